@@ -104,6 +104,7 @@ OPENKNEEBOARD_DEFINE_SPARSE_JSON(
   mBookmarks,
   mInGameUI,
   mTint,
-  mLastRunVersion)
+  mLastRunVersion,
+  mRenderCacheMiB)
 
 }// namespace OpenKneeboard
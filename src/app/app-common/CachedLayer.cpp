@@ -19,14 +19,31 @@
  */
 #include <OpenKneeboard/CachedLayer.h>
 #include <OpenKneeboard/DXResources.h>
+#include <OpenKneeboard/RasterCache.h>
 #include <OpenKneeboard/scope_guard.h>
 
 namespace OpenKneeboard {
 
-CachedLayer::CachedLayer(const DXResources& dxr) {
+CachedLayer::CachedLayer(const DXResources& dxr)
+  : mRasterCache(dxr.mRasterCache) {
 }
 
 CachedLayer::~CachedLayer() {
+  mRasterCache->EraseSource(mID.GetTemporaryValue());
+}
+
+ID2D1DeviceContext* CachedLayer::GetDeviceContext(ID2D1DeviceContext* target) {
+  winrt::com_ptr<ID2D1Device> device;
+  target->GetDevice(device.put());
+  winrt::check_pointer(device.get());
+
+  if (device != mDevice || !mDeviceContext) {
+    mDeviceContext = nullptr;
+    winrt::check_hresult(device->CreateDeviceContext(
+      D2D1_DEVICE_CONTEXT_OPTIONS_NONE, mDeviceContext.put()));
+    mDevice = device;
+  }
+  return mDeviceContext.get();
 }
 
 void CachedLayer::Render(
@@ -34,53 +51,87 @@ void CachedLayer::Render(
   const D2D1_SIZE_U& nativeSize,
   Key cacheKey,
   ID2D1DeviceContext* ctx,
-  std::function<void(ID2D1DeviceContext*, const D2D1_SIZE_U&)> impl) {
-  std::scoped_lock lock(mCacheMutex);
+  RenderFunction impl) {
+  this->Render(
+    where,
+    nativeSize,
+    SharedKey {
+      .mSource = mID.GetTemporaryValue(),
+      .mContent = cacheKey,
+    },
+    ctx,
+    std::move(impl));
+}
+
+void CachedLayer::Render(
+  const D2D1_RECT_F& where,
+  const D2D1_SIZE_U& nativeSize,
+  const SharedKey& cacheKey,
+  ID2D1DeviceContext* ctx,
+  RenderFunction impl) {
   ctx->SetTransform(D2D1::Matrix3x2F::Identity());
 
-  if (mCacheSize != nativeSize || !mCache) {
-    mCache = nullptr;
-    mCacheSize = nativeSize;
-    D2D1_BITMAP_PROPERTIES1 props {
-      .pixelFormat
-      = {DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED},
-      .bitmapOptions = D2D1_BITMAP_OPTIONS_TARGET,
-    };
-    winrt::check_hresult(
-      ctx->CreateBitmap(nativeSize, nullptr, 0, &props, mCache.put()));
-  }
+  const RasterCache::Key key {
+    .mSource = cacheKey.mSource,
+    .mContent = cacheKey.mContent,
+    .mWidth = nativeSize.width,
+    .mHeight = nativeSize.height,
+  };
 
-  if (mKey == cacheKey) {
-    ctx->DrawBitmap(mCache.get(), where);
-    return;
+  const auto bitmap = mRasterCache->GetOrRender(
+    key, [&]() { return this->RenderBitmap(ctx, nativeSize, impl); });
+  ctx->DrawBitmap(bitmap.get(), where);
+}
+
+bool CachedLayer::RenderIfCached(
+  const D2D1_RECT_F& where,
+  const D2D1_SIZE_U& nativeSize,
+  const SharedKey& cacheKey,
+  ID2D1DeviceContext* ctx) {
+  const auto bitmap = mRasterCache->Get({
+    .mSource = cacheKey.mSource,
+    .mContent = cacheKey.mContent,
+    .mWidth = nativeSize.width,
+    .mHeight = nativeSize.height,
+  });
+  if (!bitmap) {
+    return false;
   }
+  ctx->SetTransform(D2D1::Matrix3x2F::Identity());
+  ctx->DrawBitmap(bitmap.get(), where);
+  return true;
+}
 
-  winrt::com_ptr<ID2D1Device> device;
-  ctx->GetDevice(device.put());
-  winrt::check_pointer(device.get());
+winrt::com_ptr<ID2D1Bitmap1> CachedLayer::RenderBitmap(
+  ID2D1DeviceContext* ctx,
+  const D2D1_SIZE_U& nativeSize,
+  const RenderFunction& impl) {
+  std::scoped_lock lock(mDeviceContextMutex);
 
-  winrt::com_ptr<ID2D1DeviceContext> cacheContext;
-  winrt::check_hresult(device->CreateDeviceContext(
-    D2D1_DEVICE_CONTEXT_OPTIONS_NONE, cacheContext.put()));
-
-  cacheContext->SetTarget(mCache.get());
-  {
-    cacheContext->BeginDraw();
-    scope_guard endDraw([cacheContext]() noexcept {
-      winrt::check_hresult(cacheContext->EndDraw());
-    });
-    cacheContext->Clear(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f));
-    impl(cacheContext.get(), nativeSize);
-  }
-  ctx->DrawBitmap(mCache.get(), where);
-  mKey = cacheKey;
+  winrt::com_ptr<ID2D1Bitmap1> bitmap;
+  D2D1_BITMAP_PROPERTIES1 props {
+    .pixelFormat = {DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED},
+    .bitmapOptions = D2D1_BITMAP_OPTIONS_TARGET,
+  };
+  winrt::check_hresult(
+    ctx->CreateBitmap(nativeSize, nullptr, 0, &props, bitmap.put()));
+
+  auto cacheContext = this->GetDeviceContext(ctx);
+  cacheContext->SetTarget(bitmap.get());
+  cacheContext->BeginDraw();
+  scope_guard endDraw([cacheContext]() noexcept {
+    winrt::check_hresult(cacheContext->EndDraw());
+    cacheContext->SetTarget(nullptr);
+  });
+  cacheContext->SetTransform(D2D1::Matrix3x2F::Identity());
+  cacheContext->Clear(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f));
+  impl(cacheContext, nativeSize);
+
+  return bitmap;
 }
 
 void CachedLayer::Reset() {
-  std::scoped_lock lock(mCacheMutex);
-
-  mKey = ~Key {0};
-  mCache = nullptr;
+  mRasterCache->EraseSource(mID.GetTemporaryValue());
 }
 
 }// namespace OpenKneeboard
@@ -0,0 +1,126 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/EventDeliveryQueue.h>
+
+#include <algorithm>
+
+namespace OpenKneeboard {
+
+EventDeliveryExecutor::~EventDeliveryExecutor() = default;
+
+std::shared_ptr<EventDeliveryQueue> EventDeliveryQueue::Create(
+  std::unique_ptr<EventDeliveryExecutor> executor) {
+  return std::shared_ptr<EventDeliveryQueue>(
+    new EventDeliveryQueue(std::move(executor)));
+}
+
+EventDeliveryQueue::EventDeliveryQueue(
+  std::unique_ptr<EventDeliveryExecutor> executor)
+  : mExecutor(std::move(executor)) {
+}
+
+EventDeliveryQueue::~EventDeliveryQueue() = default;
+
+void EventDeliveryQueue::Enqueue(Item item) {
+  std::unique_lock lock(mMutex);
+  mPending.push_back(std::move(item));
+  ++mStats.mEnqueued;
+  if (mScheduled) {
+    return;
+  }
+  mScheduled = true;
+  lock.unlock();
+
+  if (mExecutor->IsCurrentContext()) {
+    this->Drain();
+    return;
+  }
+  this->Schedule();
+}
+
+void EventDeliveryQueue::Schedule() {
+  mExecutor->Schedule([self = shared_from_this()]() { self->Drain(); });
+}
+
+EventDeliveryQueue::Stats EventDeliveryQueue::GetStats() const {
+  std::unique_lock lock(mMutex);
+  return mStats;
+}
+
+void EventDeliveryQueue::Drain() {
+  const auto deadline = Clock::now() + MaxDrainDuration;
+  uint64_t delivered = 0;
+
+  // Must be called with the lock held
+  const auto recordDrain = [&]() {
+    ++mStats.mDrains;
+    mStats.mDelivered += delivered;
+    mStats.mMaxBatchSize = std::max(mStats.mMaxBatchSize, delivered);
+  };
+
+  while (true) {
+    if (mDrainingHead == mDraining.size()) {
+      mDraining.clear();
+      mDrainingHead = 0;
+
+      std::unique_lock lock(mMutex);
+      if (mPending.empty()) {
+        // Still holding the lock, so nothing can be enqueued between this
+        // check and clearing `mScheduled`
+        recordDrain();
+        mScheduled = false;
+        return;
+      }
+      std::swap(mPending, mDraining);
+    }
+
+    while (mDrainingHead < mDraining.size()) {
+      // Always make some progress, even if a single item is slow
+      if (delivered > 0 && Clock::now() >= deadline) {
+        // Anything left in `mDraining` is delivered first by the next drain
+        {
+          std::unique_lock lock(mMutex);
+          recordDrain();
+        }
+        this->Schedule();
+        return;
+      }
+      auto& item = mDraining.at(mDrainingHead++);
+      try {
+        item();
+      } catch (...) {
+        // Let the executor see the exception, but don't leave the queue
+        // stuck with `mScheduled` set: deliver the rest in another drain
+        item.Reset();
+        ++delivered;
+        {
+          std::unique_lock lock(mMutex);
+          recordDrain();
+        }
+        this->Schedule();
+        throw;
+      }
+      item.Reset();
+      ++delivered;
+    }
+  }
+}
+
+}// namespace OpenKneeboard
@@ -0,0 +1,267 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/EventInstrumentation.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace OpenKneeboard {
+
+namespace {
+
+// `std::source_location` isn't comparable, and the `file_name()` pointers
+// aren't guaranteed to be unique per file
+struct LocationKey {
+  std::string_view mFile;
+  std::string_view mFunction;
+  uint32_t mLine {};
+  uint32_t mColumn {};
+
+  LocationKey(const std::source_location& location)
+    : mFile(location.file_name()),
+      mFunction(location.function_name()),
+      mLine(location.line()),
+      mColumn(location.column()) {
+  }
+
+  bool operator==(const LocationKey& other) const noexcept {
+    return mLine == other.mLine && mColumn == other.mColumn
+      && mFile == other.mFile;
+  }
+
+  EventInstrumentation::Location ToLocation() const {
+    return {std::string {mFile}, mLine, std::string {mFunction}};
+  }
+};
+
+struct LocationKeyHash {
+  size_t operator()(const LocationKey& key) const noexcept {
+    return std::hash<std::string_view> {}(key.mFile)
+      ^ (static_cast<size_t>(key.mLine) << 16) ^ key.mColumn;
+  }
+};
+
+template <class T>
+using LocationMap = std::unordered_map<LocationKey, T, LocationKeyHash>;
+
+struct EmitterData {
+  uint64_t mEmitCount {};
+  size_t mMaxHandlerCount {};
+  size_t mLastHandlerCount {};
+};
+
+struct HandlerData {
+  uint64_t mCallCount {};
+  EventInstrumentation::Clock::duration mTotalTime {};
+  EventInstrumentation::Clock::duration mMaxTime {};
+  EventInstrumentation::Histogram mHistogram {};
+};
+
+struct State {
+  std::mutex mMutex;
+  EventInstrumentation::Clock::time_point mStartTime {
+    EventInstrumentation::Clock::now()};
+  LocationMap<EmitterData> mEmitters;
+  LocationMap<HandlerData> mHandlers;
+  LocationMap<uint64_t> mOrphanedReceivers;
+  std::atomic<uint64_t> mDroppedRecordCount {0};
+};
+
+State& GetState() {
+  static State sState;
+  return sState;
+}
+
+size_t GetHistogramBucket(EventInstrumentation::Clock::duration duration) {
+  const auto micros = static_cast<uint64_t>(std::max<int64_t>(
+    0,
+    std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+  // 0us => bucket 0, 1us => bucket 1, 2-3us => bucket 2, ...
+  return std::min<size_t>(
+    std::bit_width(micros), EventInstrumentation::HistogramBucketCount - 1);
+}
+
+bool IsEnabledByEnvironment() {
+  const auto value = std::getenv("OPENKNEEBOARD_EVENT_STATS");
+  return value && std::string_view {value} != "0";
+}
+
+template <class F>
+void TryRecord(F&& record) noexcept {
+  auto& state = GetState();
+  try {
+    std::unique_lock lock(state.mMutex);
+    record(state);
+  } catch (...) {
+    state.mDroppedRecordCount.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+std::string FormatLocation(const EventInstrumentation::Location& location) {
+  return std::format(
+    "{}:{} ({})", location.mFile, location.mLine, location.mFunction);
+}
+
+auto ToMicroseconds(EventInstrumentation::Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration);
+}
+
+}// namespace
+
+std::atomic_bool EventInstrumentation::sEnabled {IsEnabledByEnvironment()};
+
+void EventInstrumentation::SetEnabled(bool enabled) {
+  if (enabled && !sEnabled) {
+    Reset();
+  }
+  sEnabled = enabled;
+}
+
+void EventInstrumentation::Reset() {
+  auto& state = GetState();
+  std::unique_lock lock(state.mMutex);
+  state.mStartTime = Clock::now();
+  state.mEmitters.clear();
+  state.mHandlers.clear();
+  state.mOrphanedReceivers.clear();
+  state.mDroppedRecordCount = 0;
+}
+
+void EventInstrumentation::RecordEmit(
+  const std::source_location& emitter,
+  size_t handlerCount) noexcept {
+  TryRecord([&](State& state) {
+    auto& data = state.mEmitters[emitter];
+    ++data.mEmitCount;
+    data.mLastHandlerCount = handlerCount;
+    data.mMaxHandlerCount = std::max(data.mMaxHandlerCount, handlerCount);
+  });
+}
+
+void EventInstrumentation::RecordHandler(
+  const std::source_location& handler,
+  Clock::duration duration) noexcept {
+  TryRecord([&](State& state) {
+    auto& data = state.mHandlers[handler];
+    ++data.mCallCount;
+    data.mTotalTime += duration;
+    data.mMaxTime = std::max(data.mMaxTime, duration);
+    ++data.mHistogram[GetHistogramBucket(duration)];
+  });
+}
+
+void EventInstrumentation::RecordOrphanedReceiver(
+  const std::source_location& handler) noexcept {
+  TryRecord([&](State& state) { ++state.mOrphanedReceivers[handler]; });
+}
+
+EventInstrumentation::Snapshot EventInstrumentation::GetSnapshot() {
+  auto& state = GetState();
+  std::unique_lock lock(state.mMutex);
+
+  Snapshot ret {
+    .mEnabled = IsEnabled(),
+    .mDuration = Clock::now() - state.mStartTime,
+    .mDroppedRecordCount = state.mDroppedRecordCount.load(),
+  };
+  const auto seconds = std::chrono::duration<double>(ret.mDuration).count();
+
+  ret.mEmitters.reserve(state.mEmitters.size());
+  for (const auto& [key, data]: state.mEmitters) {
+    ret.mEmitters.push_back({
+      .mLocation = key.ToLocation(),
+      .mEmitCount = data.mEmitCount,
+      .mEmitsPerSecond = seconds > 0 ? (data.mEmitCount / seconds) : 0,
+      .mMaxHandlerCount = data.mMaxHandlerCount,
+      .mLastHandlerCount = data.mLastHandlerCount,
+    });
+  }
+  std::ranges::sort(ret.mEmitters, std::ranges::greater {}, [](const auto& it) {
+    return it.mEmitCount;
+  });
+
+  ret.mHandlers.reserve(state.mHandlers.size());
+  for (const auto& [key, data]: state.mHandlers) {
+    ret.mHandlers.push_back({
+      .mLocation = key.ToLocation(),
+      .mCallCount = data.mCallCount,
+      .mTotalTime = data.mTotalTime,
+      .mMaxTime = data.mMaxTime,
+      .mHistogram = data.mHistogram,
+    });
+  }
+  std::ranges::sort(ret.mHandlers, std::ranges::greater {}, [](const auto& it) {
+    return it.mTotalTime;
+  });
+
+  ret.mOrphanedReceivers.reserve(state.mOrphanedReceivers.size());
+  for (const auto& [key, count]: state.mOrphanedReceivers) {
+    ret.mOrphanedReceivers.push_back({key.ToLocation(), count});
+  }
+
+  return ret;
+}
+
+std::string EventInstrumentation::FormatSnapshot(const Snapshot& snapshot) {
+  auto ret = std::format(
+    "Event statistics over {:.1f}s{}\n",
+    std::chrono::duration<double>(snapshot.mDuration).count(),
+    snapshot.mEnabled ? "" : " (now disabled)");
+  if (snapshot.mDroppedRecordCount) {
+    ret += std::format(
+      "{} records were dropped\n", snapshot.mDroppedRecordCount);
+  }
+
+  ret += "\nEmitters, by emit count:\n";
+  for (const auto& it: snapshot.mEmitters) {
+    ret += std::format(
+      "- {} emits ({:.1f}/s), up to {} handlers: {}\n",
+      it.mEmitCount,
+      it.mEmitsPerSecond,
+      it.mMaxHandlerCount,
+      FormatLocation(it.mLocation));
+  }
+
+  ret += "\nHandlers, by total time:\n";
+  for (const auto& it: snapshot.mHandlers) {
+    ret += std::format(
+      "- {} calls, {} total, {} max: {}\n",
+      it.mCallCount,
+      ToMicroseconds(it.mTotalTime),
+      ToMicroseconds(it.mMaxTime),
+      FormatLocation(it.mLocation));
+  }
+
+  if (!snapshot.mOrphanedReceivers.empty()) {
+    ret += "\nReceivers still connected when their event was destroyed:\n";
+    for (const auto& it: snapshot.mOrphanedReceivers) {
+      ret += std::format("- {}x {}\n", it.mCount, FormatLocation(it.mLocation));
+    }
+  }
+  return ret;
+}
+
+}// namespace OpenKneeboard
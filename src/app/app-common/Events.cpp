@@ -22,7 +22,8 @@
 #include <OpenKneeboard/dprint.h>
 #include <OpenKneeboard/scope_guard.h>
 
-#include <queue>
+#include <mutex>
+#include <vector>
 
 namespace OpenKneeboard {
 
@@ -70,37 +71,153 @@ void EventReceiver::RemoveEventListener(EventHandlerToken token) {
       break;
     }
   }
-  if (toInvalidate) {
-    toInvalidate->Invalidate();
+  if (!toInvalidate) {
+    dprintf(
+      "RemoveEventListener() called with unknown token {:#018x}",
+      token.GetTemporaryValue());
+    return;
   }
+  toInvalidate->Invalidate();
 }
 
 namespace {
+template <class TFunction>
 struct EmitterQueueItem {
-  std::function<void()> mEmitter;
+  TFunction mEmitter;
   std::source_location mEnqueuedFrom;
 };
+
+/* Emitters queued while an `EventDelay` is active.
+ *
+ * The vector is only cleared once it has been fully drained, so its capacity
+ * is reused by later delays, and enqueuing only allocates when the queue is
+ * deeper than it has ever been before on this thread - or if the emitter is
+ * too large for `InlineFunction`'s inline storage.
+ */
+template <class TFunction>
+struct EmitterQueue {
+  std::vector<EmitterQueueItem<TFunction>> mItems;
+  size_t mHead {0};
+};
 }// namespace
 
 static thread_local uint64_t gDelayDepth = 0;
-static thread_local std::queue<EmitterQueueItem> gEmitterQueue;
+
+bool EventBase::IsDelayingEvents() noexcept {
+  return gDelayDepth;
+}
+
+static auto& GetEmitterQueue() {
+  static thread_local EmitterQueue<EventBase::EmitterFunction> sQueue;
+  return sQueue;
+}
 
 static void FlushEmitterQueue() {
-  while (!gEmitterQueue.empty()) {
-    auto item = gEmitterQueue.front();
-    gEmitterQueue.pop();
-    item.mEmitter();
+  auto& queue = GetEmitterQueue();
+  // Emitters may enqueue more items (if they use `EventDelay`), or recurse
+  // into this function, so only index into the vector, and move items out
+  // before invoking them
+  while (queue.mHead < queue.mItems.size()) {
+    auto emitter = std::move(queue.mItems.at(queue.mHead++).mEmitter);
+    emitter();
   }
+  queue.mItems.clear();
+  queue.mHead = 0;
 }
 
-void EventBase::InvokeOrEnqueue(
-  std::function<void()> func,
+void EventBase::Enqueue(
+  EmitterFunction func,
   std::source_location location) {
-  if (gDelayDepth) {
-    gEmitterQueue.push({func, location});
-    return;
+  GetEmitterQueue().mItems.push_back({std::move(func), location});
+}
+
+EventDeliveryContext::EventDeliveryContext() {
+  winrt::check_hresult(CoGetObjectContext(IID_PPV_ARGS(mIdentity.put())));
+}
+
+namespace {
+class ApartmentExecutor final : public EventDeliveryExecutor {
+ public:
+  ApartmentExecutor(const EventDeliveryContext& context) : mContext(context) {
   }
-  func();
+
+  void Schedule(std::function<void()> drain) override {
+    ScheduleAsync(mContext, std::move(drain));
+  }
+
+  bool IsCurrentContext() const override {
+    winrt::com_ptr<::IUnknown> current;
+    return SUCCEEDED(CoGetObjectContext(IID_PPV_ARGS(current.put())))
+      && current.get() == mContext.GetIdentity();
+  }
+
+ private:
+  EventDeliveryContext mContext;
+
+  static winrt::fire_and_forget ScheduleAsync(
+    EventDeliveryContext context,
+    std::function<void()> drain) {
+    // `co_await context` resumes inline if we're already in the target
+    // context, but `drain` must not be called before `Schedule()` returns
+    co_await winrt::resume_background();
+    try {
+      co_await context;
+    } catch (const winrt::hresult_error& e) {
+      // The apartment has shut down; drop the queue, and anything in it
+      dprintf(
+        L"Dropping events for an unavailable apartment: {} - {}",
+        e.code().value,
+        std::wstring_view {e.message()});
+      co_return;
+    }
+    try {
+      drain();
+    } catch (const std::exception& e) {
+      dprintf("Uncaught std::exception from queued event: {}", e.what());
+      OPENKNEEBOARD_BREAK;
+    } catch (const winrt::hresult_error& e) {
+      dprintf(
+        L"Uncaught hresult error from queued event: {} - {}",
+        e.code().value,
+        std::wstring_view {e.message()});
+      OPENKNEEBOARD_BREAK;
+    }
+  }
+};
+}// namespace
+
+std::shared_ptr<EventDeliveryQueue> EventBase::GetDeliveryQueue(
+  const EventDeliveryContext& context) {
+  const auto identity = context.GetIdentity();
+
+  // There's only a handful of contexts - usually just the UI thread - so
+  // a linear search is fine.
+  //
+  // These are weak: only the queue's executor holds a reference to the
+  // context, and the queue is only kept alive by a pending drain. This means
+  // that an idle apartment isn't kept alive by this, and the identity can't
+  // be reused by another context while the entry is live.
+  static std::mutex sMutex;
+  static std::vector<
+    std::pair<::IUnknown*, std::weak_ptr<EventDeliveryQueue>>>
+    sQueues;
+
+  std::unique_lock lock(sMutex);
+  std::erase_if(
+    sQueues, [](const auto& entry) { return entry.second.expired(); });
+  for (const auto& [queueIdentity, weakQueue]: sQueues) {
+    if (queueIdentity != identity) {
+      continue;
+    }
+    if (auto queue = weakQueue.lock()) {
+      return queue;
+    }
+  }
+
+  auto queue
+    = EventDeliveryQueue::Create(std::make_unique<ApartmentExecutor>(context));
+  sQueues.push_back({identity, queue});
+  return queue;
 }
 
 EventDelay::EventDelay(std::source_location source) : mSourceLocation(source) {
@@ -17,15 +17,21 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
  * USA.
  */
+#include <OpenKneeboard/GameEventRing.h>
 #include <OpenKneeboard/GameEventServer.h>
 #include <OpenKneeboard/config.h>
 #include <OpenKneeboard/dprint.h>
 #include <OpenKneeboard/final_release_deleter.h>
-#include <OpenKneeboard/json.h>
 #include <OpenKneeboard/scope_guard.h>
 #include <OpenKneeboard/tracing.h>
 #include <Windows.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stop_token>
 #include <thread>
 
 namespace OpenKneeboard {
@@ -38,66 +44,203 @@ std::shared_ptr<GameEventServer> GameEventServer::Create() {
 
 winrt::fire_and_forget GameEventServer::final_release(
   std::unique_ptr<GameEventServer> self) {
-  self->mRunner.Cancel();
+  self->mRunnerStopSource.request_stop();
+  if (self->mRingRunner) {
+    self->mRingRunner.Cancel();
+    // Not interruptable by cancellation
+    SetEvent(self->mRingWakeEvent.get());
+    co_await winrt::resume_on_signal(self->mRingCompletionHandle.get());
+  }
+  if (self->mReplay) {
+    self->mReplayStopSource.request_stop();
+    co_await self->mReplay;
+  }
   co_await winrt::resume_on_signal(self->mCompletionHandle.get());
 }
 
-GameEventServer::GameEventServer() {
+GameEventServer::GameEventServer()
+  : mReceiver(
+      mBatchPool,
+      mMetrics,
+      {
+        .mInspect = std::bind_front(&GameEventServer::OnBatchReceived, this),
+        .mDispatch =
+          [this](std::unique_ptr<GameEventBatch> batch) {
+            auto self = weak_from_this().lock();
+            if (!self) {
+              mBatchPool.Release(std::move(batch));
+              return;
+            }
+            self->DispatchBatch(std::move(batch));
+          },
+        .mInvalidPacket =
+          [](std::string_view packet) {
+            dprintf(
+              "Received an invalid GameEvent packet ({} bytes)",
+              packet.size());
+          },
+      }) {
   dprintf("{}", __FUNCTION__);
 }
 
 void GameEventServer::Start() {
+  // For load testing and troubleshooting; not exposed in the UI
+  if (const auto path = _wgetenv(L"OPENKNEEBOARD_GAMEEVENT_RECORDING")) {
+    this->StartRecording(path);
+  }
+
+  // Tells clients that they can send binary packets; created before the
+  // mailslot so that clients never see the mailslot without it
+  mBinaryPacketsEvent.attach(CreateEventW(
+    nullptr, TRUE, FALSE, GameEvent::GetBinaryPacketsEventName()));
+  if (!mBinaryPacketsEvent) {
+    dprintf(
+      "Failed to create GameEvent binary packets event: {}", GetLastError());
+  }
+
   mRunner = this->Run();
+
+  mRingWakeEvent.attach(CreateEventW(
+    nullptr, FALSE, FALSE, GameEvent::GetRingWakeEventName()));
+  if (mRingWakeEvent) {
+    mRingRunner = this->RunRings();
+  } else {
+    dprintf("Failed to create GameEvent ring wake event: {}", GetLastError());
+  }
+
+  if (const auto path = _wgetenv(L"OPENKNEEBOARD_GAMEEVENT_REPLAY")) {
+    double speed = 1.0;
+    if (const auto speedString
+        = _wgetenv(L"OPENKNEEBOARD_GAMEEVENT_REPLAY_SPEED")) {
+      speed = std::wcstod(speedString, nullptr);
+    }
+    this->StartReplay(path, speed);
+  }
 }
 
-GameEventServer::~GameEventServer() {
-  dprintf("{}", __FUNCTION__);
+void GameEventServer::StartRecording(const std::filesystem::path& path) {
+  try {
+    mRecorder = std::make_unique<GameEventRecordingWriter>(path);
+    dprintf("Recording GameEvents to {}", path);
+  } catch (const std::runtime_error& e) {
+    dprintf("Failed to start GameEvent recording to {}: {}", path, e.what());
+  }
 }
 
-winrt::Windows::Foundation::IAsyncAction GameEventServer::Run() {
-  const scope_guard markCompletion(
-    [handle = mCompletionHandle.get()]() { SetEvent(handle); });
+void GameEventServer::StartReplay(
+  const std::filesystem::path& path,
+  double speed) {
+  if (mReplay) {
+    dprint("Ignoring request to replay GameEvents: already replaying");
+    return;
+  }
+  mReplay = this->Replay(path, speed);
+}
 
+winrt::Windows::Foundation::IAsyncAction GameEventServer::Replay(
+  std::filesystem::path path,
+  double speed) {
   auto weak = weak_from_this();
-  winrt::file_handle handle {CreateMailslotA(
-    GameEvent::GetMailslotPath(), 0, MAILSLOT_WAIT_FOREVER, nullptr)};
-  if (!handle) {
-    dprintf("Failed to create GameEvent mailslot: {}", GetLastError());
+  const auto stopToken = mReplayStopSource.get_token();
+  co_await winrt::resume_background();
+
+  std::optional<GameEventRecordingReader> reader;
+  try {
+    reader.emplace(path);
+  } catch (const std::runtime_error& e) {
+    dprintf("Failed to open GameEvent recording {}: {}", path, e.what());
+    co_return;
+  }
+  if (!reader->IsValid()) {
+    dprintf("{} is not a valid GameEvent recording", path);
     co_return;
   }
 
-  dprint("Started listening for game events");
-  const scope_guard logOnExit([]() {
-    dprintf(
-      "GameEventServer shutting down with {} uncaught exceptions",
-      std::uncaught_exceptions());
-  });
+  dprintf("Replaying GameEvents from {} at speed {}", path, speed);
+  auto batch = mBatchPool.Acquire();
+  const auto dispatch = [&]() {
+    if (batch->IsEmpty()) {
+      return;
+    }
+    auto self = weak.lock();
+    if (!self) {
+      return;
+    }
+    mMetrics.RecordQueued(*batch);
+    self->DispatchBatch(std::move(batch));
+    batch = mBatchPool.Acquire();
+  };
 
-  auto cancelled = co_await winrt::get_cancellation_token();
-  cancelled.enable_propagation();
+  // Keep batches reasonably small when replaying as fast as possible
+  constexpr size_t MaxBatchSize = 1000;
+  const auto stats = ReplayGameEvents(
+    *reader,
+    {
+      .mSpeed = speed,
+      .mBeforeWait = dispatch,
+      .mStopToken = stopToken,
+    },
+    [&](const GameEvent& event) {
+      batch->Append(event.name, event.value, GameEventBatch::Clock::now());
+      if (batch->GetEventCount() >= MaxBatchSize) {
+        dispatch();
+      }
+    });
+  mBatchPool.Release(std::move(batch));
 
-  winrt::handle event {CreateEventW(nullptr, FALSE, FALSE, nullptr)};
+  dprintf(
+    "Replayed {} GameEvents ({} recorded) in {}; max lag {}{}",
+    stats.mEventCount,
+    std::chrono::duration_cast<std::chrono::seconds>(stats.mRecordedDuration),
+    std::chrono::duration_cast<std::chrono::milliseconds>(stats.mWallTime),
+    std::chrono::duration_cast<std::chrono::milliseconds>(stats.mMaxLag),
+    stats.mCorrupt ? "; recording is truncated or corrupt" : "");
 
-  try {
-    while ((!cancelled()) && co_await RunSingle(weak, event, handle)) {
-      // repeat!
-    }
-  } catch (const winrt::hresult_canceled&) {
-    co_return;
+  if (!stats.mStopped) {
+    evReplayCompletedEvent.EnqueueForContext(mUIThread, stats);
   }
+}
 
-  co_return;
+GameEventServer::~GameEventServer() {
+  dprintf("{}", __FUNCTION__);
 }
 
-winrt::Windows::Foundation::IAsyncOperation<bool> GameEventServer::RunSingle(
-  const std::weak_ptr<GameEventServer>& instance,
-  const winrt::handle& notifyEvent,
-  const winrt::file_handle& handle) {
-  auto cancelled = co_await winrt::get_cancellation_token();
-  cancelled.enable_propagation();
+class GameEventServer::MailslotPacketSource final
+  : public GameEventPacketSource {
+ public:
+  MailslotPacketSource(const winrt::file_handle& handle);
+
+  virtual bool ReadNext(const PacketCallback&, std::stop_token) override;
+  virtual size_t ReadPending(const PacketCallback&) override;
 
+ private:
+  const winrt::file_handle& mHandle;
+  winrt::handle mNotifyEvent {CreateEventW(nullptr, FALSE, FALSE, nullptr)};
+  winrt::handle mStopEvent {CreateEventW(nullptr, TRUE, FALSE, nullptr)};
+  // Reused for every read; only grows
+  std::vector<char> mBuffer;
+
+  std::vector<char>& GetBuffer(DWORD minimumSize);
+};
+
+GameEventServer::MailslotPacketSource::MailslotPacketSource(
+  const winrt::file_handle& handle)
+  : mHandle(handle) {
+}
+
+std::vector<char>& GameEventServer::MailslotPacketSource::GetBuffer(
+  DWORD minimumSize) {
+  if (mBuffer.size() < minimumSize) {
+    mBuffer.resize(minimumSize);
+  }
+  return mBuffer;
+}
+
+bool GameEventServer::MailslotPacketSource::ReadNext(
+  const PacketCallback& callback,
+  std::stop_token stopToken) {
   OVERLAPPED overlapped {
-    .hEvent = notifyEvent.get(),
+    .hEvent = mNotifyEvent.get(),
   };
 
   /* If there's no message yet, use this buffer size.
@@ -106,79 +249,380 @@ winrt::Windows::Foundation::IAsyncOperation<bool> GameEventServer::RunSingle(
    * and loop into this function again.
    *
    * We'll then get a good result from GetMailslotInfo(),
-   * and allocate a correctly-sized buffer.
+   * and grow the buffer.
    */
   const constexpr DWORD DefaultBufferSize = 4096;
   DWORD bufferSize {DefaultBufferSize};
   if (
-    (!GetMailslotInfo(handle.get(), nullptr, &bufferSize, nullptr, nullptr))
+    (!GetMailslotInfo(mHandle.get(), nullptr, &bufferSize, nullptr, nullptr))
     || bufferSize == MAILSLOT_NO_MESSAGE) {
     bufferSize = DefaultBufferSize;
   }
 
-  std::vector<char> buffer(bufferSize);
+  auto& buffer = this->GetBuffer(bufferSize);
   DWORD bytesRead {};
   const auto readFileResult = ReadFile(
-    handle.get(),
+    mHandle.get(),
     buffer.data(),
     static_cast<DWORD>(buffer.size()),
     &bytesRead,
     &overlapped);
   const auto readFileError = GetLastError();
   if ((!readFileResult) && readFileError != ERROR_IO_PENDING) {
-    dprintf("GameEvent ReadFile failed: {}", GetLastError());
-    co_return true;
+    dprintf("GameEvent ReadFile failed: {}", readFileError);
+    return true;
   }
 
   traceprint("Waiting for GameEvent");
-  co_await winrt::resume_on_signal(notifyEvent.get());
-  GetOverlappedResult(handle.get(), &overlapped, &bytesRead, TRUE);
+  const std::stop_callback wakeOnStop(
+    stopToken, [event = mStopEvent.get()]() { SetEvent(event); });
+  const HANDLE handles[] {mNotifyEvent.get(), mStopEvent.get()};
+  if (
+    WaitForMultipleObjects(std::size(handles), handles, FALSE, INFINITE)
+    != WAIT_OBJECT_0) {
+    CancelIoEx(mHandle.get(), &overlapped);
+    GetOverlappedResult(mHandle.get(), &overlapped, &bytesRead, TRUE);
+    return false;
+  }
+  GetOverlappedResult(mHandle.get(), &overlapped, &bytesRead, TRUE);
 
   if (bytesRead == 0) {
     dprint("Read 0-byte GameEvent message");
-    co_return true;
+    return true;
   }
+  callback({buffer.data(), bytesRead});
+  return true;
+}
+
+size_t GameEventServer::MailslotPacketSource::ReadPending(
+  const PacketCallback& callback) {
+  size_t count = 0;
+  while (true) {
+    DWORD nextSize {MAILSLOT_NO_MESSAGE};
+    if (
+      (!GetMailslotInfo(mHandle.get(), nullptr, &nextSize, nullptr, nullptr))
+      || nextSize == MAILSLOT_NO_MESSAGE) {
+      return count;
+    }
 
-  auto self = instance.lock();
-  if (!self) {
-    dprint("Failed to acquire self");
-    co_return false;
+    auto& buffer = this->GetBuffer(nextSize);
+    DWORD bytesRead {};
+    if (!ReadFile(
+          mHandle.get(),
+          buffer.data(),
+          static_cast<DWORD>(buffer.size()),
+          &bytesRead,
+          nullptr)) {
+      dprintf("GameEvent ReadFile failed while draining: {}", GetLastError());
+      return count;
+    }
+    ++count;
+    if (bytesRead > 0) {
+      callback({buffer.data(), bytesRead});
+    }
   }
+}
 
-  self->DispatchEvent({buffer.data(), bytesRead});
-  co_return true;
+GameEventReceiveMetrics::Snapshot GameEventServer::GetMetrics() const {
+  return mMetrics.GetSnapshot();
 }
 
-winrt::fire_and_forget GameEventServer::DispatchEvent(std::string_view ref) {
-  const std::string buffer(ref);
+winrt::Windows::Foundation::IAsyncAction GameEventServer::Run() {
+  const scope_guard markCompletion(
+    [handle = mCompletionHandle.get()]() { SetEvent(handle); });
+
+  winrt::file_handle handle {CreateMailslotA(
+    GameEvent::GetMailslotPath(), 0, MAILSLOT_WAIT_FOREVER, nullptr)};
+  if (!handle) {
+    dprintf("Failed to create GameEvent mailslot: {}", GetLastError());
+    co_return;
+  }
 
-  const auto stayingAlive = shared_from_this();
+  dprint("Started listening for game events");
+  const scope_guard logOnExit([]() {
+    dprintf(
+      "GameEventServer shutting down with {} uncaught exceptions",
+      std::uncaught_exceptions());
+  });
+
+  // `final_release()` waits for `mCompletionHandle`, so `this` outlives the
+  // loop
+  const auto stopToken = mRunnerStopSource.get_token();
   co_await winrt::resume_background();
+  MailslotPacketSource source {handle};
+  mReceiver.Run(source, stopToken);
+}
+
+void GameEventServer::OnBatchReceived(
+  const GameEventBatch& batch,
+  GameEventBatch::Clock::time_point receivedAt) {
+  for (const auto& event: batch) {
+    if (event.name != GameEvent::EVT_REGISTER_RING) {
+      continue;
+    }
+    const auto registration = GameEvent::FromView(event)
+                                .TryParsedValue<RegisterGameEventRingEvent>();
+    if (registration) {
+      this->AttachRing(*registration);
+    }
+  }
+
+  if (mRecorder) {
+    std::unique_lock lock(mRecorderMutex);
+    for (const auto& event: batch) {
+      mRecorder->Write(receivedAt, event.name, event.value);
+    }
+  }
+}
+
+struct GameEventServer::RingClient final {
+  RingClient() = default;
+  RingClient(const RingClient&) = delete;
+  RingClient& operator=(const RingClient&) = delete;
+
+  ~RingClient() {
+    if (mRing) {
+      mRing->SetConsumerAttached(false);
+    }
+    if (mView) {
+      UnmapViewOfFile(mView);
+    }
+  }
+
+  std::string mMappingName;
+  uint32_t mProcessID {};
+  // Not read until EVT_ACTIVATE_RING is dispatched; see
+  // `ActivateGameEventRingEvent`
+  bool mActive {false};
+  winrt::handle mProcess;
+  winrt::handle mMapping;
+  void* mView {nullptr};
+  std::optional<GameEventRing> mRing;
+
+  bool HasExited() const noexcept {
+    return WaitForSingleObject(mProcess.get(), 0) == WAIT_OBJECT_0;
+  }
+};
+
+void GameEventServer::AttachRing(const RegisterGameEventRingEvent& event) {
+  std::unique_lock lock(mRingMutex);
+  for (const auto& client: mRingClients) {
+    if (client->mMappingName == event.mMappingName) {
+      // Re-registration, e.g. before it saw that we'd attached
+      return;
+    }
+  }
+  if (
+    std::ranges::find(mRejectedRingNames, event.mMappingName)
+    != mRejectedRingNames.end()) {
+    // Re-registration; we've already logged why
+    return;
+  }
+
+  // Rings are small; anything huge is a bad or malicious registration
+  constexpr uint64_t MaxByteCount = 16 * 1024 * 1024;
+  if (event.mByteCount == 0 || event.mByteCount > MaxByteCount) {
+    dprintf(
+      "Ignoring GameEvent ring '{}' with invalid size {}",
+      event.mMappingName,
+      event.mByteCount);
+    return;
+  }
+
+  auto client = std::make_unique<RingClient>();
+  client->mMappingName = event.mMappingName;
+  client->mProcessID = event.mProcessID;
+  client->mMapping.attach(OpenFileMappingA(
+    FILE_MAP_WRITE, FALSE, event.mMappingName.c_str()));
+  if (!client->mMapping) {
+    dprintf(
+      "Failed to open GameEvent ring '{}': {}",
+      event.mMappingName,
+      GetLastError());
+    return;
+  }
+  const auto byteCount = static_cast<size_t>(event.mByteCount);
+  client->mView
+    = MapViewOfFile(client->mMapping.get(), FILE_MAP_WRITE, 0, 0, byteCount);
+  if (!client->mView) {
+    dprintf(
+      "Failed to map GameEvent ring '{}': {}",
+      event.mMappingName,
+      GetLastError());
+    return;
+  }
+  client->mRing = GameEventRing::Open(client->mView, byteCount);
+  if (!client->mRing) {
+    dprintf("GameEvent ring '{}' is invalid", event.mMappingName);
+    return;
+  }
+  client->mProcess.attach(OpenProcess(SYNCHRONIZE, FALSE, event.mProcessID));
+  if (!client->mProcess) {
+    // Without the handle, we'd never notice the client exiting, and keep the
+    // mapping forever
+    dprintf(
+      "Not attaching to GameEvent ring '{}': couldn't open process {}: {}",
+      event.mMappingName,
+      event.mProcessID,
+      GetLastError());
+    // Clients re-register until we attach, so remember that we've logged
+    // this; mapping names are unique per ring, so old entries are unlikely
+    // to be needed again
+    if (mRejectedRingNames.size() >= MaxRejectedRingNames) {
+      mRejectedRingNames.erase(mRejectedRingNames.begin());
+    }
+    mRejectedRingNames.push_back(event.mMappingName);
+    return;
+  }
+
+  client->mRing->SetConsumerAttached(true);
+  dprintf(
+    "Attached to GameEvent ring '{}' from process {}",
+    event.mMappingName,
+    event.mProcessID);
+  mRingClients.push_back(std::move(client));
+  lock.unlock();
+
+  // Start heartbeating, so that the client sees us as alive
+  SetEvent(mRingWakeEvent.get());
+}
+
+void GameEventServer::ActivateRing(const ActivateGameEventRingEvent& event) {
+  std::unique_lock lock(mRingMutex);
+  const auto it = std::ranges::find_if(mRingClients, [&](const auto& client) {
+    return client->mMappingName == event.mMappingName;
+  });
+  if (it == mRingClients.end()) {
+    return;
+  }
+  // Everything the client sent through the mailslot has been dispatched, so
+  // anything we read from the ring from now on is dispatched after it
+  (*it)->mActive = true;
+  lock.unlock();
+
+  // Pick up anything written before we got here
+  SetEvent(mRingWakeEvent.get());
+}
+
+size_t GameEventServer::DrainRings(
+  GameEventBatch& batch,
+  GameEventBatch::Clock::time_point receivedAt) {
+  std::unique_lock lock(mRingMutex);
+  size_t count = 0;
+  for (auto it = mRingClients.begin(); it != mRingClients.end();) {
+    auto& client = **it;
+    // Check before draining, so that we don't miss anything written
+    // between draining and the check
+    const auto exited = client.HasExited();
+    if (client.mRing->IsAbandoned()) {
+      // The client thought we'd stopped responding, and has switched back to
+      // the mailslot; what's left in the ring would be out of order
+      dprintf(
+        "Detaching from GameEvent ring '{}': abandoned by process {}, with {} "
+        "bytes unread",
+        client.mMappingName,
+        client.mProcessID,
+        client.mRing->GetPendingByteCount());
+      it = mRingClients.erase(it);
+      continue;
+    }
+    client.mRing->Heartbeat();
+    while (client.mActive && client.mRing->TryRead(mRingBuffer)) {
+      ++count;
+      const std::string_view packet {mRingBuffer.data(), mRingBuffer.size()};
+      const auto valid = batch.AppendPacket(packet, receivedAt);
+      mMetrics.RecordPacket(valid);
+      if (!valid) {
+        dprintf(
+          "Received an invalid GameEvent packet ({} bytes) from ring '{}'",
+          packet.size(),
+          client.mMappingName);
+      }
+    }
+    if (exited) {
+      dprintf(
+        "Detaching from GameEvent ring '{}': process {} exited",
+        client.mMappingName,
+        client.mProcessID);
+      it = mRingClients.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return count;
+}
+
+winrt::Windows::Foundation::IAsyncAction GameEventServer::RunRings() {
+  const scope_guard markCompletion(
+    [handle = mRingCompletionHandle.get()]() { SetEvent(handle); });
+
+  auto weak = weak_from_this();
+  auto cancelled = co_await winrt::get_cancellation_token();
+  const auto wakeEvent = mRingWakeEvent.get();
+
+  co_await winrt::resume_background();
+  while (!cancelled()) {
+    // Timeout so that we notice exited clients even if nothing's happening
+    co_await winrt::resume_on_signal(wakeEvent, std::chrono::seconds(1));
+    if (cancelled()) {
+      break;
+    }
+
+    auto self = weak.lock();
+    if (!self) {
+      break;
+    }
+
+    auto batch = self->mBatchPool.Acquire();
+    const auto receivedAt = GameEventBatch::Clock::now();
+    self->DrainRings(*batch, receivedAt);
+    self->mReceiver.Submit(std::move(batch), receivedAt);
+  }
+
+  std::unique_lock lock(mRingMutex);
+  mRingClients.clear();
+}
+
+winrt::fire_and_forget GameEventServer::DispatchBatch(
+  std::unique_ptr<GameEventBatch> batch) {
+  const auto stayingAlive = shared_from_this();
+  co_await mUIThread;
+
+  const auto dispatchedAt = GameEventBatch::Clock::now();
+  mMetrics.RecordDispatched(*batch, dispatchedAt);
 
-  traceprint("Handling event");
-  auto event = GameEvent::Unserialize(buffer);
   TraceLoggingActivity<gTraceProvider> activity;
   TraceLoggingWriteStart(
-    activity, "GameEvent", TraceLoggingValue(event.name.c_str(), "Name"));
-  const scope_guard stopActivity(
-    [&activity]() { TraceLoggingWriteStop(activity, "GameEvent"); });
-  if (event.name != GameEvent::EVT_MULTI_EVENT) {
-    this->evGameEvent.EnqueueForContext(mUIThread, event);
-    co_return;
-  }
+    activity,
+    "GameEventServer::DispatchBatch()",
+    TraceLoggingValue(batch->GetEventCount(), "EventCount"),
+    TraceLoggingValue(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        dispatchedAt - batch->GetReceivedAt())
+        .count(),
+      "LatencyMicroseconds"));
+
+  for (const auto& view: *batch) {
+    if (view.name == GameEvent::EVT_ACTIVATE_RING) {
+      const auto activation = GameEvent::FromView(view)
+                                .TryParsedValue<ActivateGameEventRingEvent>();
+      if (activation) {
+        this->ActivateRing(*activation);
+      }
+    }
 
-  std::vector<std::tuple<std::string, std::string>> events;
-  events = nlohmann::json::parse(event.value);
-  for (const auto& [name, value]: events) {
-    TraceLoggingActivity<gTraceProvider> subActivity;
+    TraceLoggingActivity<gTraceProvider> eventActivity;
     TraceLoggingWriteStart(
-      subActivity, "GameEvent/Multi", TraceLoggingValue(name.c_str(), "Name"));
-    co_await this->evGameEvent.EmitFromContextAsync(mUIThread, {name, value});
-    TraceLoggingWriteStop(
-      subActivity, "GameEvent/Multi", TraceLoggingValue(name.c_str(), "Name"));
+      eventActivity,
+      "GameEvent",
+      TraceLoggingCountedUtf8String(
+        view.name.data(), static_cast<ULONG>(view.name.size()), "Name"));
+    evGameEvent.Emit(GameEvent::FromView(view));
+    TraceLoggingWriteStop(eventActivity, "GameEvent");
   }
 
-  co_return;
+  TraceLoggingWriteStop(activity, "GameEventServer::DispatchBatch()");
+  mBatchPool.Release(std::move(batch));
 }
 
 }// namespace OpenKneeboard
@@ -27,6 +27,8 @@
 #include <OpenKneeboard/KneeboardState.h>
 #include <OpenKneeboard/KneeboardView.h>
 #include <OpenKneeboard/OpenXRMode.h>
+#include <OpenKneeboard/RasterCache.h>
+#include <OpenKneeboard/SearchIndexer.h>
 #include <OpenKneeboard/SteamVRKneeboard.h>
 #include <OpenKneeboard/TabView.h>
 #include <OpenKneeboard/TabletInputAdapter.h>
@@ -41,6 +43,7 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
 
 namespace OpenKneeboard {
 
@@ -50,13 +53,51 @@ std::shared_ptr<KneeboardState> KneeboardState::Create(
   return shared_with_final_release(new KneeboardState(hwnd, dxr));
 }
 
+static void SetRenderCacheBudget(
+  const DXResources& dxr,
+  const AppSettings& settings) {
+  auto& cache = *dxr.mRasterCache;
+  const auto budget = settings.mRenderCacheMiB
+    ? (static_cast<size_t>(settings.mRenderCacheMiB) * 1024 * 1024)
+    : cache.GetDefaultByteBudget();
+  if (budget == cache.GetStats().mCache.mBudget) {
+    return;
+  }
+  dprintf("Render cache budget: {}MiB", budget / (1024 * 1024));
+  cache.SetByteBudget(budget);
+}
+
 KneeboardState::KneeboardState(HWND hwnd, const DXResources& dxr)
   : mHwnd(hwnd), mDXResources(dxr) {
   const scope_guard saveMigratedSettings([this]() { this->SaveSettings(); });
+  SetRenderCacheBudget(dxr, mSettings.mApp);
 
   AddEventListener(
     this->evNeedsRepaintEvent, [this]() { this->mNeedsRepaint = true; });
 
+  const auto subscribe = [this](const GameEventName& name, auto handler) {
+    mGameEventSubscriptions.push_back(mGameEventDispatcher->Subscribe(
+      name, std::bind_front(handler, this)));
+  };
+  subscribe(
+    GameEvent::EVT_SET_INPUT_FOCUS, &KneeboardState::OnSetInputFocusEvent);
+  subscribe(
+    GameEvent::EVT_REMOTE_USER_ACTION,
+    &KneeboardState::OnRemoteUserActionEvent);
+  subscribe(GameEvent::EVT_SET_TAB_BY_ID, &KneeboardState::OnSetTabByIDEvent);
+  subscribe(
+    GameEvent::EVT_SET_TAB_BY_NAME, &KneeboardState::OnSetTabByNameEvent);
+  subscribe(
+    GameEvent::EVT_SET_TAB_BY_INDEX, &KneeboardState::OnSetTabByIndexEvent);
+  subscribe(
+    GameEvent::EVT_SET_PROFILE_BY_ID, &KneeboardState::OnSetProfileByIDEvent);
+  subscribe(
+    GameEvent::EVT_SET_PROFILE_BY_NAME,
+    &KneeboardState::OnSetProfileByNameEvent);
+  subscribe(
+    GameEvent::EVT_SET_BRIGHTNESS, &KneeboardState::OnSetBrightnessEvent);
+  subscribe(GameEvent::EVT_SEARCH, &KneeboardState::OnSearchEvent);
+
   mGamesList = std::make_unique<GamesList>(this, mSettings.mGames);
   AddEventListener(
     mGamesList->evSettingsChangedEvent,
@@ -292,154 +333,188 @@ void KneeboardState::OnGameEvent(const GameEvent& ev) noexcept {
   }
   TroubleshootingStore::Get()->OnGameEvent(ev);
 
-  const auto tabs = mTabsList->GetTabs();
+  mGameEventDispatcher->Dispatch(ev);
+}
 
-  if (ev.name == GameEvent::EVT_SET_INPUT_FOCUS) {
-    const auto viewID = std::stoull(ev.value);
-    for (int i = 0; i < mViews.size(); ++i) {
-      if (mViews.at(i)->GetRuntimeID() != viewID) {
-        continue;
-      }
-      if (mInputViewIndex == i) {
-        return;
-      }
-      mViews.at(mInputViewIndex)->PostCursorEvent({});
-      dprintf("Giving input focus to view {:#016x} at index {}", viewID, i);
-      mInputViewIndex = i;
-      evNeedsRepaintEvent.Emit();
-      evViewOrderChangedEvent.Emit();
+GameEventDispatcher* KneeboardState::GetGameEventDispatcher() const {
+  return mGameEventDispatcher.get();
+}
+
+void KneeboardState::OnSetInputFocusEvent(const GameEvent& ev) {
+  const auto viewID = std::stoull(ev.value);
+  for (int i = 0; i < mViews.size(); ++i) {
+    if (mViews.at(i)->GetRuntimeID() != viewID) {
+      continue;
+    }
+    if (mInputViewIndex == i) {
       return;
     }
-    dprintf(
-      "Asked to give input focus to view {:#016x}, but couldn't find it",
-      viewID);
+    mViews.at(mInputViewIndex)->PostCursorEvent({});
+    dprintf("Giving input focus to view {:#016x} at index {}", viewID, i);
+    mInputViewIndex = i;
+    evNeedsRepaintEvent.Emit();
+    evViewOrderChangedEvent.Emit();
     return;
   }
+  dprintf(
+    "Asked to give input focus to view {:#016x}, but couldn't find it", viewID);
+}
 
-  if (ev.name == GameEvent::EVT_REMOTE_USER_ACTION) {
+void KneeboardState::OnRemoteUserActionEvent(const GameEvent& ev) {
 #define IT(ACTION) \
   if (ev.value == #ACTION) { \
     PostUserAction(UserAction::ACTION); \
     return; \
   }
-    OPENKNEEBOARD_USER_ACTIONS
+  OPENKNEEBOARD_USER_ACTIONS
 #undef IT
+  dprintf("Unrecognized remote user action: '{}'", ev.value);
+}
+
+void KneeboardState::OnSetTabByIDEvent(const GameEvent& ev) {
+  const auto tabs = mTabsList->GetTabs();
+  const auto parsed = ev.ParsedValue<SetTabByIDEvent>();
+  winrt::guid guid;
+  try {
+    guid = winrt::guid {parsed.mID};
+  } catch (const std::invalid_argument&) {
+    dprintf("Failed to set tab by ID: '{}' is not a valid GUID", parsed.mID);
+    return;
+  }
+  const auto tab = std::ranges::find_if(
+    tabs, [guid](const auto& tab) { return tab->GetPersistentID() == guid; });
+  if (tab == tabs.end()) {
+    dprintf(
+      "Asked to switch to tab with ID '{}', but can't find it", parsed.mID);
+    return;
   }
+  this->SetCurrentTab(*tab, parsed);
+}
 
-  if (ev.name == GameEvent::EVT_SET_TAB_BY_ID) {
-    const auto parsed = ev.ParsedValue<SetTabByIDEvent>();
-    winrt::guid guid;
-    try {
-      guid = winrt::guid {parsed.mID};
-    } catch (const std::invalid_argument&) {
-      dprintf("Failed to set tab by ID: '{}' is not a valid GUID", parsed.mID);
-      return;
-    }
-    const auto tab = std::ranges::find_if(
-      tabs, [guid](const auto& tab) { return tab->GetPersistentID() == guid; });
-    if (tab == tabs.end()) {
-      dprintf(
-        "Asked to switch to tab with ID '{}', but can't find it", parsed.mID);
-      return;
-    }
-    this->SetCurrentTab(*tab, parsed);
+void KneeboardState::OnSetTabByNameEvent(const GameEvent& ev) {
+  const auto tabs = mTabsList->GetTabs();
+  const auto parsed = ev.ParsedValue<SetTabByNameEvent>();
+  const auto tab = std::ranges::find_if(tabs, [parsed](const auto& tab) {
+    return parsed.mName == tab->GetTitle();
+  });
+  if (tab == tabs.end()) {
+    dprintf(
+      "Asked to switch to tab with name '{}', but can't find it", parsed.mName);
     return;
   }
+  this->SetCurrentTab(*tab, parsed);
+}
 
-  if (ev.name == GameEvent::EVT_SET_TAB_BY_NAME) {
-    const auto parsed = ev.ParsedValue<SetTabByNameEvent>();
-    const auto tab = std::ranges::find_if(tabs, [parsed](const auto& tab) {
-      return parsed.mName == tab->GetTitle();
-    });
-    if (tab == tabs.end()) {
-      dprintf(
-        "Asked to switch to tab with name '{}', but can't find it",
-        parsed.mName);
-      return;
-    }
-    this->SetCurrentTab(*tab, parsed);
+void KneeboardState::OnSetTabByIndexEvent(const GameEvent& ev) {
+  const auto tabs = mTabsList->GetTabs();
+  const auto parsed = ev.ParsedValue<SetTabByIndexEvent>();
+  if (parsed.mIndex >= tabs.size()) {
+    dprintf(
+      "Asked to switch to tab index {}, but there aren't that many tabs",
+      parsed.mIndex);
     return;
   }
+  this->SetCurrentTab(tabs.at(parsed.mIndex), parsed);
+}
 
-  if (ev.name == GameEvent::EVT_SET_TAB_BY_INDEX) {
-    const auto parsed = ev.ParsedValue<SetTabByIndexEvent>();
-    if (parsed.mIndex >= tabs.size()) {
-      dprintf(
-        "Asked to switch to tab index {}, but there aren't that many tabs",
-        parsed.mIndex);
-      return;
-    }
-    this->SetCurrentTab(tabs.at(parsed.mIndex), parsed);
+void KneeboardState::OnSetProfileByIDEvent(const GameEvent& ev) {
+  const auto parsed = ev.ParsedValue<SetProfileByIDEvent>();
+  if (!mProfiles.mEnabled) {
+    dprint("Asked to switch profiles, but profiles are disabled");
+  }
+  if (!mProfiles.mProfiles.contains(parsed.mID)) {
+    dprintf(
+      "Asked to switch to profile with ID '{}', but it doesn't exist",
+      parsed.mID);
     return;
   }
+  ProfileSettings newSettings(mProfiles);
+  newSettings.mActiveProfile = parsed.mID;
+  this->SetProfileSettings(newSettings);
+}
 
-  if (ev.name == GameEvent::EVT_SET_PROFILE_BY_ID) {
-    const auto parsed = ev.ParsedValue<SetProfileByIDEvent>();
-    if (!mProfiles.mEnabled) {
-      dprint("Asked to switch profiles, but profiles are disabled");
-    }
-    if (!mProfiles.mProfiles.contains(parsed.mID)) {
-      dprintf(
-        "Asked to switch to profile with ID '{}', but it doesn't exist",
-        parsed.mID);
-      return;
-    }
-    ProfileSettings newSettings(mProfiles);
-    newSettings.mActiveProfile = parsed.mID;
-    this->SetProfileSettings(newSettings);
+void KneeboardState::OnSetProfileByNameEvent(const GameEvent& ev) {
+  const auto parsed = ev.ParsedValue<SetProfileByNameEvent>();
+  if (!mProfiles.mEnabled) {
+    dprint("Asked to switch profiles, but profiles are disabled");
+  }
+  auto it = std::ranges::find_if(
+    mProfiles.mProfiles,
+    [name = parsed.mName](const auto& p) { return p.second.mName == name; });
+  if (it == mProfiles.mProfiles.end()) {
+    dprintf(
+      "Asked to switch to profile with ID '{}', but it doesn't exist",
+      parsed.mName);
     return;
   }
+  ProfileSettings newSettings(mProfiles);
+  newSettings.mActiveProfile = it->first;
+  this->SetProfileSettings(newSettings);
+}
+
+void KneeboardState::OnSetBrightnessEvent(const GameEvent& ev) {
+  const auto parsed = ev.ParsedValue<SetBrightnessEvent>();
+  auto& tint = this->mSettings.mApp.mTint;
+  tint.mEnabled = true;
+  switch (parsed.mMode) {
+    case SetBrightnessEvent::Mode::Absolute:
+      if (parsed.mBrightness < 0 || parsed.mBrightness > 1) {
+        dprintf(
+          "Requested absolute brightness '{}' is outside of range 0 to 1",
+          parsed.mBrightness);
+        return;
+      }
+      tint.mBrightness = parsed.mBrightness;
+      break;
+    case SetBrightnessEvent::Mode::Relative:
+      if (parsed.mBrightness < -1 || parsed.mBrightness > 1) {
+        dprintf(
+          "Requested relative brightness '{}' is outside of range -1 to 1",
+          parsed.mBrightness);
+        return;
+      }
+      tint.mBrightness
+        = std::clamp(tint.mBrightness + parsed.mBrightness, 0.0f, 1.0f);
+      break;
+  }
+  this->SaveSettings();
+}
 
-  if (ev.name == GameEvent::EVT_SET_PROFILE_BY_NAME) {
-    const auto parsed = ev.ParsedValue<SetProfileByNameEvent>();
-    if (!mProfiles.mEnabled) {
-      dprint("Asked to switch profiles, but profiles are disabled");
-    }
-    auto it = std::ranges::find_if(
-      mProfiles.mProfiles,
-      [name = parsed.mName](const auto& p) { return p.second.mName == name; });
-    if (it == mProfiles.mProfiles.end()) {
-      dprintf(
-        "Asked to switch to profile with ID '{}', but it doesn't exist",
-        parsed.mName);
-      return;
-    }
-    ProfileSettings newSettings(mProfiles);
-    newSettings.mActiveProfile = it->first;
-    this->SetProfileSettings(newSettings);
+void KneeboardState::OnSearchEvent(const GameEvent& ev) {
+  mPendingSearch = ev.ParsedValue<SearchEvent>().mQuery;
+  // The first search starts the indexer; until that has been through every
+  // tab, the search waits for `OnSearchIndexUpdatedEvent()`
+  if (this->GetSearchIndexer()->IsIndexed()) {
+    this->RunPendingSearch();
+  }
+}
+
+winrt::fire_and_forget KneeboardState::OnSearchIndexUpdatedEvent() {
+  const auto weak = weak_from_this();
+  co_await mUIThread;
+  if (const auto self = weak.lock()) {
+    self->RunPendingSearch();
+  }
+}
+
+void KneeboardState::RunPendingSearch() {
+  if (!mPendingSearch) {
     return;
   }
+  const auto query = *std::exchange(mPendingSearch, std::nullopt);
 
-  if (ev.name == GameEvent::EVT_SET_BRIGHTNESS) {
-    const auto parsed = ev.ParsedValue<SetBrightnessEvent>();
-    auto& tint = this->mSettings.mApp.mTint;
-    tint.mEnabled = true;
-    switch (parsed.mMode) {
-      case SetBrightnessEvent::Mode::Absolute:
-        if (parsed.mBrightness < 0 || parsed.mBrightness > 1) {
-          dprintf(
-            "Requested absolute brightness '{}' is outside of range 0 to 1",
-            parsed.mBrightness);
-          return;
-        }
-        tint.mBrightness = parsed.mBrightness;
-        break;
-      case SetBrightnessEvent::Mode::Relative:
-        if (parsed.mBrightness < -1 || parsed.mBrightness > 1) {
-          dprintf(
-            "Requested relative brightness '{}' is outside of range -1 to 1",
-            parsed.mBrightness);
-          return;
-        }
-        tint.mBrightness
-          = std::clamp(tint.mBrightness + parsed.mBrightness, 0.0f, 1.0f);
-        break;
-    }
-    this->SaveSettings();
+  const auto results = mSearchIndexer->Query(query, 1);
+  if (results.empty()) {
+    dprintf("Searched for '{}', but found nothing", query);
     return;
   }
 
-  this->evGameEvent.Emit(ev);
+  const EventDelay delay;// lock must be released first
+  const std::unique_lock lock(*this);
+  if (!SearchIndexer::GoToResult(
+        this->GetActiveViewForGlobalInput().get(), results.front())) {
+    dprintf("Searched for '{}', but the result's page no longer exists", query);
+  }
 }
 
 void KneeboardState::SetCurrentTab(
@@ -532,6 +607,7 @@ void KneeboardState::SetAppSettings(const AppSettings& value) {
     mSettings.mApp = value;
     this->SaveSettings();
   }
+  SetRenderCacheBudget(mDXResources, value);
   if (!value.mDualKneeboards.mEnabled) {
     this->SetFirstViewIndex(0);
   }
@@ -545,6 +621,18 @@ TabsList* KneeboardState::GetTabsList() const {
   return mTabsList.get();
 }
 
+SearchIndexer* KneeboardState::GetSearchIndexer() {
+  // Indexing extracts the text of every tab, so don't start until something
+  // wants to search
+  if (!mSearchIndexer) {
+    mSearchIndexer = std::make_unique<SearchIndexer>(mTabsList.get());
+    AddEventListener(
+      mSearchIndexer->evIndexUpdatedEvent,
+      std::bind_front(&KneeboardState::OnSearchIndexUpdatedEvent, this));
+  }
+  return mSearchIndexer.get();
+}
+
 std::shared_ptr<TabletInputAdapter> KneeboardState::GetTabletInputAdapter()
   const {
   return mTabletInput;
@@ -697,9 +785,38 @@ void KneeboardState::AcquireExclusiveResources() {
   StartTabletInput();
 
   mGameEventServer = GameEventServer::Create();
+  // Handler times are logged when a replay completes; timing every handler
+  // costs more than dispatching, so only do it for replays
+  if (_wgetenv(L"OPENKNEEBOARD_GAMEEVENT_REPLAY")) {
+    mGameEventDispatcher->SetHandlerTimingEnabled(true);
+  }
   AddEventListener(
     mGameEventServer->evGameEvent,
     std::bind_front(&KneeboardState::OnGameEvent, this));
+  AddEventListener(
+    mGameEventServer->evReplayCompletedEvent,
+    std::bind_front(&KneeboardState::OnGameEventReplayCompleted, this));
+}
+
+void KneeboardState::OnGameEventReplayCompleted(
+  const GameEventReplayStats& replay) {
+  dprintf(
+    "GameEvent replay complete: {} events in {}",
+    replay.mEventCount,
+    std::chrono::duration_cast<std::chrono::milliseconds>(replay.mWallTime));
+  for (const auto& handler: mGameEventDispatcher->GetHandlerStats()) {
+    if (handler.mCallCount == 0) {
+      continue;
+    }
+    dprintf(
+      "- {} ({}): {} calls, {} total, {} max",
+      handler.mEventName.empty() ? "*" : handler.mEventName,
+      handler.mSubscribedFrom,
+      handler.mCallCount,
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        handler.mTotalTime),
+      std::chrono::duration_cast<std::chrono::microseconds>(handler.mMaxTime));
+  }
 }
 
 void KneeboardState::SwitchProfile(Direction direction) {
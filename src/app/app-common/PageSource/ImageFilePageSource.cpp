@@ -17,13 +17,18 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
  * USA.
  */
+#include <OpenKneeboard/D2DErrorRenderer.h>
+#include <OpenKneeboard/ImageDecodePool.h>
 #include <OpenKneeboard/ImageFilePageSource.h>
 
+#include <OpenKneeboard/config.h>
 #include <OpenKneeboard/dprint.h>
 
 #include <winrt/Windows.Foundation.Collections.h>
 #include <winrt/Windows.Foundation.h>
 
+#include <algorithm>
+#include <cmath>
 #include <ranges>
 
 #include <wincodec.h>
@@ -43,6 +48,9 @@ ImageFilePageSource::ImageFilePageSource(const DXResources& dxr) : mDXR(dxr) {
 
 void ImageFilePageSource::SetPaths(
   const std::vector<std::filesystem::path>& paths) {
+  std::unique_lock lock(mMutex);
+  this->CancelDecodes();
+  mWantedDecodes.clear();
   mPages.clear();
   mPages.reserve(paths.size());
   for (const auto& path: paths) {
@@ -64,16 +72,25 @@ void ImageFilePageSource::SetPaths(
 }
 
 void ImageFilePageSource::OnFileModified(const std::filesystem::path& path) {
-  auto it = std::ranges::find_if(
-    mPages, [&path](auto& page) { return page.mPath == path; });
-  if (it == mPages.end()) {
-    return;
-  }
-  if (std::filesystem::exists(path)) {
-    it->mBitmap = {};
-    it->mID = {};
-  } else {
-    mPages.erase(it);
+  {
+    std::unique_lock lock(mMutex);
+    auto it = std::ranges::find_if(
+      mPages, [&path](auto& page) { return page.mPath == path; });
+    if (it == mPages.end()) {
+      return;
+    }
+    const auto key = it->mID.GetTemporaryValue();
+    if (mPendingDecodes.erase(key)) {
+      mDXR.mImageDecodePool->Cancel(key);
+    }
+    if (std::filesystem::exists(path)) {
+      it->mBitmap = {};
+      it->mNativeSize = {};
+      it->mDecodeFailed = false;
+      it->mID = {};
+    } else {
+      mPages.erase(it);
+    }
   }
   this->evContentChangedEvent.Emit();
 }
@@ -86,6 +103,8 @@ std::vector<std::filesystem::path> ImageFilePageSource::GetPaths() const {
 
 ImageFilePageSource::~ImageFilePageSource() {
   this->RemoveAllEventListeners();
+  std::unique_lock lock(mMutex);
+  this->CancelDecodes();
 }
 
 bool ImageFilePageSource::CanOpenFile(const std::filesystem::path& path) const {
@@ -122,21 +141,50 @@ std::vector<PageID> ImageFilePageSource::GetPageIDs() const {
 }
 
 D2D1_SIZE_U ImageFilePageSource::GetNativeContentSize(PageID pageID) {
-  auto bitmap = GetPageBitmap(pageID);
-  if (!bitmap) {
+  std::unique_lock lock(mMutex);
+  auto it = std::ranges::find_if(
+    mPages, [pageID](const auto& page) { return page.mID == pageID; });
+  if (it == mPages.end()) [[unlikely]] {
     return {};
   }
 
-  return bitmap->GetPixelSize();
+  // Only reads the header, so this is cheap enough to do synchronously
+  auto& page = *it;
+  if (!page.mNativeSize) {
+    page.mNativeSize
+      = mDXR.mImageDecodePool->GetDecoder()->ReadSize(page.mPath);
+    if (!page.mNativeSize) {
+      return {};
+    }
+  }
+  return {page.mNativeSize->mWidth, page.mNativeSize->mHeight};
 }
 
 void ImageFilePageSource::RenderPage(
-  RenderTargetID,
+  RenderTargetID renderTarget,
   ID2D1DeviceContext* ctx,
   PageID pageID,
   const D2D1_RECT_F& rect) {
-  auto bitmap = GetPageBitmap(pageID);
+  // Usually the kneeboard texture, but we might be drawing somewhere larger,
+  // e.g. a maximized window on a high-DPI display
+  const auto roundUp = [](float size) {
+    const auto pixels = static_cast<uint32_t>(std::ceil(std::max(size, 0.0f)));
+    return ((pixels + DecodeBoundsGranularity - 1) / DecodeBoundsGranularity)
+      * DecodeBoundsGranularity;
+  };
+  const ImageSize bounds {
+    std::max(TextureWidth, roundUp(rect.right - rect.left)),
+    std::max(TextureHeight, roundUp(rect.bottom - rect.top)),
+  };
+
+  auto bitmap = GetPageBitmap(renderTarget, pageID, bounds);
   if (!bitmap) {
+    std::unique_lock lock(mMutex);
+    auto it = std::ranges::find_if(
+      mPages, [pageID](const auto& page) { return page.mID == pageID; });
+    if (it != mPages.end() && !it->mDecodeFailed) {
+      D2DErrorRenderer(mDXR).Render(ctx, _("Loading..."), rect);
+    }
     return;
   }
   const auto pageSize = bitmap->GetPixelSize();
@@ -160,7 +208,10 @@ void ImageFilePageSource::RenderPage(
     D2D1_INTERPOLATION_MODE_ANISOTROPIC);
 }
 
-winrt::com_ptr<ID2D1Bitmap> ImageFilePageSource::GetPageBitmap(PageID pageID) {
+winrt::com_ptr<ID2D1Bitmap> ImageFilePageSource::GetPageBitmap(
+  RenderTargetID renderTarget,
+  PageID pageID,
+  const ImageSize& bounds) {
   std::unique_lock lock(mMutex);
   auto it = std::ranges::find_if(
     mPages, [pageID](const auto& page) { return page.mID == pageID; });
@@ -168,89 +219,179 @@ winrt::com_ptr<ID2D1Bitmap> ImageFilePageSource::GetPageBitmap(PageID pageID) {
     return {};
   }
 
-  auto& page = *it;
-  if (page.mBitmap) [[likely]] {
-    return page.mBitmap;
+  // Even if we already have this page, the user may be about to move to the
+  // next one
+  this->RequestDecodes(
+    renderTarget, static_cast<PageIndex>(it - mPages.begin()), bounds);
+  return it->mBitmap;
+}
+
+bool ImageFilePageSource::NeedsDecode(
+  const Page& page,
+  const ImageSize& bounds) {
+  if (page.mDecodeFailed) {
+    return false;
+  }
+  if (!(page.mBitmap && page.mNativeSize)) {
+    return true;
   }
+  // Only decode at a higher resolution if we're going to draw it larger
+  const auto wanted = ScaleToFit(*page.mNativeSize, bounds);
+  const auto size = page.mBitmap->GetPixelSize();
+  return size.width < wanted.mWidth || size.height < wanted.mHeight;
+}
 
-  winrt::com_ptr<IWICBitmapDecoder> decoder;
+void ImageFilePageSource::RequestDecodes(
+  RenderTargetID renderTarget,
+  PageIndex current,
+  const ImageSize& bounds) {
+  const auto first = current - std::min(current, PrefetchDistance);
+  const auto last = std::min<PageIndex>(
+    current + PrefetchDistance, static_cast<PageIndex>(mPages.size() - 1));
+
+  // Priorities are distances from the current page; nearest first
+  auto& wanted = mWantedDecodes[renderTarget];
+  wanted.clear();
+  for (auto i = first; i <= last; ++i) {
+    const auto& page = mPages.at(i);
+    if (!NeedsDecode(page, bounds)) {
+      continue;
+    }
+    const auto key = page.mID.GetTemporaryValue();
+    wanted[key] = static_cast<int>(i > current ? i - current : current - i);
+  }
 
-  const auto wic = mDXR.mWIC.get();
+  // Stop decoding pages we've flipped away from, so they don't delay the
+  // page that's actually visible - unless another view is showing them, or
+  // is about to
+  std::unordered_set<uint64_t> keep;
+  for (const auto& [otherTarget, otherWanted]: mWantedDecodes) {
+    for (const auto& [key, priority]: otherWanted) {
+      keep.insert(key);
+    }
+  }
+  this->CancelDecodes(keep);
 
-  auto path = page.mPath.wstring();
-  wic->CreateDecoderFromFilename(
-    path.c_str(),
-    nullptr,
-    GENERIC_READ,
-    WICDecodeMetadataCacheOnLoad,
-    decoder.put());
-  if (!decoder) {
-    return {};
+  auto& pool = *mDXR.mImageDecodePool;
+  for (auto i = first; i <= last; ++i) {
+    const auto& page = mPages.at(i);
+    const auto key = page.mID.GetTemporaryValue();
+    if (!wanted.contains(key)) {
+      continue;
+    }
+    mPendingDecodes.insert(key);
+    // If it's already queued, this just updates the priority; use the
+    // highest priority any render target wants it at, so they don't fight
+    int priority = wanted.at(key);
+    for (const auto& [otherTarget, otherWanted]: mWantedDecodes) {
+      if (const auto it = otherWanted.find(key); it != otherWanted.end()) {
+        priority = std::min(priority, it->second);
+      }
+    }
+    pool.Request(
+      key,
+      page.mPath,
+      bounds,
+      priority,
+      [weak = weak_from_this(), uiThread = mUIThread, id = page.mID](
+        std::optional<DecodedImage> image) {
+        OnPageDecoded(weak, uiThread, id, std::move(image));
+      });
   }
+  this->ForgetCompletedRenderTargets();
+}
 
-  winrt::com_ptr<IWICBitmapFrameDecode> frame;
-  decoder->GetFrame(0, frame.put());
-  if (!frame) {
-    return {};
+void ImageFilePageSource::ForgetCompletedRenderTargets() {
+  // Render targets can go away without telling us; drop them once nothing
+  // they asked for is still pending, so this doesn't grow without bound
+  std::erase_if(mWantedDecodes, [this](const auto& it) {
+    return std::ranges::none_of(it.second, [this](const auto& wanted) {
+      return mPendingDecodes.contains(wanted.first);
+    });
+  });
+}
+
+void ImageFilePageSource::CancelDecodes(
+  const std::unordered_set<uint64_t>& keep) {
+  std::unordered_set<uint64_t> cancel;
+  for (const auto key: mPendingDecodes) {
+    if (!keep.contains(key)) {
+      cancel.insert(key);
+    }
+  }
+  if (cancel.empty()) {
+    return;
   }
+  mDXR.mImageDecodePool->CancelIf(
+    [&cancel](uint64_t key) { return cancel.contains(key); });
+  std::erase_if(
+    mPendingDecodes, [&cancel](uint64_t key) { return cancel.contains(key); });
+}
 
-  winrt::com_ptr<IWICFormatConverter> converter;
-  wic->CreateFormatConverter(converter.put());
-  if (!converter) {
-    return {};
+winrt::fire_and_forget ImageFilePageSource::OnPageDecoded(
+  std::weak_ptr<ImageFilePageSource> weak,
+  winrt::apartment_context uiThread,
+  PageID pageID,
+  std::optional<DecodedImage> image) {
+  co_await uiThread;
+  auto self = weak.lock();
+  if (!self) {
+    co_return;
   }
-  converter->Initialize(
-    frame.get(),
-    GUID_WICPixelFormat32bppPBGRA,
-    WICBitmapDitherTypeNone,
-    nullptr,
-    0.0f,
-    WICBitmapPaletteTypeMedianCut);
-
-  /* `CreateBitmapFromWicBitmap` creates a Direct2D bitmap that refers to
-   * - and retains a reference to - the existing WIC bitmap.
-   *
-   * This means that Direct2D/Direct3D indirectly keep a reference to an
-   * object that keeps an open file alive; releasing the internal references
-   * is not enough to close the file - we need to also wait for Direct2D/3D to
-   * finish.
-   *
-   * This is problematic if this `FolderTab` is pointing at a temporary folder
-   * if we later want to delete the temporary folder: even after calling
-   * `SetPath({})`, DirectX may still hold references to the Direct2D bitmap,
-   * and in turn the WIC bitmap and open file.
-   *
-   * The simplest way to deal with this problem is to do an immediate on-GPU
-   * copy of the pixel data from the WIC-referencing bitmap to an independent
-   * bitmap - then the WIC bitmap can immediately be freed, and is never
-   * referenced (or kept alive) by the D3D11 render pipeline.
-   */
-  winrt::com_ptr<ID2D1Bitmap> sharedBitmap;
-  winrt::com_ptr<ID2D1DeviceContext> ctx;
-  winrt::check_hresult(mDXR.mD2DDevice->CreateDeviceContext(
-    D2D1_DEVICE_CONTEXT_OPTIONS_NONE, ctx.put()));
+  self->SetPageImage(pageID, std::move(image));
+  self->evNeedsRepaintEvent.Emit();
+}
 
-  ctx->CreateBitmapFromWicBitmap(converter.get(), sharedBitmap.put());
-  if (!sharedBitmap) {
-    return {};
+void ImageFilePageSource::SetPageImage(
+  PageID pageID,
+  std::optional<DecodedImage> image) {
+  std::unique_lock lock(mMutex);
+  mPendingDecodes.erase(pageID.GetTemporaryValue());
+  this->ForgetCompletedRenderTargets();
+  auto it = std::ranges::find_if(
+    mPages, [pageID](const auto& page) { return page.mID == pageID; });
+  if (it == mPages.end()) {
+    // Modified or removed since the decode was requested
+    return;
+  }
+
+  auto& page = *it;
+  if (!image) {
+    page.mDecodeFailed = true;
+    return;
+  }
+  page.mNativeSize = image->mNativeSize;
+  if (page.mBitmap) {
+    // Keep a higher-resolution bitmap if we already have one
+    const auto size = page.mBitmap->GetPixelSize();
+    if (size.width >= image->mSize.mWidth) {
+      return;
+    }
   }
 
-  winrt::check_hresult(ctx->CreateBitmap(
-    sharedBitmap->GetPixelSize(),
+  // Copy the pixels into a bitmap owned by Direct2D, rather than referencing
+  // a WIC bitmap; this means that we never keep the file open, so the user
+  // can modify it, or delete its folder.
+  winrt::com_ptr<ID2D1DeviceContext> ctx;
+  winrt::check_hresult(mDXR.mD2DDevice->CreateDeviceContext(
+    D2D1_DEVICE_CONTEXT_OPTIONS_NONE, ctx.put()));
+  winrt::com_ptr<ID2D1Bitmap> bitmap;
+  ctx->CreateBitmap(
+    {image->mSize.mWidth, image->mSize.mHeight},
+    image->mPixels.data(),
+    static_cast<UINT32>(image->GetStride()),
     D2D1_BITMAP_PROPERTIES {
       .pixelFormat = {
         .format = DXGI_FORMAT_B8G8R8A8_UNORM,
         .alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED,
       },
     },
-    page.mBitmap.put()));
-
-  if (!page.mBitmap) {
-    return {};
+    bitmap.put());
+  if (!bitmap) {
+    page.mDecodeFailed = true;
+    return;
   }
-  page.mBitmap->CopyFromBitmap(nullptr, sharedBitmap.get(), nullptr);
-
-  return page.mBitmap;
+  page.mBitmap = std::move(bitmap);
 }
 
 bool ImageFilePageSource::IsNavigationAvailable() const {
@@ -22,12 +22,17 @@
 #include <OpenKneeboard/CursorEvent.h>
 #include <OpenKneeboard/DXResources.h>
 #include <OpenKneeboard/DoodleRenderer.h>
+#include <OpenKneeboard/FileSnapshot.h>
 #include <OpenKneeboard/Filesystem.h>
 #include <OpenKneeboard/FilesystemWatcher.h>
 #include <OpenKneeboard/LaunchURI.h>
 #include <OpenKneeboard/NavigationTab.h>
 #include <OpenKneeboard/PDFFilePageSource.h>
 #include <OpenKneeboard/PDFNavigation.h>
+#include <OpenKneeboard/PDFNavigationCache.h>
+#include <OpenKneeboard/PageImageCache.h>
+#include <OpenKneeboard/PagePrefetchQueue.h>
+#include <OpenKneeboard/RasterCache.h>
 #include <OpenKneeboard/RuntimeFiles.h>
 
 #include <OpenKneeboard/config.h>
@@ -41,7 +46,7 @@
 #include <winrt/Microsoft.UI.Dispatching.h>
 #include <winrt/Windows.Data.Pdf.h>
 #include <winrt/Windows.Foundation.h>
-#include <winrt/Windows.Storage.h>
+#include <winrt/Windows.Storage.Streams.h>
 
 #include <wil/cppwinrt.h>
 #include <wil/cppwinrt_helpers.h>
@@ -50,29 +55,146 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <iterator>
+#include <map>
 #include <mutex>
 #include <random>
 #include <shared_mutex>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
 
 #include <inttypes.h>
 
 using namespace winrt::Windows::Data::Pdf;
 using namespace winrt::Windows::Foundation;
-using namespace winrt::Windows::Storage;
+using namespace winrt::Windows::Storage::Streams;
 
 namespace OpenKneeboard {
 
+namespace {
+
+/** A read-only stream over a file, for `PdfDocument`.
+ *
+ * `PdfDocument` reads the parts of the file it needs as pages are rendered;
+ * reading those from the file keeps a large PDF out of memory for as long as
+ * its tab is open. The file is only open during each read, so the user can
+ * still save changes; once they do, reads fail until the watcher reloads
+ * the tab.
+ */
+class FileStream final
+  : public winrt::implements<FileStream, IRandomAccessStream> {
+ public:
+  FileStream(
+    std::shared_ptr<const FileRangeReader> reader,
+    uint64_t position = 0)
+    : mReader(std::move(reader)), mPosition(position) {
+  }
+
+  uint64_t Size() const {
+    return mReader ? mReader->GetIdentity().mSize : 0;
+  }
+
+  void Size(uint64_t) {
+    throw winrt::hresult_access_denied();
+  }
+
+  uint64_t Position() const {
+    return mPosition;
+  }
+
+  void Seek(uint64_t position) {
+    mPosition = position;
+  }
+
+  bool CanRead() const {
+    return static_cast<bool>(mReader);
+  }
+
+  bool CanWrite() const {
+    return false;
+  }
+
+  IInputStream GetInputStreamAt(uint64_t position) const {
+    return winrt::make<FileStream>(mReader, position);
+  }
+
+  IOutputStream GetOutputStreamAt(uint64_t) const {
+    throw winrt::hresult_access_denied();
+  }
+
+  IRandomAccessStream CloneStream() const {
+    return winrt::make<FileStream>(mReader);
+  }
+
+  IAsyncOperationWithProgress<IBuffer, uint32_t>
+  ReadAsync(IBuffer buffer, uint32_t count, InputStreamOptions) {
+    if (!mReader) {
+      throw winrt::hresult_error(RO_E_CLOSED);
+    }
+    const auto length = std::min(count, buffer.Capacity());
+    const auto bytesRead = mReader->ReadAt(
+      mPosition, {reinterpret_cast<std::byte*>(buffer.data()), length});
+    if (!bytesRead) {
+      throw winrt::hresult_error(E_CHANGED_STATE);
+    }
+    buffer.Length(static_cast<uint32_t>(*bytesRead));
+    mPosition += *bytesRead;
+    co_return buffer;
+  }
+
+  IAsyncOperationWithProgress<uint32_t, uint32_t> WriteAsync(IBuffer) {
+    throw winrt::hresult_access_denied();
+  }
+
+  IAsyncOperation<bool> FlushAsync() {
+    throw winrt::hresult_access_denied();
+  }
+
+  void Close() {
+    mReader = {};
+  }
+
+ private:
+  std::shared_ptr<const FileRangeReader> mReader;
+  uint64_t mPosition {};
+};
+
+void LogPDFDiagnostic(std::string_view message) {
+  dprint(message);
+}
+
+/// A `PDFNavigation::Link`, with its rect as `CursorClickableRegions` wants
+struct LinkRegion final {
+  D2D1_RECT_F mRect;
+  PDFNavigation::Link mLink;
+
+  bool operator==(const LinkRegion& other) const noexcept {
+    return mLink == other.mLink;
+  }
+};
+
+}// namespace
+
 struct PDFFilePageSource::Impl final {
-  using LinkHandler = CursorClickableRegions<PDFNavigation::Link>;
+  using LinkHandler = CursorClickableRegions<LinkRegion>;
 
   DXResources mDXR;
   std::filesystem::path mPath;
-  std::shared_ptr<Filesystem::TemporaryCopy> mCopy;
+  // Serializes reading the file and deciding whether it has changed
+  std::mutex mReloadMutex;
+  FileChangeDetector mFileChanges;
+  // The version that's currently loaded
+  std::optional<FileIdentity> mIdentity;
+  // Reads `mIdentity` on demand, e.g. for search
+  std::shared_ptr<FileRangeReader> mReader;
+  // The version `mPDFDocument` came from; lags behind `mIdentity` while the
+  // new version is being parsed
+  std::optional<FileIdentity> mDocumentIdentity;
 
   PdfDocument mPDFDocument {nullptr};
   winrt::com_ptr<IPdfRendererNative> mPDFRenderer;
@@ -81,16 +203,72 @@ struct PDFFilePageSource::Impl final {
 
   std::vector<NavigationEntry> mBookmarks;
   std::unordered_map<PageID, std::shared_ptr<LinkHandler>> mLinks;
+  // Set while links are being extracted in the background; pages are
+  // extracted on demand until that finishes
+  std::shared_ptr<PDFNavigation::PDF> mLinkSource;
+  // Pages queued for on-demand extraction from `mLinkSource`
+  PagePrefetchQueue<PageID> mLinkQueue;
+  uint64_t mNavigationGeneration {0};
 
   bool mNavigationLoaded = false;
 
-  std::unordered_map<RenderTargetID, std::unique_ptr<CachedLayer>> mCache;
+  // Shared by all render targets
+  std::unique_ptr<CachedLayer> mCache;
   std::unique_ptr<DoodleRenderer> mDoodles;
   std::shared_ptr<FilesystemWatcher> mWatcher;
 
   std::vector<PageID> mPageIDs;
 
   std::shared_mutex mMutex;
+
+  std::shared_ptr<LinkHandler> GetLinkHandler(PageID);
+
+  // Readbacks started by `StoreRenderedPage()` that haven't been queued
+  // for the `PageImageCache` yet; each holds a copy of the page in memory
+  std::atomic<size_t> mPendingPageStores {0};
+  static constexpr size_t MaxPendingPageStores = 4;
+
+  /** A page that `LoadCachedPage()` is reading from the `PageImageCache`.
+   *
+   * Once finished, `mImage` holds the page until it's drawn, or is empty if
+   * the page isn't in the cache.
+   */
+  struct CachedPageLoad {
+    bool mFinished {false};
+    std::optional<DecodedImage> mImage;
+  };
+  // Content hash, page, width, height; like the `RasterCache` key
+  using CachedPageLoadKey = std::tuple<uint64_t, uint64_t, uint32_t, uint32_t>;
+  std::mutex mCachedPageLoadsMutex;
+  std::map<CachedPageLoadKey, CachedPageLoad> mCachedPageLoads;
+  // Finished loads are dropped past this, e.g. if the page was turned again
+  // before they were drawn
+  static constexpr size_t MaxCachedPageLoads = 8;
+
+  static CachedPageLoadKey GetCachedPageLoadKey(const PageImageKey&);
+  /// Takes the image from a finished `LoadCachedPage()`
+  std::optional<DecodedImage> TakeCachedPage(const PageImageKey&);
+
+  std::optional<PageImageKey> GetPageImageKey(PageID, const D2D1_SIZE_U&);
+  /// Caller must hold a lock on `mMutex`
+  std::optional<PageImageKey> GetPageImageKeyLocked(
+    PageID,
+    const D2D1_SIZE_U&) const;
+  /// Returns false if `LoadCachedPage()` didn't find the page
+  bool RenderCachedPage(ID2D1DeviceContext*, PageID, const D2D1_SIZE_U&);
+  /** Call after rendering the page to `ctx`, with nothing else on top.
+   *
+   * Only queues a GPU copy on this thread; the copy is read back and
+   * stored on a background thread.
+   */
+  static void StoreRenderedPage(
+    const std::shared_ptr<Impl>&,
+    ID2D1DeviceContext*,
+    PageImageKey);
+  static winrt::fire_and_forget ReadBackRenderedPage(
+    std::shared_ptr<Impl>,
+    winrt::com_ptr<ID2D1Bitmap1>,
+    PageImageKey);
 };
 
 PDFFilePageSource::PDFFilePageSource(
@@ -98,6 +276,7 @@ PDFFilePageSource::PDFFilePageSource(
   KneeboardState* kbs)
   : p(new Impl {.mDXR = dxr}) {
   const std::unique_lock d2dLock(p->mDXR);
+  p->mCache = std::make_unique<CachedLayer>(dxr);
   p->mPDFRenderer = dxr.mPDFRenderer;
   p->mBackgroundBrush = dxr.mWhiteBrush;
   p->mHighlightBrush = dxr.mHighlightBrush;
@@ -149,7 +328,8 @@ std::shared_ptr<PDFFilePageSource> PDFFilePageSource::Create(
   return ret;
 }
 
-winrt::fire_and_forget PDFFilePageSource::ReloadRenderer() {
+winrt::fire_and_forget PDFFilePageSource::ReloadRenderer(
+  std::shared_ptr<FileRangeReader> reader) {
   auto weak = weak_from_this();
   auto uiThread = mUIThread;
 
@@ -159,22 +339,21 @@ winrt::fire_and_forget PDFFilePageSource::ReloadRenderer() {
       co_return;
     }
 
-    std::filesystem::path path;
-    {
-      std::shared_lock readLock(p->mMutex);
-      path = p->mCopy->GetPath();
-
-      if (!std::filesystem::is_regular_file(path)) {
-        co_return;
-      }
-    }
+    // Not `StorageFile`, as that would hold the file open, and stop the user
+    // saving changes to it
+    const auto identity = reader->GetIdentity();
+    const auto stream = winrt::make<FileStream>(std::move(reader));
 
-    auto file = co_await StorageFile::GetFileFromPathAsync(path.wstring());
-    auto document = co_await PdfDocument::LoadFromFileAsync(file);
+    auto document = co_await PdfDocument::LoadFromStreamAsync(stream);
 
     {
       std::unique_lock lock(p->mMutex);
+      if (p->mDocumentIdentity) {
+        // Stop any renders of the previous version from being cached
+        p->mDXR.mRasterCache->EraseSource(p->mDocumentIdentity->mContentHash);
+      }
       p->mPDFDocument = std::move(document);
+      p->mDocumentIdentity = identity;
       p->mPageIDs.resize(p->mPDFDocument.PageCount());
     }
   }
@@ -185,12 +364,15 @@ winrt::fire_and_forget PDFFilePageSource::ReloadRenderer() {
   }
 }
 
-winrt::fire_and_forget PDFFilePageSource::ReloadNavigation() {
+winrt::fire_and_forget PDFFilePageSource::ReloadNavigation(
+  std::shared_ptr<FileRangeReader> reader) {
   auto uiThread = mUIThread;
   auto weak = weak_from_this();
 
-  if (!std::filesystem::is_regular_file(p->mCopy->GetPath())) {
-    co_return;
+  uint64_t generation {};
+  {
+    std::shared_lock lock(p->mMutex);
+    generation = p->mNavigationGeneration;
   }
 
   co_await winrt::resume_background();
@@ -199,57 +381,114 @@ winrt::fire_and_forget PDFFilePageSource::ReloadNavigation() {
     co_return;
   }
 
-  std::filesystem::path path;
-  {
-    std::shared_lock lock(p->mMutex);
-    path = p->mCopy->GetPath();
+  const auto identity = reader->GetIdentity();
+  const PDFNavigation::NavigationCache cache(
+    Filesystem::GetCacheDirectory() / "PDFNavigation");
+  auto navigation = cache.Load(identity);
+
+  std::shared_ptr<PDFNavigation::PDF> pdf;
+  if (!navigation) {
+    // The parser needs a copy of the whole file; it's only kept until
+    // every page's links have been extracted and cached
+    auto snapshot = reader->ReadSnapshot();
+    if (!snapshot) {
+      // Changed since we hashed it; the watcher will reload
+      co_return;
+    }
+    pdf = std::make_shared<PDFNavigation::PDF>(
+      std::move(snapshot), &LogPDFDiagnostic);
+    navigation = PDFNavigation::Navigation {
+      .mBookmarks = pdf->GetBookmarks(),
+    };
   }
-  PDFNavigation::PDF pdf(path);
-  const auto bookmarks = pdf.GetBookmarks();
-  decltype(p->mBookmarks) navigation;
+  reader = {};
+
+  const auto& bookmarks = navigation->mBookmarks;
+  decltype(p->mBookmarks) entries;
   for (int i = 0; i < bookmarks.size(); i++) {
     const auto& it = bookmarks[i];
-    navigation.push_back({it.mName, this->GetPageIDForIndex(it.mPageIndex)});
+    entries.push_back({it.mName, this->GetPageIDForIndex(it.mPageIndex)});
   }
 
   {
     std::unique_lock lock(p->mMutex);
-    p->mBookmarks = std::move(navigation);
+    if (p->mNavigationGeneration != generation) {
+      co_return;
+    }
+    p->mBookmarks = std::move(entries);
     p->mNavigationLoaded = true;
+    p->mLinkSource = pdf;
   }
 
-  const auto links = pdf.GetLinks();
-  decltype(p->mLinks) linkHandlers;
-  for (int i = 0; i < links.size(); ++i) {
-    const auto& pageLinks = links.at(i);
-    auto handler = Impl::LinkHandler::Create(pageLinks);
-    AddEventListener(
-      handler->evClicked,
-      [weak](EventContext ctx, const PDFNavigation::Link& link) {
-        auto self = weak.lock();
-        if (!self) {
-          return;
-        }
-        const auto& dest = link.mDestination;
-        switch (dest.mType) {
-          case PDFNavigation::DestinationType::Page:
-            self->evPageChangeRequestedEvent.Emit(
-              ctx, self->GetPageIDForIndex(dest.mPageIndex));
-            break;
-          case PDFNavigation::DestinationType::URI: {
-            [=]() -> winrt::fire_and_forget {
-              co_await LaunchURI(dest.mURI);
-            }();
-            break;
+  if (pdf) {
+    // Bookmarks are usable now; extracting every page's links can take a
+    // while, and pages are extracted on demand in the mean time.
+    stayingAlive.reset();
+    co_await uiThread;
+    if (!(stayingAlive = weak.lock())) {
+      co_return;
+    }
+    this->evAvailableFeaturesChangedEvent.Emit();
+    stayingAlive.reset();
+    co_await winrt::resume_background();
+
+    // Every page's links, for the cache. This is only for later loads of
+    // the same file, so it's a page at a time, at background priority,
+    // and stops if the tab is closed or reloaded. Pages already extracted
+    // on demand are reused.
+    std::vector<std::vector<PDFNavigation::Link>> allLinks;
+    {
+      SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+      const scope_guard restorePriority([]() {
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+      });
+      const auto pageCount = pdf->GetPageCount();
+      allLinks.reserve(pageCount);
+      for (PageIndex i = 0; i < pageCount; ++i) {
+        {
+          const auto self = weak.lock();
+          if (!self) {
+            co_return;
+          }
+          std::shared_lock lock(p->mMutex);
+          if (p->mNavigationGeneration != generation) {
+            co_return;
           }
         }
-      });
-    linkHandlers[this->GetPageIDForIndex(i)] = handler;
+        allLinks.push_back(pdf->GetLinks(i));
+      }
+    }
+    navigation->mLinks = std::move(allLinks);
+    cache.Store(identity, *navigation);
+    if (!(stayingAlive = weak.lock())) {
+      co_return;
+    }
+  }
+
+  const auto& links = navigation->mLinks;
+  std::vector<PageID> pageIDs;
+  pageIDs.reserve(links.size());
+  for (PageIndex i = 0; i < links.size(); ++i) {
+    pageIDs.push_back(this->GetPageIDForIndex(i));
   }
 
   {
     std::unique_lock lock(p->mMutex);
-    p->mLinks = std::move(linkHandlers);
+    if (p->mNavigationGeneration != generation) {
+      co_return;
+    }
+    for (PageIndex i = 0; i < links.size(); ++i) {
+      if (!p->mLinks.contains(pageIDs.at(i))) {
+        this->AddLinkHandler(pageIDs.at(i), links.at(i));
+      }
+    }
+    // Every page's links are extracted, so the parser and its copy of the
+    // file aren't needed any more
+    p->mLinkSource = {};
+  }
+
+  if (pdf) {
+    co_return;
   }
 
   stayingAlive.reset();
@@ -259,6 +498,310 @@ winrt::fire_and_forget PDFFilePageSource::ReloadNavigation() {
   }
 }
 
+void PDFFilePageSource::AddLinkHandler(
+  PageID pageID,
+  const std::vector<PDFNavigation::Link>& links) {
+  std::vector<LinkRegion> regions;
+  regions.reserve(links.size());
+  for (const auto& link: links) {
+    const auto& [left, top, right, bottom] = link.mRect;
+    regions.push_back({{left, top, right, bottom}, link});
+  }
+
+  auto handler = Impl::LinkHandler::Create(regions);
+  AddEventListener(
+    handler->evClicked,
+    [weak = weak_from_this()](EventContext ctx, const LinkRegion& region) {
+      auto self = weak.lock();
+      if (!self) {
+        return;
+      }
+      const auto& dest = region.mLink.mDestination;
+      switch (dest.mType) {
+        case PDFNavigation::DestinationType::Page:
+          self->evPageChangeRequestedEvent.Emit(
+            ctx, self->GetPageIDForIndex(dest.mPageIndex));
+          break;
+        case PDFNavigation::DestinationType::URI: {
+          [=]() -> winrt::fire_and_forget {
+            co_await LaunchURI(dest.mURI);
+          }();
+          break;
+        }
+      }
+    });
+  p->mLinks[pageID] = handler;
+}
+
+void PDFFilePageSource::PrefetchLinks(PageID pageID) {
+  {
+    std::shared_lock lock(p->mMutex);
+    // Called for every cursor event and frame, so keep the common case cheap
+    if (
+      !p->mLinkSource || p->mLinks.contains(pageID)
+      || p->mLinkQueue.IsPending(pageID)) {
+      return;
+    }
+  }
+
+  std::shared_ptr<PDFNavigation::PDF> source;
+  std::vector<PagePrefetchQueue<PageID>::Request> pages;
+  {
+    std::unique_lock lock(p->mMutex);
+    if (!p->mLinkSource) {
+      return;
+    }
+    const auto it = std::ranges::find(p->mPageIDs, pageID);
+    if (it == p->mPageIDs.end()) {
+      return;
+    }
+    // Readers usually move to an adjacent page next
+    pages = p->mLinkQueue.Claim(
+      p->mPageIDs,
+      static_cast<PageIndex>(it - p->mPageIDs.begin()),
+      [this](PageID id) { return p->mLinks.contains(id); });
+    source = p->mLinkSource;
+  }
+  if (pages.empty()) {
+    return;
+  }
+
+  // QPDF can take a while for complex pages; never block the UI or render
+  // threads on it
+  [](auto weak, auto source, auto pages) -> winrt::fire_and_forget {
+    co_await winrt::resume_background();
+    for (const auto& page: pages) {
+      const auto links = source->GetLinks(page.mPageIndex);
+      auto self = weak.lock();
+      if (!self) {
+        co_return;
+      }
+      std::unique_lock lock(self->p->mMutex);
+      // False if the file has been reloaded since
+      if (
+        !self->p->mLinkQueue.Complete(page)
+        || self->p->mLinks.contains(page.mPageID)) {
+        continue;
+      }
+      self->AddLinkHandler(page.mPageID, links);
+    }
+  }(weak_from_this(), std::move(source), std::move(pages));
+}
+
+std::shared_ptr<PDFFilePageSource::Impl::LinkHandler>
+PDFFilePageSource::Impl::GetLinkHandler(PageID pageID) {
+  std::shared_lock lock(mMutex);
+  const auto it = mLinks.find(pageID);
+  if (it == mLinks.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+std::optional<PageImageKey> PDFFilePageSource::Impl::GetPageImageKey(
+  PageID pageID,
+  const D2D1_SIZE_U& size) {
+  std::shared_lock lock(mMutex);
+  return this->GetPageImageKeyLocked(pageID, size);
+}
+
+std::optional<PageImageKey> PDFFilePageSource::Impl::GetPageImageKeyLocked(
+  PageID pageID,
+  const D2D1_SIZE_U& size) const {
+  if (!mDocumentIdentity) {
+    return {};
+  }
+  const auto it = std::ranges::find(mPageIDs, pageID);
+  if (it == mPageIDs.end()) {
+    return {};
+  }
+  return PageImageKey {
+    .mPath = mPath,
+    .mSource = *mDocumentIdentity,
+    .mPage = static_cast<uint64_t>(it - mPageIDs.begin()),
+    .mSize = {size.width, size.height},
+  };
+}
+
+PDFFilePageSource::Impl::CachedPageLoadKey
+PDFFilePageSource::Impl::GetCachedPageLoadKey(const PageImageKey& key) {
+  return {
+    key.mSource.mContentHash,
+    key.mPage,
+    key.mSize.mWidth,
+    key.mSize.mHeight,
+  };
+}
+
+std::optional<DecodedImage> PDFFilePageSource::Impl::TakeCachedPage(
+  const PageImageKey& key) {
+  std::unique_lock lock(mCachedPageLoadsMutex);
+  const auto it = mCachedPageLoads.find(GetCachedPageLoadKey(key));
+  if (it == mCachedPageLoads.end() || !it->second.mFinished) {
+    return {};
+  }
+  // If the bitmap is evicted from the `RasterCache`, the next render
+  // loads it again
+  auto ret = std::move(it->second.mImage);
+  mCachedPageLoads.erase(it);
+  return ret;
+}
+
+bool PDFFilePageSource::LoadCachedPage(const PageImageKey& key) {
+  {
+    std::unique_lock lock(p->mCachedPageLoadsMutex);
+    const auto loadKey = Impl::GetCachedPageLoadKey(key);
+    if (const auto it = p->mCachedPageLoads.find(loadKey);
+        it != p->mCachedPageLoads.end()) {
+      return it->second.mFinished;
+    }
+    // Render straight away instead of drawing a placeholder for a frame
+    if (!p->mDXR.mPageImageCache->MayContain(key)) {
+      return true;
+    }
+    if (p->mCachedPageLoads.size() >= Impl::MaxCachedPageLoads) {
+      std::erase_if(p->mCachedPageLoads, [](const auto& it) {
+        return it.second.mFinished;
+      });
+    }
+    p->mCachedPageLoads.emplace(loadKey, Impl::CachedPageLoad {});
+  }
+
+  // Reading and inflating a page takes tens of milliseconds, so keep it off
+  // the render thread
+  [](auto weak, auto uiThread, auto key) -> winrt::fire_and_forget {
+    co_await winrt::resume_background();
+    {
+      auto self = weak.lock();
+      if (!self) {
+        co_return;
+      }
+      auto image = self->p->mDXR.mPageImageCache->Load(key);
+      if (image && image->mSize != key.mSize) {
+        image = {};
+      }
+      std::unique_lock lock(self->p->mCachedPageLoadsMutex);
+      const auto it
+        = self->p->mCachedPageLoads.find(Impl::GetCachedPageLoadKey(key));
+      if (it == self->p->mCachedPageLoads.end()) {
+        // Reloaded since
+        co_return;
+      }
+      it->second = {.mFinished = true, .mImage = std::move(image)};
+    }
+
+    co_await uiThread;
+    if (auto self = weak.lock()) {
+      self->evNeedsRepaintEvent.Emit();
+    }
+  }(weak_from_this(), mUIThread, key);
+  return false;
+}
+
+bool PDFFilePageSource::Impl::RenderCachedPage(
+  ID2D1DeviceContext* ctx,
+  PageID pageID,
+  const D2D1_SIZE_U& size) {
+  const auto key = this->GetPageImageKey(pageID, size);
+  if (!key) {
+    return false;
+  }
+  const auto image = this->TakeCachedPage(*key);
+  if (!image) {
+    return false;
+  }
+
+  winrt::com_ptr<ID2D1Bitmap> bitmap;
+  ctx->CreateBitmap(
+    size,
+    image->mPixels.data(),
+    static_cast<UINT32>(image->GetStride()),
+    D2D1_BITMAP_PROPERTIES {
+      .pixelFormat = {
+        .format = DXGI_FORMAT_B8G8R8A8_UNORM,
+        .alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED,
+      },
+    },
+    bitmap.put());
+  if (!bitmap) {
+    return false;
+  }
+  ctx->DrawBitmap(bitmap.get());
+  return true;
+}
+
+void PDFFilePageSource::Impl::StoreRenderedPage(
+  const std::shared_ptr<Impl>& self,
+  ID2D1DeviceContext* ctx,
+  PageImageKey key) {
+  // Caching is opportunistic; if the disk or GPU is behind, the page will
+  // just be rendered again next time
+  if (self->mPendingPageStores >= MaxPendingPageStores) {
+    return;
+  }
+
+  winrt::com_ptr<ID2D1Image> target;
+  ctx->GetTarget(target.put());
+  const auto targetBitmap = target.try_as<ID2D1Bitmap1>();
+  if (!targetBitmap) {
+    return;
+  }
+
+  // Render targets can't be mapped, so copy to a bitmap that can be. This
+  // only queues the copy; mapping waits for the GPU to finish it, so that's
+  // left to a background thread rather than stalling the render.
+  D2D1_BITMAP_PROPERTIES1 props {
+    .pixelFormat = {DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED},
+    .bitmapOptions
+    = D2D1_BITMAP_OPTIONS_CPU_READ | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
+  };
+  const D2D1_SIZE_U size {key.mSize.mWidth, key.mSize.mHeight};
+  winrt::com_ptr<ID2D1Bitmap1> readable;
+  {
+    const std::unique_lock d2dLock(self->mDXR);
+    if (
+      FAILED(ctx->CreateBitmap(size, nullptr, 0, &props, readable.put()))
+      || FAILED(
+        readable->CopyFromBitmap(nullptr, targetBitmap.get(), nullptr))) {
+      return;
+    }
+  }
+  ++self->mPendingPageStores;
+  ReadBackRenderedPage(self, std::move(readable), std::move(key));
+}
+
+winrt::fire_and_forget PDFFilePageSource::Impl::ReadBackRenderedPage(
+  std::shared_ptr<Impl> self,
+  winrt::com_ptr<ID2D1Bitmap1> readable,
+  PageImageKey key) {
+  const scope_guard done([&self] { --self->mPendingPageStores; });
+  co_await winrt::resume_background();
+
+  DecodedImage image {
+    .mSize = key.mSize,
+    .mNativeSize = key.mSize,
+  };
+  const auto stride = image.GetStride();
+  image.mPixels.resize(stride * key.mSize.mHeight);
+  {
+    const std::unique_lock d2dLock(self->mDXR);
+    D2D1_MAPPED_RECT mapped {};
+    if (FAILED(readable->Map(D2D1_MAP_OPTIONS_READ, &mapped))) {
+      co_return;
+    }
+    const scope_guard unmap([&readable] { readable->Unmap(); });
+    for (uint32_t y = 0; y < key.mSize.mHeight; ++y) {
+      std::memcpy(
+        image.mPixels.data() + (y * stride),
+        mapped.bits + (y * mapped.pitch),
+        stride);
+    }
+  }
+  readable = nullptr;
+  self->mDXR.mPageImageCache->StoreInBackground(
+    std::move(key), std::move(image));
+}
+
 PageID PDFFilePageSource::GetPageIDForIndex(PageIndex index) const {
   if (!p) {
     return {};
@@ -275,46 +818,68 @@ PageID PDFFilePageSource::GetPageIDForIndex(PageIndex index) const {
 }
 
 winrt::fire_and_forget PDFFilePageSource::Reload() {
-  static uint64_t sCount = 0;
-  auto uiThread = mUIThread;
   auto weak = weak_from_this();
+  const auto path = p->mPath;
+
+  // Read in a background thread so we're not hung up on antivirus
+  co_await winrt::resume_background();
+
+  auto self = weak.lock();
+  if (!self) {
+    co_return;
+  }
 
+  std::shared_ptr<FileRangeReader> reader;
   {
-    auto self = weak.lock();
-    if (!self) {
+    const std::unique_lock reloadLock(p->mReloadMutex);
+    // File watchers usually fire several times per save
+    if (!p->mFileChanges.MayHaveChanged(path)) {
+      co_return;
+    }
+
+    reader = FileRangeReader::Open(path);
+    if (!reader) {
+      if (std::filesystem::is_regular_file(path)) {
+        // Still being written; we'll get another notification when it's done
+        dprintf(L"Couldn't get a consistent read of PDF {}", path.wstring());
+        co_return;
+      }
+      p->mFileChanges.Reset();
+    } else if (!p->mFileChanges.Commit(reader->GetIdentity())) {
+      // e.g. touched, or re-saved without changes
       co_return;
     }
 
     std::unique_lock lock(p->mMutex);
-    p->mCopy = {};
+    p->mIdentity.reset();
+    if (reader) {
+      p->mIdentity = reader->GetIdentity();
+    }
+    p->mReader = reader;
     p->mBookmarks.clear();
     p->mLinks.clear();
+    p->mLinkSource = {};
+    p->mLinkQueue.Reset();
+    ++p->mNavigationGeneration;
     p->mNavigationLoaded = false;
-    p->mCache.clear();
-    p->mPageIDs.clear();
-
-    if (!std::filesystem::is_regular_file(p->mPath)) {
-      co_return;
+    p->mCache->Reset();
+    if (p->mDocumentIdentity) {
+      // In-flight renders of these page IDs would now be blank
+      p->mDXR.mRasterCache->EraseSource(p->mDocumentIdentity->mContentHash);
     }
+    p->mPageIDs.clear();
+  }
+  {
+    std::unique_lock lock(p->mCachedPageLoadsMutex);
+    p->mCachedPageLoads.clear();
   }
 
-  // Do copy in a background thread so we're not hung up on antivirus
-  co_await winrt::resume_background();
-
-  auto self = weak.lock();
-  if (!self) {
+  if (!reader) {
     co_return;
   }
-  auto tempPath = Filesystem::GetTemporaryDirectory()
-    / std::format(L"{:08x}-{}{}",
-                  ++sCount,
-                  p->mPath.stem().wstring().substr(0, 16),
-                  p->mPath.extension());
-  p->mCopy = std::make_shared<Filesystem::TemporaryCopy>(p->mPath, tempPath);
 
-  this->ReloadRenderer();
-  this->ReloadNavigation();
-  co_await winrt::resume_after(std::chrono::seconds(10));
+  this->ReloadRenderer(reader);
+  this->ReloadNavigation(std::move(reader));
 }
 
 winrt::fire_and_forget PDFFilePageSource::final_release(
@@ -363,23 +928,29 @@ D2D1_SIZE_U PDFFilePageSource::GetNativeContentSize(PageID id) {
   return {static_cast<UINT32>(size.Width), static_cast<UINT32>(size.Height)};
 }
 
-void PDFFilePageSource::RenderPageContent(
+std::optional<PageImageKey> PDFFilePageSource::RenderPageContent(
   ID2D1DeviceContext* ctx,
   PageID id,
   const D2D1_RECT_F& rect) noexcept {
   // Keep alive
   auto p = this->p;
   if (!p) {
-    return;
+    return {};
   }
 
   std::shared_lock lock(p->mMutex);
 
   const auto pageIt = std::ranges::find(p->mPageIDs, id);
   if (pageIt == p->mPageIDs.end()) {
-    return;
+    return {};
   }
   const auto index = pageIt - p->mPageIDs.begin();
+  auto key = p->GetPageImageKeyLocked(
+    id,
+    {
+      static_cast<UINT32>(rect.right - rect.left),
+      static_cast<UINT32>(rect.bottom - rect.top),
+    });
 
   auto page = p->mPDFDocument.GetPage(index);
 
@@ -394,16 +965,28 @@ void PDFFilePageSource::RenderPageContent(
   scope_guard resetTransform(
     [ctx]() { ctx->SetTransform(D2D1::Matrix3x2F::Identity()); });
 
+  HRESULT result {};
   {
     const std::unique_lock d2dLock(p->mDXR);
-    winrt::check_hresult(p->mPDFRenderer->RenderPageToDeviceContext(
-      winrt::get_unknown(page), ctx, &params));
+    result = p->mPDFRenderer->RenderPageToDeviceContext(
+      winrt::get_unknown(page), ctx, &params);
   }
 
   // `RenderPageToDeviceContext()` starts a multi-threaded job, but needs
   // the `page` pointer to stay valid until it has finished - so, flush to
   // get everything in the direct2d queue done.
-  winrt::check_hresult(ctx->Flush());
+  const auto flushResult = ctx->Flush();
+  if (FAILED(result) || FAILED(flushResult)) {
+    // Usually because the file has changed since it was loaded, so the
+    // stream can't read it any more; the watcher will reload it. Don't
+    // store a partial render.
+    dprintf(
+      "Failed to render PDF page: {:#010x} {:#010x}",
+      static_cast<uint32_t>(result),
+      static_cast<uint32_t>(flushResult));
+    return {};
+  }
+  return key;
 }
 
 void PDFFilePageSource::PostCursorEvent(
@@ -412,13 +995,11 @@ void PDFFilePageSource::PostCursorEvent(
   PageID pageID) {
   const auto contentRect = this->GetNativeContentSize(pageID);
 
-  if (!p->mLinks.contains(pageID)) {
-    p->mDoodles->PostCursorEvent(ctx, ev, pageID, contentRect);
-    return;
-  }
-
-  auto links = p->mLinks.at(pageID);
+  this->PrefetchLinks(pageID);
+  // Links are ignored until they've been extracted
+  auto links = p->GetLinkHandler(pageID);
   if (!links) {
+    p->mDoodles->PostCursorEvent(ctx, ev, pageID, contentRect);
     return;
   }
 
@@ -457,10 +1038,11 @@ void PDFFilePageSource::RenderOverDoodles(
   ID2D1DeviceContext* ctx,
   PageID pageID,
   const D2D1_RECT_F& contentRect) {
-  if (!p->mLinks.contains(pageID)) {
+  const auto links = p->GetLinkHandler(pageID);
+  if (!links) {
     return;
   }
-  const auto hoverButton = p->mLinks.at(pageID)->GetHoverButton();
+  const auto hoverButton = links->GetHoverButton();
   if (!hoverButton) {
     return;
   }
@@ -490,6 +1072,10 @@ void PDFFilePageSource::SetPath(const std::filesystem::path& path) {
     return;
   }
   p->mPath = path;
+  {
+    const std::unique_lock reloadLock(p->mReloadMutex);
+    p->mFileChanges.Reset();
+  }
   p->mWatcher = FilesystemWatcher::Create(path);
   AddEventListener(
     p->mWatcher->evFilesystemModifiedEvent,
@@ -521,31 +1107,105 @@ std::vector<NavigationEntry> PDFFilePageSource::GetNavigationEntries() const {
   return entries;
 }
 
+std::optional<FileIdentity> PDFFilePageSource::GetSearchIdentity() const {
+  std::shared_lock lock(p->mMutex);
+  return p->mIdentity;
+}
+
+std::optional<std::vector<SearchPage>> PDFFilePageSource::GetSearchPages(
+  const FileIdentity& identity) const {
+  std::shared_ptr<FileRangeReader> reader;
+  {
+    std::shared_lock lock(p->mMutex);
+    reader = p->mReader;
+  }
+  if (!(reader && reader->GetIdentity().HasSameContent(identity))) {
+    return {};
+  }
+  // A temporary copy for the parser; indexing is rare, but PDFs can be large.
+  // The reader checks that the file still matches, so this doesn't need
+  // hashing again.
+  auto snapshot = reader->ReadSnapshot();
+  if (!snapshot) {
+    return {};
+  }
+
+  PDFNavigation::PDF pdf(std::move(snapshot), &LogPDFDiagnostic);
+  std::vector<SearchPage> pages;
+  pages.reserve(pdf.GetPageCount());
+  for (PageIndex i = 0; i < pdf.GetPageCount(); ++i) {
+    SearchPage page {
+      .mPageKey = this->GetPageIDForIndex(i).GetTemporaryValue(),
+    };
+    for (auto& line: pdf.GetText(i)) {
+      page.mBlocks.push_back({
+        std::move(line.mText),
+        {
+          line.mRect.left,
+          line.mRect.top,
+          line.mRect.right,
+          line.mRect.bottom,
+        },
+      });
+    }
+    pages.push_back(std::move(page));
+  }
+
+  // Reloaded while we were extracting; the page IDs may be stale
+  const auto current = this->GetSearchIdentity();
+  if (!(current && current->HasSameContent(identity))) {
+    return {};
+  }
+  return pages;
+}
+
 void PDFFilePageSource::RenderPage(
   RenderTargetID rtid,
   ID2D1DeviceContext* ctx,
   PageID pageID,
   const D2D1_RECT_F& rect) {
+  // Ready for the cursor, or for when the user turns the page
+  this->PrefetchLinks(pageID);
   const auto size = this->GetNativeContentSize(pageID);
-  if (!p->mCache.contains(rtid)) {
-    p->mCache[rtid] = std::make_unique<CachedLayer>(p->mDXR);
+  const auto render = [=](ID2D1DeviceContext* ctx, const D2D1_SIZE_U& size) {
+    // Rendering PDFs is much slower than loading a cached copy; this is
+    // mostly the first time a page is shown after launch. The copy was
+    // loaded in the background by `LoadCachedPage()`.
+    if (p->RenderCachedPage(ctx, pageID, size)) {
+      return;
+    }
+    auto key = this->RenderPageContent(
+      ctx,
+      pageID,
+      {
+        0.0f,
+        0.0f,
+        static_cast<FLOAT>(size.width),
+        static_cast<FLOAT>(size.height),
+      });
+    if (key) {
+      Impl::StoreRenderedPage(p, ctx, std::move(*key));
+    }
+  };
+  // Keyed by content where possible, so that other tabs with the same file
+  // share the bitmaps
+  if (const auto imageKey = p->GetPageImageKey(pageID, size)) {
+    const CachedLayer::SharedKey cacheKey {
+      .mSource = imageKey->mSource.mContentHash,
+      .mContent = imageKey->mPage,
+    };
+    if (p->mCache->RenderIfCached(rect, size, cacheKey, ctx)) {
+      // Already rendered, or drawn from the `PageImageCache`
+    } else if (this->LoadCachedPage(*imageKey)) {
+      p->mCache->Render(rect, size, cacheKey, ctx, render);
+    } else {
+      // Only while a read is pending; repainted when it finishes. Not drawn
+      // via `mCache`, so this isn't cached
+      ctx->FillRectangle(rect, p->mBackgroundBrush.get());
+    }
+  } else {
+    p->mCache->Render(rect, size, pageID.GetTemporaryValue(), ctx, render);
   }
-  p->mCache[rtid]->Render(
-    rect,
-    size,
-    pageID.GetTemporaryValue(),
-    ctx,
-    [=](auto ctx, const auto& size) {
-      this->RenderPageContent(
-        ctx,
-        pageID,
-        {
-          0.0f,
-          0.0f,
-          static_cast<FLOAT>(size.width),
-          static_cast<FLOAT>(size.height),
-        });
-    });
   p->mDoodles->Render(ctx, pageID, rect);
   this->RenderOverDoodles(ctx, pageID, rect);
 }
@@ -25,7 +25,9 @@
 #include <OpenKneeboard/scope_guard.h>
 
 #include <algorithm>
+#include <iterator>
 #include <numeric>
+#include <span>
 
 namespace OpenKneeboard {
 
@@ -33,6 +35,7 @@ PageSourceWithDelegates::PageSourceWithDelegates(
   const DXResources& dxr,
   KneeboardState* kbs)
   : mDXResources(dxr) {
+  mContentLayerCache = std::make_unique<CachedLayer>(dxr);
   mDoodles = std::make_unique<DoodleRenderer>(dxr, kbs);
   mFixedEvents = {
     AddEventListener(mDoodles->evNeedsRepaintEvent, this->evNeedsRepaintEvent),
@@ -41,7 +44,7 @@ PageSourceWithDelegates::PageSourceWithDelegates(
     AddEventListener(
       this->evContentChangedEvent,
       [this]() {
-        this->mContentLayerCache.clear();
+        this->mContentLayerCache->Reset();
         std::unordered_set<PageID> keep;
         for (const auto pageID: this->GetPageIDs()) {
           keep.insert(pageID);
@@ -69,7 +72,10 @@ void PageSourceWithDelegates::SetDelegates(
   }
   mDelegateEvents.clear();
 
-  mDelegates = delegates;
+  {
+    std::unique_lock lock(mDelegatesMutex);
+    mDelegates = delegates;
+  }
 
   for (auto& delegate: delegates) {
     std::weak_ptr<IPageSource> weakDelegate {delegate};
@@ -158,12 +164,8 @@ void PageSourceWithDelegates::RenderPage(
 
   // ... otherwise, we'll assume it should be doodleable
 
-  if (!mContentLayerCache.contains(rti)) {
-    mContentLayerCache[rti] = std::make_unique<CachedLayer>(mDXResources);
-  }
-
   const auto nativeSize = delegate->GetNativeContentSize(pageID);
-  mContentLayerCache[rti]->Render(
+  mContentLayerCache->Render(
     rect,
     nativeSize,
     pageID.GetTemporaryValue(),
@@ -278,4 +280,108 @@ std::vector<NavigationEntry> PageSourceWithDelegates::GetNavigationEntries()
   return entries;
 }
 
+namespace {
+using SearchDelegate
+  = std::tuple<std::shared_ptr<IPageSourceWithSearch>, FileIdentity>;
+
+std::vector<SearchDelegate> GetSearchDelegates(
+  const std::vector<std::shared_ptr<IPageSource>>& delegates) {
+  std::vector<SearchDelegate> ret;
+  for (const auto& delegate: delegates) {
+    const auto withSearch
+      = std::dynamic_pointer_cast<IPageSourceWithSearch>(delegate);
+    if (!withSearch) {
+      continue;
+    }
+    // Still loading, or nothing to search
+    const auto identity = withSearch->GetSearchIdentity();
+    if (!identity) {
+      continue;
+    }
+    ret.push_back({withSearch, *identity});
+  }
+  return ret;
+}
+
+FileIdentity CombineSearchIdentities(
+  const std::vector<SearchDelegate>& delegates) {
+  if (delegates.size() == 1) {
+    return std::get<1>(delegates.front());
+  }
+
+  FileIdentity ret;
+  std::vector<uint64_t> hashes;
+  for (const auto& [delegate, identity]: delegates) {
+    ret.mSize += identity.mSize;
+    ret.mLastWriteTime = std::max(ret.mLastWriteTime, identity.mLastWriteTime);
+    hashes.push_back(identity.mContentHash);
+  }
+  ret.mContentHash = HashFileContent(std::as_bytes(std::span {hashes}));
+  return ret;
+}
+}// namespace
+
+std::vector<std::shared_ptr<IPageSource>>
+PageSourceWithDelegates::GetDelegatesForBackgroundThread() const {
+  std::shared_lock lock(mDelegatesMutex);
+  return mDelegates;
+}
+
+std::optional<FileIdentity> PageSourceWithDelegates::GetSearchIdentity()
+  const {
+  const auto delegates
+    = GetSearchDelegates(this->GetDelegatesForBackgroundThread());
+  if (delegates.empty()) {
+    return {};
+  }
+  return CombineSearchIdentities(delegates);
+}
+
+std::optional<std::vector<SearchPage>> PageSourceWithDelegates::GetSearchPages(
+  const FileIdentity& identity) const {
+  const auto delegates
+    = GetSearchDelegates(this->GetDelegatesForBackgroundThread());
+  if (delegates.empty()) {
+    return {};
+  }
+  if (!CombineSearchIdentities(delegates).HasSameContent(identity)) {
+    return {};
+  }
+
+  std::vector<SearchPage> pages;
+  for (const auto& [delegate, delegateIdentity]: delegates) {
+    auto delegatePages = delegate->GetSearchPages(delegateIdentity);
+    if (!delegatePages) {
+      return {};
+    }
+    std::ranges::move(*delegatePages, std::back_inserter(pages));
+  }
+  return pages;
+}
+
+bool PageSourceWithDelegates::IsSearchAppendOnly() const {
+  // Appending to anything but the last delegate would move later pages, so
+  // only forward this for a single delegate
+  const auto delegates
+    = GetSearchDelegates(this->GetDelegatesForBackgroundThread());
+  return delegates.size() == 1
+    && std::get<0>(delegates.front())->IsSearchAppendOnly();
+}
+
+std::optional<std::vector<SearchPage>>
+PageSourceWithDelegates::GetSearchPagesFrom(
+  const FileIdentity& identity,
+  PageIndex firstPage) const {
+  const auto delegates
+    = GetSearchDelegates(this->GetDelegatesForBackgroundThread());
+  if (delegates.size() != 1) {
+    return IPageSourceWithSearch::GetSearchPagesFrom(identity, firstPage);
+  }
+  const auto& [delegate, delegateIdentity] = delegates.front();
+  if (!delegateIdentity.HasSameContent(identity)) {
+    return {};
+  }
+  return delegate->GetSearchPagesFrom(delegateIdentity, firstPage);
+}
+
 }// namespace OpenKneeboard
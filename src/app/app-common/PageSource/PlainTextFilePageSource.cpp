@@ -18,8 +18,10 @@
  * USA.
  */
 #include <OpenKneeboard/PlainTextFilePageSource.h>
+#include <OpenKneeboard/Events.h>
 #include <OpenKneeboard/PlainTextPageSource.h>
 
+#include <OpenKneeboard/dprint.h>
 #include <OpenKneeboard/scope_guard.h>
 #include <OpenKneeboard/weak_wrap.h>
 
@@ -27,8 +29,6 @@
 
 #include <nlohmann/json.hpp>
 
-#include <fstream>
-
 namespace OpenKneeboard {
 
 PlainTextFilePageSource::PlainTextFilePageSource(
@@ -74,13 +74,15 @@ void PlainTextFilePageSource::Reload() {
   });
 
   this->mWatcher = {nullptr};
+  mPageSource->ClearText();
 
   if (!std::filesystem::is_regular_file(mPath)) {
-    mPageSource->ClearText();
+    mReader.reset();
     return;
   }
 
-  mPageSource->SetText(this->GetFileContent());
+  mReader.emplace(mPath);
+  this->ReadFileContent();
   this->SubscribeToChanges();
 }
 
@@ -103,45 +105,46 @@ void PlainTextFilePageSource::OnFileModified(
   if (!std::filesystem::is_regular_file(mPath)) {
     mPageSource->SetText({});
     mPageSource->SetPlaceholderText(_("[file deleted]"));
+    // If it's recreated, read it from the start
+    mReader.emplace(mPath);
     this->evContentChangedEvent.Emit();
     return;
   }
 
-  const auto newWriteTime = std::filesystem::last_write_time(mPath);
-
-  mPageSource->SetText(this->GetFileContent());
+  if (!mReader) {
+    mReader.emplace(mPath);
+  }
+  this->ReadFileContent();
   mPageSource->SetPlaceholderText(_("[empty file]"));
   this->evContentChangedEvent.Emit();
 }
 
-std::string PlainTextFilePageSource::GetFileContent() const {
-  auto bytes = std::filesystem::file_size(mPath);
-  if (bytes == 0) {
-    return {};
+void PlainTextFilePageSource::ReadFileContent() {
+  const EventDelay eventDelay;
+  switch (mReader->Poll()) {
+    case PlainTextFileReader::Change::None:
+      return;
+    case PlainTextFileReader::Change::Appended:
+      break;
+    case PlainTextFileReader::Change::Replaced:
+      mPageSource->ClearText();
+      break;
+    case PlainTextFileReader::Change::Error:
+      dprintf(L"Failed to open {}", mPath.wstring());
+      mPageSource->ClearText();
+      mReader.emplace(mPath);
+      return;
   }
-  std::string buffer;
-  buffer.resize(bytes);
-  size_t offset = 0;
 
-  std::ifstream f(mPath, std::ios::in | std::ios::binary);
-  if (!f.is_open()) {
-    dprintf(L"Failed to open {}", mPath.wstring());
+  // The reader only reads what's new, and the layout only lays out what it's
+  // given, so following a growing log is linear in what was appended
+  const auto ok = mReader->Read(
+    [this](std::string_view text) { mPageSource->AppendText(text); });
+  if (!ok) {
+    dprintf(L"Failed to read {}", mPath.wstring());
     mPageSource->ClearText();
-    return {};
+    mReader.emplace(mPath);
   }
-  while (bytes > 0) {
-    f.read(&buffer.data()[offset], bytes);
-    bytes -= f.gcount();
-    offset += f.gcount();
-  }
-
-  size_t pos = 0;
-  while ((pos = buffer.find("\r\n", pos)) != std::string::npos) {
-    buffer.replace(pos, 2, "\n");
-    pos++;
-  }
-
-  return buffer;
 }
 
 PageIndex PlainTextFilePageSource::GetPageCount() const {
@@ -20,15 +20,17 @@
 #include <OpenKneeboard/D2DErrorRenderer.h>
 #include <OpenKneeboard/DXResources.h>
 #include <OpenKneeboard/PlainTextPageSource.h>
+#include <OpenKneeboard/TextPageLog.h>
 
 #include <OpenKneeboard/config.h>
 #include <OpenKneeboard/dprint.h>
-#include <OpenKneeboard/scope_guard.h>
 
 #include <Unknwn.h>
 
 #include <algorithm>
 #include <format>
+#include <limits>
+#include <tuple>
 
 #include <dwrite.h>
 
@@ -59,18 +61,35 @@ PlainTextPageSource::PlainTextPageSource(
   mPadding = mRowHeight = metrics.height;
   mRows = static_cast<int>((size.height - (2 * mPadding)) / metrics.height) - 2;
   mColumns = static_cast<int>((size.width - (2 * mPadding)) / metrics.width);
+  mLayout.emplace(mColumns, mRows);
+
+  auto d2d = mDXR.mD2DDeviceContext;
+  d2d->CreateSolidColorBrush({1.0f, 1.0f, 1.0f, 1.0f}, mBackgroundBrush.put());
+  d2d->CreateSolidColorBrush({0.0f, 0.0f, 0.0f, 1.0f}, mTextBrush.put());
+  d2d->CreateSolidColorBrush({0.5f, 0.5f, 0.5f, 1.0f}, mFooterBrush.put());
 }
 
 PlainTextPageSource::~PlainTextPageSource() {
+  if (mSpillPath.empty()) {
+    return;
+  }
+  // Close the file first, as Windows can't delete open files
+  mSpill.reset();
+  std::error_code ec;
+  std::filesystem::remove(mSpillPath, ec);
+  if (ec) {
+    dprintf("Failed to delete text page log: {}", ec.message());
+  }
 }
 
 PageIndex PlainTextPageSource::GetPageCount() const {
-  if (mCompletePages.empty() && mCurrentPageLines.empty()) {
+  const auto completePages = mLayout->GetCompletePageCount();
+  if (completePages == 0 && mLayout->GetCurrentPageLines().empty()) {
     return mPlaceholderText.empty() ? 0 : 1;
   }
 
   // We only push a complete page when there's content (or about to be)
-  return mCompletePages.size() + 1;
+  return completePages + 1;
 }
 
 std::vector<PageID> PlainTextPageSource::GetPageIDs() const {
@@ -81,7 +100,7 @@ std::vector<PageID> PlainTextPageSource::GetPageIDs() const {
 }
 
 D2D1_SIZE_U PlainTextPageSource::GetNativeContentSize(PageID) {
-  return {768 * RENDER_SCALE, 1024 * RENDER_SCALE};
+  return NativeContentSize;
 }
 
 std::optional<PageIndex> PlainTextPageSource::FindPageIndex(
@@ -115,30 +134,23 @@ void PlainTextPageSource::RenderPage(
       rect.left + ((canvasSize.width - renderSize.width) / 2),
       rect.top + ((canvasSize.height - renderSize.height) / 2)));
 
-  winrt::com_ptr<ID2D1SolidColorBrush> background;
-  winrt::com_ptr<ID2D1SolidColorBrush> textBrush;
-  winrt::com_ptr<ID2D1SolidColorBrush> footerBrush;
-  ctx->CreateSolidColorBrush({1.0f, 1.0f, 1.0f, 1.0f}, background.put());
-  ctx->CreateSolidColorBrush({0.0f, 0.0f, 0.0f, 1.0f}, textBrush.put());
-  ctx->CreateSolidColorBrush({0.5f, 0.5f, 0.5f, 1.0f}, footerBrush.put());
-
   ctx->FillRectangle(
     {0.0f,
      0.0f,
      static_cast<float>(virtualSize.width),
      static_cast<float>(virtualSize.height)},
-    background.get());
+    mBackgroundBrush.get());
 
   auto textFormat = mTextFormat.get();
   textFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
-  if (mCurrentPageLines.empty()) {
+  if (mLayout->GetCurrentPageLines().empty()) {
     auto message = winrt::to_hstring(mPlaceholderText);
     ctx->DrawTextW(
       message.data(),
       static_cast<UINT32>(message.size()),
       textFormat,
       {mPadding, mPadding, virtualSize.width - mPadding, mPadding + mRowHeight},
-      footerBrush.get());
+      mFooterBrush.get());
     return;
   }
 
@@ -149,18 +161,30 @@ void PlainTextPageSource::RenderPage(
     return;
   }
 
-  const auto& lines = (*pageIndex == mCompletePages.size())
-    ? mCurrentPageLines
-    : mCompletePages.at(*pageIndex);
+  // Complete pages never change; the current page can gain lines, or have
+  // its last line extended by `AppendStream()` without gaining any, so use
+  // the hash of all the text so far
+  const LayoutCache::Key cacheKey {
+    .mPageKey = *pageIndex,
+    .mContentGeneration = (*pageIndex < mLayout->GetCompletePageCount())
+      ? 0
+      : mLayout->GetIdentity().mContentHash,
+  };
+  const LineLayouts* lines {nullptr};
+  try {
+    lines = &mLayoutCache.GetOrCreate(
+      cacheKey, [=, this]() { return this->CreateLineLayouts(*pageIndex); });
+  } catch (const std::runtime_error& e) {
+    dprintf("Failed to read text page {}: {}", *pageIndex, e.what());
+    D2DErrorRenderer(mDXR).Render(ctx, _("Failed to read page"), rect);
+    return;
+  }
 
   D2D_POINT_2F point {mPadding, mPadding};
-  for (const auto& line: lines) {
-    ctx->DrawTextW(
-      line.data(),
-      static_cast<UINT32>(line.size()),
-      textFormat,
-      {point.x, point.y, virtualSize.width - point.x, point.y + mRowHeight},
-      textBrush.get());
+  for (const auto& line: *lines) {
+    if (line) {
+      ctx->DrawTextLayout(point, line.get(), mTextBrush.get());
+    }
     point.y += mRowHeight;
   }
 
@@ -173,7 +197,7 @@ void PlainTextPageSource::RenderPage(
       static_cast<UINT32>(text.size()),
       textFormat,
       {mPadding, point.y, FLOAT(virtualSize.width), FLOAT(virtualSize.height)},
-      footerBrush.get());
+      mFooterBrush.get());
   }
 
   {
@@ -188,7 +212,7 @@ void PlainTextPageSource::RenderPage(
       static_cast<UINT32>(text.size()),
       textFormat,
       {mPadding, point.y, virtualSize.width - mPadding, point.y + mRowHeight},
-      footerBrush.get());
+      mFooterBrush.get());
   }
 
   if (*pageIndex + 1 < GetPageCount()) {
@@ -200,13 +224,13 @@ void PlainTextPageSource::RenderPage(
       static_cast<UINT32>(text.size()),
       textFormat,
       {mPadding, point.y, virtualSize.width - mPadding, point.y + mRowHeight},
-      footerBrush.get());
+      mFooterBrush.get());
   }
 }
 
 bool PlainTextPageSource::IsEmpty() const {
   std::unique_lock lock(mMutex);
-  return mMessages.empty() && mCurrentPageLines.empty();
+  return mLayout->GetCurrentPageLines().empty();
 }
 
 void PlainTextPageSource::ClearText() {
@@ -215,10 +239,19 @@ void PlainTextPageSource::ClearText() {
     if (IsEmpty()) {
       return;
     }
-    mMessages.clear();
-    mCurrentPageLines.clear();
-    mCompletePages.clear();
+    mLayout->Clear();
+    mLayoutCache.Clear();
     mPageIDs.clear();
+    mSpilledPage.reset();
+    std::unique_lock spillLock(mSpillMutex);
+    if (mSpill) {
+      try {
+        mSpill->Clear();
+      } catch (const std::runtime_error& e) {
+        dprintf("Failed to clear text page log: {}", e.what());
+        mSpill.reset();
+      }
+    }
   }
   this->evContentChangedEvent.Emit();
 }
@@ -241,126 +274,262 @@ void PlainTextPageSource::SetPlaceholderText(std::string_view text) {
 
 void PlainTextPageSource::PushMessage(std::string_view message) {
   std::unique_lock lock(mMutex);
-  mMessages.push_back(std::string(message));
-  LayoutMessages();
+  if (mRows <= 1 || mColumns <= 1) {
+    return;
+  }
+
+  // Only the new message is laid out; existing pages are never revisited
+  const auto newPages = mLayout->Append(message);
+  this->SpillPages();
+  for (size_t i = 0; i < newPages; ++i) {
+    this->evPageAppendedEvent.Emit(SuggestedPageAppendAction::SwitchToNewPage);
+  }
+  this->evContentChangedEvent.Emit();
+}
+
+void PlainTextPageSource::AppendText(std::string_view text) {
+  std::unique_lock lock(mMutex);
+  if (mRows <= 1 || mColumns <= 1 || text.empty()) {
+    return;
+  }
+
+  const auto newPages = mLayout->AppendStream(text);
+  this->SpillPages();
+  for (size_t i = 0; i < newPages; ++i) {
+    this->evPageAppendedEvent.Emit(SuggestedPageAppendAction::SwitchToNewPage);
+  }
+  this->evContentChangedEvent.Emit();
 }
 
 void PlainTextPageSource::EnsureNewPage() {
   std::unique_lock lock(mMutex);
-  if (!mCurrentPageLines.empty()) {
-    this->PushPage();
+  if (mLayout->EnsureNewPage()) {
+    this->SpillPages();
+    this->evPageAppendedEvent.Emit(SuggestedPageAppendAction::SwitchToNewPage);
   }
 }
 
-void PlainTextPageSource::PushPage() {
-  mCompletePages.push_back(mCurrentPageLines);
-  mCurrentPageLines.clear();
-  this->evPageAppendedEvent.Emit(SuggestedPageAppendAction::SwitchToNewPage);
+void PlainTextPageSource::EnableHistorySpill(
+  const std::filesystem::path& path,
+  size_t maxResidentPages) {
+  std::unique_lock lock(mMutex);
+  if (mSpill) {
+    throw std::logic_error("History spill is already enabled");
+  }
+  if (mLayout->GetFirstResidentPage() != 0) {
+    throw std::logic_error("Text pages have already been discarded");
+  }
+  // Set first, so the file is deleted even if it can't be used
+  mSpillPath = path;
+  try {
+    auto spill = std::make_unique<TextPageLog>(path);
+    // The log's page indices must match the layout's; it only holds this
+    // session's history, so torn-write recovery only matters for reads
+    // after a failed `Append()`, not across restarts
+    spill->Clear();
+    std::unique_lock spillLock(mSpillMutex);
+    mSpill = std::move(spill);
+  } catch (const std::runtime_error& e) {
+    dprintf(
+      "Failed to create text page log, keeping history in memory: {}",
+      e.what());
+    return;
+  }
+  mMaxResidentPages = maxResidentPages;
+  this->SpillPages();
 }
 
-void PlainTextPageSource::LayoutMessages() {
-  if (mRows <= 1 || mColumns <= 1) {
+void PlainTextPageSource::SpillPages() {
+  if (!mSpill) {
     return;
   }
-
-  if (mMessages.empty()) {
+  const auto first = mLayout->GetFirstResidentPage();
+  const auto resident = mLayout->GetCompletePageCount() - first;
+  // Spill in batches, so the remaining text is moved less often
+  const auto slack = std::max<size_t>(1, mMaxResidentPages / 2);
+  if (resident <= mMaxResidentPages || resident - mMaxResidentPages < slack) {
     return;
   }
 
-  const scope_guard repaintAtEnd(
-    [this]() { this->evContentChangedEvent.Emit(); });
+  const auto count = resident - mMaxResidentPages;
+  size_t spilled = 0;
+  std::unique_lock spillLock(mSpillMutex);
+  try {
+    for (; spilled < count; ++spilled) {
+      mSpill->Append(this->GetPageText(first + spilled));
+    }
+  } catch (const std::runtime_error& e) {
+    // Pages that were already spilled can still be read back
+    dprintf(
+      "Failed to spill text pages, keeping the rest in memory: {}", e.what());
+    mMaxResidentPages = std::numeric_limits<size_t>::max();
+  }
+  mLayout->DiscardCompletePages(spilled);
+}
+
+PlainTextPageSource::LineLayouts PlainTextPageSource::CreateLineLayouts(
+  PageIndex index) const {
+  // Must match the text format and boxes used by `RenderPage()`
+  mTextFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
+  const auto width = NativeContentSize.width - (2 * mPadding);
 
-  for (auto message: mMessages) {
-    // tabs are variable width, and everything else here
-    // assumes that all characters are the same width.
-    //
-    // Expand them
-    while (true) {
-      auto pos = message.find_first_of("\t");
-      if (pos == message.npos) {
-        break;
-      }
-      message.replace(pos, 1, "    ");
+  LineLayouts layouts;
+  for (const auto& text: this->GetPageText(index)) {
+    auto& layout = layouts.emplace_back();
+    if (text.empty()) {
+      continue;
     }
+    const auto line = winrt::to_hstring(text);
+    // On failure, this is left null, and the line is skipped
+    mDXR.mDWriteFactory->CreateTextLayout(
+      line.data(),
+      static_cast<UINT32>(line.size()),
+      mTextFormat.get(),
+      width,
+      mRowHeight,
+      layout.put());
+  }
+  return layouts;
+}
 
-    std::vector<std::string_view> rawLines;
-    std::string_view remaining(message);
-    while (!remaining.empty()) {
-      auto newline = remaining.find_first_of("\n");
-      if (newline == remaining.npos) {
-        rawLines.push_back(remaining);
-        break;
-      }
+PlainTextPageSource::LayoutCache::Stats
+PlainTextPageSource::GetLayoutCacheStats() const {
+  std::unique_lock lock(mMutex);
+  return mLayoutCache.GetStats();
+}
 
-      rawLines.push_back(remaining.substr(0, newline));
-      if (remaining.size() <= newline) {
-        break;
-      }
-      remaining = remaining.substr(newline + 1);
+std::vector<std::string_view> PlainTextPageSource::GetPageText(
+  PageIndex index) const {
+  std::vector<std::string_view> text;
+  if (index >= mLayout->GetFirstResidentPage()) {
+    for (const auto& line: mLayout->GetPageLines(index)) {
+      text.push_back(mLayout->GetText(line));
     }
+    return text;
+  }
 
-    std::vector<std::string_view> wrappedLines;
-    for (auto remaining: rawLines) {
-      while (true) {
-        if (remaining.size() <= mColumns) {
-          wrappedLines.push_back(remaining);
-          break;
-        }
-
-        auto space = remaining.find_last_of(" ", mColumns);
-        if (space != remaining.npos) {
-          wrappedLines.push_back(remaining.substr(0, space));
-          if (remaining.size() <= space) {
-            break;
-          }
-          remaining = remaining.substr(space + 1);
-          continue;
-        }
-
-        wrappedLines.push_back(remaining.substr(0, mColumns));
-        if (remaining.size() <= mColumns) {
-          break;
-        }
-        remaining = remaining.substr(mColumns);
-      }
+  if (!(mSpilledPage && mSpilledPage->first == index)) {
+    std::unique_lock spillLock(mSpillMutex);
+    mSpilledPage.emplace(index, mSpill->Read(index));
+  }
+  text.assign(mSpilledPage->second.begin(), mSpilledPage->second.end());
+  return text;
+}
+
+std::optional<FileIdentity> PlainTextPageSource::GetSearchIdentity() const {
+  std::unique_lock lock(mMutex);
+  if (mLayout->GetLineCount() == 0) {
+    return {};
+  }
+  // There's no file; the layout tracks the text and page breaks as they're
+  // appended, so this doesn't need to hash the whole history
+  return mLayout->GetIdentity();
+}
+
+std::optional<std::vector<SearchPage>> PlainTextPageSource::GetSearchPages(
+  const FileIdentity& identity) const {
+  return this->GetSearchPagesFrom(identity, 0);
+}
+
+bool PlainTextPageSource::IsSearchAppendOnly() const {
+  return true;
+}
+
+std::optional<std::vector<SearchPage>> PlainTextPageSource::GetSearchPagesFrom(
+  const FileIdentity& identity,
+  PageIndex firstPage) const {
+  // Only copy the resident text while holding the lock; messages arrive on
+  // other threads, and shouldn't wait for the search blocks to be built, or
+  // for spilled pages to be read back from disk
+  std::vector<std::tuple<PageID, std::vector<std::string>>> copied;
+  size_t spilledCount {};
+  float padding {};
+  float rowHeight {};
+  float columnWidth {};
+  {
+    std::unique_lock lock(mMutex);
+    const auto current = this->GetSearchIdentity();
+    if (!(current && current->HasSameContent(identity))) {
+      return {};
     }
 
-    if (wrappedLines.size() >= mRows) {
-      if (!mCurrentPageLines.empty()) {
-        mCurrentPageLines.push_back({});
+    const auto pageIDs = this->GetPageIDs();
+    const auto lastPage = mLayout->GetCompletePageCount();
+    const auto firstResident = mLayout->GetFirstResidentPage();
+    for (size_t i = firstPage; i <= lastPage; ++i) {
+      if (i < firstResident) {
+        copied.push_back({pageIDs.at(i), {}});
+        ++spilledCount;
+        continue;
       }
+      const auto lines = this->GetPageText(i);
+      copied.push_back({
+        pageIDs.at(i),
+        {lines.begin(), lines.end()},
+      });
+    }
+    padding = mPadding;
+    rowHeight = mRowHeight;
+    columnWidth = (mColumns > 0)
+      ? ((NativeContentSize.width - (2 * mPadding)) / mColumns)
+      : 0.0f;
+  }
 
-      for (const auto& line: wrappedLines) {
-        if (mCurrentPageLines.size() >= mRows) {
-          PushPage();
-        }
-        mCurrentPageLines.push_back(winrt::to_hstring(line));
+  if (spilledCount > 0) {
+    try {
+      std::unique_lock spillLock(mSpillMutex);
+      if (!mSpill) {
+        return {};
       }
-      continue;
+      for (size_t i = 0; i < spilledCount; ++i) {
+        std::get<1>(copied.at(i)) = mSpill->Read(firstPage + i);
+      }
+    } catch (const std::exception& e) {
+      // Includes `std::out_of_range` if the text was cleared meanwhile
+      dprintf("Failed to read spilled text pages for search: {}", e.what());
+      return {};
     }
-
-    // If we reach here, we can fit the full message on one page. Now figure
-    // out if we want a new page first.
-    if (mCurrentPageLines.empty()) {
-      // do nothing
-    } else if (mRows - mCurrentPageLines.size() >= wrappedLines.size() + 1) {
-      // Add a blank line first
-      mCurrentPageLines.push_back({});
-    } else {
-      // We need a new page
-      PushPage();
+    // Spilled pages never change, but the log is emptied by `ClearText()`;
+    // if it was, the pages we read may belong to the new text
+    const auto current = this->GetSearchIdentity();
+    if (!(current && current->HasSameContent(identity))) {
+      return {};
     }
+  }
 
-    for (auto line: wrappedLines) {
-      mCurrentPageLines.push_back(winrt::to_hstring(line));
+  const auto width = static_cast<float>(NativeContentSize.width);
+  const auto height = static_cast<float>(NativeContentSize.height);
+
+  std::vector<SearchPage> pages;
+  pages.reserve(copied.size());
+  for (auto& [pageID, lines]: copied) {
+    auto& page = pages.emplace_back(SearchPage {
+      .mPageKey = pageID.GetTemporaryValue(),
+    });
+    for (size_t j = 0; j < lines.size(); ++j) {
+      auto& text = lines[j];
+      if (text.empty()) {
+        continue;
+      }
+      const auto top = padding + (j * rowHeight);
+      const auto right = padding + (text.size() * columnWidth);
+      page.mBlocks.push_back({
+        std::move(text),
+        {
+          padding / width,
+          top / height,
+          right / width,
+          (top + rowHeight) / height,
+        },
+      });
     }
   }
-  mMessages.clear();
+  return pages;
 }
 
 void PlainTextPageSource::PushFullWidthSeparator() {
   std::unique_lock lock(mMutex);
-  if (mColumns <= 0 || (mMessages.empty() && mCurrentPageLines.empty())) {
+  if (mColumns <= 0 || IsEmpty()) {
     return;
   }
   this->PushMessage(std::string(mColumns, '-'));
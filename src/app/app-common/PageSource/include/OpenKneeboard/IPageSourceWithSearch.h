@@ -0,0 +1,77 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/FileSnapshot.h>
+#include <OpenKneeboard/IPageSource.h>
+#include <OpenKneeboard/SearchIndex.h>
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** A page source with text that can be added to a `SearchIndex`.
+ *
+ * Page keys in the returned `SearchPage`s are `PageID` temporary values.
+ */
+class IPageSourceWithSearch : public virtual IPageSource {
+ public:
+  /** Identifies the current text.
+   *
+   * If this hasn't changed, the source isn't re-indexed. Returns nullopt if
+   * there's nothing to index, e.g. because it's still loading.
+   */
+  virtual std::optional<FileIdentity> GetSearchIdentity() const = 0;
+  /** Extracts the text; this may be slow, and is called from a background
+   * thread.
+   *
+   * Returns nullopt if the content no longer matches the identity; the
+   * source will be indexed again when it's finished changing.
+   */
+  virtual std::optional<std::vector<SearchPage>> GetSearchPages(
+    const FileIdentity&) const
+    = 0;
+
+  /** True if only the last page's text changes, other than pages being
+   * added or being given new `PageID`s; for example, logs.
+   *
+   * These sources are re-indexed incrementally, with `GetSearchPagesFrom()`.
+   */
+  virtual bool IsSearchAppendOnly() const {
+    return false;
+  }
+
+  /// Like `GetSearchPages()`, but only pages from `firstPage` onwards
+  virtual std::optional<std::vector<SearchPage>> GetSearchPagesFrom(
+    const FileIdentity& identity,
+    PageIndex firstPage) const {
+    auto pages = this->GetSearchPages(identity);
+    if (pages) {
+      pages->erase(
+        pages->begin(),
+        pages->begin() + std::min<size_t>(firstPage, pages->size()));
+    }
+    return pages;
+  }
+};
+
+}// namespace OpenKneeboard
@@ -23,11 +23,16 @@
 #include <OpenKneeboard/Events.h>
 #include <OpenKneeboard/FilesystemWatcher.h>
 #include <OpenKneeboard/IPageSource.h>
+#include <OpenKneeboard/ImageDecoder.h>
 #include <OpenKneeboard/IPageSourceWithNavigation.h>
 
 #include <shims/filesystem>
 #include <shims/winrt/base.h>
 
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace OpenKneeboard {
 
 class ImageFilePageSource final
@@ -70,16 +75,47 @@ class ImageFilePageSource final
     std::filesystem::path mPath;
     winrt::com_ptr<ID2D1Bitmap> mBitmap;
     std::shared_ptr<FilesystemWatcher> mWatcher;
+    // From the file header, so we don't need to wait for the decode; the
+    // bitmap may be smaller
+    std::optional<ImageSize> mNativeSize;
+    bool mDecodeFailed {false};
   };
 
+  // Pages either side of the current page to decode in advance
+  static constexpr PageIndex PrefetchDistance = 2;
+  // Round up render sizes to avoid decoding again for every resize
+  static constexpr uint32_t DecodeBoundsGranularity = 512;
+
   void OnFileModified(const std::filesystem::path&);
 
   DXResources mDXR;
+  winrt::apartment_context mUIThread;
 
   std::mutex mMutex;
   std::vector<Page> mPages = {};
-
-  winrt::com_ptr<ID2D1Bitmap> GetPageBitmap(PageID);
+  // `ImageDecodePool` keys (page IDs) that we're waiting for
+  std::unordered_set<uint64_t> mPendingDecodes;
+  // The keys each render target most recently wanted, with their priorities;
+  // a decode is only cancelled when no render target wants it any more
+  std::unordered_map<RenderTargetID, std::unordered_map<uint64_t, int>>
+    mWantedDecodes;
+
+  winrt::com_ptr<ID2D1Bitmap>
+  GetPageBitmap(RenderTargetID, PageID, const ImageSize& bounds);
+  void RequestDecodes(
+    RenderTargetID,
+    PageIndex currentPage,
+    const ImageSize& bounds);
+  void ForgetCompletedRenderTargets();
+  static bool NeedsDecode(const Page&, const ImageSize& bounds);
+  void CancelDecodes(const std::unordered_set<uint64_t>& keep = {});
+  void SetPageImage(PageID, std::optional<DecodedImage>);
+
+  static winrt::fire_and_forget OnPageDecoded(
+    std::weak_ptr<ImageFilePageSource>,
+    winrt::apartment_context uiThread,
+    PageID,
+    std::optional<DecodedImage>);
 };
 
 }// namespace OpenKneeboard
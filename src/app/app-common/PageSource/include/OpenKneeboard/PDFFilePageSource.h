@@ -22,20 +22,29 @@
 #include <OpenKneeboard/Events.h>
 #include <OpenKneeboard/IPageSourceWithCursorEvents.h>
 #include <OpenKneeboard/IPageSourceWithNavigation.h>
+#include <OpenKneeboard/IPageSourceWithSearch.h>
 
 #include <shims/filesystem>
 #include <shims/winrt/base.h>
 
 #include <memory>
+#include <optional>
 
 namespace OpenKneeboard {
 
+class FileRangeReader;
 class KneeboardState;
 struct DXResources;
+struct PageImageKey;
+
+namespace PDFNavigation {
+struct Link;
+}
 
 class PDFFilePageSource final
   : virtual public IPageSourceWithCursorEvents,
     virtual public IPageSourceWithNavigation,
+    virtual public IPageSourceWithSearch,
     public EventReceiver,
     public std::enable_shared_from_this<PDFFilePageSource> {
  private:
@@ -64,6 +73,10 @@ class PDFFilePageSource final
   virtual bool IsNavigationAvailable() const override;
   virtual std::vector<NavigationEntry> GetNavigationEntries() const override;
 
+  virtual std::optional<FileIdentity> GetSearchIdentity() const override;
+  virtual std::optional<std::vector<SearchPage>> GetSearchPages(
+    const FileIdentity&) const override;
+
   virtual void PostCursorEvent(EventContext ctx, const CursorEvent&, PageID)
     override;
   virtual bool CanClearUserInput(PageID) const override;
@@ -82,12 +95,34 @@ class PDFFilePageSource final
   struct Impl;
   std::shared_ptr<Impl> p;
 
-  winrt::fire_and_forget ReloadRenderer();
-  winrt::fire_and_forget ReloadNavigation();
+  winrt::fire_and_forget ReloadRenderer(std::shared_ptr<FileRangeReader>);
+  winrt::fire_and_forget ReloadNavigation(std::shared_ptr<FileRangeReader>);
+
+  /// Caller must hold an exclusive lock on `p->mMutex`
+  void AddLinkHandler(PageID, const std::vector<PDFNavigation::Link>&);
+  /** Extracts links for a page and its neighbours on a background thread,
+   * if the extraction of every page's links isn't finished yet.
+   *
+   * Until they're loaded, the page has no link handler.
+   */
+  void PrefetchLinks(PageID);
 
   void OnFileModified(const std::filesystem::path& path);
 
-  void RenderPageContent(
+  /** Returns true if the page has been looked up in the `PageImageCache`,
+   * or is known not to be in it.
+   *
+   * Otherwise, starts looking it up on a background thread, and repaints
+   * when that's done.
+   */
+  bool LoadCachedPage(const PageImageKey&);
+
+  /** Returns the `PageImageCache` key for what was rendered.
+   *
+   * The key is taken under the same lock as the render, so it can't
+   * describe a version of the file that was loaded while rendering.
+   */
+  std::optional<PageImageKey> RenderPageContent(
     ID2D1DeviceContext*,
     PageID pageIndex,
     const D2D1_RECT_F& rect) noexcept;
@@ -24,8 +24,10 @@
 #include <OpenKneeboard/IPageSource.h>
 #include <OpenKneeboard/IPageSourceWithCursorEvents.h>
 #include <OpenKneeboard/IPageSourceWithNavigation.h>
+#include <OpenKneeboard/IPageSourceWithSearch.h>
 
 #include <memory>
+#include <shared_mutex>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -40,6 +42,7 @@ class KneeboardState;
 class PageSourceWithDelegates : public virtual IPageSource,
                                 public virtual IPageSourceWithCursorEvents,
                                 public virtual IPageSourceWithNavigation,
+                                public virtual IPageSourceWithSearch,
                                 public virtual EventReceiver {
  public:
   PageSourceWithDelegates() = delete;
@@ -65,20 +68,32 @@ class PageSourceWithDelegates : public virtual IPageSource,
   virtual bool IsNavigationAvailable() const override;
   virtual std::vector<NavigationEntry> GetNavigationEntries() const override;
 
+  virtual std::optional<FileIdentity> GetSearchIdentity() const override;
+  virtual std::optional<std::vector<SearchPage>> GetSearchPages(
+    const FileIdentity&) const override;
+  virtual bool IsSearchAppendOnly() const override;
+  virtual std::optional<std::vector<SearchPage>> GetSearchPagesFrom(
+    const FileIdentity&,
+    PageIndex firstPage) const override;
+
  protected:
   void SetDelegates(const std::vector<std::shared_ptr<IPageSource>>&);
 
  private:
   DXResources mDXResources;
   std::vector<std::shared_ptr<IPageSource>> mDelegates;
+  // Only modified on the UI thread; needed for reads from other threads
+  mutable std::shared_mutex mDelegatesMutex;
   std::vector<EventHandlerToken> mDelegateEvents;
   std::vector<EventHandlerToken> mFixedEvents;
 
   std::shared_ptr<IPageSource> FindDelegate(PageID) const;
+  std::vector<std::shared_ptr<IPageSource>> GetDelegatesForBackgroundThread()
+    const;
   mutable std::unordered_map<PageID, std::weak_ptr<IPageSource>> mPageDelegates;
 
-  std::unordered_map<RenderTargetID, std::unique_ptr<CachedLayer>>
-    mContentLayerCache;
+  // Shared by all render targets
+  std::unique_ptr<CachedLayer> mContentLayerCache;
   std::unique_ptr<DoodleRenderer> mDoodles;
 };
 
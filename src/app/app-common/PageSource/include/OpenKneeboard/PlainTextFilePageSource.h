@@ -21,6 +21,7 @@
 
 #include <OpenKneeboard/FilesystemWatcher.h>
 #include <OpenKneeboard/PageSourceWithDelegates.h>
+#include <OpenKneeboard/PlainTextFileReader.h>
 
 #include <shims/filesystem>
 #include <shims/winrt/base.h>
@@ -28,6 +29,7 @@
 #include <winrt/Windows.Storage.Search.h>
 
 #include <memory>
+#include <optional>
 
 namespace OpenKneeboard {
 
@@ -58,8 +60,10 @@ class PlainTextFilePageSource final
   winrt::apartment_context mUIThread;
   std::filesystem::path mPath;
   std::shared_ptr<PlainTextPageSource> mPageSource;
+  std::optional<PlainTextFileReader> mReader;
 
-  std::string GetFileContent() const;
+  /// Reads anything new in the file; usually just what was appended
+  void ReadFileContent();
 
   std::shared_ptr<FilesystemWatcher> mWatcher;
 
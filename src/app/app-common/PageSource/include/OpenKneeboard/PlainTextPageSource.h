@@ -19,23 +19,32 @@
  */
 #pragma once
 
-#include "IPageSource.h"
+#include "IPageSourceWithSearch.h"
 
 #include <OpenKneeboard/DXResources.h>
+#include <OpenKneeboard/PageLayoutCache.h>
+#include <OpenKneeboard/PlainTextLayout.h>
 
 #include <OpenKneeboard/utf8.h>
 
+#include <shims/filesystem>
 #include <shims/winrt/base.h>
 
 #include <memory>
 #include <mutex>
+#include <optional>
 
 namespace OpenKneeboard {
 
 struct DXResources;
+class TextPageLog;
 
-class PlainTextPageSource final : public IPageSource {
+class PlainTextPageSource final : public IPageSourceWithSearch {
  public:
+  // One per line; null for blank lines
+  using LineLayouts = std::vector<winrt::com_ptr<IDWriteTextLayout>>;
+  using LayoutCache = PageLayoutCache<LineLayouts>;
+
   PlainTextPageSource() = delete;
   PlainTextPageSource(const DXResources&, std::string_view placeholderText);
   virtual ~PlainTextPageSource();
@@ -45,9 +54,22 @@ class PlainTextPageSource final : public IPageSource {
   void SetText(std::string_view text);
   void SetPlaceholderText(std::string_view text);
   void PushMessage(std::string_view message);
+  /// Continues the text from previous calls, without starting a new message
+  void AppendText(std::string_view text);
   void PushFullWidthSeparator();
   void EnsureNewPage();
 
+  /** Keep at most `maxResidentPages` complete pages in memory.
+   *
+   * Older pages are moved to a `TextPageLog` at `path`, and read back when
+   * they're rendered or searched; page numbers are unaffected. Any existing
+   * log at `path` is discarded, as the history is only kept for this session;
+   * the log is deleted when this page source is destroyed.
+   */
+  void EnableHistorySpill(
+    const std::filesystem::path& path,
+    size_t maxResidentPages);
+
   virtual PageIndex GetPageCount() const override;
   virtual std::vector<PageID> GetPageIDs() const override;
   virtual D2D1_SIZE_U GetNativeContentSize(PageID) override;
@@ -57,14 +79,47 @@ class PlainTextPageSource final : public IPageSource {
     PageID,
     const D2D1_RECT_F& rect) override;
 
+  LayoutCache::Stats GetLayoutCacheStats() const;
+
+  virtual std::optional<FileIdentity> GetSearchIdentity() const override;
+  virtual std::optional<std::vector<SearchPage>> GetSearchPages(
+    const FileIdentity&) const override;
+  virtual bool IsSearchAppendOnly() const override;
+  virtual std::optional<std::vector<SearchPage>> GetSearchPagesFrom(
+    const FileIdentity&,
+    PageIndex firstPage) const override;
+
  private:
   static constexpr int RENDER_SCALE = 1;
+  static constexpr D2D1_SIZE_U NativeContentSize {
+    768 * RENDER_SCALE,
+    1024 * RENDER_SCALE,
+  };
 
   mutable std::recursive_mutex mMutex;
   mutable std::vector<PageID> mPageIDs;
-  std::vector<std::vector<winrt::hstring>> mCompletePages;
-  std::vector<winrt::hstring> mCurrentPageLines;
-  std::vector<std::string> mMessages;
+  // Set by the constructor, once the font metrics are known
+  std::optional<PlainTextLayout> mLayout;
+
+  // Guards `mSpill` and its file; search reads spilled pages holding only
+  // this, not `mMutex`. If both are needed, lock `mMutex` first.
+  mutable std::mutex mSpillMutex;
+  std::unique_ptr<TextPageLog> mSpill;
+  // Empty unless `EnableHistorySpill()` was called; deleted by the destructor
+  std::filesystem::path mSpillPath;
+  size_t mMaxResidentPages {};
+  // Most recently read page from `mSpill`
+  mutable std::optional<std::pair<PageIndex, std::vector<std::string>>>
+    mSpilledPage;
+
+  // Shaping every line is the bulk of the work in `RenderPage()`; keep the
+  // layouts for recently-viewed pages
+  LayoutCache mLayoutCache {8};
+
+  /// Throws std::runtime_error if a spilled page can't be read
+  std::vector<std::string_view> GetPageText(PageIndex) const;
+  LineLayouts CreateLineLayouts(PageIndex) const;
+  void SpillPages();
 
   std::optional<PageIndex> FindPageIndex(PageID) const;
 
@@ -75,10 +130,10 @@ class PlainTextPageSource final : public IPageSource {
 
   DXResources mDXR;
   winrt::com_ptr<IDWriteTextFormat> mTextFormat;
+  winrt::com_ptr<ID2D1SolidColorBrush> mBackgroundBrush;
+  winrt::com_ptr<ID2D1SolidColorBrush> mTextBrush;
+  winrt::com_ptr<ID2D1SolidColorBrush> mFooterBrush;
   std::string mPlaceholderText;
-
-  void LayoutMessages();
-  void PushPage();
 };
 
 }// namespace OpenKneeboard
@@ -0,0 +1,358 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/Bookmark.h>
+#include <OpenKneeboard/IKneeboardView.h>
+#include <OpenKneeboard/IPageSourceWithSearch.h>
+#include <OpenKneeboard/ITabView.h>
+#include <OpenKneeboard/SearchIndexer.h>
+#include <OpenKneeboard/TabsList.h>
+
+#include <OpenKneeboard/dprint.h>
+
+#include <shims/winrt/base.h>
+
+#include <algorithm>
+#include <chrono>
+#include <span>
+#include <utility>
+
+namespace OpenKneeboard {
+
+namespace {
+// File watchers and game events often fire several times in quick
+// succession; wait for things to settle before indexing.
+constexpr auto SettleTime = std::chrono::milliseconds(500);
+
+/** Page IDs change when a source is reloaded, even if the text doesn't; the
+ * index maps results to page IDs, so they're part of the identity.
+ */
+FileIdentity WithPageIDs(FileIdentity identity, const ITab& tab) {
+  std::vector<uint64_t> values {identity.mContentHash};
+  for (const auto& id: tab.GetPageIDs()) {
+    values.push_back(id.GetTemporaryValue());
+  }
+  identity.mContentHash = HashFileContent(std::as_bytes(std::span {values}));
+  return identity;
+}
+}// namespace
+
+SearchIndexer::SearchIndexer(TabsList* tabs) {
+  AddEventListener(
+    tabs->evTabsChangedEvent,
+    std::bind_front(&SearchIndexer::OnTabsChanged, this));
+  this->OnTabsChanged(tabs->GetTabs());
+
+  mThread = std::jthread([this](std::stop_token stopToken) {
+    SetThreadDescription(GetCurrentThread(), L"SearchIndexer Thread");
+    // Extracting text can parse every PDF; keep out of the way of rendering
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+    this->Run(stopToken);
+  });
+}
+
+SearchIndexer::~SearchIndexer() {
+  this->RemoveAllEventListeners();
+  mThread.request_stop();
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+}
+
+void SearchIndexer::OnTabsChanged(
+  const std::vector<std::shared_ptr<ITab>>& tabs) {
+  {
+    std::unique_lock lock(mMutex);
+    for (const auto& token: mTabEvents) {
+      this->RemoveEventListener(token);
+    }
+    mTabEvents.clear();
+    mTabs.clear();
+
+    for (const auto& tab: tabs) {
+      mTabs[tab->GetRuntimeID().GetTemporaryValue()] = tab;
+      mTabEvents.push_back(AddEventListener(
+        tab->evContentChangedEvent,
+        std::bind_front(&SearchIndexer::MarkDirty, this)));
+      mTabEvents.push_back(AddEventListener(
+        tab->evPageAppendedEvent,
+        std::bind_front(&SearchIndexer::MarkDirty, this)));
+    }
+  }
+  this->MarkDirty();
+}
+
+void SearchIndexer::MarkDirty() {
+  {
+    std::unique_lock lock(mMutex);
+    mDirty = true;
+  }
+  mWake.notify_all();
+}
+
+void SearchIndexer::Run(std::stop_token stopToken) {
+  while (!stopToken.stop_requested()) {
+    {
+      std::unique_lock lock(mMutex);
+      if (!mWake.wait(lock, stopToken, [this]() { return mDirty; })) {
+        return;
+      }
+      // Wait for the changes to settle; this restarts if there are more
+      // changes in the mean time
+      while (mDirty) {
+        mDirty = false;
+        if (mWake.wait_for(
+              lock, stopToken, SettleTime, [this]() { return mDirty; })) {
+          continue;
+        }
+        if (stopToken.stop_requested()) {
+          return;
+        }
+      }
+    }
+    this->UpdateIndex(stopToken);
+  }
+}
+
+void SearchIndexer::UpdateIndex(std::stop_token stopToken) {
+  std::vector<std::shared_ptr<ITab>> tabs;
+  {
+    std::unique_lock lock(mMutex);
+    for (const auto& [id, weak]: mTabs) {
+      if (auto tab = weak.lock()) {
+        tabs.push_back(std::move(tab));
+      }
+    }
+  }
+
+  bool changed = false;
+  std::vector<uint64_t> keys;
+  for (const auto& tab: tabs) {
+    if (stopToken.stop_requested()) {
+      return;
+    }
+    const auto key = tab->GetRuntimeID().GetTemporaryValue();
+    keys.push_back(key);
+
+    const auto source = std::dynamic_pointer_cast<IPageSourceWithSearch>(tab);
+    if (!source) {
+      continue;
+    }
+    const auto sourceIdentity = source->GetSearchIdentity();
+    if (!sourceIdentity) {
+      changed = true;
+      mIndex.Remove(key);
+      continue;
+    }
+
+    const auto identity = WithPageIDs(*sourceIdentity, *tab);
+    if (mIndex.IsCurrent(key, identity)) {
+      continue;
+    }
+
+    try {
+      // Logs change with every message; rather than re-extracting all of
+      // their history each time, only extract the last indexed page - which
+      // may have been incomplete - and anything after it, or with a new ID
+      if (source->IsSearchAppendOnly()) {
+        if (const auto indexed = mIndex.GetPageKeys(key);
+            indexed && !indexed->empty()) {
+          const auto pageIDs = tab->GetPageIDs();
+          const auto unchanged = [&](size_t i) {
+            return i < pageIDs.size()
+              && indexed->at(i) == pageIDs.at(i).GetTemporaryValue();
+          };
+          size_t first = 0;
+          while (first + 1 < indexed->size() && unchanged(first)) {
+            ++first;
+          }
+          auto pages = source->GetSearchPagesFrom(
+            *sourceIdentity, static_cast<PageIndex>(first));
+          if (!pages) {
+            continue;
+          }
+          if (mIndex.ReplacePages(key, identity, first, std::move(*pages))) {
+            changed = true;
+            continue;
+          }
+        }
+      }
+
+      auto pages = this->GetSearchPages(*tab, *source, *sourceIdentity);
+      if (!pages) {
+        // Changed while we were reading it; we'll be woken up again
+        continue;
+      }
+      mIndex.Upsert({
+        .mDocumentKey = key,
+        .mIdentity = identity,
+        .mPages = std::move(*pages),
+      });
+      changed = true;
+    } catch (const winrt::hresult_error& e) {
+      dprintf(
+        "Failed to index tab '{}': {:#010x} {}",
+        tab->GetTitle(),
+        static_cast<uint32_t>(e.code().value),
+        winrt::to_string(e.message()));
+    } catch (const std::exception& e) {
+      dprintf("Failed to index tab '{}': {}", tab->GetTitle(), e.what());
+    }
+  }
+
+  mIndex.RetainOnly(keys);
+
+  bool first = false;
+  {
+    std::unique_lock lock(mMutex);
+    first = !std::exchange(mIndexed, true);
+  }
+  if (changed) {
+    const auto stats = mIndex.GetStats();
+    // Evicted documents are indexed again on the next update; if this keeps
+    // growing, the budget is too small for these tabs
+    dprintf(
+      "Search index updated: {} documents, {} pages, {} terms, ~{}KiB, {} "
+      "evictions",
+      stats.mDocumentCount,
+      stats.mPageCount,
+      stats.mTermCount,
+      stats.mEstimatedBytes / 1024,
+      stats.mEvictionCount);
+  }
+  if (changed || first) {
+    evIndexUpdatedEvent.Emit();
+  }
+}
+
+std::optional<std::vector<SearchPage>> SearchIndexer::GetSearchPages(
+  const ITab& tab,
+  const IPageSourceWithSearch& source,
+  const FileIdentity& identity) {
+  // Metadata-only identities don't say anything about the content
+  const auto cacheable = identity.mContentHash != 0;
+  const TextCacheKey cacheKey {identity.mSize, identity.mContentHash};
+  const auto pageIDs = tab.GetPageIDs();
+
+  if (const auto cached = cacheable ? mExtractedText.Get(cacheKey) : nullptr) {
+    const auto& text = **cached;
+    const auto pageCount = static_cast<PageIndex>(pageIDs.size());
+    if (std::ranges::all_of(
+          text.mPageIndices, [=](auto i) { return i < pageCount; })) {
+      auto pages = text.mPages;
+      for (size_t i = 0; i < pages.size(); ++i) {
+        pages.at(i).mPageKey
+          = pageIDs.at(text.mPageIndices.at(i)).GetTemporaryValue();
+      }
+      return pages;
+    }
+  }
+
+  auto pages = source.GetSearchPages(identity);
+  if (!(pages && cacheable)) {
+    return pages;
+  }
+
+  auto text = std::make_shared<ExtractedText>();
+  size_t cost = 0;
+  for (const auto& page: *pages) {
+    const auto it = std::ranges::find_if(pageIDs, [&](const PageID& id) {
+      return id.GetTemporaryValue() == page.mPageKey;
+    });
+    if (it == pageIDs.end()) {
+      // Reloaded while we were extracting; don't cache stale page keys
+      return pages;
+    }
+    text->mPageIndices.push_back(static_cast<PageIndex>(it - pageIDs.begin()));
+    for (const auto& block: page.mBlocks) {
+      cost += block.mText.size() + sizeof(block);
+    }
+  }
+  text->mPages = *pages;
+  mExtractedText.Insert(cacheKey, std::move(text), cost);
+  return pages;
+}
+
+std::vector<SearchResult> SearchIndexer::Query(
+  std::string_view query,
+  size_t maxResults) const {
+  const auto hits = mIndex.Query(query, maxResults);
+
+  std::vector<SearchResult> results;
+  results.reserve(hits.size());
+  std::unique_lock lock(mMutex);
+  for (const auto& hit: hits) {
+    const auto it = mTabs.find(hit.mDocumentKey);
+    if (it == mTabs.end()) {
+      continue;
+    }
+    const auto tab = it->second.lock();
+    if (!tab) {
+      continue;
+    }
+
+    SearchResult result {
+      .mTabID = ITab::RuntimeID::FromTemporaryValue(hit.mDocumentKey),
+      .mTabTitle = tab->GetTitle(),
+      .mPageID = PageID::FromTemporaryValue(hit.mPageKey),
+      .mSnippet = hit.mSnippet,
+    };
+    for (const auto& rect: hit.mRects) {
+      result.mRects.push_back({
+        rect.mLeft,
+        rect.mTop,
+        rect.mRight,
+        rect.mBottom,
+      });
+    }
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+SearchIndex::Stats SearchIndexer::GetStats() const {
+  return mIndex.GetStats();
+}
+
+bool SearchIndexer::IsIndexed() const {
+  std::unique_lock lock(mMutex);
+  return mIndexed;
+}
+
+bool SearchIndexer::GoToResult(
+  IKneeboardView* view,
+  const SearchResult& result) {
+  const auto tabView = view->GetTabViewByID(result.mTabID);
+  if (!tabView) {
+    return false;
+  }
+  const auto pageIDs = tabView->GetRootTab()->GetPageIDs();
+  if (std::ranges::find(pageIDs, result.mPageID) == pageIDs.end()) {
+    return false;
+  }
+
+  view->GoToBookmark({
+    .mTabID = result.mTabID,
+    .mPageID = result.mPageID,
+    .mTitle = result.mTabTitle,
+  });
+  return true;
+}
+
+}// namespace OpenKneeboard
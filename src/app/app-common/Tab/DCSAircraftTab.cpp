@@ -37,7 +37,7 @@ DCSAircraftTab::DCSAircraftTab(
   const winrt::guid& persistentID,
   std::string_view title)
   : TabBase(persistentID, title),
-    DCSTab(kbs),
+    DCSTab(kbs, {DCS::EVT_AIRCRAFT}),
     PageSourceWithDelegates(dxr, kbs),
     mDXR(dxr),
     mKneeboard(kbs) {
@@ -44,7 +44,7 @@ DCSBriefingTab::DCSBriefingTab(
   const winrt::guid& persistentID,
   std::string_view title)
   : TabBase(persistentID, title),
-    DCSTab(kbs),
+    DCSTab(kbs, {DCS::EVT_MISSION, DCS::EVT_SELF_DATA, DCS::EVT_ORIGIN}),
     PageSourceWithDelegates(dxr, kbs),
     mImagePages(ImageFilePageSource::Create(dxr)),
     mTextPages(std::make_unique<PlainTextPageSource>(dxr, _("[no briefing]"))) {
@@ -38,7 +38,7 @@ DCSMissionTab::DCSMissionTab(
   const winrt::guid& persistentID,
   std::string_view title)
   : TabBase(persistentID, title),
-    DCSTab(kbs),
+    DCSTab(kbs, {DCS::EVT_MISSION, DCS::EVT_AIRCRAFT}),
     PageSourceWithDelegates(dxr, kbs) {
   mPageSource = FolderPageSource::Create(dxr, kbs);
   this->SetDelegates({std::static_pointer_cast<IPageSource>(mPageSource)});
@@ -19,10 +19,12 @@
  */
 #include <OpenKneeboard/DCSRadioLogTab.h>
 #include <OpenKneeboard/DCSWorld.h>
+#include <OpenKneeboard/Filesystem.h>
 #include <OpenKneeboard/GameEvent.h>
 #include <OpenKneeboard/PlainTextPageSource.h>
 
 #include <chrono>
+#include <random>
 
 using DCS = OpenKneeboard::DCSWorld;
 
@@ -47,7 +49,7 @@ DCSRadioLogTab::DCSRadioLogTab(
   std::string_view title,
   const nlohmann::json& config)
   : TabBase(persistentID, title),
-    DCSTab(kbs),
+    DCSTab(kbs, {DCS::EVT_SIMULATION_START, DCS::EVT_MESSAGE}),
     PageSourceWithDelegates(dxr, kbs),
     mPageSource(std::make_shared<PlainTextPageSource>(
       dxr,
@@ -55,6 +57,15 @@ DCSRadioLogTab::DCSRadioLogTab(
   this->SetDelegates({mPageSource});
   AddEventListener(mPageSource->evPageAppendedEvent, this->evPageAppendedEvent);
   LoadSettings(config);
+
+  if (mMaxPagesInMemory > 0) {
+    // Multiplayer sessions can go on for many hours; keep older pages on disk
+    std::random_device randDevice;
+    std::uniform_int_distribution<uint64_t> randDist;
+    const auto path = Filesystem::GetTemporaryDirectory()
+      / std::format("RadioLog-{:016x}.oktpl", randDist(randDevice));
+    mPageSource->EnableHistorySpill(path, mMaxPagesInMemory);
+  }
 }
 
 DCSRadioLogTab::~DCSRadioLogTab() {
@@ -71,12 +82,16 @@ void DCSRadioLogTab::LoadSettings(const nlohmann::json& json) {
   if (json.contains("ShowTimestamps")) {
     mShowTimestamps = json.at("ShowTimestamps");
   }
+  if (json.contains("MaxPagesInMemory")) {
+    mMaxPagesInMemory = json.at("MaxPagesInMemory");
+  }
 }
 
 nlohmann::json DCSRadioLogTab::GetSettings() const {
   return {
     {"MissionStartBehavior", mMissionStartBehavior},
     {"ShowTimestamps", mShowTimestamps},
+    {"MaxPagesInMemory", mMaxPagesInMemory},
   };
 };
 
@@ -27,24 +27,33 @@ using DCS = OpenKneeboard::DCSWorld;
 
 namespace OpenKneeboard {
 
-DCSTab::DCSTab(KneeboardState* kbs) {
-  mGameEventToken = AddEventListener(
-    kbs->evGameEvent, [this](const GameEvent& ev) { this->OnGameEvent(ev); });
+DCSTab::DCSTab(
+  KneeboardState* kbs,
+  std::initializer_list<GameEventName> eventNames,
+  std::source_location location) {
+  auto dispatcher = kbs->GetGameEventDispatcher();
+  mGameEventSubscriptions.push_back(dispatcher->Subscribe(
+    DCS::EVT_INSTALL_PATH, [this](const GameEvent& event) {
+      mInstallPath = std::filesystem::canonical(event.value);
+    }));
+  mGameEventSubscriptions.push_back(dispatcher->Subscribe(
+    DCS::EVT_SAVED_GAMES_PATH, [this](const GameEvent& event) {
+      mSavedGamesPath = std::filesystem::canonical(event.value);
+    }));
+
+  for (const auto& name: eventNames) {
+    mGameEventSubscriptions.push_back(dispatcher->Subscribe(
+      name,
+      [this](const GameEvent& ev) { this->OnGameEvent(ev); },
+      location));
+  }
 }
 
 DCSTab::~DCSTab() {
-  this->RemoveEventListener(mGameEventToken);
+  mGameEventSubscriptions.clear();
 }
 
 void DCSTab::OnGameEvent(const GameEvent& event) {
-  if (event.name == DCS::EVT_INSTALL_PATH) {
-    mInstallPath = std::filesystem::canonical(event.value);
-  }
-
-  if (event.name == DCS::EVT_SAVED_GAMES_PATH) {
-    mSavedGamesPath = std::filesystem::canonical(event.value);
-  }
-
   if (!(mInstallPath.empty() || mSavedGamesPath.empty())) {
     OnGameEvent(event, mInstallPath, mSavedGamesPath);
   }
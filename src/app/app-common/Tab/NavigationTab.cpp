@@ -218,6 +218,7 @@ void NavigationTab::RenderPage(
   ctx->SetTransform(pageTransform);
 
   const auto [hoverButton, buttons] = mButtonTrackers.at(pageID)->GetState();
+  const auto& metrics = this->GetPreviewMetrics(pageID);
 
   for (int i = 0; i < buttons.size(); ++i) {
     const auto& button = buttons.at(i);
@@ -225,7 +226,7 @@ void NavigationTab::RenderPage(
 
     if (button == hoverButton) {
       ctx->FillRectangle(rect, mHighlightBrush.get());
-      ctx->FillRectangle(mPreviewMetrics.mRects.at(i), mBackgroundBrush.get());
+      ctx->FillRectangle(metrics.mRects.at(i), mBackgroundBrush.get());
     } else {
       ctx->FillRectangle(rect, mInactiveBrush.get());
     }
@@ -251,24 +252,24 @@ void NavigationTab::RenderPage(
   std::vector<float> columnPreviewRightEdge(mRenderColumns);
   for (auto i = 0; i < buttons.size(); ++i) {
     const auto& button = buttons.at(i);
-    const auto& previewRect = mPreviewMetrics.mRects.at(i);
+    const auto& previewRect = metrics.mRects.at(i);
     auto& rightEdge = columnPreviewRightEdge.at(button.mRenderColumn);
     if (previewRect.right > rightEdge) {
       rightEdge = previewRect.right;
     }
     if (button == hoverButton) {
       ctx->DrawRectangle(
-        previewRect, mHighlightBrush.get(), mPreviewMetrics.mStroke);
+        previewRect, mHighlightBrush.get(), metrics.mStroke);
     } else {
       ctx->DrawRectangle(
-        previewRect, mPreviewOutlineBrush.get(), mPreviewMetrics.mStroke / 2);
+        previewRect, mPreviewOutlineBrush.get(), metrics.mStroke / 2);
     }
   }
 
   for (const auto& button: buttons) {
     auto rect = button.mRect;
     rect.left = columnPreviewRightEdge.at(button.mRenderColumn)
-      + mPreviewMetrics.mBleed;
+      + metrics.mBleed;
     ctx->DrawTextW(
       button.mName.data(),
       static_cast<UINT32>(button.mName.size()),
@@ -293,21 +294,20 @@ void NavigationTab::RenderPage(
     {0.0f,
      0.0f,
      static_cast<FLOAT>(mPreferredSize.width),
-     static_cast<FLOAT>(mPreferredSize.height) - mPreviewMetrics.mBleed},
+     static_cast<FLOAT>(mPreferredSize.height) - metrics.mBleed},
     mTextBrush.get(),
     D2D1_DRAW_TEXT_OPTIONS_NO_SNAP);
 }
 
-void NavigationTab::RenderPreviewLayer(
-  RenderTargetID rtid,
-  PageID pageID,
-  ID2D1DeviceContext* ctx,
-  const D2D1_SIZE_U& size) {
-  auto& m = mPreviewMetrics;
-  m = {};
+const NavigationTab::PreviewMetrics& NavigationTab::GetPreviewMetrics(
+  PageID pageID) {
+  if (auto it = mPreviewMetrics.find(pageID); it != mPreviewMetrics.end()) {
+    return it->second;
+  }
+
+  PreviewMetrics m {};
 
   const auto& buttons = mButtonTrackers.at(pageID)->GetButtons();
-  m.mRects.clear();
   m.mRects.resize(buttons.size());
 
   const auto& first = buttons.front();
@@ -330,8 +330,21 @@ void NavigationTab::RenderPreviewLayer(
     rect.top = button.mRect.top - m.mBleed;
     rect.right = rect.left + width;
     rect.bottom = button.mRect.bottom + m.mBleed;
+  }
 
-    mRootTab->RenderPage(rtid, ctx, button.mPageID, rect);
+  return mPreviewMetrics.emplace(pageID, std::move(m)).first->second;
+}
+
+void NavigationTab::RenderPreviewLayer(
+  RenderTargetID rtid,
+  PageID pageID,
+  ID2D1DeviceContext* ctx,
+  const D2D1_SIZE_U& size) {
+  const auto& buttons = mButtonTrackers.at(pageID)->GetButtons();
+  const auto& rects = this->GetPreviewMetrics(pageID).mRects;
+
+  for (auto i = 0; i < buttons.size(); ++i) {
+    mRootTab->RenderPage(rtid, ctx, buttons.at(i).mPageID, rects.at(i));
   }
 }
 
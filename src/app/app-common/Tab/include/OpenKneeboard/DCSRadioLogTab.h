@@ -79,6 +79,8 @@ class DCSRadioLogTab final : public TabBase,
   MissionStartBehavior mMissionStartBehavior {
     MissionStartBehavior::DrawHorizontalLine};
   bool mShowTimestamps = false;
+  // 0 keeps the entire history in memory
+  uint32_t mMaxPagesInMemory = 100;
 
   winrt::fire_and_forget OnGameEventImpl(
     const GameEvent&,
@@ -21,19 +21,31 @@
 
 #include <OpenKneeboard/DCSWorld.h>
 #include <OpenKneeboard/Events.h>
+#include <OpenKneeboard/GameEventDispatcher.h>
 #include <OpenKneeboard/ITab.h>
 
 #include <shims/filesystem>
 
+#include <initializer_list>
+#include <source_location>
+#include <vector>
+
 namespace OpenKneeboard {
 
 class KneeboardState;
 
-struct GameEvent;
-
 class DCSTab : public virtual ITab, public virtual EventReceiver {
  public:
-  DCSTab(KneeboardState*);
+  /** Subclasses only receive the events they name here, and only once the
+   * installation and saved games paths are known.
+   *
+   * The source location is the subclass constructor; it labels the
+   * subscriptions in GameEventDispatcher::GetHandlerStats().
+   */
+  DCSTab(
+    KneeboardState*,
+    std::initializer_list<GameEventName> eventNames,
+    std::source_location = std::source_location::current());
   virtual ~DCSTab();
 
   DCSTab() = delete;
@@ -50,7 +62,7 @@ class DCSTab : public virtual ITab, public virtual EventReceiver {
  private:
   std::filesystem::path mInstallPath;
   std::filesystem::path mSavedGamesPath;
-  EventHandlerToken mGameEventToken;
+  std::vector<GameEventDispatcher::Subscription> mGameEventSubscriptions;
 
   void OnGameEvent(const GameEvent&);
 };
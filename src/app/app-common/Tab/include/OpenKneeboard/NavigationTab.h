@@ -94,12 +94,17 @@ class NavigationTab final : public TabBase,
   winrt::com_ptr<ID2D1SolidColorBrush> mPreviewOutlineBrush;
   winrt::com_ptr<ID2D1SolidColorBrush> mTextBrush;
 
-  struct {
+  struct PreviewMetrics {
     float mBleed;
     float mStroke;
     float mHeight;
     std::vector<D2D1_RECT_F> mRects;
-  } mPreviewMetrics;
+  };
+  // Per-page, as `mPreviewLayer` caches multiple pages, so the previews
+  // aren't necessarily rendered when the page is
+  std::unordered_map<PageID, PreviewMetrics> mPreviewMetrics;
+
+  const PreviewMetrics& GetPreviewMetrics(PageID);
 
   void RenderPreviewLayer(
     RenderTargetID,
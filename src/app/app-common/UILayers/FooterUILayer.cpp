@@ -36,8 +36,13 @@ FooterUILayer::FooterUILayer(const DXResources& dxr, KneeboardState* kneeboard)
   AddEventListener(
     kneeboard->evFrameTimerPrepareEvent,
     std::bind_front(&FooterUILayer::Tick, this));
-  AddEventListener(
-    kneeboard->evGameEvent, std::bind_front(&FooterUILayer::OnGameEvent, this));
+  auto dispatcher = kneeboard->GetGameEventDispatcher();
+  mGameEventSubscriptions.push_back(dispatcher->Subscribe(
+    DCSWorld::EVT_SIMULATION_START,
+    std::bind_front(&FooterUILayer::OnGameEvent, this)));
+  mGameEventSubscriptions.push_back(dispatcher->Subscribe(
+    DCSWorld::EVT_MISSION_TIME,
+    std::bind_front(&FooterUILayer::OnGameEvent, this)));
   AddEventListener(
     kneeboard->evGameChangedEvent,
     std::bind_front(&FooterUILayer::OnGameChanged, this));
@@ -55,6 +60,7 @@ FooterUILayer::FooterUILayer(const DXResources& dxr, KneeboardState* kneeboard)
 }
 
 FooterUILayer::~FooterUILayer() {
+  mGameEventSubscriptions.clear();
   this->RemoveAllEventListeners();
 }
 
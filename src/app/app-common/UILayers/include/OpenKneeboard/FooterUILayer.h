@@ -20,17 +20,18 @@
 #pragma once
 
 #include <OpenKneeboard/DXResources.h>
+#include <OpenKneeboard/GameEventDispatcher.h>
 #include <OpenKneeboard/SHM.h>
 #include <OpenKneeboard/UILayerBase.h>
 #include <shims/winrt/base.h>
 
 #include <chrono>
 #include <memory>
+#include <vector>
 
 namespace OpenKneeboard {
 
 class KneeboardState;
-struct GameEvent;
 struct GameInstance;
 
 class FooterUILayer final : public UILayerBase, private EventReceiver {
@@ -66,6 +67,7 @@ class FooterUILayer final : public UILayerBase, private EventReceiver {
   std::optional<std::chrono::seconds> mUTCOffset;
 
   KneeboardState* mKneeboard {nullptr};
+  std::vector<GameEventDispatcher::Subscription> mGameEventSubscriptions;
 
   // Used for frame counter only
   SHM::Reader mSHM;
@@ -55,7 +55,7 @@ class UserInputDevice : protected EventReceiver {
   Event<UserAction> evUserActionEvent;
 
  private:
-  winrt::apartment_context mUIThread;
+  EventDeliveryContext mUIThread;
   void OnButtonEvent(UserInputButtonEvent);
 
   std::unordered_set<uint64_t> mActiveButtons;
@@ -97,6 +97,8 @@ struct AppSettings final {
   InGameUISettings mInGameUI {};
   TintSettings mTint {};
   std::string mLastRunVersion;
+  // VRAM for cached renders of pages; 0 picks a size based on the GPU
+  uint32_t mRenderCacheMiB {0};
 
   constexpr auto operator<=>(const AppSettings&) const noexcept = default;
 };
@@ -19,19 +19,47 @@
  */
 #pragma once
 
-#include <d2d1_2.h>
+#include <OpenKneeboard/UniqueID.h>
+
 #include <shims/winrt/base.h>
 
 #include <functional>
+#include <memory>
 #include <mutex>
 
+#include <d2d1_2.h>
+
 namespace OpenKneeboard {
 
 struct DXResources;
+class RasterCache;
 
+/** Renders content via bitmaps in the shared `RasterCache`.
+ *
+ * Multiple keys can be cached at once, e.g. so that flipping back and forth
+ * between pages doesn't re-render them; they are evicted when the
+ * `RasterCache` is over budget, or when this layer is reset or destroyed.
+ *
+ * A single layer can be used for multiple render targets, as long as the
+ * content for a key doesn't depend on the render target.
+ */
 class CachedLayer final {
  public:
+  /// Only meaningful to this layer
   using Key = size_t;
+  /** Content that other layers may also render, e.g. a page of a file
+   * that is open in several tabs; see `RasterCache::Key`.
+   *
+   * These are shared with other layers, so they are not erased by
+   * `Reset()` or the destructor; use `RasterCache::EraseSource()`.
+   */
+  struct SharedKey {
+    uint64_t mSource {};
+    uint64_t mContent {};
+  };
+  using RenderFunction
+    = std::function<void(ID2D1DeviceContext*, const D2D1_SIZE_U&)>;
+
   CachedLayer(const DXResources&);
   ~CachedLayer();
 
@@ -40,15 +68,40 @@ class CachedLayer final {
     const D2D1_SIZE_U& nativeSize,
     Key cacheKey,
     ID2D1DeviceContext* ctx,
-    std::function<void(ID2D1DeviceContext*, const D2D1_SIZE_U&)> impl);
+    RenderFunction impl);
+  void Render(
+    const D2D1_RECT_F& where,
+    const D2D1_SIZE_U& nativeSize,
+    const SharedKey& cacheKey,
+    ID2D1DeviceContext* ctx,
+    RenderFunction impl);
+  /** Draws the bitmap if it's already cached, without rendering it.
+   *
+   * Returns false on a miss; e.g. for callers that would rather draw a
+   * placeholder than render the content on this thread.
+   */
+  bool RenderIfCached(
+    const D2D1_RECT_F& where,
+    const D2D1_SIZE_U& nativeSize,
+    const SharedKey& cacheKey,
+    ID2D1DeviceContext* ctx);
+  /// Erase the bitmaps for this layer's own `Key`s
   void Reset();
 
  private:
-  Key mKey = ~Key {0};
+  const UniqueID mID;
+  std::shared_ptr<RasterCache> mRasterCache;
 
-  D2D1_SIZE_U mCacheSize;
-  winrt::com_ptr<ID2D1Bitmap1> mCache;
-  std::mutex mCacheMutex;
+  // Reused for every miss
+  winrt::com_ptr<ID2D1Device> mDevice;
+  winrt::com_ptr<ID2D1DeviceContext> mDeviceContext;
+  std::mutex mDeviceContextMutex;
+
+  ID2D1DeviceContext* GetDeviceContext(ID2D1DeviceContext* target);
+  winrt::com_ptr<ID2D1Bitmap1> RenderBitmap(
+    ID2D1DeviceContext* target,
+    const D2D1_SIZE_U& nativeSize,
+    const RenderFunction& impl);
 };
 
 }// namespace OpenKneeboard
@@ -0,0 +1,118 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include "InlineFunction.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** Runs work on a specific thread or apartment.
+ *
+ * This is usually an `EventDeliveryContext`, but is abstracted so that
+ * `EventDeliveryQueue` does not depend on WinRT.
+ */
+class EventDeliveryExecutor {
+ public:
+  virtual ~EventDeliveryExecutor();
+
+  /** Call `drain` once on the target context.
+   *
+   * This must not call `drain` before returning. If an item throws, the
+   * exception propagates out of `drain`, after another drain has been
+   * scheduled for the remaining items.
+   */
+  virtual void Schedule(std::function<void()> drain) = 0;
+
+  /// Whether the calling thread is already in the target context
+  virtual bool IsCurrentContext() const = 0;
+};
+
+/** Delivers work items to a single context in batches.
+ *
+ * Instead of switching to the target context for each item, only the first
+ * item that is enqueued while the queue is idle schedules a drain; the drain
+ * then runs everything that is pending in one resumption, including any items
+ * that are enqueued while it is running.
+ *
+ * If an item is enqueued from the target context while nothing else is
+ * pending, it is delivered before `Enqueue()` returns, as `co_await`ing the
+ * context would.
+ *
+ * Items are delivered in the order that they were enqueued, including across
+ * threads.
+ */
+class EventDeliveryQueue final
+  : public std::enable_shared_from_this<EventDeliveryQueue> {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Item = InlineFunction<128>;
+
+  /** How long a single drain may run for.
+   *
+   * This limits the time spent in one resumption, not how long an item waits
+   * to be delivered. When it is exceeded, any remaining items are left for
+   * another drain, so that other work on the target context is not starved
+   * by a flood of events.
+   */
+  static constexpr std::chrono::milliseconds MaxDrainDuration {8};
+
+  struct Stats {
+    uint64_t mEnqueued {0};
+    uint64_t mDelivered {0};
+    uint64_t mDrains {0};
+    uint64_t mMaxBatchSize {0};
+  };
+
+  static std::shared_ptr<EventDeliveryQueue> Create(
+    std::unique_ptr<EventDeliveryExecutor>);
+
+  EventDeliveryQueue() = delete;
+  ~EventDeliveryQueue();
+
+  void Enqueue(Item);
+
+  Stats GetStats() const;
+
+ private:
+  explicit EventDeliveryQueue(std::unique_ptr<EventDeliveryExecutor>);
+
+  const std::unique_ptr<EventDeliveryExecutor> mExecutor;
+
+  mutable std::mutex mMutex;
+  std::vector<Item> mPending;
+  bool mScheduled {false};
+  Stats mStats;
+
+  // Only used by `Drain()`; items before the head have been delivered
+  std::vector<Item> mDraining;
+  size_t mDrainingHead {0};
+
+  void Schedule();
+  void Drain();
+};
+
+}// namespace OpenKneeboard
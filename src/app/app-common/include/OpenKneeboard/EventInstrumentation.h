@@ -0,0 +1,119 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <source_location>
+#include <string>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** Optional statistics for `Event<>`s, for finding busy events and slow
+ * handlers.
+ *
+ * Events don't have names, so they are identified by where they are emitted
+ * from, and handlers by where they were added.
+ *
+ * This is disabled by default; when disabled, the only cost is checking an
+ * atomic bool in `Emit()` and `EventConnection::Call()`. It can be enabled
+ * at runtime, or at startup by setting the `OPENKNEEBOARD_EVENT_STATS`
+ * environment variable.
+ */
+class EventInstrumentation final {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  EventInstrumentation() = delete;
+
+  static inline bool IsEnabled() noexcept {
+    return sEnabled.load(std::memory_order_relaxed);
+  }
+  static void SetEnabled(bool);
+  /// Discard everything that has been recorded so far
+  static void Reset();
+
+  // These are called from `Event<>`, so don't throw; if recording fails -
+  // e.g. allocating an entry for a new location - it is counted in
+  // `Snapshot::mDroppedRecordCount` instead.
+  static void RecordEmit(
+    const std::source_location& emitter,
+    size_t handlerCount) noexcept;
+  static void RecordHandler(
+    const std::source_location& handler,
+    Clock::duration) noexcept;
+  /// A receiver was still connected when the event was destroyed
+  static void RecordOrphanedReceiver(
+    const std::source_location& handler) noexcept;
+
+  struct Location {
+    std::string mFile;
+    uint32_t mLine {};
+    std::string mFunction;
+  };
+
+  struct EmitterStats {
+    Location mLocation;
+    uint64_t mEmitCount {};
+    double mEmitsPerSecond {};
+    size_t mMaxHandlerCount {};
+    size_t mLastHandlerCount {};
+  };
+
+  /// Bucket N counts calls that took less than 2^N microseconds
+  static constexpr size_t HistogramBucketCount = 24;
+  using Histogram = std::array<uint64_t, HistogramBucketCount>;
+
+  struct HandlerStats {
+    Location mLocation;
+    uint64_t mCallCount {};
+    Clock::duration mTotalTime {};
+    Clock::duration mMaxTime {};
+    Histogram mHistogram {};
+  };
+
+  struct OrphanedReceiverStats {
+    Location mLocation;
+    uint64_t mCount {};
+  };
+
+  struct Snapshot {
+    bool mEnabled {false};
+    Clock::duration mDuration {};
+    // Sorted by emit count, descending
+    std::vector<EmitterStats> mEmitters {};
+    // Sorted by total time, descending
+    std::vector<HandlerStats> mHandlers {};
+    std::vector<OrphanedReceiverStats> mOrphanedReceivers {};
+    uint64_t mDroppedRecordCount {};
+  };
+
+  static Snapshot GetSnapshot();
+  /// A human-readable summary, e.g. for logs or debug info
+  static std::string FormatSnapshot(const Snapshot&);
+
+ private:
+  static std::atomic_bool sEnabled;
+};
+
+}// namespace OpenKneeboard
@@ -19,6 +19,9 @@
  */
 #pragma once
 
+#include "EventDeliveryQueue.h"
+#include "EventInstrumentation.h"
+#include "InlineFunction.h"
 #include "UniqueID.h"
 
 #include <OpenKneeboard/dprint.h>
@@ -28,13 +31,18 @@
 
 #include <winrt/Windows.Foundation.h>
 
+#include <algorithm>
+#include <atomic>
+#include <concepts>
 #include <cstdint>
 #include <functional>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <source_location>
 #include <type_traits>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace OpenKneeboard {
@@ -43,6 +51,34 @@ class EventContext final : public UniqueIDBase<EventContext> {};
 class EventHandlerToken final : public UniqueIDBase<EventHandlerToken> {};
 class EventHookToken final : public UniqueIDBase<EventHookToken> {};
 
+/** A `winrt::apartment_context` that events can be batched for.
+ *
+ * `apartment_context` can't be compared, so this also captures the COM
+ * identity of the current context; events that are enqueued for contexts
+ * with the same identity share an `EventDeliveryQueue`.
+ */
+class EventDeliveryContext final {
+ public:
+  /// Captures the current context
+  EventDeliveryContext();
+
+  auto operator co_await() const noexcept {
+    return mApartment.operator co_await();
+  }
+
+  const winrt::apartment_context& GetApartmentContext() const noexcept {
+    return mApartment;
+  }
+
+  ::IUnknown* GetIdentity() const noexcept {
+    return mIdentity.get();
+  }
+
+ private:
+  winrt::apartment_context mApartment;
+  winrt::com_ptr<::IUnknown> mIdentity;
+};
+
 template <class... Args>
 using EventHandler = std::function<void(Args...)>;
 
@@ -64,6 +100,9 @@ class EventBase {
     STOP_PROPAGATION,
   };
 
+  // Large enough for most events' arguments plus a receiver snapshot
+  using EmitterFunction = InlineFunction<128>;
+
  protected:
   /** Event handlers are not invoked recursively to avoid deadlocks.
    *
@@ -77,9 +116,25 @@ class EventBase {
    * To similarly buffer events in a non-handler context, use the `EventDelay`
    * class.
    */
-  static void InvokeOrEnqueue(std::function<void()>, std::source_location);
+  template <std::invocable F>
+  static void InvokeOrEnqueue(F&& func, std::source_location location) {
+    // Fast path: don't type-erase if we're going to call it immediately
+    if (!IsDelayingEvents()) {
+      func();
+      return;
+    }
+    Enqueue(EmitterFunction {std::forward<F>(func)}, location);
+  }
 
   virtual void RemoveHandler(EventHandlerToken) = 0;
+
+  /// Shared by all events that are enqueued for the same context
+  static std::shared_ptr<EventDeliveryQueue> GetDeliveryQueue(
+    const EventDeliveryContext&);
+
+ private:
+  static bool IsDelayingEvents() noexcept;
+  static void Enqueue(EmitterFunction, std::source_location);
 };
 
 /** Delay any event handling in the current thread for the lifetime of this
@@ -113,7 +168,7 @@ class EventConnection final
     public std::enable_shared_from_this<EventConnection<Args...>> {
  private:
   EventConnection(EventHandler<Args...> handler, std::source_location location)
-    : mHandler(handler), mSourceLocation(location) {
+    : mHandler(std::move(handler)), mSourceLocation(location) {
   }
 
  public:
@@ -123,46 +178,95 @@ class EventConnection final
     EventHandler<Args...> handler,
     std::source_location location) {
     return std::shared_ptr<EventConnection<Args...>>(
-      new EventConnection(handler, location));
+      new EventConnection(std::move(handler), location));
   }
 
-  constexpr operator bool() const noexcept {
-    // not bothering with the lock, as it's checked with lock in Call() and
-    // Invalidate() anyway
-    return static_cast<bool>(mHandler);
+  operator bool() const noexcept {
+    return !(mState.load(std::memory_order_acquire) & InvalidatedBit);
   }
 
   void Call(Args... args) {
     auto stayingAlive = this->shared_from_this();
-    auto handler = mHandler;
-    if (handler) {
-      // In release builds, ignore but drop unhandled exceptions from handlers.
-      // In debug builds, break (or crash)
-      try {
-        handler(args...);
-      } catch (const std::exception& e) {
-        dprintf("Uncaught std::exception from event handler: {}", e.what());
-        OPENKNEEBOARD_BREAK;
-      } catch (const winrt::hresult_error& e) {
-        dprintf(
-          L"Uncaught hresult error from event handler: {} - {}",
-          e.code().value,
-          std::wstring_view {e.message()});
-        OPENKNEEBOARD_BREAK;
-      } catch (...) {
-        dprint("Uncaught unknown exception from event handler");
-        OPENKNEEBOARD_BREAK;
+    if (!this->TryBeginCall()) {
+      return;
+    }
+    std::optional<EventInstrumentation::Clock::time_point> start;
+    if (EventInstrumentation::IsEnabled()) [[unlikely]] {
+      start = EventInstrumentation::Clock::now();
+    }
+    // In release builds, ignore but drop unhandled exceptions from handlers.
+    // In debug builds, break (or crash)
+    try {
+      if (mHandler) {
+        mHandler(args...);
       }
+    } catch (const std::exception& e) {
+      dprintf("Uncaught std::exception from event handler: {}", e.what());
+      OPENKNEEBOARD_BREAK;
+    } catch (const winrt::hresult_error& e) {
+      dprintf(
+        L"Uncaught hresult error from event handler: {} - {}",
+        e.code().value,
+        std::wstring_view {e.message()});
+      OPENKNEEBOARD_BREAK;
+    } catch (...) {
+      dprint("Uncaught unknown exception from event handler");
+      OPENKNEEBOARD_BREAK;
     }
+    if (start) [[unlikely]] {
+      EventInstrumentation::RecordHandler(
+        mSourceLocation, EventInstrumentation::Clock::now() - *start);
+    }
+    this->EndCall();
   }
 
   virtual void Invalidate() override {
-    mHandler = {};
+    const auto state
+      = mState.fetch_or(InvalidatedBit, std::memory_order_acq_rel);
+    if (state == 0) {
+      // Not already invalidated, and not being called
+      this->ReleaseHandler();
+    }
+  }
+
+  const std::source_location& GetSourceLocation() const noexcept {
+    return mSourceLocation;
   }
 
  private:
+  /* The low bits are the number of `Call()`s in progress.
+   *
+   * The handler is destroyed by whichever of `Invalidate()` and the last
+   * in-progress `Call()` finishes last, as its captures may keep other
+   * objects alive; this avoids a separate allocation for reference-counting
+   * it.
+   */
+  static constexpr uint32_t InvalidatedBit = 1u << 31;
+  std::atomic<uint32_t> mState {0};
   EventHandler<Args...> mHandler;
   std::source_location mSourceLocation;
+
+  bool TryBeginCall() noexcept {
+    auto state = mState.load(std::memory_order_acquire);
+    do {
+      if (state & InvalidatedBit) {
+        return false;
+      }
+    } while (!mState.compare_exchange_weak(
+      state, state + 1, std::memory_order_acquire));
+    return true;
+  }
+
+  void EndCall() noexcept {
+    const auto state = mState.fetch_sub(1, std::memory_order_acq_rel);
+    if (state == (InvalidatedBit | 1)) {
+      this->ReleaseHandler();
+    }
+  }
+
+  void ReleaseHandler() noexcept {
+    mHandler = nullptr;
+  }
 };
 
 /** a 1:n event. */
@@ -184,15 +288,27 @@ class Event final : public EventBase {
     mImpl->Emit(args..., location);
   }
 
+  /** Emit the event in the specified context, without waiting for it.
+   *
+   * For `EventDeliveryContext`, this is batched with any other events
+   * that are pending for the same context, so that a burst of events only
+   * requires a single switch to the target thread. If called from the target
+   * context with nothing pending, the event is emitted before this returns.
+   */
   template <class Awaitable>
-  winrt::fire_and_forget EnqueueForContext(
+  void EnqueueForContext(
     Awaitable context,
     Args... args,
     std::source_location location = std::source_location::current()) {
-    auto weakImpl = std::weak_ptr(mImpl);
-    co_await context;
-    if (auto impl = weakImpl.lock()) {
-      impl->Emit(args..., location);
+    if constexpr (std::same_as<Awaitable, EventDeliveryContext>) {
+      GetDeliveryQueue(context)->Enqueue(
+        [weakImpl = std::weak_ptr(mImpl), ... args = args, location]() {
+          if (auto impl = weakImpl.lock()) {
+            impl->Emit(args..., location);
+          }
+        });
+    } else {
+      EnqueueForAwaitable(context, args..., location);
     }
   }
 
@@ -213,6 +329,19 @@ class Event final : public EventBase {
   EventHookToken AddHook(Hook, EventHookToken token = {}) noexcept;
   void RemoveHook(EventHookToken) noexcept;
 
+ private:
+  template <class Awaitable>
+  winrt::fire_and_forget EnqueueForAwaitable(
+    Awaitable context,
+    Args... args,
+    std::source_location location) {
+    auto weakImpl = std::weak_ptr(mImpl);
+    co_await context;
+    if (auto impl = weakImpl.lock()) {
+      impl->Emit(args..., location);
+    }
+  }
+
  protected:
   std::shared_ptr<EventConnectionBase> AddHandler(
     const EventHandler<Args...>&,
@@ -223,11 +352,32 @@ class Event final : public EventBase {
   struct Impl {
     ~Impl();
 
-    std::unordered_map<
-      EventHandlerToken,
-      std::shared_ptr<EventConnection<Args...>>>
-      mReceivers;
-    std::unordered_map<EventHookToken, Hook> mHooks;
+    /** An immutable snapshot of the receivers and hooks.
+     *
+     * `Emit()` takes a reference to the current snapshot instead of copying
+     * the containers; modifications replace the snapshot. This means that
+     * emitting never copies the handler list, and handlers that are added or
+     * removed while an event is being emitted do not affect that emit.
+     *
+     * Taking the reference is not lock-free: standard library
+     * implementations of `std::atomic<std::shared_ptr>` hold a short
+     * internal lock while updating the reference count. That lock is only
+     * held for the load or store itself, never while handlers run.
+     */
+    struct State {
+      std::vector<
+        std::pair<EventHandlerToken, std::shared_ptr<EventConnection<Args...>>>>
+        mReceivers;
+      std::vector<std::pair<EventHookToken, Hook>> mHooks;
+    };
+
+    std::atomic<std::shared_ptr<const State>> mState {
+      std::make_shared<const State>()};
+    // Only needed for writers, to avoid lost updates
+    std::mutex mWriteMutex;
+
+    template <class F>
+    void Update(F&& mutate);
 
     void Emit(
       Args... args,
@@ -287,25 +437,47 @@ class EventReceiver {
   void RemoveAllEventListeners();
 };
 
+template <class... Args>
+template <class F>
+void Event<Args...>::Impl::Update(F&& mutate) {
+  std::unique_lock lock(mWriteMutex);
+  auto state = std::make_shared<State>(*mState.load());
+  mutate(*state);
+  mState.store(std::move(state));
+}
+
 template <class... Args>
 std::shared_ptr<EventConnectionBase> Event<Args...>::AddHandler(
   const EventHandler<Args...>& handler,
   std::source_location location) {
   auto connection = EventConnection<Args...>::Create(handler, location);
   auto token = connection->mToken;
-  mImpl->mReceivers.emplace(token, connection);
+  mImpl->Update([&](auto& state) {
+    // `EventReceiver` invalidates connections without removing them, so
+    // prune them here, otherwise every copy would keep getting bigger
+    std::erase_if(state.mReceivers, [](const auto& entry) {
+      return !*entry.second;
+    });
+    state.mReceivers.emplace_back(token, connection);
+  });
   return std::move(connection);
 }
 
 template <class... Args>
 void Event<Args...>::RemoveHandler(EventHandlerToken token) {
   std::shared_ptr<EventConnectionBase> receiver;
-  if (!mImpl->mReceivers.contains(token)) {
-    return;
+  mImpl->Update([&](auto& state) {
+    auto it = std::ranges::find(
+      state.mReceivers, token, [](const auto& entry) { return entry.first; });
+    if (it == state.mReceivers.end()) {
+      return;
+    }
+    receiver = std::move(it->second);
+    state.mReceivers.erase(it);
+  });
+  if (receiver) {
+    receiver->Invalidate();
   }
-  receiver = mImpl->mReceivers.at(token);
-  mImpl->mReceivers.erase(token);
-  receiver->Invalidate();
 }
 
 template <class... Args>
@@ -315,11 +487,13 @@ void Event<Args...>::Impl::Emit(Args... args, std::source_location location) {
     activity,
     "Event::Emit()",
     OPENKNEEBOARD_TraceLoggingSourceLocation(location));
-  //  Copy in case one is erased while we're running
-  auto receivers = mReceivers;
-  auto hooks = mHooks;
+  // Hold a reference in case it's replaced while we're running
+  auto state = mState.load();
+  if (EventInstrumentation::IsEnabled()) [[unlikely]] {
+    EventInstrumentation::RecordEmit(location, state->mReceivers.size());
+  }
 
-  for (const auto& [_, hook]: hooks) {
+  for (const auto& [_, hook]: state->mHooks) {
     if (hook(args...) == HookResult::STOP_PROPAGATION) {
       TraceLoggingWriteStop(
         activity,
@@ -332,8 +506,8 @@ void Event<Args...>::Impl::Emit(Args... args, std::source_location location) {
 
   TraceLoggingWriteTagged(activity, "Invoking or enqueuing");
   InvokeOrEnqueue(
-    [=]() {
-      for (const auto& [token, receiver]: receivers) {
+    [=, state = std::move(state)]() {
+      for (const auto& [token, receiver]: state->mReceivers) {
         if (receiver) {
           receiver->Call(args...);
         }
@@ -353,7 +527,13 @@ Event<Args...>::~Event() {
 
 template <class... Args>
 Event<Args...>::Impl::~Impl() {
-  for (const auto& [token, receiver]: mReceivers) {
+  for (const auto& [token, receiver]: mState.load()->mReceivers) {
+    // The receiver still has this connection in `mSenders`; it should
+    // usually have been removed before the event was destroyed
+    if (*receiver && EventInstrumentation::IsEnabled()) [[unlikely]] {
+      EventInstrumentation::RecordOrphanedReceiver(
+        receiver->GetSourceLocation());
+    }
     receiver->Invalidate();
   }
 }
@@ -362,16 +542,27 @@ template <class... Args>
 EventHookToken Event<Args...>::AddHook(
   Hook hook,
   EventHookToken token) noexcept {
-  mImpl->mHooks.insert_or_assign(token, hook);
+  mImpl->Update([&](auto& state) {
+    auto it = std::ranges::find(
+      state.mHooks, token, [](const auto& entry) { return entry.first; });
+    if (it == state.mHooks.end()) {
+      state.mHooks.emplace_back(token, std::move(hook));
+    } else {
+      it->second = std::move(hook);
+    }
+  });
   return token;
 }
 
 template <class... Args>
 void Event<Args...>::RemoveHook(EventHookToken token) noexcept {
-  auto it = mImpl->mHooks.find(token);
-  if (it != mImpl->mHooks.end()) {
-    mImpl->mHooks.erase(it);
-  }
+  mImpl->Update([&](auto& state) {
+    auto it = std::ranges::find(
+      state.mHooks, token, [](const auto& entry) { return entry.first; });
+    if (it != state.mHooks.end()) {
+      state.mHooks.erase(it);
+    }
+  });
 }
 
 template <class... Args>
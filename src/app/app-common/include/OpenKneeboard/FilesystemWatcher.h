@@ -59,7 +59,7 @@ class FilesystemWatcher final
 
   winrt::Windows::Foundation::IAsyncAction mImpl {nullptr};
 
-  winrt::apartment_context mOwnerThread;
+  EventDeliveryContext mOwnerThread;
   std::filesystem::path mPath;
   std::filesystem::file_time_type mLastWriteTime;
   bool mSettling = false;
@@ -21,10 +21,16 @@
 
 #include <OpenKneeboard/Events.h>
 #include <OpenKneeboard/GameEvent.h>
+#include <OpenKneeboard/GameEventBatch.h>
+#include <OpenKneeboard/GameEventRecording.h>
 #include <shims/winrt/base.h>
 #include <winrt/Windows.Foundation.h>
 
 #include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <vector>
 
 namespace OpenKneeboard {
 
@@ -36,21 +42,70 @@ class GameEventServer final
   ~GameEventServer();
 
   Event<GameEvent> evGameEvent;
+  Event<GameEventReplayStats> evReplayCompletedEvent;
+
+  GameEventReceiveMetrics::Snapshot GetMetrics() const;
+
+  /// Record every received event to the specified file, replacing it
+  void StartRecording(const std::filesystem::path&);
+  /** Dispatch events from a recording as if they had just been received.
+   *
+   * Speed is a multiplier; 0 is as fast as possible.
+   */
+  void StartReplay(const std::filesystem::path&, double speed);
 
  private:
+  class MailslotPacketSource;
+  struct RingClient;
   GameEventServer();
   winrt::Windows::Foundation::IAsyncAction mRunner;
-  winrt::apartment_context mUIThread;
+  EventDeliveryContext mUIThread;
   winrt::handle mCompletionHandle {CreateEventW(nullptr, TRUE, FALSE, nullptr)};
+  winrt::handle mBinaryPacketsEvent;
+
+  GameEventBatchPool mBatchPool;
+  GameEventReceiveMetrics mMetrics;
+  GameEventReceiver mReceiver;
+  std::stop_source mRunnerStopSource;
+
+  // Written to from both the mailslot and ring threads
+  std::unique_ptr<GameEventRecordingWriter> mRecorder;
+  std::mutex mRecorderMutex;
+
+  winrt::Windows::Foundation::IAsyncAction mReplay {nullptr};
+  std::stop_source mReplayStopSource;
+
+  // Shared memory rings registered by clients via EVT_REGISTER_RING
+  winrt::handle mRingWakeEvent;
+  winrt::Windows::Foundation::IAsyncAction mRingRunner {nullptr};
+  winrt::handle mRingCompletionHandle {
+    CreateEventW(nullptr, TRUE, FALSE, nullptr)};
+  std::mutex mRingMutex;
+  std::vector<std::unique_ptr<RingClient>> mRingClients;
+  // Recent registrations we couldn't attach to, oldest first; the client
+  // uses the mailslot. Capped at `MaxRejectedRingNames`
+  std::vector<std::string> mRejectedRingNames;
+  static constexpr size_t MaxRejectedRingNames = 64;
+  std::vector<char> mRingBuffer;
 
   void Start();
 
   winrt::Windows::Foundation::IAsyncAction Run();
-  static winrt::Windows::Foundation::IAsyncOperation<bool> RunSingle(
-    const std::weak_ptr<GameEventServer>&,
-    const winrt::handle& event,
-    const winrt::file_handle&);
-  winrt::fire_and_forget DispatchEvent(std::string_view);
+  /// Called on the receive thread before a batch is dispatched
+  void OnBatchReceived(
+    const GameEventBatch&,
+    GameEventBatch::Clock::time_point receivedAt);
+  winrt::fire_and_forget DispatchBatch(std::unique_ptr<GameEventBatch>);
+
+  void AttachRing(const RegisterGameEventRingEvent&);
+  /// Called on the UI thread, in dispatch order
+  void ActivateRing(const ActivateGameEventRingEvent&);
+  winrt::Windows::Foundation::IAsyncAction RunRings();
+  /// Returns the number of packets read
+  size_t DrainRings(GameEventBatch&, GameEventBatch::Clock::time_point);
+  winrt::Windows::Foundation::IAsyncAction Replay(
+    std::filesystem::path,
+    double speed);
 };
 
 }// namespace OpenKneeboard
@@ -0,0 +1,142 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace OpenKneeboard {
+
+/** A move-only `void()` callable with inline storage.
+ *
+ * Like `std::function<void()>`, except callables that fit in `TInlineSize`
+ * bytes are stored inline instead of on the heap; larger ones are still
+ * supported, but are heap-allocated.
+ */
+template <size_t TInlineSize>
+class InlineFunction final {
+ public:
+  InlineFunction() = default;
+
+  template <class F>
+    requires(!std::same_as<std::decay_t<F>, InlineFunction>)
+    && std::invocable<std::decay_t<F>&>
+  InlineFunction(F&& f) {
+    using T = std::decay_t<F>;
+    if constexpr (IsInlineable<T>) {
+      new (mStorage) T(std::forward<F>(f));
+      mVTable = &InlineVTable<T>;
+    } else {
+      *reinterpret_cast<T**>(mStorage) = new T(std::forward<F>(f));
+      mVTable = &HeapVTable<T>;
+    }
+  }
+
+  InlineFunction(InlineFunction&& other) noexcept {
+    *this = std::move(other);
+  }
+
+  InlineFunction& operator=(InlineFunction&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    this->Reset();
+    if (other.mVTable) {
+      other.mVTable->mMove(other.mStorage, mStorage);
+      mVTable = std::exchange(other.mVTable, nullptr);
+    }
+    return *this;
+  }
+
+  InlineFunction(const InlineFunction&) = delete;
+  InlineFunction& operator=(const InlineFunction&) = delete;
+
+  ~InlineFunction() {
+    this->Reset();
+  }
+
+  void operator()() {
+    mVTable->mInvoke(mStorage);
+  }
+
+  operator bool() const noexcept {
+    return mVTable;
+  }
+
+  bool IsInline() const noexcept {
+    return mVTable && mVTable->mIsInline;
+  }
+
+  void Reset() noexcept {
+    if (mVTable) {
+      std::exchange(mVTable, nullptr)->mDestroy(mStorage);
+    }
+  }
+
+  template <class T>
+  static constexpr bool IsInlineable = sizeof(T) <= TInlineSize
+    && alignof(T) <= alignof(std::max_align_t)
+    && std::is_nothrow_move_constructible_v<T>;
+
+ private:
+  static_assert(TInlineSize >= sizeof(void*));
+
+  struct VTable {
+    void (*mInvoke)(void*);
+    // Move-construct into uninitialized storage, and destroy the source
+    void (*mMove)(void* from, void* to) noexcept;
+    void (*mDestroy)(void*) noexcept;
+    bool mIsInline;
+  };
+
+  template <class T>
+  static constexpr VTable InlineVTable {
+    .mInvoke = [](void* p) { (*std::launder(reinterpret_cast<T*>(p)))(); },
+    .mMove =
+      [](void* from, void* to) noexcept {
+        auto source = std::launder(reinterpret_cast<T*>(from));
+        new (to) T(std::move(*source));
+        source->~T();
+      },
+    .mDestroy =
+      [](void* p) noexcept { std::launder(reinterpret_cast<T*>(p))->~T(); },
+    .mIsInline = true,
+  };
+
+  template <class T>
+  static constexpr VTable HeapVTable {
+    .mInvoke = [](void* p) { (**reinterpret_cast<T**>(p))(); },
+    .mMove =
+      [](void* from, void* to) noexcept {
+        *reinterpret_cast<T**>(to) = *reinterpret_cast<T**>(from);
+      },
+    .mDestroy = [](void* p) noexcept { delete *reinterpret_cast<T**>(p); },
+    .mIsInline = false,
+  };
+
+  alignas(std::max_align_t) std::byte mStorage[TInlineSize];
+  const VTable* mVTable {nullptr};
+};
+
+}// namespace OpenKneeboard
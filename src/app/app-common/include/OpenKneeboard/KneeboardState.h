@@ -21,6 +21,7 @@
 
 #include <OpenKneeboard/DXResources.h>
 #include <OpenKneeboard/Events.h>
+#include <OpenKneeboard/GameEventDispatcher.h>
 #include <OpenKneeboard/ProfileSettings.h>
 #include <OpenKneeboard/SHM.h>
 #include <OpenKneeboard/Settings.h>
@@ -31,7 +32,9 @@
 #include <winrt/Windows.Foundation.h>
 
 #include <memory>
+#include <optional>
 #include <shared_mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -44,11 +47,13 @@ class IKneeboardView;
 class InterprocessRenderer;
 class KneeboardView;
 class ITab;
+class SearchIndexer;
 class TabletInputAdapter;
 class TabsList;
 class UserInputDevice;
 struct BaseSetTabEvent;
 struct GameEvent;
+struct GameEventReplayStats;
 struct GameInstance;
 class GameEventServer;
 
@@ -86,12 +91,12 @@ class KneeboardState final
   Event<> evCurrentProfileChangedEvent;
   Event<> evViewOrderChangedEvent;
   Event<> evInputDevicesChangedEvent;
-  Event<GameEvent> evGameEvent;
   Event<DWORD, std::shared_ptr<GameInstance>> evGameChangedEvent;
 
   std::vector<std::shared_ptr<UserInputDevice>> GetInputDevices() const;
 
   GamesList* GetGamesList() const;
+  GameEventDispatcher* GetGameEventDispatcher() const;
   std::optional<RunningGame> GetCurrentGame() const;
 
   std::shared_ptr<TabletInputAdapter> GetTabletInputAdapter() const;
@@ -100,6 +105,8 @@ class KneeboardState final
   void SetProfileSettings(const ProfileSettings&);
 
   TabsList* GetTabsList() const;
+  /// Created on first use
+  SearchIndexer* GetSearchIndexer();
 
   winrt::Windows::Foundation::IAsyncAction ReleaseExclusiveResources();
   void AcquireExclusiveResources();
@@ -150,8 +157,17 @@ class KneeboardState final
   uint8_t mInputViewIndex = 0;
   std::array<std::shared_ptr<KneeboardView>, 2> mViews;
 
+  // Must be initialized before, and destroyed after, any tabs
+  std::unique_ptr<GameEventDispatcher> mGameEventDispatcher {
+    std::make_unique<GameEventDispatcher>()};
+  std::vector<GameEventDispatcher::Subscription> mGameEventSubscriptions;
+
   std::unique_ptr<GamesList> mGamesList;
   std::unique_ptr<TabsList> mTabsList;
+  // Must be destroyed before the tabs; created by `GetSearchIndexer()`
+  std::unique_ptr<SearchIndexer> mSearchIndexer;
+  // Received before the first index was built
+  std::optional<std::string> mPendingSearch;
   std::shared_ptr<InterprocessRenderer> mInterprocessRenderer;
   // Initalization and destruction order must match as they both use
   // SetWindowLongPtr
@@ -166,6 +182,19 @@ class KneeboardState final
 
   void OnGameChangedEvent(DWORD processID, std::shared_ptr<GameInstance> game);
   void OnGameEvent(const GameEvent& ev) noexcept;
+  void OnGameEventReplayCompleted(const GameEventReplayStats&);
+  void OnSetInputFocusEvent(const GameEvent&);
+  void OnRemoteUserActionEvent(const GameEvent&);
+  void OnSetTabByIDEvent(const GameEvent&);
+  void OnSetTabByNameEvent(const GameEvent&);
+  void OnSetTabByIndexEvent(const GameEvent&);
+  void OnSetProfileByIDEvent(const GameEvent&);
+  void OnSetProfileByNameEvent(const GameEvent&);
+  void OnSetBrightnessEvent(const GameEvent&);
+  void OnSearchEvent(const GameEvent&);
+  // Emitted from the indexer thread
+  winrt::fire_and_forget OnSearchIndexUpdatedEvent();
+  void RunPendingSearch();
 
   void StartOpenVRThread();
   void StartTabletInput();
@@ -0,0 +1,131 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/Events.h>
+#include <OpenKneeboard/ITab.h>
+#include <OpenKneeboard/LRUCache.h>
+#include <OpenKneeboard/SearchIndex.h>
+
+#include <OpenKneeboard/inttypes.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <d2d1.h>
+
+namespace OpenKneeboard {
+
+class IKneeboardView;
+class IPageSourceWithSearch;
+class TabsList;
+
+struct SearchResult final {
+  ITab::RuntimeID mTabID;
+  std::string mTabTitle;
+  PageID mPageID;
+  /// Normalized to the page: (0, 0) is top-left, (1, 1) is bottom-right
+  std::vector<D2D1_RECT_F> mRects;
+  std::string mSnippet;
+};
+
+/** Full-text search across all tabs.
+ *
+ * Tabs implementing `IPageSourceWithSearch` are indexed on a background
+ * thread; they're re-indexed when their content changes, but only if their
+ * search identity (usually the file size and content hash) has changed.
+ *
+ * Extracted text is also kept by content, so reloading a file or switching
+ * back to a profile doesn't extract unchanged files again.
+ */
+class SearchIndexer final : private EventReceiver {
+ public:
+  SearchIndexer() = delete;
+  explicit SearchIndexer(TabsList*);
+  ~SearchIndexer();
+
+  std::vector<SearchResult> Query(
+    std::string_view query,
+    size_t maxResults = 50) const;
+  SearchIndex::Stats GetStats() const;
+  /// Whether the first pass over the tabs has finished
+  bool IsIndexed() const;
+
+  /** Switch the view to the tab and page of a result.
+   *
+   * Returns false if the tab or page no longer exists.
+   */
+  static bool GoToResult(IKneeboardView*, const SearchResult&);
+
+  /// Emitted from the indexer thread when the index changes, and after the
+  /// first pass
+  Event<> evIndexUpdatedEvent;
+
+ private:
+  SearchIndex mIndex;
+
+  mutable std::mutex mMutex;
+  std::condition_variable_any mWake;
+  bool mDirty {true};
+  bool mIndexed {false};
+  std::unordered_map<uint64_t, std::weak_ptr<ITab>> mTabs;
+  std::vector<EventHandlerToken> mTabEvents;
+
+  struct TextCacheKey final {
+    uint64_t mSize {};
+    uint64_t mContentHash {};
+    bool operator==(const TextCacheKey&) const noexcept = default;
+  };
+  struct TextCacheKeyHash final {
+    size_t operator()(const TextCacheKey& key) const noexcept {
+      return key.mContentHash ^ key.mSize;
+    }
+  };
+  /// Pages are stored by index, as page IDs change when a file is reloaded
+  struct ExtractedText final {
+    std::vector<SearchPage> mPages;
+    std::vector<PageIndex> mPageIndices;
+  };
+  static constexpr size_t ExtractedTextBudget = 32 * 1024 * 1024;
+  // Only used on the indexer thread
+  LRUCache<TextCacheKey, std::shared_ptr<const ExtractedText>, TextCacheKeyHash>
+    mExtractedText {ExtractedTextBudget};
+
+  std::jthread mThread;
+
+  void OnTabsChanged(const std::vector<std::shared_ptr<ITab>>&);
+  void MarkDirty();
+  void Run(std::stop_token);
+  void UpdateIndex(std::stop_token);
+  std::optional<std::vector<SearchPage>> GetSearchPages(
+    const ITab&,
+    const IPageSourceWithSearch&,
+    const FileIdentity&);
+};
+
+}// namespace OpenKneeboard
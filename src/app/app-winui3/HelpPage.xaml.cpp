@@ -26,8 +26,10 @@
 #include "CheckForUpdates.h"
 #include "FilePicker.h"
 
+#include <OpenKneeboard/EventInstrumentation.h>
 #include <OpenKneeboard/Filesystem.h>
 #include <OpenKneeboard/LaunchURI.h>
+#include <OpenKneeboard/RasterCache.h>
 #include <OpenKneeboard/RuntimeFiles.h>
 #include <OpenKneeboard/Settings.h>
 #include <OpenKneeboard/TroubleshootingStore.h>
@@ -208,6 +210,30 @@ winrt::fire_and_forget HelpPage::OnExportClick(
 
   AddFile("debug-log.txt", winrt::to_string(GetDPrintMessagesAsWString()));
   AddFile("api-events.txt", GetGameEventsAsString());
+  if (EventInstrumentation::IsEnabled()) {
+    AddFile(
+      "event-stats.txt",
+      EventInstrumentation::FormatSnapshot(EventInstrumentation::GetSnapshot()));
+  }
+  {
+    const auto stats = gDXResources.mRasterCache->GetStats();
+    AddFile(
+      "render-cache.txt",
+      std::format(
+        "Budget:    {}MiB\n"
+        "Used:      {}MiB in {} bitmaps\n"
+        "Hit rate:  {:.1f}% ({} hits, {} misses)\n"
+        "Evictions: {}\n"
+        "Coalesced: {}",
+        stats.mCache.mBudget / (1024 * 1024),
+        stats.mCache.mCost / (1024 * 1024),
+        stats.mCache.mEntryCount,
+        stats.mCache.GetHitRate() * 100,
+        stats.mCache.mHits,
+        stats.mCache.mMisses,
+        stats.mCache.mEvictions,
+        stats.mCoalesced));
+  }
   AddFile("openxr.txt", GetOpenXRInfo());
   AddFile("update-history.txt", GetUpdateLog());
   AddFile("version.txt", mVersionClipboardData);
@@ -0,0 +1,75 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/CachingImageDecoder.h>
+#include <OpenKneeboard/FileSnapshot.h>
+#include <OpenKneeboard/PageImageCache.h>
+
+namespace OpenKneeboard {
+
+CachingImageDecoder::CachingImageDecoder(
+  std::shared_ptr<ImageDecoder> decoder,
+  std::shared_ptr<PageImageCache> cache)
+  : mDecoder(std::move(decoder)),
+    mCache(std::move(cache)) {
+}
+
+std::optional<ImageSize> CachingImageDecoder::ReadSize(
+  const std::filesystem::path& path) {
+  return mDecoder->ReadSize(path);
+}
+
+std::optional<DecodedImage> CachingImageDecoder::Decode(
+  const std::filesystem::path& path,
+  const ImageSize& maxSize,
+  std::stop_token stopToken) {
+  std::optional<FileIdentity> identity;
+  if (const auto snapshot = FileSnapshot::Read(path, {.mMaxAttempts = 1})) {
+    identity = snapshot->GetIdentity();
+  }
+  const auto nativeSize = mDecoder->ReadSize(path);
+  if (!(identity && nativeSize)) {
+    return mDecoder->Decode(path, maxSize, stopToken);
+  }
+
+  PageImageKey key {
+    .mPath = path,
+    .mSource = *identity,
+    .mSize = ScaleToFit(*nativeSize, maxSize),
+  };
+  if (auto cached = mCache->Load(key)) {
+    return cached;
+  }
+  if (stopToken.stop_requested()) {
+    return {};
+  }
+
+  auto decoded = mDecoder->Decode(path, maxSize, stopToken);
+  if (!decoded) {
+    return {};
+  }
+  // Don't store a newer version of the file under the old key
+  const auto current = FileIdentity::Stat(path);
+  if (current && current->HasSameMetadata(key.mSource)) {
+    mCache->StoreInBackground(std::move(key), *decoded);
+  }
+  return decoded;
+}
+
+}// namespace OpenKneeboard
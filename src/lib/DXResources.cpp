@@ -19,6 +19,12 @@
  */
 #include <OpenKneeboard/DXResources.h>
 
+#include <OpenKneeboard/CachingImageDecoder.h>
+#include <OpenKneeboard/Filesystem.h>
+#include <OpenKneeboard/ImageDecodePool.h>
+#include <OpenKneeboard/PageImageCache.h>
+#include <OpenKneeboard/RasterCache.h>
+#include <OpenKneeboard/WICImageDecoder.h>
 #include <OpenKneeboard/dprint.h>
 #include <OpenKneeboard/scope_guard.h>
 
@@ -76,6 +82,9 @@ DXResources DXResources::Create() {
   }
   dprint("----------");
 
+  DXGI_ADAPTER_DESC1 bestAdapterDesc {};
+  winrt::check_hresult(bestAdapter->GetDesc1(&bestAdapterDesc));
+
   winrt::com_ptr<ID3D11Device> d3d;
   winrt::check_hresult(D3D11CreateDevice(
     bestAdapter.get(),
@@ -131,6 +140,14 @@ DXResources DXResources::Create() {
     PdfCreateRenderer(ret.mDXGIDevice.get(), ret.mPDFRenderer.put()));
 
   ret.mLocks = std::make_shared<Locks>();
+  ret.mRasterCache = std::make_shared<RasterCache>(
+    RasterCache::GetByteBudgetForVideoMemory(
+      bestAdapterDesc.DedicatedVideoMemory));
+  ret.mPageImageCache = std::make_shared<PageImageCache>(
+    Filesystem::GetCacheDirectory() / "PageImages");
+  ret.mImageDecodePool
+    = std::make_shared<ImageDecodePool>(std::make_shared<CachingImageDecoder>(
+      std::make_shared<WICImageDecoder>(ret.mWIC), ret.mPageImageCache));
 
   winrt::check_hresult(ret.mD2DDeviceContext->CreateSolidColorBrush(
     D2D1::ColorF(1.0f, 1.0f, 1.0f, 1.0f), ret.mWhiteBrush.put()));
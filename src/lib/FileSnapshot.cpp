@@ -0,0 +1,487 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/FileSnapshot.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <shims/winrt/base.h>
+
+#include <Windows.h>
+#else
+#include <fstream>
+#endif
+
+namespace OpenKneeboard {
+
+namespace {
+
+/// `HashFileContent()`, a chunk at a time
+class ContentHasher final {
+ public:
+  explicit ContentHasher(uint64_t totalSize) : mHash(Seed ^ totalSize) {
+  }
+
+  /// Every chunk except the last must be a whole number of words
+  void Update(std::span<const std::byte> bytes) noexcept {
+    // FNV-1a-style, but a word at a time; byte-at-a-time is noticeably slow
+    // for large PDFs
+    const auto wordCount = bytes.size() / sizeof(uint64_t);
+    for (size_t i = 0; i < wordCount; ++i) {
+      uint64_t word;
+      memcpy(&word, bytes.data() + (i * sizeof(word)), sizeof(word));
+      mHash = std::rotl((mHash ^ word) * Prime, 29);
+    }
+    for (size_t i = wordCount * sizeof(uint64_t); i < bytes.size(); ++i) {
+      mHash = (mHash ^ static_cast<uint8_t>(bytes[i])) * Prime;
+    }
+  }
+
+  uint64_t Finish() const noexcept {
+    // Final avalanche (MurmurHash3's fmix64)
+    auto hash = mHash;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+ private:
+  static constexpr uint64_t Seed = 0xcbf29ce484222325;
+  static constexpr uint64_t Prime = 0x100000001b3;
+  uint64_t mHash {};
+};
+
+// Large enough to keep per-read overhead low, small enough that hashing a
+// large PDF doesn't need a copy of it
+constexpr size_t HashChunkSize = 1024 * 1024;
+static_assert(HashChunkSize % sizeof(uint64_t) == 0);
+
+#ifdef _WIN32
+winrt::file_handle OpenForSharedRead(
+  const std::filesystem::path& path,
+  DWORD flags) {
+  // Share everything so that we never stop an editor saving or replacing
+  // the file; if that happens, the caller will notice and retry
+  return winrt::file_handle {CreateFileW(
+    path.c_str(),
+    GENERIC_READ,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+    nullptr,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | flags,
+    NULL)};
+}
+
+/// Metadata of the file we actually opened, even if the path was replaced
+std::optional<FileIdentity> StatOpenFile(HANDLE file) {
+  BY_HANDLE_FILE_INFORMATION info {};
+  if (!GetFileInformationByHandle(file, &info)) {
+    return {};
+  }
+  const auto& writeTime = info.ftLastWriteTime;
+  // MSVC's `file_clock` has the same epoch and resolution as `FILETIME`
+  const std::filesystem::file_time_type::duration ticks {static_cast<int64_t>(
+    (static_cast<uint64_t>(writeTime.dwHighDateTime) << 32)
+    | writeTime.dwLowDateTime)};
+  return FileIdentity {
+    .mSize = (static_cast<uint64_t>(info.nFileSizeHigh) << 32)
+      | info.nFileSizeLow,
+    .mLastWriteTime = std::filesystem::file_time_type {ticks},
+  };
+}
+
+std::optional<std::vector<std::byte>> ReadFileContent(
+  const std::filesystem::path& path,
+  uint64_t expectedSize) {
+  const auto file = OpenForSharedRead(path, FILE_FLAG_SEQUENTIAL_SCAN);
+  if (!file) {
+    return {};
+  }
+
+  std::vector<std::byte> buffer(expectedSize + 1);
+  uint64_t offset = 0;
+  while (offset < buffer.size()) {
+    const auto remaining = buffer.size() - offset;
+    const auto chunkSize = static_cast<DWORD>(
+      std::min<uint64_t>(remaining, 64 * 1024 * 1024));
+    DWORD bytesRead {};
+    if (!ReadFile(
+          file.get(), buffer.data() + offset, chunkSize, &bytesRead, nullptr)) {
+      return {};
+    }
+    if (bytesRead == 0) {
+      break;
+    }
+    offset += bytesRead;
+  }
+  // Short read, or it grew while we were reading it
+  if (offset != expectedSize) {
+    return {};
+  }
+  buffer.resize(expectedSize);
+  return buffer;
+}
+
+std::optional<uint64_t> HashFileContent(
+  const std::filesystem::path& path,
+  uint64_t expectedSize) {
+  const auto file = OpenForSharedRead(path, FILE_FLAG_SEQUENTIAL_SCAN);
+  if (!file) {
+    return {};
+  }
+
+  ContentHasher hasher {expectedSize};
+  std::vector<std::byte> buffer(HashChunkSize);
+  uint64_t offset = 0;
+  while (true) {
+    // `ReadFile()` may return less than asked for before the end of the
+    // file, but the hasher needs whole words until the last chunk
+    DWORD filled = 0;
+    while (filled < buffer.size()) {
+      DWORD bytesRead {};
+      if (!ReadFile(
+            file.get(),
+            buffer.data() + filled,
+            static_cast<DWORD>(buffer.size() - filled),
+            &bytesRead,
+            nullptr)) {
+        return {};
+      }
+      if (bytesRead == 0) {
+        break;
+      }
+      filled += bytesRead;
+    }
+    offset += filled;
+    // It grew while we were reading it
+    if (offset > expectedSize) {
+      return {};
+    }
+    hasher.Update({buffer.data(), filled});
+    if (filled < buffer.size()) {
+      break;
+    }
+  }
+  if (offset != expectedSize) {
+    return {};
+  }
+  return hasher.Finish();
+}
+#else
+std::optional<std::vector<std::byte>> ReadFileContent(
+  const std::filesystem::path& path,
+  uint64_t expectedSize) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    return {};
+  }
+  std::vector<std::byte> buffer(expectedSize + 1);
+  f.read(
+    reinterpret_cast<char*>(buffer.data()),
+    static_cast<std::streamsize>(buffer.size()));
+  if (static_cast<uint64_t>(f.gcount()) != expectedSize) {
+    return {};
+  }
+  buffer.resize(expectedSize);
+  return buffer;
+}
+
+std::optional<uint64_t> HashFileContent(
+  const std::filesystem::path& path,
+  uint64_t expectedSize) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    return {};
+  }
+  ContentHasher hasher {expectedSize};
+  std::vector<std::byte> buffer(HashChunkSize);
+  uint64_t offset = 0;
+  // `read()` only stops short at the end of the file, so every chunk
+  // except the last is whole
+  while (f) {
+    f.read(
+      reinterpret_cast<char*>(buffer.data()),
+      static_cast<std::streamsize>(buffer.size()));
+    const auto bytesRead = static_cast<size_t>(f.gcount());
+    offset += bytesRead;
+    if (offset > expectedSize) {
+      return {};
+    }
+    hasher.Update({buffer.data(), bytesRead});
+  }
+  if (offset != expectedSize) {
+    return {};
+  }
+  return hasher.Finish();
+}
+#endif
+
+}// namespace
+
+std::optional<FileIdentity> FileIdentity::Stat(
+  const std::filesystem::path& path) {
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(path, ec)) {
+    return {};
+  }
+  const auto size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return {};
+  }
+  const auto lastWriteTime = std::filesystem::last_write_time(path, ec);
+  if (ec) {
+    return {};
+  }
+  return FileIdentity {
+    .mSize = size,
+    .mLastWriteTime = lastWriteTime,
+  };
+}
+
+bool FileIdentity::HasSameMetadata(const FileIdentity& other) const noexcept {
+  return mSize == other.mSize && mLastWriteTime == other.mLastWriteTime;
+}
+
+bool FileIdentity::HasSameContent(const FileIdentity& other) const noexcept {
+  return mSize == other.mSize && mContentHash == other.mContentHash;
+}
+
+uint64_t HashFileContent(std::span<const std::byte> bytes) noexcept {
+  ContentHasher hasher {bytes.size()};
+  hasher.Update(bytes);
+  return hasher.Finish();
+}
+
+FileSnapshot::FileSnapshot(
+  const std::filesystem::path& path,
+  const FileIdentity& identity,
+  std::vector<std::byte>&& bytes)
+  : mPath(path), mIdentity(identity), mBytes(std::move(bytes)) {
+}
+
+std::shared_ptr<FileSnapshot> FileSnapshot::Read(
+  const std::filesystem::path& path) {
+  return Read(path, {});
+}
+
+std::shared_ptr<FileSnapshot> FileSnapshot::Read(
+  const std::filesystem::path& path,
+  const Options& options) {
+  for (size_t attempt = 0; attempt < options.mMaxAttempts; ++attempt) {
+    if (attempt > 0) {
+      std::this_thread::sleep_for(options.mRetryDelay);
+    }
+
+    // A missing file may just be mid-replace, so retry that too
+    const auto before = FileIdentity::Stat(path);
+    if (!before) {
+      continue;
+    }
+
+    auto bytes = ReadFileContent(path, before->mSize);
+    if (!bytes) {
+      continue;
+    }
+
+    const auto after = FileIdentity::Stat(path);
+    if (!(after && after->HasSameMetadata(*before))) {
+      continue;
+    }
+
+    auto identity = *before;
+    identity.mContentHash = HashFileContent(*bytes);
+    return std::shared_ptr<FileSnapshot>(
+      new FileSnapshot(path, identity, std::move(*bytes)));
+  }
+  return nullptr;
+}
+
+std::filesystem::path FileSnapshot::GetPath() const noexcept {
+  return mPath;
+}
+
+const FileIdentity& FileSnapshot::GetIdentity() const noexcept {
+  return mIdentity;
+}
+
+std::span<const std::byte> FileSnapshot::GetBytes() const noexcept {
+  return mBytes;
+}
+
+FileRangeReader::FileRangeReader(
+  const std::filesystem::path& path,
+  const FileIdentity& identity)
+  : mPath(path), mIdentity(identity) {
+}
+
+std::shared_ptr<FileRangeReader> FileRangeReader::Open(
+  const std::filesystem::path& path) {
+  return Open(path, {});
+}
+
+std::shared_ptr<FileRangeReader> FileRangeReader::Open(
+  const std::filesystem::path& path,
+  const FileSnapshot::Options& options) {
+  for (size_t attempt = 0; attempt < options.mMaxAttempts; ++attempt) {
+    if (attempt > 0) {
+      std::this_thread::sleep_for(options.mRetryDelay);
+    }
+
+    const auto before = FileIdentity::Stat(path);
+    if (!before) {
+      continue;
+    }
+
+    const auto hash = HashFileContent(path, before->mSize);
+    if (!hash) {
+      continue;
+    }
+
+    const auto after = FileIdentity::Stat(path);
+    if (!(after && after->HasSameMetadata(*before))) {
+      continue;
+    }
+
+    auto identity = *before;
+    identity.mContentHash = *hash;
+    return std::shared_ptr<FileRangeReader>(
+      new FileRangeReader(path, identity));
+  }
+  return nullptr;
+}
+
+std::filesystem::path FileRangeReader::GetPath() const noexcept {
+  return mPath;
+}
+
+const FileIdentity& FileRangeReader::GetIdentity() const noexcept {
+  return mIdentity;
+}
+
+#ifdef _WIN32
+std::optional<size_t> FileRangeReader::ReadAt(
+  uint64_t offset,
+  std::span<std::byte> buffer) const {
+  // Reopened for every read so that we never hold the file open; these are
+  // cheap compared to the parsing or rendering they're for
+  const auto file = OpenForSharedRead(mPath, FILE_FLAG_RANDOM_ACCESS);
+  if (!file) {
+    return {};
+  }
+  const auto before = StatOpenFile(file.get());
+  if (!(before && before->HasSameMetadata(mIdentity))) {
+    return {};
+  }
+  if (offset >= mIdentity.mSize) {
+    return 0;
+  }
+
+  const auto length = static_cast<DWORD>(std::min<uint64_t>(
+    {buffer.size(), mIdentity.mSize - offset, 64 * 1024 * 1024}));
+  OVERLAPPED overlapped {};
+  overlapped.Offset = static_cast<DWORD>(offset);
+  overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+  DWORD bytesRead {};
+  if (!ReadFile(file.get(), buffer.data(), length, &bytesRead, &overlapped)) {
+    return {};
+  }
+
+  // Modified in place while we were reading
+  const auto after = StatOpenFile(file.get());
+  if (!(after && after->HasSameMetadata(mIdentity))) {
+    return {};
+  }
+  return bytesRead;
+}
+#else
+std::optional<size_t> FileRangeReader::ReadAt(
+  uint64_t offset,
+  std::span<std::byte> buffer) const {
+  const auto before = FileIdentity::Stat(mPath);
+  if (!(before && before->HasSameMetadata(mIdentity))) {
+    return {};
+  }
+  if (offset >= mIdentity.mSize) {
+    return 0;
+  }
+
+  std::ifstream f(mPath, std::ios::binary);
+  if (!f.seekg(static_cast<std::streamoff>(offset))) {
+    return {};
+  }
+  const auto length
+    = std::min<uint64_t>(buffer.size(), mIdentity.mSize - offset);
+  f.read(
+    reinterpret_cast<char*>(buffer.data()),
+    static_cast<std::streamsize>(length));
+
+  const auto after = FileIdentity::Stat(mPath);
+  if (!(after && after->HasSameMetadata(mIdentity))) {
+    return {};
+  }
+  return static_cast<size_t>(f.gcount());
+}
+#endif
+
+std::shared_ptr<FileSnapshot> FileRangeReader::ReadSnapshot() const {
+  std::vector<std::byte> bytes(mIdentity.mSize);
+  uint64_t offset = 0;
+  while (offset < bytes.size()) {
+    const auto bytesRead
+      = this->ReadAt(offset, std::span {bytes}.subspan(offset));
+    if (!bytesRead.value_or(0)) {
+      return nullptr;
+    }
+    offset += *bytesRead;
+  }
+  return std::shared_ptr<FileSnapshot>(
+    new FileSnapshot(mPath, mIdentity, std::move(bytes)));
+}
+
+bool FileChangeDetector::MayHaveChanged(
+  const std::filesystem::path& path) const {
+  if (!mCurrent) {
+    return true;
+  }
+  const auto identity = FileIdentity::Stat(path);
+  return !(identity && identity->HasSameMetadata(*mCurrent));
+}
+
+bool FileChangeDetector::Commit(const FileSnapshot& snapshot) {
+  return this->Commit(snapshot.GetIdentity());
+}
+
+bool FileChangeDetector::Commit(const FileIdentity& identity) {
+  const auto changed = !(mCurrent && mCurrent->HasSameContent(identity));
+  mCurrent = identity;
+  return changed;
+}
+
+void FileChangeDetector::Reset() {
+  mCurrent = {};
+}
+
+}// namespace OpenKneeboard
@@ -18,9 +18,12 @@
  * USA.
  */
 #include <OpenKneeboard/Filesystem.h>
+#include <OpenKneeboard/config.h>
 
 #include <Windows.h>
 
+#include <ShlObj.h>
+
 #include <format>
 
 namespace OpenKneeboard::Filesystem {
@@ -92,35 +95,42 @@ std::filesystem::path GetRuntimeDirectory() {
   return sCache;
 }
 
-ScopedDeleter::ScopedDeleter(const std::filesystem::path& path) : mPath(path) {
-}
-
-ScopedDeleter::~ScopedDeleter() noexcept {
-  if (std::filesystem::exists(mPath)) {
-    std::filesystem::remove_all(mPath);
+std::filesystem::path GetCacheDirectory() {
+  static std::filesystem::path sCache;
+  static std::mutex sMutex;
+  std::unique_lock lock(sMutex);
+  if (!sCache.empty()) {
+    return sCache;
   }
-}
 
-TemporaryCopy::TemporaryCopy(
-  const std::filesystem::path& source,
-  const std::filesystem::path& destination) {
-  if (!std::filesystem::exists(source)) {
-    throw std::logic_error("TemporaryCopy created without a source file");
+  wchar_t* localAppData {nullptr};
+  if (
+    SHGetKnownFolderPath(FOLDERID_LocalAppData, NULL, NULL, &localAppData)
+      != S_OK
+    || !localAppData) {
+    return GetTemporaryDirectory();
   }
-  if (std::filesystem::exists(destination)) {
-    throw std::logic_error(
-      "TemporaryCopy created, but destination already exists");
+  const auto path
+    = std::filesystem::path(localAppData) / ProjectNameW / L"Cache";
+  CoTaskMemFree(localAppData);
+
+  std::error_code ec;
+  std::filesystem::create_directories(path, ec);
+  if (ec) {
+    return GetTemporaryDirectory();
   }
-  std::filesystem::copy(source, destination);
-  mCopy = destination;
+
+  sCache = path;
+  return sCache;
 }
 
-TemporaryCopy::~TemporaryCopy() noexcept {
-  std::filesystem::remove(mCopy);
+ScopedDeleter::ScopedDeleter(const std::filesystem::path& path) : mPath(path) {
 }
 
-std::filesystem::path TemporaryCopy::GetPath() const noexcept {
-  return mCopy;
+ScopedDeleter::~ScopedDeleter() noexcept {
+  if (std::filesystem::exists(mPath)) {
+    std::filesystem::remove_all(mPath);
+  }
 }
 
 };// namespace OpenKneeboard::Filesystem
@@ -18,6 +18,8 @@
  * USA.
  */
 #include <OpenKneeboard/GameEvent.h>
+#include <OpenKneeboard/GameEventRing.h>
+#include <OpenKneeboard/GameEventSender.h>
 #include <OpenKneeboard/config.h>
 #include <OpenKneeboard/dprint.h>
 #include <OpenKneeboard/json.h>
@@ -25,140 +27,421 @@
 #include <Windows.h>
 #include <shims/winrt/base.h>
 
-#include <charconv>
 #include <chrono>
+#include <cstdlib>
+#include <optional>
 #include <string_view>
+#include <utility>
 
-static uint32_t hex_to_ui32(const std::string_view& sv) {
-  if (sv.empty()) {
-    return 0;
-  }
+namespace OpenKneeboard {
 
-  uint32_t value = 0;
-  std::from_chars(&sv.front(), &sv.front() + sv.length(), value, 16);
-  return value;
-}
+namespace {
+
+/** Writes to the mailslot created by GameEventServer.
+ *
+ * Binary packets are split into one legacy text packet per event unless the
+ * server has said that it supports them, so that newer API DLLs still work
+ * with older versions of OpenKneeboard.
+ */
+class MailslotTransport final : public GameEventTransport {
+ public:
+  bool Write(std::span<const std::byte> packet) override;
+
+ private:
+  winrt::file_handle mHandle;
+  bool mBinaryPackets {false};
+  std::chrono::steady_clock::time_point mLastAttempt {};
 
-static winrt::file_handle gMailslotHandle;
+  bool OpenHandle();
+  bool WriteToHandle(std::span<const std::byte> packet);
+  bool WritePacket(std::span<const std::byte> packet);
+};
 
-static bool OpenMailslotHandle() {
-  if (gMailslotHandle) {
+bool MailslotTransport::OpenHandle() {
+  if (mHandle) {
     return true;
   }
 
-  static std::chrono::steady_clock::time_point sLastAttempt {};
   const auto now = std::chrono::steady_clock::now();
-  if (now - sLastAttempt < std::chrono::seconds(1)) {
+  if (now - mLastAttempt < std::chrono::seconds(1)) {
     return false;
   }
-  sLastAttempt = now;
+  mLastAttempt = now;
 
-  gMailslotHandle = {CreateFileA(
-    OpenKneeboard::GameEvent::GetMailslotPath(),
+  mHandle = {CreateFileA(
+    GameEvent::GetMailslotPath(),
     GENERIC_WRITE,
     FILE_SHARE_READ,
     nullptr,
     OPEN_EXISTING,
     0,
     NULL)};
-
-  return static_cast<bool>(gMailslotHandle);
-}
-
-namespace OpenKneeboard {
-
-#define CHECK_PACKET(condition) \
-  if (!(condition)) { \
-    dprintf("Check failed at {}:{}: {}", __FILE__, __LINE__, #condition); \
-    return {}; \
+  if (!mHandle) {
+    return false;
   }
 
-GameEvent::operator bool() const {
-  return !(name.empty() || value.empty());
+  // Checked on every reconnect, as the server may have been replaced by a
+  // different version
+  const winrt::handle binaryPacketsEvent {
+    OpenEventW(SYNCHRONIZE, FALSE, GameEvent::GetBinaryPacketsEventName())};
+  mBinaryPackets = static_cast<bool>(binaryPacketsEvent);
+  return true;
 }
 
-GameEvent GameEvent::Unserialize(std::string_view packet) {
-  // "{:08x}!{}!{:08x}!{}!", name size, name, value size, value
-  CHECK_PACKET(packet.ends_with("!"));
-  CHECK_PACKET(packet.size() >= sizeof("12345678!!12345678!!") - 1);
-
-  const auto nameLen = hex_to_ui32(packet.substr(0, 8));
-  CHECK_PACKET(packet.size() >= 8 + nameLen + 8 + 4);
-  const uint32_t nameOffset = 9;
-  const std::string name(packet.substr(nameOffset, nameLen));
-
-  const uint32_t valueLenOffset = nameOffset + nameLen + 1;
-  CHECK_PACKET(packet.size() >= valueLenOffset + 10);
-  const auto valueLen = hex_to_ui32(packet.substr(valueLenOffset, 8));
-  const uint32_t valueOffset = valueLenOffset + 8 + 1;
-  CHECK_PACKET(packet.size() == valueOffset + valueLen + 1);
-  const std::string value(packet.substr(valueOffset, valueLen));
-
-  return {name, value};
+bool MailslotTransport::WriteToHandle(std::span<const std::byte> packet) {
+  return WriteFile(
+    mHandle.get(),
+    packet.data(),
+    static_cast<DWORD>(packet.size()),
+    nullptr,
+    nullptr);
 }
 
-std::vector<std::byte> GameEvent::Serialize() const {
-  const auto str = std::format(
-    "{:08x}!{}!{:08x}!{}!", name.size(), name, value.size(), value);
-  const auto first = reinterpret_cast<const std::byte*>(str.data());
-  return {first, first + str.size()};
+bool MailslotTransport::Write(std::span<const std::byte> packet) {
+  if (!this->OpenHandle()) {
+    return false;
+  }
+  if (mBinaryPackets) {
+    return this->WritePacket(packet);
+  }
+
+  const GameEventPacket parsed(
+    {reinterpret_cast<const char*>(packet.data()), packet.size()});
+  for (const auto& event: parsed) {
+    const auto text = SerializeLegacyGameEvent(event);
+    if (!this->WritePacket(std::as_bytes(std::span {text}))) {
+      return false;
+    }
+  }
+  return true;
 }
 
-void GameEvent::Send() const {
+bool MailslotTransport::WritePacket(std::span<const std::byte> packet) {
   TraceLoggingThreadActivity<gTraceProvider> activity;
   TraceLoggingWriteStart(
     activity,
-    "GameEvent::Send()",
-    TraceLoggingValue(this->name.c_str(), "Name"),
-    TraceLoggingBinary(this->value.c_str(), this->value.size(), "Value"));
+    "MailslotTransport::Write()",
+    TraceLoggingValue(packet.size(), "Bytes"));
 
-  if (!OpenMailslotHandle()) {
+  if (!OpenHandle()) {
     TraceLoggingWriteStop(
       activity,
-      "GameEvent::Send()",
+      "MailslotTransport::Write()",
       TraceLoggingValue("Couldn't open mailslot", "Result"));
-    return;
+    return false;
   }
-  const auto packet = this->Serialize();
 
-  if (WriteFile(
-        gMailslotHandle.get(),
-        packet.data(),
-        static_cast<DWORD>(packet.size()),
-        nullptr,
-        nullptr)) {
+  if (WriteToHandle(packet)) {
     TraceLoggingWriteStop(
-      activity, "GameEvent::Send()", TraceLoggingValue("Success", "Result"));
-    return;
+      activity,
+      "MailslotTransport::Write()",
+      TraceLoggingValue("Success", "Result"));
+    return true;
   }
 
-  gMailslotHandle.close();
-  gMailslotHandle = {};
+  mHandle.close();
+  mHandle = {};
   TraceLoggingWriteTagged(activity, "Closed handle");
 
-  if (!OpenMailslotHandle()) {
+  if (!OpenHandle()) {
     TraceLoggingWriteStop(
       activity,
-      "GameEvent::Send()",
+      "MailslotTransport::Write()",
       TraceLoggingValue("Couldn't reopen handle", "Result"));
-    return;
+    return false;
   }
   TraceLoggingWriteTagged(activity, "Reopened handle");
-  if (WriteFile(
-        gMailslotHandle.get(),
-        packet.data(),
-        static_cast<DWORD>(packet.size()),
-        nullptr,
-        nullptr)) {
-    TraceLoggingWriteStop(
-      activity, "GameEvent::Send()", TraceLoggingValue("Success", "Result"));
-  } else {
+  if (WriteToHandle(packet)) {
     TraceLoggingWriteStop(
       activity,
-      "GameEvent::Send()",
-      TraceLoggingValue("Error", "Result"),
-      TraceLoggingValue(GetLastError(), "Error"));
+      "MailslotTransport::Write()",
+      TraceLoggingValue("Success", "Result"));
+    return true;
+  }
+
+  TraceLoggingWriteStop(
+    activity,
+    "MailslotTransport::Write()",
+    TraceLoggingValue("Error", "Result"),
+    TraceLoggingValue(GetLastError(), "Error"));
+  return false;
+}
+
+/** Writes to a GameEventRing in a shared memory mapping owned by this
+ * process.
+ *
+ * The server is told about the mapping with an EVT_REGISTER_RING event via
+ * the mailslot. Each event goes through exactly one of the mailslot and the
+ * ring, and the switches between them keep the events in order:
+ *
+ * - Until the server has attached to the ring, events go through the
+ *   mailslot; servers that don't support rings never attach.
+ * - Once it has, an EVT_ACTIVATE_RING event is the last thing sent through
+ *   the mailslot; the server only reads the ring after it has dispatched
+ *   that.
+ * - If the server stops responding, the ring is abandoned, dropping anything
+ *   that's still in it, and a new ring is registered; events go through the
+ *   mailslot until a server attaches to that.
+ */
+class SharedMemoryTransport final : public GameEventTransport {
+ public:
+  SharedMemoryTransport();
+  ~SharedMemoryTransport();
+
+  bool Write(std::span<const std::byte> packet) override;
+
+ private:
+  static constexpr size_t Capacity = 256 * 1024;
+  // GameEventServer heartbeats at least once per second
+  static constexpr auto HeartbeatTimeout = std::chrono::seconds(5);
+
+  MailslotTransport mMailslot;
+  std::string mMappingName;
+  winrt::handle mMapping;
+  void* mView {nullptr};
+  std::optional<GameEventRing> mRing;
+  // Whether we've sent EVT_ACTIVATE_RING for `mRing`
+  bool mRingActive {false};
+  // Used to make each ring's mapping name unique
+  uint32_t mRingCount {0};
+
+  winrt::handle mWakeEvent;
+  std::chrono::steady_clock::time_point mLastWakeEventAttempt {};
+  std::chrono::steady_clock::time_point mLastRegistration {};
+  // Packets that were discarded because the ring stayed full
+  uint64_t mDroppedPackets {0};
+
+  void CreateRing();
+  void CloseRing();
+  void AbandonRing();
+  void Register();
+  bool Activate();
+  void Wake();
+};
+
+SharedMemoryTransport::SharedMemoryTransport() {
+  this->CreateRing();
+}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+  this->CloseRing();
+}
+
+void SharedMemoryTransport::CreateRing() {
+  const auto byteCount = GameEventRing::GetByteCount(Capacity);
+  mMappingName = std::format(
+    "Local\\{}.GameEvents.Ring.{}.{}.{}",
+    ProjectNameA,
+    GetCurrentProcessId(),
+    GetTickCount64(),
+    mRingCount++);
+  mMapping.attach(CreateFileMappingA(
+    INVALID_HANDLE_VALUE,
+    nullptr,
+    PAGE_READWRITE,
+    0,
+    static_cast<DWORD>(byteCount),
+    mMappingName.c_str()));
+  if (!mMapping) {
+    dprintf("Failed to create GameEvent ring mapping: {}", GetLastError());
+    return;
+  }
+  mView = MapViewOfFile(mMapping.get(), FILE_MAP_WRITE, 0, 0, byteCount);
+  if (!mView) {
+    dprintf("Failed to map GameEvent ring: {}", GetLastError());
+    return;
+  }
+  mRing = GameEventRing::Create(mView, byteCount);
+}
+
+void SharedMemoryTransport::CloseRing() {
+  mRing = {};
+  mRingActive = false;
+  if (mView) {
+    UnmapViewOfFile(std::exchange(mView, nullptr));
+  }
+  mMapping = {};
+}
+
+void SharedMemoryTransport::AbandonRing() {
+  const auto pending = mRing->GetPendingByteCount();
+  mRing->Abandon();
+  dprintf(
+    "GameEvent ring consumer stopped responding; dropped {} bytes of unread "
+    "events, and using the mailslot until a server attaches to a new ring",
+    pending);
+  this->CloseRing();
+  this->CreateRing();
+  mWakeEvent = {};
+  mLastRegistration = {};
+}
+
+void SharedMemoryTransport::Register() {
+  const auto now = std::chrono::steady_clock::now();
+  if (now - mLastRegistration < std::chrono::seconds(1)) {
+    return;
+  }
+  mLastRegistration = now;
+
+  const auto packet = GameEvent::FromStruct(RegisterGameEventRingEvent {
+                                              .mMappingName = mMappingName,
+                                              .mByteCount
+                                              = GameEventRing::GetByteCount(
+                                                Capacity),
+                                              .mProcessID
+                                              = GetCurrentProcessId(),
+                                            })
+                        .Serialize();
+  mMailslot.Write(packet);
+}
+
+bool SharedMemoryTransport::Activate() {
+  const auto packet = GameEvent::FromStruct(ActivateGameEventRingEvent {
+                                              .mMappingName = mMappingName,
+                                            })
+                        .Serialize();
+  return mMailslot.Write(packet);
+}
+
+void SharedMemoryTransport::Wake() {
+  if (!mWakeEvent) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now - mLastWakeEventAttempt < std::chrono::seconds(1)) {
+      return;
+    }
+    mLastWakeEventAttempt = now;
+    mWakeEvent.attach(OpenEventW(
+      EVENT_MODIFY_STATE, FALSE, GameEvent::GetRingWakeEventName()));
+    if (!mWakeEvent) {
+      return;
+    }
+  }
+  SetEvent(mWakeEvent.get());
+}
+
+bool SharedMemoryTransport::Write(std::span<const std::byte> packet) {
+  if (!mRing) {
+    return mMailslot.Write(packet);
+  }
+
+  if (!mRingActive) {
+    if (!mRing->IsConsumerAttached()) {
+      // The server hasn't attached yet, or doesn't support rings
+      this->Register();
+      return mMailslot.Write(packet);
+    }
+    if (!this->Activate()) {
+      // Try again with the next packet; until then, keep to the mailslot
+      return mMailslot.Write(packet);
+    }
+    mRingActive = true;
+  }
+
+  // If the server is running, give it a chance to catch up
+  for (int i = 0; i < 100; ++i) {
+    if (!mRing->IsConsumerAlive(
+          std::chrono::steady_clock::now(), HeartbeatTimeout)) {
+      // The server crashed or hung, so nothing may ever read the ring
+      this->AbandonRing();
+      this->Register();
+      return mMailslot.Write(packet);
+    }
+    if (mRing->TryWrite(packet)) {
+      this->Wake();
+      return true;
+    }
+    this->Wake();
+    Sleep(1);
+  }
+  // The sender counts this as a write failure
+  ++mDroppedPackets;
+  dprintf(
+    "GameEvent ring stayed full for 100ms; dropped a {}-byte packet ({} "
+    "dropped so far)",
+    packet.size(),
+    mDroppedPackets);
+  return false;
+}
+
+std::unique_ptr<GameEventTransport> CreateTransport() {
+  // Opt-in for now
+  const auto transport = std::getenv("OPENKNEEBOARD_GAMEEVENT_TRANSPORT");
+  if (transport && std::string_view {transport} == "shm") {
+    return std::make_unique<SharedMemoryTransport>();
+  }
+  return std::make_unique<MailslotTransport>();
+}
+
+GameEventSender& GetSender();
+
+/* In a DLL - such as the C or Lua APIs - the sender's thread runs code from
+ * the DLL, and is only stopped when the process exits; if the DLL were
+ * unloaded by `FreeLibrary()`, the thread would crash the host process. Pin
+ * the DLL so that it is never unloaded.
+ */
+void PinModuleIfDLL() {
+  HMODULE module {nullptr};
+  if (!GetModuleHandleExW(
+        GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS
+          | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+        reinterpret_cast<LPCWSTR>(&GetSender),
+        &module)) {
+    return;
+  }
+  if (module == GetModuleHandleW(nullptr)) {
+    return;
+  }
+  GetModuleHandleExW(
+    GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_PIN,
+    reinterpret_cast<LPCWSTR>(&GetSender),
+    &module);
+}
+
+GameEventSender CreateSender() {
+  PinModuleIfDLL();
+  return GameEventSender {
+    CreateTransport(),
+    {
+      .mEventsAbandoned =
+        [](uint64_t count) {
+          dprintf("GameEvent sender gave up on {} unsent events", count);
+        },
+    },
+  };
+}
+
+GameEventSender& GetSender() {
+  static GameEventSender sSender = CreateSender();
+  return sSender;
+}
+
+}// namespace
+
+void GameEvent::Send() const {
+  TraceLoggingWrite(
+    gTraceProvider,
+    "GameEvent::Send()",
+    TraceLoggingValue(this->name.c_str(), "Name"),
+    TraceLoggingBinary(this->value.c_str(), this->value.size(), "Value"));
+  GetSender().Enqueue(*this);
+}
+
+const wchar_t* GameEvent::GetRingWakeEventName() {
+  static std::wstring sName;
+  if (sName.empty()) {
+    sName = std::format(
+      L"Local\\{}.GameEvents.Ring.Wake.v1", OpenKneeboard::ProjectNameW);
+  }
+  return sName.c_str();
+}
+
+const wchar_t* GameEvent::GetBinaryPacketsEventName() {
+  static std::wstring sName;
+  if (sName.empty()) {
+    sName = std::format(
+      L"Local\\{}.GameEvents.Binary.v2", OpenKneeboard::ProjectNameW);
   }
+  return sName.c_str();
 }
 
 const char* GameEvent::GetMailslotPath() {
@@ -183,5 +466,12 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
     {SetBrightnessEvent::Mode::Relative, "Relative"},
   });
 OPENKNEEBOARD_DEFINE_JSON(SetBrightnessEvent, mBrightness, mMode);
+OPENKNEEBOARD_DEFINE_JSON(SearchEvent, mQuery);
+OPENKNEEBOARD_DEFINE_JSON(
+  RegisterGameEventRingEvent,
+  mMappingName,
+  mByteCount,
+  mProcessID);
+OPENKNEEBOARD_DEFINE_JSON(ActivateGameEventRingEvent, mMappingName);
 
 }// namespace OpenKneeboard
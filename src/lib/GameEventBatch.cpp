@@ -0,0 +1,301 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/GameEvent.h>
+#include <OpenKneeboard/GameEventBatch.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <optional>
+
+namespace OpenKneeboard {
+
+namespace {
+
+template <class T>
+void UpdateMax(std::atomic<T>& max, T value) noexcept {
+  auto current = max.load(std::memory_order_relaxed);
+  while (current < value
+         && !max.compare_exchange_weak(
+           current, value, std::memory_order_relaxed)) {
+  }
+}
+
+}// namespace
+
+GameEventBatch::GameEventBatch() = default;
+
+void GameEventBatch::Clear() noexcept {
+  mArena.clear();
+  mEntries.clear();
+  mReceivedAt = {};
+}
+
+bool GameEventBatch::AppendPacket(
+  std::string_view buffer,
+  Clock::time_point receivedAt) {
+  const GameEventPacket packet(buffer);
+  if (!packet) {
+    return false;
+  }
+
+  for (const auto& event: packet) {
+    if (event.name == GameEvent::EVT_MULTI_EVENT) {
+      this->AppendMultiEvent(event.value, receivedAt);
+      continue;
+    }
+    this->Append(event.name, event.value, receivedAt);
+  }
+  return true;
+}
+
+void GameEventBatch::AppendMultiEvent(
+  std::string_view json,
+  Clock::time_point receivedAt) {
+  const auto events = nlohmann::json::parse(json, nullptr, false);
+  if (!events.is_array()) {
+    return;
+  }
+  for (const auto& event: events) {
+    if (
+      event.size() != 2 || !event.at(0).is_string()
+      || !event.at(1).is_string()) {
+      continue;
+    }
+    this->Append(
+      event.at(0).get_ref<const std::string&>(),
+      event.at(1).get_ref<const std::string&>(),
+      receivedAt);
+  }
+}
+
+void GameEventBatch::Append(
+  std::string_view name,
+  std::string_view value,
+  Clock::time_point receivedAt) {
+  if (mEntries.empty()) {
+    mReceivedAt = receivedAt;
+  }
+  const auto nameOffset = mArena.size();
+  mArena.append(name);
+  const auto valueOffset = mArena.size();
+  mArena.append(value);
+  mEntries.push_back({
+    .mNameOffset = nameOffset,
+    .mNameSize = name.size(),
+    .mValueOffset = valueOffset,
+    .mValueSize = value.size(),
+  });
+}
+
+size_t GameEventBatch::GetEventCount() const noexcept {
+  return mEntries.size();
+}
+
+bool GameEventBatch::IsEmpty() const noexcept {
+  return mEntries.empty();
+}
+
+GameEventBatch::Clock::time_point GameEventBatch::GetReceivedAt()
+  const noexcept {
+  return mReceivedAt;
+}
+
+GameEventView GameEventBatch::operator[](size_t index) const noexcept {
+  const auto& entry = mEntries[index];
+  const std::string_view arena {mArena};
+  return {
+    arena.substr(entry.mNameOffset, entry.mNameSize),
+    arena.substr(entry.mValueOffset, entry.mValueSize),
+  };
+}
+
+GameEventBatch::Iterator GameEventBatch::begin() const noexcept {
+  return {this, 0};
+}
+
+GameEventBatch::Iterator GameEventBatch::end() const noexcept {
+  return {this, mEntries.size()};
+}
+
+GameEventBatch::Iterator::Iterator(
+  const GameEventBatch* batch,
+  size_t index) noexcept
+  : mBatch(batch), mIndex(index) {
+}
+
+GameEventView GameEventBatch::Iterator::operator*() const noexcept {
+  return (*mBatch)[mIndex];
+}
+
+GameEventBatch::Iterator& GameEventBatch::Iterator::operator++() noexcept {
+  ++mIndex;
+  return *this;
+}
+
+GameEventBatch::Iterator GameEventBatch::Iterator::operator++(int) noexcept {
+  auto ret = *this;
+  ++mIndex;
+  return ret;
+}
+
+GameEventBatchPool::GameEventBatchPool(size_t maxPooled)
+  : mMaxPooled(maxPooled) {
+}
+
+std::unique_ptr<GameEventBatch> GameEventBatchPool::Acquire() {
+  {
+    std::unique_lock lock(mMutex);
+    if (!mPool.empty()) {
+      auto ret = std::move(mPool.back());
+      mPool.pop_back();
+      return ret;
+    }
+  }
+  return std::make_unique<GameEventBatch>();
+}
+
+void GameEventBatchPool::Release(std::unique_ptr<GameEventBatch> batch) {
+  if (!batch) {
+    return;
+  }
+  batch->Clear();
+  std::unique_lock lock(mMutex);
+  if (mPool.size() < mMaxPooled) {
+    mPool.push_back(std::move(batch));
+  }
+}
+
+void GameEventReceiveMetrics::RecordPacket(bool valid) noexcept {
+  mPackets.fetch_add(1, std::memory_order_relaxed);
+  if (!valid) {
+    mInvalidPackets.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void GameEventReceiveMetrics::RecordQueued(
+  const GameEventBatch& batch) noexcept {
+  const auto count = batch.GetEventCount();
+  mEvents.fetch_add(count, std::memory_order_relaxed);
+  mBatches.fetch_add(1, std::memory_order_relaxed);
+  UpdateMax(mLargestBatch, count);
+  const auto depth
+    = mQueueDepth.fetch_add(count, std::memory_order_relaxed) + count;
+  UpdateMax(mMaxQueueDepth, depth);
+}
+
+void GameEventReceiveMetrics::RecordDispatched(
+  const GameEventBatch& batch,
+  GameEventBatch::Clock::time_point dispatchedAt) noexcept {
+  mQueueDepth.fetch_sub(batch.GetEventCount(), std::memory_order_relaxed);
+
+  const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                         dispatchedAt - batch.GetReceivedAt())
+                         .count();
+  mLastDispatchLatency.store(latency, std::memory_order_relaxed);
+  mTotalDispatchLatency.fetch_add(latency, std::memory_order_relaxed);
+  UpdateMax(mMaxDispatchLatency, latency);
+}
+
+GameEventReceiveMetrics::Snapshot GameEventReceiveMetrics::GetSnapshot()
+  const noexcept {
+  using std::chrono::microseconds;
+  return {
+    .mPackets = mPackets.load(),
+    .mInvalidPackets = mInvalidPackets.load(),
+    .mEvents = mEvents.load(),
+    .mBatches = mBatches.load(),
+    .mQueueDepth = mQueueDepth.load(),
+    .mMaxQueueDepth = mMaxQueueDepth.load(),
+    .mLargestBatch = mLargestBatch.load(),
+    .mLastDispatchLatency = microseconds {mLastDispatchLatency.load()},
+    .mMaxDispatchLatency = microseconds {mMaxDispatchLatency.load()},
+    .mTotalDispatchLatency = microseconds {mTotalDispatchLatency.load()},
+  };
+}
+
+GameEventPacketSource::~GameEventPacketSource() = default;
+
+GameEventReceiver::GameEventReceiver(
+  GameEventBatchPool& pool,
+  GameEventReceiveMetrics& metrics,
+  Callbacks callbacks)
+  : mPool(pool), mMetrics(metrics), mCallbacks(std::move(callbacks)) {
+}
+
+void GameEventReceiver::Run(
+  GameEventPacketSource& source,
+  std::stop_token stopToken) {
+  while ((!stopToken.stop_requested()) && this->RunOnce(source, stopToken)) {
+    // repeat!
+  }
+}
+
+bool GameEventReceiver::RunOnce(
+  GameEventPacketSource& source,
+  std::stop_token stopToken) {
+  auto batch = mPool.Acquire();
+  std::optional<Clock::time_point> receivedAt;
+  const auto appendPacket = [&](std::string_view packet) {
+    if (!receivedAt) {
+      receivedAt = Clock::now();
+    }
+    this->AppendPacket(*batch, packet, *receivedAt);
+  };
+
+  if (!source.ReadNext(appendPacket, stopToken)) {
+    mPool.Release(std::move(batch));
+    return false;
+  }
+  // Anything else that's arrived while we were waking up goes in the same
+  // batch
+  source.ReadPending(appendPacket);
+
+  this->Submit(std::move(batch), receivedAt.value_or(Clock::now()));
+  return true;
+}
+
+bool GameEventReceiver::AppendPacket(
+  GameEventBatch& batch,
+  std::string_view packet,
+  Clock::time_point receivedAt) {
+  const auto valid = batch.AppendPacket(packet, receivedAt);
+  mMetrics.RecordPacket(valid);
+  if (!valid && mCallbacks.mInvalidPacket) {
+    mCallbacks.mInvalidPacket(packet);
+  }
+  return valid;
+}
+
+void GameEventReceiver::Submit(
+  std::unique_ptr<GameEventBatch> batch,
+  Clock::time_point receivedAt) {
+  if (batch->IsEmpty()) {
+    mPool.Release(std::move(batch));
+    return;
+  }
+  if (mCallbacks.mInspect) {
+    mCallbacks.mInspect(*batch, receivedAt);
+  }
+  mMetrics.RecordQueued(*batch);
+  mCallbacks.mDispatch(std::move(batch));
+}
+
+}// namespace OpenKneeboard
@@ -0,0 +1,260 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/GameEventDispatcher.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace OpenKneeboard {
+
+struct GameEventDispatcher::Entry final {
+  Entry(
+    std::string_view eventName,
+    uint64_t hash,
+    Handler handler,
+    const std::source_location& location);
+
+  const std::string mEventName;
+  const uint64_t mHash;
+  const Handler mHandler;
+  const std::string mSubscribedFrom;
+
+  std::atomic<bool> mActive {true};
+
+  std::atomic<uint64_t> mCallCount {0};
+  std::atomic<uint64_t> mTimedCallCount {0};
+  std::atomic<int64_t> mTotalTime {0};
+  std::atomic<int64_t> mMaxTime {0};
+
+  void Invoke(const GameEvent&, bool timed);
+};
+
+struct GameEventDispatcher::Impl final {
+  struct IdentityHash {
+    size_t operator()(uint64_t hash) const noexcept {
+      return static_cast<size_t>(hash);
+    }
+  };
+
+  struct Table final {
+    std::vector<std::shared_ptr<Entry>> mAnyEvent;
+    std::unordered_map<uint64_t, std::vector<std::shared_ptr<Entry>>, IdentityHash>
+      mByName;
+  };
+
+  mutable std::mutex mMutex;
+  // Copy-on-write; never modified after being published
+  std::shared_ptr<const Table> mTable {std::make_shared<Table>()};
+
+  std::atomic<bool> mTimeHandlers {false};
+
+  std::shared_ptr<const Table> GetTable() const;
+  void Add(const std::shared_ptr<Entry>&);
+  void Remove(const std::shared_ptr<Entry>&);
+};
+
+GameEventDispatcher::Entry::Entry(
+  std::string_view eventName,
+  uint64_t hash,
+  Handler handler,
+  const std::source_location& location)
+  : mEventName(eventName),
+    mHash(hash),
+    mHandler(std::move(handler)),
+    mSubscribedFrom(
+      std::string(location.file_name()) + ":"
+      + std::to_string(location.line()) + " (" + location.function_name()
+      + ")") {
+}
+
+void GameEventDispatcher::Entry::Invoke(const GameEvent& event, bool timed) {
+  mCallCount.fetch_add(1, std::memory_order_relaxed);
+  if (!timed) {
+    mHandler(event);
+    return;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  mHandler(event);
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+  mTimedCallCount.fetch_add(1, std::memory_order_relaxed);
+  mTotalTime.fetch_add(elapsed, std::memory_order_relaxed);
+  auto max = mMaxTime.load(std::memory_order_relaxed);
+  while (max < elapsed
+         && !mMaxTime.compare_exchange_weak(
+           max, elapsed, std::memory_order_relaxed)) {
+  }
+}
+
+std::shared_ptr<const GameEventDispatcher::Impl::Table>
+GameEventDispatcher::Impl::GetTable() const {
+  std::unique_lock lock(mMutex);
+  return mTable;
+}
+
+void GameEventDispatcher::Impl::Add(const std::shared_ptr<Entry>& entry) {
+  std::unique_lock lock(mMutex);
+  auto table = std::make_shared<Table>(*mTable);
+  if (entry->mEventName.empty()) {
+    table->mAnyEvent.push_back(entry);
+  } else {
+    table->mByName[entry->mHash].push_back(entry);
+  }
+  mTable = std::move(table);
+}
+
+void GameEventDispatcher::Impl::Remove(const std::shared_ptr<Entry>& entry) {
+  std::unique_lock lock(mMutex);
+  auto table = std::make_shared<Table>(*mTable);
+  if (entry->mEventName.empty()) {
+    std::erase(table->mAnyEvent, entry);
+  } else if (auto it = table->mByName.find(entry->mHash);
+             it != table->mByName.end()) {
+    std::erase(it->second, entry);
+    if (it->second.empty()) {
+      table->mByName.erase(it);
+    }
+  }
+  mTable = std::move(table);
+}
+
+GameEventDispatcher::Subscription::Subscription(
+  const std::shared_ptr<Impl>& impl,
+  const std::shared_ptr<Entry>& entry)
+  : mImpl(impl), mEntry(entry) {
+}
+
+GameEventDispatcher::Subscription::~Subscription() {
+  this->Unsubscribe();
+}
+
+GameEventDispatcher::Subscription::Subscription(Subscription&& other) noexcept
+  : mImpl(std::move(other.mImpl)), mEntry(std::move(other.mEntry)) {
+}
+
+GameEventDispatcher::Subscription&
+GameEventDispatcher::Subscription::operator=(Subscription&& other) noexcept {
+  if (this != &other) {
+    this->Unsubscribe();
+    mImpl = std::move(other.mImpl);
+    mEntry = std::move(other.mEntry);
+  }
+  return *this;
+}
+
+void GameEventDispatcher::Subscription::Unsubscribe() {
+  if (!mEntry) {
+    return;
+  }
+  mEntry->mActive.store(false);
+  if (auto impl = mImpl.lock()) {
+    impl->Remove(mEntry);
+  }
+  mImpl = {};
+  mEntry = {};
+}
+
+GameEventDispatcher::GameEventDispatcher() : p(std::make_shared<Impl>()) {
+}
+
+GameEventDispatcher::~GameEventDispatcher() = default;
+
+GameEventDispatcher::Subscription GameEventDispatcher::Subscribe(
+  const GameEventName& name,
+  Handler handler,
+  std::source_location location) {
+  auto entry = std::make_shared<Entry>(
+    name.mName, name.mHash, std::move(handler), location);
+  p->Add(entry);
+  return {p, entry};
+}
+
+GameEventDispatcher::Subscription GameEventDispatcher::SubscribeToAll(
+  Handler handler,
+  std::source_location location) {
+  auto entry
+    = std::make_shared<Entry>(std::string_view {}, 0, std::move(handler), location);
+  p->Add(entry);
+  return {p, entry};
+}
+
+size_t GameEventDispatcher::Dispatch(const GameEvent& event) const {
+  const auto table = p->GetTable();
+  const auto timed = p->mTimeHandlers.load(std::memory_order_relaxed);
+  size_t count = 0;
+
+  for (const auto& entry: table->mAnyEvent) {
+    if (entry->mActive.load()) {
+      entry->Invoke(event, timed);
+      ++count;
+    }
+  }
+
+  const auto it = table->mByName.find(GameEventNameHash(event.name));
+  if (it == table->mByName.end()) {
+    return count;
+  }
+  for (const auto& entry: it->second) {
+    // The name check protects against hash collisions
+    if (entry->mActive.load() && entry->mEventName == event.name) {
+      entry->Invoke(event, timed);
+      ++count;
+    }
+  }
+  return count;
+}
+
+std::vector<GameEventDispatcher::HandlerStats>
+GameEventDispatcher::GetHandlerStats() const {
+  const auto table = p->GetTable();
+  std::vector<HandlerStats> ret;
+  const auto append = [&ret](const std::shared_ptr<Entry>& entry) {
+    ret.push_back({
+      .mEventName = entry->mEventName,
+      .mSubscribedFrom = entry->mSubscribedFrom,
+      .mCallCount = entry->mCallCount.load(),
+      .mTimedCallCount = entry->mTimedCallCount.load(),
+      .mTotalTime = std::chrono::nanoseconds {entry->mTotalTime.load()},
+      .mMaxTime = std::chrono::nanoseconds {entry->mMaxTime.load()},
+    });
+  };
+
+  for (const auto& entry: table->mAnyEvent) {
+    append(entry);
+  }
+  for (const auto& [hash, entries]: table->mByName) {
+    for (const auto& entry: entries) {
+      append(entry);
+    }
+  }
+  std::ranges::sort(ret, std::ranges::greater {}, &HandlerStats::mTotalTime);
+  return ret;
+}
+
+void GameEventDispatcher::SetHandlerTimingEnabled(bool enabled) {
+  p->mTimeHandlers.store(enabled, std::memory_order_relaxed);
+}
+
+}// namespace OpenKneeboard
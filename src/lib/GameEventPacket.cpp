@@ -0,0 +1,310 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/GameEvent.h>
+#include <OpenKneeboard/GameEventPacket.h>
+
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+namespace OpenKneeboard {
+
+namespace {
+
+uint16_t ReadLE16(const char* p) noexcept {
+  const auto b = reinterpret_cast<const uint8_t*>(p);
+  return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+uint32_t ReadLE32(const char* p) noexcept {
+  const auto b = reinterpret_cast<const uint8_t*>(p);
+  return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8)
+    | (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+void WriteLE16(std::byte* p, uint16_t value) noexcept {
+  p[0] = static_cast<std::byte>(value & 0xff);
+  p[1] = static_cast<std::byte>((value >> 8) & 0xff);
+}
+
+void WriteLE32(std::byte* p, uint32_t value) noexcept {
+  p[0] = static_cast<std::byte>(value & 0xff);
+  p[1] = static_cast<std::byte>((value >> 8) & 0xff);
+  p[2] = static_cast<std::byte>((value >> 16) & 0xff);
+  p[3] = static_cast<std::byte>((value >> 24) & 0xff);
+}
+
+std::optional<uint32_t> ParseHex32(std::string_view sv) noexcept {
+  uint32_t value = 0;
+  const auto end = sv.data() + sv.size();
+  const auto [ptr, ec] = std::from_chars(sv.data(), end, value, 16);
+  if (ec != std::errc {} || ptr != end) {
+    return {};
+  }
+  return value;
+}
+
+// "{:08x}!{}!{:08x}!{}!", name size, name, value size, value
+std::optional<GameEventView> ParseLegacyText(std::string_view packet) noexcept {
+  constexpr size_t minimumSize = sizeof("12345678!!12345678!!") - 1;
+  if (packet.size() < minimumSize || !packet.ends_with('!')) {
+    return {};
+  }
+
+  const auto nameSize = ParseHex32(packet.substr(0, 8));
+  if (!nameSize || packet[8] != '!') {
+    return {};
+  }
+  const size_t nameOffset = 9;
+  const size_t valueSizeOffset = nameOffset + *nameSize + 1;
+  if (packet.size() < valueSizeOffset + 10) {
+    return {};
+  }
+  if (packet[valueSizeOffset - 1] != '!') {
+    return {};
+  }
+
+  const auto valueSize = ParseHex32(packet.substr(valueSizeOffset, 8));
+  if (!valueSize || packet[valueSizeOffset + 8] != '!') {
+    return {};
+  }
+  const size_t valueOffset = valueSizeOffset + 9;
+  if (packet.size() != valueOffset + *valueSize + 1) {
+    return {};
+  }
+
+  return GameEventView {
+    packet.substr(nameOffset, *nameSize),
+    packet.substr(valueOffset, *valueSize),
+  };
+}
+
+}// namespace
+
+std::string SerializeLegacyGameEvent(const GameEventView& event) {
+  return std::format(
+    "{:08x}!{}!{:08x}!{}!",
+    event.name.size(),
+    event.name,
+    event.value.size(),
+    event.value);
+}
+
+GameEventPacket::GameEventPacket(std::string_view buffer) noexcept {
+  if (buffer.starts_with(GameEventWire::Magic)) {
+    if (ParseBinary(buffer)) {
+      mFormat = Format::Binary;
+    }
+    return;
+  }
+
+  if (ParseLegacyText(buffer)) {
+    mFormat = Format::LegacyText;
+    mRecords = buffer;
+    mEventCount = 1;
+  }
+}
+
+bool GameEventPacket::ParseBinary(std::string_view buffer) noexcept {
+  if (buffer.size() < GameEventWire::HeaderSize) {
+    return false;
+  }
+  const auto version = ReadLE16(buffer.data() + 4);
+  if (version != GameEventWire::Version) {
+    return false;
+  }
+  const auto eventCount = ReadLE32(buffer.data() + 8);
+
+  // Validate everything up front, so iteration can't fail
+  auto records = buffer.substr(GameEventWire::HeaderSize);
+  auto remaining = records;
+  for (uint32_t i = 0; i < eventCount; ++i) {
+    if (remaining.size() < GameEventWire::RecordHeaderSize) {
+      return false;
+    }
+    const uint64_t nameSize = ReadLE32(remaining.data());
+    const uint64_t valueSize = ReadLE32(remaining.data() + 4);
+    const auto recordSize
+      = GameEventWire::RecordHeaderSize + nameSize + valueSize;
+    if (remaining.size() < recordSize) {
+      return false;
+    }
+    remaining.remove_prefix(static_cast<size_t>(recordSize));
+  }
+  if (!remaining.empty()) {
+    return false;
+  }
+
+  mRecords = records;
+  mEventCount = eventCount;
+  return true;
+}
+
+GameEventPacket::Format GameEventPacket::GetFormat() const noexcept {
+  return mFormat;
+}
+
+size_t GameEventPacket::GetEventCount() const noexcept {
+  return mEventCount;
+}
+
+GameEventPacket::operator bool() const noexcept {
+  return mFormat != Format::Invalid;
+}
+
+GameEventPacket::Iterator GameEventPacket::begin() const noexcept {
+  return {mFormat, mRecords, mEventCount};
+}
+
+GameEventPacket::Iterator GameEventPacket::end() const noexcept {
+  return {mFormat, {}, 0};
+}
+
+GameEventPacket::Iterator::Iterator(
+  Format format,
+  std::string_view records,
+  size_t remaining) noexcept
+  : mFormat(format), mRecords(records), mRemaining(remaining) {
+  this->ReadCurrent();
+}
+
+void GameEventPacket::Iterator::ReadCurrent() noexcept {
+  if (mRemaining == 0) {
+    mRecords = {};
+    mCurrent = {};
+    mCurrentSize = 0;
+    return;
+  }
+
+  // Already validated by the GameEventPacket constructor
+  if (mFormat == Format::LegacyText) {
+    mCurrent = *ParseLegacyText(mRecords);
+    mCurrentSize = mRecords.size();
+    return;
+  }
+
+  const auto nameSize = ReadLE32(mRecords.data());
+  const auto valueSize = ReadLE32(mRecords.data() + 4);
+  const auto nameOffset = GameEventWire::RecordHeaderSize;
+  mCurrent = {
+    mRecords.substr(nameOffset, nameSize),
+    mRecords.substr(nameOffset + nameSize, valueSize),
+  };
+  mCurrentSize = nameOffset + nameSize + valueSize;
+}
+
+GameEventPacket::Iterator::reference GameEventPacket::Iterator::operator*()
+  const noexcept {
+  return mCurrent;
+}
+
+GameEventPacket::Iterator::pointer GameEventPacket::Iterator::operator->()
+  const noexcept {
+  return &mCurrent;
+}
+
+GameEventPacket::Iterator& GameEventPacket::Iterator::operator++() noexcept {
+  mRecords.remove_prefix(mCurrentSize);
+  --mRemaining;
+  this->ReadCurrent();
+  return *this;
+}
+
+GameEventPacket::Iterator GameEventPacket::Iterator::operator++(int) noexcept {
+  auto ret = *this;
+  ++(*this);
+  return ret;
+}
+
+bool GameEventPacket::Iterator::operator==(
+  const Iterator& other) const noexcept {
+  return mRemaining == other.mRemaining;
+}
+
+GameEventPacketBuilder::GameEventPacketBuilder() {
+  this->Clear();
+}
+
+void GameEventPacketBuilder::Clear() noexcept {
+  // Never shrinks, so this can't throw
+  mBuffer.resize(GameEventWire::HeaderSize);
+  std::memcpy(
+    mBuffer.data(), GameEventWire::Magic.data(), GameEventWire::Magic.size());
+  WriteLE16(mBuffer.data() + 4, GameEventWire::Version);
+  WriteLE16(mBuffer.data() + 6, 0);
+  mEventCount = 0;
+  WriteLE32(mBuffer.data() + 8, mEventCount);
+}
+
+void GameEventPacketBuilder::Append(
+  std::string_view name,
+  std::string_view value) {
+  if (
+    name.size() > std::numeric_limits<uint32_t>::max()
+    || value.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("GameEvent name or value is too large");
+  }
+
+  const auto offset = mBuffer.size();
+  mBuffer.resize(offset + GetRecordByteCount(name, value));
+  auto it = mBuffer.data() + offset;
+  WriteLE32(it, static_cast<uint32_t>(name.size()));
+  WriteLE32(it + 4, static_cast<uint32_t>(value.size()));
+  it += GameEventWire::RecordHeaderSize;
+  std::memcpy(it, name.data(), name.size());
+  std::memcpy(it + name.size(), value.data(), value.size());
+
+  WriteLE32(mBuffer.data() + 8, ++mEventCount);
+}
+
+size_t GameEventPacketBuilder::GetEventCount() const noexcept {
+  return mEventCount;
+}
+
+size_t GameEventPacketBuilder::GetByteCount() const noexcept {
+  return mBuffer.size();
+}
+
+std::span<const std::byte> GameEventPacketBuilder::GetBytes() const noexcept {
+  return mBuffer;
+}
+
+GameEvent::operator bool() const {
+  return !(name.empty() || value.empty());
+}
+
+GameEvent GameEvent::Unserialize(std::string_view buffer) {
+  const GameEventPacket packet(buffer);
+  if (packet.GetEventCount() != 1) {
+    return {};
+  }
+  return FromView(*packet.begin());
+}
+
+std::vector<std::byte> GameEvent::Serialize() const {
+  const auto str = SerializeLegacyGameEvent({name, value});
+  const auto first = reinterpret_cast<const std::byte*>(str.data());
+  return {first, first + str.size()};
+}
+
+}// namespace OpenKneeboard
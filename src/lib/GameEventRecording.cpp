@@ -0,0 +1,270 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/GameEventRecording.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+
+namespace OpenKneeboard {
+
+namespace {
+
+void AppendVarint(std::string& buffer, uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+std::optional<uint64_t> ReadVarint(std::string_view buffer, size_t& offset) {
+  uint64_t value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    if (offset >= buffer.size()) {
+      return {};
+    }
+    const auto byte = static_cast<uint8_t>(buffer[offset++]);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  return {};
+}
+
+}// namespace
+
+GameEventRecordingWriter::GameEventRecordingWriter(
+  const std::filesystem::path& path)
+  : mStream(path, std::ios::binary | std::ios::trunc) {
+  if (!mStream) {
+    throw std::runtime_error("Failed to open GameEvent recording for writing");
+  }
+
+  mBuffer.append(GameEventRecordingFormat::Magic);
+  mBuffer.push_back(static_cast<char>(GameEventRecordingFormat::Version & 0xff));
+  mBuffer.push_back(static_cast<char>(GameEventRecordingFormat::Version >> 8));
+  this->Flush();
+}
+
+GameEventRecordingWriter::~GameEventRecordingWriter() {
+  this->Flush();
+}
+
+void GameEventRecordingWriter::Write(
+  Clock::time_point receivedAt,
+  std::string_view name,
+  std::string_view value) {
+  const auto previous = mPreviousTime.value_or(receivedAt);
+  // Events may be written slightly out of order if they arrive on different
+  // transports; never go backwards.
+  const auto delta = std::max(
+    std::chrono::microseconds::zero(),
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      receivedAt - previous));
+  mPreviousTime = std::max(previous, receivedAt);
+
+  AppendVarint(mBuffer, static_cast<uint64_t>(delta.count()));
+
+  const std::string key {name};
+  if (auto it = mNameIndices.find(key); it != mNameIndices.end()) {
+    AppendVarint(mBuffer, it->second);
+  } else {
+    AppendVarint(mBuffer, 0);
+    AppendVarint(mBuffer, name.size());
+    mBuffer.append(name);
+    mNameIndices.emplace(key, mNameIndices.size() + 1);
+  }
+
+  AppendVarint(mBuffer, value.size());
+  mBuffer.append(value);
+
+  if (mBuffer.size() >= 64 * 1024) {
+    this->Flush();
+  }
+}
+
+void GameEventRecordingWriter::Flush() {
+  if (mBuffer.empty()) {
+    return;
+  }
+  mStream.write(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+  mStream.flush();
+  mBuffer.clear();
+}
+
+GameEventRecordingReader::GameEventRecordingReader(
+  const std::filesystem::path& path) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    throw std::runtime_error("Failed to open GameEvent recording for reading");
+  }
+  mContents = {
+    std::istreambuf_iterator<char>(f),
+    std::istreambuf_iterator<char>(),
+  };
+  this->ReadHeader();
+}
+
+GameEventRecordingReader::GameEventRecordingReader(std::string contents)
+  : mContents(std::move(contents)) {
+  this->ReadHeader();
+}
+
+void GameEventRecordingReader::ReadHeader() {
+  using namespace GameEventRecordingFormat;
+  const std::string_view contents {mContents};
+  if (contents.size() < HeaderSize || !contents.starts_with(Magic)) {
+    return;
+  }
+  const auto version = static_cast<uint16_t>(
+    static_cast<uint8_t>(contents[Magic.size()])
+    | (static_cast<uint8_t>(contents[Magic.size() + 1]) << 8));
+  if (version != Version) {
+    return;
+  }
+  mValid = true;
+  mOffset = HeaderSize;
+}
+
+bool GameEventRecordingReader::IsValid() const noexcept {
+  return mValid;
+}
+
+bool GameEventRecordingReader::IsCorrupt() const noexcept {
+  return mCorrupt;
+}
+
+std::optional<GameEventRecord> GameEventRecordingReader::Next() {
+  const std::string_view contents {mContents};
+  if (!mValid || mCorrupt || mOffset >= contents.size()) {
+    return {};
+  }
+
+  auto offset = mOffset;
+  const auto readBytes = [&]() -> std::optional<std::string_view> {
+    const auto size = ReadVarint(contents, offset);
+    if (!size || *size > contents.size() - offset) {
+      return {};
+    }
+    const auto ret = contents.substr(offset, static_cast<size_t>(*size));
+    offset += ret.size();
+    return ret;
+  };
+
+  const auto delta = ReadVarint(contents, offset);
+  const auto nameIndex = ReadVarint(contents, offset);
+  if (!(delta && nameIndex)) {
+    mCorrupt = true;
+    return {};
+  }
+
+  std::string name;
+  if (*nameIndex == 0) {
+    const auto newName = readBytes();
+    if (!newName) {
+      mCorrupt = true;
+      return {};
+    }
+    name = *newName;
+    mNames.push_back(name);
+  } else if (*nameIndex <= mNames.size()) {
+    name = mNames.at(static_cast<size_t>(*nameIndex - 1));
+  } else {
+    mCorrupt = true;
+    return {};
+  }
+
+  const auto value = readBytes();
+  if (!value) {
+    mCorrupt = true;
+    return {};
+  }
+
+  mOffset = offset;
+  mTimestamp += std::chrono::microseconds {static_cast<int64_t>(*delta)};
+  return GameEventRecord {
+    .mTimestamp = mTimestamp,
+    .mEvent = {std::move(name), std::string {*value}},
+  };
+}
+
+GameEventReplayStats ReplayGameEvents(
+  GameEventRecordingReader& reader,
+  const GameEventReplayOptions& options,
+  const std::function<void(const GameEvent&)>& sink) {
+  using Clock = std::chrono::steady_clock;
+
+  auto sleepUntil = options.mSleepUntil;
+  if (!sleepUntil) {
+    sleepUntil = [stopToken = options.mStopToken](Clock::time_point t) {
+      std::mutex mutex;
+      std::condition_variable_any cv;
+      std::unique_lock lock(mutex);
+      cv.wait_until(lock, stopToken, t, []() { return false; });
+    };
+  }
+  const auto beforeWait = [&options]() {
+    if (options.mBeforeWait) {
+      options.mBeforeWait();
+    }
+  };
+
+  GameEventReplayStats stats;
+  const auto start = Clock::now();
+
+  while (auto record = reader.Next()) {
+    if (options.mStopToken.stop_requested()) {
+      stats.mStopped = true;
+      break;
+    }
+    if (options.mSpeed > 0) {
+      const auto due = start
+        + std::chrono::duration_cast<Clock::duration>(
+          record->mTimestamp / options.mSpeed);
+      const auto now = Clock::now();
+      if (due > now) {
+        beforeWait();
+        sleepUntil(due);
+        if (options.mStopToken.stop_requested()) {
+          stats.mStopped = true;
+          break;
+        }
+      } else {
+        stats.mMaxLag = std::max<std::chrono::nanoseconds>(
+          stats.mMaxLag, now - due);
+      }
+    }
+
+    sink(record->mEvent);
+    ++stats.mEventCount;
+    stats.mRecordedDuration = record->mTimestamp;
+  }
+  beforeWait();
+
+  stats.mWallTime = Clock::now() - start;
+  stats.mCorrupt = reader.IsCorrupt();
+  return stats;
+}
+
+}// namespace OpenKneeboard
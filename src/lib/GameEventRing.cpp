@@ -0,0 +1,242 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/GameEventRing.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+
+namespace OpenKneeboard {
+
+struct GameEventRing::Header {
+  uint32_t mMagic;
+  uint32_t mVersion;
+  uint64_t mCapacity;
+
+  std::atomic<uint32_t> mConsumerAttached {0};
+  // Set by the producer; see `Abandon()`
+  std::atomic<uint32_t> mProducerAbandoned {0};
+  // Incremented by the consumer; see `IsConsumerAlive()`
+  std::atomic<uint64_t> mConsumerHeartbeat {0};
+
+  // Separate cache lines, as they are written by different processes
+  alignas(64) std::atomic<uint64_t> mWritePosition {0};
+  alignas(64) std::atomic<uint64_t> mReadPosition {0};
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+namespace {
+constexpr size_t DataOffset = (sizeof(GameEventRing::Header) + 63) & ~63;
+constexpr size_t RecordHeaderSize = sizeof(uint32_t);
+}// namespace
+
+size_t GameEventRing::GetByteCount(size_t capacity) noexcept {
+  return DataOffset + std::bit_ceil(capacity);
+}
+
+GameEventRing::GameEventRing(
+  Header* header,
+  std::byte* data,
+  size_t capacity) noexcept
+  : mHeader(header), mData(data), mCapacity(capacity) {
+}
+
+std::optional<GameEventRing> GameEventRing::Create(
+  void* memory,
+  size_t byteCount) noexcept {
+  if (byteCount <= DataOffset + RecordHeaderSize) {
+    return {};
+  }
+  const auto capacity = std::bit_floor(byteCount - DataOffset);
+
+  auto header = new (memory) Header {
+    .mMagic = Magic,
+    .mVersion = Version,
+    .mCapacity = capacity,
+  };
+  header->mConsumerAttached.store(0);
+  header->mProducerAbandoned.store(0);
+  header->mConsumerHeartbeat.store(0);
+  header->mWritePosition.store(0);
+  header->mReadPosition.store(0);
+
+  return GameEventRing {
+    header,
+    static_cast<std::byte*>(memory) + DataOffset,
+    capacity,
+  };
+}
+
+std::optional<GameEventRing> GameEventRing::Open(
+  void* memory,
+  size_t byteCount) noexcept {
+  if (byteCount <= DataOffset) {
+    return {};
+  }
+  auto header = std::launder(static_cast<Header*>(memory));
+  if (header->mMagic != Magic || header->mVersion != Version) {
+    return {};
+  }
+  const auto capacity = header->mCapacity;
+  if (
+    capacity == 0 || !std::has_single_bit(capacity)
+    || capacity > byteCount - DataOffset) {
+    return {};
+  }
+  return GameEventRing {
+    header,
+    static_cast<std::byte*>(memory) + DataOffset,
+    static_cast<size_t>(capacity),
+  };
+}
+
+void GameEventRing::CopyIn(
+  uint64_t position,
+  const std::byte* source,
+  size_t size) noexcept {
+  const auto offset = static_cast<size_t>(position & (mCapacity - 1));
+  const auto first = std::min(size, mCapacity - offset);
+  std::memcpy(mData + offset, source, first);
+  std::memcpy(mData, source + first, size - first);
+}
+
+void GameEventRing::CopyOut(uint64_t position, std::byte* dest, size_t size)
+  const noexcept {
+  const auto offset = static_cast<size_t>(position & (mCapacity - 1));
+  const auto first = std::min(size, mCapacity - offset);
+  std::memcpy(dest, mData + offset, first);
+  std::memcpy(dest + first, mData, size - first);
+}
+
+bool GameEventRing::TryWrite(std::span<const std::byte> packet) noexcept {
+  const auto recordSize = RecordHeaderSize + packet.size();
+  if (packet.size() > UINT32_MAX || recordSize > mCapacity) {
+    return false;
+  }
+
+  const auto write = mHeader->mWritePosition.load(std::memory_order_relaxed);
+  const auto read = mHeader->mReadPosition.load(std::memory_order_acquire);
+  if (mCapacity - (write - read) < recordSize) {
+    return false;
+  }
+
+  const auto size = static_cast<uint32_t>(packet.size());
+  const std::byte sizeBytes[RecordHeaderSize] {
+    static_cast<std::byte>(size & 0xff),
+    static_cast<std::byte>((size >> 8) & 0xff),
+    static_cast<std::byte>((size >> 16) & 0xff),
+    static_cast<std::byte>((size >> 24) & 0xff),
+  };
+  CopyIn(write, sizeBytes, RecordHeaderSize);
+  CopyIn(write + RecordHeaderSize, packet.data(), packet.size());
+
+  mHeader->mWritePosition.store(write + recordSize, std::memory_order_release);
+  return true;
+}
+
+void GameEventRing::Abandon() noexcept {
+  mHeader->mProducerAbandoned.store(1);
+}
+
+bool GameEventRing::TryRead(std::vector<char>& buffer) {
+  if (this->IsAbandoned()) {
+    return false;
+  }
+  const auto read = mHeader->mReadPosition.load(std::memory_order_relaxed);
+  const auto write = mHeader->mWritePosition.load(std::memory_order_acquire);
+  const auto pending = write - read;
+  if (pending == 0) {
+    return false;
+  }
+
+  // The other side is in another process, so don't trust it
+  const auto discard = [&]() {
+    mHeader->mReadPosition.store(write, std::memory_order_release);
+    return false;
+  };
+  if (pending < RecordHeaderSize || pending > mCapacity) {
+    return discard();
+  }
+
+  std::byte sizeBytes[RecordHeaderSize];
+  CopyOut(read, sizeBytes, RecordHeaderSize);
+  const auto size = static_cast<uint32_t>(sizeBytes[0])
+    | (static_cast<uint32_t>(sizeBytes[1]) << 8)
+    | (static_cast<uint32_t>(sizeBytes[2]) << 16)
+    | (static_cast<uint32_t>(sizeBytes[3]) << 24);
+  if (size > pending - RecordHeaderSize) {
+    return discard();
+  }
+
+  buffer.resize(size);
+  CopyOut(
+    read + RecordHeaderSize, reinterpret_cast<std::byte*>(buffer.data()), size);
+  mHeader->mReadPosition.store(
+    read + RecordHeaderSize + size, std::memory_order_release);
+  return true;
+}
+
+void GameEventRing::SetConsumerAttached(bool attached) noexcept {
+  mHeader->mConsumerAttached.store(attached ? 1 : 0);
+}
+
+void GameEventRing::Heartbeat() noexcept {
+  mHeader->mConsumerHeartbeat.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool GameEventRing::IsConsumerAlive(
+  std::chrono::steady_clock::time_point now,
+  std::chrono::steady_clock::duration timeout) noexcept {
+  if (!this->IsConsumerAttached()) {
+    mLastHeartbeatChange = {};
+    return false;
+  }
+
+  const auto heartbeat
+    = mHeader->mConsumerHeartbeat.load(std::memory_order_relaxed);
+  if (heartbeat != mLastHeartbeat || !mLastHeartbeatChange) {
+    // Newly attached, or still running
+    mLastHeartbeat = heartbeat;
+    mLastHeartbeatChange = now;
+    return true;
+  }
+  return now - *mLastHeartbeatChange < timeout;
+}
+
+bool GameEventRing::IsConsumerAttached() const noexcept {
+  return mHeader->mConsumerAttached.load() != 0;
+}
+
+bool GameEventRing::IsAbandoned() const noexcept {
+  return mHeader->mProducerAbandoned.load() != 0;
+}
+
+size_t GameEventRing::GetCapacity() const noexcept {
+  return mCapacity;
+}
+
+size_t GameEventRing::GetPendingByteCount() const noexcept {
+  return static_cast<size_t>(
+    mHeader->mWritePosition.load() - mHeader->mReadPosition.load());
+}
+
+}// namespace OpenKneeboard
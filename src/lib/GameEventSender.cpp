@@ -0,0 +1,562 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/GameEventPacket.h>
+#include <OpenKneeboard/GameEventSender.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace OpenKneeboard {
+
+GameEventTransport::~GameEventTransport() = default;
+
+namespace {
+
+// Bounded MPMC queue; see Dmitry Vyukov's 'Bounded MPMC queue'
+template <class T>
+class BoundedQueue {
+ public:
+  // Rounded up to a power of two
+  explicit BoundedQueue(size_t capacity);
+
+  // Moves from the value only on success
+  bool TryPush(T&);
+  bool TryPop(T&);
+  bool IsEmpty() const noexcept;
+
+ private:
+  struct Slot {
+    std::atomic<size_t> mSequence;
+    T mValue;
+  };
+  std::unique_ptr<Slot[]> mSlots;
+  const size_t mMask;
+  alignas(64) std::atomic<size_t> mEnqueuePosition {0};
+  alignas(64) std::atomic<size_t> mDequeuePosition {0};
+};
+
+template <class T>
+BoundedQueue<T>::BoundedQueue(size_t capacity)
+  : mSlots(new Slot[std::bit_ceil(std::max<size_t>(capacity, 2))]),
+    mMask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1) {
+  for (size_t i = 0; i <= mMask; ++i) {
+    mSlots[i].mSequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template <class T>
+bool BoundedQueue<T>::TryPush(T& value) {
+  auto position = mEnqueuePosition.load(std::memory_order_relaxed);
+  while (true) {
+    auto& slot = mSlots[position & mMask];
+    const auto sequence = slot.mSequence.load(std::memory_order_acquire);
+    const auto diff
+      = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+    if (diff == 0) {
+      if (mEnqueuePosition.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed)) {
+        slot.mValue = std::move(value);
+        slot.mSequence.store(position + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // Full
+      return false;
+    } else {
+      position = mEnqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <class T>
+bool BoundedQueue<T>::TryPop(T& value) {
+  auto position = mDequeuePosition.load(std::memory_order_relaxed);
+  while (true) {
+    auto& slot = mSlots[position & mMask];
+    const auto sequence = slot.mSequence.load(std::memory_order_acquire);
+    const auto diff
+      = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+    if (diff == 0) {
+      if (mDequeuePosition.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed)) {
+        value = std::move(slot.mValue);
+        slot.mValue = {};
+        slot.mSequence.store(position + mMask + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // Empty, or a producer has claimed the slot but not filled it yet
+      return false;
+    } else {
+      position = mDequeuePosition.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <class T>
+bool BoundedQueue<T>::IsEmpty() const noexcept {
+  return mDequeuePosition.load() == mEnqueuePosition.load();
+}
+
+// Used by OverflowPolicy::CoalesceByName; both are fixed so that a stalled
+// transport can't make the overflow grow without limit
+constexpr size_t CoalescingSlots = 256;
+constexpr size_t MaxUncoalescedOverflow = 256;
+
+}// namespace
+
+struct GameEventSender::Impl {
+  Impl(std::unique_ptr<GameEventTransport>, const Options&);
+  ~Impl();
+
+  const Options mOptions;
+  const std::unique_ptr<GameEventTransport> mTransport;
+
+  void Push(GameEvent&&);
+  bool Flush(std::chrono::milliseconds timeout);
+  void Stop(std::chrono::milliseconds timeout);
+  void Run();
+
+  Stats GetStats() const;
+
+  // Set while the flush thread is waiting for events; if the thread is
+  // terminated while this is set, it wasn't holding any locks or events
+  std::atomic<bool> mFlusherIdle {false};
+  // Once set, `Push()` drops events
+  std::atomic<bool> mShutDown {false};
+  // Producers that are part-way through `Push()`
+  std::atomic<uint32_t> mPushing {0};
+  // Only when the flush thread isn't running
+  void DrainOnCallingThread();
+  void ReportAbandoned();
+
+ private:
+  BoundedQueue<GameEvent> mQueue;
+
+  // Only used by OverflowPolicy::CoalesceByName
+  struct Overflowed {
+    uint64_t mSequence {};
+    GameEvent mEvent;
+  };
+  // The latest overflowed event for each name, indexed by a hash of the name;
+  // replaced with `exchange()` so that producers never wait for each other or
+  // search
+  std::unique_ptr<std::atomic<Overflowed*>[]> mCoalescing;
+  // Multi-events, and events displaced by a different name with the same hash
+  BoundedQueue<std::unique_ptr<Overflowed>> mUncoalesced;
+  // Overflowed events that haven't been taken by the flush thread; producers
+  // keep using the overflow while this is non-zero, so events aren't
+  // reordered
+  std::atomic<uint64_t> mOverflowCount {0};
+  std::atomic<uint64_t> mOverflowSequence {0};
+  void PushOverflow(GameEvent&&);
+  void PushUncoalesced(std::unique_ptr<Overflowed>);
+
+  std::atomic<bool> mFlusherSleeping {false};
+  std::atomic<uint32_t> mWakeCount {0};
+  std::atomic<bool> mStopping {false};
+  bool mStopped {false};
+  void Wake();
+
+  // Every enqueued event is eventually completed exactly once: written, sent
+  // in a failed write, dropped, or replaced by a coalesced event.
+  std::atomic<uint64_t> mCompletedCount {0};
+  std::mutex mCompletionMutex;
+  std::condition_variable mCompletionCV;
+  // Threads in `Flush()`; `MarkCompleted()` only takes the lock if non-zero
+  std::atomic<uint32_t> mFlushWaiters {0};
+  void MarkCompleted(uint64_t count);
+
+  std::atomic<uint64_t> mEnqueuedCount {0};
+  std::atomic<uint64_t> mDroppedCount {0};
+  std::atomic<uint64_t> mCoalescedCount {0};
+  std::atomic<uint64_t> mPacketCount {0};
+  std::atomic<uint64_t> mWriteFailureCount {0};
+
+  // Flush thread only
+  GameEventPacketBuilder mBuilder;
+  std::vector<std::unique_ptr<Overflowed>> mDrained;
+  void Append(GameEvent&&);
+  void WriteBuilder();
+  void DrainQueue();
+  void DrainOverflow();
+};
+
+GameEventSender::Impl::Impl(
+  std::unique_ptr<GameEventTransport> transport,
+  const Options& options)
+  : mOptions(options),
+    mTransport(std::move(transport)),
+    mQueue(options.mQueueCapacity),
+    mCoalescing(new std::atomic<Overflowed*>[CoalescingSlots] {}),
+    mUncoalesced(MaxUncoalescedOverflow) {
+}
+
+GameEventSender::Impl::~Impl() {
+  for (size_t i = 0; i < CoalescingSlots; ++i) {
+    delete mCoalescing[i].load();
+  }
+}
+
+void GameEventSender::Impl::Push(GameEvent&& event) {
+  mEnqueuedCount.fetch_add(1);
+
+  mPushing.fetch_add(1);
+  if (mShutDown.load()) {
+    mPushing.fetch_sub(1);
+    mDroppedCount.fetch_add(1);
+    MarkCompleted(1);
+    return;
+  }
+
+  switch (mOptions.mOverflowPolicy) {
+    case OverflowPolicy::DropOldest:
+      while (!mQueue.TryPush(event)) {
+        GameEvent dropped;
+        if (mQueue.TryPop(dropped)) {
+          mDroppedCount.fetch_add(1);
+          MarkCompleted(1);
+        }
+      }
+      break;
+    case OverflowPolicy::CoalesceByName:
+      // Once anything has overflowed, keep using the overflow until the
+      // flusher has caught up, so that events aren't reordered.
+      if (mOverflowCount.load() > 0 || !mQueue.TryPush(event)) {
+        PushOverflow(std::move(event));
+      }
+      break;
+    case OverflowPolicy::Block:
+      for (size_t attempt = 0; !mQueue.TryPush(event); ++attempt) {
+        Wake();
+        if (attempt < 64) {
+          std::this_thread::yield();
+        } else {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      }
+      break;
+  }
+
+  Wake();
+  mPushing.fetch_sub(1);
+}
+
+void GameEventSender::Impl::PushOverflow(GameEvent&& event) {
+  mOverflowCount.fetch_add(1);
+  auto overflowed = std::make_unique<Overflowed>(
+    mOverflowSequence.fetch_add(1), std::move(event));
+
+  if (overflowed->mEvent.name == GameEvent::EVT_MULTI_EVENT) {
+    PushUncoalesced(std::move(overflowed));
+    return;
+  }
+
+  // The flush thread may take and free it as soon as it's in the slot
+  const auto name = overflowed->mEvent.name;
+  auto& slot = mCoalescing
+    [std::hash<std::string> {}(name) & (CoalescingSlots - 1)];
+  std::unique_ptr<Overflowed> previous {slot.exchange(overflowed.release())};
+  if (!previous) {
+    return;
+  }
+  if (previous->mEvent.name != name) {
+    PushUncoalesced(std::move(previous));
+    return;
+  }
+
+  mOverflowCount.fetch_sub(1);
+  mCoalescedCount.fetch_add(1);
+  MarkCompleted(1);
+}
+
+void GameEventSender::Impl::PushUncoalesced(
+  std::unique_ptr<Overflowed> overflowed) {
+  while (!mUncoalesced.TryPush(overflowed)) {
+    std::unique_ptr<Overflowed> dropped;
+    if (mUncoalesced.TryPop(dropped)) {
+      mOverflowCount.fetch_sub(1);
+      mDroppedCount.fetch_add(1);
+      MarkCompleted(1);
+    }
+  }
+}
+
+void GameEventSender::Impl::Wake() {
+  if (mFlusherSleeping.exchange(false)) {
+    mWakeCount.fetch_add(1);
+    mWakeCount.notify_one();
+  }
+}
+
+void GameEventSender::Impl::MarkCompleted(uint64_t count) {
+  if (count == 0) {
+    return;
+  }
+  mCompletedCount.fetch_add(count);
+  // Producers call this too, so only lock if there's someone to wake; either
+  // we see the waiter, or it sees the new count
+  if (mFlushWaiters.load() == 0) {
+    return;
+  }
+  { std::unique_lock lock(mCompletionMutex); }
+  mCompletionCV.notify_all();
+}
+
+void GameEventSender::Impl::Append(GameEvent&& event) {
+  const auto recordSize
+    = GameEventPacketBuilder::GetRecordByteCount(event.name, event.value);
+  if (
+    mBuilder.GetEventCount() > 0
+    && mBuilder.GetByteCount() + recordSize > mOptions.mMaxPacketBytes) {
+    WriteBuilder();
+  }
+  mBuilder.Append(event.name, event.value);
+}
+
+void GameEventSender::Impl::WriteBuilder() {
+  const auto count = mBuilder.GetEventCount();
+  if (count == 0) {
+    return;
+  }
+  if (mTransport->Write(mBuilder.GetBytes())) {
+    mPacketCount.fetch_add(1);
+  } else {
+    mWriteFailureCount.fetch_add(1);
+  }
+  mBuilder.Clear();
+  MarkCompleted(count);
+}
+
+void GameEventSender::Impl::DrainQueue() {
+  GameEvent event;
+  while (mQueue.TryPop(event)) {
+    Append(std::move(event));
+  }
+  if (mOverflowCount.load() > 0) {
+    DrainOverflow();
+  }
+  WriteBuilder();
+}
+
+void GameEventSender::Impl::DrainOverflow() {
+  for (size_t i = 0; i < CoalescingSlots; ++i) {
+    if (auto overflowed = mCoalescing[i].exchange(nullptr)) {
+      mDrained.emplace_back(overflowed);
+    }
+  }
+  std::unique_ptr<Overflowed> overflowed;
+  while (mUncoalesced.TryPop(overflowed)) {
+    mDrained.push_back(std::move(overflowed));
+  }
+  if (mDrained.empty()) {
+    // A producer has counted an event, but not stored it yet
+    return;
+  }
+
+  // Each name goes where its latest value was enqueued
+  std::ranges::sort(mDrained, {}, &Overflowed::mSequence);
+  // A hash collision can leave an older event for a name in `mUncoalesced`
+  uint64_t coalesced = 0;
+  std::unordered_set<std::string_view> names;
+  for (auto it = mDrained.rbegin(); it != mDrained.rend(); ++it) {
+    const auto& name = (*it)->mEvent.name;
+    if (name == GameEvent::EVT_MULTI_EVENT || names.emplace(name).second) {
+      continue;
+    }
+    it->reset();
+    ++coalesced;
+  }
+  mCoalescedCount.fetch_add(coalesced);
+  MarkCompleted(coalesced);
+
+  mOverflowCount.fetch_sub(mDrained.size());
+  for (auto& it: mDrained) {
+    if (it) {
+      Append(std::move(it->mEvent));
+    }
+  }
+  mDrained.clear();
+}
+
+void GameEventSender::Impl::DrainOnCallingThread() {
+  DrainQueue();
+}
+
+void GameEventSender::Impl::ReportAbandoned() {
+  const auto pending = mEnqueuedCount.load() - mCompletedCount.load();
+  if (pending > 0 && mOptions.mEventsAbandoned) {
+    mOptions.mEventsAbandoned(pending);
+  }
+}
+
+void GameEventSender::Impl::Run() {
+  while (true) {
+    DrainQueue();
+
+    const auto wakeCount = mWakeCount.load();
+    mFlusherSleeping.store(true);
+    if (!(mQueue.IsEmpty() && mOverflowCount.load() == 0)) {
+      // Either new events, or a producer is part-way through a push
+      mFlusherSleeping.store(false);
+      std::this_thread::yield();
+      continue;
+    }
+    if (mStopping.load()) {
+      break;
+    }
+    mFlusherIdle.store(true);
+    mWakeCount.wait(wakeCount);
+    mFlusherIdle.store(false);
+    mFlusherSleeping.store(false);
+  }
+
+  {
+    std::unique_lock lock(mCompletionMutex);
+    mStopped = true;
+  }
+  mCompletionCV.notify_all();
+}
+
+bool GameEventSender::Impl::Flush(std::chrono::milliseconds timeout) {
+  const auto target = mEnqueuedCount.load();
+  std::unique_lock lock(mCompletionMutex);
+  mFlushWaiters.fetch_add(1);
+  const auto flushed
+    = mCompletionCV.wait_for(lock, timeout, [this, target]() {
+        return mStopped || mCompletedCount.load() >= target;
+      });
+  mFlushWaiters.fetch_sub(1);
+  return flushed;
+}
+
+void GameEventSender::Impl::Stop(std::chrono::milliseconds timeout) {
+  mStopping.store(true);
+  mFlusherSleeping.store(false);
+  mWakeCount.fetch_add(1);
+  mWakeCount.notify_one();
+
+  std::unique_lock lock(mCompletionMutex);
+  mCompletionCV.wait_for(lock, timeout, [this]() { return mStopped; });
+}
+
+GameEventSender::Stats GameEventSender::Impl::GetStats() const {
+  return {
+    .mEnqueued = mEnqueuedCount.load(),
+    .mDropped = mDroppedCount.load(),
+    .mCoalesced = mCoalescedCount.load(),
+    .mPackets = mPacketCount.load(),
+    .mWriteFailures = mWriteFailureCount.load(),
+  };
+}
+
+GameEventSender::GameEventSender(
+  std::unique_ptr<GameEventTransport> transport,
+  const Options& options)
+  : p(std::make_shared<Impl>(std::move(transport), options)),
+    mFlusher([p = p]() { p->Run(); }) {
+}
+
+bool GameEventSender::IsFlusherRunning() const {
+#ifdef _WIN32
+  // Threads are terminated before static destructors run at process exit
+  return WaitForSingleObject(
+           const_cast<std::thread&>(mFlusher).native_handle(), 0)
+    == WAIT_TIMEOUT;
+#else
+  return true;
+#endif
+}
+
+GameEventSender::~GameEventSender() {
+  if (!mFlusher.joinable()) {
+    // `Shutdown()` was called, so everything was written or dropped
+    return;
+  }
+
+  if (!this->IsFlusherRunning()) {
+    // The process is exiting; write what's left from this thread instead.
+    // This isn't safe if the thread was part-way through a write, as it may
+    // have been holding a lock or a partly-built packet.
+    mFlusher.detach();
+    if (p->mFlusherIdle.load()) {
+      p->DrainOnCallingThread();
+    }
+    p->ReportAbandoned();
+    return;
+  }
+
+  // The thread is detached rather than joined: this may be destroyed from
+  // DllMain, where waiting for a thread to exit deadlocks on the loader lock.
+  // The thread keeps `p` alive if it doesn't stop in time.
+  const auto start = std::chrono::steady_clock::now();
+  p->Flush(p->mOptions.mShutdownTimeout);
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now() - start);
+  p->Stop(std::max(
+    std::chrono::milliseconds::zero(),
+    p->mOptions.mShutdownTimeout - elapsed));
+  mFlusher.detach();
+  p->ReportAbandoned();
+}
+
+void GameEventSender::Shutdown() {
+  if (!mFlusher.joinable()) {
+    return;
+  }
+  p->mShutDown.store(true);
+  // `Run()` writes everything that's queued before it stops
+  p->Stop(std::chrono::milliseconds::zero());
+  mFlusher.join();
+
+  // Catch anything that was enqueued after the thread's last check, by
+  // producers that started before `mShutDown` was set
+  while (p->mPushing.load() > 0) {
+    std::this_thread::yield();
+  }
+  p->DrainOnCallingThread();
+}
+
+void GameEventSender::Enqueue(GameEvent event) {
+  p->Push(std::move(event));
+}
+
+bool GameEventSender::Flush(std::chrono::milliseconds timeout) {
+  return p->Flush(timeout);
+}
+
+GameEventSender::Stats GameEventSender::GetStats() const {
+  return p->GetStats();
+}
+
+}// namespace OpenKneeboard
@@ -0,0 +1,187 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/ImageDecodePool.h>
+
+#include <algorithm>
+
+namespace OpenKneeboard {
+
+ImageDecoder::~ImageDecoder() = default;
+
+size_t ImageDecodePool::GetDefaultThreadCount() noexcept {
+  // Leave most cores for the game and the renderer
+  return std::clamp<size_t>(std::thread::hardware_concurrency() / 4, 1, 4);
+}
+
+ImageDecodePool::ImageDecodePool(
+  std::shared_ptr<ImageDecoder> decoder,
+  size_t threadCount)
+  : mDecoder(std::move(decoder)),
+    mThreadCount(std::max<size_t>(threadCount, 1)) {
+}
+
+ImageDecodePool::~ImageDecodePool() {
+  {
+    std::unique_lock lock(mMutex);
+    mQueued.clear();
+    mQueue.clear();
+    for (auto& [key, stopSource]: mRunning) {
+      stopSource.request_stop();
+    }
+    mRunning.clear();
+  }
+  for (auto& thread: mThreads) {
+    thread.request_stop();
+  }
+  // Joins
+  mThreads.clear();
+}
+
+ImageDecoder* ImageDecodePool::GetDecoder() const noexcept {
+  return mDecoder.get();
+}
+
+void ImageDecodePool::Request(
+  Key key,
+  const std::filesystem::path& path,
+  const ImageSize& maxSize,
+  int priority,
+  Callback callback) {
+  std::unique_lock lock(mMutex);
+  if (mRunning.contains(key)) {
+    return;
+  }
+
+  if (auto it = mQueued.find(key); it != mQueued.end()) {
+    auto& request = it->second;
+    request.mMaxSize = maxSize;
+    if (request.mOrder.first == priority) {
+      return;
+    }
+    mQueue.erase(request.mOrder);
+    request.mOrder.first = priority;
+    mQueue.emplace(request.mOrder, key);
+    return;
+  }
+
+  ++mStats.mRequested;
+  const Order order {priority, mNextSequence++};
+  mQueued.emplace(
+    key, QueuedRequest {path, maxSize, order, std::move(callback)});
+  mQueue.emplace(order, key);
+
+  if (mThreads.empty()) {
+    for (size_t i = 0; i < mThreadCount; ++i) {
+      mThreads.emplace_back(std::bind_front(&ImageDecodePool::Run, this));
+    }
+  }
+  mWake.notify_one();
+}
+
+bool ImageDecodePool::Cancel(Key key) {
+  return this->CancelIf([key](Key it) { return it == key; }) > 0;
+}
+
+size_t ImageDecodePool::CancelIf(const std::function<bool(Key)>& pred) {
+  std::unique_lock lock(mMutex);
+  size_t count = 0;
+  for (auto it = mQueued.begin(); it != mQueued.end();) {
+    if (!pred(it->first)) {
+      ++it;
+      continue;
+    }
+    mQueue.erase(it->second.mOrder);
+    it = mQueued.erase(it);
+    ++mStats.mCancelledQueued;
+    ++count;
+  }
+  for (auto it = mRunning.begin(); it != mRunning.end();) {
+    if (!pred(it->first)) {
+      ++it;
+      continue;
+    }
+    it->second.request_stop();
+    it = mRunning.erase(it);
+    ++mStats.mCancelledRunning;
+    ++count;
+  }
+  if (count > 0) {
+    mIdle.notify_all();
+  }
+  return count;
+}
+
+void ImageDecodePool::WaitForIdle() {
+  std::unique_lock lock(mMutex);
+  mIdle.wait(lock, [this] { return mQueue.empty() && mActiveThreads == 0; });
+}
+
+ImageDecodePool::Stats ImageDecodePool::GetStats() const {
+  std::unique_lock lock(mMutex);
+  auto stats = mStats;
+  stats.mQueued = mQueue.size();
+  stats.mRunning = mActiveThreads;
+  return stats;
+}
+
+void ImageDecodePool::Run(std::stop_token stopToken) {
+  std::unique_lock lock(mMutex);
+  while (true) {
+    mWake.wait(lock, stopToken, [this] { return !mQueue.empty(); });
+    if (stopToken.stop_requested()) {
+      return;
+    }
+
+    const auto key = mQueue.begin()->second;
+    mQueue.erase(mQueue.begin());
+    auto request = std::move(mQueued.extract(key).mapped());
+    std::stop_source cancel;
+    mRunning.emplace(key, cancel);
+    ++mActiveThreads;
+    lock.unlock();
+
+    std::optional<DecodedImage> image;
+    try {
+      image = mDecoder->Decode(
+        request.mPath, request.mMaxSize, cancel.get_token());
+    } catch (...) {
+      image = std::nullopt;
+    }
+
+    lock.lock();
+    if (!cancel.stop_requested()) {
+      mRunning.erase(key);
+      if (image) {
+        ++mStats.mDecoded;
+      } else {
+        ++mStats.mFailed;
+      }
+      lock.unlock();
+      request.mCallback(std::move(image));
+      // Release any references held by the callback before going idle
+      request = {};
+      lock.lock();
+    }
+    --mActiveThreads;
+    mIdle.notify_all();
+  }
+}
+
+}// namespace OpenKneeboard
@@ -0,0 +1,262 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/ImageResampler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <span>
+
+namespace OpenKneeboard {
+
+namespace {
+
+constexpr int WeightBits = 14;
+constexpr int32_t WeightOne = 1 << WeightBits;
+
+constexpr size_t Channels = DecodedImage::BytesPerPixel;
+// BGRA
+constexpr size_t AlphaChannel = 3;
+
+double CatmullRom(double x) {
+  x = std::abs(x);
+  if (x < 1) {
+    return ((1.5 * x - 2.5) * x * x) + 1;
+  }
+  if (x < 2) {
+    return (((-0.5 * x + 2.5) * x - 4) * x) + 2;
+  }
+  return 0;
+}
+
+/// The source pixels and weights for every pixel along one axis
+struct Contributions {
+  std::vector<uint32_t> mFirst;
+  std::vector<uint32_t> mCount;
+  // `mStride` weights per destination pixel
+  std::vector<int16_t> mWeights;
+  size_t mStride {0};
+
+  Contributions(uint32_t sourceSize, uint32_t destSize) {
+    const auto scale = static_cast<double>(sourceSize) / destSize;
+    // Widen the filter when downscaling, so every source pixel contributes
+    const auto filterScale = std::max(scale, 1.0);
+    const auto radius = 2 * filterScale;
+    mStride = static_cast<size_t>(std::ceil(radius) * 2) + 1;
+
+    mFirst.resize(destSize);
+    mCount.resize(destSize);
+    mWeights.resize(destSize * mStride);
+
+    std::vector<double> weights(mStride);
+    for (uint32_t i = 0; i < destSize; ++i) {
+      const auto center = ((i + 0.5) * scale) - 0.5;
+      const auto first = std::max<int64_t>(
+        static_cast<int64_t>(std::ceil(center - radius)), 0);
+      const auto last = std::min<int64_t>(
+        static_cast<int64_t>(std::floor(center + radius)), sourceSize - 1);
+      const auto count = static_cast<size_t>(std::max<int64_t>(
+        std::min<int64_t>(last - first + 1, mStride), 1));
+
+      double total = 0;
+      for (size_t j = 0; j < count; ++j) {
+        weights[j] = CatmullRom(
+          (static_cast<double>(first + j) - center) / filterScale);
+        total += weights[j];
+      }
+
+      // Normalize; as we drop samples outside of the image, this also makes
+      // the edges behave as if they were extended
+      auto out = &mWeights[i * mStride];
+      int32_t fixedTotal = 0;
+      size_t largest = 0;
+      for (size_t j = 0; j < count; ++j) {
+        const auto weight = (total == 0) ? (j == 0 ? 1.0 : 0.0)
+                                         : weights[j] / total;
+        out[j] = static_cast<int16_t>(std::lround(weight * WeightOne));
+        fixedTotal += out[j];
+        if (out[j] > out[largest]) {
+          largest = j;
+        }
+      }
+      // Make sure flat areas stay exactly flat
+      out[largest] += static_cast<int16_t>(WeightOne - fixedTotal);
+
+      mFirst[i] = static_cast<uint32_t>(first);
+      mCount[i] = static_cast<uint32_t>(count);
+    }
+  }
+};
+
+// Extra precision kept between the horizontal and vertical passes; values
+// are also left unclamped, as Catmull-Rom overshoots near edges, and
+// clamping before the second pass would lose that.
+using Intermediate = int16_t;
+constexpr int IntermediateBits = 6;
+
+template <class T>
+constexpr int FractionBits = std::same_as<T, Intermediate> ? IntermediateBits
+                                                           : 0;
+
+template <class Out, class In>
+Out Store(int32_t value) {
+  constexpr int shift = WeightBits + FractionBits<In> - FractionBits<Out>;
+  const auto rounded = (value + (1 << (shift - 1))) >> shift;
+  if constexpr (std::same_as<Out, Intermediate>) {
+    return static_cast<Out>(rounded);
+  } else {
+    return static_cast<Out>(std::clamp<int32_t>(rounded, 0, 255));
+  }
+}
+
+template <class T>
+int32_t Load(T value) {
+  if constexpr (std::same_as<T, std::byte>) {
+    return std::to_integer<int32_t>(value);
+  } else {
+    return value;
+  }
+}
+
+template <class T>
+struct Pixels {
+  std::vector<T> mData {};
+  ImageSize mSize;
+
+  size_t GetStride() const noexcept {
+    return size_t {mSize.mWidth} * Channels;
+  }
+};
+
+template <class Out, class In>
+void ResampleHorizontally(
+  std::span<const In> source,
+  const ImageSize& sourceSize,
+  Pixels<Out>& dest) {
+  const Contributions columns(sourceSize.mWidth, dest.mSize.mWidth);
+  const auto sourceStride = size_t {sourceSize.mWidth} * Channels;
+  for (uint32_t y = 0; y < sourceSize.mHeight; ++y) {
+    const auto row = source.data() + (y * sourceStride);
+    auto out = dest.mData.data() + (y * dest.GetStride());
+    for (size_t x = 0; x < dest.mSize.mWidth; ++x, out += Channels) {
+      const auto weights = &columns.mWeights[x * columns.mStride];
+      const auto count = columns.mCount[x];
+      auto in = row + (columns.mFirst[x] * Channels);
+      int32_t b = 0, g = 0, r = 0, a = 0;
+      for (size_t i = 0; i < count; ++i, in += Channels) {
+        const int32_t weight = weights[i];
+        b += weight * Load(in[0]);
+        g += weight * Load(in[1]);
+        r += weight * Load(in[2]);
+        a += weight * Load(in[3]);
+      }
+      out[0] = Store<Out, In>(b);
+      out[1] = Store<Out, In>(g);
+      out[2] = Store<Out, In>(r);
+      out[3] = Store<Out, In>(a);
+    }
+  }
+}
+
+template <class Out, class In>
+void ResampleVertically(
+  std::span<const In> source,
+  const ImageSize& sourceSize,
+  Pixels<Out>& dest) {
+  const Contributions rows(sourceSize.mHeight, dest.mSize.mHeight);
+  const auto stride = dest.GetStride();
+  // Whole rows at a time, so that the inner loop is over contiguous values
+  std::vector<int32_t> accumulator(stride);
+  for (uint32_t y = 0; y < dest.mSize.mHeight; ++y) {
+    std::ranges::fill(accumulator, 0);
+    const auto weights = &rows.mWeights[y * rows.mStride];
+    for (size_t i = 0; i < rows.mCount[y]; ++i) {
+      const int32_t weight = weights[i];
+      const auto in = source.data() + ((rows.mFirst[y] + i) * stride);
+      for (size_t x = 0; x < stride; ++x) {
+        accumulator[x] += weight * Load(in[x]);
+      }
+    }
+    auto out = dest.mData.data() + (y * stride);
+    for (size_t x = 0; x < stride; ++x) {
+      out[x] = Store<Out, In>(accumulator[x]);
+    }
+  }
+}
+
+template <class Out, class In>
+void Resample(
+  bool horizontal,
+  std::span<const In> source,
+  const ImageSize& sourceSize,
+  Pixels<Out>& dest) {
+  dest.mData.resize(dest.GetStride() * dest.mSize.mHeight);
+  if (horizontal) {
+    ResampleHorizontally(source, sourceSize, dest);
+  } else {
+    ResampleVertically(source, sourceSize, dest);
+  }
+}
+
+}// namespace
+
+DecodedImage ResampleImage(const DecodedImage& source, const ImageSize& size) {
+  if (source.mSize == size) {
+    return source;
+  }
+  if (size.mWidth == 0 || size.mHeight == 0) {
+    return {.mSize = size, .mNativeSize = source.mNativeSize};
+  }
+
+  const std::span<const std::byte> in {source.mPixels};
+  Pixels<std::byte> out {.mSize = size};
+  const auto sameWidth = (source.mSize.mWidth == size.mWidth);
+  if (sameWidth || source.mSize.mHeight == size.mHeight) {
+    Resample(/* horizontal = */ !sameWidth, in, source.mSize, out);
+  } else {
+    // Shrink the image as early as possible, so the second pass does less
+    // work
+    const auto horizontalFirst = uint64_t {size.mWidth} * source.mSize.mHeight
+      <= uint64_t {size.mHeight} * source.mSize.mWidth;
+    Pixels<Intermediate> intermediate {
+      .mSize = horizontalFirst ? ImageSize {size.mWidth, source.mSize.mHeight}
+                               : ImageSize {source.mSize.mWidth, size.mHeight},
+    };
+    Resample(horizontalFirst, in, source.mSize, intermediate);
+    Resample<std::byte, Intermediate>(
+      !horizontalFirst, intermediate.mData, intermediate.mSize, out);
+  }
+
+  // Catmull-Rom overshoots on sharp edges; keep the colors valid
+  for (size_t i = 0; i < out.mData.size(); i += Channels) {
+    const auto alpha = out.mData[i + AlphaChannel];
+    for (size_t c = 0; c < AlphaChannel; ++c) {
+      out.mData[i + c] = std::min(out.mData[i + c], alpha);
+    }
+  }
+
+  return {
+    .mSize = size,
+    .mNativeSize = source.mNativeSize,
+    .mPixels = std::move(out.mData),
+  };
+}
+
+}// namespace OpenKneeboard
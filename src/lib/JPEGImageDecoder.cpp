@@ -0,0 +1,210 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/ImageResampler.h>
+#include <OpenKneeboard/JPEGImageDecoder.h>
+#include <OpenKneeboard/scope_guard.h>
+
+#include <array>
+#include <csetjmp>
+#include <cstdio>
+#include <fstream>
+
+#include <jpeglib.h>
+
+namespace OpenKneeboard {
+
+namespace {
+
+// libjpeg reports fatal errors via `error_exit()`, which must not return;
+// we `longjmp()` back to `Decompress()`. Anything with a destructor must be
+// created before the `setjmp()`, and nothing is read after the `longjmp()`
+// other than the result.
+struct ErrorManager {
+  jpeg_error_mgr mManager {};
+  std::jmp_buf mJump {};
+};
+
+[[noreturn]] void ErrorExit(j_common_ptr info) {
+  std::longjmp(reinterpret_cast<ErrorManager*>(info->err)->mJump, 1);
+}
+
+void OutputMessage(j_common_ptr) {
+  // Ignore warnings; libjpeg's default is to write them to stderr
+}
+
+// Reads from an `std::ifstream`, as `jpeg_stdio_src()` can't open wide
+// paths on Windows
+struct FileSource {
+  jpeg_source_mgr mManager {};
+  std::ifstream* mFile {nullptr};
+  std::array<JOCTET, 64 * 1024> mBuffer;
+};
+
+constexpr JOCTET FakeEOI[] {0xff, JPEG_EOI};
+
+void InitSource(j_decompress_ptr) {
+}
+
+boolean FillInputBuffer(j_decompress_ptr info) {
+  auto source = reinterpret_cast<FileSource*>(info->src);
+  source->mFile->read(
+    reinterpret_cast<char*>(source->mBuffer.data()), source->mBuffer.size());
+  const auto count = source->mFile->gcount();
+  if (count <= 0) {
+    // Truncated file; decode what we have, like `jpeg_stdio_src()`
+    source->mManager.next_input_byte = FakeEOI;
+    source->mManager.bytes_in_buffer = std::size(FakeEOI);
+    return TRUE;
+  }
+  source->mManager.next_input_byte = source->mBuffer.data();
+  source->mManager.bytes_in_buffer = static_cast<size_t>(count);
+  return TRUE;
+}
+
+void SkipInputData(j_decompress_ptr info, long count) {
+  auto& manager = *info->src;
+  while (count > static_cast<long>(manager.bytes_in_buffer)) {
+    count -= static_cast<long>(manager.bytes_in_buffer);
+    FillInputBuffer(info);
+  }
+  if (count > 0) {
+    manager.next_input_byte += count;
+    manager.bytes_in_buffer -= static_cast<size_t>(count);
+  }
+}
+
+void TermSource(j_decompress_ptr) {
+}
+
+/** Calls `body` with a decompressor that has read the JPEG header.
+ *
+ * Returns false if `body` returns false, or if libjpeg reports an error.
+ */
+template <class F>
+bool Decompress(const std::filesystem::path& path, F&& body) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  ErrorManager errors;
+  FileSource source;
+  source.mFile = &file;
+  jpeg_decompress_struct info {};
+  info.err = jpeg_std_error(&errors.mManager);
+  errors.mManager.error_exit = &ErrorExit;
+  errors.mManager.output_message = &OutputMessage;
+  jpeg_create_decompress(&info);
+  const scope_guard destroy([&info] { jpeg_destroy_decompress(&info); });
+
+  if (setjmp(errors.mJump)) {
+    return false;
+  }
+
+  source.mManager.init_source = &InitSource;
+  source.mManager.fill_input_buffer = &FillInputBuffer;
+  source.mManager.skip_input_data = &SkipInputData;
+  source.mManager.resync_to_restart = &jpeg_resync_to_restart;
+  source.mManager.term_source = &TermSource;
+  info.src = &source.mManager;
+
+  jpeg_read_header(&info, TRUE);
+  return body(info);
+}
+
+}// namespace
+
+std::optional<ImageSize> JPEGImageDecoder::ReadSize(
+  const std::filesystem::path& path) {
+  ImageSize size;
+  const auto ok = Decompress(path, [&size](jpeg_decompress_struct& info) {
+    size = {info.image_width, info.image_height};
+    return true;
+  });
+  if (!ok) {
+    return std::nullopt;
+  }
+  return size;
+}
+
+std::optional<DecodedImage> JPEGImageDecoder::Decode(
+  const std::filesystem::path& path,
+  const ImageSize& maxSize,
+  std::stop_token stopToken) {
+  // Rows per call to `jpeg_read_scanlines()`, and per cancellation check
+  constexpr size_t BatchSize = 16;
+
+  DecodedImage image;
+  ImageSize targetSize;
+  const auto ok = Decompress(path, [&](jpeg_decompress_struct& info) {
+    image.mNativeSize = {info.image_width, info.image_height};
+    targetSize = ScaleToFit(image.mNativeSize, maxSize);
+
+    // libjpeg can scale by n/8 while decoding, which is much cheaper than
+    // decoding at full size; pick the smallest that's still at least the
+    // target size, then resample the rest of the way.
+    info.scale_denom = 8;
+    for (info.scale_num = 1; info.scale_num < 8; ++info.scale_num) {
+      jpeg_calc_output_dimensions(&info);
+      if (
+        info.output_width >= targetSize.mWidth
+        && info.output_height >= targetSize.mHeight) {
+        break;
+      }
+    }
+
+    // Also converts greyscale; there's no alpha, so this is already
+    // premultiplied
+    info.out_color_space = JCS_EXT_BGRA;
+    jpeg_start_decompress(&info);
+
+    image.mSize = {info.output_width, info.output_height};
+    image.mPixels.resize(image.GetStride() * image.mSize.mHeight);
+
+    std::array<JSAMPROW, BatchSize> rows {};
+    while (info.output_scanline < info.output_height) {
+      if (stopToken.stop_requested()) {
+        return false;
+      }
+      for (size_t i = 0; i < rows.size(); ++i) {
+        const auto row = std::min<size_t>(
+          info.output_scanline + i, info.output_height - 1);
+        rows[i] = reinterpret_cast<JSAMPROW>(
+          image.mPixels.data() + (row * image.GetStride()));
+      }
+      jpeg_read_scanlines(
+        &info, rows.data(), static_cast<JDIMENSION>(rows.size()));
+    }
+    jpeg_finish_decompress(&info);
+    return true;
+  });
+  if (!ok) {
+    return std::nullopt;
+  }
+  if (image.mSize == targetSize) {
+    return image;
+  }
+  if (stopToken.stop_requested()) {
+    return std::nullopt;
+  }
+  return ResampleImage(image, targetSize);
+}
+
+}// namespace OpenKneeboard
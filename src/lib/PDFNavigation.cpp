@@ -18,19 +18,20 @@
  * USA.
  */
 
-#include <OpenKneeboard/DebugTimer.h>
+#include <OpenKneeboard/FileSnapshot.h>
 #include <OpenKneeboard/PDFNavigation.h>
-#include <OpenKneeboard/dprint.h>
-#include <OpenKneeboard/utf8.h>
-#include <Windows.h>
-#include <shellapi.h>
-#include <shims/winrt/base.h>
 
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
 #include <map>
+#include <mutex>
 #include <optional>
+#include <set>
+#include <span>
 #include <qpdf/QPDF.hh>
-#include <qpdf/QPDFOutlineDocumentHelper.hh>
+#include <qpdf/QPDFNameTreeObjectHelper.hh>
 #include <qpdf/QPDFPageDocumentHelper.hh>
 #include <shims/filesystem>
 
@@ -38,63 +39,220 @@ namespace OpenKneeboard::PDFNavigation {
 
 using PageIndexMap = std::map<QPDFObjGen, PageIndex>;
 
+static std::string ToUTF8(const std::filesystem::path& path) {
+  const auto utf8 = path.u8string();
+  return {reinterpret_cast<const char*>(utf8.data()), utf8.size()};
+}
+
+template <class... Args>
+static void Log(
+  const PDF::Logger& logger,
+  std::format_string<Args...> format,
+  Args&&... args) {
+  if (logger) {
+    logger(std::format(format, std::forward<Args>(args)...));
+  }
+}
+
+namespace {
+
+/// Logs how long the scope took
+class ScopedTimer final {
+ public:
+  ScopedTimer(const PDF::Logger& logger, std::string_view label)
+    : mLogger(logger), mLabel(label) {
+  }
+
+  ~ScopedTimer() {
+    Log(
+      mLogger,
+      "Timer: {} = {}",
+      mLabel,
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - mStart));
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  const PDF::Logger& mLogger;
+  std::string_view mLabel;
+  std::chrono::steady_clock::time_point mStart {
+    std::chrono::steady_clock::now()};
+};
+
+/** Resolves named destinations, like `QPDFOutlineDocumentHelper`.
+ *
+ * We don't use that helper, as its constructor builds the whole outline
+ * tree up front, following whatever `/First` and `/Next` say; walking the
+ * outline ourselves lets us bound it for malformed files.
+ */
+class Destinations final {
+ public:
+  explicit Destinations(QPDF& qpdf) {
+    auto root = qpdf.getRoot();
+    mDests = root.getKey("/Dests");
+    auto names = root.getKey("/Names");
+    if (!names.isDictionary()) {
+      return;
+    }
+    auto dests = names.getKey("/Dests");
+    if (dests.isDictionary()) {
+      mNames.emplace(dests, qpdf);
+    }
+  }
+
+  /// Returns the destination array for a name or string, or null
+  QPDFObjectHandle Resolve(QPDFObjectHandle name) {
+    QPDFObjectHandle dest = QPDFObjectHandle::newNull();
+    if (name.isName()) {
+      if (mDests.isDictionary()) {
+        dest = mDests.getKey(name.getName());
+      }
+    } else if (name.isString()) {
+      QPDFObjectHandle found;
+      if (mNames && mNames->findObject(name.getUTF8Value(), found)) {
+        dest = found;
+      }
+    }
+    if (dest.isDictionary()) {
+      dest = dest.getKey("/D");
+    }
+    return dest.isArray() ? dest : QPDFObjectHandle::newNull();
+  }
+
+ private:
+  // PDF 1.1-style `/Dests` dictionary
+  QPDFObjectHandle mDests;
+  // PDF 1.2+ `/Names` `/Dests` name tree
+  std::optional<QPDFNameTreeObjectHelper> mNames;
+};
+
+}// namespace
+
 struct PDF::Impl {
   Impl() = delete;
-  Impl(const std::filesystem::path&);
-  ~Impl();
+  Impl(const std::filesystem::path&, Logger);
+  Impl(const std::filesystem::path&, std::span<const std::byte>, Logger);
+
+  void Load(const std::filesystem::path&, std::span<const std::byte>);
+  /// Caller must hold mMutex
+  const std::vector<Link>& GetLinks(PageIndex);
+
+  // QPDF objects aren't thread-safe, even for reads
+  std::mutex mMutex;
 
   QPDF mQPDF;
-  std::optional<QPDFOutlineDocumentHelper> mOutlineDocumentHelper;
+  std::optional<Destinations> mDestinations;
   std::vector<QPDFPageObjectHelper> mPages;
   PageIndexMap mPageIndices;
-  winrt::handle mFile;
-  winrt::handle mMapping;
-  void* mView = nullptr;
+  std::vector<std::optional<std::vector<Link>>> mLinks;
+
+  std::shared_ptr<const FileSnapshot> mSnapshot;
+  Logger mLogger;
 };
 
-PDF::PDF(const std::filesystem::path& path) : p(new Impl(path)) {
+PDF::PDF(const std::filesystem::path& path, Logger logger)
+  : p(new Impl(path, std::move(logger))) {
+}
+
+PDF::PDF(
+  const std::filesystem::path& path,
+  std::span<const std::byte> content,
+  Logger logger)
+  : p(new Impl(path, content, std::move(logger))) {
+}
+
+PDF::PDF(std::shared_ptr<const FileSnapshot> snapshot, Logger logger)
+  : p(new Impl(snapshot->GetPath(), snapshot->GetBytes(), std::move(logger))) {
+  p->mSnapshot = std::move(snapshot);
 }
 
 PDF::~PDF() = default;
 
+// Like QPDF's own limit; malformed files can nest outlines arbitrarily deep
+constexpr size_t MaxOutlineDepth = 50;
+
+/// `item` and its siblings, and their children
 static void ExtractBookmarks(
-  std::vector<QPDFOutlineObjectHelper>& outlines,
+  QPDFObjectHandle item,
+  Destinations& destinations,
   const PageIndexMap& pageIndices,
-  std::back_insert_iterator<std::vector<Bookmark>> inserter) {
+  std::set<QPDFObjGen>& seen,
+  size_t depth,
+  std::vector<Bookmark>& bookmarks) {
   // Useful references:
   // - i7j-rups
   // -
   // https://www.adobe.com/content/dam/acom/en/devnet/pdf/pdfs/PDF32000_2008.pdf
-  for (auto& outline: outlines) {
-    auto page = outline.getDestPage();
-    auto key = page.getObjGen();
-    if (!pageIndices.contains(key)) {
-      continue;
+  if (depth > MaxOutlineDepth) {
+    return;
+  }
+  for (; item.isDictionary(); item = item.getKey("/Next")) {
+    // Malformed files can have cycles in the outline tree; any cycle
+    // includes an indirect object
+    const auto id = item.getObjGen();
+    if (id.isIndirect() && !seen.insert(id).second) {
+      return;
     }
-    inserter = {
-      .mName = outline.getTitle(),
-      .mPageIndex = pageIndices.at(key),
-    };
 
-    auto kids = outline.getKids();
-    ExtractBookmarks(kids, pageIndices, inserter);
+    auto dest = item.getKey("/Dest");
+    if (dest.isNull()) {
+      auto action = item.getKey("/A");
+      if (
+        action.isDictionary() && action.getKey("/S").isName()
+        && action.getKey("/S").getName() == "/GoTo") {
+        dest = action.getKey("/D");
+      }
+    }
+    if (dest.isName() || dest.isString()) {
+      dest = destinations.Resolve(dest);
+    }
+    if (!dest.isArray()) {
+      continue;
+    }
+    const auto page = pageIndices.find(dest.getArrayItem(0).getObjGen());
+    if (page == pageIndices.end()) {
+      continue;
+    }
+    auto title = item.getKey("/Title");
+    bookmarks.push_back({
+      .mName = title.isString() ? title.getUTF8Value() : std::string {},
+      .mPageIndex = page->second,
+    });
+
+    ExtractBookmarks(
+      item.getKey("/First"),
+      destinations,
+      pageIndices,
+      seen,
+      depth + 1,
+      bookmarks);
   }
 }
 
 static std::vector<Bookmark> ExtractBookmarks(
-  QPDFOutlineDocumentHelper& outlineHelper,
-  const PageIndexMap& pageIndices) {
+  QPDF& qpdf,
+  Destinations& destinations,
+  const PageIndexMap& pageIndices,
+  const PDF::Logger& logger) {
   std::vector<Bookmark> bookmarks;
-  DebugTimer timer("Bookmarks");
-  auto outlines = outlineHelper.getTopLevelOutlines();
-  ExtractBookmarks(outlines, pageIndices, std::back_inserter(bookmarks));
+  ScopedTimer timer(logger, "Bookmarks");
+  auto outlines = qpdf.getRoot().getKey("/Outlines");
+  if (!outlines.isDictionary()) {
+    return bookmarks;
+  }
+  std::set<QPDFObjGen> seen;
+  ExtractBookmarks(
+    outlines.getKey("/First"), destinations, pageIndices, seen, 1, bookmarks);
   return bookmarks;
 }
 
 static bool PushDestLink(
   QPDFObjectHandle& it,
   const PageIndexMap& pageIndices,
-  const D2D1_RECT_F& rect,
+  const Rect& rect,
   std::vector<Link>& links) {
   if (!it.hasKey("/Dest")) {
     return false;
@@ -118,7 +276,7 @@ static bool PushDestLink(
 
 static void PushURIActionLink(
   QPDFObjectHandle& action,
-  const D2D1_RECT_F& rect,
+  const Rect& rect,
   std::vector<Link>& links) {
   if (!action.hasKey("/URI")) {
     return;
@@ -136,10 +294,10 @@ static void PushURIActionLink(
 }
 
 static void PushGoToActionLink(
-  QPDFOutlineDocumentHelper& outlineHelper,
+  Destinations& destinations,
   const PageIndexMap& pageIndices,
   QPDFObjectHandle& action,
-  const D2D1_RECT_F& rect,
+  const Rect& rect,
   std::vector<Link>& links) {
   if (!action.hasKey("/D")) {
     return;
@@ -149,7 +307,7 @@ static void PushGoToActionLink(
   if (!(dest.isName() || dest.isString())) {
     return;
   }
-  dest = outlineHelper.resolveNamedDest(dest);
+  dest = destinations.Resolve(dest);
   if (!dest.isArray()) {
     return;
   }
@@ -169,10 +327,10 @@ static void PushGoToActionLink(
 }
 
 static bool PushActionLink(
-  QPDFOutlineDocumentHelper& outlineHelper,
+  Destinations& destinations,
   const PageIndexMap& pageIndices,
   QPDFObjectHandle& it,
-  const D2D1_RECT_F& rect,
+  const Rect& rect,
   std::vector<Link>& links) {
   if (!it.hasKey("/A")) {
     return false;
@@ -190,7 +348,7 @@ static bool PushActionLink(
   }
 
   if (type == "/GoTo") {
-    PushGoToActionLink(outlineHelper, pageIndices, action, rect, links);
+    PushGoToActionLink(destinations, pageIndices, action, rect, links);
     return true;
   }
 
@@ -198,9 +356,10 @@ static bool PushActionLink(
 }
 
 static std::vector<Link> ExtractLinks(
-  QPDFOutlineDocumentHelper& outlineHelper,
+  Destinations& destinations,
   QPDFPageObjectHelper& page,
-  const PageIndexMap& pageIndices) {
+  const PageIndexMap& pageIndices,
+  const PDF::Logger& logger) {
   auto annotations = page.getAnnotations("/Link");
   if (annotations.empty()) {
     return {};
@@ -209,13 +368,16 @@ static std::vector<Link> ExtractLinks(
   auto pageRect = page.getCropBox().getArrayAsRectangle();
   const auto pageWidth = static_cast<float>(pageRect.urx - pageRect.llx);
   const auto pageHeight = static_cast<float>(pageRect.ury - pageRect.lly);
+  if (!(pageWidth > 0 && pageHeight > 0)) {
+    return {};
+  }
 
   std::vector<Link> links;
   for (auto& annotation: annotations) {
     // Convert bottom-left origin (PDF) to top-left origin (everything else,
     // including D2D)
     const auto pdfRect = annotation.getRect();
-    const D2D1_RECT_F linkRect {
+    const Rect linkRect {
       .left = static_cast<float>(pdfRect.llx - pageRect.llx) / pageWidth,
       .top
       = 1.0f - (static_cast<float>(pdfRect.ury - pageRect.lly) / pageHeight),
@@ -225,94 +387,409 @@ static std::vector<Link> ExtractLinks(
     };
 
     auto handle = annotation.getObjectHandle();
-    if (PushDestLink(handle, pageIndices, linkRect, links)) {
-      continue;
-    }
-    if (PushActionLink(outlineHelper, pageIndices, handle, linkRect, links)) {
-      continue;
+    // A single broken annotation shouldn't lose us the rest of the page
+    try {
+      if (PushDestLink(handle, pageIndices, linkRect, links)) {
+        continue;
+      }
+      PushActionLink(destinations, pageIndices, handle, linkRect, links);
+    } catch (const std::exception& e) {
+      Log(logger, "Skipping invalid PDF link annotation: {}", e.what());
     }
   }
   return links;
 }
 
-static std::vector<std::vector<Link>> ExtractLinks(
-  QPDFOutlineDocumentHelper& outlineHelper,
-  std::vector<QPDFPageObjectHelper>& pages,
-  const PageIndexMap& pageIndices) {
-  DebugTimer timer("Links");
-  std::vector<std::vector<Link>> allLinks;
-  allLinks.reserve(pages.size());
+namespace {
 
-  for (auto& page: pages) {
-    allLinks.push_back(ExtractLinks(outlineHelper, page, pageIndices));
+struct Matrix final {
+  double a {1}, b {0}, c {0}, d {1}, e {0}, f {0};
+
+  static Matrix FromOperands(const std::vector<QPDFObjectHandle>& operands) {
+    return {
+      operands.at(0).getNumericValue(),
+      operands.at(1).getNumericValue(),
+      operands.at(2).getNumericValue(),
+      operands.at(3).getNumericValue(),
+      operands.at(4).getNumericValue(),
+      operands.at(5).getNumericValue(),
+    };
   }
 
-  return allLinks;
-}
+  static Matrix Translation(double x, double y) {
+    return {1, 0, 0, 1, x, y};
+  }
 
-PDF::Impl::Impl(const std::filesystem::path& path) {
-  if (!std::filesystem::is_regular_file(path)) {
-    dprintf(L"Can't find PDF file {}", path.wstring());
-    return;
+  // PDF uses row vectors, so `A * B` applies A first
+  Matrix operator*(const Matrix& o) const {
+    return {
+      (a * o.a) + (b * o.c),
+      (a * o.b) + (b * o.d),
+      (c * o.a) + (d * o.c),
+      (c * o.b) + (d * o.d),
+      (e * o.a) + (f * o.c) + o.e,
+      (e * o.b) + (f * o.d) + o.f,
+    };
   }
+};
 
-  DebugTimer initTimer("PDF Init");
-
-  const auto fileSize = std::filesystem::file_size(path);
-  const auto wpath = path.wstring();
-  mFile = {CreateFileW(
-    wpath.c_str(),
-    GENERIC_READ,
-    FILE_SHARE_READ,
-    nullptr,
-    OPEN_EXISTING,
-    FILE_ATTRIBUTE_NORMAL,
-    NULL)};
-  if (!mFile) {
-    dprint("Failed to open PDF with CreateFileW");
-    return;
+/** Collects text lines from a page content stream.
+ *
+ * This is intentionally approximate: glyph widths are estimated from the
+ * font size, and only single-byte, ASCII-compatible encodings are decoded.
+ * That's enough to find and highlight frequencies, procedure names, etc in
+ * typical kneeboard PDFs.
+ */
+class TextExtractor final : public QPDFObjectHandle::ParserCallbacks {
+ public:
+  // Rough average glyph width, as a fraction of the font size
+  static constexpr double GlyphWidth = 0.5;
+
+  std::vector<TextLine> GetLines(const QPDFObjectHandle::Rectangle& cropBox) {
+    this->FlushLine();
+    const auto width = cropBox.urx - cropBox.llx;
+    const auto height = cropBox.ury - cropBox.lly;
+    std::vector<TextLine> lines;
+    if (!(width > 0 && height > 0)) {
+      return lines;
+    }
+    for (const auto& line: mLines) {
+      // Convert bottom-left origin (PDF) to top-left origin
+      lines.push_back({
+        line.mText,
+        {
+          .left = static_cast<float>((line.mLeft - cropBox.llx) / width),
+          .top = static_cast<float>(1 - ((line.mTop - cropBox.lly) / height)),
+          .right = static_cast<float>((line.mRight - cropBox.llx) / width),
+          .bottom
+          = static_cast<float>(1 - ((line.mBottom - cropBox.lly) / height)),
+        },
+      });
+    }
+    return lines;
+  }
+
+  void handleObject(QPDFObjectHandle object) override {
+    if (!object.isOperator()) {
+      mOperands.push_back(object);
+      return;
+    }
+    // Malformed operators shouldn't lose us the rest of the page
+    try {
+      this->HandleOperator(object.getOperatorValue());
+    } catch (const std::exception&) {
+    }
+    mOperands.clear();
+  }
+
+  void handleEOF() override {
+  }
+
+ private:
+  struct PendingLine {
+    std::string mText;
+    double mBaseline {};
+    double mSize {};
+    double mLeft {};
+    double mRight {};
+    double mTop {};
+    double mBottom {};
+  };
+
+  std::vector<QPDFObjectHandle> mOperands;
+  std::vector<Matrix> mStateStack;
+  Matrix mCTM;
+  Matrix mTextMatrix;
+  Matrix mLineMatrix;
+  double mFontSize {0};
+  double mLeading {0};
+
+  std::optional<PendingLine> mCurrentLine;
+  std::vector<PendingLine> mLines;
+
+  void HandleOperator(const std::string& op) {
+    if (op == "q") {
+      mStateStack.push_back(mCTM);
+    } else if (op == "Q") {
+      if (!mStateStack.empty()) {
+        mCTM = mStateStack.back();
+        mStateStack.pop_back();
+      }
+    } else if (op == "cm") {
+      mCTM = Matrix::FromOperands(mOperands) * mCTM;
+    } else if (op == "BT") {
+      mTextMatrix = mLineMatrix = {};
+    } else if (op == "Tf") {
+      mFontSize = mOperands.at(1).getNumericValue();
+    } else if (op == "TL") {
+      mLeading = mOperands.at(0).getNumericValue();
+    } else if (op == "Tm") {
+      mTextMatrix = mLineMatrix = Matrix::FromOperands(mOperands);
+    } else if (op == "Td" || op == "TD") {
+      const auto x = mOperands.at(0).getNumericValue();
+      const auto y = mOperands.at(1).getNumericValue();
+      if (op == "TD") {
+        mLeading = -y;
+      }
+      mTextMatrix = mLineMatrix = Matrix::Translation(x, y) * mLineMatrix;
+    } else if (op == "T*") {
+      this->NextLine();
+    } else if (op == "Tj") {
+      this->ShowText(mOperands.at(0));
+    } else if (op == "'") {
+      this->NextLine();
+      this->ShowText(mOperands.at(0));
+    } else if (op == "\"") {
+      this->NextLine();
+      this->ShowText(mOperands.at(2));
+    } else if (op == "TJ") {
+      for (const auto& item: mOperands.at(0).getArrayAsVector()) {
+        if (item.isNumber()) {
+          // Thousandths of text space; large negative adjustments are
+          // usually word gaps
+          const auto adjustment = item.getNumericValue();
+          this->Advance(-adjustment / 1000 * mFontSize, adjustment < -200);
+          continue;
+        }
+        this->ShowText(item);
+      }
+    }
+  }
+
+  void NextLine() {
+    mTextMatrix = mLineMatrix
+      = Matrix::Translation(0, -mLeading) * mLineMatrix;
+  }
+
+  void Advance(double textSpaceX, bool gap) {
+    mTextMatrix = Matrix::Translation(textSpaceX, 0) * mTextMatrix;
+    if (gap && mCurrentLine && !mCurrentLine->mText.ends_with(' ')) {
+      mCurrentLine->mText.push_back(' ');
+    }
+  }
+
+  static std::string Decode(const std::string& raw) {
+    std::string ret;
+    ret.reserve(raw.size());
+    for (const auto c: raw) {
+      const auto u = static_cast<unsigned char>(c);
+      if (u >= 0x20 && u < 0x7f) {
+        ret.push_back(c);
+        continue;
+      }
+      if (u >= 0xa0) {
+        // Latin-1 range of WinAnsiEncoding and StandardEncoding
+        ret.push_back(static_cast<char>(0xc0 | (u >> 6)));
+        ret.push_back(static_cast<char>(0x80 | (u & 0x3f)));
+        continue;
+      }
+      if (u < 0x20 && c != '\t' && c != '\n' && c != '\r') {
+        // Almost certainly a multi-byte encoding that we can't decode
+        // without the font's ToUnicode map
+        return {};
+      }
+      ret.push_back(' ');
+    }
+    return ret;
+  }
+
+  void ShowText(const QPDFObjectHandle& object) {
+    if (!object.isString()) {
+      return;
+    }
+    const auto raw = object.getStringValue();
+    const auto advance = raw.size() * GlyphWidth * mFontSize;
+    const auto text = Decode(raw);
+    if (text.empty()) {
+      this->Advance(advance, false);
+      return;
+    }
+
+    const auto device = mTextMatrix * mCTM;
+    const auto scale = std::hypot(device.c, device.d);
+    const auto size = mFontSize * scale;
+    const auto x = device.e;
+    const auto y = device.f;
+    const auto width = advance * std::hypot(device.a, device.b);
+
+    if (mCurrentLine) {
+      auto& line = *mCurrentLine;
+      const auto tolerance = std::max(line.mSize, size) * 0.3;
+      const auto sameLine = std::abs(y - line.mBaseline) <= tolerance
+        && x >= line.mLeft && x <= line.mRight + (size * 2);
+      if (sameLine) {
+        if (x > line.mRight + (size * 0.15) && !line.mText.ends_with(' ')) {
+          line.mText.push_back(' ');
+        }
+        line.mText += text;
+        line.mRight = std::max(line.mRight, x + width);
+        line.mTop = std::max(line.mTop, y + (size * 0.8));
+        line.mBottom = std::min(line.mBottom, y - (size * 0.2));
+        this->Advance(advance, false);
+        return;
+      }
+      this->FlushLine();
+    }
+
+    mCurrentLine = PendingLine {
+      .mText = text,
+      .mBaseline = y,
+      .mSize = size,
+      .mLeft = x,
+      .mRight = x + width,
+      .mTop = y + (size * 0.8),
+      .mBottom = y - (size * 0.2),
+    };
+    this->Advance(advance, false);
+  }
+
+  void FlushLine() {
+    if (!mCurrentLine) {
+      return;
+    }
+    if (mCurrentLine->mText.find_first_not_of(' ') != std::string::npos) {
+      mLines.push_back(std::move(*mCurrentLine));
+    }
+    mCurrentLine = {};
   }
-  mMapping = {CreateFileMappingW(
-    mFile.get(),
-    nullptr,
-    PAGE_READONLY,
-    fileSize >> 32,
-    static_cast<DWORD>(fileSize),
-    nullptr)};
-  if (!mMapping) {
-    dprint("Failed to create file mapping of PDF");
+};
+
+}// namespace
+
+PDF::Impl::Impl(const std::filesystem::path& path, Logger logger)
+  : mLogger(std::move(logger)) {
+  ScopedTimer initTimer(mLogger, "PDF Init");
+
+  mSnapshot = FileSnapshot::Read(path);
+  if (!mSnapshot) {
+    Log(mLogger, "Can't read PDF file {}", ToUTF8(path));
     return;
   }
-  mView = MapViewOfFile(mMapping.get(), FILE_MAP_READ, 0, 0, fileSize);
+  this->Load(path, mSnapshot->GetBytes());
+}
+
+PDF::Impl::Impl(
+  const std::filesystem::path& path,
+  std::span<const std::byte> content,
+  Logger logger)
+  : mLogger(std::move(logger)) {
+  ScopedTimer initTimer(mLogger, "PDF Init");
+  this->Load(path, content);
+}
 
-  const auto utf8Path = to_utf8(path);
-  mQPDF.processMemoryFile(
-    utf8Path.c_str(), reinterpret_cast<const char*>(mView), fileSize);
-  mPages = QPDFPageDocumentHelper(mQPDF).getAllPages();
-  for (const auto& page: mPages) {
-    mPageIndices[page.getObjectHandle().getObjGen()] = mPageIndices.size();
+void PDF::Impl::Load(
+  const std::filesystem::path& path,
+  std::span<const std::byte> content) {
+  const auto utf8Path = ToUTF8(path);
+  // Warnings go to stderr by default, and QPDF is chatty about recoverable
+  // errors in malformed files
+  mQPDF.setSuppressWarnings(true);
+  try {
+    mQPDF.processMemoryFile(
+      utf8Path.c_str(),
+      reinterpret_cast<const char*>(content.data()),
+      content.size());
+    mPages = QPDFPageDocumentHelper(mQPDF).getAllPages();
+    for (const auto& page: mPages) {
+      mPageIndices[page.getObjectHandle().getObjGen()] = mPageIndices.size();
+    }
+    mDestinations.emplace(mQPDF);
+  } catch (const std::exception& e) {
+    Log(mLogger, "Failed to load PDF {}: {}", utf8Path, e.what());
+    mPages.clear();
+    mPageIndices.clear();
+    mDestinations.reset();
   }
-  mOutlineDocumentHelper.emplace(mQPDF);
+  mLinks.resize(mPages.size());
 }
 
-PDF::Impl::~Impl() {
-  if (mView) {
-    UnmapViewOfFile(mView);
+const std::vector<Link>& PDF::Impl::GetLinks(PageIndex index) {
+  auto& links = mLinks.at(index);
+  if (!links) {
+    try {
+      links = ExtractLinks(
+        *mDestinations, mPages.at(index), mPageIndices, mLogger);
+    } catch (const std::exception& e) {
+      Log(
+        mLogger,
+        "Failed to extract links for PDF page {}: {}",
+        index,
+        e.what());
+      links.emplace();
+    }
   }
+  return *links;
+}
+
+PageIndex PDF::GetPageCount() const {
+  return static_cast<PageIndex>(p->mPages.size());
 }
 
 std::vector<Bookmark> PDF::GetBookmarks() {
+  std::unique_lock lock(p->mMutex);
   if (p->mPages.empty()) {
     return {};
   }
-  return ExtractBookmarks(*p->mOutlineDocumentHelper, p->mPageIndices);
+  try {
+    return ExtractBookmarks(
+      p->mQPDF, *p->mDestinations, p->mPageIndices, p->mLogger);
+  } catch (const std::exception& e) {
+    Log(p->mLogger, "Failed to extract PDF bookmarks: {}", e.what());
+    return {};
+  }
 }
 
 std::vector<std::vector<Link>> PDF::GetLinks() {
-  if (p->mPages.empty()) {
+  ScopedTimer timer(p->mLogger, "Links");
+  std::vector<std::vector<Link>> allLinks;
+  allLinks.reserve(p->mPages.size());
+  for (PageIndex i = 0; i < p->mPages.size(); ++i) {
+    // Lock per-page so that `GetLinks(PageIndex)` isn't blocked for long
+    std::unique_lock lock(p->mMutex);
+    allLinks.push_back(p->GetLinks(i));
+  }
+  return allLinks;
+}
+
+std::vector<Link> PDF::GetLinks(PageIndex index) {
+  if (index >= p->mPages.size()) {
+    return {};
+  }
+  std::unique_lock lock(p->mMutex);
+  return p->GetLinks(index);
+}
+
+void PDF::PrefetchLinks(PageIndex first, PageIndex count) {
+  const auto last = std::min<size_t>(p->mPages.size(), first + count);
+  for (PageIndex i = first; i < last; ++i) {
+    std::unique_lock lock(p->mMutex);
+    p->GetLinks(i);
+  }
+}
+
+std::vector<TextLine> PDF::GetText(PageIndex index) {
+  if (index >= p->mPages.size()) {
+    return {};
+  }
+  std::unique_lock lock(p->mMutex);
+  auto& page = p->mPages.at(index);
+  TextExtractor extractor;
+  try {
+    page.parseContents(&extractor);
+  } catch (const std::exception& e) {
+    // Keep whatever we found before the error
+    Log(
+      p->mLogger,
+      "Failed to extract text for PDF page {}: {}",
+      index,
+      e.what());
+  }
+  try {
+    return extractor.GetLines(page.getCropBox().getArrayAsRectangle());
+  } catch (const std::exception& e) {
+    Log(p->mLogger, "Invalid crop box for PDF page {}: {}", index, e.what());
     return {};
   }
-  return ExtractLinks(*p->mOutlineDocumentHelper, p->mPages, p->mPageIndices);
 }
 
 }// namespace OpenKneeboard::PDFNavigation
@@ -0,0 +1,386 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/PDFNavigationCache.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <random>
+
+namespace OpenKneeboard::PDFNavigation {
+
+namespace {
+
+class Writer final {
+ public:
+  void U8(uint8_t value) {
+    mBuffer.push_back(static_cast<std::byte>(value));
+  }
+
+  void U32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      this->U8(static_cast<uint8_t>(value >> (i * 8)));
+    }
+  }
+
+  void U64(uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      this->U8(static_cast<uint8_t>(value >> (i * 8)));
+    }
+  }
+
+  void F32(float value) {
+    this->U32(std::bit_cast<uint32_t>(value));
+  }
+
+  void String(std::string_view value) {
+    if (value.size() > std::numeric_limits<uint32_t>::max()) {
+      throw std::length_error("String too long for PDF navigation cache");
+    }
+    this->U32(static_cast<uint32_t>(value.size()));
+    const auto begin = reinterpret_cast<const std::byte*>(value.data());
+    mBuffer.insert(mBuffer.end(), begin, begin + value.size());
+  }
+
+  std::vector<std::byte>& GetBuffer() noexcept {
+    return mBuffer;
+  }
+
+ private:
+  std::vector<std::byte> mBuffer;
+};
+
+/// Bounds-checked; after any failure, all reads fail
+class Reader final {
+ public:
+  explicit Reader(std::span<const std::byte> buffer) : mBuffer(buffer) {
+  }
+
+  bool U8(uint8_t& out) noexcept {
+    if (!this->Have(1)) {
+      return false;
+    }
+    out = static_cast<uint8_t>(mBuffer[mOffset++]);
+    return true;
+  }
+
+  bool U32(uint32_t& out) noexcept {
+    uint64_t value {};
+    if (!this->Read(value, 4)) {
+      return false;
+    }
+    out = static_cast<uint32_t>(value);
+    return true;
+  }
+
+  bool U64(uint64_t& out) noexcept {
+    return this->Read(out, 8);
+  }
+
+  bool F32(float& out) noexcept {
+    uint32_t value {};
+    if (!this->U32(value)) {
+      return false;
+    }
+    out = std::bit_cast<float>(value);
+    return true;
+  }
+
+  bool String(std::string& out) {
+    uint32_t size {};
+    if (!(this->U32(size) && this->Have(size))) {
+      return false;
+    }
+    out.assign(
+      reinterpret_cast<const char*>(mBuffer.data() + mOffset), size);
+    mOffset += size;
+    return true;
+  }
+
+  /// Used to reject absurd counts before reserving memory for them
+  size_t GetRemaining() const noexcept {
+    return mFailed ? 0 : mBuffer.size() - mOffset;
+  }
+
+ private:
+  std::span<const std::byte> mBuffer;
+  size_t mOffset {0};
+  bool mFailed {false};
+
+  bool Have(size_t count) noexcept {
+    if (mFailed || mBuffer.size() - mOffset < count) {
+      mFailed = true;
+      return false;
+    }
+    return true;
+  }
+
+  bool Read(uint64_t& out, size_t byteCount) noexcept {
+    if (!this->Have(byteCount)) {
+      return false;
+    }
+    out = 0;
+    for (size_t i = 0; i < byteCount; ++i) {
+      out |= static_cast<uint64_t>(mBuffer[mOffset + i]) << (i * 8);
+    }
+    mOffset += byteCount;
+    return true;
+  }
+};
+
+// Smallest possible encodings, for sanity-checking counts
+constexpr size_t MinBookmarkSize = 4 + 8;
+constexpr size_t MinPageSize = 4;
+constexpr size_t MinLinkSize = (4 * 4) + 1 + 8 + 4;
+
+std::optional<Navigation> DeserializePayload(
+  std::span<const std::byte> payload) {
+  Reader reader(payload);
+  Navigation ret;
+
+  uint32_t bookmarkCount {};
+  if (
+    !reader.U32(bookmarkCount)
+    || bookmarkCount > reader.GetRemaining() / MinBookmarkSize) {
+    return {};
+  }
+  ret.mBookmarks.reserve(bookmarkCount);
+  for (uint32_t i = 0; i < bookmarkCount; ++i) {
+    Bookmark bookmark;
+    uint64_t pageIndex {};
+    if (!(reader.String(bookmark.mName) && reader.U64(pageIndex))) {
+      return {};
+    }
+    bookmark.mPageIndex = static_cast<PageIndex>(pageIndex);
+    ret.mBookmarks.push_back(std::move(bookmark));
+  }
+
+  uint32_t pageCount {};
+  if (
+    !reader.U32(pageCount) || pageCount > reader.GetRemaining() / MinPageSize) {
+    return {};
+  }
+  ret.mLinks.resize(pageCount);
+  for (auto& pageLinks: ret.mLinks) {
+    uint32_t linkCount {};
+    if (
+      !reader.U32(linkCount)
+      || linkCount > reader.GetRemaining() / MinLinkSize) {
+      return {};
+    }
+    pageLinks.reserve(linkCount);
+    for (uint32_t i = 0; i < linkCount; ++i) {
+      Link link {};
+      uint8_t type {};
+      uint64_t pageIndex {};
+      if (!(reader.F32(link.mRect.left) && reader.F32(link.mRect.top)
+            && reader.F32(link.mRect.right) && reader.F32(link.mRect.bottom)
+            && reader.U8(type) && reader.U64(pageIndex)
+            && reader.String(link.mDestination.mURI))) {
+        return {};
+      }
+      switch (static_cast<DestinationType>(type)) {
+        case DestinationType::Page:
+        case DestinationType::URI:
+          break;
+        default:
+          return {};
+      }
+      link.mDestination.mType = static_cast<DestinationType>(type);
+      link.mDestination.mPageIndex = static_cast<PageIndex>(pageIndex);
+      pageLinks.push_back(std::move(link));
+    }
+  }
+
+  if (reader.GetRemaining() != 0) {
+    return {};
+  }
+  return ret;
+}
+
+}// namespace
+
+NavigationCache::NavigationCache(const std::filesystem::path& directory)
+  : mDirectory(directory) {
+}
+
+std::filesystem::path NavigationCache::GetEntryPath(
+  const FileIdentity& identity) const {
+  return mDirectory
+    / std::format(
+           "{:016x}-{:x}.v{}.okpn",
+           identity.mContentHash,
+           identity.mSize,
+           Version);
+}
+
+std::vector<std::byte> NavigationCache::Serialize(
+  const FileIdentity& identity,
+  const Navigation& navigation) {
+  Writer w;
+  w.U32(static_cast<uint32_t>(navigation.mBookmarks.size()));
+  for (const auto& bookmark: navigation.mBookmarks) {
+    w.String(bookmark.mName);
+    w.U64(bookmark.mPageIndex);
+  }
+  w.U32(static_cast<uint32_t>(navigation.mLinks.size()));
+  for (const auto& pageLinks: navigation.mLinks) {
+    w.U32(static_cast<uint32_t>(pageLinks.size()));
+    for (const auto& link: pageLinks) {
+      w.F32(link.mRect.left);
+      w.F32(link.mRect.top);
+      w.F32(link.mRect.right);
+      w.F32(link.mRect.bottom);
+      w.U8(static_cast<uint8_t>(link.mDestination.mType));
+      w.U64(link.mDestination.mPageIndex);
+      w.String(link.mDestination.mURI);
+    }
+  }
+
+  const auto& payloadBytes = w.GetBuffer();
+
+  Writer header;
+  for (const auto c: Magic) {
+    header.U8(static_cast<uint8_t>(c));
+  }
+  header.U32(Version);
+  header.U64(identity.mSize);
+  header.U64(identity.mContentHash);
+  header.U64(payloadBytes.size());
+  header.U64(HashFileContent(payloadBytes));
+
+  auto ret = std::move(header.GetBuffer());
+  ret.insert(ret.end(), payloadBytes.begin(), payloadBytes.end());
+  return ret;
+}
+
+std::optional<Navigation> NavigationCache::Deserialize(
+  std::span<const std::byte> buffer,
+  const FileIdentity& identity) {
+  if (buffer.size() < HeaderSize) {
+    return {};
+  }
+  if (std::memcmp(buffer.data(), Magic.data(), Magic.size()) != 0) {
+    return {};
+  }
+
+  Reader header(buffer.subspan(Magic.size(), HeaderSize - Magic.size()));
+  uint32_t version {};
+  uint64_t size {}, contentHash {}, payloadSize {}, payloadHash {};
+  if (!(header.U32(version) && header.U64(size) && header.U64(contentHash)
+        && header.U64(payloadSize) && header.U64(payloadHash))) {
+    return {};
+  }
+  if (version != Version) {
+    return {};
+  }
+  if (size != identity.mSize || contentHash != identity.mContentHash) {
+    return {};
+  }
+
+  const auto payload = buffer.subspan(HeaderSize);
+  if (
+    payload.size() != payloadSize || HashFileContent(payload) != payloadHash) {
+    return {};
+  }
+
+  return DeserializePayload(payload);
+}
+
+std::optional<Navigation> NavigationCache::Load(
+  const FileIdentity& identity) const {
+  const auto path = this->GetEntryPath(identity);
+  const auto snapshot = FileSnapshot::Read(path, {.mMaxAttempts = 1});
+  if (!snapshot) {
+    return {};
+  }
+  auto ret = Deserialize(snapshot->GetBytes(), identity);
+  if (ret) {
+    // Used by `Prune()` to keep the most recently used entries
+    std::error_code ec;
+    std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), ec);
+  }
+  return ret;
+}
+
+bool NavigationCache::Store(
+  const FileIdentity& identity,
+  const Navigation& navigation) const {
+  const auto bytes = Serialize(identity, navigation);
+
+  std::error_code ec;
+  std::filesystem::create_directories(mDirectory, ec);
+  if (ec) {
+    return false;
+  }
+
+  const auto path = this->GetEntryPath(identity);
+  auto tempPath = path;
+  tempPath += std::format(".{:08x}.tmp", std::random_device {}());
+
+  {
+    std::ofstream f(tempPath, std::ios::binary | std::ios::trunc);
+    f.write(
+      reinterpret_cast<const char*>(bytes.data()),
+      static_cast<std::streamsize>(bytes.size()));
+    f.close();
+    if (!f) {
+      std::filesystem::remove(tempPath, ec);
+      return false;
+    }
+  }
+
+  // The content is a pure function of the key, so if another process got
+  // there first, losing the race is fine
+  std::filesystem::rename(tempPath, path, ec);
+  if (ec) {
+    std::filesystem::remove(tempPath, ec);
+    return std::filesystem::exists(path, ec);
+  }
+
+  this->Prune();
+  return true;
+}
+
+void NavigationCache::Prune() const {
+  std::error_code ec;
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>>
+    entries;
+  for (const auto& it: std::filesystem::directory_iterator(mDirectory, ec)) {
+    if (it.path().extension() != ".okpn") {
+      continue;
+    }
+    entries.push_back({it.last_write_time(ec), it.path()});
+  }
+  if (entries.size() <= MaxEntries) {
+    return;
+  }
+
+  std::ranges::sort(entries, std::greater {});
+  for (auto it = entries.begin() + MaxEntries; it != entries.end(); ++it) {
+    std::filesystem::remove(it->second, ec);
+  }
+}
+
+}// namespace OpenKneeboard::PDFNavigation
@@ -0,0 +1,568 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/PageImageCache.h>
+
+#include <OpenKneeboard/scope_guard.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+
+#include <zlib.h>
+
+namespace OpenKneeboard {
+
+namespace {
+
+constexpr std::string_view EntryExtension {".okpi"};
+constexpr std::string_view TemporaryExtension {".tmp"};
+// Anything older was left behind by a crash rather than still being written
+constexpr auto AbandonedTemporaryFileAge = std::chrono::minutes(10);
+
+class Writer final {
+ public:
+  void U8(uint8_t value) {
+    mBuffer.push_back(static_cast<std::byte>(value));
+  }
+
+  void U32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      this->U8(static_cast<uint8_t>(value >> (i * 8)));
+    }
+  }
+
+  void U64(uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      this->U8(static_cast<uint8_t>(value >> (i * 8)));
+    }
+  }
+
+  void String(std::string_view value) {
+    if (value.size() > std::numeric_limits<uint32_t>::max()) {
+      throw std::length_error("String too long for page image cache");
+    }
+    this->U32(static_cast<uint32_t>(value.size()));
+    const auto begin = reinterpret_cast<const std::byte*>(value.data());
+    mBuffer.insert(mBuffer.end(), begin, begin + value.size());
+  }
+
+  std::vector<std::byte>& GetBuffer() noexcept {
+    return mBuffer;
+  }
+
+ private:
+  std::vector<std::byte> mBuffer;
+};
+
+/// Bounds-checked; after any failure, all reads fail
+class Reader final {
+ public:
+  explicit Reader(std::span<const std::byte> buffer) : mBuffer(buffer) {
+  }
+
+  bool U32(uint32_t& out) noexcept {
+    uint64_t value {};
+    if (!this->Read(value, 4)) {
+      return false;
+    }
+    out = static_cast<uint32_t>(value);
+    return true;
+  }
+
+  bool U64(uint64_t& out) noexcept {
+    return this->Read(out, 8);
+  }
+
+  bool String(std::string& out) {
+    uint32_t size {};
+    if (!(this->U32(size) && this->Have(size))) {
+      return false;
+    }
+    out.assign(
+      reinterpret_cast<const char*>(mBuffer.data() + mOffset), size);
+    mOffset += size;
+    return true;
+  }
+
+  size_t GetOffset() const noexcept {
+    return mOffset;
+  }
+
+ private:
+  std::span<const std::byte> mBuffer;
+  size_t mOffset {0};
+  bool mFailed {false};
+
+  bool Have(size_t count) noexcept {
+    if (mFailed || mBuffer.size() - mOffset < count) {
+      mFailed = true;
+      return false;
+    }
+    return true;
+  }
+
+  bool Read(uint64_t& out, size_t byteCount) noexcept {
+    if (!this->Have(byteCount)) {
+      return false;
+    }
+    out = 0;
+    for (size_t i = 0; i < byteCount; ++i) {
+      out |= static_cast<uint64_t>(mBuffer[mOffset + i]) << (i * 8);
+    }
+    mOffset += byteCount;
+    return true;
+  }
+};
+
+std::string ToUTF8(const std::filesystem::path& path) {
+  const auto utf8 = path.u8string();
+  return {reinterpret_cast<const char*>(utf8.data()), utf8.size()};
+}
+
+uint64_t GetTicks(const FileIdentity& identity) {
+  return static_cast<uint64_t>(
+    identity.mLastWriteTime.time_since_epoch().count());
+}
+
+bool IsValidSize(const ImageSize& size) {
+  return size.mWidth > 0 && size.mHeight > 0
+    && size.mWidth <= PageImageCache::MaxDimension
+    && size.mHeight <= PageImageCache::MaxDimension;
+}
+
+void WriteKey(Writer& w, const PageImageKey& key) {
+  w.U64(key.mSource.mSize);
+  w.U64(GetTicks(key.mSource));
+  w.U64(key.mSource.mContentHash);
+  w.U64(key.mPage);
+  w.U32(key.mSize.mWidth);
+  w.U32(key.mSize.mHeight);
+}
+
+uint64_t GetEntryHash(const PageImageKey& key) {
+  Writer w;
+  w.String(ToUTF8(key.mPath));
+  WriteKey(w, key);
+  return HashFileContent(w.GetBuffer());
+}
+
+/// The inverse of the name built by `GetEntryPath()`
+std::optional<uint64_t> ParseEntryHash(const std::filesystem::path& path) {
+  const auto stem = ToUTF8(path.stem());
+  constexpr size_t hashLength = 16;
+  if (
+    stem.size() <= hashLength
+    || std::string_view {stem}.substr(hashLength)
+      != std::format(".v{}", PageImageCache::Version)) {
+    return {};
+  }
+  uint64_t ret {};
+  const auto end = stem.data() + hashLength;
+  const auto [ptr, ec] = std::from_chars(stem.data(), end, ret, 16);
+  if (ec != std::errc {} || ptr != end) {
+    return {};
+  }
+  return ret;
+}
+
+/* Each byte is stored as the difference from the same channel in the pixel
+ * to its left; this turns smooth gradients and flat areas into runs of
+ * small values, which deflate compresses much better than raw pixels. */
+void FilterRow(const std::byte* in, std::byte* out, size_t stride) {
+  constexpr auto bpp = DecodedImage::BytesPerPixel;
+  std::memcpy(out, in, std::min(stride, bpp));
+  for (size_t i = bpp; i < stride; ++i) {
+    out[i] = static_cast<std::byte>(
+      static_cast<uint8_t>(in[i]) - static_cast<uint8_t>(in[i - bpp]));
+  }
+}
+
+void UnfilterRow(std::byte* row, size_t stride) {
+  constexpr auto bpp = DecodedImage::BytesPerPixel;
+  for (size_t i = bpp; i < stride; ++i) {
+    row[i] = static_cast<std::byte>(
+      static_cast<uint8_t>(row[i]) + static_cast<uint8_t>(row[i - bpp]));
+  }
+}
+
+std::optional<std::vector<std::byte>> Compress(const DecodedImage& image) {
+  z_stream stream {};
+  // Favor speed: pages are compressed while the user is waiting for the
+  // next one to decode, and most of the win comes from filtering anyway
+  if (deflateInit(&stream, Z_BEST_SPEED) != Z_OK) {
+    return {};
+  }
+  const scope_guard end([&stream] { deflateEnd(&stream); });
+
+  std::vector<std::byte> ret(
+    deflateBound(&stream, static_cast<uLong>(image.mPixels.size())));
+  stream.next_out = reinterpret_cast<Bytef*>(ret.data());
+  stream.avail_out = static_cast<uInt>(ret.size());
+
+  const auto stride = image.GetStride();
+  std::vector<std::byte> row(stride);
+  for (uint32_t y = 0; y < image.mSize.mHeight; ++y) {
+    FilterRow(image.mPixels.data() + (y * stride), row.data(), stride);
+    stream.next_in = reinterpret_cast<Bytef*>(row.data());
+    stream.avail_in = static_cast<uInt>(stride);
+    const auto isLastRow = (y + 1 == image.mSize.mHeight);
+    const auto result = deflate(&stream, isLastRow ? Z_FINISH : Z_NO_FLUSH);
+    if (result == Z_STREAM_ERROR || stream.avail_in != 0) {
+      return {};
+    }
+    if (isLastRow && result != Z_STREAM_END) {
+      return {};
+    }
+  }
+
+  ret.resize(stream.total_out);
+  return ret;
+}
+
+bool Decompress(std::span<const std::byte> payload, DecodedImage& image) {
+  if (payload.size() > std::numeric_limits<uInt>::max()) {
+    return false;
+  }
+  image.mPixels.resize(image.GetStride() * image.mSize.mHeight);
+
+  z_stream stream {};
+  if (inflateInit(&stream) != Z_OK) {
+    return false;
+  }
+  const scope_guard end([&stream] { inflateEnd(&stream); });
+
+  stream.next_in
+    = reinterpret_cast<Bytef*>(const_cast<std::byte*>(payload.data()));
+  stream.avail_in = static_cast<uInt>(payload.size());
+  stream.next_out = reinterpret_cast<Bytef*>(image.mPixels.data());
+  stream.avail_out = static_cast<uInt>(image.mPixels.size());
+  if (inflate(&stream, Z_FINISH) != Z_STREAM_END) {
+    return false;
+  }
+  if (stream.avail_in != 0 || stream.avail_out != 0) {
+    return false;
+  }
+
+  const auto stride = image.GetStride();
+  for (uint32_t y = 0; y < image.mSize.mHeight; ++y) {
+    UnfilterRow(image.mPixels.data() + (y * stride), stride);
+  }
+  return true;
+}
+
+}// namespace
+
+PageImageCache::PageImageCache(
+  const std::filesystem::path& directory,
+  uint64_t maxBytes)
+  : mDirectory(directory),
+    mMaxBytes(maxBytes) {
+}
+
+std::filesystem::path PageImageCache::GetEntryPath(
+  const PageImageKey& key) const {
+  return mDirectory
+    / std::format("{:016x}.v{}{}", GetEntryHash(key), Version, EntryExtension);
+}
+
+std::vector<std::byte> PageImageCache::Serialize(
+  const PageImageKey& key,
+  const DecodedImage& image) {
+  if (
+    !IsValidSize(image.mSize)
+    || image.mPixels.size() != image.GetStride() * image.mSize.mHeight) {
+    return {};
+  }
+  const auto payload = Compress(image);
+  if (!payload) {
+    return {};
+  }
+
+  Writer w;
+  for (const auto c: Magic) {
+    w.U8(static_cast<uint8_t>(c));
+  }
+  w.U32(Version);
+  WriteKey(w, key);
+  w.U32(image.mSize.mWidth);
+  w.U32(image.mSize.mHeight);
+  w.U32(image.mNativeSize.mWidth);
+  w.U32(image.mNativeSize.mHeight);
+  w.U64(payload->size());
+  w.U64(HashFileContent(*payload));
+  w.String(ToUTF8(key.mPath));
+
+  auto ret = std::move(w.GetBuffer());
+  ret.insert(ret.end(), payload->begin(), payload->end());
+  return ret;
+}
+
+std::optional<DecodedImage> PageImageCache::Deserialize(
+  std::span<const std::byte> buffer,
+  const PageImageKey& key) {
+  if (buffer.size() < Magic.size()) {
+    return {};
+  }
+  if (std::memcmp(buffer.data(), Magic.data(), Magic.size()) != 0) {
+    return {};
+  }
+
+  Reader r(buffer.subspan(Magic.size()));
+  uint32_t version {};
+  uint64_t sourceSize {}, ticks {}, contentHash {}, page {};
+  ImageSize keySize;
+  DecodedImage ret;
+  uint64_t payloadSize {}, payloadHash {};
+  std::string path;
+  if (!(r.U32(version) && r.U64(sourceSize) && r.U64(ticks)
+        && r.U64(contentHash) && r.U64(page) && r.U32(keySize.mWidth)
+        && r.U32(keySize.mHeight) && r.U32(ret.mSize.mWidth)
+        && r.U32(ret.mSize.mHeight) && r.U32(ret.mNativeSize.mWidth)
+        && r.U32(ret.mNativeSize.mHeight) && r.U64(payloadSize)
+        && r.U64(payloadHash) && r.String(path))) {
+    return {};
+  }
+  if (version != Version) {
+    return {};
+  }
+  if (
+    sourceSize != key.mSource.mSize || ticks != GetTicks(key.mSource)
+    || contentHash != key.mSource.mContentHash || page != key.mPage
+    || keySize != key.mSize || path != ToUTF8(key.mPath)) {
+    return {};
+  }
+  if (!IsValidSize(ret.mSize)) {
+    return {};
+  }
+
+  const auto payload = buffer.subspan(Magic.size() + r.GetOffset());
+  if (
+    payload.size() != payloadSize || HashFileContent(payload) != payloadHash) {
+    return {};
+  }
+  if (!Decompress(payload, ret)) {
+    return {};
+  }
+  return ret;
+}
+
+std::optional<DecodedImage> PageImageCache::Load(
+  const PageImageKey& key) const {
+  const auto hash = GetEntryHash(key);
+  {
+    // List the directory now, so that `MayContain()` can answer for pages
+    // that were never cached
+    std::unique_lock lock(mIndexMutex);
+    if (!mTotalBytes) {
+      mTotalBytes = this->Prune();
+    }
+  }
+
+  // Always read, in case another process stored it since the listing
+  const auto path = this->GetEntryPath(key);
+  const auto snapshot = FileSnapshot::Read(path, {.mMaxAttempts = 1});
+  std::optional<DecodedImage> ret;
+  if (snapshot) {
+    ret = Deserialize(snapshot->GetBytes(), key);
+  }
+  if (ret) {
+    // Used by `Prune()` to keep the most recently used entries
+    std::error_code ec;
+    std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), ec);
+  }
+
+  std::unique_lock lock(mIndexMutex);
+  if (ret) {
+    mEntries.insert(hash);
+  } else {
+    mEntries.erase(hash);
+  }
+  return ret;
+}
+
+bool PageImageCache::MayContain(const PageImageKey& key) const {
+  const auto hash = GetEntryHash(key);
+  // Called from UI threads; don't wait for a listing
+  std::unique_lock lock(mIndexMutex, std::try_to_lock);
+  if (!(lock && mTotalBytes)) {
+    return true;
+  }
+  return mEntries.contains(hash);
+}
+
+bool PageImageCache::Store(
+  const PageImageKey& key,
+  const DecodedImage& image) const {
+  const auto bytes = Serialize(key, image);
+  if (bytes.empty()) {
+    return false;
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(mDirectory, ec);
+  if (ec) {
+    return false;
+  }
+
+  const auto path = this->GetEntryPath(key);
+  auto tempPath = path;
+  tempPath += std::format(
+    ".{:08x}{}", std::random_device {}(), TemporaryExtension);
+
+  {
+    std::ofstream f(tempPath, std::ios::binary | std::ios::trunc);
+    f.write(
+      reinterpret_cast<const char*>(bytes.data()),
+      static_cast<std::streamsize>(bytes.size()));
+    f.close();
+    if (!f) {
+      std::filesystem::remove(tempPath, ec);
+      return false;
+    }
+  }
+
+  // The content is a pure function of the key, so if another thread or
+  // process got there first, losing the race is fine
+  std::filesystem::rename(tempPath, path, ec);
+  if (ec) {
+    std::filesystem::remove(tempPath, ec);
+    return std::filesystem::exists(path, ec);
+  }
+
+  this->AddEntry(GetEntryHash(key), bytes.size());
+  return true;
+}
+
+void PageImageCache::StoreInBackground(PageImageKey key, DecodedImage image) {
+  std::unique_lock lock(mMutex);
+  const auto bytes = image.mPixels.size();
+  if (mQueuedBytes > 0 && mQueuedBytes + bytes > MaxQueuedBytes) {
+    return;
+  }
+  mQueuedBytes += bytes;
+  mQueue.emplace_back(std::move(key), std::move(image));
+  if (!mWriter.joinable()) {
+    mWriter = std::jthread(std::bind_front(&PageImageCache::Run, this));
+  }
+  mWake.notify_one();
+}
+
+void PageImageCache::WaitForIdle() {
+  std::unique_lock lock(mMutex);
+  mIdle.wait(lock, [this] { return mQueue.empty() && !mStoring; });
+}
+
+void PageImageCache::Run(std::stop_token stopToken) {
+  std::unique_lock lock(mMutex);
+  while (mWake.wait(lock, stopToken, [this] { return !mQueue.empty(); })) {
+    const auto [key, image] = std::move(mQueue.front());
+    mQueue.pop_front();
+    mStoring = true;
+
+    lock.unlock();
+    this->Store(key, image);
+    lock.lock();
+
+    mQueuedBytes -= image.mPixels.size();
+    mStoring = false;
+    mIdle.notify_all();
+  }
+}
+
+void PageImageCache::AddEntry(uint64_t entryHash, uint64_t entryBytes)
+  const {
+  std::unique_lock lock(mIndexMutex);
+  // Replacing an existing entry over-counts; that just means we list the
+  // directory a little sooner, which corrects the total
+  if (mTotalBytes && *mTotalBytes + entryBytes <= mMaxBytes) {
+    *mTotalBytes += entryBytes;
+    mEntries.insert(entryHash);
+    return;
+  }
+  mTotalBytes = this->Prune();
+}
+
+uint64_t PageImageCache::Prune() const {
+  struct Entry {
+    std::filesystem::file_time_type mLastWriteTime;
+    uint64_t mSize {};
+    std::filesystem::path mPath;
+  };
+
+  std::error_code ec;
+  const auto now = std::filesystem::file_time_type::clock::now();
+  mEntries.clear();
+  std::vector<Entry> entries;
+  uint64_t totalSize {0};
+  for (const auto& it: std::filesystem::directory_iterator(mDirectory, ec)) {
+    const auto extension = it.path().extension();
+    const auto lastWriteTime = it.last_write_time(ec);
+    if (ec) {
+      continue;
+    }
+    if (extension == TemporaryExtension) {
+      if (now - lastWriteTime > AbandonedTemporaryFileAge) {
+        std::filesystem::remove(it.path(), ec);
+      }
+      continue;
+    }
+    if (extension != EntryExtension) {
+      continue;
+    }
+    const auto size = it.file_size(ec);
+    if (ec) {
+      continue;
+    }
+    totalSize += size;
+    entries.push_back({lastWriteTime, size, it.path()});
+    if (const auto hash = ParseEntryHash(it.path())) {
+      mEntries.insert(*hash);
+    }
+  }
+  if (totalSize <= mMaxBytes) {
+    return totalSize;
+  }
+
+  std::ranges::sort(entries, std::greater {}, &Entry::mLastWriteTime);
+  uint64_t seenSize {0};
+  for (const auto& entry: entries) {
+    seenSize += entry.mSize;
+    if (seenSize > mMaxBytes) {
+      std::filesystem::remove(entry.mPath, ec);
+      if (!ec) {
+        totalSize -= entry.mSize;
+        if (const auto hash = ParseEntryHash(entry.mPath)) {
+          mEntries.erase(*hash);
+        }
+      }
+    }
+  }
+  return totalSize;
+}
+
+}// namespace OpenKneeboard
@@ -0,0 +1,430 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/FileSnapshot.h>
+#include <OpenKneeboard/PlainTextFileReader.h>
+
+#include <algorithm>
+#include <fstream>
+#include <span>
+#include <utility>
+
+#ifdef _WIN32
+#include <shims/winrt/base.h>
+
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace OpenKneeboard {
+
+namespace {
+
+constexpr size_t ChunkSize = 1024 * 1024;
+constexpr size_t HashBlockSize = 64 * 1024;
+
+constexpr std::string_view UTF8BOM {"\xef\xbb\xbf"};
+constexpr std::string_view UTF16LEBOM {"\xff\xfe"};
+constexpr std::string_view UTF16BEBOM {"\xfe\xff"};
+
+constexpr char32_t ReplacementCharacter = 0xfffd;
+
+void AppendUTF8(std::string& out, char32_t cp) {
+  if (cp < 0x80) {
+    out.push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out.push_back(static_cast<char>(0xc0 | (cp >> 6)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+  } else if (cp < 0x10000) {
+    out.push_back(static_cast<char>(0xe0 | (cp >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+  } else {
+    out.push_back(static_cast<char>(0xf0 | (cp >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+  }
+}
+
+uint64_t CombineHashes(uint64_t a, uint64_t b) {
+  const uint64_t both[] {a, b};
+  return HashFileContent(std::as_bytes(std::span {both}));
+}
+
+}// namespace
+
+PlainTextFileReader::PlainTextFileReader(const std::filesystem::path& path)
+  : mPath(path) {
+}
+
+PlainTextFileReader::~PlainTextFileReader() = default;
+
+void PlainTextFileReader::Reset() {
+  mOffset = 0;
+  mLastWriteTime = {};
+  mBlockCount = 0;
+  mFirstBlockHash = {};
+  mLastBlockHash = {};
+  mAllBlocksHash = {};
+  mPartialBlock.clear();
+  mEncoding = Encoding::Unknown;
+  mPendingBytes.clear();
+  mPendingSurrogate = {};
+  mPendingCR = false;
+}
+
+PlainTextFileReader::Change PlainTextFileReader::Poll() {
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(mPath, ec);
+  if (ec) {
+    return Change::Error;
+  }
+  const auto lastWriteTime = std::filesystem::last_write_time(mPath, ec);
+  if (ec) {
+    return Change::Error;
+  }
+  const auto fileID = GetFileID(mPath);
+  if (!fileID) {
+    return Change::Error;
+  }
+
+  // Replaced by another file, e.g. saved to a temporary file then renamed;
+  // the parts we'd sample might happen to match
+  if (mOffset > 0 && fileID != mFileID) {
+    this->Reset();
+    mFileID = fileID;
+    return Change::Replaced;
+  }
+  mFileID = fileID;
+
+  if (size < mOffset) {
+    this->Reset();
+    return Change::Replaced;
+  }
+  if (size == mOffset) {
+    // Nothing was appended, so it's either a repeated notification, or an
+    // in-place edit - possibly one that restored the write time. Samples
+    // can't tell those apart, so compare everything.
+    if (!this->IsConsumedDataIdentical()) {
+      this->Reset();
+      return Change::Replaced;
+    }
+    mLastWriteTime = lastWriteTime;
+    return Change::None;
+  }
+
+  // The file may have been rewritten in place as well as growing; only
+  // treat it as appended to if the samples of what we've read are intact
+  if (!this->IsConsumedDataUnchanged()) {
+    this->Reset();
+    return Change::Replaced;
+  }
+  mLastWriteTime = lastWriteTime;
+
+  return Change::Appended;
+}
+
+auto PlainTextFileReader::GetFileID(const std::filesystem::path& path)
+  -> std::optional<FileID> {
+#ifdef _WIN32
+  const winrt::file_handle file {CreateFileW(
+    path.c_str(),
+    FILE_READ_ATTRIBUTES,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+    nullptr,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL,
+    NULL)};
+  if (!file) {
+    return {};
+  }
+  BY_HANDLE_FILE_INFORMATION info {};
+  if (!GetFileInformationByHandle(file.get(), &info)) {
+    return {};
+  }
+  return FileID {
+    .mVolume = info.dwVolumeSerialNumber,
+    .mIndex = (static_cast<uint64_t>(info.nFileIndexHigh) << 32)
+      | info.nFileIndexLow,
+  };
+#else
+  struct stat info {};
+  if (::stat(path.c_str(), &info) != 0) {
+    return {};
+  }
+  return FileID {
+    .mVolume = static_cast<uint64_t>(info.st_dev),
+    .mIndex = static_cast<uint64_t>(info.st_ino),
+  };
+#endif
+}
+
+bool PlainTextFileReader::IsConsumedDataUnchanged() {
+  if (mOffset == 0) {
+    return true;
+  }
+  std::ifstream f(mPath, std::ios::in | std::ios::binary);
+  if (!f.is_open()) {
+    return false;
+  }
+
+  // At most three reads, however much has been read
+  const auto readAt = [&](uint64_t offset, size_t size) {
+    mReadBuffer.resize(size);
+    f.seekg(static_cast<std::streamoff>(offset));
+    return static_cast<bool>(f.read(mReadBuffer.data(), size));
+  };
+  const auto blockMatches = [&](uint64_t index, uint64_t expected) {
+    return readAt(index * HashBlockSize, HashBlockSize)
+      && HashFileContent(std::as_bytes(std::span {mReadBuffer})) == expected;
+  };
+
+  if (mBlockCount > 0 && !blockMatches(0, mFirstBlockHash)) {
+    return false;
+  }
+  if (mBlockCount > 1 && !blockMatches(mBlockCount - 1, mLastBlockHash)) {
+    return false;
+  }
+  return readAt(mBlockCount * HashBlockSize, mPartialBlock.size())
+    && mReadBuffer == mPartialBlock;
+}
+
+bool PlainTextFileReader::IsConsumedDataIdentical() {
+  if (mOffset == 0) {
+    return true;
+  }
+  std::ifstream f(mPath, std::ios::in | std::ios::binary);
+  if (!f.is_open()) {
+    return false;
+  }
+
+  // The same blocks as `HashConsumedBytes()`, so no decoding is needed
+  mReadBuffer.resize(HashBlockSize);
+  uint64_t allBlocksHash {};
+  for (uint64_t i = 0; i < mBlockCount; ++i) {
+    if (!f.read(mReadBuffer.data(), HashBlockSize)) {
+      return false;
+    }
+    allBlocksHash = CombineHashes(
+      allBlocksHash, HashFileContent(std::as_bytes(std::span {mReadBuffer})));
+  }
+  if (allBlocksHash != mAllBlocksHash) {
+    return false;
+  }
+  mReadBuffer.resize(mPartialBlock.size());
+  return f.read(mReadBuffer.data(), mReadBuffer.size())
+    && mReadBuffer == mPartialBlock;
+}
+
+void PlainTextFileReader::HashConsumedBytes(std::string_view bytes) {
+  while (!bytes.empty()) {
+    const auto count
+      = std::min(bytes.size(), HashBlockSize - mPartialBlock.size());
+    mPartialBlock.append(bytes.substr(0, count));
+    bytes.remove_prefix(count);
+    if (mPartialBlock.size() == HashBlockSize) {
+      mLastBlockHash
+        = HashFileContent(std::as_bytes(std::span {mPartialBlock}));
+      if (mBlockCount == 0) {
+        mFirstBlockHash = mLastBlockHash;
+      }
+      mAllBlocksHash = CombineHashes(mAllBlocksHash, mLastBlockHash);
+      ++mBlockCount;
+      mPartialBlock.clear();
+    }
+  }
+}
+
+bool PlainTextFileReader::Read(
+  const std::function<void(std::string_view)>& onText) {
+  std::ifstream f(mPath, std::ios::in | std::ios::binary);
+  if (!f.is_open()) {
+    return false;
+  }
+  f.seekg(static_cast<std::streamoff>(mOffset));
+  if (!f) {
+    return false;
+  }
+
+  mReadBuffer.resize(ChunkSize);
+  while (true) {
+    f.read(mReadBuffer.data(), mReadBuffer.size());
+    const auto byteCount = static_cast<size_t>(f.gcount());
+    if (byteCount == 0) {
+      break;
+    }
+
+    std::string_view chunk {mReadBuffer.data(), byteCount};
+    this->HashConsumedBytes(chunk);
+    mOffset += byteCount;
+
+    if (mEncoding == Encoding::Unknown) {
+      chunk.remove_prefix(this->DetectEncoding(chunk));
+    }
+
+    mOutputBuffer.clear();
+    this->Decode(chunk, mOutputBuffer);
+    if (!mOutputBuffer.empty()) {
+      onText(mOutputBuffer);
+    }
+  }
+  return true;
+}
+
+std::string PlainTextFileReader::Decode(std::string_view bytes) {
+  PlainTextFileReader decoder {{}};
+  bytes.remove_prefix(decoder.DetectEncoding(bytes));
+
+  std::string out;
+  out.reserve(bytes.size());
+  decoder.Decode(bytes, out);
+  decoder.Finish(out);
+  return out;
+}
+
+size_t PlainTextFileReader::DetectEncoding(std::string_view bytes) {
+  if (bytes.starts_with(UTF8BOM)) {
+    mEncoding = Encoding::UTF8;
+    return UTF8BOM.size();
+  }
+  if (bytes.starts_with(UTF16LEBOM)) {
+    mEncoding = Encoding::UTF16LE;
+    return UTF16LEBOM.size();
+  }
+  if (bytes.starts_with(UTF16BEBOM)) {
+    mEncoding = Encoding::UTF16BE;
+    return UTF16BEBOM.size();
+  }
+  mEncoding = Encoding::UTF8;
+  return 0;
+}
+
+void PlainTextFileReader::Decode(std::string_view bytes, std::string& out) {
+  if (mEncoding == Encoding::UTF8) {
+    this->NormalizeLineEndings(bytes, out);
+    return;
+  }
+  mDecodeBuffer.clear();
+  this->DecodeUTF16(bytes, mDecodeBuffer);
+  this->NormalizeLineEndings(mDecodeBuffer, out);
+}
+
+void PlainTextFileReader::DecodeUTF16(
+  std::string_view bytes,
+  std::string& out) {
+  const auto bigEndian = (mEncoding == Encoding::UTF16BE);
+  const auto decodeUnit = [&](char hi, char lo) {
+    const auto unit = static_cast<char16_t>(
+      (static_cast<uint8_t>(hi) << 8) | static_cast<uint8_t>(lo));
+    const auto isHigh = (unit >= 0xd800 && unit <= 0xdbff);
+    const auto isLow = (unit >= 0xdc00 && unit <= 0xdfff);
+
+    if (mPendingSurrogate) {
+      const auto high = std::exchange(mPendingSurrogate, char16_t {});
+      if (isLow) {
+        AppendUTF8(
+          out, 0x10000 + ((high - 0xd800) << 10) + (unit - 0xdc00));
+        return;
+      }
+      AppendUTF8(out, ReplacementCharacter);
+    }
+    if (isHigh) {
+      mPendingSurrogate = unit;
+      return;
+    }
+    AppendUTF8(out, isLow ? ReplacementCharacter : unit);
+  };
+  const auto decodePair = [&](char a, char b) {
+    if (bigEndian) {
+      decodeUnit(a, b);
+    } else {
+      decodeUnit(b, a);
+    }
+  };
+
+  if (!mPendingBytes.empty() && !bytes.empty()) {
+    decodePair(mPendingBytes.front(), bytes.front());
+    mPendingBytes.clear();
+    bytes.remove_prefix(1);
+  }
+
+  out.reserve(out.size() + bytes.size());
+  size_t i = 0;
+  for (; i + 1 < bytes.size(); i += 2) {
+    decodePair(bytes[i], bytes[i + 1]);
+  }
+  if (i < bytes.size()) {
+    mPendingBytes.push_back(bytes[i]);
+  }
+}
+
+void PlainTextFileReader::NormalizeLineEndings(
+  std::string_view text,
+  std::string& out) {
+  if (text.empty()) {
+    return;
+  }
+  if (mPendingCR) {
+    mPendingCR = false;
+    if (text.front() == '\n') {
+      out.push_back('\n');
+      text.remove_prefix(1);
+    } else {
+      out.push_back('\r');
+    }
+  }
+
+  // A single pass, appending runs between CRs
+  while (true) {
+    const auto cr = text.find('\r');
+    if (cr == text.npos) {
+      out.append(text);
+      return;
+    }
+    out.append(text.substr(0, cr));
+    if (cr + 1 == text.size()) {
+      // Might be followed by LF in the next chunk
+      mPendingCR = true;
+      return;
+    }
+    if (text[cr + 1] == '\n') {
+      out.push_back('\n');
+      text.remove_prefix(cr + 2);
+    } else {
+      out.push_back('\r');
+      text.remove_prefix(cr + 1);
+    }
+  }
+}
+
+void PlainTextFileReader::Finish(std::string& out) {
+  if (mPendingSurrogate || !mPendingBytes.empty()) {
+    AppendUTF8(out, ReplacementCharacter);
+  }
+  if (mPendingCR) {
+    out.push_back('\r');
+  }
+  mPendingSurrogate = {};
+  mPendingBytes.clear();
+  mPendingCR = false;
+}
+
+}// namespace OpenKneeboard
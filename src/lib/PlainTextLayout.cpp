@@ -0,0 +1,323 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/PlainTextLayout.h>
+#include <OpenKneeboard/UnicodeText.h>
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace OpenKneeboard {
+
+namespace {
+
+/// The size of a UTF-8 sequence at the end of `text` that needs more bytes
+size_t GetIncompleteUTF8Suffix(std::string_view text) noexcept {
+  for (size_t size = 1; size <= std::min<size_t>(3, text.size()); ++size) {
+    const auto byte = static_cast<uint8_t>(text[text.size() - size]);
+    if ((byte & 0xc0) == 0x80) {
+      // Continuation byte
+      continue;
+    }
+    size_t expected = 1;
+    if ((byte & 0xe0) == 0xc0) {
+      expected = 2;
+    } else if ((byte & 0xf0) == 0xe0) {
+      expected = 3;
+    } else if ((byte & 0xf8) == 0xf0) {
+      expected = 4;
+    }
+    return (expected > size) ? size : 0;
+  }
+  return 0;
+}
+
+}// namespace
+
+PlainTextLayout::PlainTextLayout(int columns, int rows)
+  : mColumns(columns), mRows(rows) {
+}
+
+void PlainTextLayout::Clear() {
+  mText.clear();
+  mLines.clear();
+  mPageStarts.clear();
+  mCurrentPageStart = 0;
+  mDiscardedPageCount = 0;
+  mDiscardedLineCount = 0;
+  mDiscardedTextBytes = 0;
+  mContentHash = 0;
+  mStreamLineIsOpen = false;
+  mPendingStreamBytes.clear();
+}
+
+size_t PlainTextLayout::GetCompletePageCount() const noexcept {
+  return mDiscardedPageCount + mPageStarts.size();
+}
+
+size_t PlainTextLayout::GetFirstResidentPage() const noexcept {
+  return mDiscardedPageCount;
+}
+
+std::span<const PlainTextLayout::Line> PlainTextLayout::GetPageLines(
+  size_t globalPageIndex) const {
+  if (globalPageIndex < mDiscardedPageCount) {
+    throw std::out_of_range("PlainTextLayout page has been discarded");
+  }
+  const auto pageIndex = globalPageIndex - mDiscardedPageCount;
+  if (pageIndex == mPageStarts.size()) {
+    return this->GetCurrentPageLines();
+  }
+  if (pageIndex > mPageStarts.size()) {
+    throw std::out_of_range("PlainTextLayout page index out of range");
+  }
+  const auto begin = mPageStarts.at(pageIndex);
+  const auto end = (pageIndex + 1 < mPageStarts.size())
+    ? mPageStarts.at(pageIndex + 1)
+    : mCurrentPageStart;
+  return std::span {mLines}.subspan(begin, end - begin);
+}
+
+std::span<const PlainTextLayout::Line> PlainTextLayout::GetCurrentPageLines()
+  const noexcept {
+  return std::span {mLines}.subspan(mCurrentPageStart);
+}
+
+std::string_view PlainTextLayout::GetText(const Line& line) const noexcept {
+  return std::string_view {mText}.substr(line.mOffset, line.mLength);
+}
+
+size_t PlainTextLayout::GetLineCount() const noexcept {
+  return mDiscardedLineCount + mLines.size();
+}
+
+FileIdentity PlainTextLayout::GetIdentity() const noexcept {
+  return {
+    .mSize = mDiscardedTextBytes + mText.size() + this->GetLineCount()
+      + this->GetCompletePageCount(),
+    .mContentHash = mContentHash,
+  };
+}
+
+size_t PlainTextLayout::CurrentPageSize() const noexcept {
+  return mLines.size() - mCurrentPageStart;
+}
+
+void PlainTextLayout::PushLine(Line line) {
+  mLines.push_back(line);
+}
+
+void PlainTextLayout::PushPage() {
+  mPageStarts.push_back(mCurrentPageStart);
+  mCurrentPageStart = mLines.size();
+  this->MixIntoHash(this->GetLineCount());
+}
+
+void PlainTextLayout::MixIntoHash(uint64_t value) noexcept {
+  constexpr uint64_t Prime = 0x100000001b3;
+  mContentHash = std::rotl((mContentHash ^ value) * Prime, 29);
+}
+
+void PlainTextLayout::DiscardCompletePages(size_t count) {
+  count = std::min(count, mPageStarts.size());
+  if (count == 0) {
+    return;
+  }
+
+  const auto firstLine
+    = (count < mPageStarts.size()) ? mPageStarts.at(count) : mCurrentPageStart;
+  // Line offsets never decrease, so everything before the first kept line's
+  // offset belongs to discarded pages
+  const auto firstByte
+    = (firstLine < mLines.size()) ? mLines.at(firstLine).mOffset : mText.size();
+
+  mText.erase(0, firstByte);
+  mLines.erase(mLines.begin(), mLines.begin() + firstLine);
+  for (auto& line: mLines) {
+    line.mOffset -= firstByte;
+  }
+  mPageStarts.erase(mPageStarts.begin(), mPageStarts.begin() + count);
+  for (auto& start: mPageStarts) {
+    start -= firstLine;
+  }
+  mCurrentPageStart -= firstLine;
+
+  mDiscardedPageCount += count;
+  mDiscardedLineCount += firstLine;
+  mDiscardedTextBytes += firstByte;
+}
+
+bool PlainTextLayout::EnsureNewPage() {
+  mStreamLineIsOpen = false;
+  if (this->CurrentPageSize() == 0) {
+    return false;
+  }
+  this->PushPage();
+  return true;
+}
+
+size_t PlainTextLayout::ExpandTabs(std::string_view text) {
+  // tabs are variable width, and everything else here
+  // assumes that all characters are the same width.
+  //
+  // Expand them while copying into the text buffer
+  const auto offset = mText.size();
+  while (true) {
+    const auto pos = text.find('\t');
+    mText.append(text.substr(0, pos));
+    if (pos == text.npos) {
+      break;
+    }
+    mText.append("    ");
+    text.remove_prefix(pos + 1);
+  }
+  return offset;
+}
+
+void PlainTextLayout::WrapLines(size_t offset) {
+  const auto columns = static_cast<size_t>(mColumns);
+  // mText isn't modified again until the next append, so these views stay
+  // valid
+  const auto toLine = [base = mText.data()](std::string_view text) {
+    return Line {static_cast<size_t>(text.data() - base), text.size()};
+  };
+
+  mWrappedLines.clear();
+  auto pending = std::string_view {mText}.substr(offset);
+  while (!pending.empty()) {
+    const auto newline = pending.find('\n');
+    auto remaining = pending.substr(0, newline);
+    pending = (newline == pending.npos) ? std::string_view {}
+                                        : pending.substr(newline + 1);
+
+    while (true) {
+      // Nothing is wider than its UTF-8 encoding
+      if (remaining.size() <= columns) {
+        mWrappedLines.push_back(toLine(remaining));
+        break;
+      }
+
+      const auto wrap = WrapLine(remaining, columns);
+      mWrappedLines.push_back(toLine(remaining.substr(0, wrap.mLength)));
+      remaining.remove_prefix(wrap.mNextLineOffset);
+      if (remaining.empty()) {
+        break;
+      }
+    }
+  }
+}
+
+size_t PlainTextLayout::Append(std::string_view message) {
+  if (mRows <= 1 || mColumns <= 1) {
+    return 0;
+  }
+  const auto rows = static_cast<size_t>(mRows);
+  mStreamLineIsOpen = false;
+
+  this->MixIntoHash(HashFileContent(std::as_bytes(std::span {message})));
+  const auto messageOffset = this->ExpandTabs(message);
+  this->WrapLines(messageOffset);
+
+  const auto pageCount = mPageStarts.size();
+  // Blank lines between messages point at the start of the message, so that
+  // offsets never decrease
+  const Line blank {messageOffset, 0};
+
+  if (mWrappedLines.size() >= rows) {
+    if (this->CurrentPageSize() > 0) {
+      this->PushLine(blank);
+    }
+
+    for (const auto& line: mWrappedLines) {
+      if (this->CurrentPageSize() >= rows) {
+        this->PushPage();
+      }
+      this->PushLine(line);
+    }
+    return mPageStarts.size() - pageCount;
+  }
+
+  // If we reach here, we can fit the full message on one page. Now figure
+  // out if we want a new page first.
+  if (this->CurrentPageSize() == 0) {
+    // do nothing
+  } else if (rows - this->CurrentPageSize() >= mWrappedLines.size() + 1) {
+    // Add a blank line first
+    this->PushLine(blank);
+  } else {
+    // We need a new page
+    this->PushPage();
+  }
+
+  mLines.insert(mLines.end(), mWrappedLines.begin(), mWrappedLines.end());
+  return mPageStarts.size() - pageCount;
+}
+
+size_t PlainTextLayout::AppendStream(std::string_view text) {
+  if (mRows <= 1 || mColumns <= 1 || text.empty()) {
+    return 0;
+  }
+  const auto rows = static_cast<size_t>(mRows);
+
+  this->MixIntoHash(HashFileContent(std::as_bytes(std::span {text})));
+
+  // A character split between calls would otherwise be wrapped as
+  // replacement characters; hold it back until the rest arrives
+  if (!mPendingStreamBytes.empty()) {
+    mPendingStreamBytes += text;
+    text = mPendingStreamBytes;
+  }
+  const auto incomplete = GetIncompleteUTF8Suffix(text);
+  std::string pending {text.substr(text.size() - incomplete)};
+  text.remove_suffix(incomplete);
+  if (text.empty()) {
+    mPendingStreamBytes = std::move(pending);
+    return 0;
+  }
+
+  // Wrapping is greedy, and each wrapped line only depends on the text from
+  // its own start up to the first grapheme cluster that doesn't fit, so if
+  // the last line is unterminated, only its final wrapped line can change.
+  // That line's text - and any hanging spaces - are at the end of `mText`,
+  // directly before the new text.
+  auto offset = mText.size();
+  if (mStreamLineIsOpen) {
+    offset = mLines.back().mOffset;
+    mLines.pop_back();
+  }
+  this->ExpandTabs(text);
+  this->WrapLines(offset);
+  mStreamLineIsOpen = !text.ends_with('\n');
+  // `text` may point into it
+  mPendingStreamBytes = std::move(pending);
+
+  // Equivalent to `Append()` on an empty page: no blank lines, just fill
+  // the pages
+  const auto pageCount = mPageStarts.size();
+  for (const auto& line: mWrappedLines) {
+    if (this->CurrentPageSize() >= rows) {
+      this->PushPage();
+    }
+    this->PushLine(line);
+  }
+  return mPageStarts.size() - pageCount;
+}
+
+}// namespace OpenKneeboard
@@ -0,0 +1,84 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/RasterCache.h>
+
+#include <algorithm>
+
+namespace OpenKneeboard {
+
+size_t RasterCache::GetByteBudgetForVideoMemory(uint64_t dedicatedVideoMemory) {
+  if (dedicatedVideoMemory == 0) {
+    return DefaultByteBudget;
+  }
+  constexpr uint64_t MiB = 1024 * 1024;
+  return static_cast<size_t>(
+    std::clamp<uint64_t>(dedicatedVideoMemory / 8, 128 * MiB, 1024 * MiB));
+}
+
+RasterCache::RasterCache(size_t defaultByteBudget)
+  : mDefaultByteBudget(defaultByteBudget), mCache(defaultByteBudget) {
+}
+
+RasterCache::~RasterCache() = default;
+
+size_t RasterCache::KeyHash::operator()(const Key& key) const noexcept {
+  // FNV-1a over the fields
+  uint64_t hash = 0xcbf29ce484222325;
+  const auto mix = [&hash](uint64_t value) {
+    hash ^= value;
+    hash *= 0x100000001b3;
+  };
+  mix(key.mSource);
+  mix(key.mContent);
+  mix((static_cast<uint64_t>(key.mWidth) << 32) | key.mHeight);
+  return static_cast<size_t>(hash);
+}
+
+winrt::com_ptr<ID2D1Bitmap1> RasterCache::GetOrRender(
+  const Key& key,
+  const Renderer& renderer) {
+  return mCache.GetOrCreate(key, [&]() {
+    // Always B8G8R8A8
+    const size_t cost = static_cast<size_t>(key.mWidth) * key.mHeight * 4;
+    return std::pair {renderer(), cost};
+  });
+}
+
+winrt::com_ptr<ID2D1Bitmap1> RasterCache::Get(const Key& key) {
+  return mCache.Get(key).value_or(nullptr);
+}
+
+void RasterCache::EraseSource(uint64_t source) {
+  mCache.EraseIf([source](const Key& key) { return key.mSource == source; });
+}
+
+size_t RasterCache::GetDefaultByteBudget() const noexcept {
+  return mDefaultByteBudget;
+}
+
+void RasterCache::SetByteBudget(size_t budget) {
+  mCache.SetBudget(budget);
+}
+
+RasterCache::Stats RasterCache::GetStats() const {
+  return mCache.GetStats();
+}
+
+}// namespace OpenKneeboard
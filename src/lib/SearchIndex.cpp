@@ -0,0 +1,630 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/SearchIndex.h>
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <span>
+#include <unordered_set>
+
+namespace OpenKneeboard {
+
+namespace {
+
+// Rough per-entry overheads, for the memory budget
+constexpr size_t TermOverheadBytes = 64;
+constexpr size_t BlockOverheadBytes = sizeof(SearchTextBlock);
+constexpr size_t PageOverheadBytes = sizeof(SearchPage);
+constexpr size_t DocumentTermOverheadBytes = 32;
+
+// Terms beyond this are ignored, so we can use a bitmask per block
+constexpr size_t MaxQueryTerms = 32;
+
+constexpr bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+constexpr bool IsWordByte(char c) {
+  const auto u = static_cast<unsigned char>(c);
+  // Treat all non-ASCII UTF-8 bytes as word characters; we don't have
+  // Unicode tables, but this keeps non-English words intact.
+  return u >= 0x80 || IsDigit(c) || (c >= 'a' && c <= 'z')
+    || (c >= 'A' && c <= 'Z');
+}
+
+constexpr char ToLowerASCII(char c) {
+  if (c >= 'A' && c <= 'Z') {
+    return static_cast<char>(c - 'A' + 'a');
+  }
+  return c;
+}
+
+constexpr bool IsUTF8Continuation(char c) {
+  return (static_cast<unsigned char>(c) & 0xc0) == 0x80;
+}
+
+std::string MakeSnippet(
+  std::string_view text,
+  std::string_view term,
+  size_t maxLength) {
+  if (text.size() <= maxLength) {
+    return std::string {text};
+  }
+
+  std::string lower {text};
+  std::ranges::transform(lower, lower.begin(), &ToLowerASCII);
+  const auto match = lower.find(term);
+
+  size_t begin = 0;
+  if (match != std::string::npos && match > maxLength / 4) {
+    begin = std::min(match - (maxLength / 4), text.size() - maxLength);
+  }
+  while (begin > 0 && IsUTF8Continuation(text[begin])) {
+    --begin;
+  }
+  auto end = std::min(text.size(), begin + maxLength);
+  while (end < text.size() && IsUTF8Continuation(text[end])) {
+    --end;
+  }
+
+  std::string ret;
+  if (begin > 0) {
+    ret += "...";
+  }
+  ret += text.substr(begin, end - begin);
+  if (end < text.size()) {
+    ret += "...";
+  }
+  return ret;
+}
+
+/// Calls `callback(const std::string&)` for each token, without allocating
+/// a new string per token
+template <class T>
+void ForEachToken(std::string_view text, T&& callback) {
+  std::string current;
+  for (size_t i = 0; i < text.size(); ++i) {
+    const auto c = text[i];
+    if (IsWordByte(c)) {
+      current.push_back(ToLowerASCII(c));
+      continue;
+    }
+    // Keep frequencies, distances etc together, e.g. "118.45" or "1,000"
+    if (
+      (c == '.' || c == ',') && !current.empty() && IsDigit(current.back())
+      && i + 1 < text.size() && IsDigit(text[i + 1])) {
+      current.push_back(c);
+      continue;
+    }
+    if (!current.empty()) {
+      callback(current);
+      current.clear();
+    }
+  }
+  if (!current.empty()) {
+    callback(current);
+  }
+}
+
+size_t EstimatePageBytes(const SearchPage& page) {
+  size_t bytes = PageOverheadBytes;
+  for (const auto& block: page.mBlocks) {
+    bytes += BlockOverheadBytes + block.mText.size();
+  }
+  return bytes;
+}
+
+}// namespace
+
+/** The slow part of indexing, so done outside of the lock.
+ *
+ * Terms get document-local IDs first, so that we only need to look up each
+ * distinct term in the main index once.
+ */
+struct SearchIndex::TokenizedPages {
+  std::unordered_map<std::string, uint32_t> mLocalIDs;
+  // Local term IDs in each block of each page
+  std::vector<std::vector<std::vector<uint32_t>>> mPageTerms;
+  size_t mPostingCount {};
+  // Text and structure, but not postings or terms
+  size_t mPageBytes {};
+
+  explicit TokenizedPages(std::span<const SearchPage> pages) {
+    mPageTerms.reserve(pages.size());
+    for (const auto& page: pages) {
+      mPageBytes += EstimatePageBytes(page);
+      auto& blockTerms = mPageTerms.emplace_back();
+      blockTerms.reserve(page.mBlocks.size());
+      for (const auto& block: page.mBlocks) {
+        auto& terms = blockTerms.emplace_back();
+        ForEachToken(block.mText, [&](const std::string& token) {
+          auto it = mLocalIDs.find(token);
+          if (it == mLocalIDs.end()) {
+            it = mLocalIDs
+                   .emplace(token, static_cast<uint32_t>(mLocalIDs.size()))
+                   .first;
+          }
+          terms.push_back(it->second);
+        });
+        std::ranges::sort(terms);
+        const auto [first, last] = std::ranges::unique(terms);
+        terms.erase(first, last);
+        mPostingCount += terms.size();
+      }
+    }
+  }
+};
+
+SearchIndex::SearchIndex() : SearchIndex(Options {}) {
+}
+
+SearchIndex::SearchIndex(const Options& options) : mOptions(options) {
+}
+
+SearchIndex::~SearchIndex() = default;
+
+std::vector<std::string> SearchIndex::Tokenize(std::string_view text) {
+  std::vector<std::string> tokens;
+  ForEachToken(text, [&tokens](const std::string& token) {
+    tokens.push_back(token);
+  });
+  return tokens;
+}
+
+bool SearchIndex::IsCurrent(
+  uint64_t documentKey,
+  const FileIdentity& identity) const {
+  std::unique_lock lock(mMutex);
+  const auto it = mSlots.find(documentKey);
+  if (it == mSlots.end()) {
+    return false;
+  }
+  return mDocuments.at(it->second).mIdentity.HasSameContent(identity);
+}
+
+std::optional<std::vector<uint64_t>> SearchIndex::GetPageKeys(
+  uint64_t documentKey) const {
+  std::unique_lock lock(mMutex);
+  const auto it = mSlots.find(documentKey);
+  if (it == mSlots.end()) {
+    return {};
+  }
+  const auto& doc = mDocuments.at(it->second);
+  std::vector<uint64_t> ret;
+  ret.reserve(doc.mPages.size());
+  for (const auto& page: doc.mPages) {
+    ret.push_back(page.mPageKey);
+  }
+  return ret;
+}
+
+void SearchIndex::Upsert(SearchDocument source) {
+  const TokenizedPages tokenized(source.mPages);
+
+  std::unique_lock lock(mMutex);
+  if (const auto it = mSlots.find(source.mDocumentKey); it != mSlots.end()) {
+    this->RemoveSlot(it->second);
+  }
+
+  uint32_t slot {};
+  if (mFreeSlots.empty()) {
+    slot = static_cast<uint32_t>(mDocuments.size());
+    mDocuments.emplace_back();
+  } else {
+    slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+  }
+  mSlots[source.mDocumentKey] = slot;
+
+  auto& doc = mDocuments.at(slot);
+  doc = {
+    .mKey = source.mDocumentKey,
+    .mIdentity = source.mIdentity,
+    .mPages = std::move(source.mPages),
+  };
+  this->AddPostings(slot, 0, tokenized);
+
+  doc.mEstimatedBytes = sizeof(Document) + tokenized.mPageBytes
+    + (tokenized.mPostingCount * sizeof(Posting))
+    + (doc.mTermPostings.size() * DocumentTermOverheadBytes);
+  mEstimatedBytes += doc.mEstimatedBytes;
+  mLRU.push_front(slot);
+  doc.mLRUPosition = mLRU.begin();
+
+  this->EvictIfNeeded();
+}
+
+bool SearchIndex::ReplacePages(
+  uint64_t documentKey,
+  const FileIdentity& identity,
+  size_t firstPage,
+  std::vector<SearchPage> pages) {
+  const TokenizedPages tokenized(pages);
+
+  std::unique_lock lock(mMutex);
+  const auto it = mSlots.find(documentKey);
+  if (it == mSlots.end()) {
+    return false;
+  }
+  const auto slot = it->second;
+  auto& doc = mDocuments.at(slot);
+  if (doc.mPages.size() < firstPage) {
+    return false;
+  }
+
+  auto bytes = doc.mEstimatedBytes
+    - (doc.mTermPostings.size() * DocumentTermOverheadBytes);
+  bytes -= this->RemovePostings(slot, static_cast<uint32_t>(firstPage))
+    * sizeof(Posting);
+  for (auto page = doc.mPages.begin() + firstPage; page != doc.mPages.end();
+       ++page) {
+    bytes -= EstimatePageBytes(*page);
+  }
+  doc.mPages.erase(doc.mPages.begin() + firstPage, doc.mPages.end());
+
+  this->AddPostings(slot, static_cast<uint32_t>(firstPage), tokenized);
+  doc.mPages.insert(
+    doc.mPages.end(),
+    std::make_move_iterator(pages.begin()),
+    std::make_move_iterator(pages.end()));
+  doc.mIdentity = identity;
+  bytes += tokenized.mPageBytes + (tokenized.mPostingCount * sizeof(Posting))
+    + (doc.mTermPostings.size() * DocumentTermOverheadBytes);
+
+  mEstimatedBytes = (mEstimatedBytes - doc.mEstimatedBytes) + bytes;
+  doc.mEstimatedBytes = bytes;
+  this->Touch(slot);
+
+  this->EvictIfNeeded();
+  return true;
+}
+
+void SearchIndex::AddPostings(
+  uint32_t slot,
+  uint32_t firstPage,
+  const TokenizedPages& tokenized) {
+  auto& doc = mDocuments.at(slot);
+
+  std::vector<TermID> termIDs(tokenized.mLocalIDs.size());
+  for (const auto& [text, localID]: tokenized.mLocalIDs) {
+    termIDs.at(localID) = this->GetOrCreateTerm(text);
+  }
+
+  std::vector<uint32_t> counts(termIDs.size());
+  const auto& pageTerms = tokenized.mPageTerms;
+  for (uint32_t pageIndex = 0; pageIndex < pageTerms.size(); ++pageIndex) {
+    const auto& blockTerms = pageTerms.at(pageIndex);
+    for (uint32_t blockIndex = 0; blockIndex < blockTerms.size();
+         ++blockIndex) {
+      for (const auto localID: blockTerms.at(blockIndex)) {
+        mPostings.at(termIDs.at(localID))
+          .push_back({slot, firstPage + pageIndex, blockIndex});
+        ++counts.at(localID);
+      }
+    }
+  }
+
+  for (uint32_t localID = 0; localID < termIDs.size(); ++localID) {
+    doc.mTermPostings[termIDs.at(localID)] += counts.at(localID);
+  }
+}
+
+size_t SearchIndex::RemovePostings(uint32_t slot, uint32_t firstPage) {
+  auto& doc = mDocuments.at(slot);
+
+  // Only the terms on the removed pages can be affected
+  std::unordered_set<TermID> terms;
+  for (auto page = doc.mPages.begin() + firstPage; page != doc.mPages.end();
+       ++page) {
+    for (const auto& block: page->mBlocks) {
+      ForEachToken(block.mText, [&](const std::string& token) {
+        terms.insert(mTermLookup.at(token));
+      });
+    }
+  }
+
+  size_t removed = 0;
+  for (const auto term: terms) {
+    auto& postings = mPostings.at(term);
+    // This document's postings are in page order, so the ones to remove are
+    // after its last posting for an earlier page. For a recently-updated
+    // document, that's usually near the end.
+    auto begin = postings.end();
+    while (begin != postings.begin()) {
+      const auto& posting = *(begin - 1);
+      if (posting.mDocument == slot && posting.mPage < firstPage) {
+        break;
+      }
+      --begin;
+    }
+    const auto end = std::remove_if(begin, postings.end(), [=](const auto& it) {
+      return it.mDocument == slot;
+    });
+    const auto count = static_cast<size_t>(postings.end() - end);
+    postings.erase(end, postings.end());
+    removed += count;
+
+    auto& docCount = doc.mTermPostings.at(term);
+    docCount -= static_cast<uint32_t>(count);
+    if (docCount == 0) {
+      doc.mTermPostings.erase(term);
+    }
+    if (postings.empty()) {
+      this->RemoveTerm(term);
+    }
+  }
+  return removed;
+}
+
+SearchIndex::TermID SearchIndex::GetOrCreateTerm(std::string_view text) {
+  if (const auto it = mTermLookup.find(text); it != mTermLookup.end()) {
+    return it->second;
+  }
+
+  TermID id {};
+  if (mFreeTermIDs.empty()) {
+    id = static_cast<TermID>(mPostings.size());
+    mPostings.emplace_back();
+    mTermText.emplace_back();
+  } else {
+    id = mFreeTermIDs.back();
+    mFreeTermIDs.pop_back();
+  }
+
+  const auto& key = mTerms.emplace(std::string {text}, id).first->first;
+  mTermLookup.emplace(key, id);
+  mTermText.at(id) = key;
+  mEstimatedBytes += TermOverheadBytes + key.size();
+  return id;
+}
+
+void SearchIndex::RemoveTerm(TermID id) {
+  const auto text = mTermText.at(id);
+  mEstimatedBytes -= TermOverheadBytes + text.size();
+  mTermLookup.erase(text);
+  mTermText.at(id) = {};
+  mPostings.at(id) = {};
+  mFreeTermIDs.push_back(id);
+  // Invalidates `text`
+  mTerms.erase(mTerms.find(text));
+}
+
+void SearchIndex::Remove(uint64_t documentKey) {
+  std::unique_lock lock(mMutex);
+  const auto it = mSlots.find(documentKey);
+  if (it != mSlots.end()) {
+    this->RemoveSlot(it->second);
+  }
+}
+
+void SearchIndex::RetainOnly(const std::vector<uint64_t>& documentKeys) {
+  const std::unordered_set<uint64_t> retain {
+    documentKeys.begin(), documentKeys.end()};
+  std::unique_lock lock(mMutex);
+  std::vector<uint32_t> remove;
+  for (const auto& [key, slot]: mSlots) {
+    if (!retain.contains(key)) {
+      remove.push_back(slot);
+    }
+  }
+  for (const auto slot: remove) {
+    this->RemoveSlot(slot);
+  }
+}
+
+void SearchIndex::RemoveSlot(uint32_t slot) {
+  auto& doc = mDocuments.at(slot);
+  for (const auto& [term, count]: doc.mTermPostings) {
+    auto& postings = mPostings.at(term);
+    std::erase_if(
+      postings, [slot](const auto& it) { return it.mDocument == slot; });
+    if (postings.empty()) {
+      this->RemoveTerm(term);
+    }
+  }
+  mLRU.erase(doc.mLRUPosition);
+  mEstimatedBytes -= doc.mEstimatedBytes;
+
+  mSlots.erase(doc.mKey);
+  doc = {};
+  mFreeSlots.push_back(slot);
+}
+
+void SearchIndex::EvictIfNeeded() {
+  // Always keep the most recently used document, even if it's over budget
+  // by itself
+  while (mEstimatedBytes > mOptions.mMemoryBudgetBytes && mLRU.size() > 1) {
+    this->RemoveSlot(mLRU.back());
+    ++mEvictionCount;
+  }
+}
+
+void SearchIndex::Touch(uint32_t slot) const {
+  const auto& doc = mDocuments.at(slot);
+  mLRU.splice(mLRU.begin(), mLRU, doc.mLRUPosition);
+}
+
+std::vector<SearchHit> SearchIndex::Query(
+  std::string_view query,
+  size_t maxResults) const {
+  auto terms = Tokenize(query);
+  if (terms.empty() || maxResults == 0) {
+    return {};
+  }
+  // The last term is a prefix, so it can't be deduplicated against the others
+  const auto prefix = terms.back();
+  terms.pop_back();
+  std::ranges::sort(terms);
+  const auto [first, last] = std::ranges::unique(terms);
+  terms.erase(first, last);
+  std::erase(terms, prefix);
+  if (terms.size() >= MaxQueryTerms) {
+    terms.resize(MaxQueryTerms - 1);
+  }
+  terms.push_back(prefix);
+
+  const auto fullMask
+    = (terms.size() == 32) ? ~uint32_t {0} : (uint32_t {1} << terms.size()) - 1;
+
+  std::unique_lock lock(mMutex);
+
+  // Which terms each page and block contains
+  struct PageMatch {
+    uint32_t mMask {};
+    std::unordered_map<uint32_t, uint32_t> mBlocks;
+  };
+  std::unordered_map<uint64_t, PageMatch> pages;
+  const auto pageID = [](const Posting& posting) {
+    return (static_cast<uint64_t>(posting.mDocument) << 32) | posting.mPage;
+  };
+
+  for (size_t i = 0; i < terms.size(); ++i) {
+    const auto& term = terms.at(i);
+    const auto bit = uint32_t {1} << i;
+    const auto isPrefix = (i + 1 == terms.size());
+
+    auto it = isPrefix ? mTerms.lower_bound(term) : mTerms.find(term);
+    bool anyMatches = false;
+    for (; it != mTerms.end(); ++it) {
+      if (isPrefix ? !it->first.starts_with(term) : it->first != term) {
+        break;
+      }
+      for (const auto& posting: mPostings.at(it->second)) {
+        // After the first term, only pages that are still candidates matter
+        auto pageIt = pages.find(pageID(posting));
+        if (pageIt == pages.end()) {
+          if (i > 0) {
+            continue;
+          }
+          pageIt = pages.emplace(pageID(posting), PageMatch {}).first;
+        }
+        pageIt->second.mMask |= bit;
+        pageIt->second.mBlocks[posting.mBlock] |= bit;
+        anyMatches = true;
+      }
+      if (!isPrefix) {
+        break;
+      }
+    }
+    if (!anyMatches) {
+      return {};
+    }
+    const auto required = (bit << 1) - 1;
+    std::erase_if(pages, [required](const auto& it) {
+      return (it.second.mMask & required) != required;
+    });
+  }
+
+  struct Candidate {
+    uint32_t mDocument;
+    uint32_t mPage;
+    size_t mScore;
+    std::vector<uint32_t> mBlocks {};
+  };
+  std::vector<Candidate> candidates;
+  candidates.reserve(pages.size());
+  for (const auto& [id, match]: pages) {
+    if (match.mMask != fullMask) {
+      continue;
+    }
+    int best = 0;
+    for (const auto& [block, mask]: match.mBlocks) {
+      best = std::max(best, std::popcount(mask));
+    }
+    Candidate candidate {
+      .mDocument = static_cast<uint32_t>(id >> 32),
+      .mPage = static_cast<uint32_t>(id & 0xffffffff),
+      .mScore = static_cast<size_t>(best),
+    };
+    for (const auto& [block, mask]: match.mBlocks) {
+      if (std::popcount(mask) == best) {
+        candidate.mBlocks.push_back(block);
+      }
+    }
+    std::ranges::sort(candidate.mBlocks);
+    candidates.push_back(std::move(candidate));
+  }
+
+  const auto order = [this](const Candidate& a, const Candidate& b) {
+    if (a.mScore != b.mScore) {
+      return a.mScore > b.mScore;
+    }
+    const auto aKey = mDocuments.at(a.mDocument).mKey;
+    const auto bKey = mDocuments.at(b.mDocument).mKey;
+    if (aKey != bKey) {
+      return aKey < bKey;
+    }
+    return a.mPage < b.mPage;
+  };
+  if (candidates.size() > maxResults) {
+    std::ranges::partial_sort(
+      candidates, candidates.begin() + maxResults, order);
+    candidates.resize(maxResults);
+  } else {
+    std::ranges::sort(candidates, order);
+  }
+
+  std::vector<SearchHit> hits;
+  hits.reserve(candidates.size());
+  std::unordered_set<uint32_t> touched;
+  for (const auto& candidate: candidates) {
+    const auto& doc = mDocuments.at(candidate.mDocument);
+    const auto& page = doc.mPages.at(candidate.mPage);
+    SearchHit hit {
+      .mDocumentKey = doc.mKey,
+      .mPageKey = page.mPageKey,
+      .mScore = candidate.mScore,
+    };
+    for (const auto block: candidate.mBlocks) {
+      hit.mRects.push_back(page.mBlocks.at(block).mRect);
+    }
+    hit.mSnippet = MakeSnippet(
+      page.mBlocks.at(candidate.mBlocks.front()).mText,
+      terms.front(),
+      mOptions.mMaxSnippetLength);
+    hits.push_back(std::move(hit));
+
+    if (touched.insert(candidate.mDocument).second) {
+      this->Touch(candidate.mDocument);
+    }
+  }
+  return hits;
+}
+
+SearchIndex::Stats SearchIndex::GetStats() const {
+  std::unique_lock lock(mMutex);
+  Stats stats {
+    .mTermCount = mTerms.size(),
+    .mEstimatedBytes = mEstimatedBytes,
+    .mEvictionCount = mEvictionCount,
+  };
+  for (const auto& [key, slot]: mSlots) {
+    const auto& doc = mDocuments.at(slot);
+    ++stats.mDocumentCount;
+    stats.mPageCount += doc.mPages.size();
+  }
+  for (const auto& postings: mPostings) {
+    stats.mPostingCount += postings.size();
+  }
+  return stats;
+}
+
+}// namespace OpenKneeboard
@@ -0,0 +1,255 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/FileSnapshot.h>
+#include <OpenKneeboard/TextPageLog.h>
+
+#include <limits>
+#include <stdexcept>
+
+namespace OpenKneeboard {
+
+namespace {
+
+void AppendU16(std::string& buffer, uint16_t value) {
+  buffer.push_back(static_cast<char>(value & 0xff));
+  buffer.push_back(static_cast<char>(value >> 8));
+}
+
+void AppendU32(std::string& buffer, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+void AppendU64(std::string& buffer, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+uint64_t ReadLE(std::string_view buffer, size_t offset, size_t byteCount) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < byteCount; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(buffer[offset + i]))
+      << (8 * i);
+  }
+  return value;
+}
+
+uint64_t HashPayload(std::string_view payload) {
+  return HashFileContent(std::as_bytes(std::span {payload}));
+}
+
+/// Returns the payload byte count, or 0 if the record header is invalid
+uint32_t ReadRecordHeader(std::fstream& stream, uint64_t& hash) {
+  using namespace TextPageLogFormat;
+  char header[RecordHeaderSize];
+  if (!stream.read(header, sizeof(header))) {
+    return 0;
+  }
+  const std::string_view view {header, sizeof(header)};
+  hash = ReadLE(view, sizeof(uint32_t), sizeof(uint64_t));
+  return static_cast<uint32_t>(ReadLE(view, 0, sizeof(uint32_t)));
+}
+
+}// namespace
+
+TextPageLog::TextPageLog(const std::filesystem::path& path) : mPath(path) {
+  std::error_code ec;
+  this->Open(!std::filesystem::exists(path, ec));
+}
+
+TextPageLog::~TextPageLog() = default;
+
+size_t TextPageLog::GetPageCount() const noexcept {
+  return mPageOffsets.size();
+}
+
+uint64_t TextPageLog::GetByteCount() const noexcept {
+  return mEndOffset;
+}
+
+uint64_t TextPageLog::GetDiscardedByteCount() const noexcept {
+  return mDiscardedByteCount;
+}
+
+void TextPageLog::Open(bool truncate) {
+  using namespace TextPageLogFormat;
+  mStream = {};
+  mPageOffsets.clear();
+  if (!truncate) {
+    mStream.open(mPath, std::ios::in | std::ios::out | std::ios::binary);
+    if (mStream) {
+      this->Recover();
+      return;
+    }
+  }
+
+  mStream.open(
+    mPath,
+    std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!mStream) {
+    throw std::runtime_error("Failed to open text page log");
+  }
+  mBuffer.clear();
+  mBuffer.append(Magic);
+  AppendU16(mBuffer, Version);
+  mStream.write(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+  mStream.flush();
+  if (!mStream) {
+    throw std::runtime_error("Failed to write text page log header");
+  }
+  mEndOffset = HeaderSize;
+}
+
+void TextPageLog::Recover() {
+  using namespace TextPageLogFormat;
+  std::error_code ec;
+  const auto fileSize = std::filesystem::file_size(mPath, ec);
+
+  char header[HeaderSize];
+  if (
+    ec || !mStream.read(header, sizeof(header))
+    || std::string_view {header, Magic.size()} != Magic
+    || ReadLE({header, sizeof(header)}, Magic.size(), sizeof(uint16_t))
+      != Version) {
+    mDiscardedByteCount = ec ? 0 : fileSize;
+    this->Open(/* truncate = */ true);
+    return;
+  }
+
+  uint64_t offset = HeaderSize;
+  std::string payload;
+  while (offset + RecordHeaderSize <= fileSize) {
+    uint64_t hash {};
+    const auto byteCount = ReadRecordHeader(mStream, hash);
+    if (
+      byteCount < sizeof(uint32_t)
+      || offset + RecordHeaderSize + byteCount > fileSize) {
+      break;
+    }
+    payload.resize(byteCount);
+    if (
+      !mStream.read(payload.data(), byteCount)
+      || HashPayload(payload) != hash) {
+      break;
+    }
+    mPageOffsets.push_back(offset);
+    offset += RecordHeaderSize + byteCount;
+  }
+  mEndOffset = offset;
+
+  if (offset == fileSize) {
+    mStream.clear();
+    return;
+  }
+
+  // Torn or corrupt tail; drop it so that new pages directly follow the
+  // last valid page
+  mDiscardedByteCount = fileSize - offset;
+  mStream.close();
+  std::filesystem::resize_file(mPath, offset, ec);
+  mStream.open(mPath, std::ios::in | std::ios::out | std::ios::binary);
+  if (ec || !mStream) {
+    throw std::runtime_error("Failed to truncate text page log");
+  }
+}
+
+void TextPageLog::Append(std::span<const std::string_view> lines) {
+  using namespace TextPageLogFormat;
+  constexpr auto MaxSize = std::numeric_limits<uint32_t>::max();
+
+  mBuffer.clear();
+  mBuffer.resize(RecordHeaderSize);
+  AppendU32(mBuffer, static_cast<uint32_t>(lines.size()));
+  for (const auto& line: lines) {
+    if (line.size() > MaxSize - mBuffer.size()) {
+      throw std::runtime_error("Text page is too large for the log");
+    }
+    AppendU32(mBuffer, static_cast<uint32_t>(line.size()));
+    mBuffer.append(line);
+  }
+
+  const std::string_view payload
+    = std::string_view {mBuffer}.substr(RecordHeaderSize);
+  std::string header;
+  AppendU32(header, static_cast<uint32_t>(payload.size()));
+  AppendU64(header, HashPayload(payload));
+  mBuffer.replace(0, RecordHeaderSize, header);
+
+  mStream.clear();
+  mStream.seekp(static_cast<std::streamoff>(mEndOffset));
+  mStream.write(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+  mStream.flush();
+  if (!mStream) {
+    // Anything partially written is overwritten by the next append, or
+    // truncated when the log is next opened
+    mStream.clear();
+    throw std::runtime_error("Failed to append to text page log");
+  }
+  mPageOffsets.push_back(mEndOffset);
+  mEndOffset += mBuffer.size();
+}
+
+std::vector<std::string> TextPageLog::Read(size_t pageIndex) {
+  using namespace TextPageLogFormat;
+  const auto offset = mPageOffsets.at(pageIndex);
+
+  mStream.clear();
+  mStream.seekg(static_cast<std::streamoff>(offset));
+  uint64_t hash {};
+  const auto byteCount = ReadRecordHeader(mStream, hash);
+  mBuffer.resize(byteCount);
+  if (
+    byteCount < sizeof(uint32_t) || !mStream.read(mBuffer.data(), byteCount)
+    || HashPayload(mBuffer) != hash) {
+    mStream.clear();
+    throw std::runtime_error("Failed to read text page log");
+  }
+
+  const std::string_view payload {mBuffer};
+  const auto lineCount = ReadLE(payload, 0, sizeof(uint32_t));
+  if (lineCount > payload.size() / sizeof(uint32_t)) {
+    throw std::runtime_error("Corrupt text page log record");
+  }
+  size_t position = sizeof(uint32_t);
+  std::vector<std::string> lines;
+  lines.reserve(lineCount);
+  for (uint64_t i = 0; i < lineCount; ++i) {
+    if (position + sizeof(uint32_t) > payload.size()) {
+      throw std::runtime_error("Corrupt text page log record");
+    }
+    const auto length = ReadLE(payload, position, sizeof(uint32_t));
+    position += sizeof(uint32_t);
+    if (length > payload.size() - position) {
+      throw std::runtime_error("Corrupt text page log record");
+    }
+    lines.emplace_back(payload.substr(position, length));
+    position += length;
+  }
+  return lines;
+}
+
+void TextPageLog::Clear() {
+  mDiscardedByteCount = 0;
+  this->Open(/* truncate = */ true);
+}
+
+}// namespace OpenKneeboard
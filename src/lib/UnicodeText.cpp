@@ -0,0 +1,706 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/UnicodeText.h>
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <optional>
+#include <utility>
+
+namespace OpenKneeboard {
+
+namespace {
+
+using LB = LineBreakClass;
+using GCB = GraphemeClusterBreak;
+
+constexpr char32_t ReplacementCharacter = 0xfffd;
+constexpr char32_t EmojiPresentationSelector = 0xfe0f;
+
+constexpr CodePointProperties UnpackProperties(uint32_t packed) noexcept {
+  // Bits 0-5: LineBreakClass; 6-9: GraphemeClusterBreak;
+  // 10-11: IndicConjunctBreak; 12-13: width; 14: Extended_Pictographic;
+  // 15: East Asian; 16: unassigned
+  return {
+    .mLineBreak = static_cast<LineBreakClass>(packed & 0x3f),
+    .mGraphemeClusterBreak
+    = static_cast<GraphemeClusterBreak>((packed >> 6) & 0xf),
+    .mIndicConjunctBreak
+    = static_cast<IndicConjunctBreak>((packed >> 10) & 0x3),
+    .mWidth = static_cast<uint8_t>((packed >> 12) & 0x3),
+    .mExtendedPictographic = static_cast<bool>(packed & (1 << 14)),
+    .mEastAsian = static_cast<bool>(packed & (1 << 15)),
+    .mUnassigned = static_cast<bool>(packed & (1 << 16)),
+  };
+}
+
+CodePointProperties LookupProperties(char32_t c) noexcept {
+  const auto ranges = UnicodeTextTables::GetRanges();
+  const auto it = std::upper_bound(
+    ranges.begin(), ranges.end(), c, [](char32_t c, const auto& range) {
+      return c < range.mFirst;
+    });
+  return UnpackProperties(std::prev(it)->mProperties);
+}
+
+using Latin1Properties = std::array<CodePointProperties, 0x100>;
+
+// Skips the binary search for the most common characters
+const Latin1Properties& GetLatin1Properties() noexcept {
+  static const auto sTable = [] {
+    Latin1Properties table;
+    for (char32_t c = 0; c < table.size(); ++c) {
+      table[c] = LookupProperties(c);
+    }
+    return table;
+  }();
+  return sTable;
+}
+
+// Variadic rather than a list so that it compiles down to a bit test
+template <auto First, decltype(First)... Rest>
+constexpr bool IsOneOf(decltype(First) value) noexcept {
+  return value == First || ((value == Rest) || ...);
+}
+
+constexpr LineBreakClass Resolve(LineBreakClass c) noexcept {
+  // LB1
+  switch (c) {
+    case LB::AI:
+    case LB::SA:
+    case LB::SG:
+    case LB::XX:
+      return LB::AL;
+    case LB::CJ:
+      return LB::NS;
+    default:
+      return c;
+  }
+}
+
+struct Cluster {
+  // The first code point
+  CodePointProperties mProperties;
+  LineBreaker::Break mBreakBefore {LineBreaker::Break::None};
+  size_t mWidth {};
+};
+
+/* Reads grapheme clusters, passing every code point to a `LineBreaker`.
+ *
+ * Only the break opportunity before each cluster is kept. Finding the end of
+ * a cluster means decoding the code point after it; that's kept for the
+ * start of the next cluster instead of being decoded and looked up again.
+ */
+class ClusterReader final {
+ public:
+  explicit ClusterReader(std::string_view text) noexcept
+    : mLatin1(GetLatin1Properties()), mText(text) {
+  }
+
+  bool AtEnd() const noexcept {
+    return mOffset == mText.size();
+  }
+
+  size_t GetOffset() const noexcept {
+    return mOffset;
+  }
+
+  Cluster Next() noexcept;
+
+ private:
+  struct CodePoint {
+    char32_t mValue {};
+    CodePointProperties mProperties;
+    size_t mEnd {};
+  };
+
+  const Latin1Properties& mLatin1;
+  std::string_view mText;
+  size_t mOffset {};
+  LineBreaker mLineBreaker;
+  std::optional<CodePoint> mLookahead;
+
+  CodePoint Decode(size_t offset) const noexcept {
+    const auto c = DecodeUTF8(mText, offset);
+    return {
+      c,
+      (c < mLatin1.size()) ? mLatin1[c] : GetCodePointProperties(c),
+      offset,
+    };
+  }
+};
+
+Cluster ClusterReader::Next() noexcept {
+  const auto isASCII
+    = [this](size_t i) { return static_cast<uint8_t>(mText[i]) < 0x80; };
+  // Fast path: ASCII, not followed by a combining mark or similar.
+  // ASCII can't extend a cluster, and CRLF doesn't happen within a line.
+  if (
+    !mLookahead && isASCII(mOffset)
+    && (mOffset + 1 == mText.size() || isASCII(mOffset + 1))) {
+    const auto& properties = mLatin1[static_cast<uint8_t>(mText[mOffset++])];
+    return {properties, mLineBreaker.Next(properties), properties.mWidth};
+  }
+
+  const auto first
+    = mLookahead ? *std::exchange(mLookahead, std::nullopt) : Decode(mOffset);
+  mOffset = first.mEnd;
+  const auto& properties = first.mProperties;
+  Cluster cluster {
+    properties, mLineBreaker.Next(properties), properties.mWidth};
+
+  GraphemeBreaker graphemes;
+  graphemes.Next(properties);
+  size_t regionalIndicators
+    = (properties.mGraphemeClusterBreak == GCB::RegionalIndicator) ? 1 : 0;
+  while (mOffset < mText.size()) {
+    const auto next = Decode(mOffset);
+    const auto& extension = next.mProperties;
+    if (graphemes.Next(extension)) {
+      mLookahead = next;
+      break;
+    }
+    mOffset = next.mEnd;
+    mLineBreaker.Next(extension);
+
+    cluster.mWidth = std::max<size_t>(cluster.mWidth, extension.mWidth);
+    if (next.mValue == EmojiPresentationSelector) {
+      cluster.mWidth = 2;
+    }
+    if (extension.mGraphemeClusterBreak == GCB::RegionalIndicator) {
+      ++regionalIndicators;
+    }
+  }
+  // Flags
+  if (regionalIndicators == 2) {
+    cluster.mWidth = 2;
+  }
+  return cluster;
+}
+
+}// namespace
+
+CodePointProperties GetCodePointProperties(char32_t c) noexcept {
+  if (c < 0x100) {
+    return GetLatin1Properties()[c];
+  }
+  if (c > 0x10ffff) {
+    c = ReplacementCharacter;
+  }
+  return LookupProperties(c);
+}
+
+char32_t DecodeUTF8(std::string_view text, size_t& offset) noexcept {
+  const auto byte = [&](size_t i) { return static_cast<uint8_t>(text[i]); };
+  const auto lead = byte(offset);
+  if (lead < 0x80) {
+    ++offset;
+    return lead;
+  }
+
+  size_t length {};
+  char32_t c {};
+  char32_t minimum {};
+  if ((lead & 0xe0) == 0xc0) {
+    length = 2;
+    c = lead & 0x1f;
+    minimum = 0x80;
+  } else if ((lead & 0xf0) == 0xe0) {
+    length = 3;
+    c = lead & 0x0f;
+    minimum = 0x800;
+  } else if ((lead & 0xf8) == 0xf0) {
+    length = 4;
+    c = lead & 0x07;
+    minimum = 0x10000;
+  } else {
+    ++offset;
+    return ReplacementCharacter;
+  }
+
+  if (text.size() - offset < length) {
+    ++offset;
+    return ReplacementCharacter;
+  }
+  for (size_t i = 1; i < length; ++i) {
+    const auto continuation = byte(offset + i);
+    if ((continuation & 0xc0) != 0x80) {
+      ++offset;
+      return ReplacementCharacter;
+    }
+    c = (c << 6) | (continuation & 0x3f);
+  }
+  if (c < minimum || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff)) {
+    ++offset;
+    return ReplacementCharacter;
+  }
+  offset += length;
+  return c;
+}
+
+bool GraphemeBreaker::Next(const CodePointProperties& properties) noexcept {
+  const auto current = properties.mGraphemeClusterBreak;
+  const auto previous = std::exchange(mPrevious, current);
+  const auto isBoundary = [&, this] {
+    // GB1
+    if (std::exchange(mAtStart, false)) {
+      return true;
+    }
+    // GB3
+    if (previous == GCB::CR && current == GCB::LF) {
+      return false;
+    }
+    // GB4, GB5
+    if (
+      IsOneOf<GCB::Control, GCB::CR, GCB::LF>(previous)
+      || IsOneOf<GCB::Control, GCB::CR, GCB::LF>(current)) {
+      return true;
+    }
+    // GB6, GB7, GB8: Hangul syllables
+    if (
+      previous == GCB::L
+      && IsOneOf<GCB::L, GCB::V, GCB::LV, GCB::LVT>(current)) {
+      return false;
+    }
+    if (
+      IsOneOf<GCB::LV, GCB::V>(previous)
+      && IsOneOf<GCB::V, GCB::T>(current)) {
+      return false;
+    }
+    if (IsOneOf<GCB::LVT, GCB::T>(previous) && current == GCB::T) {
+      return false;
+    }
+    // GB9, GB9a, GB9b
+    if (
+      IsOneOf<GCB::Extend, GCB::ZWJ, GCB::SpacingMark>(current)
+      || previous == GCB::Prepend) {
+      return false;
+    }
+    // GB9c
+    if (
+      mConjunctHasLinker
+      && properties.mIndicConjunctBreak == IndicConjunctBreak::Consonant) {
+      return false;
+    }
+    // GB11
+    if (mAfterPictographicZWJ && properties.mExtendedPictographic) {
+      return false;
+    }
+    // GB12, GB13
+    if (
+      current == GCB::RegionalIndicator && (mRegionalIndicators % 2) == 1) {
+      return false;
+    }
+    // GB999
+    return true;
+  }();
+
+  mRegionalIndicators
+    = (current == GCB::RegionalIndicator) ? mRegionalIndicators + 1 : 0;
+
+  mAfterPictographicZWJ = mInPictographicSequence && current == GCB::ZWJ;
+  mInPictographicSequence = properties.mExtendedPictographic
+    || (mInPictographicSequence && current == GCB::Extend);
+
+  switch (properties.mIndicConjunctBreak) {
+    case IndicConjunctBreak::Consonant:
+      mInConjunct = true;
+      mConjunctHasLinker = false;
+      break;
+    case IndicConjunctBreak::Linker:
+      mConjunctHasLinker = mInConjunct;
+      break;
+    case IndicConjunctBreak::Extend:
+      break;
+    case IndicConjunctBreak::None:
+      mInConjunct = false;
+      mConjunctHasLinker = false;
+      break;
+  }
+
+  return isBoundary;
+}
+
+LineBreaker::Break LineBreaker::Next(
+  const CodePointProperties& properties) noexcept {
+  auto current = Resolve(properties.mLineBreak);
+  const auto isZWJ = (current == LB::ZWJ);
+
+  // LB9: X (CM | ZWJ)* is treated as X
+  if (
+    !mAtStart && (current == LB::CM || isZWJ)
+    && !IsOneOf<LB::BK, LB::CR, LB::LF, LB::NL, LB::SP, LB::ZW>(mPrevious)) {
+    mPreviousIsZWJ = isZWJ;
+    return Break::None;
+  }
+  // LB10
+  if (current == LB::CM || isZWJ) {
+    current = LB::AL;
+  }
+
+  const auto previous = mPrevious;
+  const auto beforeSpaces = (previous == LB::SP) ? mBeforeSpaces : previous;
+  const auto result = [&, this] {
+    // LB2
+    if (mAtStart) {
+      return Break::None;
+    }
+    // LB4, LB5
+    if (IsOneOf<LB::BK, LB::LF, LB::NL>(previous)) {
+      return Break::Mandatory;
+    }
+    if (previous == LB::CR) {
+      return (current == LB::LF) ? Break::None : Break::Mandatory;
+    }
+    // LB6, LB7
+    if (IsOneOf<LB::BK, LB::CR, LB::LF, LB::NL, LB::SP, LB::ZW>(current)) {
+      return Break::None;
+    }
+    // LB8
+    if (beforeSpaces == LB::ZW) {
+      return Break::Allowed;
+    }
+    // LB8a
+    if (mPreviousIsZWJ) {
+      return Break::None;
+    }
+    // LB11, LB12, LB12a
+    if (current == LB::WJ || previous == LB::WJ || previous == LB::GL) {
+      return Break::None;
+    }
+    if (
+      current == LB::GL && !IsOneOf<LB::SP, LB::BA, LB::HY>(previous)) {
+      return Break::None;
+    }
+    // LB13
+    if (IsOneOf<LB::CL, LB::CP, LB::EX, LB::IS, LB::SY>(current)) {
+      return Break::None;
+    }
+    // LB14, LB15, LB16, LB17
+    if (beforeSpaces == LB::OP) {
+      return Break::None;
+    }
+    if (beforeSpaces == LB::QU && current == LB::OP) {
+      return Break::None;
+    }
+    if (IsOneOf<LB::CL, LB::CP>(beforeSpaces) && current == LB::NS) {
+      return Break::None;
+    }
+    if (beforeSpaces == LB::B2 && current == LB::B2) {
+      return Break::None;
+    }
+    // LB18
+    if (previous == LB::SP) {
+      return Break::Allowed;
+    }
+    // LB19
+    if (current == LB::QU || previous == LB::QU) {
+      return Break::None;
+    }
+    // LB20
+    if (current == LB::CB || previous == LB::CB) {
+      return Break::Allowed;
+    }
+    // LB21, LB21a, LB21b, LB22
+    if (
+      IsOneOf<LB::BA, LB::HY, LB::NS, LB::IN>(current)
+      || previous == LB::BB || mAfterHebrewHyphen
+      || (previous == LB::SY && current == LB::HL)) {
+      return Break::None;
+    }
+
+    const auto isAlphabetic = [](LineBreakClass c) {
+      return c == LB::AL || c == LB::HL;
+    };
+    const auto isIdeographic = [](LineBreakClass c) {
+      return IsOneOf<LB::ID, LB::EB, LB::EM>(c);
+    };
+    const auto isHangul = [](LineBreakClass c) {
+      return IsOneOf<LB::JL, LB::JV, LB::JT, LB::H2, LB::H3>(c);
+    };
+    // LB23
+    if (
+      (isAlphabetic(previous) && current == LB::NU)
+      || (previous == LB::NU && isAlphabetic(current))) {
+      return Break::None;
+    }
+    // LB23a
+    if (
+      (previous == LB::PR && isIdeographic(current))
+      || (isIdeographic(previous) && current == LB::PO)) {
+      return Break::None;
+    }
+    // LB24
+    if (
+      (IsOneOf<LB::PR, LB::PO>(previous) && isAlphabetic(current))
+      || (isAlphabetic(previous) && IsOneOf<LB::PR, LB::PO>(current))) {
+      return Break::None;
+    }
+    // LB25
+    if (
+      (IsOneOf<LB::CL, LB::CP, LB::NU>(previous)
+       && IsOneOf<LB::PO, LB::PR>(current))
+      || (IsOneOf<LB::PO, LB::PR>(previous)
+          && IsOneOf<LB::OP, LB::NU>(current))
+      || (IsOneOf<LB::HY, LB::IS, LB::NU, LB::SY>(previous)
+          && current == LB::NU)) {
+      return Break::None;
+    }
+    // LB26
+    if (
+      (previous == LB::JL
+       && IsOneOf<LB::JL, LB::JV, LB::H2, LB::H3>(current))
+      || (IsOneOf<LB::JV, LB::H2>(previous)
+          && IsOneOf<LB::JV, LB::JT>(current))
+      || (IsOneOf<LB::JT, LB::H3>(previous) && current == LB::JT)) {
+      return Break::None;
+    }
+    // LB27
+    if (
+      (isHangul(previous) && current == LB::PO)
+      || (previous == LB::PR && isHangul(current))) {
+      return Break::None;
+    }
+    // LB28, LB29
+    if (
+      (isAlphabetic(previous) || previous == LB::IS)
+      && isAlphabetic(current)) {
+      return Break::None;
+    }
+    // LB30
+    if (
+      (isAlphabetic(previous) || previous == LB::NU) && current == LB::OP
+      && !properties.mEastAsian) {
+      return Break::None;
+    }
+    if (
+      previous == LB::CP && !mPreviousIsEastAsian
+      && (isAlphabetic(current) || current == LB::NU)) {
+      return Break::None;
+    }
+    // LB30a
+    if (
+      previous == LB::RI && current == LB::RI
+      && (mRegionalIndicators % 2) == 1) {
+      return Break::None;
+    }
+    // LB30b
+    if (
+      current == LB::EM
+      && (previous == LB::EB || mPreviousIsUnassignedPictographic)) {
+      return Break::None;
+    }
+    // LB31
+    return Break::Allowed;
+  }();
+
+  if (current == LB::SP && previous != LB::SP) {
+    mBeforeSpaces = mAtStart ? LB::XX : previous;
+  }
+  mAtStart = false;
+  mAfterHebrewHyphen
+    = (previous == LB::HL) && IsOneOf<LB::HY, LB::BA>(current);
+  mRegionalIndicators
+    = (current == LB::RI) ? mRegionalIndicators + 1 : 0;
+  mPreviousIsEastAsian = properties.mEastAsian;
+  mPreviousIsUnassignedPictographic
+    = properties.mExtendedPictographic && properties.mUnassigned;
+  mPreviousIsZWJ = isZWJ;
+  mPrevious = current;
+  return result;
+}
+
+namespace {
+
+constexpr bool IsPrintableASCII(char c) noexcept {
+  return c >= 0x20 && c <= 0x7e;
+}
+
+/* Break opportunities between printable ASCII characters.
+ *
+ * For these, UAX #14 only depends on the current character, the previous
+ * character, and the last character before any spaces, so we can look up
+ * `LineBreaker`'s results instead of running the rules for every byte.
+ *
+ * Indexed by [last character before any spaces][previous is a space][current
+ * character], with characters offset by 0x20; `StartOfText` is used if
+ * there are only spaces before the current character.
+ */
+class ASCIILineBreaks final {
+ public:
+  static constexpr size_t CharacterCount = 0x7f - 0x20;
+  static constexpr uint8_t StartOfText = CharacterCount;
+
+  ASCIILineBreaks() noexcept {
+    const auto properties = [](size_t index) {
+      return GetCodePointProperties(static_cast<char32_t>(index + 0x20));
+    };
+    for (size_t context = 0; context <= CharacterCount; ++context) {
+      for (const auto afterSpace: {false, true}) {
+        for (size_t current = 0; current < CharacterCount; ++current) {
+          LineBreaker lineBreaker;
+          if (context != StartOfText) {
+            lineBreaker.Next(properties(context));
+          }
+          if (afterSpace) {
+            lineBreaker.Next(properties(' ' - 0x20));
+          }
+          mBreaks[context][afterSpace][current]
+            = lineBreaker.Next(properties(current))
+            != LineBreaker::Break::None;
+        }
+      }
+    }
+  }
+
+  bool CanBreakBefore(uint8_t context, bool afterSpace, char current)
+    const noexcept {
+    return mBreaks[context][afterSpace][current - 0x20];
+  }
+
+ private:
+  std::array<std::array<std::array<bool, CharacterCount>, 2>,
+             CharacterCount + 1>
+    mBreaks {};
+};
+
+/* `WrapLine()` for printable ASCII.
+ *
+ * Returns nothing if it reaches anything else before it has found the end of
+ * the line; every printable ASCII character is a single-column grapheme
+ * cluster, unless it's followed by a combining mark or similar.
+ */
+std::optional<LineWrap> WrapASCIILine(
+  std::string_view text,
+  size_t columns) noexcept {
+  static const ASCIILineBreaks sBreaks;
+
+  size_t width {};
+  size_t contentEnd {};
+  bool hasContent {false};
+  std::optional<LineWrap> lastBreak;
+  uint8_t context {ASCIILineBreaks::StartOfText};
+  bool afterSpace {false};
+
+  for (size_t offset = 0; offset < text.size(); ++offset) {
+    const auto c = text[offset];
+    if (
+      !IsPrintableASCII(c)
+      || (offset + 1 < text.size()
+          && static_cast<uint8_t>(text[offset + 1]) >= 0x80)) {
+      return std::nullopt;
+    }
+    const auto isSpace = (c == ' ');
+
+    if (
+      hasContent && offset > 0
+      && sBreaks.CanBreakBefore(context, afterSpace, c)) {
+      lastBreak = LineWrap {contentEnd, offset};
+    }
+    afterSpace = isSpace;
+    if (!isSpace) {
+      context = static_cast<uint8_t>(c - 0x20);
+    }
+
+    if (hasContent && isSpace) {
+      ++width;
+      continue;
+    }
+    if (offset > 0 && width + 1 > columns) {
+      if (lastBreak) {
+        return lastBreak;
+      }
+      return LineWrap {hasContent ? contentEnd : offset, offset};
+    }
+    ++width;
+    contentEnd = offset + 1;
+    hasContent = hasContent || !isSpace;
+  }
+
+  if (width > columns) {
+    return LineWrap {contentEnd, text.size()};
+  }
+  return LineWrap {text.size(), text.size()};
+}
+
+}// namespace
+
+LineWrap WrapLine(std::string_view text, size_t columns) noexcept {
+  if (const auto wrap = WrapASCIILine(text, columns)) {
+    return *wrap;
+  }
+
+  ClusterReader clusters {text};
+
+  // Includes hanging spaces
+  size_t width {};
+  // End of the last cluster that isn't a hanging space
+  size_t contentEnd {};
+  bool hasContent {false};
+  bool haveBreak {false};
+  LineWrap lastBreak;
+
+  while (!clusters.AtEnd()) {
+    const auto start = clusters.GetOffset();
+    const auto cluster = clusters.Next();
+    const auto offset = clusters.GetOffset();
+    // U+0020 is the only SP; with a combining mark it's treated as AL (LB10)
+    const auto isSpace = (cluster.mProperties.mLineBreak == LB::SP)
+      && (offset - start == 1);
+
+    // Breaking before leading spaces would give an empty line
+    if (hasContent && cluster.mBreakBefore != LineBreaker::Break::None) {
+      haveBreak = true;
+      lastBreak = {contentEnd, start};
+    }
+    if (hasContent && isSpace) {
+      width += cluster.mWidth;
+      continue;
+    }
+    if (start > 0 && width + cluster.mWidth > columns) {
+      if (haveBreak) {
+        return lastBreak;
+      }
+      // No break opportunity that fits; break before this cluster
+      return {hasContent ? contentEnd : start, start};
+    }
+    width += cluster.mWidth;
+    contentEnd = offset;
+    hasContent = hasContent || !isSpace;
+  }
+
+  if (width > columns) {
+    // Only trailing spaces are past the margin
+    return {contentEnd, text.size()};
+  }
+  return {text.size(), text.size()};
+}
+
+size_t GetDisplayWidth(std::string_view text) noexcept {
+  ClusterReader clusters {text};
+  size_t width {};
+  while (!clusters.AtEnd()) {
+    width += clusters.Next().mWidth;
+  }
+  return width;
+}
+
+}// namespace OpenKneeboard
@@ -0,0 +1,1029 @@
+// Generated by generate-unicode-tables.py; do not edit.
+//
+// Sources:
+// LineBreak.txt: Unicode 15.0.0 data, exported from ICU 72.1
+// EastAsianWidth.txt: Unicode 15.0.0 data, exported from ICU 72.1
+// DerivedGeneralCategory.txt: Unicode 15.0.0 data, exported from ICU 72.1
+// GraphemeBreakProperty.txt: Unicode 15.0.0 data, exported from ICU 72.1
+// emoji-data.txt: Unicode 15.0.0 data, exported from ICU 72.1
+// DerivedCoreProperties.txt: Unicode 15.0.0 data, exported from ICU 72.1
+
+// clang-format off
+#include <OpenKneeboard/UnicodeText.h>
+
+namespace OpenKneeboard::UnicodeTextTables {
+
+namespace {
+
+// Packed properties, starting at each code point; see
+// `UnpackProperties()` in UnicodeText.cpp for the layout.
+constexpr UnicodeTextRange Ranges[3997] = {
+  {0x00000, 0x010c3}, {0x00009, 0x010cc}, {0x0000a, 0x01082}, {0x0000b, 0x010c0},
+  {0x0000d, 0x01041}, {0x0000e, 0x010c3}, {0x00020, 0x01009}, {0x00021, 0x01012},
+  {0x00022, 0x01016}, {0x00023, 0x0101d}, {0x00024, 0x0101a}, {0x00025, 0x01019},
+  {0x00026, 0x0101d}, {0x00027, 0x01016}, {0x00028, 0x01015}, {0x00029, 0x01011},
+  {0x0002a, 0x0101d}, {0x0002b, 0x0101a}, {0x0002c, 0x01017}, {0x0002d, 0x0100e},
+  {0x0002e, 0x01017}, {0x0002f, 0x0101b}, {0x00030, 0x01018}, {0x0003a, 0x01017},
+  {0x0003c, 0x0101d}, {0x0003f, 0x01012}, {0x00040, 0x0101d}, {0x0005b, 0x01015},
+  {0x0005c, 0x0101a}, {0x0005d, 0x01011}, {0x0005e, 0x0101d}, {0x0007b, 0x01015},
+  {0x0007c, 0x0100c}, {0x0007d, 0x01010}, {0x0007e, 0x0101d}, {0x0007f, 0x010c3},
+  {0x00085, 0x010c4}, {0x00086, 0x010c3}, {0x000a0, 0x01008}, {0x000a1, 0x01015},
+  {0x000a2, 0x01019}, {0x000a3, 0x0101a}, {0x000a6, 0x0101d}, {0x000a7, 0x0101c},
+  {0x000a9, 0x0501d}, {0x000aa, 0x0101c}, {0x000ab, 0x01016}, {0x000ac, 0x0101d},
+  {0x000ad, 0x000cc}, {0x000ae, 0x0501d}, {0x000af, 0x0101d}, {0x000b0, 0x01019},
+  {0x000b1, 0x0101a}, {0x000b2, 0x0101c}, {0x000b4, 0x0100d}, {0x000b5, 0x0101d},
+  {0x000b6, 0x0101c}, {0x000bb, 0x01016}, {0x000bc, 0x0101c}, {0x000bf, 0x01015},
+  {0x000c0, 0x0101d}, {0x000d7, 0x0101c}, {0x000d8, 0x0101d}, {0x000f7, 0x0101c},
+  {0x000f8, 0x0101d}, {0x002c7, 0x0101c}, {0x002c8, 0x0100d}, {0x002c9, 0x0101c},
+  {0x002cc, 0x0100d}, {0x002cd, 0x0101c}, {0x002ce, 0x0101d}, {0x002d0, 0x0101c},
+  {0x002d1, 0x0101d}, {0x002d8, 0x0101c}, {0x002dc, 0x0101d}, {0x002dd, 0x0101c},
+  {0x002de, 0x0101d}, {0x002df, 0x0100d}, {0x002e0, 0x0101d}, {0x00300, 0x00103},
+  {0x0034f, 0x00108}, {0x00350, 0x00103}, {0x0035c, 0x00108}, {0x00363, 0x00103},
+  {0x00370, 0x0101d}, {0x00378, 0x1102a}, {0x0037a, 0x0101d}, {0x0037e, 0x01017},
+  {0x0037f, 0x0101d}, {0x00380, 0x1102a}, {0x00384, 0x0101d}, {0x0038b, 0x1102a},
+  {0x0038c, 0x0101d}, {0x0038d, 0x1102a}, {0x0038e, 0x0101d}, {0x003a2, 0x1102a},
+  {0x003a3, 0x0101d}, {0x00483, 0x00103}, {0x0048a, 0x0101d}, {0x00530, 0x1102a},
+  {0x00531, 0x0101d}, {0x00557, 0x1102a}, {0x00559, 0x0101d}, {0x00589, 0x01017},
+  {0x0058a, 0x0100c}, {0x0058b, 0x1102a}, {0x0058d, 0x0101d}, {0x0058f, 0x0101a},
+  {0x00590, 0x1102a}, {0x00591, 0x00103}, {0x005be, 0x0100c}, {0x005bf, 0x00103},
+  {0x005c0, 0x0101d}, {0x005c1, 0x00103}, {0x005c3, 0x0101d}, {0x005c4, 0x00103},
+  {0x005c6, 0x01012}, {0x005c7, 0x00103}, {0x005c8, 0x1102a}, {0x005d0, 0x01023},
+  {0x005eb, 0x1102a}, {0x005ef, 0x01023}, {0x005f3, 0x0101d}, {0x005f5, 0x1102a},
+  {0x00600, 0x001dd}, {0x00606, 0x0101d}, {0x00609, 0x01019}, {0x0060c, 0x01017},
+  {0x0060e, 0x0101d}, {0x00610, 0x00103}, {0x0061b, 0x01012}, {0x0061c, 0x000c3},
+  {0x0061d, 0x01012}, {0x00620, 0x0101d}, {0x0064b, 0x00103}, {0x00660, 0x01018},
+  {0x0066a, 0x01019}, {0x0066b, 0x01018}, {0x0066d, 0x0101d}, {0x00670, 0x00103},
+  {0x00671, 0x0101d}, {0x006d4, 0x01012}, {0x006d5, 0x0101d}, {0x006d6, 0x00103},
+  {0x006dd, 0x001dd}, {0x006de, 0x0101d}, {0x006df, 0x00103}, {0x006e5, 0x0101d},
+  {0x006e7, 0x00103}, {0x006e9, 0x0101d}, {0x006ea, 0x00103}, {0x006ee, 0x0101d},
+  {0x006f0, 0x01018}, {0x006fa, 0x0101d}, {0x0070e, 0x1102a}, {0x0070f, 0x001dd},
+  {0x00710, 0x0101d}, {0x00711, 0x00103}, {0x00712, 0x0101d}, {0x00730, 0x00103},
+  {0x0074b, 0x1102a}, {0x0074d, 0x0101d}, {0x007a6, 0x00103}, {0x007b1, 0x0101d},
+  {0x007b2, 0x1102a}, {0x007c0, 0x01018}, {0x007ca, 0x0101d}, {0x007eb, 0x00103},
+  {0x007f4, 0x0101d}, {0x007f8, 0x01017}, {0x007f9, 0x01012}, {0x007fa, 0x0101d},
+  {0x007fb, 0x1102a}, {0x007fd, 0x00103}, {0x007fe, 0x0101a}, {0x00800, 0x0101d},
+  {0x00816, 0x00103}, {0x0081a, 0x0101d}, {0x0081b, 0x00103}, {0x00824, 0x0101d},
+  {0x00825, 0x00103}, {0x00828, 0x0101d}, {0x00829, 0x00103}, {0x0082e, 0x1102a},
+  {0x00830, 0x0101d}, {0x0083f, 0x1102a}, {0x00840, 0x0101d}, {0x00859, 0x00103},
+  {0x0085c, 0x1102a}, {0x0085e, 0x0101d}, {0x0085f, 0x1102a}, {0x00860, 0x0101d},
+  {0x0086b, 0x1102a}, {0x00870, 0x0101d}, {0x0088f, 0x1102a}, {0x00890, 0x001dd},
+  {0x00892, 0x1102a}, {0x00898, 0x00103}, {0x008a0, 0x0101d}, {0x008ca, 0x00103},
+  {0x008e2, 0x001dd}, {0x008e3, 0x00103}, {0x00903, 0x01203}, {0x00904, 0x0101d},
+  {0x0093a, 0x00103}, {0x0093b, 0x01203}, {0x0093c, 0x00103}, {0x0093d, 0x0101d},
+  {0x0093e, 0x01203}, {0x00941, 0x00103}, {0x00949, 0x01203}, {0x0094d, 0x00103},
+  {0x0094e, 0x01203}, {0x00950, 0x0101d}, {0x00951, 0x00103}, {0x00958, 0x0101d},
+  {0x00962, 0x00103}, {0x00964, 0x0100c}, {0x00966, 0x01018}, {0x00970, 0x0101d},
+  {0x00981, 0x00103}, {0x00982, 0x01203}, {0x00984, 0x1102a}, {0x00985, 0x0101d},
+  {0x0098d, 0x1102a}, {0x0098f, 0x0101d}, {0x00991, 0x1102a}, {0x00993, 0x0101d},
+  {0x009a9, 0x1102a}, {0x009aa, 0x0101d}, {0x009b1, 0x1102a}, {0x009b2, 0x0101d},
+  {0x009b3, 0x1102a}, {0x009b6, 0x0101d}, {0x009ba, 0x1102a}, {0x009bc, 0x00103},
+  {0x009bd, 0x0101d}, {0x009be, 0x01103}, {0x009bf, 0x01203}, {0x009c1, 0x00103},
+  {0x009c5, 0x1102a}, {0x009c7, 0x01203}, {0x009c9, 0x1102a}, {0x009cb, 0x01203},
+  {0x009cd, 0x00103}, {0x009ce, 0x0101d}, {0x009cf, 0x1102a}, {0x009d7, 0x01103},
+  {0x009d8, 0x1102a}, {0x009dc, 0x0101d}, {0x009de, 0x1102a}, {0x009df, 0x0101d},
+  {0x009e2, 0x00103}, {0x009e4, 0x1102a}, {0x009e6, 0x01018}, {0x009f0, 0x0101d},
+  {0x009f2, 0x01019}, {0x009f4, 0x0101d}, {0x009f9, 0x01019}, {0x009fa, 0x0101d},
+  {0x009fb, 0x0101a}, {0x009fc, 0x0101d}, {0x009fe, 0x00103}, {0x009ff, 0x1102a},
+  {0x00a01, 0x00103}, {0x00a03, 0x01203}, {0x00a04, 0x1102a}, {0x00a05, 0x0101d},
+  {0x00a0b, 0x1102a}, {0x00a0f, 0x0101d}, {0x00a11, 0x1102a}, {0x00a13, 0x0101d},
+  {0x00a29, 0x1102a}, {0x00a2a, 0x0101d}, {0x00a31, 0x1102a}, {0x00a32, 0x0101d},
+  {0x00a34, 0x1102a}, {0x00a35, 0x0101d}, {0x00a37, 0x1102a}, {0x00a38, 0x0101d},
+  {0x00a3a, 0x1102a}, {0x00a3c, 0x00103}, {0x00a3d, 0x1102a}, {0x00a3e, 0x01203},
+  {0x00a41, 0x00103}, {0x00a43, 0x1102a}, {0x00a47, 0x00103}, {0x00a49, 0x1102a},
+  {0x00a4b, 0x00103}, {0x00a4e, 0x1102a}, {0x00a51, 0x00103}, {0x00a52, 0x1102a},
+  {0x00a59, 0x0101d}, {0x00a5d, 0x1102a}, {0x00a5e, 0x0101d}, {0x00a5f, 0x1102a},
+  {0x00a66, 0x01018}, {0x00a70, 0x00103}, {0x00a72, 0x0101d}, {0x00a75, 0x00103},
+  {0x00a76, 0x0101d}, {0x00a77, 0x1102a}, {0x00a81, 0x00103}, {0x00a83, 0x01203},
+  {0x00a84, 0x1102a}, {0x00a85, 0x0101d}, {0x00a8e, 0x1102a}, {0x00a8f, 0x0101d},
+  {0x00a92, 0x1102a}, {0x00a93, 0x0101d}, {0x00aa9, 0x1102a}, {0x00aaa, 0x0101d},
+  {0x00ab1, 0x1102a}, {0x00ab2, 0x0101d}, {0x00ab4, 0x1102a}, {0x00ab5, 0x0101d},
+  {0x00aba, 0x1102a}, {0x00abc, 0x00103}, {0x00abd, 0x0101d}, {0x00abe, 0x01203},
+  {0x00ac1, 0x00103}, {0x00ac6, 0x1102a}, {0x00ac7, 0x00103}, {0x00ac9, 0x01203},
+  {0x00aca, 0x1102a}, {0x00acb, 0x01203}, {0x00acd, 0x00103}, {0x00ace, 0x1102a},
+  {0x00ad0, 0x0101d}, {0x00ad1, 0x1102a}, {0x00ae0, 0x0101d}, {0x00ae2, 0x00103},
+  {0x00ae4, 0x1102a}, {0x00ae6, 0x01018}, {0x00af0, 0x0101d}, {0x00af1, 0x0101a},
+  {0x00af2, 0x1102a}, {0x00af9, 0x0101d}, {0x00afa, 0x00103}, {0x00b00, 0x1102a},
+  {0x00b01, 0x00103}, {0x00b02, 0x01203}, {0x00b04, 0x1102a}, {0x00b05, 0x0101d},
+  {0x00b0d, 0x1102a}, {0x00b0f, 0x0101d}, {0x00b11, 0x1102a}, {0x00b13, 0x0101d},
+  {0x00b29, 0x1102a}, {0x00b2a, 0x0101d}, {0x00b31, 0x1102a}, {0x00b32, 0x0101d},
+  {0x00b34, 0x1102a}, {0x00b35, 0x0101d}, {0x00b3a, 0x1102a}, {0x00b3c, 0x00103},
+  {0x00b3d, 0x0101d}, {0x00b3e, 0x01103}, {0x00b3f, 0x00103}, {0x00b40, 0x01203},
+  {0x00b41, 0x00103}, {0x00b45, 0x1102a}, {0x00b47, 0x01203}, {0x00b49, 0x1102a},
+  {0x00b4b, 0x01203}, {0x00b4d, 0x00103}, {0x00b4e, 0x1102a}, {0x00b55, 0x00103},
+  {0x00b57, 0x01103}, {0x00b58, 0x1102a}, {0x00b5c, 0x0101d}, {0x00b5e, 0x1102a},
+  {0x00b5f, 0x0101d}, {0x00b62, 0x00103}, {0x00b64, 0x1102a}, {0x00b66, 0x01018},
+  {0x00b70, 0x0101d}, {0x00b78, 0x1102a}, {0x00b82, 0x00103}, {0x00b83, 0x0101d},
+  {0x00b84, 0x1102a}, {0x00b85, 0x0101d}, {0x00b8b, 0x1102a}, {0x00b8e, 0x0101d},
+  {0x00b91, 0x1102a}, {0x00b92, 0x0101d}, {0x00b96, 0x1102a}, {0x00b99, 0x0101d},
+  {0x00b9b, 0x1102a}, {0x00b9c, 0x0101d}, {0x00b9d, 0x1102a}, {0x00b9e, 0x0101d},
+  {0x00ba0, 0x1102a}, {0x00ba3, 0x0101d}, {0x00ba5, 0x1102a}, {0x00ba8, 0x0101d},
+  {0x00bab, 0x1102a}, {0x00bae, 0x0101d}, {0x00bba, 0x1102a}, {0x00bbe, 0x01103},
+  {0x00bbf, 0x01203}, {0x00bc0, 0x00103}, {0x00bc1, 0x01203}, {0x00bc3, 0x1102a},
+  {0x00bc6, 0x01203}, {0x00bc9, 0x1102a}, {0x00bca, 0x01203}, {0x00bcd, 0x00103},
+  {0x00bce, 0x1102a}, {0x00bd0, 0x0101d}, {0x00bd1, 0x1102a}, {0x00bd7, 0x01103},
+  {0x00bd8, 0x1102a}, {0x00be6, 0x01018}, {0x00bf0, 0x0101d}, {0x00bf9, 0x0101a},
+  {0x00bfa, 0x0101d}, {0x00bfb, 0x1102a}, {0x00c00, 0x00103}, {0x00c01, 0x01203},
+  {0x00c04, 0x00103}, {0x00c05, 0x0101d}, {0x00c0d, 0x1102a}, {0x00c0e, 0x0101d},
+  {0x00c11, 0x1102a}, {0x00c12, 0x0101d}, {0x00c29, 0x1102a}, {0x00c2a, 0x0101d},
+  {0x00c3a, 0x1102a}, {0x00c3c, 0x00103}, {0x00c3d, 0x0101d}, {0x00c3e, 0x00103},
+  {0x00c41, 0x01203}, {0x00c45, 0x1102a}, {0x00c46, 0x00103}, {0x00c49, 0x1102a},
+  {0x00c4a, 0x00103}, {0x00c4e, 0x1102a}, {0x00c55, 0x00103}, {0x00c57, 0x1102a},
+  {0x00c58, 0x0101d}, {0x00c5b, 0x1102a}, {0x00c5d, 0x0101d}, {0x00c5e, 0x1102a},
+  {0x00c60, 0x0101d}, {0x00c62, 0x00103}, {0x00c64, 0x1102a}, {0x00c66, 0x01018},
+  {0x00c70, 0x1102a}, {0x00c77, 0x0100d}, {0x00c78, 0x0101d}, {0x00c81, 0x00103},
+  {0x00c82, 0x01203}, {0x00c84, 0x0100d}, {0x00c85, 0x0101d}, {0x00c8d, 0x1102a},
+  {0x00c8e, 0x0101d}, {0x00c91, 0x1102a}, {0x00c92, 0x0101d}, {0x00ca9, 0x1102a},
+  {0x00caa, 0x0101d}, {0x00cb4, 0x1102a}, {0x00cb5, 0x0101d}, {0x00cba, 0x1102a},
+  {0x00cbc, 0x00103}, {0x00cbd, 0x0101d}, {0x00cbe, 0x01203}, {0x00cbf, 0x00103},
+  {0x00cc0, 0x01203}, {0x00cc2, 0x01103}, {0x00cc3, 0x01203}, {0x00cc5, 0x1102a},
+  {0x00cc6, 0x00103}, {0x00cc7, 0x01203}, {0x00cc9, 0x1102a}, {0x00cca, 0x01203},
+  {0x00ccc, 0x00103}, {0x00cce, 0x1102a}, {0x00cd5, 0x01103}, {0x00cd7, 0x1102a},
+  {0x00cdd, 0x0101d}, {0x00cdf, 0x1102a}, {0x00ce0, 0x0101d}, {0x00ce2, 0x00103},
+  {0x00ce4, 0x1102a}, {0x00ce6, 0x01018}, {0x00cf0, 0x1102a}, {0x00cf1, 0x0101d},
+  {0x00cf3, 0x01203}, {0x00cf4, 0x1102a}, {0x00d00, 0x00103}, {0x00d02, 0x01203},
+  {0x00d04, 0x0101d}, {0x00d0d, 0x1102a}, {0x00d0e, 0x0101d}, {0x00d11, 0x1102a},
+  {0x00d12, 0x0101d}, {0x00d3b, 0x00103}, {0x00d3d, 0x0101d}, {0x00d3e, 0x01103},
+  {0x00d3f, 0x01203}, {0x00d41, 0x00103}, {0x00d45, 0x1102a}, {0x00d46, 0x01203},
+  {0x00d49, 0x1102a}, {0x00d4a, 0x01203}, {0x00d4d, 0x00103}, {0x00d4e, 0x011dd},
+  {0x00d4f, 0x0101d}, {0x00d50, 0x1102a}, {0x00d54, 0x0101d}, {0x00d57, 0x01103},
+  {0x00d58, 0x0101d}, {0x00d62, 0x00103}, {0x00d64, 0x1102a}, {0x00d66, 0x01018},
+  {0x00d70, 0x0101d}, {0x00d79, 0x01019}, {0x00d7a, 0x0101d}, {0x00d80, 0x1102a},
+  {0x00d81, 0x00103}, {0x00d82, 0x01203}, {0x00d84, 0x1102a}, {0x00d85, 0x0101d},
+  {0x00d97, 0x1102a}, {0x00d9a, 0x0101d}, {0x00db2, 0x1102a}, {0x00db3, 0x0101d},
+  {0x00dbc, 0x1102a}, {0x00dbd, 0x0101d}, {0x00dbe, 0x1102a}, {0x00dc0, 0x0101d},
+  {0x00dc7, 0x1102a}, {0x00dca, 0x00103}, {0x00dcb, 0x1102a}, {0x00dcf, 0x01103},
+  {0x00dd0, 0x01203}, {0x00dd2, 0x00103}, {0x00dd5, 0x1102a}, {0x00dd6, 0x00103},
+  {0x00dd7, 0x1102a}, {0x00dd8, 0x01203}, {0x00ddf, 0x01103}, {0x00de0, 0x1102a},
+  {0x00de6, 0x01018}, {0x00df0, 0x1102a}, {0x00df2, 0x01203}, {0x00df4, 0x0101d},
+  {0x00df5, 0x1102a}, {0x00e01, 0x01029}, {0x00e31, 0x00129}, {0x00e32, 0x01029},
+  {0x00e33, 0x01229}, {0x00e34, 0x00129}, {0x00e3b, 0x1102a}, {0x00e3f, 0x0101a},
+  {0x00e40, 0x01029}, {0x00e47, 0x00129}, {0x00e4f, 0x0101d}, {0x00e50, 0x01018},
+  {0x00e5a, 0x0100c}, {0x00e5c, 0x1102a}, {0x00e81, 0x01029}, {0x00e83, 0x1102a},
+  {0x00e84, 0x01029}, {0x00e85, 0x1102a}, {0x00e86, 0x01029}, {0x00e8b, 0x1102a},
+  {0x00e8c, 0x01029}, {0x00ea4, 0x1102a}, {0x00ea5, 0x01029}, {0x00ea6, 0x1102a},
+  {0x00ea7, 0x01029}, {0x00eb1, 0x00129}, {0x00eb2, 0x01029}, {0x00eb3, 0x01229},
+  {0x00eb4, 0x00129}, {0x00ebd, 0x01029}, {0x00ebe, 0x1102a}, {0x00ec0, 0x01029},
+  {0x00ec5, 0x1102a}, {0x00ec6, 0x01029}, {0x00ec7, 0x1102a}, {0x00ec8, 0x00129},
+  {0x00ecf, 0x1102a}, {0x00ed0, 0x01018}, {0x00eda, 0x1102a}, {0x00edc, 0x01029},
+  {0x00ee0, 0x1102a}, {0x00f00, 0x0101d}, {0x00f01, 0x0100d}, {0x00f05, 0x0101d},
+  {0x00f06, 0x0100d}, {0x00f08, 0x01008}, {0x00f09, 0x0100d}, {0x00f0b, 0x0100c},
+  {0x00f0c, 0x01008}, {0x00f0d, 0x01012}, {0x00f12, 0x01008}, {0x00f13, 0x0101d},
+  {0x00f14, 0x01012}, {0x00f15, 0x0101d}, {0x00f18, 0x00103}, {0x00f1a, 0x0101d},
+  {0x00f20, 0x01018}, {0x00f2a, 0x0101d}, {0x00f34, 0x0100c}, {0x00f35, 0x00103},
+  {0x00f36, 0x0101d}, {0x00f37, 0x00103}, {0x00f38, 0x0101d}, {0x00f39, 0x00103},
+  {0x00f3a, 0x01015}, {0x00f3b, 0x01010}, {0x00f3c, 0x01015}, {0x00f3d, 0x01010},
+  {0x00f3e, 0x01203}, {0x00f40, 0x0101d}, {0x00f48, 0x1102a}, {0x00f49, 0x0101d},
+  {0x00f6d, 0x1102a}, {0x00f71, 0x00103}, {0x00f7f, 0x0120c}, {0x00f80, 0x00103},
+  {0x00f85, 0x0100c}, {0x00f86, 0x00103}, {0x00f88, 0x0101d}, {0x00f8d, 0x00103},
+  {0x00f98, 0x1102a}, {0x00f99, 0x00103}, {0x00fbd, 0x1102a}, {0x00fbe, 0x0100c},
+  {0x00fc0, 0x0101d}, {0x00fc6, 0x00103}, {0x00fc7, 0x0101d}, {0x00fcd, 0x1102a},
+  {0x00fce, 0x0101d}, {0x00fd0, 0x0100d}, {0x00fd2, 0x0100c}, {0x00fd3, 0x0100d},
+  {0x00fd4, 0x0101d}, {0x00fd9, 0x01008}, {0x00fdb, 0x1102a}, {0x01000, 0x01029},
+  {0x0102d, 0x00129}, {0x01031, 0x01229}, {0x01032, 0x00129}, {0x01038, 0x01029},
+  {0x01039, 0x00129}, {0x0103b, 0x01229}, {0x0103d, 0x00129}, {0x0103f, 0x01029},
+  {0x01040, 0x01018}, {0x0104a, 0x0100c}, {0x0104c, 0x0101d}, {0x01050, 0x01029},
+  {0x01056, 0x01229}, {0x01058, 0x00129}, {0x0105a, 0x01029}, {0x0105e, 0x00129},
+  {0x01061, 0x01029}, {0x01071, 0x00129}, {0x01075, 0x01029}, {0x01082, 0x00129},
+  {0x01083, 0x01029}, {0x01084, 0x01229}, {0x01085, 0x00129}, {0x01087, 0x01029},
+  {0x0108d, 0x00129}, {0x0108e, 0x01029}, {0x01090, 0x01018}, {0x0109a, 0x01029},
+  {0x0109d, 0x00129}, {0x0109e, 0x01029}, {0x010a0, 0x0101d}, {0x010c6, 0x1102a},
+  {0x010c7, 0x0101d}, {0x010c8, 0x1102a}, {0x010cd, 0x0101d}, {0x010ce, 0x1102a},
+  {0x010d0, 0x0101d}, {0x01100, 0x0a265}, {0x01160, 0x002a6}, {0x011a8, 0x002e7},
+  {0x01200, 0x0101d}, {0x01249, 0x1102a}, {0x0124a, 0x0101d}, {0x0124e, 0x1102a},
+  {0x01250, 0x0101d}, {0x01257, 0x1102a}, {0x01258, 0x0101d}, {0x01259, 0x1102a},
+  {0x0125a, 0x0101d}, {0x0125e, 0x1102a}, {0x01260, 0x0101d}, {0x01289, 0x1102a},
+  {0x0128a, 0x0101d}, {0x0128e, 0x1102a}, {0x01290, 0x0101d}, {0x012b1, 0x1102a},
+  {0x012b2, 0x0101d}, {0x012b6, 0x1102a}, {0x012b8, 0x0101d}, {0x012bf, 0x1102a},
+  {0x012c0, 0x0101d}, {0x012c1, 0x1102a}, {0x012c2, 0x0101d}, {0x012c6, 0x1102a},
+  {0x012c8, 0x0101d}, {0x012d7, 0x1102a}, {0x012d8, 0x0101d}, {0x01311, 0x1102a},
+  {0x01312, 0x0101d}, {0x01316, 0x1102a}, {0x01318, 0x0101d}, {0x0135b, 0x1102a},
+  {0x0135d, 0x00103}, {0x01360, 0x0101d}, {0x01361, 0x0100c}, {0x01362, 0x0101d},
+  {0x0137d, 0x1102a}, {0x01380, 0x0101d}, {0x0139a, 0x1102a}, {0x013a0, 0x0101d},
+  {0x013f6, 0x1102a}, {0x013f8, 0x0101d}, {0x013fe, 0x1102a}, {0x01400, 0x0100c},
+  {0x01401, 0x0101d}, {0x01680, 0x0100c}, {0x01681, 0x0101d}, {0x0169b, 0x01015},
+  {0x0169c, 0x01010}, {0x0169d, 0x1102a}, {0x016a0, 0x0101d}, {0x016eb, 0x0100c},
+  {0x016ee, 0x0101d}, {0x016f9, 0x1102a}, {0x01700, 0x0101d}, {0x01712, 0x00103},
+  {0x01715, 0x01203}, {0x01716, 0x1102a}, {0x0171f, 0x0101d}, {0x01732, 0x00103},
+  {0x01734, 0x01203}, {0x01735, 0x0100c}, {0x01737, 0x1102a}, {0x01740, 0x0101d},
+  {0x01752, 0x00103}, {0x01754, 0x1102a}, {0x01760, 0x0101d}, {0x0176d, 0x1102a},
+  {0x0176e, 0x0101d}, {0x01771, 0x1102a}, {0x01772, 0x00103}, {0x01774, 0x1102a},
+  {0x01780, 0x01029}, {0x017b4, 0x00129}, {0x017b6, 0x01229}, {0x017b7, 0x00129},
+  {0x017be, 0x01229}, {0x017c6, 0x00129}, {0x017c7, 0x01229}, {0x017c9, 0x00129},
+  {0x017d4, 0x0100c}, {0x017d6, 0x01014}, {0x017d7, 0x01029}, {0x017d8, 0x0100c},
+  {0x017d9, 0x0101d}, {0x017da, 0x0100c}, {0x017db, 0x0101a}, {0x017dc, 0x01029},
+  {0x017dd, 0x00129}, {0x017de, 0x1102a}, {0x017e0, 0x01018}, {0x017ea, 0x1102a},
+  {0x017f0, 0x0101d}, {0x017fa, 0x1102a}, {0x01800, 0x0101d}, {0x01802, 0x01012},
+  {0x01804, 0x0100c}, {0x01806, 0x0100d}, {0x01807, 0x0101d}, {0x01808, 0x01012},
+  {0x0180a, 0x0101d}, {0x0180b, 0x00103}, {0x0180e, 0x000c8}, {0x0180f, 0x00103},
+  {0x01810, 0x01018}, {0x0181a, 0x1102a}, {0x01820, 0x0101d}, {0x01879, 0x1102a},
+  {0x01880, 0x0101d}, {0x01885, 0x00103}, {0x01887, 0x0101d}, {0x018a9, 0x00103},
+  {0x018aa, 0x0101d}, {0x018ab, 0x1102a}, {0x018b0, 0x0101d}, {0x018f6, 0x1102a},
+  {0x01900, 0x0101d}, {0x0191f, 0x1102a}, {0x01920, 0x00103}, {0x01923, 0x01203},
+  {0x01927, 0x00103}, {0x01929, 0x01203}, {0x0192c, 0x1102a}, {0x01930, 0x01203},
+  {0x01932, 0x00103}, {0x01933, 0x01203}, {0x01939, 0x00103}, {0x0193c, 0x1102a},
+  {0x01940, 0x0101d}, {0x01941, 0x1102a}, {0x01944, 0x01012}, {0x01946, 0x01018},
+  {0x01950, 0x01029}, {0x0196e, 0x1102a}, {0x01970, 0x01029}, {0x01975, 0x1102a},
+  {0x01980, 0x01029}, {0x019ac, 0x1102a}, {0x019b0, 0x01029}, {0x019ca, 0x1102a},
+  {0x019d0, 0x01018}, {0x019da, 0x01029}, {0x019db, 0x1102a}, {0x019de, 0x01029},
+  {0x019e0, 0x0101d}, {0x01a17, 0x00103}, {0x01a19, 0x01203}, {0x01a1b, 0x00103},
+  {0x01a1c, 0x1102a}, {0x01a1e, 0x0101d}, {0x01a20, 0x01029}, {0x01a55, 0x01229},
+  {0x01a56, 0x00129}, {0x01a57, 0x01229}, {0x01a58, 0x00129}, {0x01a5f, 0x1102a},
+  {0x01a60, 0x00129}, {0x01a61, 0x01029}, {0x01a62, 0x00129}, {0x01a63, 0x01029},
+  {0x01a65, 0x00129}, {0x01a6d, 0x01229}, {0x01a73, 0x00129}, {0x01a7d, 0x1102a},
+  {0x01a7f, 0x00103}, {0x01a80, 0x01018}, {0x01a8a, 0x1102a}, {0x01a90, 0x01018},
+  {0x01a9a, 0x1102a}, {0x01aa0, 0x01029}, {0x01aae, 0x1102a}, {0x01ab0, 0x00103},
+  {0x01acf, 0x1102a}, {0x01b00, 0x00103}, {0x01b04, 0x01203}, {0x01b05, 0x0101d},
+  {0x01b34, 0x00103}, {0x01b35, 0x01103}, {0x01b36, 0x00103}, {0x01b3b, 0x01203},
+  {0x01b3c, 0x00103}, {0x01b3d, 0x01203}, {0x01b42, 0x00103}, {0x01b43, 0x01203},
+  {0x01b45, 0x0101d}, {0x01b4d, 0x1102a}, {0x01b50, 0x01018}, {0x01b5a, 0x0100c},
+  {0x01b5c, 0x0101d}, {0x01b5d, 0x0100c}, {0x01b61, 0x0101d}, {0x01b6b, 0x00103},
+  {0x01b74, 0x0101d}, {0x01b7d, 0x0100c}, {0x01b7f, 0x1102a}, {0x01b80, 0x00103},
+  {0x01b82, 0x01203}, {0x01b83, 0x0101d}, {0x01ba1, 0x01203}, {0x01ba2, 0x00103},
+  {0x01ba6, 0x01203}, {0x01ba8, 0x00103}, {0x01baa, 0x01203}, {0x01bab, 0x00103},
+  {0x01bae, 0x0101d}, {0x01bb0, 0x01018}, {0x01bba, 0x0101d}, {0x01be6, 0x00103},
+  {0x01be7, 0x01203}, {0x01be8, 0x00103}, {0x01bea, 0x01203}, {0x01bed, 0x00103},
+  {0x01bee, 0x01203}, {0x01bef, 0x00103}, {0x01bf2, 0x01203}, {0x01bf4, 0x1102a},
+  {0x01bfc, 0x0101d}, {0x01c24, 0x01203}, {0x01c2c, 0x00103}, {0x01c34, 0x01203},
+  {0x01c36, 0x00103}, {0x01c38, 0x1102a}, {0x01c3b, 0x0100c}, {0x01c40, 0x01018},
+  {0x01c4a, 0x1102a}, {0x01c4d, 0x0101d}, {0x01c50, 0x01018}, {0x01c5a, 0x0101d},
+  {0x01c7e, 0x0100c}, {0x01c80, 0x0101d}, {0x01c89, 0x1102a}, {0x01c90, 0x0101d},
+  {0x01cbb, 0x1102a}, {0x01cbd, 0x0101d}, {0x01cc8, 0x1102a}, {0x01cd0, 0x00103},
+  {0x01cd3, 0x0101d}, {0x01cd4, 0x00103}, {0x01ce1, 0x01203}, {0x01ce2, 0x00103},
+  {0x01ce9, 0x0101d}, {0x01ced, 0x00103}, {0x01cee, 0x0101d}, {0x01cf4, 0x00103},
+  {0x01cf5, 0x0101d}, {0x01cf7, 0x01203}, {0x01cf8, 0x00103}, {0x01cfa, 0x0101d},
+  {0x01cfb, 0x1102a}, {0x01d00, 0x0101d}, {0x01dc0, 0x00103}, {0x01dcd, 0x00108},
+  {0x01dce, 0x00103}, {0x01dfc, 0x00108}, {0x01dfd, 0x00103}, {0x01e00, 0x0101d},
+  {0x01f16, 0x1102a}, {0x01f18, 0x0101d}, {0x01f1e, 0x1102a}, {0x01f20, 0x0101d},
+  {0x01f46, 0x1102a}, {0x01f48, 0x0101d}, {0x01f4e, 0x1102a}, {0x01f50, 0x0101d},
+  {0x01f58, 0x1102a}, {0x01f59, 0x0101d}, {0x01f5a, 0x1102a}, {0x01f5b, 0x0101d},
+  {0x01f5c, 0x1102a}, {0x01f5d, 0x0101d}, {0x01f5e, 0x1102a}, {0x01f5f, 0x0101d},
+  {0x01f7e, 0x1102a}, {0x01f80, 0x0101d}, {0x01fb5, 0x1102a}, {0x01fb6, 0x0101d},
+  {0x01fc5, 0x1102a}, {0x01fc6, 0x0101d}, {0x01fd4, 0x1102a}, {0x01fd6, 0x0101d},
+  {0x01fdc, 0x1102a}, {0x01fdd, 0x0101d}, {0x01ff0, 0x1102a}, {0x01ff2, 0x0101d},
+  {0x01ff5, 0x1102a}, {0x01ff6, 0x0101d}, {0x01ffd, 0x0100d}, {0x01ffe, 0x0101d},
+  {0x01fff, 0x1102a}, {0x02000, 0x0100c}, {0x02007, 0x01008}, {0x02008, 0x0100c},
+  {0x0200b, 0x000c7}, {0x0200c, 0x00103}, {0x0200d, 0x0014a}, {0x0200e, 0x000c3},
+  {0x02010, 0x0100c}, {0x02011, 0x01008}, {0x02012, 0x0100c}, {0x02014, 0x0100b},
+  {0x02015, 0x0101c}, {0x02017, 0x0101d}, {0x02018, 0x01016}, {0x0201a, 0x01015},
+  {0x0201b, 0x01016}, {0x0201e, 0x01015}, {0x0201f, 0x01016}, {0x02020, 0x0101c},
+  {0x02022, 0x0101d}, {0x02024, 0x01013}, {0x02027, 0x0100c}, {0x02028, 0x010c0},
+  {0x0202a, 0x000c3}, {0x0202f, 0x01008}, {0x02030, 0x01019}, {0x02038, 0x0101d},
+  {0x02039, 0x01016}, {0x0203b, 0x0101c}, {0x0203c, 0x05014}, {0x0203d, 0x01014},
+  {0x0203e, 0x0101d}, {0x02044, 0x01017}, {0x02045, 0x01015}, {0x02046, 0x01010},
+  {0x02047, 0x01014}, {0x02049, 0x05014}, {0x0204a, 0x0101d}, {0x02056, 0x0100c},
+  {0x02057, 0x01019}, {0x02058, 0x0100c}, {0x0205c, 0x0101d}, {0x0205d, 0x0100c},
+  {0x02060, 0x000c6}, {0x02061, 0x000dd}, {0x02065, 0x110ea}, {0x02066, 0x000c3},
+  {0x02070, 0x0101d}, {0x02072, 0x1102a}, {0x02074, 0x0101c}, {0x02075, 0x0101d},
+  {0x0207d, 0x01015}, {0x0207e, 0x01010}, {0x0207f, 0x0101c}, {0x02080, 0x0101d},
+  {0x02081, 0x0101c}, {0x02085, 0x0101d}, {0x0208d, 0x01015}, {0x0208e, 0x01010},
+  {0x0208f, 0x1102a}, {0x02090, 0x0101d}, {0x0209d, 0x1102a}, {0x020a0, 0x0101a},
+  {0x020a7, 0x01019}, {0x020a8, 0x0101a}, {0x020a9, 0x0901a}, {0x020aa, 0x0101a},
+  {0x020b6, 0x01019}, {0x020b7, 0x0101a}, {0x020bb, 0x01019}, {0x020bc, 0x0101a},
+  {0x020be, 0x01019}, {0x020bf, 0x0101a}, {0x020c0, 0x01019}, {0x020c1, 0x1101a},
+  {0x020d0, 0x00103}, {0x020f1, 0x1102a}, {0x02100, 0x0101d}, {0x02103, 0x01019},
+  {0x02104, 0x0101d}, {0x02105, 0x0101c}, {0x02106, 0x0101d}, {0x02109, 0x01019},
+  {0x0210a, 0x0101d}, {0x02113, 0x0101c}, {0x02114, 0x0101d}, {0x02116, 0x0101a},
+  {0x02117, 0x0101d}, {0x02121, 0x0101c}, {0x02122, 0x0501c}, {0x02123, 0x0101d},
+  {0x0212b, 0x0101c}, {0x0212c, 0x0101d}, {0x02139, 0x0501d}, {0x0213a, 0x0101d},
+  {0x02154, 0x0101c}, {0x02156, 0x0101d}, {0x0215b, 0x0101c}, {0x0215c, 0x0101d},
+  {0x0215e, 0x0101c}, {0x0215f, 0x0101d}, {0x02160, 0x0101c}, {0x0216c, 0x0101d},
+  {0x02170, 0x0101c}, {0x0217a, 0x0101d}, {0x02189, 0x0101c}, {0x0218a, 0x0101d},
+  {0x0218c, 0x1102a}, {0x02190, 0x0101c}, {0x02194, 0x0501c}, {0x0219a, 0x0101d},
+  {0x021a9, 0x0501d}, {0x021ab, 0x0101d}, {0x021d2, 0x0101c}, {0x021d3, 0x0101d},
+  {0x021d4, 0x0101c}, {0x021d5, 0x0101d}, {0x02200, 0x0101c}, {0x02201, 0x0101d},
+  {0x02202, 0x0101c}, {0x02204, 0x0101d}, {0x02207, 0x0101c}, {0x02209, 0x0101d},
+  {0x0220b, 0x0101c}, {0x0220c, 0x0101d}, {0x0220f, 0x0101c}, {0x02210, 0x0101d},
+  {0x02211, 0x0101c}, {0x02212, 0x0101a}, {0x02214, 0x0101d}, {0x02215, 0x0101c},
+  {0x02216, 0x0101d}, {0x0221a, 0x0101c}, {0x0221b, 0x0101d}, {0x0221d, 0x0101c},
+  {0x02221, 0x0101d}, {0x02223, 0x0101c}, {0x02224, 0x0101d}, {0x02225, 0x0101c},
+  {0x02226, 0x0101d}, {0x02227, 0x0101c}, {0x0222d, 0x0101d}, {0x0222e, 0x0101c},
+  {0x0222f, 0x0101d}, {0x02234, 0x0101c}, {0x02238, 0x0101d}, {0x0223c, 0x0101c},
+  {0x0223e, 0x0101d}, {0x02248, 0x0101c}, {0x02249, 0x0101d}, {0x0224c, 0x0101c},
+  {0x0224d, 0x0101d}, {0x02252, 0x0101c}, {0x02253, 0x0101d}, {0x02260, 0x0101c},
+  {0x02262, 0x0101d}, {0x02264, 0x0101c}, {0x02268, 0x0101d}, {0x0226a, 0x0101c},
+  {0x0226c, 0x0101d}, {0x0226e, 0x0101c}, {0x02270, 0x0101d}, {0x02282, 0x0101c},
+  {0x02284, 0x0101d}, {0x02286, 0x0101c}, {0x02288, 0x0101d}, {0x02295, 0x0101c},
+  {0x02296, 0x0101d}, {0x02299, 0x0101c}, {0x0229a, 0x0101d}, {0x022a5, 0x0101c},
+  {0x022a6, 0x0101d}, {0x022bf, 0x0101c}, {0x022c0, 0x0101d}, {0x022ef, 0x01013},
+  {0x022f0, 0x0101d}, {0x02308, 0x01015}, {0x02309, 0x01010}, {0x0230a, 0x01015},
+  {0x0230b, 0x01010}, {0x0230c, 0x0101d}, {0x02312, 0x0101c}, {0x02313, 0x0101d},
+  {0x0231a, 0x0e024}, {0x0231c, 0x0101d}, {0x02328, 0x0501d}, {0x02329, 0x0a015},
+  {0x0232a, 0x0a010}, {0x0232b, 0x0101d}, {0x02388, 0x0501d}, {0x02389, 0x0101d},
+  {0x023cf, 0x0501d}, {0x023d0, 0x0101d}, {0x023e9, 0x0e01d}, {0x023ed, 0x0501d},
+  {0x023f0, 0x0e024}, {0x023f1, 0x05024}, {0x023f3, 0x0e024}, {0x023f4, 0x0101d},
+  {0x023f8, 0x0501d}, {0x023fb, 0x0101d}, {0x02427, 0x1102a}, {0x02440, 0x0101d},
+  {0x0244b, 0x1102a}, {0x02460, 0x0101c}, {0x024c2, 0x0501c}, {0x024c3, 0x0101c},
+  {0x024ff, 0x0101d}, {0x02500, 0x0101c}, {0x0254c, 0x0101d}, {0x02550, 0x0101c},
+  {0x02575, 0x0101d}, {0x02580, 0x0101c}, {0x02590, 0x0101d}, {0x02592, 0x0101c},
+  {0x02596, 0x0101d}, {0x025a0, 0x0101c}, {0x025a2, 0x0101d}, {0x025a3, 0x0101c},
+  {0x025aa, 0x0501d}, {0x025ac, 0x0101d}, {0x025b2, 0x0101c}, {0x025b4, 0x0101d},
+  {0x025b6, 0x0501c}, {0x025b7, 0x0101c}, {0x025b8, 0x0101d}, {0x025bc, 0x0101c},
+  {0x025be, 0x0101d}, {0x025c0, 0x0501c}, {0x025c1, 0x0101c}, {0x025c2, 0x0101d},
+  {0x025c6, 0x0101c}, {0x025c9, 0x0101d}, {0x025cb, 0x0101c}, {0x025cc, 0x0101d},
+  {0x025ce, 0x0101c}, {0x025d2, 0x0101d}, {0x025e2, 0x0101c}, {0x025e6, 0x0101d},
+  {0x025ef, 0x0101c}, {0x025f0, 0x0101d}, {0x025fb, 0x0501d}, {0x025fd, 0x0e01d},
+  {0x025ff, 0x0101d}, {0x02600, 0x05024}, {0x02604, 0x0501d}, {0x02605, 0x0501c},
+  {0x02606, 0x0101c}, {0x02607, 0x0501d}, {0x02609, 0x0501c}, {0x0260a, 0x0501d},
+  {0x0260e, 0x0501c}, {0x02610, 0x0501d}, {0x02613, 0x0101d}, {0x02614, 0x0e024},
+  {0x02616, 0x0501c}, {0x02618, 0x05024}, {0x02619, 0x0501d}, {0x0261a, 0x05024},
+  {0x0261d, 0x0501f}, {0x0261e, 0x05024}, {0x02620, 0x0501d}, {0x02639, 0x05024},
+  {0x0263c, 0x0501d}, {0x02640, 0x0501c}, {0x02641, 0x0501d}, {0x02642, 0x0501c},
+  {0x02643, 0x0501d}, {0x02648, 0x0e01d}, {0x02654, 0x0501d}, {0x02660, 0x0501c},
+  {0x02662, 0x0501d}, {0x02663, 0x0501c}, {0x02666, 0x0501d}, {0x02667, 0x0501c},
+  {0x02668, 0x05024}, {0x02669, 0x0501c}, {0x0266b, 0x0501d}, {0x0266c, 0x0501c},
+  {0x0266e, 0x0501d}, {0x0266f, 0x0501c}, {0x02670, 0x0501d}, {0x0267f, 0x0e024},
+  {0x02680, 0x0501d}, {0x02686, 0x0101d}, {0x02690, 0x0501d}, {0x02693, 0x0e01d},
+  {0x02694, 0x0501d}, {0x0269e, 0x0501c}, {0x026a0, 0x0501d}, {0x026a1, 0x0e01d},
+  {0x026a2, 0x0501d}, {0x026aa, 0x0e01d}, {0x026ac, 0x0501d}, {0x026bd, 0x0e024},
+  {0x026bf, 0x05024}, {0x026c4, 0x0e024}, {0x026c6, 0x05024}, {0x026c9, 0x0501c},
+  {0x026cd, 0x05024}, {0x026ce, 0x0e01d}, {0x026cf, 0x05024}, {0x026d2, 0x0501c},
+  {0x026d3, 0x05024}, {0x026d4, 0x0e024}, {0x026d5, 0x0501c}, {0x026d8, 0x05024},
+  {0x026da, 0x0501c}, {0x026dc, 0x05024}, {0x026dd, 0x0501c}, {0x026df, 0x05024},
+  {0x026e2, 0x0501d}, {0x026e3, 0x0501c}, {0x026e4, 0x0501d}, {0x026e8, 0x0501c},
+  {0x026ea, 0x0e024}, {0x026eb, 0x0501c}, {0x026f1, 0x05024}, {0x026f2, 0x0e024},
+  {0x026f4, 0x05024}, {0x026f5, 0x0e024}, {0x026f6, 0x0501c}, {0x026f7, 0x05024},
+  {0x026f9, 0x0501f}, {0x026fa, 0x0e024}, {0x026fb, 0x0501c}, {0x026fd, 0x0e024},
+  {0x026fe, 0x05024}, {0x02705, 0x0e01d}, {0x02706, 0x0101d}, {0x02708, 0x05024},
+  {0x0270a, 0x0e01f}, {0x0270c, 0x0501f}, {0x0270e, 0x0501d}, {0x02713, 0x0101d},
+  {0x02714, 0x0501d}, {0x02715, 0x0101d}, {0x02716, 0x0501d}, {0x02717, 0x0101d},
+  {0x0271d, 0x0501d}, {0x0271e, 0x0101d}, {0x02721, 0x0501d}, {0x02722, 0x0101d},
+  {0x02728, 0x0e01d}, {0x02729, 0x0101d}, {0x02733, 0x0501d}, {0x02735, 0x0101d},
+  {0x02744, 0x0501d}, {0x02745, 0x0101d}, {0x02747, 0x0501d}, {0x02748, 0x0101d},
+  {0x0274c, 0x0e01d}, {0x0274d, 0x0101d}, {0x0274e, 0x0e01d}, {0x0274f, 0x0101d},
+  {0x02753, 0x0e01d}, {0x02756, 0x0101d}, {0x02757, 0x0e01c}, {0x02758, 0x0101d},
+  {0x0275b, 0x01016}, {0x02761, 0x0101d}, {0x02762, 0x01012}, {0x02763, 0x05012},
+  {0x02764, 0x05024}, {0x02765, 0x0501d}, {0x02768, 0x01015}, {0x02769, 0x01010},
+  {0x0276a, 0x01015}, {0x0276b, 0x01010}, {0x0276c, 0x01015}, {0x0276d, 0x01010},
+  {0x0276e, 0x01015}, {0x0276f, 0x01010}, {0x02770, 0x01015}, {0x02771, 0x01010},
+  {0x02772, 0x01015}, {0x02773, 0x01010}, {0x02774, 0x01015}, {0x02775, 0x01010},
+  {0x02776, 0x0101c}, {0x02794, 0x0101d}, {0x02795, 0x0e01d}, {0x02798, 0x0101d},
+  {0x027a1, 0x0501d}, {0x027a2, 0x0101d}, {0x027b0, 0x0e01d}, {0x027b1, 0x0101d},
+  {0x027bf, 0x0e01d}, {0x027c0, 0x0101d}, {0x027c5, 0x01015}, {0x027c6, 0x01010},
+  {0x027c7, 0x0101d}, {0x027e6, 0x01015}, {0x027e7, 0x01010}, {0x027e8, 0x01015},
+  {0x027e9, 0x01010}, {0x027ea, 0x01015}, {0x027eb, 0x01010}, {0x027ec, 0x01015},
+  {0x027ed, 0x01010}, {0x027ee, 0x01015}, {0x027ef, 0x01010}, {0x027f0, 0x0101d},
+  {0x02934, 0x0501d}, {0x02936, 0x0101d}, {0x02983, 0x01015}, {0x02984, 0x01010},
+  {0x02985, 0x01015}, {0x02986, 0x01010}, {0x02987, 0x01015}, {0x02988, 0x01010},
+  {0x02989, 0x01015}, {0x0298a, 0x01010}, {0x0298b, 0x01015}, {0x0298c, 0x01010},
+  {0x0298d, 0x01015}, {0x0298e, 0x01010}, {0x0298f, 0x01015}, {0x02990, 0x01010},
+  {0x02991, 0x01015}, {0x02992, 0x01010}, {0x02993, 0x01015}, {0x02994, 0x01010},
+  {0x02995, 0x01015}, {0x02996, 0x01010}, {0x02997, 0x01015}, {0x02998, 0x01010},
+  {0x02999, 0x0101d}, {0x029d8, 0x01015}, {0x029d9, 0x01010}, {0x029da, 0x01015},
+  {0x029db, 0x01010}, {0x029dc, 0x0101d}, {0x029fc, 0x01015}, {0x029fd, 0x01010},
+  {0x029fe, 0x0101d}, {0x02b05, 0x0501d}, {0x02b08, 0x0101d}, {0x02b1b, 0x0e01d},
+  {0x02b1d, 0x0101d}, {0x02b50, 0x0e01d}, {0x02b51, 0x0101d}, {0x02b55, 0x0e01c},
+  {0x02b56, 0x0101c}, {0x02b5a, 0x0101d}, {0x02b74, 0x1102a}, {0x02b76, 0x0101d},
+  {0x02b96, 0x1102a}, {0x02b97, 0x0101d}, {0x02cef, 0x00103}, {0x02cf2, 0x0101d},
+  {0x02cf4, 0x1102a}, {0x02cf9, 0x01012}, {0x02cfa, 0x0100c}, {0x02cfd, 0x0101d},
+  {0x02cfe, 0x01012}, {0x02cff, 0x0100c}, {0x02d00, 0x0101d}, {0x02d26, 0x1102a},
+  {0x02d27, 0x0101d}, {0x02d28, 0x1102a}, {0x02d2d, 0x0101d}, {0x02d2e, 0x1102a},
+  {0x02d30, 0x0101d}, {0x02d68, 0x1102a}, {0x02d6f, 0x0101d}, {0x02d70, 0x0100c},
+  {0x02d71, 0x1102a}, {0x02d7f, 0x00103}, {0x02d80, 0x0101d}, {0x02d97, 0x1102a},
+  {0x02da0, 0x0101d}, {0x02da7, 0x1102a}, {0x02da8, 0x0101d}, {0x02daf, 0x1102a},
+  {0x02db0, 0x0101d}, {0x02db7, 0x1102a}, {0x02db8, 0x0101d}, {0x02dbf, 0x1102a},
+  {0x02dc0, 0x0101d}, {0x02dc7, 0x1102a}, {0x02dc8, 0x0101d}, {0x02dcf, 0x1102a},
+  {0x02dd0, 0x0101d}, {0x02dd7, 0x1102a}, {0x02dd8, 0x0101d}, {0x02ddf, 0x1102a},
+  {0x02de0, 0x00103}, {0x02e00, 0x01016}, {0x02e0e, 0x0100c}, {0x02e16, 0x0101d},
+  {0x02e17, 0x0100c}, {0x02e18, 0x01015}, {0x02e19, 0x0100c}, {0x02e1a, 0x0101d},
+  {0x02e1c, 0x01016}, {0x02e1e, 0x0101d}, {0x02e20, 0x01016}, {0x02e22, 0x01015},
+  {0x02e23, 0x01010}, {0x02e24, 0x01015}, {0x02e25, 0x01010}, {0x02e26, 0x01015},
+  {0x02e27, 0x01010}, {0x02e28, 0x01015}, {0x02e29, 0x01010}, {0x02e2a, 0x0100c},
+  {0x02e2e, 0x01012}, {0x02e2f, 0x0101d}, {0x02e30, 0x0100c}, {0x02e32, 0x0101d},
+  {0x02e33, 0x0100c}, {0x02e35, 0x0101d}, {0x02e3a, 0x0100b}, {0x02e3c, 0x0100c},
+  {0x02e3f, 0x0101d}, {0x02e40, 0x0100c}, {0x02e42, 0x01015}, {0x02e43, 0x0100c},
+  {0x02e4b, 0x0101d}, {0x02e4c, 0x0100c}, {0x02e4d, 0x0101d}, {0x02e4e, 0x0100c},
+  {0x02e50, 0x0101d}, {0x02e53, 0x01012}, {0x02e55, 0x01015}, {0x02e56, 0x01010},
+  {0x02e57, 0x01015}, {0x02e58, 0x01010}, {0x02e59, 0x01015}, {0x02e5a, 0x01010},
+  {0x02e5b, 0x01015}, {0x02e5c, 0x01010}, {0x02e5d, 0x0100c}, {0x02e5e, 0x1102a},
+  {0x02e80, 0x0a024}, {0x02e9a, 0x1102a}, {0x02e9b, 0x0a024}, {0x02ef4, 0x1102a},
+  {0x02f00, 0x0a024}, {0x02fd6, 0x1102a}, {0x02ff0, 0x0a024}, {0x02ffc, 0x1102a},
+  {0x03000, 0x0a00c}, {0x03001, 0x0a010}, {0x03003, 0x0a024}, {0x03005, 0x0a014},
+  {0x03006, 0x0a024}, {0x03008, 0x0a015}, {0x03009, 0x0a010}, {0x0300a, 0x0a015},
+  {0x0300b, 0x0a010}, {0x0300c, 0x0a015}, {0x0300d, 0x0a010}, {0x0300e, 0x0a015},
+  {0x0300f, 0x0a010}, {0x03010, 0x0a015}, {0x03011, 0x0a010}, {0x03012, 0x0a024},
+  {0x03014, 0x0a015}, {0x03015, 0x0a010}, {0x03016, 0x0a015}, {0x03017, 0x0a010},
+  {0x03018, 0x0a015}, {0x03019, 0x0a010}, {0x0301a, 0x0a015}, {0x0301b, 0x0a010},
+  {0x0301c, 0x0a014}, {0x0301d, 0x0a015}, {0x0301e, 0x0a010}, {0x03020, 0x0a024},
+  {0x0302a, 0x08103}, {0x0302e, 0x0a103}, {0x03030, 0x0e024}, {0x03031, 0x0a024},
+  {0x03035, 0x0a003}, {0x03036, 0x0a024}, {0x0303b, 0x0a014}, {0x0303d, 0x0e024},
+  {0x0303e, 0x0a024}, {0x0303f, 0x01024}, {0x03040, 0x1102a}, {0x03041, 0x0a01e},
+  {0x03042, 0x0a024}, {0x03043, 0x0a01e}, {0x03044, 0x0a024}, {0x03045, 0x0a01e},
+  {0x03046, 0x0a024}, {0x03047, 0x0a01e}, {0x03048, 0x0a024}, {0x03049, 0x0a01e},
+  {0x0304a, 0x0a024}, {0x03063, 0x0a01e}, {0x03064, 0x0a024}, {0x03083, 0x0a01e},
+  {0x03084, 0x0a024}, {0x03085, 0x0a01e}, {0x03086, 0x0a024}, {0x03087, 0x0a01e},
+  {0x03088, 0x0a024}, {0x0308e, 0x0a01e}, {0x0308f, 0x0a024}, {0x03095, 0x0a01e},
+  {0x03097, 0x1102a}, {0x03099, 0x08103}, {0x0309b, 0x0a014}, {0x0309f, 0x0a024},
+  {0x030a0, 0x0a014}, {0x030a1, 0x0a01e}, {0x030a2, 0x0a024}, {0x030a3, 0x0a01e},
+  {0x030a4, 0x0a024}, {0x030a5, 0x0a01e}, {0x030a6, 0x0a024}, {0x030a7, 0x0a01e},
+  {0x030a8, 0x0a024}, {0x030a9, 0x0a01e}, {0x030aa, 0x0a024}, {0x030c3, 0x0a01e},
+  {0x030c4, 0x0a024}, {0x030e3, 0x0a01e}, {0x030e4, 0x0a024}, {0x030e5, 0x0a01e},
+  {0x030e6, 0x0a024}, {0x030e7, 0x0a01e}, {0x030e8, 0x0a024}, {0x030ee, 0x0a01e},
+  {0x030ef, 0x0a024}, {0x030f5, 0x0a01e}, {0x030f7, 0x0a024}, {0x030fb, 0x0a014},
+  {0x030fc, 0x0a01e}, {0x030fd, 0x0a014}, {0x030ff, 0x0a024}, {0x03100, 0x1102a},
+  {0x03105, 0x0a024}, {0x03130, 0x1102a}, {0x03131, 0x0a024}, {0x0318f, 0x1102a},
+  {0x03190, 0x0a024}, {0x031e4, 0x1102a}, {0x031f0, 0x0a01e}, {0x03200, 0x0a024},
+  {0x0321f, 0x1102a}, {0x03220, 0x0a024}, {0x03248, 0x0101c}, {0x03250, 0x0a024},
+  {0x03297, 0x0e024}, {0x03298, 0x0a024}, {0x03299, 0x0e024}, {0x0329a, 0x0a024},
+  {0x04dc0, 0x0101d}, {0x04e00, 0x0a024}, {0x0a015, 0x0a014}, {0x0a016, 0x0a024},
+  {0x0a48d, 0x1102a}, {0x0a490, 0x0a024}, {0x0a4c7, 0x1102a}, {0x0a4d0, 0x0101d},
+  {0x0a4fe, 0x0100c}, {0x0a500, 0x0101d}, {0x0a60d, 0x0100c}, {0x0a60e, 0x01012},
+  {0x0a60f, 0x0100c}, {0x0a610, 0x0101d}, {0x0a620, 0x01018}, {0x0a62a, 0x0101d},
+  {0x0a62c, 0x1102a}, {0x0a640, 0x0101d}, {0x0a66f, 0x00103}, {0x0a673, 0x0101d},
+  {0x0a674, 0x00103}, {0x0a67e, 0x0101d}, {0x0a69e, 0x00103}, {0x0a6a0, 0x0101d},
+  {0x0a6f0, 0x00103}, {0x0a6f2, 0x0101d}, {0x0a6f3, 0x0100c}, {0x0a6f8, 0x1102a},
+  {0x0a700, 0x0101d}, {0x0a7cb, 0x1102a}, {0x0a7d0, 0x0101d}, {0x0a7d2, 0x1102a},
+  {0x0a7d3, 0x0101d}, {0x0a7d4, 0x1102a}, {0x0a7d5, 0x0101d}, {0x0a7da, 0x1102a},
+  {0x0a7f2, 0x0101d}, {0x0a802, 0x00103}, {0x0a803, 0x0101d}, {0x0a806, 0x00103},
+  {0x0a807, 0x0101d}, {0x0a80b, 0x00103}, {0x0a80c, 0x0101d}, {0x0a823, 0x01203},
+  {0x0a825, 0x00103}, {0x0a827, 0x01203}, {0x0a828, 0x0101d}, {0x0a82c, 0x00103},
+  {0x0a82d, 0x1102a}, {0x0a830, 0x0101d}, {0x0a838, 0x01019}, {0x0a839, 0x0101d},
+  {0x0a83a, 0x1102a}, {0x0a840, 0x0101d}, {0x0a874, 0x0100d}, {0x0a876, 0x01012},
+  {0x0a878, 0x1102a}, {0x0a880, 0x01203}, {0x0a882, 0x0101d}, {0x0a8b4, 0x01203},
+  {0x0a8c4, 0x00103}, {0x0a8c6, 0x1102a}, {0x0a8ce, 0x0100c}, {0x0a8d0, 0x01018},
+  {0x0a8da, 0x1102a}, {0x0a8e0, 0x00103}, {0x0a8f2, 0x0101d}, {0x0a8fc, 0x0100d},
+  {0x0a8fd, 0x0101d}, {0x0a8ff, 0x00103}, {0x0a900, 0x01018}, {0x0a90a, 0x0101d},
+  {0x0a926, 0x00103}, {0x0a92e, 0x0100c}, {0x0a930, 0x0101d}, {0x0a947, 0x00103},
+  {0x0a952, 0x01203}, {0x0a954, 0x1102a}, {0x0a95f, 0x0101d}, {0x0a960, 0x0a265},
+  {0x0a97d, 0x1102a}, {0x0a980, 0x00103}, {0x0a983, 0x01203}, {0x0a984, 0x0101d},
+  {0x0a9b3, 0x00103}, {0x0a9b4, 0x01203}, {0x0a9b6, 0x00103}, {0x0a9ba, 0x01203},
+  {0x0a9bc, 0x00103}, {0x0a9be, 0x01203}, {0x0a9c1, 0x0101d}, {0x0a9c7, 0x0100c},
+  {0x0a9ca, 0x0101d}, {0x0a9ce, 0x1102a}, {0x0a9cf, 0x0101d}, {0x0a9d0, 0x01018},
+  {0x0a9da, 0x1102a}, {0x0a9de, 0x0101d}, {0x0a9e0, 0x01029}, {0x0a9e5, 0x00129},
+  {0x0a9e6, 0x01029}, {0x0a9f0, 0x01018}, {0x0a9fa, 0x01029}, {0x0a9ff, 0x1102a},
+  {0x0aa00, 0x0101d}, {0x0aa29, 0x00103}, {0x0aa2f, 0x01203}, {0x0aa31, 0x00103},
+  {0x0aa33, 0x01203}, {0x0aa35, 0x00103}, {0x0aa37, 0x1102a}, {0x0aa40, 0x0101d},
+  {0x0aa43, 0x00103}, {0x0aa44, 0x0101d}, {0x0aa4c, 0x00103}, {0x0aa4d, 0x01203},
+  {0x0aa4e, 0x1102a}, {0x0aa50, 0x01018}, {0x0aa5a, 0x1102a}, {0x0aa5c, 0x0101d},
+  {0x0aa5d, 0x0100c}, {0x0aa60, 0x01029}, {0x0aa7c, 0x00129}, {0x0aa7d, 0x01029},
+  {0x0aab0, 0x00129}, {0x0aab1, 0x01029}, {0x0aab2, 0x00129}, {0x0aab5, 0x01029},
+  {0x0aab7, 0x00129}, {0x0aab9, 0x01029}, {0x0aabe, 0x00129}, {0x0aac0, 0x01029},
+  {0x0aac1, 0x00129}, {0x0aac2, 0x01029}, {0x0aac3, 0x1102a}, {0x0aadb, 0x01029},
+  {0x0aae0, 0x0101d}, {0x0aaeb, 0x01203}, {0x0aaec, 0x00103}, {0x0aaee, 0x01203},
+  {0x0aaf0, 0x0100c}, {0x0aaf2, 0x0101d}, {0x0aaf5, 0x01203}, {0x0aaf6, 0x00103},
+  {0x0aaf7, 0x1102a}, {0x0ab01, 0x0101d}, {0x0ab07, 0x1102a}, {0x0ab09, 0x0101d},
+  {0x0ab0f, 0x1102a}, {0x0ab11, 0x0101d}, {0x0ab17, 0x1102a}, {0x0ab20, 0x0101d},
+  {0x0ab27, 0x1102a}, {0x0ab28, 0x0101d}, {0x0ab2f, 0x1102a}, {0x0ab30, 0x0101d},
+  {0x0ab6c, 0x1102a}, {0x0ab70, 0x0101d}, {0x0abe3, 0x01203}, {0x0abe5, 0x00103},
+  {0x0abe6, 0x01203}, {0x0abe8, 0x00103}, {0x0abe9, 0x01203}, {0x0abeb, 0x0100c},
+  {0x0abec, 0x01203}, {0x0abed, 0x00103}, {0x0abee, 0x1102a}, {0x0abf0, 0x01018},
+  {0x0abfa, 0x1102a}, {0x0ac00, 0x0a321}, {0x0ac01, 0x0a362}, {0x0ac1c, 0x0a321},
+  {0x0ac1d, 0x0a362}, {0x0ac38, 0x0a321}, {0x0ac39, 0x0a362}, {0x0ac54, 0x0a321},
+  {0x0ac55, 0x0a362}, {0x0ac70, 0x0a321}, {0x0ac71, 0x0a362}, {0x0ac8c, 0x0a321},
+  {0x0ac8d, 0x0a362}, {0x0aca8, 0x0a321}, {0x0aca9, 0x0a362}, {0x0acc4, 0x0a321},
+  {0x0acc5, 0x0a362}, {0x0ace0, 0x0a321}, {0x0ace1, 0x0a362}, {0x0acfc, 0x0a321},
+  {0x0acfd, 0x0a362}, {0x0ad18, 0x0a321}, {0x0ad19, 0x0a362}, {0x0ad34, 0x0a321},
+  {0x0ad35, 0x0a362}, {0x0ad50, 0x0a321}, {0x0ad51, 0x0a362}, {0x0ad6c, 0x0a321},
+  {0x0ad6d, 0x0a362}, {0x0ad88, 0x0a321}, {0x0ad89, 0x0a362}, {0x0ada4, 0x0a321},
+  {0x0ada5, 0x0a362}, {0x0adc0, 0x0a321}, {0x0adc1, 0x0a362}, {0x0addc, 0x0a321},
+  {0x0addd, 0x0a362}, {0x0adf8, 0x0a321}, {0x0adf9, 0x0a362}, {0x0ae14, 0x0a321},
+  {0x0ae15, 0x0a362}, {0x0ae30, 0x0a321}, {0x0ae31, 0x0a362}, {0x0ae4c, 0x0a321},
+  {0x0ae4d, 0x0a362}, {0x0ae68, 0x0a321}, {0x0ae69, 0x0a362}, {0x0ae84, 0x0a321},
+  {0x0ae85, 0x0a362}, {0x0aea0, 0x0a321}, {0x0aea1, 0x0a362}, {0x0aebc, 0x0a321},
+  {0x0aebd, 0x0a362}, {0x0aed8, 0x0a321}, {0x0aed9, 0x0a362}, {0x0aef4, 0x0a321},
+  {0x0aef5, 0x0a362}, {0x0af10, 0x0a321}, {0x0af11, 0x0a362}, {0x0af2c, 0x0a321},
+  {0x0af2d, 0x0a362}, {0x0af48, 0x0a321}, {0x0af49, 0x0a362}, {0x0af64, 0x0a321},
+  {0x0af65, 0x0a362}, {0x0af80, 0x0a321}, {0x0af81, 0x0a362}, {0x0af9c, 0x0a321},
+  {0x0af9d, 0x0a362}, {0x0afb8, 0x0a321}, {0x0afb9, 0x0a362}, {0x0afd4, 0x0a321},
+  {0x0afd5, 0x0a362}, {0x0aff0, 0x0a321}, {0x0aff1, 0x0a362}, {0x0b00c, 0x0a321},
+  {0x0b00d, 0x0a362}, {0x0b028, 0x0a321}, {0x0b029, 0x0a362}, {0x0b044, 0x0a321},
+  {0x0b045, 0x0a362}, {0x0b060, 0x0a321}, {0x0b061, 0x0a362}, {0x0b07c, 0x0a321},
+  {0x0b07d, 0x0a362}, {0x0b098, 0x0a321}, {0x0b099, 0x0a362}, {0x0b0b4, 0x0a321},
+  {0x0b0b5, 0x0a362}, {0x0b0d0, 0x0a321}, {0x0b0d1, 0x0a362}, {0x0b0ec, 0x0a321},
+  {0x0b0ed, 0x0a362}, {0x0b108, 0x0a321}, {0x0b109, 0x0a362}, {0x0b124, 0x0a321},
+  {0x0b125, 0x0a362}, {0x0b140, 0x0a321}, {0x0b141, 0x0a362}, {0x0b15c, 0x0a321},
+  {0x0b15d, 0x0a362}, {0x0b178, 0x0a321}, {0x0b179, 0x0a362}, {0x0b194, 0x0a321},
+  {0x0b195, 0x0a362}, {0x0b1b0, 0x0a321}, {0x0b1b1, 0x0a362}, {0x0b1cc, 0x0a321},
+  {0x0b1cd, 0x0a362}, {0x0b1e8, 0x0a321}, {0x0b1e9, 0x0a362}, {0x0b204, 0x0a321},
+  {0x0b205, 0x0a362}, {0x0b220, 0x0a321}, {0x0b221, 0x0a362}, {0x0b23c, 0x0a321},
+  {0x0b23d, 0x0a362}, {0x0b258, 0x0a321}, {0x0b259, 0x0a362}, {0x0b274, 0x0a321},
+  {0x0b275, 0x0a362}, {0x0b290, 0x0a321}, {0x0b291, 0x0a362}, {0x0b2ac, 0x0a321},
+  {0x0b2ad, 0x0a362}, {0x0b2c8, 0x0a321}, {0x0b2c9, 0x0a362}, {0x0b2e4, 0x0a321},
+  {0x0b2e5, 0x0a362}, {0x0b300, 0x0a321}, {0x0b301, 0x0a362}, {0x0b31c, 0x0a321},
+  {0x0b31d, 0x0a362}, {0x0b338, 0x0a321}, {0x0b339, 0x0a362}, {0x0b354, 0x0a321},
+  {0x0b355, 0x0a362}, {0x0b370, 0x0a321}, {0x0b371, 0x0a362}, {0x0b38c, 0x0a321},
+  {0x0b38d, 0x0a362}, {0x0b3a8, 0x0a321}, {0x0b3a9, 0x0a362}, {0x0b3c4, 0x0a321},
+  {0x0b3c5, 0x0a362}, {0x0b3e0, 0x0a321}, {0x0b3e1, 0x0a362}, {0x0b3fc, 0x0a321},
+  {0x0b3fd, 0x0a362}, {0x0b418, 0x0a321}, {0x0b419, 0x0a362}, {0x0b434, 0x0a321},
+  {0x0b435, 0x0a362}, {0x0b450, 0x0a321}, {0x0b451, 0x0a362}, {0x0b46c, 0x0a321},
+  {0x0b46d, 0x0a362}, {0x0b488, 0x0a321}, {0x0b489, 0x0a362}, {0x0b4a4, 0x0a321},
+  {0x0b4a5, 0x0a362}, {0x0b4c0, 0x0a321}, {0x0b4c1, 0x0a362}, {0x0b4dc, 0x0a321},
+  {0x0b4dd, 0x0a362}, {0x0b4f8, 0x0a321}, {0x0b4f9, 0x0a362}, {0x0b514, 0x0a321},
+  {0x0b515, 0x0a362}, {0x0b530, 0x0a321}, {0x0b531, 0x0a362}, {0x0b54c, 0x0a321},
+  {0x0b54d, 0x0a362}, {0x0b568, 0x0a321}, {0x0b569, 0x0a362}, {0x0b584, 0x0a321},
+  {0x0b585, 0x0a362}, {0x0b5a0, 0x0a321}, {0x0b5a1, 0x0a362}, {0x0b5bc, 0x0a321},
+  {0x0b5bd, 0x0a362}, {0x0b5d8, 0x0a321}, {0x0b5d9, 0x0a362}, {0x0b5f4, 0x0a321},
+  {0x0b5f5, 0x0a362}, {0x0b610, 0x0a321}, {0x0b611, 0x0a362}, {0x0b62c, 0x0a321},
+  {0x0b62d, 0x0a362}, {0x0b648, 0x0a321}, {0x0b649, 0x0a362}, {0x0b664, 0x0a321},
+  {0x0b665, 0x0a362}, {0x0b680, 0x0a321}, {0x0b681, 0x0a362}, {0x0b69c, 0x0a321},
+  {0x0b69d, 0x0a362}, {0x0b6b8, 0x0a321}, {0x0b6b9, 0x0a362}, {0x0b6d4, 0x0a321},
+  {0x0b6d5, 0x0a362}, {0x0b6f0, 0x0a321}, {0x0b6f1, 0x0a362}, {0x0b70c, 0x0a321},
+  {0x0b70d, 0x0a362}, {0x0b728, 0x0a321}, {0x0b729, 0x0a362}, {0x0b744, 0x0a321},
+  {0x0b745, 0x0a362}, {0x0b760, 0x0a321}, {0x0b761, 0x0a362}, {0x0b77c, 0x0a321},
+  {0x0b77d, 0x0a362}, {0x0b798, 0x0a321}, {0x0b799, 0x0a362}, {0x0b7b4, 0x0a321},
+  {0x0b7b5, 0x0a362}, {0x0b7d0, 0x0a321}, {0x0b7d1, 0x0a362}, {0x0b7ec, 0x0a321},
+  {0x0b7ed, 0x0a362}, {0x0b808, 0x0a321}, {0x0b809, 0x0a362}, {0x0b824, 0x0a321},
+  {0x0b825, 0x0a362}, {0x0b840, 0x0a321}, {0x0b841, 0x0a362}, {0x0b85c, 0x0a321},
+  {0x0b85d, 0x0a362}, {0x0b878, 0x0a321}, {0x0b879, 0x0a362}, {0x0b894, 0x0a321},
+  {0x0b895, 0x0a362}, {0x0b8b0, 0x0a321}, {0x0b8b1, 0x0a362}, {0x0b8cc, 0x0a321},
+  {0x0b8cd, 0x0a362}, {0x0b8e8, 0x0a321}, {0x0b8e9, 0x0a362}, {0x0b904, 0x0a321},
+  {0x0b905, 0x0a362}, {0x0b920, 0x0a321}, {0x0b921, 0x0a362}, {0x0b93c, 0x0a321},
+  {0x0b93d, 0x0a362}, {0x0b958, 0x0a321}, {0x0b959, 0x0a362}, {0x0b974, 0x0a321},
+  {0x0b975, 0x0a362}, {0x0b990, 0x0a321}, {0x0b991, 0x0a362}, {0x0b9ac, 0x0a321},
+  {0x0b9ad, 0x0a362}, {0x0b9c8, 0x0a321}, {0x0b9c9, 0x0a362}, {0x0b9e4, 0x0a321},
+  {0x0b9e5, 0x0a362}, {0x0ba00, 0x0a321}, {0x0ba01, 0x0a362}, {0x0ba1c, 0x0a321},
+  {0x0ba1d, 0x0a362}, {0x0ba38, 0x0a321}, {0x0ba39, 0x0a362}, {0x0ba54, 0x0a321},
+  {0x0ba55, 0x0a362}, {0x0ba70, 0x0a321}, {0x0ba71, 0x0a362}, {0x0ba8c, 0x0a321},
+  {0x0ba8d, 0x0a362}, {0x0baa8, 0x0a321}, {0x0baa9, 0x0a362}, {0x0bac4, 0x0a321},
+  {0x0bac5, 0x0a362}, {0x0bae0, 0x0a321}, {0x0bae1, 0x0a362}, {0x0bafc, 0x0a321},
+  {0x0bafd, 0x0a362}, {0x0bb18, 0x0a321}, {0x0bb19, 0x0a362}, {0x0bb34, 0x0a321},
+  {0x0bb35, 0x0a362}, {0x0bb50, 0x0a321}, {0x0bb51, 0x0a362}, {0x0bb6c, 0x0a321},
+  {0x0bb6d, 0x0a362}, {0x0bb88, 0x0a321}, {0x0bb89, 0x0a362}, {0x0bba4, 0x0a321},
+  {0x0bba5, 0x0a362}, {0x0bbc0, 0x0a321}, {0x0bbc1, 0x0a362}, {0x0bbdc, 0x0a321},
+  {0x0bbdd, 0x0a362}, {0x0bbf8, 0x0a321}, {0x0bbf9, 0x0a362}, {0x0bc14, 0x0a321},
+  {0x0bc15, 0x0a362}, {0x0bc30, 0x0a321}, {0x0bc31, 0x0a362}, {0x0bc4c, 0x0a321},
+  {0x0bc4d, 0x0a362}, {0x0bc68, 0x0a321}, {0x0bc69, 0x0a362}, {0x0bc84, 0x0a321},
+  {0x0bc85, 0x0a362}, {0x0bca0, 0x0a321}, {0x0bca1, 0x0a362}, {0x0bcbc, 0x0a321},
+  {0x0bcbd, 0x0a362}, {0x0bcd8, 0x0a321}, {0x0bcd9, 0x0a362}, {0x0bcf4, 0x0a321},
+  {0x0bcf5, 0x0a362}, {0x0bd10, 0x0a321}, {0x0bd11, 0x0a362}, {0x0bd2c, 0x0a321},
+  {0x0bd2d, 0x0a362}, {0x0bd48, 0x0a321}, {0x0bd49, 0x0a362}, {0x0bd64, 0x0a321},
+  {0x0bd65, 0x0a362}, {0x0bd80, 0x0a321}, {0x0bd81, 0x0a362}, {0x0bd9c, 0x0a321},
+  {0x0bd9d, 0x0a362}, {0x0bdb8, 0x0a321}, {0x0bdb9, 0x0a362}, {0x0bdd4, 0x0a321},
+  {0x0bdd5, 0x0a362}, {0x0bdf0, 0x0a321}, {0x0bdf1, 0x0a362}, {0x0be0c, 0x0a321},
+  {0x0be0d, 0x0a362}, {0x0be28, 0x0a321}, {0x0be29, 0x0a362}, {0x0be44, 0x0a321},
+  {0x0be45, 0x0a362}, {0x0be60, 0x0a321}, {0x0be61, 0x0a362}, {0x0be7c, 0x0a321},
+  {0x0be7d, 0x0a362}, {0x0be98, 0x0a321}, {0x0be99, 0x0a362}, {0x0beb4, 0x0a321},
+  {0x0beb5, 0x0a362}, {0x0bed0, 0x0a321}, {0x0bed1, 0x0a362}, {0x0beec, 0x0a321},
+  {0x0beed, 0x0a362}, {0x0bf08, 0x0a321}, {0x0bf09, 0x0a362}, {0x0bf24, 0x0a321},
+  {0x0bf25, 0x0a362}, {0x0bf40, 0x0a321}, {0x0bf41, 0x0a362}, {0x0bf5c, 0x0a321},
+  {0x0bf5d, 0x0a362}, {0x0bf78, 0x0a321}, {0x0bf79, 0x0a362}, {0x0bf94, 0x0a321},
+  {0x0bf95, 0x0a362}, {0x0bfb0, 0x0a321}, {0x0bfb1, 0x0a362}, {0x0bfcc, 0x0a321},
+  {0x0bfcd, 0x0a362}, {0x0bfe8, 0x0a321}, {0x0bfe9, 0x0a362}, {0x0c004, 0x0a321},
+  {0x0c005, 0x0a362}, {0x0c020, 0x0a321}, {0x0c021, 0x0a362}, {0x0c03c, 0x0a321},
+  {0x0c03d, 0x0a362}, {0x0c058, 0x0a321}, {0x0c059, 0x0a362}, {0x0c074, 0x0a321},
+  {0x0c075, 0x0a362}, {0x0c090, 0x0a321}, {0x0c091, 0x0a362}, {0x0c0ac, 0x0a321},
+  {0x0c0ad, 0x0a362}, {0x0c0c8, 0x0a321}, {0x0c0c9, 0x0a362}, {0x0c0e4, 0x0a321},
+  {0x0c0e5, 0x0a362}, {0x0c100, 0x0a321}, {0x0c101, 0x0a362}, {0x0c11c, 0x0a321},
+  {0x0c11d, 0x0a362}, {0x0c138, 0x0a321}, {0x0c139, 0x0a362}, {0x0c154, 0x0a321},
+  {0x0c155, 0x0a362}, {0x0c170, 0x0a321}, {0x0c171, 0x0a362}, {0x0c18c, 0x0a321},
+  {0x0c18d, 0x0a362}, {0x0c1a8, 0x0a321}, {0x0c1a9, 0x0a362}, {0x0c1c4, 0x0a321},
+  {0x0c1c5, 0x0a362}, {0x0c1e0, 0x0a321}, {0x0c1e1, 0x0a362}, {0x0c1fc, 0x0a321},
+  {0x0c1fd, 0x0a362}, {0x0c218, 0x0a321}, {0x0c219, 0x0a362}, {0x0c234, 0x0a321},
+  {0x0c235, 0x0a362}, {0x0c250, 0x0a321}, {0x0c251, 0x0a362}, {0x0c26c, 0x0a321},
+  {0x0c26d, 0x0a362}, {0x0c288, 0x0a321}, {0x0c289, 0x0a362}, {0x0c2a4, 0x0a321},
+  {0x0c2a5, 0x0a362}, {0x0c2c0, 0x0a321}, {0x0c2c1, 0x0a362}, {0x0c2dc, 0x0a321},
+  {0x0c2dd, 0x0a362}, {0x0c2f8, 0x0a321}, {0x0c2f9, 0x0a362}, {0x0c314, 0x0a321},
+  {0x0c315, 0x0a362}, {0x0c330, 0x0a321}, {0x0c331, 0x0a362}, {0x0c34c, 0x0a321},
+  {0x0c34d, 0x0a362}, {0x0c368, 0x0a321}, {0x0c369, 0x0a362}, {0x0c384, 0x0a321},
+  {0x0c385, 0x0a362}, {0x0c3a0, 0x0a321}, {0x0c3a1, 0x0a362}, {0x0c3bc, 0x0a321},
+  {0x0c3bd, 0x0a362}, {0x0c3d8, 0x0a321}, {0x0c3d9, 0x0a362}, {0x0c3f4, 0x0a321},
+  {0x0c3f5, 0x0a362}, {0x0c410, 0x0a321}, {0x0c411, 0x0a362}, {0x0c42c, 0x0a321},
+  {0x0c42d, 0x0a362}, {0x0c448, 0x0a321}, {0x0c449, 0x0a362}, {0x0c464, 0x0a321},
+  {0x0c465, 0x0a362}, {0x0c480, 0x0a321}, {0x0c481, 0x0a362}, {0x0c49c, 0x0a321},
+  {0x0c49d, 0x0a362}, {0x0c4b8, 0x0a321}, {0x0c4b9, 0x0a362}, {0x0c4d4, 0x0a321},
+  {0x0c4d5, 0x0a362}, {0x0c4f0, 0x0a321}, {0x0c4f1, 0x0a362}, {0x0c50c, 0x0a321},
+  {0x0c50d, 0x0a362}, {0x0c528, 0x0a321}, {0x0c529, 0x0a362}, {0x0c544, 0x0a321},
+  {0x0c545, 0x0a362}, {0x0c560, 0x0a321}, {0x0c561, 0x0a362}, {0x0c57c, 0x0a321},
+  {0x0c57d, 0x0a362}, {0x0c598, 0x0a321}, {0x0c599, 0x0a362}, {0x0c5b4, 0x0a321},
+  {0x0c5b5, 0x0a362}, {0x0c5d0, 0x0a321}, {0x0c5d1, 0x0a362}, {0x0c5ec, 0x0a321},
+  {0x0c5ed, 0x0a362}, {0x0c608, 0x0a321}, {0x0c609, 0x0a362}, {0x0c624, 0x0a321},
+  {0x0c625, 0x0a362}, {0x0c640, 0x0a321}, {0x0c641, 0x0a362}, {0x0c65c, 0x0a321},
+  {0x0c65d, 0x0a362}, {0x0c678, 0x0a321}, {0x0c679, 0x0a362}, {0x0c694, 0x0a321},
+  {0x0c695, 0x0a362}, {0x0c6b0, 0x0a321}, {0x0c6b1, 0x0a362}, {0x0c6cc, 0x0a321},
+  {0x0c6cd, 0x0a362}, {0x0c6e8, 0x0a321}, {0x0c6e9, 0x0a362}, {0x0c704, 0x0a321},
+  {0x0c705, 0x0a362}, {0x0c720, 0x0a321}, {0x0c721, 0x0a362}, {0x0c73c, 0x0a321},
+  {0x0c73d, 0x0a362}, {0x0c758, 0x0a321}, {0x0c759, 0x0a362}, {0x0c774, 0x0a321},
+  {0x0c775, 0x0a362}, {0x0c790, 0x0a321}, {0x0c791, 0x0a362}, {0x0c7ac, 0x0a321},
+  {0x0c7ad, 0x0a362}, {0x0c7c8, 0x0a321}, {0x0c7c9, 0x0a362}, {0x0c7e4, 0x0a321},
+  {0x0c7e5, 0x0a362}, {0x0c800, 0x0a321}, {0x0c801, 0x0a362}, {0x0c81c, 0x0a321},
+  {0x0c81d, 0x0a362}, {0x0c838, 0x0a321}, {0x0c839, 0x0a362}, {0x0c854, 0x0a321},
+  {0x0c855, 0x0a362}, {0x0c870, 0x0a321}, {0x0c871, 0x0a362}, {0x0c88c, 0x0a321},
+  {0x0c88d, 0x0a362}, {0x0c8a8, 0x0a321}, {0x0c8a9, 0x0a362}, {0x0c8c4, 0x0a321},
+  {0x0c8c5, 0x0a362}, {0x0c8e0, 0x0a321}, {0x0c8e1, 0x0a362}, {0x0c8fc, 0x0a321},
+  {0x0c8fd, 0x0a362}, {0x0c918, 0x0a321}, {0x0c919, 0x0a362}, {0x0c934, 0x0a321},
+  {0x0c935, 0x0a362}, {0x0c950, 0x0a321}, {0x0c951, 0x0a362}, {0x0c96c, 0x0a321},
+  {0x0c96d, 0x0a362}, {0x0c988, 0x0a321}, {0x0c989, 0x0a362}, {0x0c9a4, 0x0a321},
+  {0x0c9a5, 0x0a362}, {0x0c9c0, 0x0a321}, {0x0c9c1, 0x0a362}, {0x0c9dc, 0x0a321},
+  {0x0c9dd, 0x0a362}, {0x0c9f8, 0x0a321}, {0x0c9f9, 0x0a362}, {0x0ca14, 0x0a321},
+  {0x0ca15, 0x0a362}, {0x0ca30, 0x0a321}, {0x0ca31, 0x0a362}, {0x0ca4c, 0x0a321},
+  {0x0ca4d, 0x0a362}, {0x0ca68, 0x0a321}, {0x0ca69, 0x0a362}, {0x0ca84, 0x0a321},
+  {0x0ca85, 0x0a362}, {0x0caa0, 0x0a321}, {0x0caa1, 0x0a362}, {0x0cabc, 0x0a321},
+  {0x0cabd, 0x0a362}, {0x0cad8, 0x0a321}, {0x0cad9, 0x0a362}, {0x0caf4, 0x0a321},
+  {0x0caf5, 0x0a362}, {0x0cb10, 0x0a321}, {0x0cb11, 0x0a362}, {0x0cb2c, 0x0a321},
+  {0x0cb2d, 0x0a362}, {0x0cb48, 0x0a321}, {0x0cb49, 0x0a362}, {0x0cb64, 0x0a321},
+  {0x0cb65, 0x0a362}, {0x0cb80, 0x0a321}, {0x0cb81, 0x0a362}, {0x0cb9c, 0x0a321},
+  {0x0cb9d, 0x0a362}, {0x0cbb8, 0x0a321}, {0x0cbb9, 0x0a362}, {0x0cbd4, 0x0a321},
+  {0x0cbd5, 0x0a362}, {0x0cbf0, 0x0a321}, {0x0cbf1, 0x0a362}, {0x0cc0c, 0x0a321},
+  {0x0cc0d, 0x0a362}, {0x0cc28, 0x0a321}, {0x0cc29, 0x0a362}, {0x0cc44, 0x0a321},
+  {0x0cc45, 0x0a362}, {0x0cc60, 0x0a321}, {0x0cc61, 0x0a362}, {0x0cc7c, 0x0a321},
+  {0x0cc7d, 0x0a362}, {0x0cc98, 0x0a321}, {0x0cc99, 0x0a362}, {0x0ccb4, 0x0a321},
+  {0x0ccb5, 0x0a362}, {0x0ccd0, 0x0a321}, {0x0ccd1, 0x0a362}, {0x0ccec, 0x0a321},
+  {0x0cced, 0x0a362}, {0x0cd08, 0x0a321}, {0x0cd09, 0x0a362}, {0x0cd24, 0x0a321},
+  {0x0cd25, 0x0a362}, {0x0cd40, 0x0a321}, {0x0cd41, 0x0a362}, {0x0cd5c, 0x0a321},
+  {0x0cd5d, 0x0a362}, {0x0cd78, 0x0a321}, {0x0cd79, 0x0a362}, {0x0cd94, 0x0a321},
+  {0x0cd95, 0x0a362}, {0x0cdb0, 0x0a321}, {0x0cdb1, 0x0a362}, {0x0cdcc, 0x0a321},
+  {0x0cdcd, 0x0a362}, {0x0cde8, 0x0a321}, {0x0cde9, 0x0a362}, {0x0ce04, 0x0a321},
+  {0x0ce05, 0x0a362}, {0x0ce20, 0x0a321}, {0x0ce21, 0x0a362}, {0x0ce3c, 0x0a321},
+  {0x0ce3d, 0x0a362}, {0x0ce58, 0x0a321}, {0x0ce59, 0x0a362}, {0x0ce74, 0x0a321},
+  {0x0ce75, 0x0a362}, {0x0ce90, 0x0a321}, {0x0ce91, 0x0a362}, {0x0ceac, 0x0a321},
+  {0x0cead, 0x0a362}, {0x0cec8, 0x0a321}, {0x0cec9, 0x0a362}, {0x0cee4, 0x0a321},
+  {0x0cee5, 0x0a362}, {0x0cf00, 0x0a321}, {0x0cf01, 0x0a362}, {0x0cf1c, 0x0a321},
+  {0x0cf1d, 0x0a362}, {0x0cf38, 0x0a321}, {0x0cf39, 0x0a362}, {0x0cf54, 0x0a321},
+  {0x0cf55, 0x0a362}, {0x0cf70, 0x0a321}, {0x0cf71, 0x0a362}, {0x0cf8c, 0x0a321},
+  {0x0cf8d, 0x0a362}, {0x0cfa8, 0x0a321}, {0x0cfa9, 0x0a362}, {0x0cfc4, 0x0a321},
+  {0x0cfc5, 0x0a362}, {0x0cfe0, 0x0a321}, {0x0cfe1, 0x0a362}, {0x0cffc, 0x0a321},
+  {0x0cffd, 0x0a362}, {0x0d018, 0x0a321}, {0x0d019, 0x0a362}, {0x0d034, 0x0a321},
+  {0x0d035, 0x0a362}, {0x0d050, 0x0a321}, {0x0d051, 0x0a362}, {0x0d06c, 0x0a321},
+  {0x0d06d, 0x0a362}, {0x0d088, 0x0a321}, {0x0d089, 0x0a362}, {0x0d0a4, 0x0a321},
+  {0x0d0a5, 0x0a362}, {0x0d0c0, 0x0a321}, {0x0d0c1, 0x0a362}, {0x0d0dc, 0x0a321},
+  {0x0d0dd, 0x0a362}, {0x0d0f8, 0x0a321}, {0x0d0f9, 0x0a362}, {0x0d114, 0x0a321},
+  {0x0d115, 0x0a362}, {0x0d130, 0x0a321}, {0x0d131, 0x0a362}, {0x0d14c, 0x0a321},
+  {0x0d14d, 0x0a362}, {0x0d168, 0x0a321}, {0x0d169, 0x0a362}, {0x0d184, 0x0a321},
+  {0x0d185, 0x0a362}, {0x0d1a0, 0x0a321}, {0x0d1a1, 0x0a362}, {0x0d1bc, 0x0a321},
+  {0x0d1bd, 0x0a362}, {0x0d1d8, 0x0a321}, {0x0d1d9, 0x0a362}, {0x0d1f4, 0x0a321},
+  {0x0d1f5, 0x0a362}, {0x0d210, 0x0a321}, {0x0d211, 0x0a362}, {0x0d22c, 0x0a321},
+  {0x0d22d, 0x0a362}, {0x0d248, 0x0a321}, {0x0d249, 0x0a362}, {0x0d264, 0x0a321},
+  {0x0d265, 0x0a362}, {0x0d280, 0x0a321}, {0x0d281, 0x0a362}, {0x0d29c, 0x0a321},
+  {0x0d29d, 0x0a362}, {0x0d2b8, 0x0a321}, {0x0d2b9, 0x0a362}, {0x0d2d4, 0x0a321},
+  {0x0d2d5, 0x0a362}, {0x0d2f0, 0x0a321}, {0x0d2f1, 0x0a362}, {0x0d30c, 0x0a321},
+  {0x0d30d, 0x0a362}, {0x0d328, 0x0a321}, {0x0d329, 0x0a362}, {0x0d344, 0x0a321},
+  {0x0d345, 0x0a362}, {0x0d360, 0x0a321}, {0x0d361, 0x0a362}, {0x0d37c, 0x0a321},
+  {0x0d37d, 0x0a362}, {0x0d398, 0x0a321}, {0x0d399, 0x0a362}, {0x0d3b4, 0x0a321},
+  {0x0d3b5, 0x0a362}, {0x0d3d0, 0x0a321}, {0x0d3d1, 0x0a362}, {0x0d3ec, 0x0a321},
+  {0x0d3ed, 0x0a362}, {0x0d408, 0x0a321}, {0x0d409, 0x0a362}, {0x0d424, 0x0a321},
+  {0x0d425, 0x0a362}, {0x0d440, 0x0a321}, {0x0d441, 0x0a362}, {0x0d45c, 0x0a321},
+  {0x0d45d, 0x0a362}, {0x0d478, 0x0a321}, {0x0d479, 0x0a362}, {0x0d494, 0x0a321},
+  {0x0d495, 0x0a362}, {0x0d4b0, 0x0a321}, {0x0d4b1, 0x0a362}, {0x0d4cc, 0x0a321},
+  {0x0d4cd, 0x0a362}, {0x0d4e8, 0x0a321}, {0x0d4e9, 0x0a362}, {0x0d504, 0x0a321},
+  {0x0d505, 0x0a362}, {0x0d520, 0x0a321}, {0x0d521, 0x0a362}, {0x0d53c, 0x0a321},
+  {0x0d53d, 0x0a362}, {0x0d558, 0x0a321}, {0x0d559, 0x0a362}, {0x0d574, 0x0a321},
+  {0x0d575, 0x0a362}, {0x0d590, 0x0a321}, {0x0d591, 0x0a362}, {0x0d5ac, 0x0a321},
+  {0x0d5ad, 0x0a362}, {0x0d5c8, 0x0a321}, {0x0d5c9, 0x0a362}, {0x0d5e4, 0x0a321},
+  {0x0d5e5, 0x0a362}, {0x0d600, 0x0a321}, {0x0d601, 0x0a362}, {0x0d61c, 0x0a321},
+  {0x0d61d, 0x0a362}, {0x0d638, 0x0a321}, {0x0d639, 0x0a362}, {0x0d654, 0x0a321},
+  {0x0d655, 0x0a362}, {0x0d670, 0x0a321}, {0x0d671, 0x0a362}, {0x0d68c, 0x0a321},
+  {0x0d68d, 0x0a362}, {0x0d6a8, 0x0a321}, {0x0d6a9, 0x0a362}, {0x0d6c4, 0x0a321},
+  {0x0d6c5, 0x0a362}, {0x0d6e0, 0x0a321}, {0x0d6e1, 0x0a362}, {0x0d6fc, 0x0a321},
+  {0x0d6fd, 0x0a362}, {0x0d718, 0x0a321}, {0x0d719, 0x0a362}, {0x0d734, 0x0a321},
+  {0x0d735, 0x0a362}, {0x0d750, 0x0a321}, {0x0d751, 0x0a362}, {0x0d76c, 0x0a321},
+  {0x0d76d, 0x0a362}, {0x0d788, 0x0a321}, {0x0d789, 0x0a362}, {0x0d7a4, 0x1102a},
+  {0x0d7b0, 0x002a6}, {0x0d7c7, 0x1102a}, {0x0d7cb, 0x002e7}, {0x0d7fc, 0x1102a},
+  {0x0d800, 0x01005}, {0x0e000, 0x0102a}, {0x0f900, 0x0a024}, {0x0fa6e, 0x1a024},
+  {0x0fa70, 0x0a024}, {0x0fada, 0x1a024}, {0x0fb00, 0x0101d}, {0x0fb07, 0x1102a},
+  {0x0fb13, 0x0101d}, {0x0fb18, 0x1102a}, {0x0fb1d, 0x01023}, {0x0fb1e, 0x00103},
+  {0x0fb1f, 0x01023}, {0x0fb29, 0x0101d}, {0x0fb2a, 0x01023}, {0x0fb37, 0x1102a},
+  {0x0fb38, 0x01023}, {0x0fb3d, 0x1102a}, {0x0fb3e, 0x01023}, {0x0fb3f, 0x1102a},
+  {0x0fb40, 0x01023}, {0x0fb42, 0x1102a}, {0x0fb43, 0x01023}, {0x0fb45, 0x1102a},
+  {0x0fb46, 0x01023}, {0x0fb50, 0x0101d}, {0x0fbc3, 0x1102a}, {0x0fbd3, 0x0101d},
+  {0x0fd3e, 0x01010}, {0x0fd3f, 0x01015}, {0x0fd40, 0x0101d}, {0x0fd90, 0x1102a},
+  {0x0fd92, 0x0101d}, {0x0fdc8, 0x1102a}, {0x0fdcf, 0x0101d}, {0x0fdd0, 0x1102a},
+  {0x0fdf0, 0x0101d}, {0x0fdfc, 0x01019}, {0x0fdfd, 0x0101d}, {0x0fe00, 0x00103},
+  {0x0fe10, 0x0a017}, {0x0fe11, 0x0a010}, {0x0fe13, 0x0a017}, {0x0fe15, 0x0a012},
+  {0x0fe17, 0x0a015}, {0x0fe18, 0x0a010}, {0x0fe19, 0x0a013}, {0x0fe1a, 0x1102a},
+  {0x0fe20, 0x00103}, {0x0fe30, 0x0a024}, {0x0fe35, 0x0a015}, {0x0fe36, 0x0a010},
+  {0x0fe37, 0x0a015}, {0x0fe38, 0x0a010}, {0x0fe39, 0x0a015}, {0x0fe3a, 0x0a010},
+  {0x0fe3b, 0x0a015}, {0x0fe3c, 0x0a010}, {0x0fe3d, 0x0a015}, {0x0fe3e, 0x0a010},
+  {0x0fe3f, 0x0a015}, {0x0fe40, 0x0a010}, {0x0fe41, 0x0a015}, {0x0fe42, 0x0a010},
+  {0x0fe43, 0x0a015}, {0x0fe44, 0x0a010}, {0x0fe45, 0x0a024}, {0x0fe47, 0x0a015},
+  {0x0fe48, 0x0a010}, {0x0fe49, 0x0a024}, {0x0fe50, 0x0a010}, {0x0fe51, 0x0a024},
+  {0x0fe52, 0x0a010}, {0x0fe53, 0x1102a}, {0x0fe54, 0x0a014}, {0x0fe56, 0x0a012},
+  {0x0fe58, 0x0a024}, {0x0fe59, 0x0a015}, {0x0fe5a, 0x0a010}, {0x0fe5b, 0x0a015},
+  {0x0fe5c, 0x0a010}, {0x0fe5d, 0x0a015}, {0x0fe5e, 0x0a010}, {0x0fe5f, 0x0a024},
+  {0x0fe67, 0x1102a}, {0x0fe68, 0x0a024}, {0x0fe69, 0x0a01a}, {0x0fe6a, 0x0a019},
+  {0x0fe6b, 0x0a024}, {0x0fe6c, 0x1102a}, {0x0fe70, 0x0101d}, {0x0fe75, 0x1102a},
+  {0x0fe76, 0x0101d}, {0x0fefd, 0x1102a}, {0x0feff, 0x000c6}, {0x0ff00, 0x1102a},
+  {0x0ff01, 0x0a012}, {0x0ff02, 0x0a024}, {0x0ff04, 0x0a01a}, {0x0ff05, 0x0a019},
+  {0x0ff06, 0x0a024}, {0x0ff08, 0x0a015}, {0x0ff09, 0x0a010}, {0x0ff0a, 0x0a024},
+  {0x0ff0c, 0x0a010}, {0x0ff0d, 0x0a024}, {0x0ff0e, 0x0a010}, {0x0ff0f, 0x0a024},
+  {0x0ff1a, 0x0a014}, {0x0ff1c, 0x0a024}, {0x0ff1f, 0x0a012}, {0x0ff20, 0x0a024},
+  {0x0ff3b, 0x0a015}, {0x0ff3c, 0x0a024}, {0x0ff3d, 0x0a010}, {0x0ff3e, 0x0a024},
+  {0x0ff5b, 0x0a015}, {0x0ff5c, 0x0a024}, {0x0ff5d, 0x0a010}, {0x0ff5e, 0x0a024},
+  {0x0ff5f, 0x0a015}, {0x0ff60, 0x0a010}, {0x0ff61, 0x09010}, {0x0ff62, 0x09015},
+  {0x0ff63, 0x09010}, {0x0ff65, 0x09014}, {0x0ff66, 0x09024}, {0x0ff67, 0x0901e},
+  {0x0ff71, 0x09024}, {0x0ff9e, 0x09114}, {0x0ffa0, 0x09024}, {0x0ffbf, 0x1102a},
+  {0x0ffc2, 0x09024}, {0x0ffc8, 0x1102a}, {0x0ffca, 0x09024}, {0x0ffd0, 0x1102a},
+  {0x0ffd2, 0x09024}, {0x0ffd8, 0x1102a}, {0x0ffda, 0x09024}, {0x0ffdd, 0x1102a},
+  {0x0ffe0, 0x0a019}, {0x0ffe1, 0x0a01a}, {0x0ffe2, 0x0a024}, {0x0ffe5, 0x0a01a},
+  {0x0ffe7, 0x1102a}, {0x0ffe8, 0x0901d}, {0x0ffef, 0x1102a}, {0x0fff0, 0x110ea},
+  {0x0fff9, 0x000c3}, {0x0fffc, 0x0100f}, {0x0fffd, 0x0101c}, {0x0fffe, 0x1102a},
+  {0x10000, 0x0101d}, {0x1000c, 0x1102a}, {0x1000d, 0x0101d}, {0x10027, 0x1102a},
+  {0x10028, 0x0101d}, {0x1003b, 0x1102a}, {0x1003c, 0x0101d}, {0x1003e, 0x1102a},
+  {0x1003f, 0x0101d}, {0x1004e, 0x1102a}, {0x10050, 0x0101d}, {0x1005e, 0x1102a},
+  {0x10080, 0x0101d}, {0x100fb, 0x1102a}, {0x10100, 0x0100c}, {0x10103, 0x1102a},
+  {0x10107, 0x0101d}, {0x10134, 0x1102a}, {0x10137, 0x0101d}, {0x1018f, 0x1102a},
+  {0x10190, 0x0101d}, {0x1019d, 0x1102a}, {0x101a0, 0x0101d}, {0x101a1, 0x1102a},
+  {0x101d0, 0x0101d}, {0x101fd, 0x00103}, {0x101fe, 0x1102a}, {0x10280, 0x0101d},
+  {0x1029d, 0x1102a}, {0x102a0, 0x0101d}, {0x102d1, 0x1102a}, {0x102e0, 0x00103},
+  {0x102e1, 0x0101d}, {0x102fc, 0x1102a}, {0x10300, 0x0101d}, {0x10324, 0x1102a},
+  {0x1032d, 0x0101d}, {0x1034b, 0x1102a}, {0x10350, 0x0101d}, {0x10376, 0x00103},
+  {0x1037b, 0x1102a}, {0x10380, 0x0101d}, {0x1039e, 0x1102a}, {0x1039f, 0x0100c},
+  {0x103a0, 0x0101d}, {0x103c4, 0x1102a}, {0x103c8, 0x0101d}, {0x103d0, 0x0100c},
+  {0x103d1, 0x0101d}, {0x103d6, 0x1102a}, {0x10400, 0x0101d}, {0x1049e, 0x1102a},
+  {0x104a0, 0x01018}, {0x104aa, 0x1102a}, {0x104b0, 0x0101d}, {0x104d4, 0x1102a},
+  {0x104d8, 0x0101d}, {0x104fc, 0x1102a}, {0x10500, 0x0101d}, {0x10528, 0x1102a},
+  {0x10530, 0x0101d}, {0x10564, 0x1102a}, {0x1056f, 0x0101d}, {0x1057b, 0x1102a},
+  {0x1057c, 0x0101d}, {0x1058b, 0x1102a}, {0x1058c, 0x0101d}, {0x10593, 0x1102a},
+  {0x10594, 0x0101d}, {0x10596, 0x1102a}, {0x10597, 0x0101d}, {0x105a2, 0x1102a},
+  {0x105a3, 0x0101d}, {0x105b2, 0x1102a}, {0x105b3, 0x0101d}, {0x105ba, 0x1102a},
+  {0x105bb, 0x0101d}, {0x105bd, 0x1102a}, {0x10600, 0x0101d}, {0x10737, 0x1102a},
+  {0x10740, 0x0101d}, {0x10756, 0x1102a}, {0x10760, 0x0101d}, {0x10768, 0x1102a},
+  {0x10780, 0x0101d}, {0x10786, 0x1102a}, {0x10787, 0x0101d}, {0x107b1, 0x1102a},
+  {0x107b2, 0x0101d}, {0x107bb, 0x1102a}, {0x10800, 0x0101d}, {0x10806, 0x1102a},
+  {0x10808, 0x0101d}, {0x10809, 0x1102a}, {0x1080a, 0x0101d}, {0x10836, 0x1102a},
+  {0x10837, 0x0101d}, {0x10839, 0x1102a}, {0x1083c, 0x0101d}, {0x1083d, 0x1102a},
+  {0x1083f, 0x0101d}, {0x10856, 0x1102a}, {0x10857, 0x0100c}, {0x10858, 0x0101d},
+  {0x1089f, 0x1102a}, {0x108a7, 0x0101d}, {0x108b0, 0x1102a}, {0x108e0, 0x0101d},
+  {0x108f3, 0x1102a}, {0x108f4, 0x0101d}, {0x108f6, 0x1102a}, {0x108fb, 0x0101d},
+  {0x1091c, 0x1102a}, {0x1091f, 0x0100c}, {0x10920, 0x0101d}, {0x1093a, 0x1102a},
+  {0x1093f, 0x0101d}, {0x10940, 0x1102a}, {0x10980, 0x0101d}, {0x109b8, 0x1102a},
+  {0x109bc, 0x0101d}, {0x109d0, 0x1102a}, {0x109d2, 0x0101d}, {0x10a01, 0x00103},
+  {0x10a04, 0x1102a}, {0x10a05, 0x00103}, {0x10a07, 0x1102a}, {0x10a0c, 0x00103},
+  {0x10a10, 0x0101d}, {0x10a14, 0x1102a}, {0x10a15, 0x0101d}, {0x10a18, 0x1102a},
+  {0x10a19, 0x0101d}, {0x10a36, 0x1102a}, {0x10a38, 0x00103}, {0x10a3b, 0x1102a},
+  {0x10a3f, 0x00103}, {0x10a40, 0x0101d}, {0x10a49, 0x1102a}, {0x10a50, 0x0100c},
+  {0x10a58, 0x0101d}, {0x10a59, 0x1102a}, {0x10a60, 0x0101d}, {0x10aa0, 0x1102a},
+  {0x10ac0, 0x0101d}, {0x10ae5, 0x00103}, {0x10ae7, 0x1102a}, {0x10aeb, 0x0101d},
+  {0x10af0, 0x0100c}, {0x10af6, 0x01013}, {0x10af7, 0x1102a}, {0x10b00, 0x0101d},
+  {0x10b36, 0x1102a}, {0x10b39, 0x0100c}, {0x10b40, 0x0101d}, {0x10b56, 0x1102a},
+  {0x10b58, 0x0101d}, {0x10b73, 0x1102a}, {0x10b78, 0x0101d}, {0x10b92, 0x1102a},
+  {0x10b99, 0x0101d}, {0x10b9d, 0x1102a}, {0x10ba9, 0x0101d}, {0x10bb0, 0x1102a},
+  {0x10c00, 0x0101d}, {0x10c49, 0x1102a}, {0x10c80, 0x0101d}, {0x10cb3, 0x1102a},
+  {0x10cc0, 0x0101d}, {0x10cf3, 0x1102a}, {0x10cfa, 0x0101d}, {0x10d24, 0x00103},
+  {0x10d28, 0x1102a}, {0x10d30, 0x01018}, {0x10d3a, 0x1102a}, {0x10e60, 0x0101d},
+  {0x10e7f, 0x1102a}, {0x10e80, 0x0101d}, {0x10eaa, 0x1102a}, {0x10eab, 0x00103},
+  {0x10ead, 0x0100c}, {0x10eae, 0x1102a}, {0x10eb0, 0x0101d}, {0x10eb2, 0x1102a},
+  {0x10efd, 0x00103}, {0x10f00, 0x0101d}, {0x10f28, 0x1102a}, {0x10f30, 0x0101d},
+  {0x10f46, 0x00103}, {0x10f51, 0x0101d}, {0x10f5a, 0x1102a}, {0x10f70, 0x0101d},
+  {0x10f82, 0x00103}, {0x10f86, 0x0101d}, {0x10f8a, 0x1102a}, {0x10fb0, 0x0101d},
+  {0x10fcc, 0x1102a}, {0x10fe0, 0x0101d}, {0x10ff7, 0x1102a}, {0x11000, 0x01203},
+  {0x11001, 0x00103}, {0x11002, 0x01203}, {0x11003, 0x0101d}, {0x11038, 0x00103},
+  {0x11047, 0x0100c}, {0x11049, 0x0101d}, {0x1104e, 0x1102a}, {0x11052, 0x0101d},
+  {0x11066, 0x01018}, {0x11070, 0x00103}, {0x11071, 0x0101d}, {0x11073, 0x00103},
+  {0x11075, 0x0101d}, {0x11076, 0x1102a}, {0x1107f, 0x00103}, {0x11082, 0x01203},
+  {0x11083, 0x0101d}, {0x110b0, 0x01203}, {0x110b3, 0x00103}, {0x110b7, 0x01203},
+  {0x110b9, 0x00103}, {0x110bb, 0x0101d}, {0x110bd, 0x001dd}, {0x110be, 0x0100c},
+  {0x110c2, 0x00103}, {0x110c3, 0x1102a}, {0x110cd, 0x001dd}, {0x110ce, 0x1102a},
+  {0x110d0, 0x0101d}, {0x110e9, 0x1102a}, {0x110f0, 0x01018}, {0x110fa, 0x1102a},
+  {0x11100, 0x00103}, {0x11103, 0x0101d}, {0x11127, 0x00103}, {0x1112c, 0x01203},
+  {0x1112d, 0x00103}, {0x11135, 0x1102a}, {0x11136, 0x01018}, {0x11140, 0x0100c},
+  {0x11144, 0x0101d}, {0x11145, 0x01203}, {0x11147, 0x0101d}, {0x11148, 0x1102a},
+  {0x11150, 0x0101d}, {0x11173, 0x00103}, {0x11174, 0x0101d}, {0x11175, 0x0100d},
+  {0x11176, 0x0101d}, {0x11177, 0x1102a}, {0x11180, 0x00103}, {0x11182, 0x01203},
+  {0x11183, 0x0101d}, {0x111b3, 0x01203}, {0x111b6, 0x00103}, {0x111bf, 0x01203},
+  {0x111c1, 0x0101d}, {0x111c2, 0x011dd}, {0x111c4, 0x0101d}, {0x111c5, 0x0100c},
+  {0x111c7, 0x0101d}, {0x111c8, 0x0100c}, {0x111c9, 0x00103}, {0x111cd, 0x0101d},
+  {0x111ce, 0x01203}, {0x111cf, 0x00103}, {0x111d0, 0x01018}, {0x111da, 0x0101d},
+  {0x111db, 0x0100d}, {0x111dc, 0x0101d}, {0x111dd, 0x0100c}, {0x111e0, 0x1102a},
+  {0x111e1, 0x0101d}, {0x111f5, 0x1102a}, {0x11200, 0x0101d}, {0x11212, 0x1102a},
+  {0x11213, 0x0101d}, {0x1122c, 0x01203}, {0x1122f, 0x00103}, {0x11232, 0x01203},
+  {0x11234, 0x00103}, {0x11235, 0x01203}, {0x11236, 0x00103}, {0x11238, 0x0100c},
+  {0x1123a, 0x0101d}, {0x1123b, 0x0100c}, {0x1123d, 0x0101d}, {0x1123e, 0x00103},
+  {0x1123f, 0x0101d}, {0x11241, 0x00103}, {0x11242, 0x1102a}, {0x11280, 0x0101d},
+  {0x11287, 0x1102a}, {0x11288, 0x0101d}, {0x11289, 0x1102a}, {0x1128a, 0x0101d},
+  {0x1128e, 0x1102a}, {0x1128f, 0x0101d}, {0x1129e, 0x1102a}, {0x1129f, 0x0101d},
+  {0x112a9, 0x0100c}, {0x112aa, 0x1102a}, {0x112b0, 0x0101d}, {0x112df, 0x00103},
+  {0x112e0, 0x01203}, {0x112e3, 0x00103}, {0x112eb, 0x1102a}, {0x112f0, 0x01018},
+  {0x112fa, 0x1102a}, {0x11300, 0x00103}, {0x11302, 0x01203}, {0x11304, 0x1102a},
+  {0x11305, 0x0101d}, {0x1130d, 0x1102a}, {0x1130f, 0x0101d}, {0x11311, 0x1102a},
+  {0x11313, 0x0101d}, {0x11329, 0x1102a}, {0x1132a, 0x0101d}, {0x11331, 0x1102a},
+  {0x11332, 0x0101d}, {0x11334, 0x1102a}, {0x11335, 0x0101d}, {0x1133a, 0x1102a},
+  {0x1133b, 0x00103}, {0x1133d, 0x0101d}, {0x1133e, 0x01103}, {0x1133f, 0x01203},
+  {0x11340, 0x00103}, {0x11341, 0x01203}, {0x11345, 0x1102a}, {0x11347, 0x01203},
+  {0x11349, 0x1102a}, {0x1134b, 0x01203}, {0x1134e, 0x1102a}, {0x11350, 0x0101d},
+  {0x11351, 0x1102a}, {0x11357, 0x01103}, {0x11358, 0x1102a}, {0x1135d, 0x0101d},
+  {0x11362, 0x01203}, {0x11364, 0x1102a}, {0x11366, 0x00103}, {0x1136d, 0x1102a},
+  {0x11370, 0x00103}, {0x11375, 0x1102a}, {0x11400, 0x0101d}, {0x11435, 0x01203},
+  {0x11438, 0x00103}, {0x11440, 0x01203}, {0x11442, 0x00103}, {0x11445, 0x01203},
+  {0x11446, 0x00103}, {0x11447, 0x0101d}, {0x1144b, 0x0100c}, {0x1144f, 0x0101d},
+  {0x11450, 0x01018}, {0x1145a, 0x0100c}, {0x1145c, 0x1102a}, {0x1145d, 0x0101d},
+  {0x1145e, 0x00103}, {0x1145f, 0x0101d}, {0x11462, 0x1102a}, {0x11480, 0x0101d},
+  {0x114b0, 0x01103}, {0x114b1, 0x01203}, {0x114b3, 0x00103}, {0x114b9, 0x01203},
+  {0x114ba, 0x00103}, {0x114bb, 0x01203}, {0x114bd, 0x01103}, {0x114be, 0x01203},
+  {0x114bf, 0x00103}, {0x114c1, 0x01203}, {0x114c2, 0x00103}, {0x114c4, 0x0101d},
+  {0x114c8, 0x1102a}, {0x114d0, 0x01018}, {0x114da, 0x1102a}, {0x11580, 0x0101d},
+  {0x115af, 0x01103}, {0x115b0, 0x01203}, {0x115b2, 0x00103}, {0x115b6, 0x1102a},
+  {0x115b8, 0x01203}, {0x115bc, 0x00103}, {0x115be, 0x01203}, {0x115bf, 0x00103},
+  {0x115c1, 0x0100d}, {0x115c2, 0x0100c}, {0x115c4, 0x01012}, {0x115c6, 0x0101d},
+  {0x115c9, 0x0100c}, {0x115d8, 0x0101d}, {0x115dc, 0x00103}, {0x115de, 0x1102a},
+  {0x11600, 0x0101d}, {0x11630, 0x01203}, {0x11633, 0x00103}, {0x1163b, 0x01203},
+  {0x1163d, 0x00103}, {0x1163e, 0x01203}, {0x1163f, 0x00103}, {0x11641, 0x0100c},
+  {0x11643, 0x0101d}, {0x11645, 0x1102a}, {0x11650, 0x01018}, {0x1165a, 0x1102a},
+  {0x11660, 0x0100d}, {0x1166d, 0x1102a}, {0x11680, 0x0101d}, {0x116ab, 0x00103},
+  {0x116ac, 0x01203}, {0x116ad, 0x00103}, {0x116ae, 0x01203}, {0x116b0, 0x00103},
+  {0x116b6, 0x01203}, {0x116b7, 0x00103}, {0x116b8, 0x0101d}, {0x116ba, 0x1102a},
+  {0x116c0, 0x01018}, {0x116ca, 0x1102a}, {0x11700, 0x01029}, {0x1171b, 0x1102a},
+  {0x1171d, 0x00129}, {0x11720, 0x01029}, {0x11722, 0x00129}, {0x11726, 0x01229},
+  {0x11727, 0x00129}, {0x1172c, 0x1102a}, {0x11730, 0x01018}, {0x1173a, 0x01029},
+  {0x1173c, 0x0100c}, {0x1173f, 0x01029}, {0x11747, 0x1102a}, {0x11800, 0x0101d},
+  {0x1182c, 0x01203}, {0x1182f, 0x00103}, {0x11838, 0x01203}, {0x11839, 0x00103},
+  {0x1183b, 0x0101d}, {0x1183c, 0x1102a}, {0x118a0, 0x0101d}, {0x118e0, 0x01018},
+  {0x118ea, 0x0101d}, {0x118f3, 0x1102a}, {0x118ff, 0x0101d}, {0x11907, 0x1102a},
+  {0x11909, 0x0101d}, {0x1190a, 0x1102a}, {0x1190c, 0x0101d}, {0x11914, 0x1102a},
+  {0x11915, 0x0101d}, {0x11917, 0x1102a}, {0x11918, 0x0101d}, {0x11930, 0x01103},
+  {0x11931, 0x01203}, {0x11936, 0x1102a}, {0x11937, 0x01203}, {0x11939, 0x1102a},
+  {0x1193b, 0x00103}, {0x1193d, 0x01203}, {0x1193e, 0x00103}, {0x1193f, 0x011dd},
+  {0x11940, 0x01203}, {0x11941, 0x011dd}, {0x11942, 0x01203}, {0x11943, 0x00103},
+  {0x11944, 0x0100c}, {0x11947, 0x1102a}, {0x11950, 0x01018}, {0x1195a, 0x1102a},
+  {0x119a0, 0x0101d}, {0x119a8, 0x1102a}, {0x119aa, 0x0101d}, {0x119d1, 0x01203},
+  {0x119d4, 0x00103}, {0x119d8, 0x1102a}, {0x119da, 0x00103}, {0x119dc, 0x01203},
+  {0x119e0, 0x00103}, {0x119e1, 0x0101d}, {0x119e2, 0x0100d}, {0x119e3, 0x0101d},
+  {0x119e4, 0x01203}, {0x119e5, 0x1102a}, {0x11a00, 0x0101d}, {0x11a01, 0x00103},
+  {0x11a0b, 0x0101d}, {0x11a33, 0x00103}, {0x11a39, 0x01203}, {0x11a3a, 0x011dd},
+  {0x11a3b, 0x00103}, {0x11a3f, 0x0100d}, {0x11a40, 0x0101d}, {0x11a41, 0x0100c},
+  {0x11a45, 0x0100d}, {0x11a46, 0x0101d}, {0x11a47, 0x00103}, {0x11a48, 0x1102a},
+  {0x11a50, 0x0101d}, {0x11a51, 0x00103}, {0x11a57, 0x01203}, {0x11a59, 0x00103},
+  {0x11a5c, 0x0101d}, {0x11a84, 0x011dd}, {0x11a8a, 0x00103}, {0x11a97, 0x01203},
+  {0x11a98, 0x00103}, {0x11a9a, 0x0100c}, {0x11a9d, 0x0101d}, {0x11a9e, 0x0100d},
+  {0x11aa1, 0x0100c}, {0x11aa3, 0x1102a}, {0x11ab0, 0x0101d}, {0x11af9, 0x1102a},
+  {0x11b00, 0x0100d}, {0x11b0a, 0x1102a}, {0x11c00, 0x0101d}, {0x11c09, 0x1102a},
+  {0x11c0a, 0x0101d}, {0x11c2f, 0x01203}, {0x11c30, 0x00103}, {0x11c37, 0x1102a},
+  {0x11c38, 0x00103}, {0x11c3e, 0x01203}, {0x11c3f, 0x00103}, {0x11c40, 0x0101d},
+  {0x11c41, 0x0100c}, {0x11c46, 0x1102a}, {0x11c50, 0x01018}, {0x11c5a, 0x0101d},
+  {0x11c6d, 0x1102a}, {0x11c70, 0x0100d}, {0x11c71, 0x01012}, {0x11c72, 0x0101d},
+  {0x11c90, 0x1102a}, {0x11c92, 0x00103}, {0x11ca8, 0x1102a}, {0x11ca9, 0x01203},
+  {0x11caa, 0x00103}, {0x11cb1, 0x01203}, {0x11cb2, 0x00103}, {0x11cb4, 0x01203},
+  {0x11cb5, 0x00103}, {0x11cb7, 0x1102a}, {0x11d00, 0x0101d}, {0x11d07, 0x1102a},
+  {0x11d08, 0x0101d}, {0x11d0a, 0x1102a}, {0x11d0b, 0x0101d}, {0x11d31, 0x00103},
+  {0x11d37, 0x1102a}, {0x11d3a, 0x00103}, {0x11d3b, 0x1102a}, {0x11d3c, 0x00103},
+  {0x11d3e, 0x1102a}, {0x11d3f, 0x00103}, {0x11d46, 0x011dd}, {0x11d47, 0x00103},
+  {0x11d48, 0x1102a}, {0x11d50, 0x01018}, {0x11d5a, 0x1102a}, {0x11d60, 0x0101d},
+  {0x11d66, 0x1102a}, {0x11d67, 0x0101d}, {0x11d69, 0x1102a}, {0x11d6a, 0x0101d},
+  {0x11d8a, 0x01203}, {0x11d8f, 0x1102a}, {0x11d90, 0x00103}, {0x11d92, 0x1102a},
+  {0x11d93, 0x01203}, {0x11d95, 0x00103}, {0x11d96, 0x01203}, {0x11d97, 0x00103},
+  {0x11d98, 0x0101d}, {0x11d99, 0x1102a}, {0x11da0, 0x01018}, {0x11daa, 0x1102a},
+  {0x11ee0, 0x0101d}, {0x11ef3, 0x00103}, {0x11ef5, 0x01203}, {0x11ef7, 0x0101d},
+  {0x11ef9, 0x1102a}, {0x11f00, 0x00103}, {0x11f02, 0x011dd}, {0x11f03, 0x01203},
+  {0x11f04, 0x0101d}, {0x11f11, 0x1102a}, {0x11f12, 0x0101d}, {0x11f34, 0x01203},
+  {0x11f36, 0x00103}, {0x11f3b, 0x1102a}, {0x11f3e, 0x01203}, {0x11f40, 0x00103},
+  {0x11f41, 0x01203}, {0x11f42, 0x00103}, {0x11f43, 0x0100c}, {0x11f45, 0x01024},
+  {0x11f50, 0x01018}, {0x11f5a, 0x1102a}, {0x11fb0, 0x0101d}, {0x11fb1, 0x1102a},
+  {0x11fc0, 0x0101d}, {0x11fdd, 0x01019}, {0x11fe1, 0x0101d}, {0x11ff2, 0x1102a},
+  {0x11fff, 0x0100c}, {0x12000, 0x0101d}, {0x1239a, 0x1102a}, {0x12400, 0x0101d},
+  {0x1246f, 0x1102a}, {0x12470, 0x0100c}, {0x12475, 0x1102a}, {0x12480, 0x0101d},
+  {0x12544, 0x1102a}, {0x12f90, 0x0101d}, {0x12ff3, 0x1102a}, {0x13000, 0x0101d},
+  {0x13258, 0x01015}, {0x1325b, 0x01010}, {0x1325e, 0x0101d}, {0x13282, 0x01010},
+  {0x13283, 0x0101d}, {0x13286, 0x01015}, {0x13287, 0x01010}, {0x13288, 0x01015},
+  {0x13289, 0x01010}, {0x1328a, 0x0101d}, {0x13379, 0x01015}, {0x1337a, 0x01010},
+  {0x1337c, 0x0101d}, {0x13430, 0x000c8}, {0x13437, 0x000d5}, {0x13438, 0x000d0},
+  {0x13439, 0x000c8}, {0x1343c, 0x000d5}, {0x1343d, 0x000d0}, {0x1343e, 0x000d5},
+  {0x1343f, 0x000d0}, {0x13440, 0x00103}, {0x13441, 0x0101d}, {0x13447, 0x00103},
+  {0x13456, 0x1102a}, {0x14400, 0x0101d}, {0x145ce, 0x01015}, {0x145cf, 0x01010},
+  {0x145d0, 0x0101d}, {0x14647, 0x1102a}, {0x16800, 0x0101d}, {0x16a39, 0x1102a},
+  {0x16a40, 0x0101d}, {0x16a5f, 0x1102a}, {0x16a60, 0x01018}, {0x16a6a, 0x1102a},
+  {0x16a6e, 0x0100c}, {0x16a70, 0x0101d}, {0x16abf, 0x1102a}, {0x16ac0, 0x01018},
+  {0x16aca, 0x1102a}, {0x16ad0, 0x0101d}, {0x16aee, 0x1102a}, {0x16af0, 0x00103},
+  {0x16af5, 0x0100c}, {0x16af6, 0x1102a}, {0x16b00, 0x0101d}, {0x16b30, 0x00103},
+  {0x16b37, 0x0100c}, {0x16b3a, 0x0101d}, {0x16b44, 0x0100c}, {0x16b45, 0x0101d},
+  {0x16b46, 0x1102a}, {0x16b50, 0x01018}, {0x16b5a, 0x1102a}, {0x16b5b, 0x0101d},
+  {0x16b62, 0x1102a}, {0x16b63, 0x0101d}, {0x16b78, 0x1102a}, {0x16b7d, 0x0101d},
+  {0x16b90, 0x1102a}, {0x16e40, 0x0101d}, {0x16e97, 0x0100c}, {0x16e99, 0x0101d},
+  {0x16e9b, 0x1102a}, {0x16f00, 0x0101d}, {0x16f4b, 0x1102a}, {0x16f4f, 0x00103},
+  {0x16f50, 0x0101d}, {0x16f51, 0x01203}, {0x16f88, 0x1102a}, {0x16f8f, 0x00103},
+  {0x16f93, 0x0101d}, {0x16fa0, 0x1102a}, {0x16fe0, 0x0a014}, {0x16fe4, 0x08108},
+  {0x16fe5, 0x1102a}, {0x16ff0, 0x0a203}, {0x16ff2, 0x1102a}, {0x17000, 0x0a024},
+  {0x187f8, 0x1102a}, {0x18800, 0x0a024}, {0x18b00, 0x0a01d}, {0x18cd6, 0x1102a},
+  {0x18d00, 0x0a024}, {0x18d09, 0x1102a}, {0x1aff0, 0x0a01d}, {0x1aff4, 0x1102a},
+  {0x1aff5, 0x0a01d}, {0x1affc, 0x1102a}, {0x1affd, 0x0a01d}, {0x1afff, 0x1102a},
+  {0x1b000, 0x0a024}, {0x1b123, 0x1102a}, {0x1b132, 0x0a01e}, {0x1b133, 0x1102a},
+  {0x1b150, 0x0a01e}, {0x1b153, 0x1102a}, {0x1b155, 0x0a01e}, {0x1b156, 0x1102a},
+  {0x1b164, 0x0a01e}, {0x1b168, 0x1102a}, {0x1b170, 0x0a024}, {0x1b2fc, 0x1102a},
+  {0x1bc00, 0x0101d}, {0x1bc6b, 0x1102a}, {0x1bc70, 0x0101d}, {0x1bc7d, 0x1102a},
+  {0x1bc80, 0x0101d}, {0x1bc89, 0x1102a}, {0x1bc90, 0x0101d}, {0x1bc9a, 0x1102a},
+  {0x1bc9c, 0x0101d}, {0x1bc9d, 0x00103}, {0x1bc9f, 0x0100c}, {0x1bca0, 0x000c3},
+  {0x1bca4, 0x1102a}, {0x1cf00, 0x00103}, {0x1cf2e, 0x1102a}, {0x1cf30, 0x00103},
+  {0x1cf47, 0x1102a}, {0x1cf50, 0x0101d}, {0x1cfc4, 0x1102a}, {0x1d000, 0x0101d},
+  {0x1d0f6, 0x1102a}, {0x1d100, 0x0101d}, {0x1d127, 0x1102a}, {0x1d129, 0x0101d},
+  {0x1d165, 0x01103}, {0x1d166, 0x01203}, {0x1d167, 0x00103}, {0x1d16a, 0x0101d},
+  {0x1d16d, 0x01203}, {0x1d16e, 0x01103}, {0x1d173, 0x000c3}, {0x1d17b, 0x00103},
+  {0x1d183, 0x0101d}, {0x1d185, 0x00103}, {0x1d18c, 0x0101d}, {0x1d1aa, 0x00103},
+  {0x1d1ae, 0x0101d}, {0x1d1eb, 0x1102a}, {0x1d200, 0x0101d}, {0x1d242, 0x00103},
+  {0x1d245, 0x0101d}, {0x1d246, 0x1102a}, {0x1d2c0, 0x0101d}, {0x1d2d4, 0x1102a},
+  {0x1d2e0, 0x0101d}, {0x1d2f4, 0x1102a}, {0x1d300, 0x0101d}, {0x1d357, 0x1102a},
+  {0x1d360, 0x0101d}, {0x1d379, 0x1102a}, {0x1d400, 0x0101d}, {0x1d455, 0x1102a},
+  {0x1d456, 0x0101d}, {0x1d49d, 0x1102a}, {0x1d49e, 0x0101d}, {0x1d4a0, 0x1102a},
+  {0x1d4a2, 0x0101d}, {0x1d4a3, 0x1102a}, {0x1d4a5, 0x0101d}, {0x1d4a7, 0x1102a},
+  {0x1d4a9, 0x0101d}, {0x1d4ad, 0x1102a}, {0x1d4ae, 0x0101d}, {0x1d4ba, 0x1102a},
+  {0x1d4bb, 0x0101d}, {0x1d4bc, 0x1102a}, {0x1d4bd, 0x0101d}, {0x1d4c4, 0x1102a},
+  {0x1d4c5, 0x0101d}, {0x1d506, 0x1102a}, {0x1d507, 0x0101d}, {0x1d50b, 0x1102a},
+  {0x1d50d, 0x0101d}, {0x1d515, 0x1102a}, {0x1d516, 0x0101d}, {0x1d51d, 0x1102a},
+  {0x1d51e, 0x0101d}, {0x1d53a, 0x1102a}, {0x1d53b, 0x0101d}, {0x1d53f, 0x1102a},
+  {0x1d540, 0x0101d}, {0x1d545, 0x1102a}, {0x1d546, 0x0101d}, {0x1d547, 0x1102a},
+  {0x1d54a, 0x0101d}, {0x1d551, 0x1102a}, {0x1d552, 0x0101d}, {0x1d6a6, 0x1102a},
+  {0x1d6a8, 0x0101d}, {0x1d7cc, 0x1102a}, {0x1d7ce, 0x01018}, {0x1d800, 0x0101d},
+  {0x1da00, 0x00103}, {0x1da37, 0x0101d}, {0x1da3b, 0x00103}, {0x1da6d, 0x0101d},
+  {0x1da75, 0x00103}, {0x1da76, 0x0101d}, {0x1da84, 0x00103}, {0x1da85, 0x0101d},
+  {0x1da87, 0x0100c}, {0x1da8b, 0x0101d}, {0x1da8c, 0x1102a}, {0x1da9b, 0x00103},
+  {0x1daa0, 0x1102a}, {0x1daa1, 0x00103}, {0x1dab0, 0x1102a}, {0x1df00, 0x0101d},
+  {0x1df1f, 0x1102a}, {0x1df25, 0x0101d}, {0x1df2b, 0x1102a}, {0x1e000, 0x00103},
+  {0x1e007, 0x1102a}, {0x1e008, 0x00103}, {0x1e019, 0x1102a}, {0x1e01b, 0x00103},
+  {0x1e022, 0x1102a}, {0x1e023, 0x00103}, {0x1e025, 0x1102a}, {0x1e026, 0x00103},
+  {0x1e02b, 0x1102a}, {0x1e030, 0x0101d}, {0x1e06e, 0x1102a}, {0x1e08f, 0x00103},
+  {0x1e090, 0x1102a}, {0x1e100, 0x0101d}, {0x1e12d, 0x1102a}, {0x1e130, 0x00103},
+  {0x1e137, 0x0101d}, {0x1e13e, 0x1102a}, {0x1e140, 0x01018}, {0x1e14a, 0x1102a},
+  {0x1e14e, 0x0101d}, {0x1e150, 0x1102a}, {0x1e290, 0x0101d}, {0x1e2ae, 0x00103},
+  {0x1e2af, 0x1102a}, {0x1e2c0, 0x0101d}, {0x1e2ec, 0x00103}, {0x1e2f0, 0x01018},
+  {0x1e2fa, 0x1102a}, {0x1e2ff, 0x0101a}, {0x1e300, 0x1102a}, {0x1e4d0, 0x0101d},
+  {0x1e4ec, 0x00103}, {0x1e4f0, 0x01018}, {0x1e4fa, 0x1102a}, {0x1e7e0, 0x0101d},
+  {0x1e7e7, 0x1102a}, {0x1e7e8, 0x0101d}, {0x1e7ec, 0x1102a}, {0x1e7ed, 0x0101d},
+  {0x1e7ef, 0x1102a}, {0x1e7f0, 0x0101d}, {0x1e7ff, 0x1102a}, {0x1e800, 0x0101d},
+  {0x1e8c5, 0x1102a}, {0x1e8c7, 0x0101d}, {0x1e8d0, 0x00103}, {0x1e8d7, 0x1102a},
+  {0x1e900, 0x0101d}, {0x1e944, 0x00103}, {0x1e94b, 0x0101d}, {0x1e94c, 0x1102a},
+  {0x1e950, 0x01018}, {0x1e95a, 0x1102a}, {0x1e95e, 0x01015}, {0x1e960, 0x1102a},
+  {0x1ec71, 0x0101d}, {0x1ecac, 0x01019}, {0x1ecad, 0x0101d}, {0x1ecb0, 0x01019},
+  {0x1ecb1, 0x0101d}, {0x1ecb5, 0x1102a}, {0x1ed01, 0x0101d}, {0x1ed3e, 0x1102a},
+  {0x1ee00, 0x0101d}, {0x1ee04, 0x1102a}, {0x1ee05, 0x0101d}, {0x1ee20, 0x1102a},
+  {0x1ee21, 0x0101d}, {0x1ee23, 0x1102a}, {0x1ee24, 0x0101d}, {0x1ee25, 0x1102a},
+  {0x1ee27, 0x0101d}, {0x1ee28, 0x1102a}, {0x1ee29, 0x0101d}, {0x1ee33, 0x1102a},
+  {0x1ee34, 0x0101d}, {0x1ee38, 0x1102a}, {0x1ee39, 0x0101d}, {0x1ee3a, 0x1102a},
+  {0x1ee3b, 0x0101d}, {0x1ee3c, 0x1102a}, {0x1ee42, 0x0101d}, {0x1ee43, 0x1102a},
+  {0x1ee47, 0x0101d}, {0x1ee48, 0x1102a}, {0x1ee49, 0x0101d}, {0x1ee4a, 0x1102a},
+  {0x1ee4b, 0x0101d}, {0x1ee4c, 0x1102a}, {0x1ee4d, 0x0101d}, {0x1ee50, 0x1102a},
+  {0x1ee51, 0x0101d}, {0x1ee53, 0x1102a}, {0x1ee54, 0x0101d}, {0x1ee55, 0x1102a},
+  {0x1ee57, 0x0101d}, {0x1ee58, 0x1102a}, {0x1ee59, 0x0101d}, {0x1ee5a, 0x1102a},
+  {0x1ee5b, 0x0101d}, {0x1ee5c, 0x1102a}, {0x1ee5d, 0x0101d}, {0x1ee5e, 0x1102a},
+  {0x1ee5f, 0x0101d}, {0x1ee60, 0x1102a}, {0x1ee61, 0x0101d}, {0x1ee63, 0x1102a},
+  {0x1ee64, 0x0101d}, {0x1ee65, 0x1102a}, {0x1ee67, 0x0101d}, {0x1ee6b, 0x1102a},
+  {0x1ee6c, 0x0101d}, {0x1ee73, 0x1102a}, {0x1ee74, 0x0101d}, {0x1ee78, 0x1102a},
+  {0x1ee79, 0x0101d}, {0x1ee7d, 0x1102a}, {0x1ee7e, 0x0101d}, {0x1ee7f, 0x1102a},
+  {0x1ee80, 0x0101d}, {0x1ee8a, 0x1102a}, {0x1ee8b, 0x0101d}, {0x1ee9c, 0x1102a},
+  {0x1eea1, 0x0101d}, {0x1eea4, 0x1102a}, {0x1eea5, 0x0101d}, {0x1eeaa, 0x1102a},
+  {0x1eeab, 0x0101d}, {0x1eebc, 0x1102a}, {0x1eef0, 0x0101d}, {0x1eef2, 0x1102a},
+  {0x1f000, 0x05024}, {0x1f004, 0x0e024}, {0x1f005, 0x05024}, {0x1f02c, 0x15024},
+  {0x1f030, 0x05024}, {0x1f094, 0x15024}, {0x1f0a0, 0x05024}, {0x1f0af, 0x15024},
+  {0x1f0b1, 0x05024}, {0x1f0c0, 0x15024}, {0x1f0c1, 0x05024}, {0x1f0cf, 0x0e024},
+  {0x1f0d0, 0x15024}, {0x1f0d1, 0x05024}, {0x1f0f6, 0x15024}, {0x1f100, 0x0101c},
+  {0x1f10d, 0x05024}, {0x1f110, 0x0101c}, {0x1f12e, 0x0101d}, {0x1f12f, 0x0501d},
+  {0x1f130, 0x0101c}, {0x1f16a, 0x0101d}, {0x1f16c, 0x0501d}, {0x1f16d, 0x05024},
+  {0x1f170, 0x0501c}, {0x1f172, 0x0101c}, {0x1f17e, 0x0501c}, {0x1f180, 0x0101c},
+  {0x1f18e, 0x0e01c}, {0x1f18f, 0x0101c}, {0x1f191, 0x0e01c}, {0x1f19b, 0x0101c},
+  {0x1f1ad, 0x05024}, {0x1f1ae, 0x15024}, {0x1f1e6, 0x011a8}, {0x1f200, 0x0a024},
+  {0x1f201, 0x0e024}, {0x1f203, 0x15024}, {0x1f210, 0x0a024}, {0x1f21a, 0x0e024},
+  {0x1f21b, 0x0a024}, {0x1f22f, 0x0e024}, {0x1f230, 0x0a024}, {0x1f232, 0x0e024},
+  {0x1f23b, 0x0a024}, {0x1f23c, 0x15024}, {0x1f240, 0x0a024}, {0x1f249, 0x15024},
+  {0x1f250, 0x0e024}, {0x1f252, 0x15024}, {0x1f260, 0x0e024}, {0x1f266, 0x15024},
+  {0x1f300, 0x0e024}, {0x1f321, 0x05024}, {0x1f32d, 0x0e024}, {0x1f336, 0x05024},
+  {0x1f337, 0x0e024}, {0x1f37d, 0x05024}, {0x1f37e, 0x0e024}, {0x1f385, 0x0e01f},
+  {0x1f386, 0x0e024}, {0x1f394, 0x05024}, {0x1f39c, 0x0501d}, {0x1f39e, 0x05024},
+  {0x1f3a0, 0x0e024}, {0x1f3b5, 0x0e01d}, {0x1f3b7, 0x0e024}, {0x1f3bc, 0x0e01d},
+  {0x1f3bd, 0x0e024}, {0x1f3c2, 0x0e01f}, {0x1f3c5, 0x0e024}, {0x1f3c7, 0x0e01f},
+  {0x1f3c8, 0x0e024}, {0x1f3ca, 0x0e01f}, {0x1f3cb, 0x0501f}, {0x1f3cd, 0x05024},
+  {0x1f3cf, 0x0e024}, {0x1f3d4, 0x05024}, {0x1f3e0, 0x0e024}, {0x1f3f1, 0x05024},
+  {0x1f3f4, 0x0e024}, {0x1f3f5, 0x05024}, {0x1f3f8, 0x0e024}, {0x1f3fb, 0x0a120},
+  {0x1f400, 0x0e024}, {0x1f43f, 0x05024}, {0x1f440, 0x0e024}, {0x1f441, 0x05024},
+  {0x1f442, 0x0e01f}, {0x1f444, 0x0e024}, {0x1f446, 0x0e01f}, {0x1f451, 0x0e024},
+  {0x1f466, 0x0e01f}, {0x1f479, 0x0e024}, {0x1f47c, 0x0e01f}, {0x1f47d, 0x0e024},
+  {0x1f481, 0x0e01f}, {0x1f484, 0x0e024}, {0x1f485, 0x0e01f}, {0x1f488, 0x0e024},
+  {0x1f48f, 0x0e01f}, {0x1f490, 0x0e024}, {0x1f491, 0x0e01f}, {0x1f492, 0x0e024},
+  {0x1f4a0, 0x0e01d}, {0x1f4a1, 0x0e024}, {0x1f4a2, 0x0e01d}, {0x1f4a3, 0x0e024},
+  {0x1f4a4, 0x0e01d}, {0x1f4a5, 0x0e024}, {0x1f4aa, 0x0e01f}, {0x1f4ab, 0x0e024},
+  {0x1f4af, 0x0e01d}, {0x1f4b0, 0x0e024}, {0x1f4b1, 0x0e01d}, {0x1f4b3, 0x0e024},
+  {0x1f4fd, 0x05024}, {0x1f4ff, 0x0e024}, {0x1f500, 0x0e01d}, {0x1f507, 0x0e024},
+  {0x1f517, 0x0e01d}, {0x1f525, 0x0e024}, {0x1f532, 0x0e01d}, {0x1f53e, 0x0101d},
+  {0x1f546, 0x0501d}, {0x1f54a, 0x05024}, {0x1f54b, 0x0e024}, {0x1f54f, 0x05024},
+  {0x1f550, 0x0e024}, {0x1f568, 0x05024}, {0x1f574, 0x0501f}, {0x1f576, 0x05024},
+  {0x1f57a, 0x0e01f}, {0x1f57b, 0x05024}, {0x1f590, 0x0501f}, {0x1f591, 0x05024},
+  {0x1f595, 0x0e01f}, {0x1f597, 0x05024}, {0x1f5a4, 0x0e024}, {0x1f5a5, 0x05024},
+  {0x1f5d4, 0x0501d}, {0x1f5dc, 0x05024}, {0x1f5f4, 0x0501d}, {0x1f5fa, 0x05024},
+  {0x1f5fb, 0x0e024}, {0x1f645, 0x0e01f}, {0x1f648, 0x0e024}, {0x1f64b, 0x0e01f},
+  {0x1f650, 0x0101d}, {0x1f676, 0x01016}, {0x1f679, 0x01014}, {0x1f67c, 0x0101d},
+  {0x1f680, 0x0e024}, {0x1f6a3, 0x0e01f}, {0x1f6a4, 0x0e024}, {0x1f6b4, 0x0e01f},
+  {0x1f6b7, 0x0e024}, {0x1f6c0, 0x0e01f}, {0x1f6c1, 0x0e024}, {0x1f6c6, 0x05024},
+  {0x1f6cc, 0x0e01f}, {0x1f6cd, 0x05024}, {0x1f6d0, 0x0e024}, {0x1f6d3, 0x05024},
+  {0x1f6d5, 0x0e024}, {0x1f6d8, 0x15024}, {0x1f6dc, 0x0e024}, {0x1f6e0, 0x05024},
+  {0x1f6eb, 0x0e024}, {0x1f6ed, 0x15024}, {0x1f6f0, 0x05024}, {0x1f6f4, 0x0e024},
+  {0x1f6fd, 0x15024}, {0x1f700, 0x0101d}, {0x1f774, 0x05024}, {0x1f777, 0x15024},
+  {0x1f77b, 0x05024}, {0x1f780, 0x0101d}, {0x1f7d5, 0x05024}, {0x1f7da, 0x15024},
+  {0x1f7e0, 0x0e024}, {0x1f7ec, 0x15024}, {0x1f7f0, 0x0e024}, {0x1f7f1, 0x15024},
+  {0x1f800, 0x0101d}, {0x1f80c, 0x15024}, {0x1f810, 0x0101d}, {0x1f848, 0x15024},
+  {0x1f850, 0x0101d}, {0x1f85a, 0x15024}, {0x1f860, 0x0101d}, {0x1f888, 0x15024},
+  {0x1f890, 0x0101d}, {0x1f8ae, 0x15024}, {0x1f8b0, 0x05024}, {0x1f8b2, 0x15024},
+  {0x1f900, 0x0101d}, {0x1f90c, 0x0e01f}, {0x1f90d, 0x0e024}, {0x1f90f, 0x0e01f},
+  {0x1f910, 0x0e024}, {0x1f918, 0x0e01f}, {0x1f920, 0x0e024}, {0x1f926, 0x0e01f},
+  {0x1f927, 0x0e024}, {0x1f930, 0x0e01f}, {0x1f93a, 0x0e024}, {0x1f93b, 0x01024},
+  {0x1f93c, 0x0e01f}, {0x1f93f, 0x0e024}, {0x1f946, 0x01024}, {0x1f947, 0x0e024},
+  {0x1f977, 0x0e01f}, {0x1f978, 0x0e024}, {0x1f9b5, 0x0e01f}, {0x1f9b7, 0x0e024},
+  {0x1f9b8, 0x0e01f}, {0x1f9ba, 0x0e024}, {0x1f9bb, 0x0e01f}, {0x1f9bc, 0x0e024},
+  {0x1f9cd, 0x0e01f}, {0x1f9d0, 0x0e024}, {0x1f9d1, 0x0e01f}, {0x1f9de, 0x0e024},
+  {0x1fa00, 0x0501d}, {0x1fa54, 0x15024}, {0x1fa60, 0x05024}, {0x1fa6e, 0x15024},
+  {0x1fa70, 0x0e024}, {0x1fa7d, 0x15024}, {0x1fa80, 0x0e024}, {0x1fa89, 0x15024},
+  {0x1fa90, 0x0e024}, {0x1fabe, 0x15024}, {0x1fabf, 0x0e024}, {0x1fac3, 0x0e01f},
+  {0x1fac6, 0x15024}, {0x1face, 0x0e024}, {0x1fadc, 0x15024}, {0x1fae0, 0x0e024},
+  {0x1fae9, 0x15024}, {0x1faf0, 0x0e01f}, {0x1faf9, 0x15024}, {0x1fb00, 0x0101d},
+  {0x1fb93, 0x1102a}, {0x1fb94, 0x0101d}, {0x1fbcb, 0x1102a}, {0x1fbf0, 0x01018},
+  {0x1fbfa, 0x1102a}, {0x1fc00, 0x15024}, {0x1fffe, 0x1102a}, {0x20000, 0x0a024},
+  {0x2a6e0, 0x1a024}, {0x2a700, 0x0a024}, {0x2b73a, 0x1a024}, {0x2b740, 0x0a024},
+  {0x2b81e, 0x1a024}, {0x2b820, 0x0a024}, {0x2cea2, 0x1a024}, {0x2ceb0, 0x0a024},
+  {0x2ebe1, 0x1a024}, {0x2f800, 0x0a024}, {0x2fa1e, 0x1a024}, {0x2fffe, 0x1102a},
+  {0x30000, 0x0a024}, {0x3134b, 0x1a024}, {0x31350, 0x0a024}, {0x323b0, 0x1a024},
+  {0x3fffe, 0x1102a}, {0xe0000, 0x110ea}, {0xe0001, 0x000c3}, {0xe0002, 0x110ea},
+  {0xe0020, 0x00103}, {0xe0080, 0x110ea}, {0xe0100, 0x00103}, {0xe01f0, 0x110ea},
+  {0xe1000, 0x1102a}, {0xf0000, 0x0102a}, {0xffffe, 0x1102a}, {0x100000, 0x0102a},
+  {0x10fffe, 0x1102a},
+};
+
+}// namespace
+
+std::span<const UnicodeTextRange> GetRanges() noexcept {
+  return Ranges;
+}
+
+}// namespace OpenKneeboard::UnicodeTextTables
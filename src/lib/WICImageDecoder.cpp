@@ -0,0 +1,194 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/WICImageDecoder.h>
+
+#include <algorithm>
+
+namespace OpenKneeboard {
+
+namespace {
+
+// Worker threads are owned by `ImageDecodePool`, so they won't have
+// initialized COM themselves
+void EnsureCOMInitialized() {
+  thread_local const bool sInitialized = [] {
+    const auto result = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    // RPC_E_CHANGED_MODE: already initialized as STA, which works too
+    return SUCCEEDED(result) || result == RPC_E_CHANGED_MODE;
+  }();
+  (void)sInitialized;
+}
+
+}// namespace
+
+WICImageDecoder::WICImageDecoder(
+  const winrt::com_ptr<IWICImagingFactory>& wic)
+  : mWIC(wic) {
+}
+
+bool WICImageDecoder::HasAlpha(IWICBitmapSource* source) {
+  WICPixelFormatGUID format {};
+  if (FAILED(source->GetPixelFormat(&format))) {
+    return true;
+  }
+  winrt::com_ptr<IWICComponentInfo> info;
+  mWIC->CreateComponentInfo(format, info.put());
+  const auto formatInfo = info.try_as<IWICPixelFormatInfo2>();
+  if (!formatInfo) {
+    return true;
+  }
+  BOOL transparency {TRUE};
+  formatInfo->SupportsTransparency(&transparency);
+  return transparency;
+}
+
+winrt::com_ptr<IWICBitmapFrameDecode> WICImageDecoder::OpenFrame(
+  const std::filesystem::path& path) {
+  EnsureCOMInitialized();
+
+  winrt::com_ptr<IWICBitmapDecoder> decoder;
+  const auto wsPath = path.wstring();
+  mWIC->CreateDecoderFromFilename(
+    wsPath.c_str(),
+    nullptr,
+    GENERIC_READ,
+    WICDecodeMetadataCacheOnDemand,
+    decoder.put());
+  if (!decoder) {
+    return {};
+  }
+
+  winrt::com_ptr<IWICBitmapFrameDecode> frame;
+  decoder->GetFrame(0, frame.put());
+  return frame;
+}
+
+std::optional<ImageSize> WICImageDecoder::ReadSize(
+  const std::filesystem::path& path) {
+  auto frame = this->OpenFrame(path);
+  if (!frame) {
+    return std::nullopt;
+  }
+  ImageSize size;
+  if (FAILED(frame->GetSize(&size.mWidth, &size.mHeight))) {
+    return std::nullopt;
+  }
+  return size;
+}
+
+std::optional<DecodedImage> WICImageDecoder::Decode(
+  const std::filesystem::path& path,
+  const ImageSize& maxSize,
+  std::stop_token stopToken) {
+  // Rows per `CopyPixels()` call, and per cancellation check
+  constexpr UINT BandHeight = 256;
+
+  auto frame = this->OpenFrame(path);
+  if (!frame) {
+    return std::nullopt;
+  }
+
+  ImageSize nativeSize;
+  if (FAILED(frame->GetSize(&nativeSize.mWidth, &nativeSize.mHeight))) {
+    return std::nullopt;
+  }
+  const auto targetSize = ScaleToFit(nativeSize, maxSize);
+
+  winrt::com_ptr<IWICFormatConverter> converter;
+  mWIC->CreateFormatConverter(converter.put());
+  if (!converter) {
+    return std::nullopt;
+  }
+  winrt::com_ptr<IWICBitmapScaler> scaler;
+  if (targetSize != nativeSize) {
+    mWIC->CreateBitmapScaler(scaler.put());
+    if (!scaler) {
+      return std::nullopt;
+    }
+  }
+
+  const auto convert = [&converter](IWICBitmapSource* source) {
+    return SUCCEEDED(converter->Initialize(
+      source,
+      GUID_WICPixelFormat32bppPBGRA,
+      WICBitmapDitherTypeNone,
+      nullptr,
+      0.0f,
+      WICBitmapPaletteTypeMedianCut));
+  };
+  const auto scale = [&scaler, targetSize](IWICBitmapSource* source) {
+    return SUCCEEDED(scaler->Initialize(
+      source,
+      targetSize.mWidth,
+      targetSize.mHeight,
+      WICBitmapInterpolationModeHighQualityCubic));
+  };
+
+  IWICBitmapSource* source = converter.get();
+  if (!scaler) {
+    if (!convert(frame.get())) {
+      return std::nullopt;
+    }
+  } else if (this->HasAlpha(frame.get())) {
+    // Scale premultiplied pixels, so that the colors of fully transparent
+    // pixels don't bleed into their neighbors
+    if (!(convert(frame.get()) && scale(converter.get()))) {
+      return std::nullopt;
+    }
+    source = scaler.get();
+  } else {
+    // Scale first, so that the scaler can use the decoder's own scaling
+    // (`IWICBitmapSourceTransform`) where available, e.g. for JPEG
+    if (!(scale(frame.get()) && convert(scaler.get()))) {
+      return std::nullopt;
+    }
+  }
+
+  DecodedImage image {.mNativeSize = nativeSize};
+  if (FAILED(source->GetSize(&image.mSize.mWidth, &image.mSize.mHeight))) {
+    return std::nullopt;
+  }
+  const auto stride = static_cast<UINT>(image.GetStride());
+  image.mPixels.resize(image.GetStride() * image.mSize.mHeight);
+
+  for (UINT y = 0; y < image.mSize.mHeight; y += BandHeight) {
+    if (stopToken.stop_requested()) {
+      return std::nullopt;
+    }
+    const auto height = std::min(BandHeight, image.mSize.mHeight - y);
+    const WICRect rect {
+      0,
+      static_cast<INT>(y),
+      static_cast<INT>(image.mSize.mWidth),
+      static_cast<INT>(height),
+    };
+    if (FAILED(source->CopyPixels(
+          &rect,
+          stride,
+          stride * height,
+          reinterpret_cast<BYTE*>(image.mPixels.data() + (y * stride))))) {
+      return std::nullopt;
+    }
+  }
+
+  return image;
+}
+
+}// namespace OpenKneeboard
@@ -0,0 +1,80 @@
+# OpenKneeboard
+#
+# Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 2.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+# USA.
+
+# Downloads the Unicode Character Database files used by
+# generate-unicode-tables.py, and the matching conformance tests, all from the
+# same Unicode version.
+#
+# `unicode-text-benchmark verify` doesn't run the conformance tests by
+# default: it uses the icu72-*-cases.txt files, which are generated with ICU
+# and are not conformance tests. To run the official ones, pass them to it:
+#
+#   unicode-text-benchmark verify GraphemeBreakTest.txt LineBreakTest.txt
+#
+# They haven't been run against this implementation yet, so some lines may
+# fail; ICU 72.1, which the checked-in cases come from, tailors LB25 and
+# applies Unicode 15.1's LB20a early.
+#
+# Usage: fetch-unicode-data.py VERSION [OUTPUT_DIR]
+#
+# VERSION is a full version, e.g. 15.0.0. OUTPUT_DIR defaults to the
+# unicode-data directory next to this script; regenerate the tables
+# afterwards with:
+#
+#   generate-unicode-tables.py unicode-data UnicodeTextTables.cpp
+
+import os
+import sys
+import urllib.request
+
+FILES = [
+    "LineBreak.txt",
+    "EastAsianWidth.txt",
+    "extracted/DerivedGeneralCategory.txt",
+    "auxiliary/GraphemeBreakProperty.txt",
+    "emoji/emoji-data.txt",
+    "DerivedCoreProperties.txt",
+    "auxiliary/GraphemeBreakTest.txt",
+    "auxiliary/LineBreakTest.txt",
+]
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.exit(f"Usage: {sys.argv[0]} VERSION [OUTPUT_DIR]")
+    version = sys.argv[1]
+    if len(sys.argv) == 3:
+        output_dir = sys.argv[2]
+    else:
+        output_dir = os.path.join(
+            os.path.dirname(os.path.abspath(__file__)), "unicode-data")
+    os.makedirs(output_dir, exist_ok=True)
+
+    for relative in FILES:
+        url = f"https://www.unicode.org/Public/{version}/ucd/{relative}"
+        print(f"Fetching {url}")
+        with urllib.request.urlopen(url) as response:
+            data = response.read()
+        # generate-unicode-tables.py also accepts a flat directory
+        path = os.path.join(output_dir, os.path.basename(relative))
+        with open(path, "wb") as f:
+            f.write(data)
+
+
+if __name__ == "__main__":
+    main()
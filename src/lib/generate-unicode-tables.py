@@ -0,0 +1,189 @@
+# OpenKneeboard
+#
+# Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 2.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+# USA.
+
+# Generates UnicodeTextTables.cpp from the Unicode Character Database.
+#
+# Usage: generate-unicode-tables.py UCD_DIR OUTPUT
+#
+# UCD_DIR is an extracted copy of https://www.unicode.org/Public/UCD/latest/ucd/
+# (or any other version); the files can also be placed directly in UCD_DIR.
+#
+# All files must be from the same Unicode version. The checked-in tables are
+# generated from the unicode-data directory next to this script;
+# fetch-unicode-data.py replaces them with a single version of the official
+# files.
+
+import os
+import sys
+
+SOURCES = {
+    "LineBreak": "LineBreak.txt",
+    "EastAsianWidth": "EastAsianWidth.txt",
+    "GeneralCategory": "extracted/DerivedGeneralCategory.txt",
+    "GraphemeBreak": "auxiliary/GraphemeBreakProperty.txt",
+    "Emoji": "emoji/emoji-data.txt",
+    "CoreProperties": "DerivedCoreProperties.txt",
+}
+
+# Must match the enums in OpenKneeboard/UnicodeText.h
+LINE_BREAK_CLASSES = [
+    "BK", "CR", "LF", "CM", "NL", "SG", "WJ", "ZW", "GL", "SP", "ZWJ", "B2",
+    "BA", "BB", "HY", "CB", "CL", "CP", "EX", "IN", "NS", "OP", "QU", "IS",
+    "NU", "PO", "PR", "SY", "AI", "AL", "CJ", "EB", "EM", "H2", "H3", "HL",
+    "ID", "JL", "JV", "JT", "RI", "SA", "XX",
+]
+GRAPHEME_CLUSTER_BREAKS = [
+    "Other", "CR", "LF", "Control", "Extend", "ZWJ", "Regional_Indicator",
+    "Prepend", "SpacingMark", "L", "V", "T", "LV", "LVT",
+]
+INDIC_CONJUNCT_BREAKS = ["None", "Consonant", "Extend", "Linker"]
+
+MAX_CODE_POINT = 0x10FFFF
+
+
+def find_source(ucd_dir, relative):
+    for candidate in (relative, os.path.basename(relative)):
+        path = os.path.join(ucd_dir, candidate)
+        if os.path.exists(path):
+            return path
+    sys.exit(f"Could not find {relative} in {ucd_dir}")
+
+
+def parse_range(text):
+    first, _, last = text.strip().partition("..")
+    first = int(first, 16)
+    return first, int(last, 16) if last else first
+
+
+def read_property(path, default, field=1, only=None):
+    """Returns a list with a value for every code point.
+
+    `@missing` lines are applied first, in order, then explicit values.
+    If `only` is set, only lines where field 1 matches it are used, and the
+    value is taken from `field`.
+    """
+    values = [default] * (MAX_CODE_POINT + 1)
+    explicit = []
+    with open(path, encoding="utf-8") as f:
+        header = f.readline().strip()
+        for line in f:
+            missing = line.startswith("# @missing:")
+            if missing:
+                line = line[len("# @missing:"):]
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = [x.strip() for x in line.split(";")]
+            if only is not None and fields[1] != only:
+                continue
+            first, last = parse_range(fields[0])
+            value = fields[field]
+            if missing:
+                values[first:last + 1] = [value] * (last + 1 - first)
+            else:
+                explicit.append((first, last, value))
+    for first, last, value in explicit:
+        values[first:last + 1] = [value] * (last + 1 - first)
+    return header, values
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(f"Usage: {sys.argv[0]} UCD_DIR OUTPUT")
+    ucd_dir, output = sys.argv[1:]
+    paths = {k: find_source(ucd_dir, v) for k, v in SOURCES.items()}
+
+    headers = []
+
+    def read(name, *args, **kwargs):
+        header, values = read_property(paths[name], *args, **kwargs)
+        headers.append(header)
+        return values
+
+    line_break = read("LineBreak", "XX")
+    east_asian_width = read("EastAsianWidth", "N")
+    general_category = read("GeneralCategory", "Cn")
+    grapheme_break = read("GraphemeBreak", "Other")
+    pictographic = read(
+        "Emoji", None, field=1, only="Extended_Pictographic")
+    indic_conjunct_break = read(
+        "CoreProperties", "None", field=2, only="InCB")
+
+    def pack(cp):
+        gc = general_category[cp]
+        gcb = grapheme_break[cp]
+        eaw = east_asian_width[cp]
+        if gc in ("Mn", "Me", "Cf") or gcb in ("V", "T"):
+            width = 0
+        elif eaw in ("W", "F"):
+            width = 2
+        else:
+            width = 1
+        return (
+            LINE_BREAK_CLASSES.index(line_break[cp])
+            | (GRAPHEME_CLUSTER_BREAKS.index(gcb) << 6)
+            | (INDIC_CONJUNCT_BREAKS.index(indic_conjunct_break[cp]) << 10)
+            | (width << 12)
+            | ((1 if pictographic[cp] else 0) << 14)
+            | ((1 if eaw in ("F", "W", "H") else 0) << 15)
+            | ((1 if gc == "Cn" else 0) << 16))
+
+    ranges = []
+    previous = None
+    for cp in range(MAX_CODE_POINT + 1):
+        packed = pack(cp)
+        if packed != previous:
+            ranges.append((cp, packed))
+            previous = packed
+
+    with open(output, "w", encoding="utf-8", newline="\n") as f:
+        f.write("// Generated by generate-unicode-tables.py; do not edit.\n")
+        f.write("//\n// Sources:\n")
+        for header in headers:
+            f.write(f"// {header.lstrip('# ')}\n")
+        f.write(
+            "\n"
+            "// clang-format off\n"
+            "#include <OpenKneeboard/UnicodeText.h>\n"
+            "\n"
+            "namespace OpenKneeboard::UnicodeTextTables {\n"
+            "\n"
+            "namespace {\n"
+            "\n"
+            "// Packed properties, starting at each code point; see\n"
+            "// `UnpackProperties()` in UnicodeText.cpp for the layout.\n"
+            f"constexpr UnicodeTextRange Ranges[{len(ranges)}] = {{\n")
+        for i in range(0, len(ranges), 4):
+            chunk = ranges[i:i + 4]
+            f.write("  " + " ".join(
+                f"{{0x{cp:05x}, 0x{packed:05x}}}," for cp, packed in chunk)
+                + "\n")
+        f.write(
+            "};\n"
+            "\n"
+            "}// namespace\n"
+            "\n"
+            "std::span<const UnicodeTextRange> GetRanges() noexcept {\n"
+            "  return Ranges;\n"
+            "}\n"
+            "\n"
+            "}// namespace OpenKneeboard::UnicodeTextTables\n")
+
+
+if __name__ == "__main__":
+    main()
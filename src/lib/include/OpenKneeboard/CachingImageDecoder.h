@@ -0,0 +1,54 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/ImageDecoder.h>
+
+#include <memory>
+
+namespace OpenKneeboard {
+
+class PageImageCache;
+
+/** Wraps another decoder, keeping decoded images in a `PageImageCache`.
+ *
+ * On a hit, the file is still read and hashed to check it hasn't changed,
+ * but that's much cheaper than decoding it. Misses are stored in the
+ * background, so they're no slower than decoding without the cache.
+ */
+class CachingImageDecoder final : public ImageDecoder {
+ public:
+  CachingImageDecoder() = delete;
+  CachingImageDecoder(
+    std::shared_ptr<ImageDecoder>,
+    std::shared_ptr<PageImageCache>);
+
+  std::optional<ImageSize> ReadSize(const std::filesystem::path&) override;
+  std::optional<DecodedImage> Decode(
+    const std::filesystem::path&,
+    const ImageSize& maxSize,
+    std::stop_token stopToken) override;
+
+ private:
+  const std::shared_ptr<ImageDecoder> mDecoder;
+  const std::shared_ptr<PageImageCache> mCache;
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,169 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/LRUCache.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace OpenKneeboard {
+
+/** A thread-safe `LRUCache` that only creates each value once.
+ *
+ * If a value is requested while another thread is already creating it, the
+ * second thread waits for the first one's result instead of creating it
+ * again.
+ *
+ * Values should be cheap to copy, e.g. `std::shared_ptr` or
+ * `winrt::com_ptr`.
+ */
+template <
+  class TKey,
+  class TValue,
+  class THash = std::hash<TKey>,
+  class TKeyEqual = std::equal_to<TKey>>
+class CoalescingCache final {
+ public:
+  struct Stats {
+    LRUCacheStats mCache;
+    // Requests that waited for another thread instead of creating a value
+    uint64_t mCoalesced {0};
+  };
+
+  /// Returns the cached value, and its cost
+  using Factory = std::function<std::pair<TValue, size_t>()>;
+
+  explicit CoalescingCache(size_t budget) : mCache(budget) {
+  }
+
+  CoalescingCache(const CoalescingCache&) = delete;
+  CoalescingCache& operator=(const CoalescingCache&) = delete;
+
+  /** Returns a cached value, or creates it with `factory`.
+   *
+   * If `factory` throws, the exception is rethrown to every waiting caller,
+   * and nothing is cached.
+   */
+  TValue GetOrCreate(const TKey& key, const Factory& factory) {
+    std::promise<TValue> promise;
+    uint64_t creation {};
+    {
+      std::unique_lock lock(mMutex);
+      if (auto value = mCache.Get(key)) {
+        return *value;
+      }
+      if (auto it = mInFlight.find(key); it != mInFlight.end()) {
+        auto future = it->second.mFuture;
+        ++mCoalesced;
+        lock.unlock();
+        return future.get();
+      }
+      creation = ++mLastCreation;
+      mInFlight.emplace(key, InFlight {promise.get_future().share(), creation});
+    }
+
+    try {
+      auto [value, cost] = factory();
+      std::unique_lock lock(mMutex);
+      // If this key was erased while we were creating it, the value may be
+      // stale, so don't cache it
+      if (this->EraseInFlight(key, creation)) {
+        mCache.Insert(key, value, cost);
+      }
+      lock.unlock();
+      promise.set_value(value);
+      return value;
+    } catch (...) {
+      {
+        std::unique_lock lock(mMutex);
+        this->EraseInFlight(key, creation);
+      }
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+  }
+
+  /// Returns a cached value, without creating it or waiting for it
+  std::optional<TValue> Get(const TKey& key) {
+    std::unique_lock lock(mMutex);
+    if (auto value = mCache.Get(key)) {
+      return *value;
+    }
+    return std::nullopt;
+  }
+
+  /** Erases cached values where `pred(key)` is true.
+   *
+   * Values for matching keys that are currently being created are returned
+   * to their callers, but not cached; later requests create them again.
+   */
+  template <class TPred>
+  size_t EraseIf(TPred&& pred) {
+    std::unique_lock lock(mMutex);
+    std::erase_if(mInFlight, [&pred](const auto& it) {
+      return pred(std::as_const(it.first));
+    });
+    return mCache.EraseIf(
+      [&pred](const TKey& key, const TValue&) { return pred(key); });
+  }
+
+  void SetBudget(size_t budget) {
+    std::unique_lock lock(mMutex);
+    mCache.SetBudget(budget);
+  }
+
+  Stats GetStats() const {
+    std::unique_lock lock(mMutex);
+    return {mCache.GetStats(), mCoalesced};
+  }
+
+ private:
+  struct InFlight {
+    std::shared_future<TValue> mFuture;
+    // Distinguishes this creation from a later one for the same key
+    uint64_t mCreation {};
+  };
+
+  mutable std::mutex mMutex;
+  LRUCache<TKey, TValue, THash, TKeyEqual> mCache;
+  std::unordered_map<TKey, InFlight, THash, TKeyEqual> mInFlight;
+  uint64_t mCoalesced {0};
+  uint64_t mLastCreation {0};
+
+  /// Returns false if the creation was erased by `EraseIf()`
+  bool EraseInFlight(const TKey& key, uint64_t creation) {
+    const auto it = mInFlight.find(key);
+    if (it == mInFlight.end() || it->second.mCreation != creation) {
+      return false;
+    }
+    mInFlight.erase(it);
+    return true;
+  }
+};
+
+}// namespace OpenKneeboard
@@ -23,6 +23,7 @@
 
 #include <windows.data.pdf.interop.h>
 
+#include <memory>
 #include <source_location>
 
 #include <d2d1_2.h>
@@ -33,6 +34,10 @@
 
 namespace OpenKneeboard {
 
+class ImageDecodePool;
+class PageImageCache;
+class RasterCache;
+
 /** Direct2D/Direct3D/DXGI resources we want to share between multiple objects.
  *
  * For the most part, we just care that we're using the same D3D11 device, so we
@@ -60,6 +65,13 @@ struct DXResources {
 
   winrt::com_ptr<IPdfRendererNative> mPDFRenderer;
 
+  // Rendered pages etc; shared so that the VRAM budget is global
+  std::shared_ptr<RasterCache> mRasterCache;
+  // Image files; shared so that the number of decode threads is global
+  std::shared_ptr<ImageDecodePool> mImageDecodePool;
+  // Decoded and rendered pages, kept on disk between launches
+  std::shared_ptr<PageImageCache> mPageImageCache;
+
   // Use like push/pop, but only one is allowed at a time; this exists
   // to get better debugging information/breakpoints when that's not the case
   void PushD2DDraw(std::source_location = std::source_location::current());
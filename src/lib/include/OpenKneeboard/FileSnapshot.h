@@ -0,0 +1,164 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <shims/filesystem>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** What we know about a version of a file.
+ *
+ * `mContentHash` is only populated for identities that came from a
+ * `FileSnapshot`; metadata-only identities from `Stat()` leave it as 0.
+ */
+struct FileIdentity final {
+  uint64_t mSize {};
+  std::filesystem::file_time_type mLastWriteTime {};
+  uint64_t mContentHash {};
+
+  /// Size and modification time only; returns nullopt if not a regular file
+  static std::optional<FileIdentity> Stat(const std::filesystem::path&);
+
+  bool HasSameMetadata(const FileIdentity&) const noexcept;
+  bool HasSameContent(const FileIdentity&) const noexcept;
+};
+
+/// Non-cryptographic hash, only suitable for change detection
+uint64_t HashFileContent(std::span<const std::byte>) noexcept;
+
+/** An in-memory copy of a file, with the identity it was read at.
+ *
+ * Reading doesn't copy the file on disk; the file is read directly, and if it
+ * is modified or replaced while we're reading it, the read is retried.
+ */
+class FileSnapshot final {
+ public:
+  struct Options {
+    size_t mMaxAttempts {5};
+    std::chrono::milliseconds mRetryDelay {50};
+  };
+
+  FileSnapshot() = delete;
+  FileSnapshot(const FileSnapshot&) = delete;
+  FileSnapshot& operator=(const FileSnapshot&) = delete;
+
+  /** Returns nullptr if the file doesn't exist, can't be read, or didn't
+   * stay the same for long enough to read it. */
+  static std::shared_ptr<FileSnapshot> Read(const std::filesystem::path&);
+  static std::shared_ptr<FileSnapshot> Read(
+    const std::filesystem::path&,
+    const Options&);
+
+  std::filesystem::path GetPath() const noexcept;
+  const FileIdentity& GetIdentity() const noexcept;
+  std::span<const std::byte> GetBytes() const noexcept;
+
+ private:
+  friend class FileRangeReader;
+
+  FileSnapshot(
+    const std::filesystem::path&,
+    const FileIdentity&,
+    std::vector<std::byte>&&);
+
+  std::filesystem::path mPath;
+  FileIdentity mIdentity;
+  std::vector<std::byte> mBytes;
+};
+
+/** Reads parts of a file on demand, failing if it has changed.
+ *
+ * For large files that are read a range at a time, e.g. by a PDF renderer:
+ * unlike `FileSnapshot`, this doesn't keep a copy of the file in memory, and
+ * the file is only open during each read, so the user can still save or
+ * replace it.
+ */
+class FileRangeReader final {
+ public:
+  FileRangeReader() = delete;
+  FileRangeReader(const FileRangeReader&) = delete;
+  FileRangeReader& operator=(const FileRangeReader&) = delete;
+
+  /** Reads the whole file once, a chunk at a time, to hash it.
+   *
+   * Returns nullptr in the same cases as `FileSnapshot::Read()`.
+   */
+  static std::shared_ptr<FileRangeReader> Open(const std::filesystem::path&);
+  static std::shared_ptr<FileRangeReader> Open(
+    const std::filesystem::path&,
+    const FileSnapshot::Options&);
+
+  std::filesystem::path GetPath() const noexcept;
+  const FileIdentity& GetIdentity() const noexcept;
+
+  /** Reads up to `buffer.size()` bytes from `offset`.
+   *
+   * Returns the number of bytes read, or nullopt if the file can't be read,
+   * or its metadata no longer matches `GetIdentity()`.
+   */
+  std::optional<size_t> ReadAt(uint64_t offset, std::span<std::byte> buffer)
+    const;
+
+  /** A full copy of the file, for parsers that need one.
+   *
+   * Every range is checked against `GetIdentity()` instead of re-hashing the
+   * copy; returns nullptr if the file has changed.
+   */
+  std::shared_ptr<FileSnapshot> ReadSnapshot() const;
+
+ private:
+  FileRangeReader(const std::filesystem::path&, const FileIdentity&);
+
+  std::filesystem::path mPath;
+  FileIdentity mIdentity;
+};
+
+/** Tracks the last-loaded version of a file, to skip redundant reloads.
+ *
+ * File watchers tend to fire several times for a single save, and some
+ * editors rewrite files without changing them; this lets callers do a cheap
+ * metadata check before reading the file, and a content check before doing
+ * anything expensive with it.
+ */
+class FileChangeDetector final {
+ public:
+  /// True if the metadata differs from the last committed version
+  bool MayHaveChanged(const std::filesystem::path&) const;
+  /** Records the snapshot as the current version.
+   *
+   * Returns true if the content differs from the previous version.
+   */
+  bool Commit(const FileSnapshot&);
+  bool Commit(const FileIdentity&);
+  void Reset();
+
+ private:
+  std::optional<FileIdentity> mCurrent;
+};
+
+}// namespace OpenKneeboard
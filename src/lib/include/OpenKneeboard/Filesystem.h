@@ -27,6 +27,9 @@ namespace OpenKneeboard::Filesystem {
  * it guarantees to be in canonical form */
 std::filesystem::path GetTemporaryDirectory();
 std::filesystem::path GetRuntimeDirectory();
+/** Persistent, per-user, and safe to delete; e.g.
+ * `%LOCALAPPDATA%\OpenKneeboard\Cache` */
+std::filesystem::path GetCacheDirectory();
 
 void CleanupTemporaryDirectories();
 
@@ -43,21 +46,4 @@ class ScopedDeleter {
   std::filesystem::path mPath;
 };
 
-class TemporaryCopy final {
- public:
-  TemporaryCopy(
-    const std::filesystem::path& source,
-    const std::filesystem::path& destination);
-  ~TemporaryCopy() noexcept;
-
-  TemporaryCopy() = delete;
-  TemporaryCopy(const TemporaryCopy&) = delete;
-  TemporaryCopy& operator=(const TemporaryCopy&) = delete;
-
-  std::filesystem::path GetPath() const noexcept;
-
- private:
-  std::filesystem::path mCopy;
-};
-
 }// namespace OpenKneeboard::Filesystem
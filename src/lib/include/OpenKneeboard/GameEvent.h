@@ -19,6 +19,7 @@
  */
 #pragma once
 
+#include <OpenKneeboard/GameEventPacket.h>
 #include <OpenKneeboard/json_fwd.h>
 #include <OpenKneeboard/utf8.h>
 
@@ -61,11 +62,30 @@ struct GameEvent final {
 
   operator bool() const;
 
+  static GameEvent FromView(const GameEventView& view) {
+    return {std::string {view.name}, std::string {view.value}};
+  }
+
+  /** Parses a packet containing exactly one event.
+   *
+   * Returns an empty event if the packet is invalid or contains multiple
+   * events; use `GameEventPacket` for packets that may contain several.
+   */
   static GameEvent Unserialize(std::string_view packet);
+  /** Serializes with the legacy text framing.
+   *
+   * This is accepted by every version of OpenKneeboard; `GameEvent::Send()`
+   * batches events into binary packets when the receiver supports them.
+   */
   std::vector<std::byte> Serialize() const;
+  /// Queue for sending from a background thread; does not block
   void Send() const;
 
   static const char* GetMailslotPath();
+  /// Signalled by clients after writing to a `GameEventRing`
+  static const wchar_t* GetRingWakeEventName();
+  /// Exists while the receiver accepts binary (version 2) packets
+  static const wchar_t* GetBinaryPacketsEventName();
 
   /// String name of OpenKneeboard::UserAction enum member
   static constexpr char EVT_REMOTE_USER_ACTION[] = "RemoteUserAction";
@@ -87,8 +107,18 @@ struct GameEvent final {
   // struct SetBrightnessEvent
   static constexpr char EVT_SET_BRIGHTNESS[] = "SetBrightness";
 
+  /// struct SearchEvent
+  static constexpr char EVT_SEARCH[] = "Search";
+
   /// JSON: "[ [name, value], [name, value], ... ]"
   static constexpr char EVT_MULTI_EVENT[] = "MultiEvent";
+
+  /// struct RegisterGameEventRingEvent; sent via the mailslot
+  static constexpr char EVT_REGISTER_RING[] = "RegisterGameEventRing";
+  /** struct ActivateGameEventRingEvent; sent via the mailslot after the
+   * client's last event that it sends through the mailslot
+   */
+  static constexpr char EVT_ACTIVATE_RING[] = "ActivateGameEventRing";
 };
 
 struct BaseSetTabEvent {
@@ -139,4 +169,32 @@ struct SetBrightnessEvent {
 };
 OPENKNEEBOARD_DECLARE_JSON(SetBrightnessEvent);
 
+/// Go to the best match for `mQuery` in any tab's text
+struct SearchEvent {
+  static constexpr auto ID {GameEvent::EVT_SEARCH};
+  std::string mQuery;
+};
+OPENKNEEBOARD_DECLARE_JSON(SearchEvent);
+
+struct RegisterGameEventRingEvent {
+  static constexpr auto ID {GameEvent::EVT_REGISTER_RING};
+  // Name of a file mapping containing a GameEventRing
+  std::string mMappingName;
+  uint64_t mByteCount {};
+  uint32_t mProcessID {};
+};
+OPENKNEEBOARD_DECLARE_JSON(RegisterGameEventRingEvent);
+
+/** Sent once a client has seen the server attach to its ring.
+ *
+ * The server doesn't read the ring until it has dispatched this, so that
+ * events the client sent through the mailslot before switching to the ring
+ * are dispatched first.
+ */
+struct ActivateGameEventRingEvent {
+  static constexpr auto ID {GameEvent::EVT_ACTIVATE_RING};
+  std::string mMappingName;
+};
+OPENKNEEBOARD_DECLARE_JSON(ActivateGameEventRingEvent);
+
 }// namespace OpenKneeboard
@@ -0,0 +1,241 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/GameEventPacket.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** A batch of received `GameEvent`s.
+ *
+ * Names and values are copied into a single arena; `EVT_MULTI_EVENT` packets
+ * are flattened into their component events when they're appended, so
+ * consumers never see them.
+ *
+ * `Clear()` keeps the allocations, so recycled batches stop allocating once
+ * they've grown to fit the usual burst.
+ */
+class GameEventBatch final {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  GameEventBatch();
+
+  void Clear() noexcept;
+
+  /// Returns false if the packet was invalid
+  bool AppendPacket(std::string_view packet, Clock::time_point receivedAt);
+  void Append(
+    std::string_view name,
+    std::string_view value,
+    Clock::time_point receivedAt);
+
+  size_t GetEventCount() const noexcept;
+  bool IsEmpty() const noexcept;
+  /// When the oldest event in the batch was received
+  Clock::time_point GetReceivedAt() const noexcept;
+
+  GameEventView operator[](size_t index) const noexcept;
+
+  class Iterator final {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = GameEventView;
+
+    Iterator() = default;
+    Iterator(const GameEventBatch*, size_t index) noexcept;
+
+    GameEventView operator*() const noexcept;
+    Iterator& operator++() noexcept;
+    Iterator operator++(int) noexcept;
+    bool operator==(const Iterator&) const noexcept = default;
+
+   private:
+    const GameEventBatch* mBatch {nullptr};
+    size_t mIndex {0};
+  };
+
+  Iterator begin() const noexcept;
+  Iterator end() const noexcept;
+
+ private:
+  struct Entry {
+    size_t mNameOffset;
+    size_t mNameSize;
+    size_t mValueOffset;
+    size_t mValueSize;
+  };
+  std::string mArena;
+  std::vector<Entry> mEntries;
+  Clock::time_point mReceivedAt {};
+
+  void AppendMultiEvent(std::string_view json, Clock::time_point receivedAt);
+};
+
+/// Recycles `GameEventBatch`es between the receive and dispatch threads
+class GameEventBatchPool final {
+ public:
+  explicit GameEventBatchPool(size_t maxPooled = 4);
+
+  std::unique_ptr<GameEventBatch> Acquire();
+  void Release(std::unique_ptr<GameEventBatch>);
+
+ private:
+  const size_t mMaxPooled;
+  std::mutex mMutex;
+  std::vector<std::unique_ptr<GameEventBatch>> mPool;
+};
+
+/// Counters for a `GameEvent` receiver; safe to update from any thread
+class GameEventReceiveMetrics final {
+ public:
+  struct Snapshot {
+    uint64_t mPackets {0};
+    uint64_t mInvalidPackets {0};
+    uint64_t mEvents {0};
+    uint64_t mBatches {0};
+    // Events that have been received, but not dispatched
+    uint64_t mQueueDepth {0};
+    uint64_t mMaxQueueDepth {0};
+    size_t mLargestBatch {0};
+    // From receiving the oldest event in a batch, to dispatching the batch
+    std::chrono::microseconds mLastDispatchLatency {};
+    std::chrono::microseconds mMaxDispatchLatency {};
+    std::chrono::microseconds mTotalDispatchLatency {};
+  };
+
+  void RecordPacket(bool valid) noexcept;
+  void RecordQueued(const GameEventBatch&) noexcept;
+  void RecordDispatched(
+    const GameEventBatch&,
+    GameEventBatch::Clock::time_point dispatchedAt) noexcept;
+
+  Snapshot GetSnapshot() const noexcept;
+
+ private:
+  std::atomic<uint64_t> mPackets {0};
+  std::atomic<uint64_t> mInvalidPackets {0};
+  std::atomic<uint64_t> mEvents {0};
+  std::atomic<uint64_t> mBatches {0};
+  std::atomic<uint64_t> mQueueDepth {0};
+  std::atomic<uint64_t> mMaxQueueDepth {0};
+  std::atomic<size_t> mLargestBatch {0};
+  std::atomic<int64_t> mLastDispatchLatency {0};
+  std::atomic<int64_t> mMaxDispatchLatency {0};
+  std::atomic<int64_t> mTotalDispatchLatency {0};
+};
+
+/** A source of raw `GameEvent` packets, such as a mailslot.
+ *
+ * `GameEventReceiver` waits for one packet with `ReadNext()`, then drains
+ * everything else that is already waiting with `ReadPending()`.
+ */
+class GameEventPacketSource {
+ public:
+  virtual ~GameEventPacketSource();
+
+  using PacketCallback = std::function<void(std::string_view packet)>;
+
+  /** Block until a packet arrives, then call `callback` for it.
+   *
+   * May return without calling `callback`, e.g. if an empty message was read.
+   * Returns false if the source has been closed, or `stopToken` has been
+   * triggered.
+   *
+   * The `string_view` is only valid until the callback returns.
+   */
+  virtual bool ReadNext(const PacketCallback& callback, std::stop_token) = 0;
+
+  /** Call `callback` for every packet that is already pending, without
+   * blocking.
+   *
+   * The `string_view` is only valid until the callback returns. Returns the
+   * number of packets read.
+   */
+  virtual size_t ReadPending(const PacketCallback& callback) = 0;
+};
+
+/** The receive loop for `GameEvent` packets.
+ *
+ * After each wakeup, everything that is pending is read into a single batch,
+ * so that the consumer - usually the UI thread - only needs to be woken once.
+ * How batches are dispatched is up to the caller.
+ */
+class GameEventReceiver final {
+ public:
+  using Clock = GameEventBatch::Clock;
+
+  struct Callbacks {
+    /// Called on the receive thread for each non-empty batch, before dispatch
+    std::function<void(const GameEventBatch&, Clock::time_point receivedAt)>
+      mInspect {};
+    /// Should release the batch back to the pool when it's done with it
+    std::function<void(std::unique_ptr<GameEventBatch>)> mDispatch {};
+    /** Called on the receive thread for each packet that couldn't be parsed,
+     * e.g. to log it; these are also counted in the metrics.
+     */
+    std::function<void(std::string_view packet)> mInvalidPacket {};
+  };
+
+  GameEventReceiver(GameEventBatchPool&, GameEventReceiveMetrics&, Callbacks);
+
+  GameEventReceiver() = delete;
+  GameEventReceiver(const GameEventReceiver&) = delete;
+  GameEventReceiver& operator=(const GameEventReceiver&) = delete;
+
+  /// Dispatch batches until the source is closed, or a stop is requested
+  void Run(GameEventPacketSource&, std::stop_token);
+  /** Wait for a packet, then dispatch it and anything else that is pending.
+   *
+   * Returns false if the source is closed, or a stop is requested.
+   */
+  bool RunOnce(GameEventPacketSource&, std::stop_token);
+
+  /// Returns false if the packet was invalid
+  bool AppendPacket(
+    GameEventBatch&,
+    std::string_view packet,
+    Clock::time_point receivedAt);
+  /** Inspect and dispatch a batch that was filled by something else.
+   *
+   * Empty batches are returned to the pool.
+   */
+  void Submit(std::unique_ptr<GameEventBatch>, Clock::time_point receivedAt);
+
+ private:
+  GameEventBatchPool& mPool;
+  GameEventReceiveMetrics& mMetrics;
+  const Callbacks mCallbacks;
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,143 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/GameEvent.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/// 64-bit FNV-1a
+constexpr uint64_t GameEventNameHash(std::string_view name) noexcept {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (const auto c: name) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+/** An event name, and its hash.
+ *
+ * Constructing from a string literal or a `constexpr char[]` such as
+ * `GameEvent::EVT_SET_TAB_BY_ID` hashes at compile time.
+ */
+struct GameEventName final {
+  template <size_t N>
+  consteval GameEventName(const char (&name)[N])
+    : mName(name, N - 1), mHash(GameEventNameHash(mName)) {
+  }
+
+  explicit constexpr GameEventName(std::string_view name)
+    : mName(name), mHash(GameEventNameHash(name)) {
+  }
+
+  std::string_view mName;
+  uint64_t mHash;
+};
+
+/** Routes `GameEvent`s to handlers that subscribed to their name.
+ *
+ * Handlers for the specific name are invoked in subscription order, after any
+ * handlers subscribed with `SubscribeToAll()`.
+ *
+ * Subscribing and unsubscribing copy the handler table, so they're safe to do
+ * from inside a handler. A handler that is unsubscribed during a dispatch on
+ * the same thread - e.g. by an earlier handler - is not invoked again. If
+ * another thread is dispatching at the same time, a call to the handler may
+ * still start or be running after `Unsubscribe()` returns; the handler is
+ * kept alive until that dispatch finishes.
+ *
+ * Handler calls are always counted; timing them reads the clock twice per
+ * handler, so it is off unless `SetHandlerTimingEnabled()` is used.
+ */
+class GameEventDispatcher final {
+ private:
+  struct Impl;
+  struct Entry;
+
+ public:
+  using Handler = std::function<void(const GameEvent&)>;
+
+  /// Unsubscribes when destroyed
+  class Subscription final {
+   public:
+    Subscription() = default;
+    ~Subscription();
+
+    Subscription(Subscription&&) noexcept;
+    Subscription& operator=(Subscription&&) noexcept;
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+
+    void Unsubscribe();
+
+   private:
+    friend class GameEventDispatcher;
+    Subscription(const std::shared_ptr<Impl>&, const std::shared_ptr<Entry>&);
+
+    std::weak_ptr<Impl> mImpl;
+    std::shared_ptr<Entry> mEntry;
+  };
+
+  struct HandlerStats {
+    // Empty for `SubscribeToAll()`
+    std::string mEventName;
+    std::string mSubscribedFrom;
+    uint64_t mCallCount {0};
+    // Only calls while timing was enabled
+    uint64_t mTimedCallCount {0};
+    std::chrono::nanoseconds mTotalTime {};
+    std::chrono::nanoseconds mMaxTime {};
+  };
+
+  GameEventDispatcher();
+  ~GameEventDispatcher();
+
+  GameEventDispatcher(const GameEventDispatcher&) = delete;
+  GameEventDispatcher& operator=(const GameEventDispatcher&) = delete;
+
+  [[nodiscard]] Subscription Subscribe(
+    const GameEventName&,
+    Handler,
+    std::source_location = std::source_location::current());
+  [[nodiscard]] Subscription SubscribeToAll(
+    Handler,
+    std::source_location = std::source_location::current());
+
+  /// Returns the number of handlers that were invoked
+  size_t Dispatch(const GameEvent&) const;
+
+  std::vector<HandlerStats> GetHandlerStats() const;
+  void SetHandlerTimingEnabled(bool);
+
+ private:
+  std::shared_ptr<Impl> p;
+};
+
+}// namespace OpenKneeboard
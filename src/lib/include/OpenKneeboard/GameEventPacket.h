@@ -0,0 +1,166 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** Wire format for `GameEvent`s.
+ *
+ * Version 2 is a binary, length-prefixed framing that can contain multiple
+ * events in a single packet; all integers are little-endian:
+ *
+ * - 4 bytes: magic ("OKGE")
+ * - uint16: version (2)
+ * - uint16: flags (reserved, 0)
+ * - uint32: event count
+ * - for each event:
+ *   - uint32: name byte count
+ *   - uint32: value byte count
+ *   - name bytes (UTF-8)
+ *   - value bytes (UTF-8)
+ *
+ * The legacy text framing - "{:08x}!{}!{:08x}!{}!" with the name size, name,
+ * value size, and value - is still accepted, as it may be sent by older
+ * copies of the API DLLs.
+ *
+ * Older versions of OpenKneeboard only accept the legacy framing, so senders
+ * must only use version 2 if the receiver has created the named event from
+ * `GameEvent::GetBinaryPacketsEventName()`.
+ */
+namespace GameEventWire {
+constexpr std::string_view Magic {"OKGE"};
+constexpr uint16_t Version = 2;
+constexpr size_t HeaderSize = 12;
+constexpr size_t RecordHeaderSize = 8;
+}// namespace GameEventWire
+
+/** A non-owning `GameEvent`.
+ *
+ * Both members point into a buffer owned by something else - usually a
+ * `GameEventPacket`'s buffer.
+ */
+struct GameEventView final {
+  std::string_view name;
+  std::string_view value;
+};
+
+/// Formats a single event with the legacy text framing
+std::string SerializeLegacyGameEvent(const GameEventView&);
+
+/** A read-only view of a `GameEvent` packet.
+ *
+ * This does not copy or allocate: all `GameEventView`s point into the original
+ * buffer, so the buffer must outlive the packet and any views.
+ *
+ * The packet is fully validated on construction; if it is malformed, it is
+ * treated as empty, and `operator bool()` returns false.
+ */
+class GameEventPacket final {
+ public:
+  enum class Format {
+    Invalid,
+    LegacyText,
+    Binary,
+  };
+
+  GameEventPacket() = delete;
+  explicit GameEventPacket(std::string_view buffer) noexcept;
+
+  Format GetFormat() const noexcept;
+  size_t GetEventCount() const noexcept;
+  operator bool() const noexcept;
+
+  class Iterator final {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = GameEventView;
+    using pointer = const GameEventView*;
+    using reference = const GameEventView&;
+
+    Iterator() = default;
+
+    reference operator*() const noexcept;
+    pointer operator->() const noexcept;
+    Iterator& operator++() noexcept;
+    Iterator operator++(int) noexcept;
+
+    bool operator==(const Iterator&) const noexcept;
+
+   private:
+    friend class GameEventPacket;
+    Iterator(Format, std::string_view records, size_t remaining) noexcept;
+
+    Format mFormat {Format::Invalid};
+    std::string_view mRecords;
+    size_t mRemaining {0};
+    size_t mCurrentSize {0};
+    GameEventView mCurrent;
+
+    void ReadCurrent() noexcept;
+  };
+
+  Iterator begin() const noexcept;
+  Iterator end() const noexcept;
+
+ private:
+  Format mFormat {Format::Invalid};
+  std::string_view mRecords;
+  size_t mEventCount {0};
+
+  bool ParseBinary(std::string_view) noexcept;
+};
+
+/** Builds a binary `GameEvent` packet containing one or more events.
+ *
+ * The buffer is retained by `Clear()`, so a long-lived builder stops
+ * allocating once it has grown to fit the largest packet.
+ */
+class GameEventPacketBuilder final {
+ public:
+  GameEventPacketBuilder();
+
+  void Clear() noexcept;
+  void Append(std::string_view name, std::string_view value);
+
+  size_t GetEventCount() const noexcept;
+  size_t GetByteCount() const noexcept;
+  std::span<const std::byte> GetBytes() const noexcept;
+
+  static constexpr size_t GetRecordByteCount(
+    std::string_view name,
+    std::string_view value) noexcept {
+    return GameEventWire::RecordHeaderSize + name.size() + value.size();
+  }
+
+ private:
+  std::vector<std::byte> mBuffer;
+  uint32_t mEventCount {0};
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,150 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/GameEvent.h>
+
+#include <shims/filesystem>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** Recorded `GameEvent` stream format.
+ *
+ * - 8 bytes: magic ("OKGEREC" followed by 0x1a)
+ * - uint16 (little-endian): version (1)
+ * - for each event, as unsigned LEB128 varints:
+ *   - microseconds since the previous event (or since recording started)
+ *   - name index; 0 is a new name, which is followed by its byte count and
+ *     bytes, and is assigned the next index starting from 1
+ *   - value byte count, followed by the value bytes
+ *
+ * Names are usually repeated, so this is typically only a few bytes more
+ * than the values.
+ */
+namespace GameEventRecordingFormat {
+constexpr std::string_view Magic {"OKGEREC\x1a", 8};
+constexpr uint16_t Version = 1;
+constexpr size_t HeaderSize = Magic.size() + sizeof(uint16_t);
+}// namespace GameEventRecordingFormat
+
+struct GameEventRecord {
+  // Since the recording started
+  std::chrono::microseconds mTimestamp {};
+  GameEvent mEvent;
+};
+
+class GameEventRecordingWriter final {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Throws std::runtime_error if the file can't be opened
+  explicit GameEventRecordingWriter(const std::filesystem::path&);
+  ~GameEventRecordingWriter();
+
+  GameEventRecordingWriter() = delete;
+  GameEventRecordingWriter(const GameEventRecordingWriter&) = delete;
+  GameEventRecordingWriter& operator=(const GameEventRecordingWriter&)
+    = delete;
+
+  void Write(
+    Clock::time_point receivedAt,
+    std::string_view name,
+    std::string_view value);
+  void Flush();
+
+ private:
+  std::ofstream mStream;
+  std::optional<Clock::time_point> mPreviousTime;
+  std::unordered_map<std::string, uint64_t> mNameIndices;
+  std::string mBuffer;
+};
+
+class GameEventRecordingReader final {
+ public:
+  /// Throws std::runtime_error if the file can't be read
+  explicit GameEventRecordingReader(const std::filesystem::path&);
+  explicit GameEventRecordingReader(std::string contents);
+
+  GameEventRecordingReader() = delete;
+
+  /// False if the header is missing or an unsupported version
+  bool IsValid() const noexcept;
+  /// True if `Next()` stopped because the data was truncated or corrupt
+  bool IsCorrupt() const noexcept;
+
+  std::optional<GameEventRecord> Next();
+
+ private:
+  std::string mContents;
+  size_t mOffset {0};
+  bool mValid {false};
+  bool mCorrupt {false};
+  std::chrono::microseconds mTimestamp {};
+  std::vector<std::string> mNames;
+
+  void ReadHeader();
+};
+
+struct GameEventReplayOptions {
+  // 1 is real time, 2 is twice as fast, and so on; 0 is as fast as possible
+  double mSpeed {1.0};
+  /* Called before waiting for the next event, and after the last event;
+   * useful for dispatching a batch.
+   */
+  std::function<void()> mBeforeWait {};
+  // Checked before each event, and interrupts the default sleep
+  std::stop_token mStopToken {};
+  // Replaces the default sleep, e.g. for a virtual clock
+  std::function<void(std::chrono::steady_clock::time_point)> mSleepUntil {};
+};
+
+struct GameEventReplayStats {
+  uint64_t mEventCount {0};
+  // Timestamp of the last event
+  std::chrono::microseconds mRecordedDuration {};
+  std::chrono::nanoseconds mWallTime {};
+  // Worst delay between when an event was due, and when it was replayed
+  std::chrono::nanoseconds mMaxLag {};
+  bool mCorrupt {false};
+  bool mStopped {false};
+};
+
+/** Replay every remaining event from the reader to `sink`, in order.
+ *
+ * The sequence of events is always identical; only the wall-clock timing
+ * depends on `mSpeed`.
+ */
+GameEventReplayStats ReplayGameEvents(
+  GameEventRecordingReader&,
+  const GameEventReplayOptions&,
+  const std::function<void(const GameEvent&)>& sink);
+
+}// namespace OpenKneeboard
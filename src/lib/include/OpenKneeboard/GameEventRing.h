@@ -0,0 +1,122 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** A single-producer, single-consumer queue of `GameEventPacket`s in a
+ * caller-provided memory block, such as a shared memory mapping.
+ *
+ * The block contains a header followed by the data area; positions are
+ * free-running 64-bit byte counts, so the producer and consumer never need to
+ * share anything except the block itself. Each record is a little-endian
+ * uint32 byte count followed by the packet, and may wrap around the end of
+ * the data area.
+ *
+ * This does not wait or signal; pair it with an OS event for wakeups.
+ */
+class GameEventRing final {
+ public:
+  static constexpr uint32_t Magic = 0x474b4f52;// "ROKG" in little-endian
+  static constexpr uint32_t Version = 3;
+
+  struct Header;
+
+  /// Total size of the memory block for the given data capacity
+  static size_t GetByteCount(size_t capacity) noexcept;
+
+  /** Initialize a new ring in `memory`; this is done by the producer.
+   *
+   * The capacity is the largest power of two that fits.
+   */
+  static std::optional<GameEventRing> Create(
+    void* memory,
+    size_t byteCount) noexcept;
+  /// Attach to a ring that was created by another process
+  static std::optional<GameEventRing> Open(
+    void* memory,
+    size_t byteCount) noexcept;
+
+  // Producer only
+
+  /// Returns false without writing anything if there is not enough space
+  bool TryWrite(std::span<const std::byte> packet) noexcept;
+  /** Stop using the ring, e.g. because the consumer stopped responding.
+   *
+   * The consumer stops reading when it sees this, so that the packets that
+   * are still in the ring are not delivered out of order with anything the
+   * producer sends some other way; they are dropped.
+   */
+  void Abandon() noexcept;
+
+  // Consumer only
+
+  /** Copies the next packet into `buffer`, replacing its contents.
+   *
+   * Returns false if the ring is empty or abandoned. If the ring is corrupt,
+   * it is emptied.
+   */
+  bool TryRead(std::vector<char>& buffer);
+
+  void SetConsumerAttached(bool) noexcept;
+  /// Call at least once per producer timeout while attached; see below
+  void Heartbeat() noexcept;
+
+  /** Producer only: true if the consumer is attached, and its heartbeat has
+   * changed within `timeout`.
+   *
+   * A consumer that crashes never clears the attached flag, so the producer
+   * tracks when it last saw the heartbeat change.
+   */
+  bool IsConsumerAlive(
+    std::chrono::steady_clock::time_point now,
+    std::chrono::steady_clock::duration timeout) noexcept;
+
+  // Either side
+
+  bool IsConsumerAttached() const noexcept;
+  bool IsAbandoned() const noexcept;
+  size_t GetCapacity() const noexcept;
+  size_t GetPendingByteCount() const noexcept;
+
+ private:
+  GameEventRing(Header*, std::byte* data, size_t capacity) noexcept;
+
+  Header* mHeader {nullptr};
+  std::byte* mData {nullptr};
+  size_t mCapacity {0};
+
+  // Producer-side heartbeat tracking
+  uint64_t mLastHeartbeat {0};
+  std::optional<std::chrono::steady_clock::time_point> mLastHeartbeatChange;
+
+  void CopyIn(uint64_t position, const std::byte* source, size_t size) noexcept;
+  void CopyOut(uint64_t position, std::byte* dest, size_t size) const noexcept;
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,131 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/GameEvent.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <thread>
+
+namespace OpenKneeboard {
+
+/// Where a `GameEventSender` writes its packets to
+class GameEventTransport {
+ public:
+  virtual ~GameEventTransport();
+
+  /** Write a complete packet.
+   *
+   * Returns false if the packet could not be delivered; the transport is
+   * responsible for any reconnection or retry throttling.
+   */
+  virtual bool Write(std::span<const std::byte> packet) = 0;
+};
+
+/** Sends `GameEvent`s from a background thread.
+ *
+ * `Enqueue()` only pushes to a bounded lock-free queue; a background thread
+ * batches everything that is waiting into a single `GameEventPacket` and
+ * writes it to the transport. This keeps the mailslot open/write off game
+ * threads.
+ *
+ * The destructor writes anything that's still queued; if the thread has
+ * already been terminated because the process is exiting, it does so from
+ * the calling thread. Events that it can't write are reported to
+ * `Options::mEventsAbandoned`.
+ */
+class GameEventSender final {
+ public:
+  enum class OverflowPolicy {
+    /// Discard the oldest queued event to make space
+    DropOldest,
+    /** Hold overflow events to the side, replacing any earlier held event with
+     * the same name; `EVT_MULTI_EVENT` is never coalesced.
+     *
+     * Held events are sent in the order of their latest value. Only a fixed
+     * number of events that can't be coalesced are held; past that, the
+     * oldest of them are dropped.
+     */
+    CoalesceByName,
+    /// Wait for space; this is the only policy where `Enqueue()` can block
+    Block,
+  };
+
+  struct Options {
+    // Rounded up to a power of two
+    size_t mQueueCapacity {1024};
+    OverflowPolicy mOverflowPolicy {OverflowPolicy::CoalesceByName};
+    // Single events larger than this are sent on their own
+    size_t mMaxPacketBytes {64 * 1024};
+    // How long the destructor waits for queued events to be written
+    std::chrono::milliseconds mShutdownTimeout {1000};
+    /** Called by the destructor with the number of events that it gave up
+     * on, e.g. to log them; not called if everything was written.
+     */
+    std::function<void(uint64_t count)> mEventsAbandoned {};
+  };
+
+  struct Stats {
+    uint64_t mEnqueued {0};
+    uint64_t mDropped {0};
+    uint64_t mCoalesced {0};
+    uint64_t mPackets {0};
+    uint64_t mWriteFailures {0};
+  };
+
+  GameEventSender(std::unique_ptr<GameEventTransport>, const Options&);
+  ~GameEventSender();
+
+  GameEventSender() = delete;
+  GameEventSender(const GameEventSender&) = delete;
+  GameEventSender& operator=(const GameEventSender&) = delete;
+
+  void Enqueue(GameEvent);
+
+  /** Wait until everything enqueued so far has been handed to the transport.
+   *
+   * Returns false on timeout.
+   */
+  bool Flush(std::chrono::milliseconds timeout);
+
+  /** Write everything that's queued, then join the background thread.
+   *
+   * Later events are dropped, and counted in `Stats::mDropped`. This must not
+   * be called from `DllMain()`, as joining the thread needs the loader lock.
+   */
+  void Shutdown();
+
+  Stats GetStats() const;
+
+ private:
+  struct Impl;
+  // Shared with the flush thread, in case we need to detach it on shutdown
+  std::shared_ptr<Impl> p;
+  std::thread mFlusher;
+
+  bool IsFlusherRunning() const;
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,144 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/ImageDecoder.h>
+
+#include <shims/filesystem>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** Decodes images on a fixed number of background threads.
+ *
+ * Requests are decoded in priority order, and can be re-prioritized or
+ * cancelled until their callback is called; cancelling a request that is
+ * already being decoded asks the decoder to stop early.
+ *
+ * Threads are started on the first request.
+ */
+class ImageDecodePool final {
+ public:
+  using Key = uint64_t;
+  /// Called on a worker thread; empty if the image couldn't be decoded
+  using Callback = std::function<void(std::optional<DecodedImage>)>;
+
+  struct Stats {
+    uint64_t mRequested {0};
+    uint64_t mDecoded {0};
+    uint64_t mFailed {0};
+    // Cancelled before decoding started
+    uint64_t mCancelledQueued {0};
+    // Cancelled while decoding
+    uint64_t mCancelledRunning {0};
+    size_t mQueued {0};
+    size_t mRunning {0};
+  };
+
+  static size_t GetDefaultThreadCount() noexcept;
+
+  ImageDecodePool(
+    std::shared_ptr<ImageDecoder>,
+    size_t threadCount = GetDefaultThreadCount());
+  ~ImageDecodePool();
+
+  ImageDecodePool() = delete;
+  ImageDecodePool(const ImageDecodePool&) = delete;
+  ImageDecodePool& operator=(const ImageDecodePool&) = delete;
+
+  ImageDecoder* GetDecoder() const noexcept;
+
+  /** Decodes `path` in the background, and passes the result to `callback`.
+   *
+   * The image is scaled down to fit within `maxSize`; see
+   * `ImageDecoder::Decode()`.
+   *
+   * Lower priorities are decoded first; requests with the same priority are
+   * decoded in the order they were first made.
+   *
+   * If `key` is already queued, this only changes its size and priority. If
+   * it's already being decoded, this does nothing.
+   */
+  void Request(
+    Key key,
+    const std::filesystem::path& path,
+    const ImageSize& maxSize,
+    int priority,
+    Callback callback);
+
+  /** Cancels a queued or running request.
+   *
+   * Its callback won't be called, unless it has already started. Returns
+   * false if there was nothing to cancel.
+   */
+  bool Cancel(Key);
+  /// Cancels every queued or running request where `pred(key)` is true
+  size_t CancelIf(const std::function<bool(Key)>& pred);
+
+  /// Blocks until nothing is queued or running; mostly for tests
+  void WaitForIdle();
+
+  Stats GetStats() const;
+
+ private:
+  using Order = std::pair<int, uint64_t>;
+  struct QueuedRequest {
+    std::filesystem::path mPath;
+    ImageSize mMaxSize;
+    Order mOrder;
+    Callback mCallback;
+  };
+
+  const std::shared_ptr<ImageDecoder> mDecoder;
+  const size_t mThreadCount;
+
+  mutable std::mutex mMutex;
+  std::condition_variable_any mWake;
+  std::condition_variable_any mIdle;
+
+  std::unordered_map<Key, QueuedRequest> mQueued;
+  std::map<Order, Key> mQueue;
+  // Cancelled requests are removed immediately, even if the decoder hasn't
+  // stopped yet, so they can be requested again
+  std::unordered_map<Key, std::stop_source> mRunning;
+  // Includes cancelled decodes that haven't stopped yet
+  size_t mActiveThreads {0};
+  uint64_t mNextSequence {0};
+  Stats mStats;
+
+  std::vector<std::jthread> mThreads;
+
+  void Run(std::stop_token);
+};
+
+}// namespace OpenKneeboard
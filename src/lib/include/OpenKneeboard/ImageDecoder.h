@@ -0,0 +1,114 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <shims/filesystem>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stop_token>
+#include <vector>
+
+namespace OpenKneeboard {
+
+struct ImageSize {
+  uint32_t mWidth {};
+  uint32_t mHeight {};
+
+  constexpr bool operator==(const ImageSize&) const noexcept = default;
+};
+
+/// For `ImageDecoder::Decode()`, to decode at the size in the file
+constexpr ImageSize UnboundedImageSize {
+  std::numeric_limits<uint32_t>::max(),
+  std::numeric_limits<uint32_t>::max(),
+};
+
+/** The largest size with the same aspect ratio as `size` that fits within
+ * `bounds`.
+ *
+ * Never larger than `size`, and never smaller than 1x1.
+ */
+constexpr ImageSize ScaleToFit(
+  const ImageSize& size,
+  const ImageSize& bounds) noexcept {
+  if (size.mWidth <= bounds.mWidth && size.mHeight <= bounds.mHeight) {
+    return size;
+  }
+  // Compare `bounds.mWidth / size.mWidth` to `bounds.mHeight / size.mHeight`
+  const auto widthLimited = uint64_t {bounds.mWidth} * size.mHeight
+    <= uint64_t {bounds.mHeight} * size.mWidth;
+  if (widthLimited) {
+    const auto height
+      = (uint64_t {size.mHeight} * bounds.mWidth) / size.mWidth;
+    return {
+      std::max<uint32_t>(bounds.mWidth, 1),
+      std::max<uint32_t>(static_cast<uint32_t>(height), 1),
+    };
+  }
+  const auto width = (uint64_t {size.mWidth} * bounds.mHeight) / size.mHeight;
+  return {
+    std::max<uint32_t>(static_cast<uint32_t>(width), 1),
+    std::max<uint32_t>(bounds.mHeight, 1),
+  };
+}
+
+/// 32bpp premultiplied BGRA, top-down, with no padding between rows
+struct DecodedImage {
+  static constexpr size_t BytesPerPixel = 4;
+
+  ImageSize mSize;
+  // The size in the file; larger than `mSize` if it was scaled down
+  ImageSize mNativeSize;
+  std::vector<std::byte> mPixels {};
+
+  constexpr size_t GetStride() const noexcept {
+    return mSize.mWidth * BytesPerPixel;
+  }
+};
+
+/// Reads image files; implementations must be thread-safe
+class ImageDecoder {
+ public:
+  virtual ~ImageDecoder();
+
+  /// Reads the size from the file header, without decoding any pixels
+  virtual std::optional<ImageSize> ReadSize(const std::filesystem::path&) = 0;
+
+  /** Decodes the first frame, scaled down to `ScaleToFit(size, maxSize)`.
+   *
+   * Implementations should scale while decoding where the format allows it,
+   * e.g. JPEG's DCT scaling, rather than decoding at full size first.
+   *
+   * Returns nothing if the file can't be decoded, or if `stopToken` is
+   * triggered first; implementations should check it regularly, e.g. every
+   * few rows.
+   */
+  virtual std::optional<DecodedImage> Decode(
+    const std::filesystem::path&,
+    const ImageSize& maxSize,
+    std::stop_token stopToken)
+    = 0;
+};
+
+}// namespace OpenKneeboard
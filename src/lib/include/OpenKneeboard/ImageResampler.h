@@ -0,0 +1,37 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/ImageDecoder.h>
+
+namespace OpenKneeboard {
+
+/** Resizes an image with a separable Catmull-Rom (bicubic) filter.
+ *
+ * When downscaling, the filter is widened to cover every source pixel, so
+ * fine detail is averaged instead of aliasing; this is what makes it
+ * suitable for fitting large scans or photos to the kneeboard.
+ *
+ * Works in fixed point on the premultiplied values; results are clamped so
+ * that they remain valid premultiplied colors.
+ */
+DecodedImage ResampleImage(const DecodedImage&, const ImageSize& size);
+
+}// namespace OpenKneeboard
@@ -0,0 +1,40 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/ImageDecoder.h>
+
+namespace OpenKneeboard {
+
+/** Decodes JPEG files with libjpeg-turbo.
+ *
+ * Unlike WIC, this is portable, so it can be used to test and benchmark
+ * `ImageDecodePool` anywhere.
+ */
+class JPEGImageDecoder final : public ImageDecoder {
+ public:
+  std::optional<ImageSize> ReadSize(const std::filesystem::path&) override;
+  std::optional<DecodedImage> Decode(
+    const std::filesystem::path&,
+    const ImageSize& maxSize,
+    std::stop_token) override;
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,195 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace OpenKneeboard {
+
+struct LRUCacheStats {
+  uint64_t mHits {0};
+  uint64_t mMisses {0};
+  uint64_t mInsertions {0};
+  uint64_t mEvictions {0};
+
+  size_t mEntryCount {0};
+  size_t mCost {0};
+  size_t mBudget {0};
+
+  constexpr double GetHitRate() const noexcept {
+    const auto lookups = mHits + mMisses;
+    return lookups ? (static_cast<double>(mHits) / lookups) : 0;
+  }
+};
+
+/** A least-recently-used cache with a total cost budget.
+ *
+ * Each entry has a caller-defined cost, e.g. its size in bytes; when an
+ * insertion would take the total over budget, the least-recently used entries
+ * are evicted until it fits.
+ *
+ * This is not thread-safe.
+ */
+template <
+  class TKey,
+  class TValue,
+  class THash = std::hash<TKey>,
+  class TKeyEqual = std::equal_to<TKey>>
+class LRUCache final {
+ public:
+  using Stats = LRUCacheStats;
+
+  explicit LRUCache(size_t budget) : mBudget(budget) {
+  }
+
+  LRUCache(const LRUCache&) = delete;
+  LRUCache& operator=(const LRUCache&) = delete;
+
+  /// Returns nullptr on a miss; on a hit, marks the entry as most recently used
+  TValue* Get(const TKey& key) {
+    auto it = mIndex.find(key);
+    if (it == mIndex.end()) {
+      ++mStats.mMisses;
+      return nullptr;
+    }
+    ++mStats.mHits;
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    return &it->second->mValue;
+  }
+
+  bool Contains(const TKey& key) const {
+    return mIndex.contains(key);
+  }
+
+  /** Insert or replace an entry, making it the most recently used.
+   *
+   * Returns false without caching anything if `cost` is greater than the
+   * whole budget.
+   */
+  bool Insert(const TKey& key, TValue value, size_t cost) {
+    this->Erase(key);
+    if (cost > mBudget) {
+      return false;
+    }
+    this->EvictUntil(mBudget - cost);
+
+    mEntries.push_front({key, std::move(value), cost});
+    mIndex.emplace(key, mEntries.begin());
+    mCost += cost;
+    ++mStats.mInsertions;
+    return true;
+  }
+
+  bool Erase(const TKey& key) {
+    auto it = mIndex.find(key);
+    if (it == mIndex.end()) {
+      return false;
+    }
+    mCost -= it->second->mCost;
+    mEntries.erase(it->second);
+    mIndex.erase(it);
+    return true;
+  }
+
+  /// Erase every entry where `pred(key, value)` is true; not counted as
+  /// evictions
+  template <class TPred>
+  size_t EraseIf(TPred&& pred) {
+    size_t count = 0;
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+      if (!pred(std::as_const(it->mKey), std::as_const(it->mValue))) {
+        ++it;
+        continue;
+      }
+      mCost -= it->mCost;
+      mIndex.erase(it->mKey);
+      it = mEntries.erase(it);
+      ++count;
+    }
+    return count;
+  }
+
+  void Clear() {
+    mEntries.clear();
+    mIndex.clear();
+    mCost = 0;
+  }
+
+  void SetBudget(size_t budget) {
+    mBudget = budget;
+    this->EvictUntil(budget);
+  }
+
+  size_t GetBudget() const noexcept {
+    return mBudget;
+  }
+
+  size_t GetCost() const noexcept {
+    return mCost;
+  }
+
+  Stats GetStats() const noexcept {
+    auto ret = mStats;
+    ret.mEntryCount = mIndex.size();
+    ret.mCost = mCost;
+    ret.mBudget = mBudget;
+    return ret;
+  }
+
+  void ResetStats() noexcept {
+    mStats = {};
+  }
+
+ private:
+  struct Entry {
+    TKey mKey;
+    TValue mValue;
+    size_t mCost;
+  };
+  // Most recently used first
+  std::list<Entry> mEntries;
+  std::unordered_map<
+    TKey,
+    typename std::list<Entry>::iterator,
+    THash,
+    TKeyEqual>
+    mIndex;
+
+  size_t mBudget {0};
+  size_t mCost {0};
+  Stats mStats;
+
+  void EvictUntil(size_t maxCost) {
+    while (mCost > maxCost && !mEntries.empty()) {
+      auto& entry = mEntries.back();
+      mCost -= entry.mCost;
+      mIndex.erase(entry.mKey);
+      mEntries.pop_back();
+      ++mStats.mEvictions;
+    }
+  }
+};
+
+}// namespace OpenKneeboard
@@ -21,20 +21,28 @@
 #pragma once
 
 #include <OpenKneeboard/inttypes.h>
-#include <d2d1.h>
 
 #include <cinttypes>
+#include <cstring>
+#include <functional>
 #include <map>
 #include <memory>
 #include <shims/filesystem>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
+namespace OpenKneeboard {
+class FileSnapshot;
+}
+
 namespace OpenKneeboard::PDFNavigation {
 
 struct Bookmark final {
   std::string mName;
   PageIndex mPageIndex;
+  auto operator<=>(const Bookmark&) const = default;
 };
 
 enum class DestinationType {
@@ -45,29 +53,89 @@ enum class DestinationType {
 struct Destination final {
   DestinationType mType;
   PageIndex mPageIndex = 0;
-  std::string mURI;
+  std::string mURI {};
   auto operator<=>(const Destination&) const = default;
 };
 
+/** Normalized page coordinates, from the top left.
+ *
+ * Laid out like `D2D1_RECT_F`, but this library doesn't depend on Direct2D;
+ * callers convert where they draw.
+ */
+struct Rect final {
+  float left {};
+  float top {};
+  float right {};
+  float bottom {};
+
+  /// Bitwise, so that cached NaNs compare equal to what was stored
+  bool operator==(const Rect& other) const noexcept {
+    return std::memcmp(this, &other, sizeof(Rect)) == 0;
+  }
+};
+
 struct Link final {
-  D2D1_RECT_F mRect;
+  Rect mRect;
   Destination mDestination;
 
-  constexpr bool operator==(const Link& other) const noexcept {
-    return mDestination == other.mDestination
-      && memcmp(&mRect, &other.mRect, sizeof(mRect)) == 0;
-  }
+  bool operator==(const Link&) const noexcept = default;
+};
+
+/// A line of text, in normalized page coordinates like `Link::mRect`
+struct TextLine final {
+  std::string mText;
+  Rect mRect;
 };
 
 class PDF final {
  public:
+  /** Receives diagnostics about malformed files, e.g. to log them.
+   *
+   * Called on whichever thread hit the problem; without one, they're
+   * discarded.
+   */
+  using Logger = std::function<void(std::string_view message)>;
+
   PDF() = delete;
-  PDF(const std::filesystem::path&);
+  explicit PDF(const std::filesystem::path&, Logger = {});
+  /** Parse a PDF that's already in memory.
+   *
+   * The path is only used for diagnostics. The content is not copied, so it
+   * must outlive this object.
+   */
+  PDF(
+    const std::filesystem::path&,
+    std::span<const std::byte> content,
+    Logger = {});
+  /// Parse a snapshot, keeping it alive for as long as this object
+  explicit PDF(std::shared_ptr<const FileSnapshot>, Logger = {});
   ~PDF();
 
+  PageIndex GetPageCount() const;
+
   std::vector<Bookmark> GetBookmarks();
+  /// All pages; reuses links that have already been extracted
   std::vector<std::vector<Link>> GetLinks();
 
+  /** Links for a single page.
+   *
+   * Annotations are parsed on the first request for each page, then
+   * memoized. All methods are thread-safe, so this can be called from a
+   * render thread while another thread is in `GetLinks()`.
+   */
+  std::vector<Link> GetLinks(PageIndex);
+  /// Extract links for pages in [first, first + count), if not already done
+  void PrefetchLinks(PageIndex first, PageIndex count);
+
+  /** Approximate text of a page, for searching.
+   *
+   * Only literal text in the page's own content stream is extracted; text
+   * in form XObjects, and text in fonts without an ASCII-compatible
+   * encoding, is skipped. Positions are estimated from the font size, not
+   * from glyph metrics.
+   */
+  std::vector<TextLine> GetText(PageIndex);
+
  private:
   struct Impl;
   std::unique_ptr<Impl> p;
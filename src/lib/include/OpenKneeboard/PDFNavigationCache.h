@@ -0,0 +1,98 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/FileSnapshot.h>
+#include <OpenKneeboard/PDFNavigation.h>
+
+#include <shims/filesystem>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace OpenKneeboard::PDFNavigation {
+
+/// Everything we extract from a PDF with QPDF
+struct Navigation final {
+  std::vector<Bookmark> mBookmarks {};
+  std::vector<std::vector<Link>> mLinks {};
+
+  bool operator==(const Navigation&) const = default;
+};
+
+/** An on-disk cache of `Navigation`, keyed by file content.
+ *
+ * Entries are keyed by size and content hash rather than by path, so
+ * renamed or re-saved files still hit the cache.
+ *
+ * Format - all integers are little-endian:
+ *
+ * - 4 bytes: magic ("OKPN")
+ * - uint32: format version
+ * - uint64: PDF size
+ * - uint64: PDF content hash
+ * - uint64: payload byte count
+ * - uint64: payload hash
+ * - payload:
+ *   - uint32: bookmark count
+ *   - for each bookmark: uint32 name byte count, name (UTF-8), uint64 page
+ *   - uint32: page count
+ *   - for each page: uint32 link count, then for each link: 4 float32
+ *     (left, top, right, bottom), uint8 destination type, uint64 page,
+ *     uint32 URI byte count, URI (UTF-8)
+ *
+ * Entries are written to a temporary file then renamed into place, so
+ * readers never see partial entries; anything that fails validation is
+ * treated as a miss.
+ */
+class NavigationCache final {
+ public:
+  static constexpr std::string_view Magic {"OKPN"};
+  static constexpr uint32_t Version = 1;
+  static constexpr size_t HeaderSize = 40;
+  static constexpr size_t MaxEntries = 64;
+
+  NavigationCache() = delete;
+  explicit NavigationCache(const std::filesystem::path& directory);
+
+  std::optional<Navigation> Load(const FileIdentity&) const;
+  /// Returns false on failure; failing to write the cache isn't fatal
+  bool Store(const FileIdentity&, const Navigation&) const;
+
+  std::filesystem::path GetEntryPath(const FileIdentity&) const;
+
+  static std::vector<std::byte> Serialize(
+    const FileIdentity&,
+    const Navigation&);
+  static std::optional<Navigation> Deserialize(
+    std::span<const std::byte>,
+    const FileIdentity&);
+
+ private:
+  std::filesystem::path mDirectory;
+
+  void Prune() const;
+};
+
+}// namespace OpenKneeboard::PDFNavigation
@@ -0,0 +1,165 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/FileSnapshot.h>
+#include <OpenKneeboard/ImageDecoder.h>
+
+#include <shims/filesystem>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/// Identifies a render of a page of a specific version of a file
+struct PageImageKey final {
+  std::filesystem::path mPath;
+  // Must have a content hash, i.e. come from a `FileSnapshot`
+  FileIdentity mSource;
+  uint64_t mPage {};
+  ImageSize mSize;
+};
+
+/** An on-disk cache of rendered or decoded pages, so they don't need to be
+ * decoded from the source file again on the next launch.
+ *
+ * Entries are keyed by path, file identity, page, and size; the page
+ * sources only ever ask for a few sizes per page, so the same file at
+ * different sizes - e.g. navigation previews - gets separate entries.
+ *
+ * Format - all integers are little-endian:
+ *
+ * - 4 bytes: magic ("OKPI")
+ * - uint32: format version
+ * - uint64: source size
+ * - int64: source modification time, in `file_time_type` ticks
+ * - uint64: source content hash
+ * - uint64: page
+ * - uint32: key width, uint32: key height
+ * - uint32: image width, uint32: image height
+ * - uint32: native width, uint32: native height
+ * - uint64: payload byte count
+ * - uint64: payload hash
+ * - uint32: path byte count, path (UTF-8)
+ * - payload: deflated BGRA pixels, top-down, with each byte stored as the
+ *   difference from the same channel of the pixel to its left
+ *
+ * Compression is lossless, so a cached page looks exactly like a decoded
+ * one.
+ *
+ * Entries are written to a temporary file then renamed into place, so
+ * readers never see partial entries; anything that fails validation is
+ * treated as a miss. The least recently used entries are removed when the
+ * total size is over budget, along with temporary files left behind by
+ * crashes.
+ *
+ * The directory is only listed on the first load or store, and when the
+ * total goes over budget; in between, the total and the set of entries are
+ * tracked in memory. Entries written by other processes are picked up by the
+ * next listing.
+ */
+class PageImageCache final {
+ public:
+  static constexpr std::string_view Magic {"OKPI"};
+  static constexpr uint32_t Version = 1;
+  static constexpr uint64_t DefaultMaxBytes = 256 * 1024 * 1024;
+  // Also limits how much memory a corrupt entry can make us allocate
+  static constexpr uint32_t MaxDimension = 16384;
+  // Pages waiting for `StoreInBackground()` are dropped past this
+  static constexpr size_t MaxQueuedBytes = 64 * 1024 * 1024;
+
+  PageImageCache() = delete;
+  PageImageCache(const PageImageCache&) = delete;
+  PageImageCache& operator=(const PageImageCache&) = delete;
+
+  explicit PageImageCache(
+    const std::filesystem::path& directory,
+    uint64_t maxBytes = DefaultMaxBytes);
+
+  std::optional<DecodedImage> Load(const PageImageKey&) const;
+  /** Whether `Load()` might find the key, without touching the disk.
+   *
+   * Returns true until the directory has been listed, so a false result
+   * means the page definitely needs decoding.
+   */
+  bool MayContain(const PageImageKey&) const;
+  /// Returns false on failure; failing to write the cache isn't fatal
+  bool Store(const PageImageKey&, const DecodedImage&) const;
+  /** Stores on a background thread, so callers don't wait for compression.
+   *
+   * Does nothing if too much is already queued; the page will just be
+   * decoded again next time.
+   */
+  void StoreInBackground(PageImageKey, DecodedImage);
+  /// Blocks until nothing is queued or being stored; mostly for tests
+  void WaitForIdle();
+
+  std::filesystem::path GetEntryPath(const PageImageKey&) const;
+
+  static std::vector<std::byte> Serialize(
+    const PageImageKey&,
+    const DecodedImage&);
+  static std::optional<DecodedImage> Deserialize(
+    std::span<const std::byte>,
+    const PageImageKey&);
+
+ private:
+  const std::filesystem::path mDirectory;
+  const uint64_t mMaxBytes;
+
+  std::mutex mMutex;
+  std::condition_variable_any mWake;
+  std::condition_variable_any mIdle;
+  std::deque<std::pair<PageImageKey, DecodedImage>> mQueue;
+  size_t mQueuedBytes {0};
+  bool mStoring {false};
+
+  mutable std::mutex mIndexMutex;
+  // Total size of entries; empty until the directory has been listed
+  mutable std::optional<uint64_t> mTotalBytes;
+  // Name hashes of the entries; only valid once `mTotalBytes` is set
+  mutable std::unordered_set<uint64_t> mEntries;
+
+  // Last, so it's stopped before anything it uses is destroyed
+  std::jthread mWriter;
+
+  void AddEntry(uint64_t entryHash, uint64_t entryBytes) const;
+  /** Lists the directory, removing entries if over budget.
+   *
+   * Returns the total size of the remaining entries, and replaces
+   * `mEntries`; the caller must hold `mIndexMutex`.
+   */
+  uint64_t Prune() const;
+  void Run(std::stop_token);
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,141 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** A small LRU cache of per-page layouts, such as `IDWriteTextLayout`s.
+ *
+ * Entries are invalidated when:
+ * - the page's content generation changes; this must change whenever the
+ *   page's content does
+ * - the style generation changes; this should change whenever anything
+ *   else that affects layout does, such as the font or its size. This
+ *   invalidates every page.
+ * - `Clear()` is called
+ *
+ * `TLayout` is opaque to the cache, so the policy can be tested and
+ * benchmarked without a renderer.
+ *
+ * Not thread-safe.
+ */
+template <class TLayout>
+class PageLayoutCache final {
+ public:
+  struct Key {
+    uint64_t mPageKey {};
+    uint64_t mContentGeneration {};
+
+    bool operator==(const Key&) const = default;
+  };
+
+  struct Stats {
+    uint64_t mHits {};
+    uint64_t mMisses {};
+    // Misses because the page's content changed
+    uint64_t mStaleEntries {};
+    uint64_t mEvictions {};
+    // Clears, including style changes
+    uint64_t mInvalidations {};
+  };
+
+  PageLayoutCache() = delete;
+  explicit PageLayoutCache(size_t capacity)
+    : mCapacity(std::max<size_t>(1, capacity)) {
+  }
+
+  void SetStyleGeneration(uint64_t generation) {
+    if (generation == mStyleGeneration) {
+      return;
+    }
+    mStyleGeneration = generation;
+    this->Clear();
+  }
+
+  void Clear() {
+    if (mEntries.empty()) {
+      return;
+    }
+    mEntries.clear();
+    ++mStats.mInvalidations;
+  }
+
+  /// `create` is only called on a miss, and must return a `TLayout`
+  template <class F>
+  const TLayout& GetOrCreate(const Key& key, F&& create) {
+    ++mUseCount;
+    auto it = std::ranges::find(mEntries, key.mPageKey, [](const auto& entry) {
+      return entry.mKey.mPageKey;
+    });
+    if (it != mEntries.end()) {
+      if (it->mKey == key) {
+        ++mStats.mHits;
+        it->mLastUse = mUseCount;
+        return it->mLayout;
+      }
+      ++mStats.mStaleEntries;
+      ++mStats.mMisses;
+      *it = {key, mUseCount, std::forward<F>(create)()};
+      return it->mLayout;
+    }
+
+    ++mStats.mMisses;
+    if (mEntries.size() < mCapacity) {
+      mEntries.push_back({key, mUseCount, std::forward<F>(create)()});
+      return mEntries.back().mLayout;
+    }
+
+    ++mStats.mEvictions;
+    auto& lru = *std::ranges::min_element(
+      mEntries, {}, [](const auto& entry) { return entry.mLastUse; });
+    lru = {key, mUseCount, std::forward<F>(create)()};
+    return lru.mLayout;
+  }
+
+  size_t GetSize() const noexcept {
+    return mEntries.size();
+  }
+
+  Stats GetStats() const noexcept {
+    return mStats;
+  }
+
+ private:
+  struct Entry {
+    Key mKey;
+    uint64_t mLastUse {};
+    TLayout mLayout;
+  };
+
+  // Usually only a handful of pages, so a linear search beats hashing
+  std::vector<Entry> mEntries;
+  size_t mCapacity {};
+  uint64_t mStyleGeneration {};
+  uint64_t mUseCount {};
+  Stats mStats;
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,110 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/inttypes.h>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** Tracks per-page work that's done on demand, e.g. extracting links.
+ *
+ * `Claim()` picks the requested page and its neighbours, skipping pages that
+ * are done or already queued; the caller does the work outside of its lock,
+ * then calls `Complete()` to find out whether the result is still wanted.
+ *
+ * `Reset()` starts a new generation, e.g. when the file is reloaded; results
+ * for earlier generations are rejected, and don't affect pages queued since.
+ *
+ * This is not thread-safe; callers should hold their own lock.
+ */
+template <class TPageID, class THash = std::hash<TPageID>>
+class PagePrefetchQueue final {
+ public:
+  struct Request {
+    TPageID mPageID;
+    PageIndex mPageIndex;
+    uint64_t mGeneration;
+  };
+
+  /** Queue `index` and the pages readers usually move to next.
+   *
+   * `isDone(pageID)` should return true for pages that don't need the work.
+   * Returns the newly-queued pages, in the order they should be done.
+   */
+  template <class TIsDone>
+  std::vector<Request> Claim(
+    std::span<const TPageID> pageIDs,
+    PageIndex index,
+    TIsDone&& isDone) {
+    std::vector<Request> ret;
+    if (index >= pageIDs.size()) {
+      return ret;
+    }
+    for (const auto i: {index, index + 1, index - 1, index + 2}) {
+      // `index - 1` wraps around for the first page
+      if (i >= pageIDs.size()) {
+        continue;
+      }
+      const auto& id = pageIDs[i];
+      if (isDone(id) || !mPending.insert(id).second) {
+        continue;
+      }
+      ret.push_back({id, i, mGeneration});
+    }
+    return ret;
+  }
+
+  bool IsPending(const TPageID& id) const {
+    return mPending.contains(id);
+  }
+
+  /// Returns true if the result for `request` should be kept
+  bool Complete(const Request& request) {
+    if (request.mGeneration != mGeneration) {
+      // The page may have been queued again since the reset
+      return false;
+    }
+    mPending.erase(request.mPageID);
+    return true;
+  }
+
+  /// Forget queued pages, and reject their results
+  void Reset() {
+    mPending.clear();
+    ++mGeneration;
+  }
+
+  size_t GetPendingCount() const noexcept {
+    return mPending.size();
+  }
+
+ private:
+  // Only pages queued in the current generation
+  std::unordered_set<TPageID, THash> mPending;
+  uint64_t mGeneration {0};
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,146 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <shims/filesystem>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace OpenKneeboard {
+
+/** Incrementally reads a text file as UTF-8 with '\n' line endings.
+ *
+ * Files with a UTF-16 byte order mark are converted to UTF-8; a UTF-8 byte
+ * order mark is removed. CRLF is converted to LF; a lone CR is kept.
+ *
+ * After the first read, only data appended to the file is read, so a
+ * growing file such as a log can be followed cheaply. If the file shrinks,
+ * is replaced by another file (e.g. by a rename), or the data that was
+ * already read changes, it is treated as replaced, and read again from the
+ * beginning.
+ *
+ * Decoding is linear in the size of the new data. When the file has grown,
+ * checking that it was only appended to re-reads a bounded sample of the
+ * data that was already read: the first and last complete blocks, and
+ * anything after them. A change elsewhere that also grows the same file is
+ * not detected; editors that modify files in place usually rewrite the end
+ * of the file too.
+ *
+ * When the size hasn't changed, nothing was appended, but the file may have
+ * been edited in place - possibly keeping its last write time - so all of
+ * the data that was already read is re-read and compared, without decoding
+ * it. Only poll when the file may have changed, e.g. on a change
+ * notification.
+ *
+ * Not thread-safe.
+ */
+class PlainTextFileReader final {
+ public:
+  enum class Change {
+    None,
+    Appended,
+    // Discard anything previously read
+    Replaced,
+    // The file could not be read
+    Error,
+  };
+
+  PlainTextFileReader() = delete;
+  explicit PlainTextFileReader(const std::filesystem::path&);
+  ~PlainTextFileReader();
+
+  /// How the file has changed since the last `Read()`
+  Change Poll();
+  /** Passes all text appended since the last call to `onText`.
+   *
+   * `onText` may be called several times. Returns false if the file could
+   * not be read. If the file was replaced, call `Poll()` first.
+   */
+  bool Read(const std::function<void(std::string_view)>& onText);
+
+  /// The whole of `bytes`, decoded and normalized in one go
+  static std::string Decode(std::string_view bytes);
+
+ private:
+  enum class Encoding {
+    Unknown,
+    UTF8,
+    UTF16LE,
+    UTF16BE,
+  };
+
+  /// Volume and file index on Windows, device and inode elsewhere
+  struct FileID {
+    uint64_t mVolume {};
+    uint64_t mIndex {};
+
+    bool operator==(const FileID&) const noexcept = default;
+  };
+
+  std::filesystem::path mPath;
+  uint64_t mOffset {};
+  std::filesystem::file_time_type mLastWriteTime {};
+  std::optional<FileID> mFileID;
+  // Samples of the data read so far, used to detect the file being
+  // modified: `HashFileContent()` of the first and last complete
+  // `HashBlockSize` blocks, and the bytes read after the last complete block
+  uint64_t mBlockCount {};
+  uint64_t mFirstBlockHash {};
+  uint64_t mLastBlockHash {};
+  // Every complete block's hash, combined in order
+  uint64_t mAllBlocksHash {};
+  std::string mPartialBlock;
+
+  Encoding mEncoding {Encoding::Unknown};
+  // Bytes that don't yet form a complete UTF-16 code unit
+  std::string mPendingBytes;
+  // High surrogate waiting for its low surrogate
+  char16_t mPendingSurrogate {};
+  bool mPendingCR {false};
+
+  // Reused between reads
+  std::string mReadBuffer;
+  std::string mDecodeBuffer;
+  std::string mOutputBuffer;
+
+  static std::optional<FileID> GetFileID(const std::filesystem::path&);
+
+  void Reset();
+  /// Updates the samples with bytes read at `mOffset`
+  void HashConsumedBytes(std::string_view);
+  /// Whether the sampled parts of the first `mOffset` bytes are unchanged
+  bool IsConsumedDataUnchanged();
+  /// Whether all of the first `mOffset` bytes are unchanged
+  bool IsConsumedDataIdentical();
+  /// Returns the size of the byte order mark, if any
+  size_t DetectEncoding(std::string_view firstBytes);
+  void Decode(std::string_view bytes, std::string& out);
+  /// Flushes any pending state, for the end of a complete buffer
+  void Finish(std::string& out);
+  void DecodeUTF16(std::string_view bytes, std::string& out);
+  void NormalizeLineEndings(std::string_view text, std::string& out);
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,127 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/FileSnapshot.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** Wraps and paginates UTF-8 messages for a fixed-width font.
+ *
+ * This is append-only: each message is laid out once, when it's appended,
+ * and never revisited. Expanded text is kept in a single shared buffer;
+ * lines are ranges into that buffer, and pages are ranges of lines, so
+ * completing a page is O(1) no matter how much history there is.
+ *
+ * The oldest complete pages can be discarded to bound memory usage, for
+ * example after copying them to a `TextPageLog`; page indices are not
+ * affected.
+ *
+ * Lines are wrapped with `WrapLine()`: widths are measured in columns of a
+ * fixed-width font, lines are only broken between grapheme clusters, and
+ * preferably at Unicode line break opportunities.
+ *
+ * Not thread-safe.
+ */
+class PlainTextLayout final {
+ public:
+  struct Line {
+    size_t mOffset {};
+    size_t mLength {};
+  };
+
+  PlainTextLayout() = delete;
+  PlainTextLayout(int columns, int rows);
+
+  void Clear();
+  /// Returns the number of pages completed by this message
+  size_t Append(std::string_view message);
+  /** Appends to a continuous stream of text, such as a growing file.
+   *
+   * The result is the same as a single `Append()` of all the streamed text
+   * to an empty layout; the text does not need to end at a line break. If
+   * it ends part-way through a UTF-8 sequence, the start of the sequence is
+   * held back until the next call.
+   * Call `Clear()` first if the layout contains anything else.
+   *
+   * Returns the number of pages completed by this text.
+   */
+  size_t AppendStream(std::string_view text);
+  /// Completes the current page if it has any lines
+  bool EnsureNewPage();
+  /// Frees the oldest `count` complete pages that are still in memory
+  void DiscardCompletePages(size_t count);
+
+  /// The current (incomplete) page is at index `GetCompletePageCount()`
+  size_t GetCompletePageCount() const noexcept;
+  /// Pages before this have been discarded
+  size_t GetFirstResidentPage() const noexcept;
+  /// Throws std::out_of_range for discarded or future pages
+  std::span<const Line> GetPageLines(size_t pageIndex) const;
+  std::span<const Line> GetCurrentPageLines() const noexcept;
+  std::string_view GetText(const Line&) const noexcept;
+
+  /// Includes discarded lines
+  size_t GetLineCount() const noexcept;
+  /// Identifies the appended text and page breaks, in O(1)
+  FileIdentity GetIdentity() const noexcept;
+
+ private:
+  int mColumns {};
+  int mRows {};
+
+  // Only for resident pages; offsets and indices are relative to the first
+  // resident page
+  std::string mText;
+  std::vector<Line> mLines;
+  std::vector<size_t> mPageStarts;
+  size_t mCurrentPageStart {};
+
+  size_t mDiscardedPageCount {};
+  size_t mDiscardedLineCount {};
+  size_t mDiscardedTextBytes {};
+  uint64_t mContentHash {};
+
+  // Reused between calls to avoid reallocating for every message
+  std::vector<Line> mWrappedLines;
+  // If true, the last line came from `AppendStream()` and wasn't followed
+  // by a line break, so it may be extended by the next call
+  bool mStreamLineIsOpen {false};
+  // The start of a UTF-8 sequence at the end of the last streamed text
+  std::string mPendingStreamBytes;
+
+  /// Returns the offset of the expanded text in `mText`
+  size_t ExpandTabs(std::string_view);
+  /// Wraps `mText` from `offset` into `mWrappedLines`
+  void WrapLines(size_t offset);
+  size_t CurrentPageSize() const noexcept;
+  void PushLine(Line);
+  void PushPage();
+  void MixIntoHash(uint64_t) noexcept;
+};
+
+}// namespace OpenKneeboard
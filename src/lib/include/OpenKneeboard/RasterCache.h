@@ -0,0 +1,98 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/CoalescingCache.h>
+#include <shims/winrt/base.h>
+
+#include <cstdint>
+#include <functional>
+
+#include <d2d1_2.h>
+
+namespace OpenKneeboard {
+
+/** A shared cache of rendered bitmaps, with a VRAM budget.
+ *
+ * Entries are keyed by what they show rather than by who rendered them, so
+ * the same bitmap is shared by every view and layer showing the same content
+ * at the same size; concurrent requests for the same key only render once.
+ */
+class RasterCache final {
+ public:
+  /** `mSource` identifies where content comes from - e.g. a document's
+   * content hash, or a `CachedLayer` for content that only it can render -
+   * and `mContent` identifies the content within it, e.g. a page.
+   */
+  struct Key {
+    uint64_t mSource {};
+    uint64_t mContent {};
+    uint32_t mWidth {};
+    uint32_t mHeight {};
+
+    constexpr bool operator==(const Key&) const noexcept = default;
+  };
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key&) const noexcept;
+  };
+  using Cache = CoalescingCache<Key, winrt::com_ptr<ID2D1Bitmap1>, KeyHash>;
+
+ public:
+  using Stats = Cache::Stats;
+  using Renderer = std::function<winrt::com_ptr<ID2D1Bitmap1>()>;
+
+  static constexpr size_t DefaultByteBudget = 256 * 1024 * 1024;
+
+  /** A budget for a GPU with this much dedicated memory.
+   *
+   * An eighth of it, clamped to 128MiB-1GiB, or `DefaultByteBudget` if
+   * this is 0, e.g. for the software renderer.
+   */
+  static size_t GetByteBudgetForVideoMemory(uint64_t dedicatedVideoMemory);
+
+  RasterCache(size_t defaultByteBudget = DefaultByteBudget);
+  ~RasterCache();
+
+  RasterCache(const RasterCache&) = delete;
+  RasterCache& operator=(const RasterCache&) = delete;
+
+  winrt::com_ptr<ID2D1Bitmap1> GetOrRender(const Key&, const Renderer&);
+  /// Returns null if the bitmap isn't cached; doesn't wait for renders
+  winrt::com_ptr<ID2D1Bitmap1> Get(const Key&);
+  /** Erase all bitmaps for the source.
+   *
+   * Bitmaps that are being rendered for it are not cached when they finish;
+   * this does not affect other sources' renders.
+   */
+  void EraseSource(uint64_t source);
+
+  /// The budget that was passed to the constructor
+  size_t GetDefaultByteBudget() const noexcept;
+  void SetByteBudget(size_t);
+  Stats GetStats() const;
+
+ private:
+  const size_t mDefaultByteBudget;
+  Cache mCache;
+};
+
+}// namespace OpenKneeboard
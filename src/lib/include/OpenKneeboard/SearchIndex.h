@@ -0,0 +1,197 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/FileSnapshot.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/// Normalized page coordinates: (0, 0) is top-left, (1, 1) is bottom-right
+struct SearchRect final {
+  float mLeft {};
+  float mTop {};
+  float mRight {};
+  float mBottom {};
+
+  bool operator==(const SearchRect&) const = default;
+};
+
+/// A line or similar run of text, and where it is on the page
+struct SearchTextBlock final {
+  std::string mText;
+  SearchRect mRect {};
+};
+
+struct SearchPage final {
+  // Opaque to the index; usually a `PageID`'s temporary value
+  uint64_t mPageKey {};
+  std::vector<SearchTextBlock> mBlocks {};
+};
+
+struct SearchDocument final {
+  // Opaque to the index; usually a tab's runtime ID
+  uint64_t mDocumentKey {};
+  FileIdentity mIdentity;
+  std::vector<SearchPage> mPages {};
+};
+
+struct SearchHit final {
+  uint64_t mDocumentKey {};
+  uint64_t mPageKey {};
+  /// Every block on the page that matches the most query terms
+  std::vector<SearchRect> mRects {};
+  /// Text of the first best-matching block
+  std::string mSnippet {};
+  size_t mScore {};
+};
+
+/** An in-memory inverted index of the text in a set of documents.
+ *
+ * Queries match pages containing every term in the query; the last term
+ * is treated as a prefix, so results update sensibly while typing. Terms
+ * are case-insensitive for ASCII, and numbers such as "118.45" or "1,000"
+ * are kept as a single term.
+ *
+ * Memory is bounded: when the estimated size exceeds the budget, the
+ * least-recently-used documents are evicted. Evicted documents are not
+ * current for `IsCurrent()`, so callers index them again on their next
+ * update; if every document can't fit in the budget, that evicts
+ * others, so the budget should be sized for the whole set.
+ *
+ * All methods are thread-safe.
+ */
+class SearchIndex final {
+ public:
+  struct Options {
+    size_t mMemoryBudgetBytes {64 * 1024 * 1024};
+    size_t mMaxSnippetLength {120};
+  };
+
+  struct Stats {
+    size_t mDocumentCount {};
+    size_t mPageCount {};
+    size_t mTermCount {};
+    size_t mPostingCount {};
+    size_t mEstimatedBytes {};
+    size_t mEvictionCount {};
+  };
+
+  SearchIndex();
+  explicit SearchIndex(const Options&);
+  ~SearchIndex();
+
+  /// True if the document is indexed with this identity, and not evicted
+  bool IsCurrent(uint64_t documentKey, const FileIdentity&) const;
+  /// Returns nullopt if the document isn't indexed, or was evicted
+  std::optional<std::vector<uint64_t>> GetPageKeys(uint64_t documentKey) const;
+  /// Adds or replaces a document
+  void Upsert(SearchDocument);
+  /** Replaces the pages from `firstPage` onwards, keeping earlier pages.
+   *
+   * For documents that are only appended to, such as logs: the cost is
+   * proportional to the replaced and new pages, not to the whole document.
+   *
+   * Returns false without changing anything if the document isn't indexed,
+   * was evicted, or has fewer than `firstPage` pages; use `Upsert()` instead.
+   */
+  bool ReplacePages(
+    uint64_t documentKey,
+    const FileIdentity&,
+    size_t firstPage,
+    std::vector<SearchPage> pages);
+  void Remove(uint64_t documentKey);
+  /// Removes every document not in `documentKeys`
+  void RetainOnly(const std::vector<uint64_t>& documentKeys);
+
+  /// Results are ordered by score, then by document and page order
+  std::vector<SearchHit> Query(std::string_view query, size_t maxResults = 100)
+    const;
+
+  Stats GetStats() const;
+
+  static std::vector<std::string> Tokenize(std::string_view);
+
+ private:
+  using TermID = uint32_t;
+
+  // Each term's postings for a document are in page order; other documents'
+  // postings may be interleaved
+  struct Posting {
+    uint32_t mDocument;
+    uint32_t mPage;
+    uint32_t mBlock;
+  };
+
+  struct Document {
+    uint64_t mKey {};
+    FileIdentity mIdentity;
+    std::vector<SearchPage> mPages;
+    // How many of each term's postings are for this document
+    std::unordered_map<TermID, uint32_t> mTermPostings {};
+    size_t mEstimatedBytes {};
+    std::list<uint32_t>::iterator mLRUPosition {};
+  };
+
+  Options mOptions;
+  mutable std::mutex mMutex;
+
+  // Slots are reused, so postings can refer to documents by index
+  std::vector<Document> mDocuments;
+  std::vector<uint32_t> mFreeSlots;
+  std::unordered_map<uint64_t, uint32_t> mSlots;
+
+  // Ordered, for prefix matches
+  std::map<std::string, TermID, std::less<>> mTerms;
+  // Views of the keys in mTerms
+  std::unordered_map<std::string_view, TermID> mTermLookup;
+  std::vector<std::string_view> mTermText;
+  std::vector<std::vector<Posting>> mPostings;
+  std::vector<TermID> mFreeTermIDs;
+
+  // Most recently used at the front
+  mutable std::list<uint32_t> mLRU;
+
+  size_t mEstimatedBytes {};
+  size_t mEvictionCount {};
+
+  struct TokenizedPages;
+
+  TermID GetOrCreateTerm(std::string_view);
+  void AddPostings(uint32_t slot, uint32_t firstPage, const TokenizedPages&);
+  /// Returns the number of postings removed
+  size_t RemovePostings(uint32_t slot, uint32_t firstPage);
+  void RemoveTerm(TermID);
+  void RemoveSlot(uint32_t slot);
+  void EvictIfNeeded();
+  void Touch(uint32_t slot) const;
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,101 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <shims/filesystem>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace OpenKneeboard {
+
+/** On-disk format for `TextPageLog`; all integers are little-endian.
+ *
+ * - 8 bytes: magic ("OKTXPGL" followed by 0x1a)
+ * - uint16: version (1)
+ * - for each page:
+ *   - uint32: payload byte count
+ *   - uint64: `HashFileContent()` of the payload
+ *   - payload:
+ *     - uint32: line count
+ *     - for each line, uint32 byte count followed by the bytes (UTF-8)
+ *
+ * Each page is written with a single write and flushed; a page that was
+ * only partially written when a process crashed fails the size or hash
+ * check, and is discarded along with anything after it.
+ */
+namespace TextPageLogFormat {
+constexpr std::string_view Magic {"OKTXPGL\x1a", 8};
+constexpr uint16_t Version = 1;
+constexpr size_t HeaderSize = Magic.size() + sizeof(uint16_t);
+constexpr size_t RecordHeaderSize = sizeof(uint32_t) + sizeof(uint64_t);
+}// namespace TextPageLogFormat
+
+/** An append-only log of pages of text, read back by page index.
+ *
+ * Used to keep long histories out of memory; only the file offset of each
+ * page is kept in memory.
+ *
+ * Not thread-safe.
+ */
+class TextPageLog final {
+ public:
+  /** Opens an existing log, or creates a new one.
+   *
+   * Valid pages in an existing log are kept; a torn or corrupt tail is
+   * truncated. Throws std::runtime_error if the file can't be opened.
+   */
+  explicit TextPageLog(const std::filesystem::path&);
+  ~TextPageLog();
+
+  TextPageLog() = delete;
+  TextPageLog(const TextPageLog&) = delete;
+  TextPageLog& operator=(const TextPageLog&) = delete;
+
+  size_t GetPageCount() const noexcept;
+  uint64_t GetByteCount() const noexcept;
+  /// Bytes truncated from a torn or corrupt tail when the log was opened
+  uint64_t GetDiscardedByteCount() const noexcept;
+
+  /// Throws std::runtime_error if the write fails
+  void Append(std::span<const std::string_view> lines);
+  /// Throws std::out_of_range, or std::runtime_error if the read fails
+  std::vector<std::string> Read(size_t pageIndex);
+  /// Removes all pages
+  void Clear();
+
+ private:
+  std::filesystem::path mPath;
+  std::fstream mStream;
+  std::vector<uint64_t> mPageOffsets;
+  uint64_t mEndOffset {};
+  uint64_t mDiscardedByteCount {};
+  std::string mBuffer;
+
+  void Open(bool truncate);
+  void Recover();
+};
+
+}// namespace OpenKneeboard
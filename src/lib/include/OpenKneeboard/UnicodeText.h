@@ -0,0 +1,211 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace OpenKneeboard {
+
+/// UAX #14 line breaking classes
+enum class LineBreakClass : uint8_t {
+  BK,
+  CR,
+  LF,
+  CM,
+  NL,
+  SG,
+  WJ,
+  ZW,
+  GL,
+  SP,
+  ZWJ,
+  B2,
+  BA,
+  BB,
+  HY,
+  CB,
+  CL,
+  CP,
+  EX,
+  IN,
+  NS,
+  OP,
+  QU,
+  IS,
+  NU,
+  PO,
+  PR,
+  SY,
+  AI,
+  AL,
+  CJ,
+  EB,
+  EM,
+  H2,
+  H3,
+  HL,
+  ID,
+  JL,
+  JV,
+  JT,
+  RI,
+  SA,
+  XX,
+};
+
+/// UAX #29 Grapheme_Cluster_Break values
+enum class GraphemeClusterBreak : uint8_t {
+  Other,
+  CR,
+  LF,
+  Control,
+  Extend,
+  ZWJ,
+  RegionalIndicator,
+  Prepend,
+  SpacingMark,
+  L,
+  V,
+  T,
+  LV,
+  LVT,
+};
+
+/// UAX #29 Indic_Conjunct_Break values
+enum class IndicConjunctBreak : uint8_t {
+  None,
+  Consonant,
+  Extend,
+  Linker,
+};
+
+struct CodePointProperties {
+  LineBreakClass mLineBreak {LineBreakClass::XX};
+  GraphemeClusterBreak mGraphemeClusterBreak {GraphemeClusterBreak::Other};
+  IndicConjunctBreak mIndicConjunctBreak {IndicConjunctBreak::None};
+  /// Columns in a fixed-width font: 0, 1, or 2
+  uint8_t mWidth {1};
+  bool mExtendedPictographic {false};
+  /// East_Asian_Width is Fullwidth, Wide, or Halfwidth
+  bool mEastAsian {false};
+  bool mUnassigned {false};
+};
+
+/// Looked up in tables generated by `generate-unicode-tables.py`
+CodePointProperties GetCodePointProperties(char32_t) noexcept;
+
+/** Decodes the code point at `offset`, and moves `offset` past it.
+ *
+ * Invalid, overlong, or truncated sequences decode to U+FFFD, consuming a
+ * single byte.
+ */
+char32_t DecodeUTF8(std::string_view text, size_t& offset) noexcept;
+
+/** Finds extended grapheme cluster boundaries, as in UAX #29.
+ *
+ * Feed it every code point in order; as with most of these rules, the state
+ * only depends on the current cluster, so a new instance can be started at
+ * any known boundary.
+ */
+class GraphemeBreaker final {
+ public:
+  /// True if there is a boundary before this code point
+  bool Next(const CodePointProperties&) noexcept;
+
+ private:
+  bool mAtStart {true};
+  GraphemeClusterBreak mPrevious {GraphemeClusterBreak::Other};
+  size_t mRegionalIndicators {};
+  // GB11: ExtPict Extend* ZWJ x ExtPict
+  bool mInPictographicSequence {false};
+  bool mAfterPictographicZWJ {false};
+  // GB9c: Consonant [Extend Linker]* Linker [Extend Linker]* x Consonant
+  bool mInConjunct {false};
+  bool mConjunctHasLinker {false};
+};
+
+/** Finds line break opportunities, as in UAX #14.
+ *
+ * This implements the default algorithm, with SA (complex context) resolved
+ * to AL, and AI/SG/XX resolved to AL; CJ is resolved to NS (strict).
+ */
+class LineBreaker final {
+ public:
+  enum class Break {
+    None,
+    Allowed,
+    Mandatory,
+  };
+
+  /// Whether text can be broken before this code point
+  Break Next(const CodePointProperties&) noexcept;
+
+ private:
+  bool mAtStart {true};
+  // Previous class, after LB9/LB10 resolution of combining marks
+  LineBreakClass mPrevious {LineBreakClass::XX};
+  // The class before any spaces, for rules of the form "X SP* x"
+  LineBreakClass mBeforeSpaces {LineBreakClass::XX};
+  bool mPreviousIsEastAsian {false};
+  bool mPreviousIsUnassignedPictographic {false};
+  bool mPreviousIsZWJ {false};
+  // LB21a: HL (HY | BA) x
+  bool mAfterHebrewHyphen {false};
+  size_t mRegionalIndicators {};
+};
+
+/** Where to end a line of text that is too wide for `columns`.
+ *
+ * Widths are in fixed-width columns: most characters take one column, wide
+ * East Asian characters take two, and combining marks take none.
+ *
+ * Lines are broken at UAX #14 break opportunities; spaces at the end of a
+ * line hang past the margin and are left off the line. If there is no break
+ * opportunity that fits, the line is broken between grapheme clusters
+ * instead. Each line contains at least one grapheme cluster.
+ *
+ * Mandatory breaks are treated as break opportunities; callers are expected
+ * to split lines at '\n' first.
+ */
+struct LineWrap {
+  /// Bytes to show on this line; excludes hanging spaces
+  size_t mLength {};
+  /// Where the next line starts; this is `text.size()` for the last line
+  size_t mNextLineOffset {};
+};
+/// Wraps the first line of `text`, starting at a line start
+LineWrap WrapLine(std::string_view text, size_t columns) noexcept;
+
+/// Columns needed for `text` in a fixed-width font
+size_t GetDisplayWidth(std::string_view text) noexcept;
+
+namespace UnicodeTextTables {
+struct UnicodeTextRange {
+  char32_t mFirst {};
+  uint32_t mProperties {};
+};
+/// Sorted by `mFirst`; the first range starts at U+0000
+std::span<const UnicodeTextRange> GetRanges() noexcept;
+}// namespace UnicodeTextTables
+
+}// namespace OpenKneeboard
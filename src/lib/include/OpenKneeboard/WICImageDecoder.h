@@ -0,0 +1,50 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <OpenKneeboard/ImageDecoder.h>
+
+#include <shims/winrt/base.h>
+
+#include <wincodec.h>
+
+namespace OpenKneeboard {
+
+/// Decodes any format supported by the Windows Imaging Component
+class WICImageDecoder final : public ImageDecoder {
+ public:
+  WICImageDecoder() = delete;
+  WICImageDecoder(const winrt::com_ptr<IWICImagingFactory>&);
+
+  std::optional<ImageSize> ReadSize(const std::filesystem::path&) override;
+  std::optional<DecodedImage> Decode(
+    const std::filesystem::path&,
+    const ImageSize& maxSize,
+    std::stop_token) override;
+
+ private:
+  winrt::com_ptr<IWICImagingFactory> mWIC;
+
+  winrt::com_ptr<IWICBitmapFrameDecode> OpenFrame(
+    const std::filesystem::path&);
+  bool HasAlpha(IWICBitmapSource*);
+};
+
+}// namespace OpenKneeboard
@@ -0,0 +1,119 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#include <OpenKneeboard/BenchmarkHarness.h>
+
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#include <Windows.h>
+
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace OpenKneeboard::BenchmarkHarness {
+
+double MillisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+    .count();
+}
+
+uint64_t GetPeakMemoryBytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc {};
+  GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+  return pmc.PeakWorkingSetSize;
+#else
+  rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+  // kilobytes on Linux
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+bool Checks::operator()(bool ok, std::string_view what) {
+  ++mChecks;
+  std::cout << std::format("{}: {}\n", what, ok ? "OK" : "FAILED");
+  if (!ok) {
+    ++mFailures;
+  }
+  return ok;
+}
+
+void Checks::Fail(std::string_view what) {
+  ++mChecks;
+  ++mFailures;
+  std::cout << std::format("FAILED: {}\n", what);
+}
+
+size_t Checks::GetFailureCount() const noexcept {
+  return mFailures;
+}
+
+int Checks::GetExitCode() const {
+  std::cout << std::format(
+    "\n{} of {} checks passed\n", mChecks - mFailures, mChecks);
+  return mFailures ? 1 : 0;
+}
+
+int Run(int argc, char** argv, std::initializer_list<Command> commands) {
+  const auto program = std::filesystem::path(argv[0]).stem().string();
+  const auto showUsage = [&] {
+    std::cout << "Usage:\n";
+    for (const auto& command: commands) {
+      std::cout << std::format("  {} {}", program, command.mName);
+      if (!command.mUsage.empty()) {
+        std::cout << ' ' << command.mUsage;
+      }
+      std::cout << '\n';
+    }
+    return 1;
+  };
+
+  if (argc < 2) {
+    return showUsage();
+  }
+  const std::string_view name {argv[1]};
+  const std::span<char* const> arguments {argv + 2, argv + argc};
+  for (const auto& command: commands) {
+    if (command.mName != name) {
+      continue;
+    }
+    if (
+      arguments.size() < command.mMinArguments
+      || arguments.size() > command.mMaxArguments) {
+      return showUsage();
+    }
+    try {
+      return command.mRun(arguments);
+    } catch (const std::exception& e) {
+      std::cout << std::format("FAILED: uncaught exception: {}\n", e.what());
+      return 1;
+    }
+  }
+  return showUsage();
+}
+
+}// namespace OpenKneeboard::BenchmarkHarness
@@ -0,0 +1,580 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `Event<>` delivery semantics - order, handlers added or removed
+// while emitting, hooks, `EventDelay`, and batched delivery to another
+// context via `EventDeliveryQueue` - including emitting from several
+// threads while handlers are added and removed, that emitting doesn't
+// allocate, and `EventInstrumentation` - and measures the cost of emitting
+// against the number of receivers, under contention, and with
+// instrumentation.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/EventDeliveryQueue.h>
+#include <OpenKneeboard/EventInstrumentation.h>
+#include <OpenKneeboard/Events.h>
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace OpenKneeboard {
+/* Used by `EventDelay`; not registered, so tracing is a no-op.
+ *
+ * PS >
+ * [System.Diagnostics.Tracing.EventSource]::new("OpenKneeboard.EventsBenchmark")
+ * 0f49ad70-5dac-5aa6-53d8-353a300fad4b
+ */
+TRACELOGGING_DEFINE_PROVIDER(
+  gTraceProvider,
+  "OpenKneeboard.EventsBenchmark",
+  (0x0f49ad70, 0x5dac, 0x5aa6, 0x53, 0xd8, 0x35, 0x3a, 0x30, 0x0f, 0xad, 0x4b));
+}// namespace OpenKneeboard
+
+namespace {
+// Counted by the replacement `operator new` below
+std::atomic<uint64_t> gAllocationCount {0};
+
+uint64_t GetAllocationCount() {
+  return gAllocationCount.load(std::memory_order_relaxed);
+}
+}// namespace
+
+void* operator new(std::size_t size) {
+  gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+  if (auto p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+class Receiver final : public EventReceiver {
+ public:
+  using EventReceiver::AddEventListener;
+  using EventReceiver::RemoveEventListener;
+
+  ~Receiver() {
+    this->RemoveAllEventListeners();
+  }
+};
+
+void VerifyOrdering(Checks& check) {
+  Event<int> event;
+  Receiver receiver;
+  std::vector<int> calls;
+
+  EventHandlerToken second;
+  receiver.AddEventListener(event, [&](int) {
+    calls.push_back(1);
+    receiver.RemoveEventListener(second);
+    // Added during an emit, so shouldn't receive it
+    receiver.AddEventListener(event, [&](int) { calls.push_back(4); });
+  });
+  second = receiver.AddEventListener(event, [&](int) { calls.push_back(2); });
+  receiver.AddEventListener(event, [&](int) { calls.push_back(3); });
+
+  event.Emit(0);
+  check(
+    calls == std::vector {1, 3},
+    "registration order; removed during emit is skipped; "
+    "added during emit isn't called");
+
+  calls.clear();
+  // The first handler adds another '4' each time
+  event.Emit(0);
+  check(calls == std::vector {1, 3, 4}, "added handlers receive later emits");
+}
+
+void VerifyHooks(Checks& check) {
+  Event<int> event;
+  Receiver receiver;
+  std::vector<int> values;
+  receiver.AddEventListener(event, [&](int value) { values.push_back(value); });
+
+  const auto hook = event.AddHook([](int value) {
+    return value == 2 ? EventBase::HookResult::STOP_PROPAGATION
+                      : EventBase::HookResult::ALLOW_PROPAGATION;
+  });
+  event.Emit(1);
+  event.Emit(2);
+  event.Emit(3);
+  check(values == std::vector {1, 3}, "hook stops propagation");
+
+  event.RemoveHook(hook);
+  event.Emit(2);
+  check(values == std::vector {1, 3, 2}, "removed hook");
+}
+
+void VerifyDelay(Checks& check) {
+  Event<int> first;
+  Event<int> second;
+  Receiver receiver;
+  std::vector<int> values;
+  receiver.AddEventListener(first, [&](int value) {
+    values.push_back(value);
+    // Once the delay has ended, this is invoked immediately
+    second.Emit(value + 100);
+    values.push_back(-value);
+  });
+  receiver.AddEventListener(
+    second, [&](int value) { values.push_back(value); });
+
+  {
+    const EventDelay delay;
+    first.Emit(1);
+    first.Emit(2);
+    check(values.empty(), "EventDelay delays handlers");
+  }
+  check(
+    values == std::vector {1, 101, -1, 2, 102, -2},
+    "delayed emits are delivered in order when the delay ends");
+}
+
+void VerifyLifetimes(Checks& check) {
+  size_t calls = 0;
+  {
+    Receiver receiver;
+    {
+      Event<> event;
+      receiver.AddEventListener(event, [&]() { ++calls; });
+      event.Emit();
+    }
+    // The receiver outlives the event
+  }
+  {
+    Event<> event;
+    {
+      Receiver receiver;
+      receiver.AddEventListener(event, [&]() { ++calls; });
+    }
+    // The event outlives the receiver
+    event.Emit();
+  }
+  check(calls == 1, "receivers and events can be destroyed in either order");
+}
+
+void VerifyHandlerLifetimes(Checks& check) {
+  Event<> event;
+  Receiver receiver;
+
+  auto captured = std::make_shared<int>(0);
+  const auto token
+    = receiver.AddEventListener(event, [captured]() { ++*captured; });
+  event.Emit();
+  receiver.RemoveEventListener(token);
+  check(
+    *captured == 1 && captured.use_count() == 1,
+    "removing a handler releases its captures");
+
+  std::weak_ptr<int> weak;
+  EventHandlerToken self;
+  {
+    auto selfCaptured = std::make_shared<int>(0);
+    weak = selfCaptured;
+    self = receiver.AddEventListener(event, [&, selfCaptured]() {
+      receiver.RemoveEventListener(self);
+      // Still safe to use captures after removing ourselves
+      ++*selfCaptured;
+    });
+  }
+  event.Emit();
+  check(
+    weak.expired(),
+    "a handler that removes itself releases its captures when it returns");
+}
+
+void VerifyAllocations(Checks& check) {
+  Event<int> event;
+  Event<int> forwarded;
+  Receiver receiver;
+  uint64_t sum = 0;
+  for (int i = 0; i < 8; ++i) {
+    receiver.AddEventListener(event, [&sum](int value) { sum += value; });
+  }
+  receiver.AddEventListener(event, forwarded);
+  receiver.AddEventListener(forwarded, [&sum](int value) { sum += value; });
+
+  const auto emitDelayed = [&]() {
+    const EventDelay delay;
+    for (int i = 0; i < 100; ++i) {
+      event.Emit(i);
+    }
+  };
+  // Warm up, e.g. the per-thread delay queue's capacity
+  event.Emit(0);
+  emitDelayed();
+
+  auto before = GetAllocationCount();
+  for (int i = 0; i < 1000; ++i) {
+    event.Emit(i);
+  }
+  const auto immediate = GetAllocationCount() - before;
+  check(
+    immediate == 0,
+    std::format("immediate emits allocate nothing ({})", immediate));
+
+  before = GetAllocationCount();
+  emitDelayed();
+  const auto delayed = GetAllocationCount() - before;
+  check(
+    delayed == 0,
+    std::format("delayed emits allocate nothing after warm-up ({})", delayed));
+}
+
+// Runs drains when asked to, instead of on another thread
+class ManualExecutor final : public EventDeliveryExecutor {
+ public:
+  void Schedule(std::function<void()> drain) override {
+    mScheduled.push_back(std::move(drain));
+  }
+
+  bool IsCurrentContext() const override {
+    return mIsCurrentContext;
+  }
+
+  // Pretend that the caller is in the target context
+  void SetIsCurrentContext(bool value) {
+    mIsCurrentContext = value;
+  }
+
+  size_t GetScheduledCount() const noexcept {
+    return mScheduled.size();
+  }
+
+  // Returns false if a drain threw
+  bool RunScheduled() {
+    auto scheduled = std::exchange(mScheduled, {});
+    bool ok = true;
+    for (auto& drain: scheduled) {
+      try {
+        drain();
+      } catch (const std::runtime_error&) {
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+ private:
+  std::vector<std::function<void()>> mScheduled;
+  bool mIsCurrentContext {false};
+};
+
+void VerifyDeliveryQueue(Checks& check) {
+  auto executor = std::make_unique<ManualExecutor>();
+  auto& manual = *executor;
+  auto queue = EventDeliveryQueue::Create(std::move(executor));
+
+  std::vector<int> delivered;
+  for (int i = 0; i < 100; ++i) {
+    queue->Enqueue([&delivered, i]() { delivered.push_back(i); });
+  }
+  check(manual.GetScheduledCount() == 1, "a burst schedules a single drain");
+  manual.RunScheduled();
+  bool inOrder = delivered.size() == 100;
+  for (int i = 0; inOrder && i < 100; ++i) {
+    inOrder = delivered[i] == i;
+  }
+  check(
+    inOrder && queue->GetStats().mDrains == 1,
+    "a single drain delivers the burst in order");
+
+  delivered.clear();
+  queue->Enqueue([&delivered]() { delivered.push_back(1); });
+  queue->Enqueue([]() { throw std::runtime_error("test"); });
+  queue->Enqueue([&delivered]() { delivered.push_back(3); });
+  const auto threw = !manual.RunScheduled();
+  check(
+    threw && delivered == std::vector {1} && manual.GetScheduledCount() == 1,
+    "an item that throws propagates, and reschedules the rest");
+  manual.RunScheduled();
+  check(delivered == std::vector {1, 3}, "items after a throw are delivered");
+  queue->Enqueue([&delivered]() { delivered.push_back(4); });
+  check(
+    manual.GetScheduledCount() == 1,
+    "the queue schedules drains after an item throws");
+  manual.RunScheduled();
+
+  delivered.clear();
+  const auto slow = EventDeliveryQueue::MaxDrainDuration * 2 / 3;
+  for (int i = 0; i < 3; ++i) {
+    queue->Enqueue([&delivered, i, slow]() {
+      std::this_thread::sleep_for(slow);
+      delivered.push_back(i);
+    });
+  }
+  manual.RunScheduled();
+  check(
+    delivered.size() < 3 && manual.GetScheduledCount() == 1,
+    "a long drain stops, and schedules another for the rest");
+  while (manual.GetScheduledCount() > 0) {
+    manual.RunScheduled();
+  }
+  check(
+    delivered == std::vector {0, 1, 2},
+    "items after a long drain are delivered in order");
+
+  delivered.clear();
+  manual.SetIsCurrentContext(true);
+  queue->Enqueue([&delivered]() { delivered.push_back(1); });
+  check(
+    delivered == std::vector {1} && manual.GetScheduledCount() == 0,
+    "enqueuing from the target context delivers immediately");
+
+  delivered.clear();
+  manual.SetIsCurrentContext(false);
+  queue->Enqueue([&delivered]() { delivered.push_back(1); });
+  manual.SetIsCurrentContext(true);
+  queue->Enqueue([&delivered]() { delivered.push_back(2); });
+  check(
+    delivered.empty() && manual.GetScheduledCount() == 1,
+    "enqueuing from the target context waits for pending items");
+  manual.RunScheduled();
+  check(
+    delivered == std::vector {1, 2},
+    "items from the target context stay in order");
+  manual.SetIsCurrentContext(false);
+}
+
+bool IsThisFile(const EventInstrumentation::Location& location) {
+  return std::string_view {location.mFile}.ends_with("events-benchmark.cpp");
+}
+
+void VerifyInstrumentation(Checks& check) {
+  Event<> event;
+  Receiver receiver;
+  receiver.AddEventListener(event, []() {});
+  receiver.AddEventListener(
+    event, []() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+
+  EventInstrumentation::SetEnabled(false);
+  EventInstrumentation::Reset();
+  event.Emit();
+  check(
+    EventInstrumentation::GetSnapshot().mEmitters.empty(),
+    "nothing is recorded while instrumentation is disabled");
+
+  EventInstrumentation::SetEnabled(true);
+  for (int i = 0; i < 5; ++i) {
+    event.Emit();
+  }
+  {
+    // The receiver outlives this event
+    Event<> orphaned;
+    receiver.AddEventListener(orphaned, []() {});
+  }
+  EventInstrumentation::SetEnabled(false);
+
+  const auto snapshot = EventInstrumentation::GetSnapshot();
+  const auto& emitters = snapshot.mEmitters;
+  check(
+    emitters.size() == 1 && IsThisFile(emitters[0].mLocation)
+      && emitters[0].mEmitCount == 5 && emitters[0].mLastHandlerCount == 2,
+    "emit counts and handler counts, by emitter location");
+
+  const auto& handlers = snapshot.mHandlers;
+  const auto bucket = std::bit_width(2000u);
+  check(
+    handlers.size() == 2 && IsThisFile(handlers[0].mLocation)
+      && handlers[0].mCallCount == 5 && handlers[1].mCallCount == 5
+      && handlers[0].mMaxTime >= std::chrono::milliseconds(2)
+      && handlers[0].mHistogram[bucket - 1] == 0
+      && std::accumulate(
+           handlers[0].mHistogram.begin() + bucket,
+           handlers[0].mHistogram.end(),
+           uint64_t {0})
+        == 5,
+    "handler times, slowest first, with a log2 histogram");
+  check(
+    snapshot.mOrphanedReceivers.size() == 1
+      && snapshot.mOrphanedReceivers[0].mCount == 1,
+    "receivers still connected when their event is destroyed");
+
+  const auto formatted = EventInstrumentation::FormatSnapshot(snapshot);
+  check(
+    formatted.find("- 5 emits") != std::string::npos
+      && formatted.find(std::format(
+           "{}:{} ",
+           emitters[0].mLocation.mFile,
+           emitters[0].mLocation.mLine))
+        != std::string::npos
+      && snapshot.mDroppedRecordCount == 0,
+    "snapshots can be formatted for logs");
+}
+
+struct ContentionResult {
+  uint64_t mCalls {0};
+  uint64_t mExpectedCalls {0};
+  double mNanosecondsPerEmit {0};
+};
+
+ContentionResult RunContended(
+  size_t emitterCount,
+  size_t emitsPerThread,
+  size_t receiverCount) {
+  Event<int> event;
+  Receiver receiver;
+  std::atomic<uint64_t> calls {0};
+  for (size_t i = 0; i < receiverCount; ++i) {
+    receiver.AddEventListener(
+      event, [&calls](int) { calls.fetch_add(1, std::memory_order_relaxed); });
+  }
+
+  std::atomic_flag stop;
+  std::thread writer([&]() {
+    Receiver churn;
+    while (!stop.test()) {
+      const auto token = churn.AddEventListener(event, [](int) {});
+      churn.RemoveEventListener(token);
+    }
+  });
+
+  const auto start = Clock::now();
+  std::vector<std::thread> emitters;
+  for (size_t i = 0; i < emitterCount; ++i) {
+    emitters.emplace_back([&]() {
+      for (size_t j = 0; j < emitsPerThread; ++j) {
+        event.Emit(static_cast<int>(j));
+      }
+    });
+  }
+  for (auto& thread: emitters) {
+    thread.join();
+  }
+  const auto emits = emitterCount * emitsPerThread;
+  const auto nanoseconds = MillisecondsSince(start) * 1000000 / emits;
+
+  stop.test_and_set();
+  writer.join();
+  return {calls.load(), emits * receiverCount, nanoseconds};
+}
+
+int Verify() {
+  Checks check;
+  VerifyOrdering(check);
+  VerifyHooks(check);
+  VerifyDelay(check);
+  VerifyLifetimes(check);
+  VerifyHandlerLifetimes(check);
+  VerifyAllocations(check);
+  VerifyDeliveryQueue(check);
+  VerifyInstrumentation(check);
+
+  const auto contended = RunContended(4, 20000, 8);
+  check(
+    contended.mCalls == contended.mExpectedCalls,
+    std::format(
+      "emitting from 4 threads while handlers are added and removed: "
+      "{} of {} calls",
+      contended.mCalls,
+      contended.mExpectedCalls));
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t emits) {
+  for (const size_t receiverCount: {1, 4, 16, 64}) {
+    Event<int> event;
+    Receiver receiver;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < receiverCount; ++i) {
+      receiver.AddEventListener(event, [&sum](int value) { sum += value; });
+    }
+    const auto start = Clock::now();
+    for (size_t i = 0; i < emits; ++i) {
+      event.Emit(static_cast<int>(i));
+    }
+    std::cout << std::format(
+      "{:>2} receivers: {:.1f}ns per emit\n",
+      receiverCount,
+      MillisecondsSince(start) * 1000000 / emits);
+  }
+
+  for (const auto enabled: {false, true}) {
+    EventInstrumentation::SetEnabled(enabled);
+    Event<int> event;
+    Receiver receiver;
+    uint64_t sum = 0;
+    receiver.AddEventListener(event, [&sum](int value) { sum += value; });
+    const auto start = Clock::now();
+    for (size_t i = 0; i < emits; ++i) {
+      event.Emit(static_cast<int>(i));
+    }
+    std::cout << std::format(
+      " 1 receiver, instrumentation {}: {:.1f}ns per emit\n",
+      enabled ? "enabled" : "disabled",
+      MillisecondsSince(start) * 1000000 / emits);
+  }
+  EventInstrumentation::SetEnabled(false);
+
+  const auto contended = RunContended(4, emits / 4, 8);
+  std::cout << std::format(
+    "4 threads, 8 receivers, while adding and removing handlers: "
+    "{:.1f}ns per emit\n",
+    contended.mNanosecondsPerEmit);
+  return contended.mCalls == contended.mExpectedCalls ? 0 : 1;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[EMITS]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 1000000 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
@@ -0,0 +1,401 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks that `FileSnapshot`, `FileRangeReader` and `FileChangeDetector`
+// agree on file identities, that range reads fail once a file is changed or
+// replaced, and that reads are retried - including while other threads
+// rewrite the file in place or replace it; also compares the cost of
+// reading a whole file with hashing it and reading ranges on demand. Only
+// depends on the standard library, so it can also be built and profiled
+// outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/FileSnapshot.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+std::filesystem::path GetScratchPath(std::string_view name) {
+  return std::filesystem::temp_directory_path()
+    / std::format("file-snapshot-benchmark-{}.bin", name);
+}
+
+std::vector<std::byte> RandomBytes(std::mt19937_64& rng, size_t size) {
+  std::vector<std::byte> bytes(size);
+  for (auto& byte: bytes) {
+    byte = static_cast<std::byte>(rng());
+  }
+  return bytes;
+}
+
+/** Writes the file, and gives it a distinct modification time.
+ *
+ * Some filesystems only update modification times every few milliseconds;
+ * the code under test can't tell versions apart if they have the same size
+ * and time, so neither can these tests.
+ */
+void WriteFile(
+  const std::filesystem::path& path,
+  std::span<const std::byte> bytes,
+  int version) {
+  {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f.write(
+      reinterpret_cast<const char*>(bytes.data()),
+      static_cast<std::streamsize>(bytes.size()));
+  }
+  static const auto base = std::filesystem::file_time_type::clock::now();
+  std::filesystem::last_write_time(
+    path, base + std::chrono::seconds(version));
+}
+
+/// Every byte is the version number, so partial writes are recognizable
+std::vector<std::byte> MakeVersion(int version) {
+  return std::vector<std::byte>(
+    4096 + (version % 7) * 1000, static_cast<std::byte>(version));
+}
+
+bool IsWholeVersion(std::span<const std::byte> bytes) {
+  if (bytes.empty()) {
+    return false;
+  }
+  const auto version = std::to_integer<int>(bytes.front());
+  return bytes.size() == MakeVersion(version).size()
+    && std::ranges::all_of(bytes, [&](auto b) { return b == bytes.front(); });
+}
+
+bool HasConsistentIdentity(const FileSnapshot& snapshot) {
+  const auto& identity = snapshot.GetIdentity();
+  return identity.mSize == snapshot.GetBytes().size()
+    && identity.mContentHash == HashFileContent(snapshot.GetBytes());
+}
+
+bool SameIdentity(const FileIdentity& a, const FileIdentity& b) {
+  return a.HasSameMetadata(b) && a.HasSameContent(b);
+}
+
+void VerifyIdentities(Checks& check) {
+  const auto path = GetScratchPath("identity");
+  std::mt19937_64 rng {38};
+  int version = 0;
+  bool allSame = true;
+  // Around the hash's word size and `FileRangeReader`'s chunk size
+  for (const size_t size:
+       {0, 1, 7, 8, 9, 1048575, 1048576, 1048579, 3 * 1048576 + 5}) {
+    const auto bytes = RandomBytes(rng, size);
+    WriteFile(path, bytes, ++version);
+    const auto snapshot = FileSnapshot::Read(path);
+    const auto reader = FileRangeReader::Open(path);
+    if (!(snapshot && reader
+          && SameIdentity(snapshot->GetIdentity(), reader->GetIdentity())
+          && snapshot->GetIdentity().mContentHash == HashFileContent(bytes))) {
+      check.Fail(std::format("identities for a {}-byte file", size));
+      allSame = false;
+    }
+  }
+  check(allSame, "FileRangeReader hashes like FileSnapshot");
+
+  const auto bytes = RandomBytes(rng, 300000);
+  WriteFile(path, bytes, ++version);
+  const auto reader = FileRangeReader::Open(path);
+  if (!reader) {
+    check.Fail("FileRangeReader::Open");
+    return;
+  }
+
+  bool rangesMatch = true;
+  std::vector<std::byte> buffer(5000);
+  for (int i = 0; i < 100; ++i) {
+    const auto offset = rng() % (bytes.size() + 100);
+    const auto read = reader->ReadAt(offset, buffer);
+    const auto expected = offset < bytes.size()
+      ? std::min(buffer.size(), bytes.size() - offset)
+      : 0;
+    rangesMatch = rangesMatch && read == expected
+      && std::ranges::equal(
+        std::span {buffer}.first(expected),
+        std::span {bytes}.subspan(std::min(offset, bytes.size()), expected));
+  }
+  check(rangesMatch, "ranges, including past the end");
+
+  const auto copy = reader->ReadSnapshot();
+  check(
+    copy && std::ranges::equal(copy->GetBytes(), bytes)
+      && SameIdentity(copy->GetIdentity(), reader->GetIdentity()),
+    "ReadSnapshot");
+
+  auto modified = bytes;
+  modified.at(1234) ^= std::byte {1};
+  WriteFile(path, modified, ++version);
+  check(
+    !reader->ReadAt(0, buffer) && !reader->ReadSnapshot(),
+    "range reads fail after the file is modified in place");
+
+  const auto replacement = GetScratchPath("identity-replacement");
+  WriteFile(replacement, bytes, ++version);
+  const auto replaced = FileRangeReader::Open(path);
+  std::filesystem::rename(replacement, path);
+  check(
+    replaced && !replaced->ReadAt(0, buffer),
+    "range reads fail after the file is replaced");
+
+  std::filesystem::resize_file(path, 10);
+  const auto truncated = FileRangeReader::Open(path);
+  std::filesystem::remove(path);
+  check(
+    truncated && !truncated->ReadAt(0, buffer) && !FileRangeReader::Open(path)
+      && !FileSnapshot::Read(path, {.mMaxAttempts = 1}),
+    "deleted files");
+}
+
+void VerifyChangeDetector(Checks& check) {
+  const auto path = GetScratchPath("changes");
+  FileChangeDetector changes;
+  WriteFile(path, MakeVersion(1), 1);
+  check(changes.MayHaveChanged(path), "everything is new at first");
+
+  const auto reader = FileRangeReader::Open(path);
+  check(
+    reader && changes.Commit(reader->GetIdentity())
+      && !changes.MayHaveChanged(path),
+    "committed versions are unchanged");
+
+  // Touched, or saved again without changes
+  WriteFile(path, MakeVersion(1), 2);
+  const auto touched = FileSnapshot::Read(path);
+  check(
+    changes.MayHaveChanged(path) && touched && !changes.Commit(*touched)
+      && !changes.MayHaveChanged(path),
+    "touching a file isn't a change");
+
+  WriteFile(path, MakeVersion(2), 3);
+  const auto modified = FileRangeReader::Open(path);
+  check(
+    changes.MayHaveChanged(path) && modified
+      && changes.Commit(modified->GetIdentity()),
+    "content changes are changes");
+
+  changes.Reset();
+  check(changes.MayHaveChanged(path), "Reset");
+  std::filesystem::remove(path);
+}
+
+void VerifyRetries(Checks& check) {
+  using namespace std::chrono_literals;
+  const auto path = GetScratchPath("retries");
+  std::filesystem::remove(path);
+
+  // e.g. the path is missing while an editor replaces the file
+  {
+    std::jthread writer([&]() {
+      std::this_thread::sleep_for(100ms);
+      WriteFile(path, MakeVersion(1), 1);
+    });
+    check(
+      !FileSnapshot::Read(path, {.mMaxAttempts = 1}),
+      "missing files aren't read");
+    const auto snapshot
+      = FileSnapshot::Read(path, {.mMaxAttempts = 100, .mRetryDelay = 10ms});
+    check(
+      snapshot && IsWholeVersion(snapshot->GetBytes()),
+      "reads are retried until the file exists");
+  }
+
+  // Replacing by renaming is atomic, so every read should be of a whole
+  // version, even if it's retried
+  {
+    std::atomic<bool> stop {false};
+    std::jthread writer([&]() {
+      const auto temporary = GetScratchPath("retries-temporary");
+      for (int version = 1; !stop; ++version) {
+        WriteFile(temporary, MakeVersion(version % 200), version);
+        std::filesystem::rename(temporary, path);
+      }
+    });
+    size_t reads = 0;
+    size_t whole = 0;
+    for (int i = 0; i < 500; ++i) {
+      if (const auto snapshot = FileSnapshot::Read(path, {.mRetryDelay = 1ms});
+          snapshot) {
+        ++reads;
+        whole += IsWholeVersion(snapshot->GetBytes())
+          && HasConsistentIdentity(*snapshot);
+      }
+      const auto reader = FileRangeReader::Open(path, {.mRetryDelay = 1ms});
+      if (const auto copy = reader ? reader->ReadSnapshot() : nullptr) {
+        ++reads;
+        whole += IsWholeVersion(copy->GetBytes())
+          && HasConsistentIdentity(*copy);
+      }
+    }
+    stop = true;
+    check(
+      reads > 0 && whole == reads,
+      std::format(
+        "replaced by rename while reading: {} of {} reads were whole versions",
+        whole,
+        reads));
+  }
+
+  // In-place writes aren't atomic; we can only notice them if the
+  // modification time or size changes while we're reading, so a read can
+  // still be of a partial write. Check that what we do get is consistent
+  // with its identity, and that we see the final version once the writer
+  // stops.
+  {
+    std::atomic<bool> stop {false};
+    std::atomic<int> lastVersion {0};
+    FileChangeDetector changes;
+    size_t changeCount = 0;
+    std::jthread writer([&]() {
+      for (int version = 1; !stop; ++version) {
+        WriteFile(path, MakeVersion(version % 200), version);
+        lastVersion = version;
+      }
+    });
+    size_t reads = 0;
+    size_t consistent = 0;
+    size_t whole = 0;
+    for (int i = 0; i < 500; ++i) {
+      const auto snapshot = FileSnapshot::Read(path, {.mRetryDelay = 1ms});
+      if (!snapshot) {
+        continue;
+      }
+      ++reads;
+      consistent += HasConsistentIdentity(*snapshot);
+      whole += IsWholeVersion(snapshot->GetBytes());
+      changeCount += changes.MayHaveChanged(path) && changes.Commit(*snapshot);
+    }
+    stop = true;
+    writer = {};
+    check(
+      reads > 0 && consistent == reads && changeCount > 0,
+      std::format(
+        "modified in place while reading: {} reads, {} changes, {} whole "
+        "versions",
+        reads,
+        changeCount,
+        whole));
+
+    const auto final = FileSnapshot::Read(path);
+    check(
+      final && changes.MayHaveChanged(path) && changes.Commit(*final)
+        && std::ranges::equal(
+          final->GetBytes(), MakeVersion(lastVersion % 200)),
+      "the final version is read once writes stop");
+  }
+  std::filesystem::remove(path);
+}
+
+int Verify() {
+  Checks check;
+  VerifyIdentities(check);
+  VerifyChangeDetector(check);
+  VerifyRetries(check);
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t megabytes) {
+  const auto path = GetScratchPath("bench");
+  std::mt19937_64 rng {38};
+  const auto bytes = RandomBytes(rng, megabytes * 1024 * 1024);
+  WriteFile(path, bytes, 1);
+
+  constexpr int Iterations = 5;
+  auto start = Clock::now();
+  for (int i = 0; i < Iterations; ++i) {
+    FileSnapshot::Read(path);
+  }
+  const auto snapshotMS = MillisecondsSince(start) / Iterations;
+
+  std::shared_ptr<FileRangeReader> reader;
+  start = Clock::now();
+  for (int i = 0; i < Iterations; ++i) {
+    reader = FileRangeReader::Open(path);
+  }
+  const auto openMS = MillisecondsSince(start) / Iterations;
+
+  start = Clock::now();
+  for (int i = 0; i < Iterations; ++i) {
+    reader->ReadSnapshot();
+  }
+  const auto copyMS = MillisecondsSince(start) / Iterations;
+
+  // Roughly what a PDF renderer asks for when drawing a page
+  constexpr int RangeReads = 1000;
+  std::vector<std::byte> buffer(64 * 1024);
+  start = Clock::now();
+  for (int i = 0; i < RangeReads; ++i) {
+    reader->ReadAt(rng() % bytes.size(), buffer);
+  }
+  const auto rangeUS = MillisecondsSince(start) * 1000 / RangeReads;
+
+  std::cout << std::format(
+    "{}MB file\n"
+    "FileSnapshot::Read():          {:.1f}ms, keeps a {}MB copy\n"
+    "FileRangeReader::Open():       {:.1f}ms, keeps no copy\n"
+    "FileRangeReader::ReadSnapshot: {:.1f}ms\n"
+    "FileRangeReader::ReadAt():     {:.1f}us per 64KB\n",
+    megabytes,
+    snapshotMS,
+    megabytes,
+    openMS,
+    copyMS,
+    rangeUS);
+  std::filesystem::remove(path);
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[MEGABYTES]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 100 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
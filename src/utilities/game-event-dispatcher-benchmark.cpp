@@ -0,0 +1,312 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `GameEventDispatcher`'s ordering and subscription rules, and
+// compares dispatching to many tabs by name against every handler
+// string-comparing every event. Only depends on the standard library, so it
+// can also be built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/GameEvent.h>
+#include <OpenKneeboard/GameEventDispatcher.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+constexpr char EVT_A[] = "A";
+static_assert(GameEventName(EVT_A).mHash == GameEventNameHash("A"));
+
+// Names similar to the DCS tabs'
+constexpr std::string_view TabEventNames[] {
+  "Aircraft",
+  "Mission",
+  "Terrain",
+  "Message",
+  "SimulationStart",
+  "SelfData",
+  "Origin",
+};
+
+int Verify() {
+  Checks check;
+  GameEventDispatcher dispatcher;
+  std::string log;
+
+  auto all = dispatcher.SubscribeToAll(
+    [&](const GameEvent& event) { log += "*" + event.name; });
+  auto a = dispatcher.Subscribe(EVT_A, [&](const auto&) { log += "a"; });
+  auto a2 = dispatcher.Subscribe(EVT_A, [&](const auto&) { log += "2"; });
+  check(
+    dispatcher.Dispatch({"A", "1"}) == 3 && log == "*Aa2",
+    "all-event handlers first, then subscription order");
+
+  log.clear();
+  check(
+    dispatcher.Dispatch({"C", "1"}) == 1 && log == "*C",
+    "events only reach matching handlers");
+
+  // Unsubscribing from inside a handler stops later handlers for the same
+  // event
+  GameEventDispatcher::Subscription second;
+  auto first = dispatcher.Subscribe("B", [&](const auto&) {
+    log += "b";
+    second.Unsubscribe();
+  });
+  second = dispatcher.Subscribe("B", [&](const auto&) { log += "B"; });
+  log.clear();
+  dispatcher.Dispatch({"B", "1"});
+  dispatcher.Dispatch({"B", "1"});
+  check(log == "*Bb*Bb", "unsubscribing from inside a handler");
+
+  // Subscribing from inside a handler takes effect for the next event
+  std::optional<GameEventDispatcher::Subscription> late;
+  auto subscriber = dispatcher.Subscribe("D", [&](const auto&) {
+    log += "d";
+    if (!late) {
+      late = dispatcher.Subscribe("D", [&](const auto&) { log += "D"; });
+    }
+  });
+  log.clear();
+  dispatcher.Dispatch({"D", "1"});
+  dispatcher.Dispatch({"D", "1"});
+  check(log == "*Dd*DdD", "subscribing from inside a handler");
+
+  // Subscriptions are RAII, and movable
+  {
+    auto scoped = dispatcher.Subscribe("E", [&](const auto&) { log += "e"; });
+    auto moved = std::move(scoped);
+    log.clear();
+    dispatcher.Dispatch({"E", "1"});
+  }
+  dispatcher.Dispatch({"E", "1"});
+  check(log == "*Ee*E", "subscriptions unsubscribe when destroyed");
+
+  const auto stats = dispatcher.GetHandlerStats();
+  bool statsOK = stats.size() == 6;
+  for (const auto& it: stats) {
+    statsOK = statsOK && it.mSubscribedFrom.find("benchmark")
+      != std::string::npos;
+    if (it.mEventName.empty()) {
+      statsOK = statsOK && it.mCallCount == 8;
+    }
+    statsOK = statsOK && it.mTimedCallCount == 0
+      && it.mTotalTime == std::chrono::nanoseconds::zero();
+  }
+  check(statsOK, "handler stats, untimed by default");
+
+  dispatcher.SetHandlerTimingEnabled(true);
+  dispatcher.Dispatch({"A", "1"});
+  dispatcher.SetHandlerTimingEnabled(false);
+  dispatcher.Dispatch({"A", "1"});
+  statsOK = true;
+  for (const auto& it: dispatcher.GetHandlerStats()) {
+    if (it.mEventName.empty()) {
+      statsOK = statsOK && it.mCallCount == 10 && it.mTimedCallCount == 1;
+    } else if (it.mEventName == "A") {
+      statsOK = statsOK && it.mTimedCallCount == 1;
+    } else {
+      statsOK = statsOK && it.mTimedCallCount == 0;
+    }
+  }
+  check(statsOK, "handler timing can be enabled");
+
+  // Subscriptions can outlive the dispatcher
+  std::optional<GameEventDispatcher> shortLived {std::in_place};
+  auto orphan = shortLived->Subscribe("F", [](const auto&) {});
+  shortLived.reset();
+  orphan.Unsubscribe();
+  check(true, "subscriptions outlive the dispatcher");
+
+  return check.GetExitCode();
+}
+
+// Stands in for a tab handling an event it cares about
+uint64_t HandleEvent(const GameEvent& event) {
+  return GameEventNameHash(event.value);
+}
+
+// Only counts the event, so that the cost of routing it is what's measured
+uint64_t CountEvent(const GameEvent&) {
+  return 1;
+}
+
+struct Timings {
+  double mByName {};
+  double mTimed {};
+  double mBroadcast {};
+};
+
+// The event names that each tab subscribes to
+using TabNames = std::vector<std::vector<std::string>>;
+
+Timings Benchmark(
+  const TabNames& tabNames,
+  const std::vector<GameEvent>& events,
+  uint64_t (*handle)(const GameEvent&),
+  bool& hitsMatch) {
+  GameEventDispatcher dispatcher;
+  std::vector<GameEventDispatcher::Subscription> subscriptions;
+  // The previous approach: every tab sees every event
+  std::vector<std::function<void(const GameEvent&)>> broadcast;
+  uint64_t dispatchedHits = 0;
+  uint64_t broadcastHits = 0;
+
+  for (const auto& names: tabNames) {
+    for (const auto& name: names) {
+      subscriptions.push_back(dispatcher.Subscribe(
+        GameEventName {name},
+        [&, handle](const auto& event) { dispatchedHits += handle(event); }));
+    }
+    broadcast.push_back([&, handle](const GameEvent& event) {
+      if (std::ranges::find(names, event.name) != names.end()) {
+        broadcastHits += handle(event);
+      }
+    });
+  }
+
+  Timings ret;
+  auto start = Clock::now();
+  for (const auto& event: events) {
+    dispatcher.Dispatch(event);
+  }
+  ret.mByName = MillisecondsSince(start);
+  const auto untimedHits = std::exchange(dispatchedHits, 0);
+
+  dispatcher.SetHandlerTimingEnabled(true);
+  start = Clock::now();
+  for (const auto& event: events) {
+    dispatcher.Dispatch(event);
+  }
+  ret.mTimed = MillisecondsSince(start);
+
+  start = Clock::now();
+  for (const auto& event: events) {
+    for (const auto& handler: broadcast) {
+      handler(event);
+    }
+  }
+  ret.mBroadcast = MillisecondsSince(start);
+
+  hitsMatch = hitsMatch && untimedHits == broadcastHits
+    && dispatchedHits == broadcastHits;
+  return ret;
+}
+
+int Benchmark(size_t tabCount, size_t eventCount) {
+  // Like the DCS tabs: each tab wants two of a few shared names, so each
+  // event is wanted by about 2/7 of the tabs
+  TabNames sharedNames;
+  std::vector<GameEvent> sharedEvents;
+  // Each tab wants its own name, so each event is wanted by one tab
+  TabNames ownNames;
+  std::vector<GameEvent> ownEvents;
+  for (size_t i = 0; i < tabCount; ++i) {
+    sharedNames.push_back({
+      std::string {TabEventNames[i % std::size(TabEventNames)]},
+      std::string {TabEventNames[(i + 1) % std::size(TabEventNames)]},
+    });
+    ownNames.push_back({std::format("Tab{}", i)});
+  }
+  for (size_t i = 0; i < eventCount; ++i) {
+    sharedEvents.push_back({
+      std::string {TabEventNames[i % std::size(TabEventNames)]},
+      std::string(256, 'x'),
+    });
+    ownEvents.push_back({
+      std::format("Tab{}", i % tabCount),
+      std::string(256, 'x'),
+    });
+  }
+
+  std::cout << std::format("{} tabs, {} events\n", tabCount, eventCount);
+  bool hitsMatch = true;
+  for (const auto& [label, names, events, handle]: {
+         std::tuple {
+           "Shared names, handlers only count events",
+           &sharedNames,
+           &sharedEvents,
+           &CountEvent},
+         std::tuple {
+           "Shared names, handlers hash the event value",
+           &sharedNames,
+           &sharedEvents,
+           &HandleEvent},
+         std::tuple {
+           "One tab per name, handlers hash the event value",
+           &ownNames,
+           &ownEvents,
+           &HandleEvent},
+       }) {
+    const auto timings = Benchmark(*names, *events, handle, hitsMatch);
+    const auto perEvent = [eventCount](double ms) {
+      return ms * 1e6 / eventCount;
+    };
+    std::cout << std::format(
+      "{}:\n"
+      "  By name:   {:.1f}ms ({:.0f}ns per event)\n"
+      "    timed:   {:.1f}ms ({:.0f}ns per event)\n"
+      "  Broadcast: {:.1f}ms ({:.0f}ns per event)\n",
+      label,
+      timings.mByName,
+      perEvent(timings.mByName),
+      timings.mTimed,
+      perEvent(timings.mTimed),
+      timings.mBroadcast,
+      perEvent(timings.mBroadcast));
+  }
+  return hitsMatch ? 0 : 1;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[TABS [EVENTS]]",
+        .mMaxArguments = 2,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              (arguments.size() >= 1) ? std::stoull(arguments[0]) : 500,
+              (arguments.size() == 2) ? std::stoull(arguments[1]) : 100000);
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
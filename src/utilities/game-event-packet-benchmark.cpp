@@ -0,0 +1,309 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `GameEventPacket` round trips and rejection of malformed packets,
+// fuzzes the parser, and measures building and parsing batches. Only depends
+// on the standard library, so it can also be built and profiled outside of
+// Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/GameEvent.h>
+#include <OpenKneeboard/GameEventPacket.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+using Events = std::vector<std::pair<std::string, std::string>>;
+
+std::string_view AsString(std::span<const std::byte> bytes) {
+  return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+Events Parse(const GameEventPacket& packet) {
+  Events ret;
+  for (const auto& event: packet) {
+    ret.emplace_back(event.name, event.value);
+  }
+  return ret;
+}
+
+std::string RandomString(std::mt19937_64& rng, size_t maxLength) {
+  std::string ret(rng() % (maxLength + 1), '\0');
+  for (auto& c: ret) {
+    // Include '!' and NUL, as they're special in the legacy framing
+    c = static_cast<char>(rng());
+  }
+  return ret;
+}
+
+Events RandomEvents(std::mt19937_64& rng, size_t count) {
+  Events ret;
+  for (size_t i = 0; i < count; ++i) {
+    ret.emplace_back(RandomString(rng, 32), RandomString(rng, 256));
+  }
+  return ret;
+}
+
+std::string BuildBinary(const Events& events) {
+  GameEventPacketBuilder builder;
+  for (const auto& [name, value]: events) {
+    builder.Append(name, value);
+  }
+  return std::string {AsString(builder.GetBytes())};
+}
+
+// Every proper prefix of a valid packet must be rejected
+bool RejectsTruncation(std::string_view packet) {
+  for (size_t i = 0; i < packet.size(); ++i) {
+    const GameEventPacket truncated(packet.substr(0, i));
+    if (truncated || truncated.GetEventCount() != 0) {
+      return false;
+    }
+    if (truncated.begin() != truncated.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int Verify() {
+  Checks check;
+  std::mt19937_64 rng {26};
+
+  const Events fixed {{"foo", "bar"}, {"", "x"}, {"name", ""}};
+  const auto fixedPacket = BuildBinary(fixed);
+  const GameEventPacket parsed(fixedPacket);
+  check(
+    parsed && parsed.GetFormat() == GameEventPacket::Format::Binary
+      && parsed.GetEventCount() == 3 && Parse(parsed) == fixed,
+    "binary round trip");
+  check(RejectsTruncation(fixedPacket), "truncated binary packets rejected");
+  check(!GameEventPacket(fixedPacket + "x"), "trailing bytes rejected");
+  {
+    auto badVersion = fixedPacket;
+    badVersion[4] = 3;
+    check(!GameEventPacket(badVersion), "unknown versions rejected");
+  }
+  {
+    auto badCount = fixedPacket;
+    badCount[8] = 4;
+    check(!GameEventPacket(badCount), "event count mismatch rejected");
+  }
+  check(
+    GameEventPacket(BuildBinary({})).GetFormat()
+        == GameEventPacket::Format::Binary
+      && GameEventPacket(BuildBinary({})).GetEventCount() == 0,
+    "empty binary packet");
+
+  const auto legacy = SerializeLegacyGameEvent({"abc", "hello!"});
+  const GameEventPacket legacyPacket(legacy);
+  check(
+    legacy == "00000003!abc!00000006!hello!!"
+      && legacyPacket.GetFormat() == GameEventPacket::Format::LegacyText
+      && Parse(legacyPacket) == Events {{"abc", "hello!"}},
+    "legacy round trip");
+  check(RejectsTruncation(legacy), "truncated legacy packets rejected");
+
+  bool randomOK = true;
+  for (size_t i = 0; i < 1000 && randomOK; ++i) {
+    const auto events = RandomEvents(rng, rng() % 8);
+    randomOK = Parse(GameEventPacket(BuildBinary(events))) == events;
+    for (const auto& [name, value]: events) {
+      randomOK = randomOK
+        && Parse(GameEventPacket(SerializeLegacyGameEvent({name, value})))
+          == Events {{name, value}};
+    }
+  }
+  check(randomOK, "random round trips");
+
+  const GameEvent single {"name", "value"};
+  const auto serialized = single.Serialize();
+  const auto unserialized = GameEvent::Unserialize(AsString(serialized));
+  check(
+    unserialized.name == single.name && unserialized.value == single.value,
+    "GameEvent::Serialize() round trip");
+  check(
+    GameEventPacket(AsString(serialized)).GetFormat()
+      == GameEventPacket::Format::LegacyText,
+    "GameEvent::Serialize() is compatible with older versions");
+  check(
+    !GameEvent::Unserialize(fixedPacket),
+    "GameEvent::Unserialize() rejects multiple events");
+
+  return check.GetExitCode();
+}
+
+// Random mutations of valid packets must either be rejected, or iterate
+// within the buffer
+int Fuzz(size_t iterations, uint64_t seed) {
+  std::cout << std::format("Random seed: {}\n", seed);
+  std::mt19937_64 rng {seed};
+  size_t accepted = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    const auto events = RandomEvents(rng, rng() % 4);
+    auto packet = (rng() % 2)
+      ? BuildBinary(events)
+      : (events.empty() ? std::string {}
+                        : SerializeLegacyGameEvent(
+                            {events.front().first, events.front().second}));
+    if (packet.empty()) {
+      continue;
+    }
+    for (size_t j = rng() % 4; j > 0; --j) {
+      packet[rng() % packet.size()] = static_cast<char>(rng());
+    }
+    if (rng() % 4 == 0) {
+      packet.resize(rng() % packet.size());
+    }
+
+    const std::string_view buffer {packet};
+    const GameEventPacket parsed(buffer);
+    size_t count = 0;
+    for (const auto& event: parsed) {
+      ++count;
+      for (const auto field: {event.name, event.value}) {
+        if (
+          field.data() < buffer.data()
+          || field.data() + field.size() > buffer.data() + buffer.size()) {
+          std::cout << std::format("FAILED: iteration {} out of bounds\n", i);
+          return 1;
+        }
+      }
+    }
+    if (count != parsed.GetEventCount() || (!parsed && count)) {
+      std::cout << std::format("FAILED: iteration {} count mismatch\n", i);
+      return 1;
+    }
+    accepted += parsed ? 1 : 0;
+  }
+  std::cout << std::format(
+    "OK: {} iterations, {} mutated packets still valid\n",
+    iterations,
+    accepted);
+  return 0;
+}
+
+int Benchmark(size_t eventCount) {
+  std::mt19937_64 rng {123};
+  Events events;
+  for (size_t i = 0; i < eventCount; ++i) {
+    events.emplace_back(
+      std::format("Event{}", i % 16), std::string(rng() % 200, 'x'));
+  }
+
+  constexpr size_t BatchSize = 64;
+  GameEventPacketBuilder builder;
+  std::vector<std::string> packets;
+  auto start = Clock::now();
+  for (size_t i = 0; i < events.size(); i += BatchSize) {
+    builder.Clear();
+    for (size_t j = i; j < std::min(i + BatchSize, events.size()); ++j) {
+      builder.Append(events.at(j).first, events.at(j).second);
+    }
+    packets.emplace_back(AsString(builder.GetBytes()));
+  }
+  const auto buildMS = MillisecondsSince(start);
+
+  size_t bytes = 0;
+  start = Clock::now();
+  for (const auto& packet: packets) {
+    for (const auto& event: GameEventPacket(packet)) {
+      bytes += event.name.size() + event.value.size();
+    }
+  }
+  const auto parseMS = MillisecondsSince(start);
+
+  std::vector<std::string> legacyPackets;
+  start = Clock::now();
+  for (const auto& [name, value]: events) {
+    legacyPackets.push_back(SerializeLegacyGameEvent({name, value}));
+  }
+  const auto legacyBuildMS = MillisecondsSince(start);
+
+  size_t legacyBytes = 0;
+  start = Clock::now();
+  for (const auto& packet: legacyPackets) {
+    for (const auto& event: GameEventPacket(packet)) {
+      legacyBytes += event.name.size() + event.value.size();
+    }
+  }
+  const auto legacyParseMS = MillisecondsSince(start);
+
+  std::cout << std::format(
+    "{} events, {} per binary packet\n"
+    "Binary: build {:.2f}ms, parse {:.2f}ms ({} packets)\n"
+    "Legacy: build {:.2f}ms, parse {:.2f}ms ({} packets)\n",
+    events.size(),
+    BatchSize,
+    buildMS,
+    parseMS,
+    packets.size(),
+    legacyBuildMS,
+    legacyParseMS,
+    legacyPackets.size());
+  return (bytes == legacyBytes) ? 0 : 1;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[EVENTS]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 1000000 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+      {
+        .mName = "fuzz",
+        .mUsage = "ITERATIONS [RANDOM_SEED]",
+        .mMinArguments = 1,
+        .mMaxArguments = 2,
+        .mRun =
+          [](auto arguments) {
+            return Fuzz(
+              std::stoull(arguments[0]),
+              (arguments.size() == 2) ? std::stoull(arguments[1])
+                                      : std::random_device {}());
+          },
+      },
+    });
+}
@@ -0,0 +1,329 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks that `GameEventReceiver` batches, orders, and stops correctly, and
+// measures throughput and dispatch latency with an in-memory packet source
+// and a stand-in for the UI thread. Only depends on the standard library,
+// so it can also be built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/GameEvent.h>
+#include <OpenKneeboard/GameEventBatch.h>
+#include <OpenKneeboard/GameEventPacket.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+// Stands in for the mailslot
+class QueuePacketSource final : public GameEventPacketSource {
+ public:
+  void Push(std::string packet) {
+    {
+      std::unique_lock lock(mMutex);
+      mPackets.push_back(std::move(packet));
+    }
+    mCV.notify_one();
+  }
+
+  void Close() {
+    {
+      std::unique_lock lock(mMutex);
+      mClosed = true;
+    }
+    mCV.notify_all();
+  }
+
+  bool ReadNext(const PacketCallback& callback, std::stop_token stopToken)
+    override {
+    std::unique_lock lock(mMutex);
+    mCV.wait(
+      lock, stopToken, [this]() { return mClosed || !mPackets.empty(); });
+    if (mPackets.empty()) {
+      return false;
+    }
+    mCurrent = std::move(mPackets.front());
+    mPackets.pop_front();
+    lock.unlock();
+    callback(mCurrent);
+    return true;
+  }
+
+  size_t ReadPending(const PacketCallback& callback) override {
+    {
+      std::unique_lock lock(mMutex);
+      mPending.swap(mPackets);
+    }
+    const auto count = mPending.size();
+    for (const auto& packet: mPending) {
+      callback(packet);
+    }
+    mPending.clear();
+    return count;
+  }
+
+ private:
+  std::mutex mMutex;
+  std::condition_variable_any mCV;
+  std::deque<std::string> mPackets;
+  bool mClosed {false};
+
+  // Receive thread only
+  std::string mCurrent;
+  std::deque<std::string> mPending;
+};
+
+// Stands in for `GameEventServer::DispatchBatch()` hopping to the UI thread
+class Dispatcher final {
+ public:
+  Dispatcher(GameEventBatchPool& pool, GameEventReceiveMetrics& metrics)
+    : mPool(pool), mMetrics(metrics) {
+    mThread = std::jthread {[this](std::stop_token stopToken) {
+      this->Run(stopToken);
+    }};
+  }
+
+  void Dispatch(std::unique_ptr<GameEventBatch> batch) {
+    {
+      std::unique_lock lock(mMutex);
+      mQueue.push_back(std::move(batch));
+    }
+    mCV.notify_one();
+  }
+
+  // Blocks until `count` events have been dispatched
+  std::vector<std::string> WaitForValues(size_t count) {
+    std::unique_lock lock(mMutex);
+    mCV.wait(lock, [&]() { return mValues.size() >= count; });
+    return mValues;
+  }
+
+  size_t GetBatchCount() {
+    std::unique_lock lock(mMutex);
+    return mBatchCount;
+  }
+
+ private:
+  GameEventBatchPool& mPool;
+  GameEventReceiveMetrics& mMetrics;
+  std::mutex mMutex;
+  std::condition_variable_any mCV;
+  std::deque<std::unique_ptr<GameEventBatch>> mQueue;
+  std::vector<std::string> mValues;
+  size_t mBatchCount {0};
+  std::jthread mThread;
+
+  void Run(std::stop_token stopToken) {
+    std::unique_lock lock(mMutex);
+    while (mCV.wait(lock, stopToken, [this]() { return !mQueue.empty(); })) {
+      auto batch = std::move(mQueue.front());
+      mQueue.pop_front();
+      lock.unlock();
+
+      mMetrics.RecordDispatched(*batch, GameEventBatch::Clock::now());
+      std::vector<std::string> values;
+      for (const auto& event: *batch) {
+        values.emplace_back(event.value);
+      }
+      mPool.Release(std::move(batch));
+
+      lock.lock();
+      ++mBatchCount;
+      std::ranges::move(values, std::back_inserter(mValues));
+      mCV.notify_all();
+    }
+  }
+};
+
+std::string MakePacket(std::string_view name, std::string_view value) {
+  GameEventPacketBuilder builder;
+  builder.Append(name, value);
+  const auto bytes = builder.GetBytes();
+  return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+int Verify() {
+  Checks check;
+
+  {
+    GameEventBatchPool pool;
+    GameEventReceiveMetrics metrics;
+    Dispatcher dispatcher {pool, metrics};
+    size_t inspected = 0;
+    std::vector<std::string> invalid;
+    GameEventReceiver receiver {
+      pool,
+      metrics,
+      {
+        .mInspect = [&](const auto& batch,
+                        auto) { inspected += batch.GetEventCount(); },
+        .mDispatch =
+          [&](auto batch) { dispatcher.Dispatch(std::move(batch)); },
+        .mInvalidPacket =
+          [&](std::string_view packet) { invalid.emplace_back(packet); },
+      },
+    };
+    QueuePacketSource source;
+
+    // Everything already pending when the receiver wakes up is one batch
+    for (size_t i = 0; i < 100; ++i) {
+      source.Push(MakePacket("Event", std::to_string(i)));
+    }
+    source.Push("not a packet");
+    source.Push(MakePacket(
+      GameEvent::EVT_MULTI_EVENT, R"([["Event", "100"], ["Event", "101"]])"));
+    check(receiver.RunOnce(source, {}), "RunOnce() with pending packets");
+    auto values = dispatcher.WaitForValues(102);
+    bool ordered = values.size() == 102;
+    for (size_t i = 0; ordered && i < values.size(); ++i) {
+      ordered = values.at(i) == std::to_string(i);
+    }
+    check(ordered, "every event dispatched, in order");
+    check(
+      dispatcher.GetBatchCount() == 1 && inspected == 102,
+      "pending packets dispatched as one batch");
+    const auto snapshot = metrics.GetSnapshot();
+    check(
+      snapshot.mPackets == 102 && snapshot.mInvalidPackets == 1
+        && snapshot.mEvents == 102 && snapshot.mQueueDepth == 0,
+      "metrics");
+    check(
+      invalid == std::vector<std::string> {"not a packet"},
+      "invalid packets reported");
+
+    // Invalid-only wakeups aren't dispatched
+    source.Push("still not a packet");
+    check(
+      receiver.RunOnce(source, {}) && dispatcher.GetBatchCount() == 1,
+      "empty batches not dispatched");
+
+    // Stops while waiting
+    std::stop_source stop;
+    std::jthread stopper {[&stop]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      stop.request_stop();
+    }};
+    receiver.Run(source, stop.get_token());
+    check(true, "Run() returns when stopped");
+
+    std::jthread producer {[&source]() {
+      for (size_t i = 102; i < 10000; ++i) {
+        source.Push(MakePacket("Event", std::to_string(i)));
+      }
+      source.Close();
+    }};
+    receiver.Run(source, {});
+    values = dispatcher.WaitForValues(10000);
+    ordered = values.size() == 10000;
+    for (size_t i = 0; ordered && i < values.size(); ++i) {
+      ordered = values.at(i) == std::to_string(i);
+    }
+    check(ordered, "concurrent producer: every event dispatched, in order");
+    check(true, "Run() returns when the source is closed");
+  }
+
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t eventCount, size_t producerCount) {
+  GameEventBatchPool pool;
+  GameEventReceiveMetrics metrics;
+  Dispatcher dispatcher {pool, metrics};
+  GameEventReceiver receiver {
+    pool,
+    metrics,
+    {.mDispatch = [&](auto batch) { dispatcher.Dispatch(std::move(batch)); }},
+  };
+  QueuePacketSource source;
+
+  const auto start = Clock::now();
+  std::jthread receiveThread {[&]() { receiver.Run(source, {}); }};
+  {
+    std::vector<std::jthread> producers;
+    for (size_t i = 0; i < producerCount; ++i) {
+      producers.emplace_back([&, i]() {
+        const auto value = std::string(100, 'x');
+        for (size_t j = i; j < eventCount; j += producerCount) {
+          source.Push(MakePacket(std::format("Event{}", j % 16), value));
+        }
+      });
+    }
+  }
+  source.Close();
+  receiveThread.join();
+  dispatcher.WaitForValues(eventCount);
+  const auto elapsed = MillisecondsSince(start);
+
+  const auto snapshot = metrics.GetSnapshot();
+  std::cout << std::format(
+    "{} events from {} producers in {:.1f}ms ({:.0f} events/s)\n"
+    "{} batches; largest {} events; max queue depth {}\n"
+    "Dispatch latency: mean {}us, max {}us\n",
+    snapshot.mEvents,
+    producerCount,
+    elapsed,
+    snapshot.mEvents / (elapsed / 1000),
+    snapshot.mBatches,
+    snapshot.mLargestBatch,
+    snapshot.mMaxQueueDepth,
+    snapshot.mTotalDispatchLatency.count()
+      / std::max<uint64_t>(snapshot.mBatches, 1),
+    snapshot.mMaxDispatchLatency.count());
+  return (snapshot.mEvents == eventCount) ? 0 : 1;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[EVENTS [PRODUCERS]]",
+        .mMaxArguments = 2,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              (arguments.size() >= 1) ? std::stoull(arguments[0]) : 1000000,
+              (arguments.size() == 2) ? std::stoull(arguments[1]) : 4);
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
@@ -0,0 +1,266 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks that `GameEvent` recordings round-trip, that truncated or corrupt
+// recordings stop cleanly, and that replay timing follows the recording;
+// also measures recording and replay throughput. Only depends on the
+// standard library, so it can also be built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/GameEventRecording.h>
+
+#include <shims/filesystem>
+
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+using namespace std::chrono_literals;
+
+std::filesystem::path GetScratchPath(std::string_view name) {
+  return std::filesystem::temp_directory_path()
+    / std::format("game-event-recording-benchmark-{}.okgerec", name);
+}
+
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream f(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(f), {}};
+}
+
+// Roughly the shape of DCS traffic: frequent small updates, occasional
+// large values
+std::vector<GameEvent> MakeEvents(size_t count) {
+  std::mt19937_64 rng {30};
+  constexpr std::string_view names[] {
+    "SelfData", "MissionTime", "Message", "Aircraft", "Terrain"};
+  std::vector<GameEvent> events;
+  for (size_t i = 0; i < count; ++i) {
+    const auto name = names[(i % 7 == 0) ? 2 + (rng() % 3) : (rng() % 2)];
+    const auto size = (rng() % 100 == 0) ? 4096 : 16 + rng() % 64;
+    events.push_back({std::string {name}, std::string(size, 'a' + (i % 26))});
+  }
+  return events;
+}
+
+void WriteRecording(
+  const std::filesystem::path& path,
+  const std::vector<GameEvent>& events,
+  GameEventRecordingWriter::Clock::duration interval) {
+  const auto start = GameEventRecordingWriter::Clock::now();
+  GameEventRecordingWriter writer {path};
+  for (size_t i = 0; i < events.size(); ++i) {
+    writer.Write(start + (i * interval), events[i].name, events[i].value);
+  }
+}
+
+int Verify() {
+  Checks check;
+  const auto path = GetScratchPath("verify");
+  const auto events = MakeEvents(10000);
+  WriteRecording(path, events, 7ms);
+
+  {
+    GameEventRecordingReader reader {path};
+    check(reader.IsValid(), "header");
+    bool same = true;
+    size_t count = 0;
+    std::chrono::microseconds lastTimestamp {};
+    while (const auto record = reader.Next()) {
+      same = same && count < events.size()
+        && record->mEvent.name == events[count].name
+        && record->mEvent.value == events[count].value
+        && record->mTimestamp == count * 7ms;
+      lastTimestamp = record->mTimestamp;
+      ++count;
+    }
+    check(
+      same && count == events.size() && !reader.IsCorrupt(),
+      "round trip, including timestamps");
+    check(lastTimestamp == 9999 * 7ms, "recorded duration");
+  }
+
+  const auto contents = ReadFile(path);
+  {
+    size_t valuesSize = 0;
+    for (const auto& event: events) {
+      valuesSize += event.value.size();
+    }
+    check(
+      contents.size() < valuesSize + (events.size() * 6),
+      std::format(
+        "compact: {} bytes for {} bytes of values",
+        contents.size(),
+        valuesSize));
+  }
+
+  // Every truncation must stop cleanly at an event boundary; check every
+  // offset near the start, then sample the rest
+  bool truncationOK = true;
+  for (size_t i = GameEventRecordingFormat::HeaderSize;
+       i < contents.size() && truncationOK;
+       i += (i < 4096) ? 1 : (contents.size() / 256)) {
+    GameEventRecordingReader reader {contents.substr(0, i)};
+    size_t count = 0;
+    while (const auto record = reader.Next()) {
+      truncationOK
+        = truncationOK && record->mEvent.value == events[count].value;
+      ++count;
+    }
+    truncationOK = truncationOK && count < events.size();
+  }
+  check(truncationOK, "truncated recordings");
+
+  check(
+    !GameEventRecordingReader {contents.substr(0, 4)}.IsValid(),
+    "missing header");
+  {
+    auto badVersion = contents;
+    badVersion[GameEventRecordingFormat::Magic.size()] = 2;
+    check(
+      !GameEventRecordingReader {badVersion}.IsValid(), "unknown version");
+  }
+
+  // Random corruption must never crash, or read out of bounds
+  std::mt19937_64 rng {30};
+  for (size_t i = 0; i < 200; ++i) {
+    auto corrupt = contents;
+    for (size_t j = 0; j < 8; ++j) {
+      corrupt[GameEventRecordingFormat::HeaderSize
+              + rng() % (corrupt.size() - GameEventRecordingFormat::HeaderSize)]
+        = static_cast<char>(rng());
+    }
+    GameEventRecordingReader reader {std::move(corrupt)};
+    while (reader.Next()) {
+    }
+  }
+  check(true, "corrupt recordings");
+
+  // Replay follows the recorded timing, scaled by the speed
+  {
+    GameEventRecordingReader reader {contents};
+    std::vector<std::chrono::steady_clock::time_point> sleeps;
+    size_t count = 0;
+    size_t beforeWaitCount = 0;
+    bool ordered = true;
+    const auto stats = ReplayGameEvents(
+      reader,
+      {
+        .mSpeed = 2,
+        .mBeforeWait = [&beforeWaitCount]() { ++beforeWaitCount; },
+        .mSleepUntil = [&](auto until) { sleeps.push_back(until); },
+      },
+      [&](const GameEvent& event) {
+        ordered = ordered && event.value == events[count].value;
+        ++count;
+      });
+    bool timingOK = sleeps.size() >= 2;
+    for (size_t i = 1; timingOK && i < sleeps.size(); ++i) {
+      const auto delta = sleeps[i] - sleeps[i - 1];
+      timingOK = delta >= 3500us - 1us && delta <= 3500us + 1us;
+    }
+    check(
+      ordered && count == events.size() && stats.mEventCount == count,
+      "replay order");
+    check(timingOK, "replay timing at 2x speed");
+    check(
+      beforeWaitCount >= sleeps.size() && beforeWaitCount > 0,
+      "replay calls mBeforeWait before waiting");
+  }
+
+  {
+    GameEventRecordingReader reader {contents};
+    std::stop_source stop;
+    size_t count = 0;
+    const auto stats = ReplayGameEvents(
+      reader,
+      {.mSpeed = 0, .mStopToken = stop.get_token()},
+      [&](const GameEvent&) {
+        if (++count == 100) {
+          stop.request_stop();
+        }
+      });
+    check(stats.mStopped && count == 100, "replay stops when requested");
+  }
+
+  std::filesystem::remove(path);
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t eventCount) {
+  const auto path = GetScratchPath("bench");
+  const auto events = MakeEvents(eventCount);
+
+  auto start = Clock::now();
+  WriteRecording(path, events, 1ms);
+  const auto writeMS = MillisecondsSince(start);
+  const auto bytes = std::filesystem::file_size(path);
+
+  GameEventRecordingReader reader {path};
+  size_t count = 0;
+  start = Clock::now();
+  const auto stats = ReplayGameEvents(
+    reader, {.mSpeed = 0}, [&count](const GameEvent&) { ++count; });
+  const auto replayMS = MillisecondsSince(start);
+  std::filesystem::remove(path);
+
+  std::cout << std::format(
+    "{} events, {:.1f}MiB\n"
+    "Record: {:.1f}ms ({:.0f} events/s)\n"
+    "Replay: {:.1f}ms ({:.0f} events/s)\n",
+    eventCount,
+    bytes / (1024.0 * 1024.0),
+    writeMS,
+    eventCount / (writeMS / 1000),
+    replayMS,
+    count / (replayMS / 1000));
+  return (count == eventCount && !stats.mCorrupt) ? 0 : 1;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[EVENTS]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 1000000 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
@@ -0,0 +1,594 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `GameEventRing` on its own and with producers and a consumer in
+// separate processes - including a consumer that crashes without detaching -
+// and measures multi-process throughput. Only depends on the standard
+// library and the OS's shared memory and process APIs, so it can also be
+// built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/GameEventRing.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// Producer processes are this executable, with a hidden command
+const char* gExecutable {nullptr};
+
+constexpr size_t RingCapacity = 256 * 1024;
+
+#ifdef _WIN32
+class SharedMemory final {
+ public:
+  SharedMemory(const std::string& name, size_t byteCount, bool create) {
+    mMapping = create ? CreateFileMappingA(
+                          INVALID_HANDLE_VALUE,
+                          nullptr,
+                          PAGE_READWRITE,
+                          0,
+                          static_cast<DWORD>(byteCount),
+                          name.c_str())
+                      : OpenFileMappingA(FILE_MAP_WRITE, FALSE, name.c_str());
+    if (!mMapping) {
+      throw std::runtime_error(std::format("Failed to open {}", name));
+    }
+    mView = MapViewOfFile(mMapping, FILE_MAP_WRITE, 0, 0, byteCount);
+    if (!mView) {
+      CloseHandle(mMapping);
+      throw std::runtime_error(std::format("Failed to map {}", name));
+    }
+  }
+
+  ~SharedMemory() {
+    UnmapViewOfFile(mView);
+    CloseHandle(mMapping);
+  }
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  void* data() const noexcept {
+    return mView;
+  }
+
+ private:
+  HANDLE mMapping {nullptr};
+  void* mView {nullptr};
+};
+
+class ChildProcess final {
+ public:
+  explicit ChildProcess(const std::vector<std::string>& arguments) {
+    auto commandLine = std::format("\"{}\"", gExecutable);
+    for (const auto& argument: arguments) {
+      commandLine += std::format(" \"{}\"", argument);
+    }
+    STARTUPINFOA startupInfo {.cb = sizeof(STARTUPINFOA)};
+    PROCESS_INFORMATION processInfo {};
+    if (!CreateProcessA(
+          gExecutable,
+          commandLine.data(),
+          nullptr,
+          nullptr,
+          FALSE,
+          0,
+          nullptr,
+          nullptr,
+          &startupInfo,
+          &processInfo)) {
+      throw std::runtime_error("Failed to start a child process");
+    }
+    CloseHandle(processInfo.hThread);
+    mProcess = processInfo.hProcess;
+  }
+
+  ~ChildProcess() {
+    this->Wait();
+    CloseHandle(mProcess);
+  }
+
+  ChildProcess(const ChildProcess&) = delete;
+  ChildProcess& operator=(const ChildProcess&) = delete;
+
+  bool HasExited() const noexcept {
+    return WaitForSingleObject(mProcess, 0) == WAIT_OBJECT_0;
+  }
+
+  int Wait() {
+    WaitForSingleObject(mProcess, INFINITE);
+    DWORD exitCode {};
+    GetExitCodeProcess(mProcess, &exitCode);
+    return static_cast<int>(exitCode);
+  }
+
+ private:
+  HANDLE mProcess {nullptr};
+};
+
+std::string GetSharedMemoryName(std::string_view purpose, size_t index) {
+  return std::format(
+    "Local\\game-event-ring-benchmark.{}.{}.{}",
+    GetCurrentProcessId(),
+    purpose,
+    index);
+}
+#else
+class SharedMemory final {
+ public:
+  SharedMemory(const std::string& name, size_t byteCount, bool create)
+    : mName(name), mByteCount(byteCount), mOwner(create) {
+    const auto fd = shm_open(
+      name.c_str(), create ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR, 0600);
+    if (fd < 0) {
+      throw std::runtime_error(std::format("Failed to open {}", name));
+    }
+    if (create && ftruncate(fd, static_cast<off_t>(byteCount)) != 0) {
+      close(fd);
+      shm_unlink(name.c_str());
+      throw std::runtime_error(std::format("Failed to resize {}", name));
+    }
+    mView = mmap(nullptr, byteCount, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mView == MAP_FAILED) {
+      if (create) {
+        shm_unlink(name.c_str());
+      }
+      throw std::runtime_error(std::format("Failed to map {}", name));
+    }
+  }
+
+  ~SharedMemory() {
+    munmap(mView, mByteCount);
+    if (mOwner) {
+      shm_unlink(mName.c_str());
+    }
+  }
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  void* data() const noexcept {
+    return mView;
+  }
+
+ private:
+  std::string mName;
+  size_t mByteCount {0};
+  bool mOwner {false};
+  void* mView {nullptr};
+};
+
+class ChildProcess final {
+ public:
+  explicit ChildProcess(const std::vector<std::string>& arguments) {
+    std::vector<char*> argv {const_cast<char*>(gExecutable)};
+    for (const auto& argument: arguments) {
+      argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+    const auto error = posix_spawn(
+      &mProcess, gExecutable, nullptr, nullptr, argv.data(), environ);
+    if (error != 0) {
+      throw std::runtime_error("Failed to start a child process");
+    }
+  }
+
+  ~ChildProcess() {
+    this->Wait();
+  }
+
+  ChildProcess(const ChildProcess&) = delete;
+  ChildProcess& operator=(const ChildProcess&) = delete;
+
+  bool HasExited() noexcept {
+    if (mExitCode) {
+      return true;
+    }
+    int status {};
+    if (waitpid(mProcess, &status, WNOHANG) != mProcess) {
+      return false;
+    }
+    mExitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return true;
+  }
+
+  int Wait() {
+    if (!mExitCode) {
+      int status {};
+      waitpid(mProcess, &status, 0);
+      mExitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+    return *mExitCode;
+  }
+
+ private:
+  pid_t mProcess {};
+  std::optional<int> mExitCode;
+};
+
+std::string GetSharedMemoryName(std::string_view purpose, size_t index) {
+  return std::format(
+    "/game-event-ring-benchmark.{}.{}.{}", getpid(), purpose, index);
+}
+#endif
+
+/* Records are an 8-byte sequence number followed by a pattern that depends
+ * on it, with varying lengths so that records wrap around the end of the
+ * ring at different offsets.
+ */
+size_t MakeRecord(uint64_t sequence, std::vector<std::byte>& buffer) {
+  const auto size = sizeof(sequence) + 16 + (sequence * 7919) % 300;
+  buffer.resize(size);
+  std::memcpy(buffer.data(), &sequence, sizeof(sequence));
+  for (size_t i = sizeof(sequence); i < size; ++i) {
+    buffer[i] = static_cast<std::byte>((sequence + i) & 0xff);
+  }
+  return size;
+}
+
+bool IsExpectedRecord(uint64_t sequence, const std::vector<char>& record) {
+  if (record.size() < sizeof(sequence)) {
+    return false;
+  }
+  uint64_t actual {};
+  std::memcpy(&actual, record.data(), sizeof(actual));
+  if (actual != sequence) {
+    return false;
+  }
+  thread_local std::vector<std::byte> expected;
+  MakeRecord(sequence, expected);
+  return record.size() == expected.size()
+    && std::memcmp(record.data(), expected.data(), record.size()) == 0;
+}
+
+// Child process: write `count` records to an existing ring
+int Produce(const std::string& name, uint64_t count) {
+  const auto byteCount = GameEventRing::GetByteCount(RingCapacity);
+  SharedMemory memory {name, byteCount, false};
+  auto ring = GameEventRing::Open(memory.data(), byteCount);
+  if (!ring) {
+    return 1;
+  }
+  std::vector<std::byte> record;
+  for (uint64_t i = 0; i < count; ++i) {
+    MakeRecord(i, record);
+    while (!ring->TryWrite(record)) {
+      std::this_thread::yield();
+    }
+  }
+  return 0;
+}
+
+// Child process: attach and heartbeat for a while, then exit without
+// detaching, like a crashing GameEventServer
+int CrashConsumer(const std::string& name) {
+  const auto byteCount = GameEventRing::GetByteCount(RingCapacity);
+  SharedMemory memory {name, byteCount, false};
+  auto ring = GameEventRing::Open(memory.data(), byteCount);
+  if (!ring) {
+    return 1;
+  }
+  ring->SetConsumerAttached(true);
+  for (int i = 0; i < 20; ++i) {
+    ring->Heartbeat();
+    std::this_thread::sleep_for(10ms);
+  }
+  std::_Exit(0);
+}
+
+struct MultiProcessResult {
+  uint64_t mReceived {0};
+  bool mInOrder {true};
+  bool mProducersSucceeded {true};
+  double mMilliseconds {0};
+};
+
+// Consume from `producerCount` child processes, each with its own ring
+MultiProcessResult RunProducers(size_t producerCount, uint64_t perProducer) {
+  const auto byteCount = GameEventRing::GetByteCount(RingCapacity);
+
+  // Create the rings before starting the producers, so opening them isn't
+  // racy
+  std::vector<std::unique_ptr<SharedMemory>> memory;
+  std::vector<GameEventRing> rings;
+  for (size_t i = 0; i < producerCount; ++i) {
+    memory.push_back(std::make_unique<SharedMemory>(
+      GetSharedMemoryName("producer", i), byteCount, true));
+    rings.push_back(*GameEventRing::Create(memory.back()->data(), byteCount));
+    rings.back().SetConsumerAttached(true);
+  }
+
+  MultiProcessResult result;
+  const auto start = Clock::now();
+  std::vector<std::unique_ptr<ChildProcess>> producers;
+  for (size_t i = 0; i < producerCount; ++i) {
+    const std::vector<std::string> arguments {
+      "produce",
+      GetSharedMemoryName("producer", i),
+      std::to_string(perProducer),
+    };
+    producers.push_back(std::make_unique<ChildProcess>(arguments));
+  }
+
+  std::vector<uint64_t> next(producerCount, 0);
+  std::vector<char> buffer;
+  size_t finished = 0;
+  while (finished < producerCount) {
+    finished = 0;
+    bool idle = true;
+    for (size_t i = 0; i < producerCount; ++i) {
+      if (next[i] == perProducer) {
+        ++finished;
+        continue;
+      }
+      // As in GameEventServer, check before draining so that we don't miss
+      // anything written between draining and the check
+      const auto exited = producers[i]->HasExited();
+      while (rings[i].TryRead(buffer)) {
+        idle = false;
+        result.mInOrder = result.mInOrder && IsExpectedRecord(next[i], buffer);
+        ++next[i];
+        ++result.mReceived;
+      }
+      if (exited && next[i] != perProducer) {
+        // It failed or crashed; don't wait forever
+        result.mProducersSucceeded = false;
+        next[i] = perProducer;
+      }
+    }
+    if (idle) {
+      std::this_thread::yield();
+    }
+  }
+  result.mMilliseconds = MillisecondsSince(start);
+
+  for (const auto& producer: producers) {
+    result.mProducersSucceeded
+      = result.mProducersSucceeded && producer->Wait() == 0;
+  }
+  return result;
+}
+
+void VerifyRing(Checks& check) {
+  constexpr size_t capacity = 4096;
+  std::vector<std::byte> memory(GameEventRing::GetByteCount(capacity));
+  auto producer = GameEventRing::Create(memory.data(), memory.size());
+  auto consumer = GameEventRing::Open(memory.data(), memory.size());
+  if (!check(producer && consumer, "create and open")) {
+    return;
+  }
+  check(producer->GetCapacity() == capacity, "capacity");
+
+  std::vector<std::byte> record;
+  std::vector<char> buffer;
+  bool inOrder = true;
+  uint64_t written = 0;
+  uint64_t read = 0;
+  bool sawFull = false;
+  // Enough to wrap around many times, at every alignment
+  while (read < 5000) {
+    MakeRecord(written, record);
+    if (producer->TryWrite(record)) {
+      ++written;
+      continue;
+    }
+    sawFull = true;
+    for (int i = 0; i < 3 && consumer->TryRead(buffer); ++i) {
+      inOrder = inOrder && IsExpectedRecord(read, buffer);
+      ++read;
+    }
+  }
+  while (consumer->TryRead(buffer)) {
+    inOrder = inOrder && IsExpectedRecord(read, buffer);
+    ++read;
+  }
+  check(
+    inOrder && sawFull && read == written
+      && consumer->GetPendingByteCount() == 0,
+    "wrap-around, and full rings reject writes");
+
+  record.resize(capacity);
+  check(!producer->TryWrite(record), "oversized packet is rejected");
+
+  // Start again, so that the next record is at the start of the data area
+  producer = GameEventRing::Create(memory.data(), memory.size());
+  consumer = GameEventRing::Open(memory.data(), memory.size());
+  MakeRecord(0, record);
+  producer->TryWrite(record);
+  // Corrupt the record size
+  std::memset(memory.data() + memory.size() - capacity, 0xff, 4);
+  check(
+    !consumer->TryRead(buffer) && consumer->GetPendingByteCount() == 0,
+    "corrupt ring is emptied");
+
+  producer = GameEventRing::Create(memory.data(), memory.size());
+  consumer = GameEventRing::Open(memory.data(), memory.size());
+  MakeRecord(0, record);
+  producer->TryWrite(record);
+  producer->TryWrite(record);
+  const auto readBeforeAbandon = consumer->TryRead(buffer);
+  producer->Abandon();
+  check(
+    readBeforeAbandon && consumer->IsAbandoned() && !consumer->TryRead(buffer)
+      && consumer->GetPendingByteCount() > 0,
+    "abandoned ring is not read further");
+
+  std::vector<std::byte> garbage(memory.size(), std::byte {0x5a});
+  check(
+    !GameEventRing::Open(garbage.data(), garbage.size()),
+    "opening garbage fails");
+  check(
+    !GameEventRing::Open(memory.data(), memory.size() - capacity),
+    "opening a short mapping fails");
+}
+
+void VerifyHeartbeat(Checks& check) {
+  std::vector<std::byte> memory(GameEventRing::GetByteCount(4096));
+  auto producer = GameEventRing::Create(memory.data(), memory.size());
+  auto consumer = GameEventRing::Open(memory.data(), memory.size());
+
+  const auto t0 = Clock::time_point {} + 1h;
+  check(!producer->IsConsumerAlive(t0, 5s), "not alive before attaching");
+  consumer->SetConsumerAttached(true);
+  bool alive = producer->IsConsumerAlive(t0, 5s);
+  for (int i = 1; i <= 10; ++i) {
+    consumer->Heartbeat();
+    alive = alive && producer->IsConsumerAlive(t0 + (i * 1s), 5s);
+  }
+  check(alive, "alive while heartbeating");
+  check(
+    producer->IsConsumerAlive(t0 + 14s, 5s)
+      && !producer->IsConsumerAlive(t0 + 15s, 5s),
+    "stale 5s after the last heartbeat");
+  check(producer->IsConsumerAttached(), "stale consumer is still attached");
+  consumer->Heartbeat();
+  check(producer->IsConsumerAlive(t0 + 60s, 5s), "alive after recovery");
+  consumer->SetConsumerAttached(false);
+  check(!producer->IsConsumerAlive(t0 + 61s, 5s), "not alive after detaching");
+}
+
+void VerifyCrashedConsumer(Checks& check) {
+  const auto byteCount = GameEventRing::GetByteCount(RingCapacity);
+  SharedMemory memory {GetSharedMemoryName("crash", 0), byteCount, true};
+  auto producer = GameEventRing::Create(memory.data(), byteCount);
+
+  ChildProcess consumer {{"crash-consumer", GetSharedMemoryName("crash", 0)}};
+  const auto deadline = Clock::now() + 10s;
+  while (!producer->IsConsumerAttached() && Clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+  check(
+    producer->IsConsumerAlive(Clock::now(), 100ms),
+    "consumer in another process is alive");
+  check(consumer.Wait() == 0, "consumer process exited");
+
+  const auto crashedAt = Clock::now();
+  while (producer->IsConsumerAlive(Clock::now(), 100ms)
+         && Clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+  const auto detectedMS = MillisecondsSince(crashedAt);
+  check(
+    producer->IsConsumerAttached() && detectedMS < 1000,
+    std::format(
+      "crashed consumer is still attached, but stale after {:.0f}ms",
+      detectedMS));
+}
+
+int Verify() {
+  Checks check;
+  VerifyRing(check);
+  VerifyHeartbeat(check);
+  VerifyCrashedConsumer(check);
+
+  constexpr uint64_t perProducer = 50000;
+  const auto result = RunProducers(4, perProducer);
+  check(
+    result.mProducersSucceeded && result.mInOrder
+      && result.mReceived == 4 * perProducer,
+    std::format(
+      "4 producer processes, {} records, each in order", result.mReceived));
+  return check.GetExitCode();
+}
+
+int Benchmark(uint64_t events, size_t producerCount) {
+  const auto result = RunProducers(producerCount, events / producerCount);
+  std::cout << std::format(
+    "{} producer processes, {} events: {:.1f}ms ({:.0f} events/s){}\n",
+    producerCount,
+    result.mReceived,
+    result.mMilliseconds,
+    result.mReceived / (result.mMilliseconds / 1000),
+    (result.mInOrder && result.mProducersSucceeded) ? "" : " - FAILED");
+  return (result.mInOrder && result.mProducersSucceeded) ? 0 : 1;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  gExecutable = argv[0];
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[EVENTS [PRODUCERS]]",
+        .mMaxArguments = 2,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 2000000 : std::stoull(arguments[0]),
+              arguments.size() < 2 ? 4 : std::stoull(arguments[1]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+      // Used by `verify` and `bench`
+      {
+        .mName = "produce",
+        .mUsage = "MAPPING COUNT",
+        .mMinArguments = 2,
+        .mMaxArguments = 2,
+        .mRun =
+          [](auto arguments) {
+            return Produce(arguments[0], std::stoull(arguments[1]));
+          },
+      },
+      {
+        .mName = "crash-consumer",
+        .mUsage = "MAPPING",
+        .mMinArguments = 1,
+        .mMaxArguments = 1,
+        .mRun = [](auto arguments) { return CrashConsumer(arguments[0]); },
+      },
+    });
+}
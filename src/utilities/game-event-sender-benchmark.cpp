@@ -0,0 +1,363 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `GameEventSender`'s ordering, overflow policies, flushing and
+// shutdown against an in-memory transport, and compares the time spent in
+// `Enqueue()` with writing each event synchronously to a slow transport.
+// Only depends on the standard library, so it can also be built and
+// profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/GameEventPacket.h>
+#include <OpenKneeboard/GameEventSender.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+struct Written {
+  std::mutex mMutex;
+  std::vector<std::string> mPackets;
+  // Held by the test to block writes
+  std::mutex mGate;
+  std::chrono::microseconds mWriteCost {0};
+
+  // All events in every packet, as "name=value "
+  std::string GetEvents() {
+    std::unique_lock lock(mMutex);
+    std::string ret;
+    for (const auto& packet: mPackets) {
+      for (const auto& event: GameEventPacket {packet}) {
+        ret += std::format("{}={} ", event.name, event.value);
+      }
+    }
+    return ret;
+  }
+};
+
+class TestTransport final : public GameEventTransport {
+ public:
+  TestTransport(const std::shared_ptr<Written>& written) : mWritten(written) {
+  }
+
+  bool Write(std::span<const std::byte> packet) override {
+    { std::unique_lock gate(mWritten->mGate); }
+    if (mWritten->mWriteCost.count()) {
+      std::this_thread::sleep_for(mWritten->mWriteCost);
+    }
+    std::unique_lock lock(mWritten->mMutex);
+    mWritten->mPackets.emplace_back(
+      reinterpret_cast<const char*>(packet.data()), packet.size());
+    return true;
+  }
+
+ private:
+  std::shared_ptr<Written> mWritten;
+};
+
+std::unique_ptr<GameEventTransport> CreateTransport(
+  const std::shared_ptr<Written>& written) {
+  return std::make_unique<TestTransport>(written);
+}
+
+int Verify() {
+  Checks check;
+  using Policy = GameEventSender::OverflowPolicy;
+
+  {
+    auto written = std::make_shared<Written>();
+    std::string expected;
+    {
+      GameEventSender sender {
+        CreateTransport(written),
+        {.mQueueCapacity = 16, .mOverflowPolicy = Policy::Block},
+      };
+      for (int i = 0; i < 10000; ++i) {
+        sender.Enqueue({"n", std::to_string(i)});
+        expected += std::format("n={} ", i);
+      }
+      check(sender.Flush(std::chrono::seconds(5)), "flush");
+    }
+    check(written->GetEvents() == expected, "blocking keeps every event, in order");
+  }
+
+  {
+    auto written = std::make_shared<Written>();
+    std::unique_lock gate(written->mGate);
+    GameEventSender sender {
+      CreateTransport(written),
+      {.mQueueCapacity = 4, .mOverflowPolicy = Policy::CoalesceByName},
+    };
+    // The flush thread blocks on the gate while writing this
+    sender.Enqueue({"first", "0"});
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (int i = 0; i < 4; ++i) {
+      sender.Enqueue({"q", std::to_string(i)});
+    }
+    for (int i = 0; i < 100; ++i) {
+      sender.Enqueue({(i % 2) ? "a" : "b", std::to_string(i)});
+    }
+    sender.Enqueue({GameEvent::EVT_MULTI_EVENT, "x"});
+    sender.Enqueue({GameEvent::EVT_MULTI_EVENT, "y"});
+    check(
+      !sender.Flush(std::chrono::milliseconds(10)),
+      "flush times out while the transport is blocked");
+    gate.unlock();
+    check(sender.Flush(std::chrono::seconds(5)), "flush after unblocking");
+    check(sender.GetStats().mCoalesced == 98, "overflow coalesced by name");
+    check(
+      written->GetEvents()
+        == std::format(
+          "first=0 q=0 q=1 q=2 q=3 b=98 a=99 {0}=x {0}=y ",
+          GameEvent::EVT_MULTI_EVENT),
+      "coalescing keeps order, and never coalesces multi-events");
+  }
+
+  {
+    auto written = std::make_shared<Written>();
+    std::unique_lock gate(written->mGate);
+    GameEventSender sender {
+      CreateTransport(written),
+      {.mQueueCapacity = 4, .mOverflowPolicy = Policy::CoalesceByName},
+    };
+    sender.Enqueue({"first", "0"});
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (int i = 0; i < 4; ++i) {
+      sender.Enqueue({"q", std::to_string(i)});
+    }
+    for (int i = 0; i < 10000; ++i) {
+      sender.Enqueue({GameEvent::EVT_MULTI_EVENT, std::to_string(i)});
+      sender.Enqueue({std::format("n{}", i), std::to_string(i)});
+    }
+    gate.unlock();
+    check(sender.Flush(std::chrono::seconds(5)), "flush after a long stall");
+    const auto stats = sender.GetStats();
+    size_t count = 0;
+    std::string lastMulti;
+    {
+      std::unique_lock lock(written->mMutex);
+      for (const auto& packet: written->mPackets) {
+        for (const auto& event: GameEventPacket {packet}) {
+          ++count;
+          if (event.name == GameEvent::EVT_MULTI_EVENT) {
+            lastMulti = event.value;
+          }
+        }
+      }
+    }
+    check(
+      count < 1000 && stats.mDropped + stats.mCoalesced + count == 20005
+        && lastMulti == "9999",
+      "overflow is capped, keeping the latest events");
+  }
+
+  {
+    auto written = std::make_shared<Written>();
+    std::unique_lock gate(written->mGate);
+    GameEventSender sender {
+      CreateTransport(written),
+      {.mQueueCapacity = 8, .mOverflowPolicy = Policy::CoalesceByName},
+    };
+    std::vector<std::jthread> producers;
+    for (int i = 0; i < 4; ++i) {
+      producers.emplace_back([&sender]() {
+        for (int i = 0; i < 5000; ++i) {
+          sender.Enqueue({std::format("n{}", i % 300), std::to_string(i)});
+        }
+      });
+    }
+    // Unblock part-way through, so the overflow is drained while in use
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    gate.unlock();
+    producers.clear();
+    check(sender.Flush(std::chrono::seconds(5)), "flush after coalescing");
+    const auto stats = sender.GetStats();
+    const auto events = written->GetEvents();
+    const auto count = std::ranges::count(events, ' ');
+    check(
+      stats.mEnqueued == 20000
+        && stats.mDropped + stats.mCoalesced + count == 20000,
+      "coalescing with several producers accounts for every event");
+  }
+
+  {
+    auto written = std::make_shared<Written>();
+    std::unique_lock gate(written->mGate);
+    GameEventSender sender {
+      CreateTransport(written),
+      {.mQueueCapacity = 8, .mOverflowPolicy = Policy::DropOldest},
+    };
+    std::vector<std::jthread> producers;
+    for (int i = 0; i < 4; ++i) {
+      producers.emplace_back([&sender]() {
+        for (int i = 0; i < 1000; ++i) {
+          sender.Enqueue({"x", std::to_string(i)});
+        }
+      });
+    }
+    producers.clear();
+    gate.unlock();
+    check(sender.Flush(std::chrono::seconds(5)), "flush after dropping");
+    const auto stats = sender.GetStats();
+    check(
+      stats.mEnqueued == 4000 && stats.mDropped > 0 && stats.mDropped < 4000,
+      "oldest events dropped when full, with several producers");
+  }
+
+  {
+    auto written = std::make_shared<Written>();
+    {
+      GameEventSender sender {CreateTransport(written), {}};
+      sender.Enqueue({"before", "1"});
+      sender.Shutdown();
+      check(
+        written->GetEvents() == "before=1 ",
+        "shutdown writes what's queued");
+      sender.Enqueue({"after", "2"});
+      check(
+        written->GetEvents() == "before=1 "
+          && sender.GetStats().mDropped == 1,
+        "events after shutdown are dropped, not written by the caller");
+      check(sender.Flush(std::chrono::seconds(0)), "flush after shutdown");
+      // Must not block or write again
+      sender.Shutdown();
+    }
+    check(
+      written->GetEvents() == "before=1 ",
+      "destroying a shut down sender writes nothing");
+  }
+
+  {
+    auto written = std::make_shared<Written>();
+    uint64_t abandoned {};
+    std::unique_lock gate(written->mGate);
+    {
+      GameEventSender sender {
+        CreateTransport(written),
+        {
+          .mShutdownTimeout = std::chrono::milliseconds(50),
+          .mEventsAbandoned = [&abandoned](auto count) { abandoned = count; },
+        },
+      };
+      for (int i = 0; i < 10; ++i) {
+        sender.Enqueue({"n", std::to_string(i)});
+      }
+      // Destroyed while the transport is blocked
+    }
+    // Let the detached thread finish
+    gate.unlock();
+    check(abandoned > 0, "destructor reports events it gave up on");
+  }
+
+  {
+    auto written = std::make_shared<Written>();
+    {
+      std::unique_lock gate(written->mGate);
+      GameEventSender sender {CreateTransport(written), {}};
+      for (int i = 0; i < 100; ++i) {
+        sender.Enqueue({"n", std::to_string(i)});
+      }
+      gate.unlock();
+    }
+    check(
+      written->GetEvents().size() == std::string_view {"n=0 "}.size() * 10
+        + std::string_view {"n=10 "}.size() * 90,
+      "destructor writes what's queued");
+  }
+
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t eventCount) {
+  auto written = std::make_shared<Written>();
+  // Roughly a mailslot write
+  written->mWriteCost = std::chrono::microseconds(20);
+
+  const auto syncStart = Clock::now();
+  {
+    TestTransport transport {written};
+    for (size_t i = 0; i < eventCount; ++i) {
+      transport.Write(GameEvent {"n", std::to_string(i)}.Serialize());
+    }
+  }
+  const auto syncMS = MillisecondsSince(syncStart);
+  written->mPackets.clear();
+
+  double enqueueMS {};
+  double totalMS {};
+  {
+    const auto start = Clock::now();
+    GameEventSender sender {CreateTransport(written), {}};
+    for (size_t i = 0; i < eventCount; ++i) {
+      sender.Enqueue({"n", std::to_string(i)});
+    }
+    enqueueMS = MillisecondsSince(start);
+    sender.Flush(std::chrono::minutes(1));
+    totalMS = MillisecondsSince(start);
+  }
+
+  std::cout << std::format(
+    "{} events, {}us per write\n"
+    "synchronous: {:.1f}ms in the caller\n"
+    "sender:      {:.1f}ms in the caller, {:.1f}ms until written, "
+    "{} packets\n",
+    eventCount,
+    written->mWriteCost.count(),
+    syncMS,
+    enqueueMS,
+    totalMS,
+    written->mPackets.size());
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[EVENTS]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 10000 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
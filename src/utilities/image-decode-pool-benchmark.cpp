@@ -0,0 +1,504 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `JPEGImageDecoder`, including scaled decoding, and the scheduling in
+// `ImageDecodePool` - priorities, cancellation, and the thread limit - and
+// measures decode throughput, how long it takes for the current page to
+// appear while neighbouring pages are also queued, and the cost of decoding
+// large images for the kneeboard. Only depends on the standard library
+// and libjpeg-turbo, so it can also be built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/ImageDecodePool.h>
+#include <OpenKneeboard/ImageResampler.h>
+#include <OpenKneeboard/JPEGImageDecoder.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <jpeglib.h>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+std::filesystem::path GetScratchPath(std::string_view name) {
+  return std::filesystem::temp_directory_path()
+    / std::format("image-decode-pool-benchmark-{}.jpg", name);
+}
+
+// A smooth gradient, so that it survives compression nearly unchanged
+uint8_t ExpectedChannel(uint32_t x, uint32_t y, int channel) {
+  switch (channel) {
+    case 0:// R
+      return static_cast<uint8_t>((x * 255) / 1024);
+    case 1:// G
+      return static_cast<uint8_t>((y * 255) / 1024);
+    default:// B
+      return 128;
+  }
+}
+
+void WriteJPEG(
+  const std::filesystem::path& path,
+  uint32_t width,
+  uint32_t height,
+  int quality = 95) {
+  jpeg_compress_struct info {};
+  jpeg_error_mgr errors {};
+  info.err = jpeg_std_error(&errors);
+  jpeg_create_compress(&info);
+
+  unsigned char* buffer = nullptr;
+  unsigned long size = 0;
+  jpeg_mem_dest(&info, &buffer, &size);
+  info.image_width = width;
+  info.image_height = height;
+  info.input_components = 3;
+  info.in_color_space = JCS_RGB;
+  jpeg_set_defaults(&info);
+  jpeg_set_quality(&info, quality, TRUE);
+  jpeg_start_compress(&info, TRUE);
+
+  std::vector<JSAMPLE> row(width * 3);
+  while (info.next_scanline < height) {
+    for (uint32_t x = 0; x < width; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        row[(x * 3) + c] = ExpectedChannel(x, info.next_scanline, c);
+      }
+    }
+    auto rowPointer = row.data();
+    jpeg_write_scanlines(&info, &rowPointer, 1);
+  }
+  jpeg_finish_compress(&info);
+
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  f.write(reinterpret_cast<const char*>(buffer), size);
+  f.close();
+  std::free(buffer);
+  jpeg_destroy_compress(&info);
+}
+
+void WriteBytes(const std::filesystem::path& path, std::string_view bytes) {
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+/** Doesn't read files; used to control timing in scheduling tests.
+ *
+ * The path is the result; decodes block until `Release()` is called, or the
+ * decode is cancelled.
+ */
+class FakeDecoder final : public ImageDecoder {
+ public:
+  std::optional<ImageSize> ReadSize(const std::filesystem::path&) override {
+    return ImageSize {1, 1};
+  }
+
+  std::optional<DecodedImage> Decode(
+    const std::filesystem::path& path,
+    const ImageSize&,
+    std::stop_token stopToken) override {
+    {
+      std::unique_lock lock(mMutex);
+      mStarted.push_back(path.string());
+      mMaxConcurrent = std::max(++mConcurrent, mMaxConcurrent);
+    }
+    mChanged.notify_all();
+    {
+      std::unique_lock lock(mMutex);
+      mChanged.wait(lock, stopToken, [this] { return mReleased; });
+      --mConcurrent;
+    }
+    mChanged.notify_all();
+    if (stopToken.stop_requested()) {
+      return std::nullopt;
+    }
+    return DecodedImage {{1, 1}, {1, 1}, std::vector<std::byte>(4)};
+  }
+
+  void Release() {
+    {
+      std::unique_lock lock(mMutex);
+      mReleased = true;
+    }
+    mChanged.notify_all();
+  }
+
+  void WaitForStarted(size_t count) {
+    std::unique_lock lock(mMutex);
+    mChanged.wait(lock, [=, this] { return mStarted.size() >= count; });
+  }
+
+  std::vector<std::string> GetStarted() {
+    std::unique_lock lock(mMutex);
+    return mStarted;
+  }
+
+  size_t GetMaxConcurrent() {
+    std::unique_lock lock(mMutex);
+    return mMaxConcurrent;
+  }
+
+ private:
+  std::mutex mMutex;
+  std::condition_variable_any mChanged;
+  bool mReleased {false};
+  std::vector<std::string> mStarted;
+  size_t mConcurrent {0};
+  size_t mMaxConcurrent {0};
+};
+
+/// Records the order that callbacks are called in
+struct Completions {
+  std::mutex mMutex;
+  std::vector<ImageDecodePool::Key> mKeys;
+
+  ImageDecodePool::Callback Add(ImageDecodePool::Key key) {
+    return [this, key](auto) {
+      std::unique_lock lock(mMutex);
+      mKeys.push_back(key);
+    };
+  }
+};
+
+bool MatchesGradient(const DecodedImage& image) {
+  if (image.mPixels.size() != image.GetStride() * image.mSize.mHeight) {
+    return false;
+  }
+  const auto scaleX = double(image.mNativeSize.mWidth) / image.mSize.mWidth;
+  const auto scaleY = double(image.mNativeSize.mHeight) / image.mSize.mHeight;
+  // The edges are extended, so aren't the average of a linear gradient
+  for (uint32_t y = 2; y + 2 < image.mSize.mHeight; y += 3) {
+    for (uint32_t x = 2; x + 2 < image.mSize.mWidth; x += 5) {
+      const auto pixel = &image.mPixels.at((y * image.GetStride()) + (x * 4));
+      const auto sourceX = static_cast<uint32_t>(((x + 0.5) * scaleX) - 0.5);
+      const auto sourceY = static_cast<uint32_t>(((y + 0.5) * scaleY) - 0.5);
+      // BGRA
+      for (int c = 0; c < 3; ++c) {
+        const auto actual = std::to_integer<int>(pixel[2 - c]);
+        if (std::abs(actual - ExpectedChannel(sourceX, sourceY, c)) > 4) {
+          return false;
+        }
+      }
+      if (std::to_integer<int>(pixel[3]) != 0xff) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int Verify() {
+  Checks check;
+
+  JPEGImageDecoder jpeg;
+  const auto path = GetScratchPath("verify");
+  {
+    WriteJPEG(path, 1000, 700);
+    check(jpeg.ReadSize(path) == ImageSize {1000, 700}, "JPEG size");
+    const auto image = jpeg.Decode(path, UnboundedImageSize, {});
+    check(
+      image && image->mSize == ImageSize {1000, 700}
+        && image->mNativeSize == image->mSize && MatchesGradient(*image),
+      "JPEG pixels");
+
+    // Exact DCT scaling, DCT scaling then resampling, and no scaling
+    for (const auto& [maxSize, expected]: {
+           std::pair {ImageSize {500, 10000}, ImageSize {500, 350}},
+           std::pair {ImageSize {250, 250}, ImageSize {250, 175}},
+           std::pair {ImageSize {333, 333}, ImageSize {333, 233}},
+           std::pair {ImageSize {2000, 2000}, ImageSize {1000, 700}},
+         }) {
+      const auto scaled = jpeg.Decode(path, maxSize, {});
+      check(
+        scaled && scaled->mSize == expected
+          && scaled->mNativeSize == ImageSize {1000, 700}
+          && MatchesGradient(*scaled),
+        std::format(
+          "JPEG scaled to fit {}x{}", maxSize.mWidth, maxSize.mHeight));
+    }
+  }
+
+  {
+    std::stop_source stop;
+    stop.request_stop();
+    check(
+      !jpeg.Decode(path, UnboundedImageSize, stop.get_token()),
+      "JPEG cancellation");
+  }
+
+  {
+    std::ifstream f(path, std::ios::binary);
+    std::string bytes {std::istreambuf_iterator<char>(f), {}};
+    f.close();
+    WriteBytes(path, bytes.substr(0, bytes.size() / 2));
+    const auto image = jpeg.Decode(path, UnboundedImageSize, {});
+    check(
+      image && image->mSize == ImageSize {1000, 700},
+      "truncated JPEG decodes what's there");
+    WriteBytes(path, bytes.substr(0, 200));
+    check(
+      !jpeg.Decode(path, UnboundedImageSize, {}),
+      "JPEG truncated in header fails");
+    WriteBytes(path, "this is not a JPEG");
+    check(
+      !jpeg.ReadSize(path) && !jpeg.Decode(path, UnboundedImageSize, {}),
+      "invalid JPEG fails");
+  }
+  std::filesystem::remove(path);
+  check(!jpeg.Decode(path, UnboundedImageSize, {}), "missing file fails");
+
+  {
+    auto decoder = std::make_shared<FakeDecoder>();
+    Completions done;
+    ImageDecodePool pool {decoder, 1};
+    // Keep the only thread busy while we queue everything else
+    pool.Request(0, "0", {1, 1}, 0, done.Add(0));
+    decoder->WaitForStarted(1);
+    pool.Request(1, "1", {1, 1}, 2, done.Add(1));
+    pool.Request(2, "2", {1, 1}, 1, done.Add(2));
+    pool.Request(3, "3", {1, 1}, 2, done.Add(3));
+    pool.Request(4, "4", {1, 1}, 0, done.Add(4));
+    pool.Request(5, "5", {1, 1}, 5, done.Add(5));
+    // Re-prioritized, not queued again
+    pool.Request(5, "5", {1, 1}, -1, done.Add(5));
+    check(pool.Cancel(3), "cancel queued request");
+    check(!pool.Cancel(3), "cancel is idempotent");
+    decoder->Release();
+    pool.WaitForIdle();
+    check(
+      done.mKeys == std::vector<ImageDecodePool::Key> {0, 5, 4, 2, 1},
+      "priority order");
+    const auto stats = pool.GetStats();
+    check(
+      stats.mRequested == 6 && stats.mDecoded == 5
+        && stats.mCancelledQueued == 1,
+      "stats");
+  }
+
+  {
+    auto decoder = std::make_shared<FakeDecoder>();
+    Completions done;
+    ImageDecodePool pool {decoder, 2};
+    pool.Request(1, "1", {1, 1}, 0, done.Add(1));
+    decoder->WaitForStarted(1);
+    check(pool.Cancel(1), "cancel running request");
+    // The cancelled decode might not have stopped yet, but this must still
+    // be decoded again
+    pool.Request(1, "1", {1, 1}, 0, done.Add(1));
+    decoder->WaitForStarted(2);
+    decoder->Release();
+    pool.WaitForIdle();
+    check(
+      done.mKeys == std::vector<ImageDecodePool::Key> {1}
+        && pool.GetStats().mCancelledRunning == 1,
+      "re-request after cancelling running request");
+  }
+
+  {
+    auto decoder = std::make_shared<FakeDecoder>();
+    Completions done;
+    ImageDecodePool pool {decoder, 3};
+    for (ImageDecodePool::Key i = 0; i < 20; ++i) {
+      pool.Request(i, std::to_string(i), {1, 1}, 0, done.Add(i));
+    }
+    decoder->WaitForStarted(3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto startedWhileBlocked = decoder->GetStarted().size();
+    check(
+      pool.CancelIf([](auto key) { return key % 2 == 1; }) == 10,
+      "CancelIf");
+    decoder->Release();
+    pool.WaitForIdle();
+    std::ranges::sort(done.mKeys);
+    bool ok = (done.mKeys.size() == 10);
+    for (size_t i = 0; ok && i < done.mKeys.size(); ++i) {
+      ok = (done.mKeys.at(i) == i * 2);
+    }
+    check(ok, "no callbacks for cancelled requests");
+    check(
+      startedWhileBlocked == 3 && decoder->GetMaxConcurrent() == 3,
+      "thread limit");
+  }
+
+  {
+    auto decoder = std::make_shared<FakeDecoder>();
+    std::atomic<size_t> calls {0};
+    {
+      ImageDecodePool pool {decoder, 2};
+      for (ImageDecodePool::Key i = 0; i < 10; ++i) {
+        pool.Request(
+          i, std::to_string(i), {1, 1}, 0, [&calls](auto) { ++calls; });
+      }
+      decoder->WaitForStarted(2);
+    }
+    check(calls == 0, "destroying pool cancels requests");
+  }
+
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t pageCount) {
+  constexpr uint32_t Width = 2480;
+  constexpr uint32_t Height = 3508;// A4 at 300 DPI
+
+  std::vector<std::filesystem::path> paths;
+  size_t bytes = 0;
+  for (size_t i = 0; i < pageCount; ++i) {
+    const auto& path
+      = paths.emplace_back(GetScratchPath(std::format("page-{}", i)));
+    WriteJPEG(path, Width, Height, 90);
+    bytes += std::filesystem::file_size(path);
+  }
+  std::cout << std::format(
+    "{} pages of {}x{}, {:.1f} MiB total\n\n",
+    pageCount,
+    Width,
+    Height,
+    bytes / (1024.0 * 1024.0));
+
+  auto decoder = std::make_shared<JPEGImageDecoder>();
+  {
+    const auto start = Clock::now();
+    for (const auto& path: paths) {
+      decoder->ReadSize(path);
+    }
+    std::cout << std::format(
+      "ReadSize(): {:.3f}ms per page\n",
+      MillisecondsSince(start) / pageCount);
+  }
+
+  std::cout << "\nthreads   total (ms)   pages/s   current page (ms)\n";
+  const auto hardwareThreads
+    = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  for (size_t threads = 1; threads <= std::min<size_t>(hardwareThreads, 8);
+       threads *= 2) {
+    ImageDecodePool pool {decoder, threads};
+    std::atomic<double> currentPage {0};
+    const auto current = pageCount / 2;
+    const auto start = Clock::now();
+    // Simulates opening a folder at page `current`, with everything else
+    // already queued in page order: the current page should still be first
+    for (size_t i = 0; i < pageCount; ++i) {
+      const auto distance = (i > current) ? i - current : current - i;
+      pool.Request(
+        i,
+        paths.at(i),
+        UnboundedImageSize,
+        static_cast<int>(distance),
+        [&currentPage, i, current, start](auto image) {
+          if (i == current && image) {
+            currentPage = MillisecondsSince(start);
+          }
+        });
+    }
+    pool.WaitForIdle();
+    const auto total = MillisecondsSince(start);
+    std::cout << std::format(
+      "{:>7}   {:>10.1f}   {:>7.2f}   {:>17.1f}\n",
+      threads,
+      total,
+      pageCount / (total / 1000),
+      currentPage.load());
+  }
+
+  {
+    // What the previous synchronous decode did, in page order
+    const auto start = Clock::now();
+    for (size_t i = 0; i <= pageCount / 2; ++i) {
+      decoder->Decode(paths.at(i), UnboundedImageSize, {});
+    }
+    std::cout << std::format(
+      "\nSynchronous, current page after: {:.1f}ms\n",
+      MillisecondsSince(start));
+  }
+
+  for (const auto& path: paths) {
+    std::filesystem::remove(path);
+  }
+
+  {
+    // A 24 megapixel photo or scan, shown on the kneeboard texture
+    constexpr ImageSize KneeboardSize {2048, 2048};
+    const auto path = GetScratchPath("large");
+    WriteJPEG(path, 6000, 4000, 90);
+    std::cout << "\n6000x4000 for 2048x2048:\n";
+
+    const auto measure = [](std::string_view label, auto&& decode) {
+      constexpr size_t Iterations = 3;
+      size_t bytes = 0;
+      const auto start = Clock::now();
+      for (size_t i = 0; i < Iterations; ++i) {
+        bytes = decode().mPixels.size();
+      }
+      std::cout << std::format(
+        "  {:<32} {:>8.1f}ms {:>8.1f} MiB\n",
+        label,
+        MillisecondsSince(start) / Iterations,
+        bytes / (1024.0 * 1024.0));
+    };
+    measure("full size", [&] {
+      return *decoder->Decode(path, UnboundedImageSize, {});
+    });
+    measure("full size, then resampled", [&] {
+      const auto image = *decoder->Decode(path, UnboundedImageSize, {});
+      return ResampleImage(image, ScaleToFit(image.mSize, KneeboardSize));
+    });
+    measure("DCT scaled, then resampled", [&] {
+      return *decoder->Decode(path, KneeboardSize, {});
+    });
+    std::filesystem::remove(path);
+  }
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[PAGES]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 16 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
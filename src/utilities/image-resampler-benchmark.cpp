@@ -0,0 +1,349 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `ResampleImage()` against a floating-point reference, and for
+// aliasing, flat areas, and valid premultiplied output; also measures
+// throughput for typical scans and photos. Only depends on the standard
+// library, so it can also be built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/ImageResampler.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+DecodedImage MakeImage(ImageSize size, auto&& pixel) {
+  DecodedImage image {.mSize = size, .mNativeSize = size};
+  image.mPixels.resize(image.GetStride() * size.mHeight);
+  for (uint32_t y = 0; y < size.mHeight; ++y) {
+    for (uint32_t x = 0; x < size.mWidth; ++x) {
+      const std::array<uint8_t, 4> bgra = pixel(x, y);
+      auto out = &image.mPixels[(y * image.GetStride()) + (x * 4)];
+      for (size_t c = 0; c < 4; ++c) {
+        out[c] = std::byte {bgra[c]};
+      }
+    }
+  }
+  return image;
+}
+
+uint8_t Channel(const DecodedImage& image, uint32_t x, uint32_t y, int c) {
+  return std::to_integer<uint8_t>(
+    image.mPixels[(y * image.GetStride()) + (x * 4) + c]);
+}
+
+/// Random premultiplied pixels, with some smooth areas and hard edges
+DecodedImage MakeRandomImage(std::mt19937_64& rng, ImageSize size) {
+  const auto style = rng() % 3;
+  const auto seed = rng();
+  return MakeImage(size, [=](uint32_t x, uint32_t y) {
+    std::mt19937_64 pixelRNG {seed ^ (uint64_t {x} << 32) ^ y};
+    uint8_t alpha = 255;
+    if (style == 1) {
+      alpha = ((x / 3) + (y / 5)) % 2 ? 255 : 0;
+    } else if (style == 2) {
+      alpha = static_cast<uint8_t>(pixelRNG());
+    }
+    std::array<uint8_t, 4> ret {};
+    for (int c = 0; c < 3; ++c) {
+      const auto value = (style == 0)
+        ? static_cast<uint8_t>(((x * (c + 1) * 7) + (y * 3)) % 256)
+        : static_cast<uint8_t>(pixelRNG());
+      ret[c] = static_cast<uint8_t>((value * alpha) / 255);
+    }
+    ret[3] = alpha;
+    return ret;
+  });
+}
+
+double ReferenceKernel(double x) {
+  x = std::abs(x);
+  if (x < 1) {
+    return ((1.5 * x - 2.5) * x * x) + 1;
+  }
+  if (x < 2) {
+    return (((-0.5 * x + 2.5) * x - 4) * x) + 2;
+  }
+  return 0;
+}
+
+/// Normalized weights for every source pixel, for one destination pixel
+std::vector<double> ReferenceWeights(uint32_t in, uint32_t out, uint32_t i) {
+  const auto scale = double(in) / out;
+  const auto filterScale = std::max(scale, 1.0);
+  const auto center = ((i + 0.5) * scale) - 0.5;
+  std::vector<double> weights(in);
+  double total = 0;
+  for (uint32_t j = 0; j < in; ++j) {
+    weights[j] = ReferenceKernel((j - center) / filterScale);
+    total += weights[j];
+  }
+  for (auto& weight: weights) {
+    weight /= total;
+  }
+  return weights;
+}
+
+/// Straightforward, slow, floating-point, with no intermediate rounding
+DecodedImage ReferenceResample(const DecodedImage& source, ImageSize size) {
+  std::vector<std::vector<double>> columns, rows;
+  for (uint32_t x = 0; x < size.mWidth; ++x) {
+    columns.push_back(ReferenceWeights(source.mSize.mWidth, size.mWidth, x));
+  }
+  for (uint32_t y = 0; y < size.mHeight; ++y) {
+    rows.push_back(ReferenceWeights(source.mSize.mHeight, size.mHeight, y));
+  }
+  return MakeImage(size, [&](uint32_t x, uint32_t y) {
+    std::array<double, 4> sum {};
+    for (uint32_t sy = 0; sy < source.mSize.mHeight; ++sy) {
+      if (rows[y][sy] == 0) {
+        continue;
+      }
+      for (uint32_t sx = 0; sx < source.mSize.mWidth; ++sx) {
+        const auto weight = rows[y][sy] * columns[x][sx];
+        for (int c = 0; c < 4; ++c) {
+          sum[c] += weight * Channel(source, sx, sy, c);
+        }
+      }
+    }
+    std::array<uint8_t, 4> ret {};
+    for (int c = 0; c < 4; ++c) {
+      ret[c] = static_cast<uint8_t>(std::clamp(std::round(sum[c]), 0.0, 255.0));
+    }
+    for (int c = 0; c < 3; ++c) {
+      ret[c] = std::min(ret[c], ret[3]);
+    }
+    return ret;
+  });
+}
+
+int MaxDifference(const DecodedImage& a, const DecodedImage& b) {
+  if (a.mSize != b.mSize) {
+    return 256;
+  }
+  int ret = 0;
+  for (size_t i = 0; i < a.mPixels.size(); ++i) {
+    ret = std::max(
+      ret,
+      std::abs(
+        std::to_integer<int>(a.mPixels[i])
+        - std::to_integer<int>(b.mPixels[i])));
+  }
+  return ret;
+}
+
+int Verify() {
+  Checks check;
+  std::mt19937_64 rng {1};
+
+  {
+    int worst = 0;
+    for (size_t i = 0; i < 200; ++i) {
+      const ImageSize from {
+        1 + static_cast<uint32_t>(rng() % 60),
+        1 + static_cast<uint32_t>(rng() % 60),
+      };
+      const ImageSize to {
+        1 + static_cast<uint32_t>(rng() % 60),
+        1 + static_cast<uint32_t>(rng() % 60),
+      };
+      const auto source = MakeRandomImage(rng, from);
+      worst = std::max(
+        worst,
+        MaxDifference(
+          ResampleImage(source, to), ReferenceResample(source, to)));
+    }
+    std::cout << std::format("Largest difference from reference: {}\n", worst);
+    // Weights are 14-bit fixed point, and the intermediate image is rounded
+    // to 8 bits
+    check(worst <= 3, "matches floating-point reference");
+  }
+
+  {
+    const auto source = MakeRandomImage(rng, {97, 31});
+    check(
+      MaxDifference(ResampleImage(source, source.mSize), source) == 0,
+      "same size is unchanged");
+  }
+
+  {
+    bool ok = true;
+    for (size_t i = 0; ok && i < 100; ++i) {
+      const std::array color {
+        static_cast<uint8_t>(rng()),
+        static_cast<uint8_t>(rng()),
+        static_cast<uint8_t>(rng()),
+        uint8_t {255},
+      };
+      const ImageSize from {
+        1 + static_cast<uint32_t>(rng() % 300),
+        1 + static_cast<uint32_t>(rng() % 300),
+      };
+      const ImageSize to {
+        1 + static_cast<uint32_t>(rng() % 300),
+        1 + static_cast<uint32_t>(rng() % 300),
+      };
+      const auto flat = MakeImage(from, [&](auto, auto) { return color; });
+      const auto resized = ResampleImage(flat, to);
+      ok = (MaxDifference(resized, MakeImage(to, [&](auto, auto) {
+              return color;
+            })) == 0);
+    }
+    check(ok, "flat areas stay exactly flat");
+  }
+
+  {
+    // A 1-pixel checkerboard is the worst case for aliasing: point sampling
+    // gives solid black or white, but it should average to grey.
+    const auto checkerboard = MakeImage({1024, 1024}, [](auto x, auto y) {
+      const uint8_t v = ((x + y) % 2) ? 255 : 0;
+      return std::array<uint8_t, 4> {v, v, v, 255};
+    });
+    bool ok = true;
+    for (const uint32_t size: {512u, 300u, 256u, 100u, 37u}) {
+      const auto resized = ResampleImage(checkerboard, {size, size});
+      for (uint32_t y = 0; ok && y < size; ++y) {
+        for (uint32_t x = 0; ok && x < size; ++x) {
+          ok = std::abs(Channel(resized, x, y, 1) - 127.5) <= 16;
+        }
+      }
+    }
+    check(ok, "no aliasing when downscaling");
+  }
+
+  {
+    bool ok = true;
+    for (size_t i = 0; ok && i < 50; ++i) {
+      const ImageSize from {
+        1 + static_cast<uint32_t>(rng() % 200),
+        1 + static_cast<uint32_t>(rng() % 200),
+      };
+      const ImageSize to {
+        1 + static_cast<uint32_t>(rng() % 200),
+        1 + static_cast<uint32_t>(rng() % 200),
+      };
+      const auto resized = ResampleImage(MakeRandomImage(rng, from), to);
+      ok = resized.mSize == to
+        && resized.mPixels.size() == resized.GetStride() * to.mHeight;
+      for (uint32_t y = 0; ok && y < to.mHeight; ++y) {
+        for (uint32_t x = 0; ok && x < to.mWidth; ++x) {
+          const auto alpha = Channel(resized, x, y, 3);
+          ok = Channel(resized, x, y, 0) <= alpha
+            && Channel(resized, x, y, 1) <= alpha
+            && Channel(resized, x, y, 2) <= alpha;
+        }
+      }
+    }
+    check(ok, "output is valid premultiplied BGRA");
+  }
+
+  {
+    const DecodedImage source {
+      .mSize = {4000, 3000},
+      .mNativeSize = {8000, 6000},
+      .mPixels = std::vector<std::byte>(4000 * 3000 * 4),
+    };
+    check(
+      ResampleImage(source, {1000, 750}).mNativeSize == source.mNativeSize,
+      "native size is preserved");
+  }
+
+  check(
+    ScaleToFit({6000, 4000}, {2048, 2048}) == ImageSize {2048, 1365}
+      && ScaleToFit({2480, 3508}, {2048, 2048}) == ImageSize {1447, 2048}
+      && ScaleToFit({100, 50}, {2048, 2048}) == ImageSize {100, 50}
+      && ScaleToFit({100000, 1}, {2048, 2048}) == ImageSize {2048, 1}
+      && ScaleToFit({1000, 1000}, UnboundedImageSize)
+        == ImageSize {1000, 1000},
+    "ScaleToFit()");
+
+  return check.GetExitCode();
+}
+
+int Benchmark() {
+  struct Case {
+    std::string_view mName;
+    ImageSize mFrom;
+    ImageSize mTo;
+  };
+  constexpr ImageSize Kneeboard {2048, 2048};
+  constexpr ImageSize Photo {6000, 4000};
+  constexpr ImageSize A4At600DPI {4960, 7016};
+  constexpr ImageSize A4At300DPI {2480, 3508};
+  const Case cases[] {
+    {"24MP photo -> kneeboard", Photo, ScaleToFit(Photo, Kneeboard)},
+    {"A4 at 600 DPI -> kneeboard",
+     A4At600DPI,
+     ScaleToFit(A4At600DPI, Kneeboard)},
+    {"A4 at 300 DPI -> kneeboard",
+     A4At300DPI,
+     ScaleToFit(A4At300DPI, Kneeboard)},
+    // What's left after JPEG's DCT scaling
+    {"3/8 DCT-scaled photo -> kneeboard", {2250, 1500}, {2048, 1365}},
+    {"1024x1024 -> 2048x2048 (upscale)", {1024, 1024}, {2048, 2048}},
+  };
+
+  std::mt19937_64 rng {1};
+  std::cout << std::format(
+    "{:<36} {:>10} {:>10} {:>12}\n", "", "ms", "MP/s in", "MP/s out");
+  for (const auto& [name, from, to]: cases) {
+    const auto source = MakeRandomImage(rng, from);
+    constexpr size_t Iterations = 3;
+    const auto start = Clock::now();
+    for (size_t i = 0; i < Iterations; ++i) {
+      ResampleImage(source, to);
+    }
+    const auto ms = MillisecondsSince(start) / Iterations;
+    const auto inMP = (double(from.mWidth) * from.mHeight) / 1e6;
+    const auto outMP = (double(to.mWidth) * to.mHeight) / 1e6;
+    std::cout << std::format(
+      "{:<36} {:>10.1f} {:>10.1f} {:>12.1f}\n",
+      name,
+      ms,
+      inMP / (ms / 1000),
+      outMP / (ms / 1000));
+  }
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {.mName = "bench", .mRun = [](auto) { return Benchmark(); }},
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
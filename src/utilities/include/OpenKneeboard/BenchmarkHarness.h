@@ -0,0 +1,80 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+
+/** Shared scaffolding for the `*-benchmark` utilities.
+ *
+ * Each utility has a `verify` command, which is registered with CTest, and
+ * usually a `bench` command; this only depends on the standard library, so
+ * the utilities can also be built and profiled outside of Windows.
+ */
+namespace OpenKneeboard::BenchmarkHarness {
+
+using Clock = std::chrono::steady_clock;
+
+double MillisecondsSince(Clock::time_point start);
+/// Peak working set/resident set size of this process
+uint64_t GetPeakMemoryBytes();
+
+/** Prints and counts results in `verify` commands.
+ *
+ * Use like a function: `check(ok, "what")`.
+ */
+class Checks final {
+ public:
+  /// Prints the result, and returns `ok`
+  bool operator()(bool ok, std::string_view what);
+  /// Records a failure that has already been described
+  void Fail(std::string_view what);
+
+  size_t GetFailureCount() const noexcept;
+  /// Prints a summary, and returns 0 if everything passed
+  int GetExitCode() const;
+
+ private:
+  size_t mChecks {0};
+  size_t mFailures {0};
+};
+
+struct Command {
+  std::string_view mName;
+  // Shown in the usage message, e.g. "[PAGES]"
+  std::string_view mUsage {};
+  size_t mMinArguments {0};
+  size_t mMaxArguments {0};
+  std::function<int(std::span<char* const> arguments)> mRun;
+};
+
+/** Runs the command named by `argv[1]` with the remaining arguments.
+ *
+ * Shows usage and returns 1 if there is no such command, or the number of
+ * arguments is wrong; exceptions are reported as failures.
+ */
+int Run(int argc, char** argv, std::initializer_list<Command> commands);
+
+}// namespace OpenKneeboard::BenchmarkHarness
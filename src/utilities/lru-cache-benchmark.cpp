@@ -0,0 +1,397 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `LRUCache`'s eviction order, cost budget and stats, and that
+// `CoalescingCache` creates each value once, even with concurrent requests;
+// also measures hit rates on synthetic page navigation traces for different
+// cache sizes, and lookup cost with and without contention. Only depends on
+// the standard library, so it can also be built and profiled outside of
+// Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/CoalescingCache.h>
+#include <OpenKneeboard/LRUCache.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+struct Trace {
+  std::string_view mName;
+  // Page indices, in the order they're shown
+  std::vector<uint32_t> mPages {};
+};
+
+std::vector<Trace> MakeTraces(size_t length) {
+  constexpr uint32_t pageCount = 200;
+  std::mt19937 rng {36};
+  std::vector<Trace> traces;
+
+  {
+    Trace trace {"flipping between two pages"};
+    for (size_t i = 0; i < length; ++i) {
+      trace.mPages.push_back((i % 2) ? 17 : 42);
+    }
+    traces.push_back(std::move(trace));
+  }
+
+  {
+    // Reading forwards, sometimes glancing back a page or two
+    Trace trace {"reading with lookback"};
+    uint32_t page = 0;
+    while (trace.mPages.size() < length) {
+      if (rng() % 5 == 0 && page > 2) {
+        trace.mPages.push_back(page - (1 + (rng() % 2)));
+        trace.mPages.push_back(page);
+      }
+      page = (page + ((rng() % 3) == 0)) % pageCount;
+      trace.mPages.push_back(page);
+    }
+    traces.push_back(std::move(trace));
+  }
+
+  {
+    // Mostly jumping between a few bookmarked checklist pages
+    Trace trace {"bookmarked checklist pages"};
+    constexpr uint32_t bookmarks[] {3, 10, 55, 120, 180};
+    for (size_t i = 0; i < length; ++i) {
+      trace.mPages.push_back(
+        (rng() % 4) ? bookmarks[rng() % std::size(bookmarks)]
+                    : (rng() % pageCount));
+    }
+    traces.push_back(std::move(trace));
+  }
+
+  return traces;
+}
+
+double GetHitRate(const Trace& trace, size_t capacity) {
+  LRUCache<uint32_t, uint32_t> cache {capacity};
+  for (const auto page: trace.mPages) {
+    if (!cache.Get(page)) {
+      cache.Insert(page, page, 1);
+    }
+  }
+  return cache.GetStats().GetHitRate();
+}
+
+void VerifyCoalescing(Checks& check) {
+  using namespace std::chrono_literals;
+  using Cache = CoalescingCache<int, std::shared_ptr<const int>>;
+  using Created = std::pair<std::shared_ptr<const int>, size_t>;
+
+  {
+    Cache cache {100};
+    std::atomic<int> created {0};
+    std::atomic<int> wrong {0};
+    std::latch start {8};
+    std::vector<std::jthread> threads;
+    for (int i = 0; i < 8; ++i) {
+      threads.emplace_back([&]() {
+        start.arrive_and_wait();
+        const auto value = cache.GetOrCreate(1, [&]() {
+          ++created;
+          std::this_thread::sleep_for(50ms);
+          return Created {std::make_shared<const int>(42), 1};
+        });
+        if (*value != 42) {
+          ++wrong;
+        }
+      });
+    }
+    threads.clear();
+    const auto stats = cache.GetStats();
+    check(
+      created == 1 && wrong == 0
+        && stats.mCoalesced + stats.mCache.mHits == 7,
+      std::format(
+        "concurrent requests create once ({} created, {} coalesced)",
+        created.load(),
+        stats.mCoalesced));
+  }
+
+  {
+    Cache cache {100};
+    std::latch started {1};
+    bool creatorSawException = false;
+    bool waiterSawException = false;
+    std::jthread waiter;
+    try {
+      cache.GetOrCreate(1, [&]() -> Created {
+        waiter = std::jthread([&]() {
+          started.count_down();
+          try {
+            cache.GetOrCreate(1, []() -> Created {
+              throw std::logic_error("the waiter shouldn't create a value");
+            });
+          } catch (const std::runtime_error&) {
+            waiterSawException = true;
+          }
+        });
+        started.wait();
+        // Give the waiter a chance to start waiting for this
+        std::this_thread::sleep_for(50ms);
+        throw std::runtime_error("test");
+      });
+    } catch (const std::runtime_error&) {
+      creatorSawException = true;
+    }
+    waiter = {};
+    check(
+      creatorSawException && waiterSawException
+        && cache.GetStats().mCache.mEntryCount == 0,
+      "exceptions are rethrown to waiters, and nothing is cached");
+  }
+
+  {
+    Cache cache {100};
+    cache.GetOrCreate(1, [&]() {
+      // Invalidated while this is being created
+      cache.EraseIf([](int key) { return key == 1; });
+      return Created {std::make_shared<const int>(1), 1};
+    });
+    check(
+      cache.GetStats().mCache.mEntryCount == 0,
+      "values invalidated while being created aren't cached");
+  }
+
+  {
+    Cache cache {100};
+    cache.GetOrCreate(1, [&]() {
+      cache.EraseIf([](int key) { return key == 2; });
+      return Created {std::make_shared<const int>(1), 1};
+    });
+    check(
+      cache.GetStats().mCache.mEntryCount == 1,
+      "erasing other keys doesn't discard values being created");
+  }
+
+  {
+    // Erased while being created, then requested again before the first
+    // creation finishes: the second request must not wait for the stale
+    // value
+    Cache cache {100};
+    std::latch erased {1};
+    std::latch recreated {1};
+    int second = 0;
+    std::jthread first([&]() {
+      cache.GetOrCreate(1, [&]() {
+        cache.EraseIf([](int) { return true; });
+        erased.count_down();
+        recreated.wait();
+        return Created {std::make_shared<const int>(1), 1};
+      });
+    });
+    erased.wait();
+    second = *cache.GetOrCreate(
+      1, []() { return Created {std::make_shared<const int>(2), 1}; });
+    recreated.count_down();
+    first = {};
+    const auto cached = cache.GetOrCreate(
+      1, []() { return Created {std::make_shared<const int>(3), 1}; });
+    check(
+      second == 2 && *cached == 2,
+      "values erased while being created are created again");
+  }
+
+  {
+    Cache cache {100};
+    const auto empty = !cache.Get(1);
+    bool inFlight = false;
+    cache.GetOrCreate(1, [&]() {
+      inFlight = !cache.Get(1);
+      return Created {std::make_shared<const int>(1), 1};
+    });
+    const auto created = cache.Get(1);
+    check(
+      empty && inFlight && created && **created == 1,
+      "Get() only returns created values, without waiting");
+  }
+
+  {
+    // Two views of the same pages, at two sizes, rendered concurrently
+    Cache cache {1000};
+    std::atomic<int> created {0};
+    std::vector<std::jthread> views;
+    for (int view = 0; view < 2; ++view) {
+      views.emplace_back([&]() {
+        for (int page = 0; page < 50; ++page) {
+          for (const int size: {1, 2}) {
+            cache.GetOrCreate(page * 10 + size, [&]() {
+              ++created;
+              std::this_thread::sleep_for(100us);
+              return Created {std::make_shared<const int>(page), 1};
+            });
+          }
+        }
+      });
+    }
+    views.clear();
+    check(created == 100, "two views render each page and size once");
+  }
+}
+
+int Verify() {
+  Checks check;
+  VerifyCoalescing(check);
+
+  LRUCache<int, std::string> cache {10};
+  check(!cache.Get(1), "empty cache misses");
+  cache.Insert(1, "a", 4);
+  cache.Insert(2, "b", 4);
+  check(cache.Get(1) && *cache.Get(1) == "a", "hit");
+  // 1 is now the most recently used, so 2 is evicted
+  cache.Insert(3, "c", 4);
+  check(
+    cache.Contains(1) && !cache.Contains(2) && cache.Contains(3)
+      && cache.GetCost() == 8,
+    "least recently used entry is evicted");
+
+  check(
+    !cache.Insert(4, "d", 11) && !cache.Contains(4) && cache.GetCost() == 8,
+    "entries over the whole budget are rejected");
+  cache.Insert(1, "a2", 2);
+  check(
+    *cache.Get(1) == "a2" && cache.GetCost() == 6,
+    "replacing an entry updates its cost");
+  cache.Insert(5, "e", 10);
+  check(
+    cache.GetStats().mEntryCount == 1 && cache.Contains(5),
+    "a large entry evicts as many entries as needed");
+
+  cache.Insert(6, "f", 0);
+  check(
+    cache.EraseIf([](int key, const std::string&) { return key == 5; }) == 1
+      && cache.GetCost() == 0 && cache.Contains(6),
+    "EraseIf");
+
+  cache.Insert(7, "g", 3);
+  cache.Insert(8, "h", 3);
+  cache.SetBudget(4);
+  check(
+    cache.GetCost() <= 4 && cache.Contains(8) && !cache.Contains(7),
+    "reducing the budget evicts");
+
+  const auto stats = cache.GetStats();
+  check(
+    stats.mHits == 3 && stats.mMisses == 1 && stats.mInsertions == 8
+      && stats.mEvictions == 5 && stats.mBudget == 4,
+    std::format(
+      "stats: {} hits, {} misses, {} insertions, {} evictions",
+      stats.mHits,
+      stats.mMisses,
+      stats.mInsertions,
+      stats.mEvictions));
+  cache.ResetStats();
+  check(cache.GetStats().mHits == 0, "ResetStats");
+
+  const auto traces = MakeTraces(10000);
+  check(GetHitRate(traces[0], 1) == 0, "one entry never hits when flipping");
+  check(GetHitRate(traces[0], 4) > 0.99, "four entries hit when flipping");
+  check(
+    GetHitRate(traces[2], 8) > GetHitRate(traces[2], 1),
+    "more entries help with bookmarks");
+
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t length) {
+  const auto traces = MakeTraces(length);
+  for (const auto& trace: traces) {
+    std::cout << std::format("{}:", trace.mName);
+    for (const size_t capacity: {1, 2, 4, 8, 16}) {
+      std::cout << std::format(
+        " {}: {:.0f}%", capacity, 100 * GetHitRate(trace, capacity));
+    }
+    std::cout << '\n';
+  }
+
+  // Lookups and insertions for a realistic size, with a mix of hits and
+  // misses
+  const auto& trace = traces.at(1);
+  LRUCache<uint32_t, uint32_t> cache {8};
+  const auto start = Clock::now();
+  for (const auto page: trace.mPages) {
+    if (!cache.Get(page)) {
+      cache.Insert(page, page, 1);
+    }
+  }
+  std::cout << std::format(
+    "LRUCache: {:.1f}ns per lookup\n",
+    MillisecondsSince(start) * 1000000 / trace.mPages.size());
+
+  for (const size_t threadCount: {1, 4}) {
+    CoalescingCache<uint32_t, uint32_t> coalescing {8};
+    const auto coalescingStart = Clock::now();
+    std::vector<std::jthread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+      threads.emplace_back([&]() {
+        for (const auto page: trace.mPages) {
+          coalescing.GetOrCreate(
+            page, [page]() { return std::pair {page, size_t {1}}; });
+        }
+      });
+    }
+    threads.clear();
+    std::cout << std::format(
+      "CoalescingCache, {} threads: {:.1f}ns per lookup\n",
+      threadCount,
+      MillisecondsSince(coalescingStart) * 1000000
+        / (trace.mPages.size() * threadCount));
+  }
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[TRACE_LENGTH]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 1000000 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
@@ -0,0 +1,664 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `PageImageCache` - round trips, keying, corruption, crash leftovers,
+// LRU eviction, and background stores - and `CachingImageDecoder`, then
+// compares decoding a profile's worth of pages on a cold start with loading
+// them from the cache on the next launch. Only depends on the standard
+// library, zlib, and libjpeg-turbo, so it can also be built and profiled
+// outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/CachingImageDecoder.h>
+#include <OpenKneeboard/JPEGImageDecoder.h>
+#include <OpenKneeboard/PageImageCache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <jpeglib.h>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+std::filesystem::path GetScratchPath(std::string_view name) {
+  return std::filesystem::temp_directory_path()
+    / std::format("page-image-cache-benchmark-{}", name);
+}
+
+/// A gradient with some texture, roughly like a photo or a scanned page
+void WriteJPEG(
+  const std::filesystem::path& path,
+  uint32_t width,
+  uint32_t height,
+  uint32_t seed) {
+  jpeg_compress_struct info {};
+  jpeg_error_mgr errors {};
+  info.err = jpeg_std_error(&errors);
+  jpeg_create_compress(&info);
+
+  unsigned char* buffer = nullptr;
+  unsigned long size = 0;
+  jpeg_mem_dest(&info, &buffer, &size);
+  info.image_width = width;
+  info.image_height = height;
+  info.input_components = 3;
+  info.in_color_space = JCS_RGB;
+  jpeg_set_defaults(&info);
+  jpeg_set_quality(&info, 90, TRUE);
+  jpeg_start_compress(&info, TRUE);
+
+  std::minstd_rand random {seed};
+  std::vector<JSAMPLE> row(width * 3);
+  while (info.next_scanline < height) {
+    const auto y = info.next_scanline;
+    for (uint32_t x = 0; x < width; ++x) {
+      const auto noise = static_cast<int>(random() % 24);
+      row[(x * 3) + 0] = static_cast<JSAMPLE>((x * 200) / width + noise);
+      row[(x * 3) + 1] = static_cast<JSAMPLE>((y * 200) / height + noise);
+      row[(x * 3) + 2] = static_cast<JSAMPLE>(((x + y + seed) % 200) + noise);
+    }
+    auto rowPointer = row.data();
+    jpeg_write_scanlines(&info, &rowPointer, 1);
+  }
+  jpeg_finish_compress(&info);
+
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  f.write(reinterpret_cast<const char*>(buffer), size);
+  f.close();
+  std::free(buffer);
+  jpeg_destroy_compress(&info);
+}
+
+/// Premultiplied, with a mixture of flat, smooth, and noisy areas
+DecodedImage MakeImage(ImageSize size, uint32_t seed) {
+  DecodedImage ret {
+    .mSize = size,
+    .mNativeSize = {size.mWidth * 2, size.mHeight * 2},
+  };
+  ret.mPixels.resize(ret.GetStride() * size.mHeight);
+  std::minstd_rand random {seed};
+  auto it = ret.mPixels.begin();
+  for (uint32_t y = 0; y < size.mHeight; ++y) {
+    for (uint32_t x = 0; x < size.mWidth; ++x) {
+      const auto alpha = static_cast<uint8_t>(
+        (x < size.mWidth / 2) ? 255 : ((x + y) % 256));
+      const auto noisy = (y > size.mHeight / 2);
+      for (int c = 0; c < 3; ++c) {
+        const auto value = noisy ? random() % 256 : ((x * (c + 1)) % 256);
+        *it++ = static_cast<std::byte>((value * alpha) / 255);
+      }
+      *it++ = static_cast<std::byte>(alpha);
+    }
+  }
+  return ret;
+}
+
+/// Black lines of 'words' on white, like a rendered PDF page
+DecodedImage MakeDocumentImage(ImageSize size, uint32_t seed) {
+  DecodedImage ret {.mSize = size, .mNativeSize = size};
+  ret.mPixels.resize(ret.GetStride() * size.mHeight, std::byte {0xff});
+  std::minstd_rand random {seed};
+  const auto margin = size.mWidth / 10;
+  for (uint32_t line = margin; line + 12 < size.mHeight - margin; line += 24) {
+    uint32_t x = margin;
+    while (x < size.mWidth - margin) {
+      const auto wordWidth = static_cast<uint32_t>(20 + (random() % 60));
+      const auto wordEnd = std::min(x + wordWidth, size.mWidth - margin);
+      for (uint32_t y = line; y < line + 12; ++y) {
+        for (uint32_t i = x; i < wordEnd; ++i) {
+          const auto offset = (y * ret.GetStride()) + (i * 4);
+          // Anti-aliased edges, so it's not just two colors
+          const auto value = static_cast<std::byte>(random() % 64);
+          for (int c = 0; c < 3; ++c) {
+            ret.mPixels[offset + c] = value;
+          }
+        }
+      }
+      x += wordWidth + 12;
+    }
+  }
+  return ret;
+}
+
+PageImageKey MakeKey(const std::filesystem::path& path, uint64_t page) {
+  return {
+    .mPath = path,
+    .mSource = {
+      .mSize = 12345,
+      .mLastWriteTime = std::filesystem::file_time_type::clock::now(),
+      .mContentHash = 0x0123456789abcdef,
+    },
+    .mPage = page,
+    .mSize = {300, 200},
+  };
+}
+
+bool SameImage(
+  const std::optional<DecodedImage>& a,
+  const DecodedImage& b) {
+  return a && a->mSize == b.mSize && a->mNativeSize == b.mNativeSize
+    && a->mPixels == b.mPixels;
+}
+
+size_t CountFiles(
+  const std::filesystem::path& directory,
+  std::string_view extension) {
+  size_t count = 0;
+  for (const auto& it: std::filesystem::directory_iterator(directory)) {
+    if (it.path().extension() == extension) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+uint64_t GetDirectorySize(const std::filesystem::path& directory) {
+  uint64_t ret = 0;
+  for (const auto& it: std::filesystem::directory_iterator(directory)) {
+    ret += it.file_size();
+  }
+  return ret;
+}
+
+void Corrupt(const std::filesystem::path& path, size_t offsetFromEnd) {
+  std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+  f.seekg(-static_cast<std::streamoff>(offsetFromEnd), std::ios::end);
+  char c {};
+  f.read(&c, 1);
+  f.seekp(-static_cast<std::streamoff>(offsetFromEnd), std::ios::end);
+  c = static_cast<char>(c ^ 0x5a);
+  f.write(&c, 1);
+}
+
+/// Counts decodes that get past the cache
+class CountingDecoder final : public ImageDecoder {
+ public:
+  std::optional<ImageSize> ReadSize(
+    const std::filesystem::path& path) override {
+    return mDecoder.ReadSize(path);
+  }
+
+  std::optional<DecodedImage> Decode(
+    const std::filesystem::path& path,
+    const ImageSize& maxSize,
+    std::stop_token stopToken) override {
+    ++mDecodeCount;
+    return mDecoder.Decode(path, maxSize, stopToken);
+  }
+
+  std::atomic<size_t> mDecodeCount {0};
+
+ private:
+  JPEGImageDecoder mDecoder;
+};
+
+int Verify() {
+  Checks check;
+
+  const auto directory = GetScratchPath("verify");
+  std::filesystem::remove_all(directory);
+
+  const auto image = MakeImage({300, 200}, 1);
+  const auto key = MakeKey("C:/kneeboard/page.png", 0);
+  {
+    const auto bytes = PageImageCache::Serialize(key, image);
+    check(
+      SameImage(PageImageCache::Deserialize(bytes, key), image),
+      "serialize round trip");
+    check(
+      bytes.size() < image.mPixels.size(), "entry is smaller than the pixels");
+
+    auto truncated = bytes;
+    truncated.pop_back();
+    check(
+      !PageImageCache::Deserialize(truncated, key), "truncated entry misses");
+    check(
+      !PageImageCache::Deserialize(
+        std::span {bytes}.subspan(0, bytes.size() / 2), key),
+      "half-written entry misses");
+    auto badMagic = bytes;
+    badMagic[0] = std::byte {'X'};
+    check(!PageImageCache::Deserialize(badMagic, key), "bad magic misses");
+    auto badVersion = bytes;
+    badVersion[4] = static_cast<std::byte>(PageImageCache::Version + 1);
+    check(!PageImageCache::Deserialize(badVersion, key), "bad version misses");
+    check(!PageImageCache::Deserialize({}, key), "empty entry misses");
+
+    DecodedImage wrongPixelCount = image;
+    wrongPixelCount.mPixels.pop_back();
+    check(
+      PageImageCache::Serialize(key, wrongPixelCount).empty(),
+      "inconsistent images aren't serialized");
+  }
+
+  {
+    const auto mismatches = [&key] {
+      std::vector<std::pair<std::string_view, PageImageKey>> ret;
+      auto k = key;
+      k.mPath = "C:/kneeboard/other.png";
+      ret.push_back({"path", k});
+      k = key;
+      k.mSource.mSize += 1;
+      ret.push_back({"source size", k});
+      k = key;
+      k.mSource.mLastWriteTime += std::chrono::seconds(1);
+      ret.push_back({"modification time", k});
+      k = key;
+      k.mSource.mContentHash += 1;
+      ret.push_back({"content hash", k});
+      k = key;
+      k.mPage += 1;
+      ret.push_back({"page", k});
+      k = key;
+      k.mSize.mWidth += 1;
+      ret.push_back({"size", k});
+      return ret;
+    }();
+
+    const auto bytes = PageImageCache::Serialize(key, image);
+    for (const auto& [what, other]: mismatches) {
+      check(
+        !PageImageCache::Deserialize(bytes, other),
+        std::format("different {} misses", what));
+    }
+
+    PageImageCache cache(directory);
+    for (const auto& [what, other]: mismatches) {
+      check(
+        cache.GetEntryPath(other) != cache.GetEntryPath(key),
+        std::format("different {} has a different entry", what));
+    }
+  }
+
+  {
+    PageImageCache cache(directory);
+    check(!cache.Load(key), "empty cache misses");
+    check(cache.Store(key, image), "store");
+    check(SameImage(cache.Load(key), image), "load");
+    check(
+      SameImage(PageImageCache(directory).Load(key), image),
+      "load from another instance");
+    check(CountFiles(directory, ".tmp") == 0, "no temporary files left");
+
+    const auto entry = cache.GetEntryPath(key);
+    Corrupt(entry, 10);
+    check(!cache.Load(key), "corrupt payload misses");
+    check(cache.Store(key, image), "store over corrupt entry");
+    check(SameImage(cache.Load(key), image), "load after re-storing");
+  }
+
+  {
+    // Left behind by a crash mid-write
+    PageImageCache cache(directory);
+    const auto entry = cache.GetEntryPath(key);
+    auto recent = entry;
+    recent += ".00000001.tmp";
+    auto abandoned = entry;
+    abandoned += ".00000002.tmp";
+    for (const auto& path: {recent, abandoned}) {
+      std::ofstream(path, std::ios::binary) << "partial";
+    }
+    std::filesystem::last_write_time(
+      abandoned,
+      std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+    check(SameImage(cache.Load(key), image), "temporary files are ignored");
+    cache.Store(MakeKey("C:/kneeboard/prune.png", 0), image);
+    check(
+      std::filesystem::exists(recent) && !std::filesystem::exists(abandoned),
+      "abandoned temporary files are removed");
+
+    // The total is tracked in memory until it goes over budget
+    std::ofstream(abandoned, std::ios::binary) << "partial";
+    std::filesystem::last_write_time(
+      abandoned,
+      std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+    cache.Store(MakeKey("C:/kneeboard/prune.png", 1), image);
+    check(
+      std::filesystem::exists(abandoned),
+      "stores within budget don't list the directory");
+    std::filesystem::remove(recent);
+    std::filesystem::remove(abandoned);
+  }
+
+  {
+    PageImageCache cache(directory);
+    const auto absent = MakeKey("C:/kneeboard/absent.png", 0);
+    check(
+      cache.MayContain(key) && cache.MayContain(absent),
+      "anything may be cached before the directory is listed");
+    check(!cache.Load(absent), "absent entry misses");
+    check(
+      cache.MayContain(key) && !cache.MayContain(absent),
+      "absent entries are known after a load");
+    cache.Store(absent, image);
+    check(cache.MayContain(absent), "stored entries may be cached");
+    std::filesystem::remove(cache.GetEntryPath(absent));
+    check(!cache.Load(absent), "entries removed by another process miss");
+    check(
+      !cache.MayContain(absent),
+      "entries removed by another process are absent after a load");
+  }
+
+  {
+    std::filesystem::remove_all(directory);
+    PageImageCache unlimited(directory);
+    unlimited.Store(MakeKey("C:/kneeboard/size.png", 0), image);
+    const auto entrySize = GetDirectorySize(directory);
+    std::filesystem::remove_all(directory);
+
+    // Room for 3 entries
+    PageImageCache cache(directory, (entrySize * 3) + (entrySize / 2));
+    std::vector<PageImageKey> keys;
+    const auto start = std::filesystem::file_time_type::clock::now();
+    for (uint64_t i = 0; i < 3; ++i) {
+      keys.push_back(MakeKey("C:/kneeboard/lru.png", i));
+      cache.Store(keys.back(), image);
+      // Filesystem timestamps can be coarse
+      std::filesystem::last_write_time(
+        cache.GetEntryPath(keys.back()),
+        start - std::chrono::seconds(10 - i));
+    }
+    // Makes page 0 the most recently used
+    check(cache.Load(keys.at(0)).has_value(), "LRU: load");
+    keys.push_back(MakeKey("C:/kneeboard/lru.png", 3));
+    cache.Store(keys.back(), image);
+    check(
+      !cache.MayContain(keys.at(1)) && cache.MayContain(keys.at(3)),
+      "LRU: evicted entries are known absent");
+
+    check(cache.Load(keys.at(0)).has_value(), "LRU: recently used kept");
+    check(!cache.Load(keys.at(1)).has_value(), "LRU: least recent evicted");
+    check(cache.Load(keys.at(2)).has_value(), "LRU: others kept");
+    check(cache.Load(keys.at(3)).has_value(), "LRU: new entry kept");
+    check(
+      GetDirectorySize(directory) <= (entrySize * 3) + (entrySize / 2),
+      "LRU: within budget");
+
+    bool newestKept = true;
+    for (uint64_t i = 4; i < 16; ++i) {
+      keys.push_back(MakeKey("C:/kneeboard/lru.png", i));
+      cache.Store(keys.back(), image);
+      newestKept = newestKept && cache.Load(keys.back()).has_value();
+    }
+    // Overwrites are over-counted until the next listing
+    for (int i = 0; i < 4; ++i) {
+      cache.Store(keys.back(), image);
+    }
+    check(
+      newestKept
+        && GetDirectorySize(directory) <= (entrySize * 3) + (entrySize / 2),
+      "LRU: repeated stores stay within budget");
+  }
+
+  {
+    std::filesystem::remove_all(directory);
+    PageImageCache cache(directory);
+    std::vector<PageImageKey> keys;
+    for (uint64_t i = 0; i < 8; ++i) {
+      keys.push_back(MakeKey("C:/kneeboard/background.png", i));
+      cache.StoreInBackground(keys.back(), MakeImage({300, 200}, i));
+    }
+    cache.WaitForIdle();
+    bool ok = true;
+    for (uint64_t i = 0; i < keys.size(); ++i) {
+      ok = ok && SameImage(cache.Load(keys.at(i)), MakeImage({300, 200}, i));
+    }
+    check(ok, "background stores");
+
+    const auto big = MakeImage({4096, 4096}, 1);
+    const auto bigKey = MakeKey("C:/kneeboard/big.png", 0);
+    for (int i = 0; i < 4; ++i) {
+      cache.StoreInBackground(bigKey, big);
+    }
+    cache.WaitForIdle();
+    check(SameImage(cache.Load(bigKey), big), "large background store");
+  }
+
+  {
+    // Several threads or processes decoding the same page
+    std::filesystem::remove_all(directory);
+    PageImageCache cache(directory);
+    std::atomic<size_t> stored {0};
+    std::vector<std::jthread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&] {
+        for (int j = 0; j < 4; ++j) {
+          if (PageImageCache(directory).Store(key, image)) {
+            ++stored;
+          }
+        }
+      });
+    }
+    threads.clear();
+    check(
+      stored == 16 && SameImage(cache.Load(key), image)
+        && CountFiles(directory, ".tmp") == 0,
+      "concurrent stores");
+  }
+
+  {
+    std::filesystem::remove_all(directory);
+    const auto jpegPath = GetScratchPath("verify.jpg");
+    WriteJPEG(jpegPath, 1200, 900, 1);
+
+    auto counting = std::make_shared<CountingDecoder>();
+    auto cache = std::make_shared<PageImageCache>(directory);
+    CachingImageDecoder decoder(counting, cache);
+    constexpr ImageSize Bounds {600, 600};
+
+    const auto first = decoder.Decode(jpegPath, Bounds, {});
+    cache->WaitForIdle();
+    const auto second = decoder.Decode(jpegPath, Bounds, {});
+    check(
+      first && first->mSize == ImageSize {600, 450}
+        && first->mNativeSize == ImageSize {1200, 900},
+      "decoder: first decode");
+    check(
+      second && SameImage(second, *first) && counting->mDecodeCount == 1,
+      "decoder: second decode is a hit");
+
+    const auto other = decoder.Decode(jpegPath, {300, 300}, {});
+    cache->WaitForIdle();
+    check(
+      other && other->mSize == ImageSize {300, 225}
+        && counting->mDecodeCount == 2,
+      "decoder: different size misses");
+
+    WriteJPEG(jpegPath, 1200, 900, 2);
+    // Make sure the modification time changes too
+    std::filesystem::last_write_time(
+      jpegPath,
+      std::filesystem::last_write_time(jpegPath) + std::chrono::seconds(2));
+    const auto modified = decoder.Decode(jpegPath, Bounds, {});
+    check(
+      modified && !SameImage(modified, *first)
+        && counting->mDecodeCount == 3,
+      "decoder: modified file misses");
+
+    std::stop_source stopped;
+    stopped.request_stop();
+    std::filesystem::remove_all(directory);
+    check(
+      !decoder.Decode(jpegPath, {100, 100}, stopped.get_token()),
+      "decoder: cancellation");
+    cache->WaitForIdle();
+    std::filesystem::remove(jpegPath);
+  }
+
+  std::filesystem::remove_all(directory);
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t pageCount) {
+  // A4 at 300 DPI, shown on the kneeboard texture
+  constexpr uint32_t Width = 2480;
+  constexpr uint32_t Height = 3508;
+  constexpr ImageSize Bounds {2048, 2048};
+
+  const auto directory = GetScratchPath("bench");
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  std::vector<std::filesystem::path> paths;
+  for (size_t i = 0; i < pageCount; ++i) {
+    paths.push_back(directory / std::format("page-{}.jpg", i));
+    WriteJPEG(paths.back(), Width, Height, static_cast<uint32_t>(i));
+  }
+  const auto cacheDirectory = directory / "cache";
+  std::cout << std::format(
+    "{} pages of {}x{}, for {}x{}\n\n",
+    pageCount,
+    Width,
+    Height,
+    Bounds.mWidth,
+    Bounds.mHeight);
+
+  const auto decodeAll = [&](ImageDecoder& decoder) {
+    const auto start = Clock::now();
+    for (const auto& path: paths) {
+      if (!decoder.Decode(path, Bounds, {})) {
+        std::cout << "Decode failed\n";
+        std::exit(1);
+      }
+    }
+    return MillisecondsSince(start);
+  };
+  const auto report = [pageCount](std::string_view label, double ms) {
+    std::cout << std::format(
+      "  {:<36} {:>8.1f}ms {:>8.1f}ms/page\n", label, ms, ms / pageCount);
+  };
+
+  auto jpeg = std::make_shared<JPEGImageDecoder>();
+  report("without cache", decodeAll(*jpeg));
+
+  {
+    auto cache = std::make_shared<PageImageCache>(cacheDirectory);
+    CachingImageDecoder decoder(jpeg, cache);
+    report("cold start with cache", decodeAll(decoder));
+    const auto start = Clock::now();
+    cache->WaitForIdle();
+    report("  + background stores", MillisecondsSince(start));
+  }
+  {
+    // A new instance, like the next launch
+    auto cache = std::make_shared<PageImageCache>(cacheDirectory);
+    CachingImageDecoder decoder(jpeg, cache);
+    report("warm start", decodeAll(decoder));
+  }
+  std::cout << std::format(
+    "  {:<36} {:>8.1f} MiB\n",
+    "cache size",
+    GetDirectorySize(cacheDirectory) / (1024.0 * 1024.0));
+
+  std::cout << "\nRendered document pages (e.g. PDF), 1275x1650:\n";
+  {
+    constexpr size_t Iterations = 10;
+    const auto image = MakeDocumentImage({1275, 1650}, 1);
+    const auto key = MakeKey(directory / "document.pdf", 0);
+    PageImageCache cache(cacheDirectory);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < Iterations; ++i) {
+      cache.Store(key, image);
+    }
+    const auto storeMS = MillisecondsSince(start) / Iterations;
+    start = Clock::now();
+    for (size_t i = 0; i < Iterations; ++i) {
+      if (!cache.Load(key)) {
+        std::cout << "Load failed\n";
+        return 1;
+      }
+    }
+    const auto loadMS = MillisecondsSince(start) / Iterations;
+    std::cout << std::format(
+      "  {:<36} {:>8.1f}ms\n  {:<36} {:>8.1f}ms\n  {:<36} {:>8.1f} KiB "
+      "({:.1f}% of raw)\n",
+      "store",
+      storeMS,
+      "load",
+      loadMS,
+      "entry size",
+      std::filesystem::file_size(cache.GetEntryPath(key)) / 1024.0,
+      (100.0 * std::filesystem::file_size(cache.GetEntryPath(key)))
+        / image.mPixels.size());
+  }
+
+  {
+    // A cache that's been in use for a while; stores shouldn't have to list
+    // every entry
+    constexpr size_t OtherEntries = 5000;
+    constexpr size_t Iterations = 100;
+    const auto crowded = directory / "crowded";
+    std::filesystem::create_directories(crowded);
+    for (size_t i = 0; i < OtherEntries; ++i) {
+      std::ofstream(crowded / std::format("{:016x}.v1.okpi", i)) << "entry";
+    }
+    const auto image = MakeImage({64, 64}, 1);
+    PageImageCache cache(crowded);
+    // The first store lists the directory
+    cache.Store(MakeKey(directory / "crowded.png", 0), image);
+    const auto start = Clock::now();
+    for (size_t i = 0; i < Iterations; ++i) {
+      cache.Store(MakeKey(directory / "crowded.png", i + 1), image);
+    }
+    std::cout << std::format(
+      "  {:<36} {:>8.3f}ms\n",
+      std::format("small store, {} other entries", OtherEntries),
+      MillisecondsSince(start) / Iterations);
+  }
+
+  std::filesystem::remove_all(directory);
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[PAGES]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 30 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
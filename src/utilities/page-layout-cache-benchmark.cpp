@@ -0,0 +1,233 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks the invalidation rules of `PageLayoutCache`, and measures repeated
+// renders of dense `PlainTextLayout` pages with a headless stand-in for
+// DirectWrite. Only depends on the standard library, so it can also be
+// built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/PageLayoutCache.h>
+#include <OpenKneeboard/PlainTextLayout.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+// Stands in for `IDWriteTextLayout`: 'shaping' computes a position for
+// every character, which is roughly the shape of the real work
+struct HeadlessTextLayout {
+  std::vector<float> mAdvances;
+  float mWidth {};
+};
+
+using HeadlessPageLayout = std::vector<HeadlessTextLayout>;
+
+HeadlessTextLayout Shape(std::string_view text, float fontSize) {
+  HeadlessTextLayout layout;
+  layout.mAdvances.reserve(text.size());
+  for (const auto c: text) {
+    // Something the optimizer can't skip
+    const auto advance
+      = fontSize * (0.5f + 0.01f * std::sin(static_cast<float>(c)));
+    layout.mAdvances.push_back(advance);
+    layout.mWidth += advance;
+  }
+  return layout;
+}
+
+HeadlessPageLayout ShapePage(
+  const PlainTextLayout& text,
+  size_t pageIndex,
+  float fontSize) {
+  HeadlessPageLayout page;
+  for (const auto& line: text.GetPageLines(pageIndex)) {
+    page.push_back(Shape(text.GetText(line), fontSize));
+  }
+  return page;
+}
+
+// Stands in for drawing the glyph runs
+float Draw(const HeadlessPageLayout& page) {
+  float total = 0;
+  for (const auto& line: page) {
+    total += line.mWidth;
+  }
+  return total;
+}
+
+// The same key as `PlainTextPageSource::RenderPage()`
+PageLayoutCache<HeadlessPageLayout>::Key GetKey(
+  const PlainTextLayout& text,
+  size_t pageIndex) {
+  return {
+    .mPageKey = pageIndex,
+    .mContentGeneration = (pageIndex < text.GetCompletePageCount())
+      ? 0
+      : text.GetCurrentPageLines().size(),
+  };
+}
+
+int Verify() {
+  Checks check;
+
+  PageLayoutCache<int> cache {2};
+  int creates = 0;
+  const auto get = [&](uint64_t page, uint64_t generation) {
+    return cache.GetOrCreate(
+      {page, generation}, [&]() { return ++creates; });
+  };
+
+  const auto first = get(0, 0);
+  check(get(0, 0) == first && creates == 1, "hit");
+  check(
+    get(0, 1) != first && creates == 2 && cache.GetStats().mStaleEntries == 1,
+    "content generation change");
+  get(1, 0);
+  get(0, 1);
+  // Page 1 is now least-recently used
+  get(2, 0);
+  check(
+    cache.GetSize() == 2 && cache.GetStats().mEvictions == 1
+      && get(0, 1) == 2,
+    "LRU eviction");
+  const auto beforeStyle = creates;
+  cache.SetStyleGeneration(1);
+  check(
+    cache.GetSize() == 0 && get(0, 1) == beforeStyle + 1,
+    "style change invalidates everything");
+  cache.SetStyleGeneration(1);
+  check(cache.GetSize() == 1, "unchanged style keeps entries");
+  cache.Clear();
+  check(cache.GetSize() == 0, "clear");
+
+  // Appending must invalidate the current page, but no complete pages
+  PlainTextLayout text {60, 38};
+  PageLayoutCache<HeadlessPageLayout> pages {8};
+  std::mt19937_64 rng {1};
+  bool contentOK = true;
+  for (size_t i = 0; i < 2000; ++i) {
+    text.Append(std::format("message {} {}", i, rng()));
+    const auto last = text.GetCompletePageCount();
+    for (const auto page: {last, last > 0 ? last - 1 : last}) {
+      const auto& cached = pages.GetOrCreate(
+        GetKey(text, page), [&]() { return ShapePage(text, page, 20); });
+      if (cached.size() != text.GetPageLines(page).size()) {
+        contentOK = false;
+      }
+    }
+  }
+  check(contentOK, "cached pages match content");
+
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t renderCount) {
+  // A dense page: every line full
+  PlainTextLayout text {60, 38};
+  std::mt19937_64 rng {42};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  for (size_t i = 0; i < 2000; ++i) {
+    std::string message;
+    while (message.size() < 55) {
+      message += std::string(1 + (rng() % 8), static_cast<char>(letter(rng)));
+      message += ' ';
+    }
+    text.Append(message);
+  }
+
+  // Mostly repaints of the same page (e.g. cursor movement), sometimes
+  // flipping between a few pages
+  std::vector<size_t> renders;
+  const auto pageCount = text.GetCompletePageCount();
+  for (size_t i = 0; i < renderCount; ++i) {
+    const auto roll = rng() % 100;
+    renders.push_back(
+      (roll < 90) ? pageCount - 1 : (pageCount - 1 - (rng() % 4)));
+  }
+
+  float sink = 0;
+  auto start = Clock::now();
+  for (const auto page: renders) {
+    sink += Draw(ShapePage(text, page, 20));
+  }
+  const auto uncachedMS = MillisecondsSince(start);
+
+  PageLayoutCache<HeadlessPageLayout> cache {8};
+  start = Clock::now();
+  for (const auto page: renders) {
+    sink += Draw(cache.GetOrCreate(
+      GetKey(text, page), [&]() { return ShapePage(text, page, 20); }));
+  }
+  const auto cachedMS = MillisecondsSince(start);
+  const auto stats = cache.GetStats();
+
+  std::cout << std::format(
+    "{} renders of {}-line pages\n"
+    "  uncached: {:.1f}ms, {:.2f}us/render\n"
+    "  cached:   {:.1f}ms, {:.2f}us/render\n"
+    "  {} hits, {} misses ({} stale), {} evictions; {:.1f}% hit rate\n"
+    "  (checksum {})\n",
+    renderCount,
+    text.GetPageLines(pageCount - 1).size(),
+    uncachedMS,
+    (uncachedMS * 1000) / renderCount,
+    cachedMS,
+    (cachedMS * 1000) / renderCount,
+    stats.mHits,
+    stats.mMisses,
+    stats.mStaleEntries,
+    stats.mEvictions,
+    (100.0 * stats.mHits) / (stats.mHits + stats.mMisses),
+    sink);
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[RENDERS]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 100000 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
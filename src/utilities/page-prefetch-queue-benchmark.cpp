@@ -0,0 +1,335 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `PagePrefetchQueue`'s neighbour window, and that results from
+// before a reset are rejected without disturbing pages queued since - both
+// directly, and with threads doing the work outside of the lock like
+// `PDFFilePageSource` does for links. Also measures the cost of a claim.
+// Only depends on the standard library, so it can also be built and profiled
+// outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/PagePrefetchQueue.h>
+
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+using Queue = PagePrefetchQueue<uint64_t>;
+
+std::vector<uint64_t> MakePageIDs(size_t count, uint64_t first = 1000) {
+  std::vector<uint64_t> ret(count);
+  std::iota(ret.begin(), ret.end(), first);
+  return ret;
+}
+
+std::vector<PageIndex> GetIndices(const std::vector<Queue::Request>& requests) {
+  std::vector<PageIndex> ret;
+  for (const auto& it: requests) {
+    ret.push_back(it.mPageIndex);
+  }
+  return ret;
+}
+
+constexpr auto NeverDone = [](uint64_t) { return false; };
+
+void VerifyWindow(Checks& check) {
+  const auto pageIDs = MakePageIDs(10);
+
+  {
+    Queue queue;
+    const auto claimed = queue.Claim(pageIDs, 5, NeverDone);
+    check(
+      GetIndices(claimed) == std::vector<PageIndex> {5, 6, 4, 7}
+        && claimed.front().mPageID == pageIDs.at(5),
+      "claims the page, then the next, previous, and the one after");
+  }
+
+  {
+    Queue queue;
+    check(
+      GetIndices(queue.Claim(pageIDs, 0, NeverDone))
+        == std::vector<PageIndex> {0, 1, 2},
+      "the first page doesn't wrap around to the last");
+  }
+
+  {
+    Queue queue;
+    check(
+      GetIndices(queue.Claim(pageIDs, 9, NeverDone))
+        == std::vector<PageIndex> {9, 8},
+      "the last page only claims pages that exist");
+  }
+
+  {
+    Queue queue;
+    check(
+      queue.Claim(pageIDs, 10, NeverDone).empty()
+        && queue.GetPendingCount() == 0,
+      "out-of-range pages claim nothing");
+  }
+
+  {
+    Queue queue;
+    const auto claimed = queue.Claim(
+      pageIDs, 5, [&](uint64_t id) { return id == pageIDs.at(6); });
+    check(
+      GetIndices(claimed) == std::vector<PageIndex> {5, 4, 7}
+        && !queue.IsPending(pageIDs.at(6)),
+      "pages that are already done aren't claimed");
+  }
+
+  {
+    Queue queue;
+    queue.Claim(pageIDs, 5, NeverDone);
+    check(
+      GetIndices(queue.Claim(pageIDs, 6, NeverDone))
+        == std::vector<PageIndex> {8},
+      "pending pages aren't claimed twice");
+  }
+}
+
+void VerifyCompletion(Checks& check) {
+  const auto pageIDs = MakePageIDs(10);
+
+  {
+    Queue queue;
+    const auto claimed = queue.Claim(pageIDs, 5, NeverDone);
+    bool allKept = true;
+    for (const auto& it: claimed) {
+      allKept = queue.Complete(it) && allKept;
+    }
+    check(
+      allKept && queue.GetPendingCount() == 0
+        && queue.Claim(pageIDs, 5, NeverDone).size() == 4,
+      "completed pages are kept, and can be claimed again");
+  }
+
+  {
+    Queue queue;
+    const auto stale = queue.Claim(pageIDs, 5, NeverDone);
+    queue.Reset();
+    check(
+      queue.GetPendingCount() == 0 && !queue.Complete(stale.front()),
+      "results from before a reset are rejected");
+  }
+
+  {
+    // The race `PDFFilePageSource` hits when a PDF is reloaded while a page
+    // is being extracted: the stale result must not un-queue the same page
+    // for the new file, or it would be extracted again
+    Queue queue;
+    const auto stale = queue.Claim(pageIDs, 5, NeverDone);
+    queue.Reset();
+    const auto current = queue.Claim(pageIDs, 5, NeverDone);
+    const auto staleKept = queue.Complete(stale.front());
+    check(
+      !staleKept && queue.IsPending(pageIDs.at(5))
+        && queue.Claim(pageIDs, 5, NeverDone).empty(),
+      "stale results don't un-queue pages claimed after a reset");
+    check(
+      queue.Complete(current.front()) && !queue.IsPending(pageIDs.at(5)),
+      "results claimed after a reset are kept");
+  }
+}
+
+// Like `PDFFilePageSource::PrefetchLinks()`: cursor threads claim pages
+// under a lock, the work is done without it, then the result is stored if
+// `Complete()` allows it. The file is 'reloaded' every so often.
+void VerifyConcurrent(Checks& check) {
+  constexpr size_t threadCount = 8;
+  constexpr size_t eventsPerThread = 20000;
+  constexpr size_t pageCount = 50;
+  const auto pageIDs = MakePageIDs(pageCount);
+
+  std::mutex mutex;
+  Queue queue;
+  uint64_t generation = 0;
+  // Page ID => the generation its result is from
+  std::unordered_map<uint64_t, uint64_t> done;
+  // (generation, page ID) => times the work was done
+  std::map<std::pair<uint64_t, uint64_t>, size_t> workCount;
+  size_t staleStored = 0;
+  size_t resets = 0;
+
+  std::vector<std::jthread> threads;
+  for (size_t t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng {static_cast<uint32_t>(t)};
+      for (size_t i = 0; i < eventsPerThread; ++i) {
+        std::vector<Queue::Request> claimed;
+        uint64_t claimedGeneration {};
+        {
+          std::unique_lock lock(mutex);
+          if (rng() % 2000 == 0) {
+            queue.Reset();
+            done.clear();
+            ++generation;
+            ++resets;
+            continue;
+          }
+          claimed = queue.Claim(
+            pageIDs,
+            static_cast<PageIndex>(rng() % pageCount),
+            [&](uint64_t id) { return done.contains(id); });
+          claimedGeneration = generation;
+          for (const auto& it: claimed) {
+            ++workCount[{claimedGeneration, it.mPageID}];
+          }
+        }
+        for (const auto& it: claimed) {
+          // The 'work'; let other threads run, reset, and complete
+          std::this_thread::yield();
+          std::unique_lock lock(mutex);
+          if (!queue.Complete(it) || done.contains(it.mPageID)) {
+            continue;
+          }
+          if (claimedGeneration != generation) {
+            ++staleStored;
+          }
+          done.emplace(it.mPageID, claimedGeneration);
+        }
+      }
+    });
+  }
+  threads.clear();
+
+  size_t duplicated = 0;
+  for (const auto& [key, count]: workCount) {
+    if (count > 1) {
+      ++duplicated;
+    }
+  }
+  check(
+    resets > 0 && duplicated == 0,
+    std::format(
+      "concurrent claims do each page once per generation ({} duplicated, {} "
+      "resets)",
+      duplicated,
+      resets));
+  check(
+    staleStored == 0,
+    std::format("results from before a reset aren't stored ({})", staleStored));
+  check(
+    queue.GetPendingCount() == 0,
+    std::format(
+      "nothing is left pending once all work is complete ({})",
+      queue.GetPendingCount()));
+}
+
+int Verify() {
+  Checks check;
+  VerifyWindow(check);
+  VerifyCompletion(check);
+  VerifyConcurrent(check);
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t pageCount) {
+  const auto pageIDs = MakePageIDs(pageCount);
+  constexpr size_t iterations = 1000000;
+
+  {
+    // Every page is done: the common case once the reader has been around
+    Queue queue;
+    std::unordered_set<uint64_t> done(pageIDs.begin(), pageIDs.end());
+    size_t claimed = 0;
+    const auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      claimed += queue
+                   .Claim(
+                     pageIDs,
+                     static_cast<PageIndex>(i % pageCount),
+                     [&](uint64_t id) { return done.contains(id); })
+                   .size();
+    }
+    std::cout << std::format(
+      "{} pages, all done: {:.1f}ns per claim ({} claimed)\n",
+      pageCount,
+      MillisecondsSince(start) * 1000000 / iterations,
+      claimed);
+  }
+
+  {
+    // Reading forwards from the start, completing each claim immediately
+    Queue queue;
+    std::unordered_set<uint64_t> done;
+    size_t claimed = 0;
+    const auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      if (i % pageCount == 0) {
+        queue.Reset();
+        done.clear();
+      }
+      for (const auto& it: queue.Claim(
+             pageIDs,
+             static_cast<PageIndex>(i % pageCount),
+             [&](uint64_t id) { return done.contains(id); })) {
+        ++claimed;
+        if (queue.Complete(it)) {
+          done.insert(it.mPageID);
+        }
+      }
+    }
+    std::cout << std::format(
+      "{} pages, reading forwards: {:.1f}ns per page turn ({} claimed)\n",
+      pageCount,
+      MillisecondsSince(start) * 1000000 / iterations,
+      claimed);
+  }
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[PAGES]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 500 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
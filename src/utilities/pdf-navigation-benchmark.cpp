@@ -0,0 +1,787 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Generates a corpus of awkward PDFs, and checks, measures, or fuzzes
+// `PDFNavigation::PDF` against them. Only depends on QPDF and the standard
+// library, so it can also be built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/FileSnapshot.h>
+#include <OpenKneeboard/PDFNavigation.h>
+
+#include <shims/filesystem>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+using namespace OpenKneeboard::PDFNavigation;
+
+namespace {
+
+std::string ToUTF8(const std::filesystem::path& path) {
+  const auto utf8 = path.u8string();
+  return {reinterpret_cast<const char*>(utf8.data()), utf8.size()};
+}
+
+/// Just enough of a PDF writer to produce structurally valid files
+class PDFBuilder final {
+ public:
+  using ObjectID = size_t;
+
+  ObjectID Reserve() {
+    mObjects.emplace_back();
+    return mObjects.size();
+  }
+
+  void Set(ObjectID id, std::string body) {
+    mObjects.at(id - 1) = std::move(body);
+  }
+
+  ObjectID Add(std::string body) {
+    const auto id = this->Reserve();
+    this->Set(id, std::move(body));
+    return id;
+  }
+
+  std::string Build(ObjectID root) const {
+    std::string out = "%PDF-1.7\n";
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < mObjects.size(); ++i) {
+      offsets.push_back(out.size());
+      out += std::format("{} 0 obj\n{}\nendobj\n", i + 1, mObjects.at(i));
+    }
+    const auto xref = out.size();
+    out += std::format(
+      "xref\n0 {}\n0000000000 65535 f \n", mObjects.size() + 1);
+    for (const auto offset: offsets) {
+      out += std::format("{:010} 00000 n \n", offset);
+    }
+    out += std::format(
+      "trailer\n<< /Size {} /Root {} 0 R >>\nstartxref\n{}\n%%EOF\n",
+      mObjects.size() + 1,
+      root,
+      xref);
+    return out;
+  }
+
+ private:
+  std::vector<std::string> mObjects;
+};
+
+struct Document {
+  PDFBuilder mBuilder;
+  PDFBuilder::ObjectID mCatalog {};
+  PDFBuilder::ObjectID mPagesRoot {};
+  std::vector<PDFBuilder::ObjectID> mPages;
+};
+
+/** Creates a document with `pageCount` pages; `annotations(doc, i)` returns
+ * the contents of page i's /Annots array. */
+template <class F>
+Document CreateDocument(size_t pageCount, F&& annotations) {
+  Document doc;
+  auto& b = doc.mBuilder;
+  doc.mCatalog = b.Reserve();
+  doc.mPagesRoot = b.Reserve();
+  for (size_t i = 0; i < pageCount; ++i) {
+    doc.mPages.push_back(b.Reserve());
+  }
+
+  std::string kids;
+  for (size_t i = 0; i < pageCount; ++i) {
+    kids += std::format("{} 0 R ", doc.mPages.at(i));
+    b.Set(
+      doc.mPages.at(i),
+      std::format(
+        "<< /Type /Page /Parent {} 0 R /MediaBox [0 0 612 792] /Annots [{}] "
+        ">>",
+        doc.mPagesRoot,
+        annotations(doc, i)));
+  }
+  b.Set(
+    doc.mPagesRoot,
+    std::format(
+      "<< /Type /Pages /Kids [{}] /Count {} >>", kids, pageCount));
+  return doc;
+}
+
+std::string PageLink(const Document& doc, size_t target, size_t n) {
+  const auto x = 20 + (n % 10) * 55;
+  const auto y = 20 + (n / 10) * 30;
+  return std::format(
+    "<< /Type /Annot /Subtype /Link /Rect [{} {} {} {}] /Dest [{} 0 R /Fit] "
+    ">> ",
+    x,
+    y,
+    x + 50,
+    y + 20,
+    doc.mPages.at(target));
+}
+
+std::string URILink(size_t n) {
+  return std::format(
+    "<< /Type /Annot /Subtype /Link /Rect [10 {} 100 {}] /A << /S /URI "
+    "/URI (https://example.com/{}) >> >> ",
+    n,
+    n + 10,
+    n);
+}
+
+void SetCatalog(Document& doc, std::string_view extra = {}) {
+  doc.mBuilder.Set(
+    doc.mCatalog,
+    std::format(
+      "<< /Type /Catalog /Pages {} 0 R {} >>", doc.mPagesRoot, extra));
+}
+
+std::string ManyLinks() {
+  constexpr size_t PageCount = 500;
+  constexpr size_t LinksPerPage = 40;
+  std::mt19937 rng(1);
+  auto doc = CreateDocument(PageCount, [&](const Document& doc, size_t) {
+    std::string annots;
+    for (size_t i = 0; i < LinksPerPage; ++i) {
+      annots += (i % 8 == 7) ? URILink(i) : PageLink(doc, rng() % PageCount, i);
+    }
+    return annots;
+  });
+  SetCatalog(doc);
+  return doc.mBuilder.Build(doc.mCatalog);
+}
+
+/// `extra` is usually /First, /Last, /Next etc
+std::string OutlineItem(
+  const Document& doc,
+  std::string_view title,
+  size_t page,
+  PDFBuilder::ObjectID parent,
+  std::string_view extra) {
+  return std::format(
+    "<< /Title ({}) /Parent {} 0 R /Dest [{} 0 R /Fit] {} >>",
+    title,
+    parent,
+    doc.mPages.at(page),
+    extra);
+}
+
+std::string DeepOutline() {
+  constexpr size_t PageCount = 50;
+  constexpr size_t Depth = 2000;
+  auto doc = CreateDocument(PageCount, [](auto&, auto) { return ""; });
+  auto& b = doc.mBuilder;
+  const auto outlines = b.Reserve();
+  std::vector<PDFBuilder::ObjectID> items;
+  for (size_t i = 0; i < Depth; ++i) {
+    items.push_back(b.Reserve());
+  }
+  for (size_t i = 0; i < Depth; ++i) {
+    const auto parent = (i == 0) ? outlines : items.at(i - 1);
+    const auto kids = (i + 1 < Depth)
+      ? std::format(
+          "/First {0} 0 R /Last {0} 0 R /Count 1", items.at(i + 1))
+      : std::string {};
+    b.Set(
+      items.at(i),
+      OutlineItem(
+        doc, std::format("Level {}", i), i % PageCount, parent, kids));
+  }
+  b.Set(
+    outlines,
+    std::format(
+      "<< /Type /Outlines /First {0} 0 R /Last {0} 0 R /Count 1 >>",
+      items.front()));
+  SetCatalog(doc, std::format("/Outlines {} 0 R", outlines));
+  return b.Build(doc.mCatalog);
+}
+
+std::string WideOutline() {
+  constexpr size_t PageCount = 1000;
+  constexpr size_t Count = 10000;
+  auto doc = CreateDocument(PageCount, [](auto&, auto) { return ""; });
+  auto& b = doc.mBuilder;
+  const auto outlines = b.Reserve();
+  std::vector<PDFBuilder::ObjectID> items;
+  for (size_t i = 0; i < Count; ++i) {
+    items.push_back(b.Reserve());
+  }
+  for (size_t i = 0; i < Count; ++i) {
+    std::string siblings;
+    if (i > 0) {
+      siblings += std::format("/Prev {} 0 R ", items.at(i - 1));
+    }
+    if (i + 1 < Count) {
+      siblings += std::format("/Next {} 0 R", items.at(i + 1));
+    }
+    b.Set(
+      items.at(i),
+      OutlineItem(
+        doc, std::format("Item {}", i), i % PageCount, outlines, siblings));
+  }
+  b.Set(
+    outlines,
+    std::format(
+      "<< /Type /Outlines /First {} 0 R /Last {} 0 R /Count {} >>",
+      items.front(),
+      items.back(),
+      Count));
+  SetCatalog(doc, std::format("/Outlines {} 0 R", outlines));
+  return b.Build(doc.mCatalog);
+}
+
+std::string CyclicOutline() {
+  constexpr size_t PageCount = 10;
+  constexpr size_t Count = 8;
+  auto doc = CreateDocument(PageCount, [](auto&, auto) { return ""; });
+  auto& b = doc.mBuilder;
+  const auto outlines = b.Reserve();
+  std::vector<PDFBuilder::ObjectID> items;
+  for (size_t i = 0; i < Count; ++i) {
+    items.push_back(b.Reserve());
+  }
+  // Every item's siblings loop back to the start, and every item's first
+  // child is the first top-level item
+  for (size_t i = 0; i < Count; ++i) {
+    b.Set(
+      items.at(i),
+      OutlineItem(
+        doc,
+        std::format("Cycle {}", i),
+        i % PageCount,
+        outlines,
+        std::format(
+          "/Next {0} 0 R /First {1} 0 R /Last {1} 0 R /Count {2}",
+          items.at((i + 1) % Count),
+          items.front(),
+          Count)));
+  }
+  b.Set(
+    outlines,
+    std::format(
+      "<< /Type /Outlines /First {} 0 R /Last {} 0 R /Count {} >>",
+      items.front(),
+      items.back(),
+      Count));
+  SetCatalog(doc, std::format("/Outlines {} 0 R", outlines));
+  return b.Build(doc.mCatalog);
+}
+
+std::string BrokenDestinations() {
+  constexpr size_t PageCount = 20;
+  auto doc = CreateDocument(PageCount, [](const Document& doc, size_t page) {
+    return std::format(
+      // Destination isn't a page
+      "<< /Subtype /Link /Rect [0 0 10 10] /Dest [{0} 0 R /Fit] >> "
+      // Destination isn't an array
+      "<< /Subtype /Link /Rect [0 0 10 10] /Dest 42 >> "
+      // Empty destination
+      "<< /Subtype /Link /Rect [0 0 10 10] /Dest [] >> "
+      // Missing named destination
+      "<< /Subtype /Link /Rect [0 0 10 10] /A << /S /GoTo /D (nope) >> >> "
+      // Unsupported action
+      "<< /Subtype /Link /Rect [0 0 10 10] /A << /S /Launch /F (x) >> >> "
+      // URI isn't a string
+      "<< /Subtype /Link /Rect [0 0 10 10] /A << /S /URI /URI 7 >> >> "
+      // Missing or malformed rectangles
+      "<< /Subtype /Link /Dest [{1} 0 R /Fit] >> "
+      "<< /Subtype /Link /Rect [1 2] /Dest [{1} 0 R /Fit] >> "
+      // Dangling reference
+      "<< /Subtype /Link /Rect [0 0 10 10] /Dest [99999 0 R /Fit] >> "
+      // And one that's fine
+      "<< /Subtype /Link /Rect [0 0 10 10] /Dest [{1} 0 R /Fit] >> ",
+      doc.mCatalog,
+      doc.mPages.at((page + 1) % doc.mPages.size()));
+  });
+  SetCatalog(doc);
+  return doc.mBuilder.Build(doc.mCatalog);
+}
+
+/// A page of text, like a frequency card
+std::string Text() {
+  PDFBuilder b;
+  const auto catalog = b.Reserve();
+  const auto pages = b.Reserve();
+  const auto page = b.Reserve();
+  constexpr std::string_view Content
+    = "BT /F1 12 Tf 72 700 Td (Hello world) Tj 0 -20 Td (ATIS 127.5) Tj ET";
+  const auto content = b.Add(std::format(
+    "<< /Length {} >>\nstream\n{}\nendstream", Content.size(), Content));
+  const auto font = b.Add(
+    "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+  b.Set(
+    page,
+    std::format(
+      "<< /Type /Page /Parent {} 0 R /MediaBox [0 0 612 792] /Contents {} 0 "
+      "R /Resources << /Font << /F1 {} 0 R >> >> >>",
+      pages,
+      content,
+      font));
+  b.Set(pages, std::format("<< /Type /Pages /Kids [{} 0 R] /Count 1 >>", page));
+  b.Set(catalog, std::format("<< /Type /Catalog /Pages {} 0 R >>", pages));
+  return b.Build(catalog);
+}
+
+void WriteFile(const std::filesystem::path& path, std::string_view content) {
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  f.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+int Generate(const std::filesystem::path& directory) {
+  std::filesystem::create_directories(directory);
+  const std::pair<const char*, std::string (*)()> generators[] {
+    {"many-links.pdf", &ManyLinks},
+    {"deep-outline.pdf", &DeepOutline},
+    {"wide-outline.pdf", &WideOutline},
+    {"cyclic-outline.pdf", &CyclicOutline},
+    {"broken-destinations.pdf", &BrokenDestinations},
+    {"text.pdf", &Text},
+  };
+  for (const auto& [name, generator]: generators) {
+    const auto path = directory / name;
+    WriteFile(path, generator());
+    std::cout << std::format(
+      "Wrote {} ({} bytes)\n",
+      ToUTF8(path),
+      std::filesystem::file_size(path));
+  }
+  return 0;
+}
+
+struct Result {
+  double mOpenMS {};
+  double mFirstLinkMS {};
+  double mBookmarksMS {};
+  double mLinksMS {};
+  size_t mBookmarkCount {};
+  size_t mLinkCount {};
+  PageIndex mPageCount {};
+};
+
+Result Measure(
+  const std::filesystem::path& path,
+  std::span<const std::byte> content) {
+  Result ret;
+  const auto start = Clock::now();
+  PDF pdf(path, content);
+  ret.mOpenMS = MillisecondsSince(start);
+  ret.mPageCount = pdf.GetPageCount();
+
+  // Includes opening the file
+  pdf.GetLinks(0);
+  ret.mFirstLinkMS = MillisecondsSince(start);
+
+  auto t = Clock::now();
+  ret.mBookmarkCount = pdf.GetBookmarks().size();
+  ret.mBookmarksMS = MillisecondsSince(t);
+
+  t = Clock::now();
+  for (const auto& page: pdf.GetLinks()) {
+    ret.mLinkCount += page.size();
+  }
+  ret.mLinksMS = MillisecondsSince(t);
+  return ret;
+}
+
+std::vector<std::byte> ReadFile(const std::filesystem::path& path) {
+  std::ifstream f(path, std::ios::binary);
+  std::vector<std::byte> ret(std::filesystem::file_size(path));
+  f.read(
+    reinterpret_cast<char*>(ret.data()),
+    static_cast<std::streamsize>(ret.size()));
+  return ret;
+}
+
+int Benchmark(std::span<char* const> args) {
+  for (const std::filesystem::path path: args) {
+    const auto content = ReadFile(path);
+    const auto r = Measure(path, content);
+    std::cout << std::format(
+      "{}: {} pages, {} bookmarks, {} links\n"
+      "  open {:.2f}ms, first link {:.2f}ms, bookmarks {:.2f}ms, all links "
+      "{:.2f}ms\n"
+      "  peak memory so far: {:.1f}MiB\n",
+      ToUTF8(path.filename()),
+      r.mPageCount,
+      r.mBookmarkCount,
+      r.mLinkCount,
+      r.mOpenMS,
+      r.mFirstLinkMS,
+      r.mBookmarksMS,
+      r.mLinksMS,
+      GetPeakMemoryBytes() / (1024.0 * 1024.0));
+  }
+  return 0;
+}
+
+void Mutate(std::vector<std::byte>& buffer, std::mt19937& rng) {
+  static constexpr std::string_view Tokens[] {
+    " obj ", " R ", "<<", ">>", "[", "]", "/Dest", "/First", "/Next",
+    "/Kids", "/Count -1", "endobj", "stream", "99999 0 R", "/Annots",
+  };
+  if (buffer.empty()) {
+    return;
+  }
+  switch (rng() % 4) {
+    case 0:
+      for (int i = rng() % 8; i >= 0; --i) {
+        buffer.at(rng() % buffer.size()) = static_cast<std::byte>(rng());
+      }
+      return;
+    case 1:
+      buffer.resize(rng() % buffer.size());
+      return;
+    case 2: {
+      const auto token = Tokens[rng() % std::size(Tokens)];
+      const auto at = buffer.begin() + (rng() % buffer.size());
+      const auto begin = reinterpret_cast<const std::byte*>(token.data());
+      buffer.insert(at, begin, begin + token.size());
+      return;
+    }
+    case 3: {
+      // Duplicate a chunk somewhere else; good at making reference loops
+      const auto from = rng() % buffer.size();
+      const auto size = std::min<size_t>(rng() % 256, buffer.size() - from);
+      const std::vector<std::byte> chunk(
+        buffer.begin() + from, buffer.begin() + from + size);
+      buffer.insert(
+        buffer.begin() + (rng() % buffer.size()), chunk.begin(), chunk.end());
+      return;
+    }
+  }
+}
+
+int Fuzz(
+  const std::filesystem::path& seedFile,
+  size_t iterations,
+  uint32_t seed) {
+  const auto original = ReadFile(seedFile);
+  std::mt19937 rng(seed);
+
+  double slowestMS {};
+  std::vector<std::byte> slowest;
+  size_t escaped {};
+
+  for (size_t i = 0; i < iterations; ++i) {
+    auto buffer = original;
+    for (int j = rng() % 4; j >= 0; --j) {
+      Mutate(buffer, rng);
+    }
+
+    const auto start = Clock::now();
+    try {
+      Measure(seedFile, buffer);
+    } catch (const std::exception& e) {
+      ++escaped;
+      std::cout << std::format(
+        "Iteration {}: exception escaped: {}\n", i, e.what());
+    }
+    const auto elapsed = MillisecondsSince(start);
+    if (elapsed > slowestMS) {
+      slowestMS = elapsed;
+      slowest = std::move(buffer);
+    }
+  }
+
+  const auto slowestPath = std::filesystem::path(seedFile).replace_extension(
+    ".slowest.pdf");
+  WriteFile(
+    slowestPath,
+    {reinterpret_cast<const char*>(slowest.data()), slowest.size()});
+  std::cout << std::format(
+    "{} iterations, {} escaped exceptions; slowest {:.2f}ms (saved to {}); "
+    "peak memory {:.1f}MiB\n",
+    iterations,
+    escaped,
+    slowestMS,
+    ToUTF8(slowestPath),
+    GetPeakMemoryBytes() / (1024.0 * 1024.0));
+  return escaped ? 1 : 0;
+}
+
+std::span<const std::byte> AsBytes(std::string_view content) {
+  return {reinterpret_cast<const std::byte*>(content.data()), content.size()};
+}
+
+bool IsNormalized(const Rect& rect) {
+  return rect.left >= 0 && rect.left < rect.right && rect.right <= 1
+    && rect.top >= 0 && rect.top < rect.bottom && rect.bottom <= 1;
+}
+
+void VerifyLinks(Checks& check) {
+  const auto content = ManyLinks();
+  PDF pdf("many-links.pdf", AsBytes(content));
+  check(pdf.GetPageCount() == 500, "many links: page count");
+
+  // Ask for single pages before and during the full pass, like the app does
+  // while the background extraction is running
+  const auto first = pdf.GetLinks(0);
+  std::vector<std::vector<Link>> perPage(pdf.GetPageCount());
+  std::vector<std::vector<Link>> all;
+  {
+    std::jthread everything([&] { all = pdf.GetLinks(); });
+    std::vector<std::jthread> readers;
+    for (PageIndex offset = 0; offset < 4; ++offset) {
+      readers.emplace_back([&, offset] {
+        for (PageIndex i = offset; i < perPage.size(); i += 4) {
+          perPage.at(i) = pdf.GetLinks(i);
+        }
+      });
+    }
+  }
+  check(
+    all.size() == pdf.GetPageCount() && all.front() == first && all == perPage,
+    "many links: concurrent single-page and full extraction agree");
+  pdf.PrefetchLinks(10, 5);
+  check(pdf.GetLinks(12) == all.at(12), "many links: prefetch");
+
+  size_t linkCount = 0;
+  size_t uriCount = 0;
+  bool valid = true;
+  for (const auto& page: all) {
+    linkCount += page.size();
+    for (size_t i = 0; i < page.size(); ++i) {
+      const auto& [rect, dest] = page.at(i);
+      valid = valid && IsNormalized(rect);
+      if (dest.mType == DestinationType::URI) {
+        ++uriCount;
+        valid = valid && dest.mURI == std::format("https://example.com/{}", i);
+      } else {
+        valid = valid && dest.mPageIndex < pdf.GetPageCount();
+      }
+    }
+  }
+  check(linkCount == 500 * 40, "many links: every link is found");
+  check(uriCount == 500 * 5, "many links: URI links");
+  check(valid, "many links: rectangles, pages, and URIs");
+
+  {
+    const auto& link = all.front().front();
+    // Bottom-left origin in the PDF, top-left origin for us
+    constexpr Rect Expected {
+      20.0f / 612, 1 - (40.0f / 792), 70.0f / 612, 1 - (20.0f / 792)};
+    const auto near = [](float a, float b) { return std::abs(a - b) < 1e-5f; };
+    check(
+      near(link.mRect.left, Expected.left) && near(link.mRect.top, Expected.top)
+        && near(link.mRect.right, Expected.right)
+        && near(link.mRect.bottom, Expected.bottom),
+      "many links: coordinates are converted to a top-left origin");
+  }
+
+  {
+    const auto path = std::filesystem::temp_directory_path()
+      / "pdf-navigation-benchmark-verify.pdf";
+    WriteFile(path, content);
+    auto snapshot = FileSnapshot::Read(path);
+    std::filesystem::remove(path);
+    check(snapshot != nullptr, "snapshot: read");
+    if (snapshot) {
+      PDF fromSnapshot(std::move(snapshot));
+      check(
+        fromSnapshot.GetLinks() == all,
+        "snapshot: same links, after the file is gone");
+    }
+  }
+}
+
+void VerifyBookmarks(Checks& check) {
+  {
+    const auto content = WideOutline();
+    PDF pdf("wide-outline.pdf", AsBytes(content));
+    const auto bookmarks = pdf.GetBookmarks();
+    bool inOrder = bookmarks.size() == 10000;
+    for (size_t i = 0; inOrder && i < bookmarks.size(); ++i) {
+      inOrder = bookmarks.at(i).mName == std::format("Item {}", i)
+        && bookmarks.at(i).mPageIndex == i % 1000;
+    }
+    check(inOrder, "wide outline: every bookmark, in order");
+  }
+
+  {
+    const auto content = DeepOutline();
+    PDF pdf("deep-outline.pdf", AsBytes(content));
+    // Only followed so deep; we just need the top, and no crash
+    const auto bookmarks = pdf.GetBookmarks();
+    check(
+      !bookmarks.empty() && bookmarks.size() <= 2000
+        && bookmarks.front().mName == "Level 0",
+      std::format("deep outline: {} bookmarks", bookmarks.size()));
+  }
+
+  {
+    const auto content = CyclicOutline();
+    PDF pdf("cyclic-outline.pdf", AsBytes(content));
+    auto bookmarks = pdf.GetBookmarks();
+    const auto count = bookmarks.size();
+    std::ranges::sort(bookmarks);
+    check(
+      count == 8 && std::ranges::adjacent_find(bookmarks) == bookmarks.end(),
+      std::format("cyclic outline: each item once ({} bookmarks)", count));
+  }
+}
+
+void VerifyBrokenDestinations(Checks& check) {
+  const auto content = BrokenDestinations();
+  PDF pdf("broken-destinations.pdf", AsBytes(content));
+  const auto pageCount = pdf.GetPageCount();
+  const auto all = pdf.GetLinks();
+
+  // Links without a usable rectangle may or may not be kept, depending on
+  // how QPDF reads them, but they must still go to the right page
+  bool valid = all.size() == pageCount;
+  bool keptGood = true;
+  for (PageIndex i = 0; valid && i < all.size(); ++i) {
+    const auto next = (i + 1) % pageCount;
+    size_t good = 0;
+    for (const auto& [rect, dest]: all.at(i)) {
+      if (dest.mType == DestinationType::URI) {
+        // `/URI 7`
+        valid = valid && dest.mURI.empty();
+        continue;
+      }
+      valid = valid && dest.mPageIndex == next;
+      if (IsNormalized(rect)) {
+        ++good;
+      }
+    }
+    keptGood = keptGood && good == 1;
+  }
+  check(valid, "broken destinations: no bogus links");
+  check(keptGood, "broken destinations: the valid link on each page is kept");
+}
+
+void VerifyText(Checks& check) {
+  const auto content = Text();
+  PDF pdf("text.pdf", AsBytes(content));
+  const auto lines = pdf.GetText(0);
+  check(
+    lines.size() == 2 && lines.at(0).mText == "Hello world"
+      && lines.at(1).mText == "ATIS 127.5",
+    "text: lines");
+  check(
+    lines.size() == 2 && IsNormalized(lines.at(0).mRect)
+      && std::abs(lines.at(0).mRect.left - (72.0f / 612)) < 1e-5f
+      && lines.at(0).mRect.bottom < lines.at(1).mRect.top,
+    "text: positions");
+}
+
+void VerifyLogger(Checks& check) {
+  std::vector<std::string> messages;
+  PDF pdf(
+    "not-a-pdf.pdf",
+    AsBytes("not a PDF"),
+    [&messages](std::string_view message) { messages.emplace_back(message); });
+  check(
+    pdf.GetPageCount() == 0
+      && std::ranges::any_of(
+        messages,
+        [](const auto& it) { return it.starts_with("Failed to load PDF"); }),
+    "diagnostics go to the logger");
+  check(
+    PDF("not-a-pdf.pdf", AsBytes("not a PDF")).GetPageCount() == 0,
+    "diagnostics can be ignored");
+}
+
+/// A few hundred fixed mutations; `fuzz` is for longer runs
+void VerifyFuzz(Checks& check) {
+  std::mt19937 rng(1);
+  size_t escaped = 0;
+  size_t iterations = 0;
+  for (const auto generator: {&BrokenDestinations, &CyclicOutline, &Text}) {
+    const auto content = generator();
+    const auto original = AsBytes(content);
+    for (size_t i = 0; i < 100; ++i, ++iterations) {
+      std::vector<std::byte> buffer(original.begin(), original.end());
+      for (int j = rng() % 4; j >= 0; --j) {
+        Mutate(buffer, rng);
+      }
+      try {
+        Measure("fuzz.pdf", buffer);
+      } catch (const std::exception&) {
+        ++escaped;
+      }
+    }
+  }
+  check(
+    escaped == 0,
+    std::format(
+      "fuzz: {} of {} mutations threw out of PDF", escaped, iterations));
+}
+
+int Verify() {
+  Checks check;
+  VerifyLinks(check);
+  VerifyBookmarks(check);
+  VerifyBrokenDestinations(check);
+  VerifyText(check);
+  VerifyLogger(check);
+  VerifyFuzz(check);
+  return check.GetExitCode();
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "generate",
+        .mUsage = "DIRECTORY",
+        .mMinArguments = 1,
+        .mMaxArguments = 1,
+        .mRun = [](auto arguments) { return Generate(arguments[0]); },
+      },
+      {
+        .mName = "bench",
+        .mUsage = "FILE...",
+        .mMinArguments = 1,
+        .mMaxArguments = std::numeric_limits<size_t>::max(),
+        .mRun = [](auto arguments) { return Benchmark(arguments); },
+      },
+      {
+        .mName = "fuzz",
+        .mUsage = "SEED_FILE ITERATIONS [RANDOM_SEED]",
+        .mMinArguments = 2,
+        .mMaxArguments = 3,
+        .mRun =
+          [](auto arguments) {
+            return Fuzz(
+              arguments[0],
+              std::stoull(arguments[1]),
+              (arguments.size() == 3) ? std::stoul(arguments[2])
+                                      : std::random_device {}());
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
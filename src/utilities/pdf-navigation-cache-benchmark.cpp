@@ -0,0 +1,509 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks `PDFNavigation::NavigationCache` - round trips, keying, truncated or
+// corrupted entries, hostile counts, pruning, and concurrent writers and
+// readers - then measures serializing, storing, and warm-loading navigation
+// for documents of various sizes. Only depends on the standard library, so it
+// can also be built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/PDFNavigationCache.h>
+
+#include <shims/filesystem>
+
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+using namespace OpenKneeboard::PDFNavigation;
+
+namespace {
+
+std::filesystem::path GetScratchPath(std::string_view name) {
+  return std::filesystem::temp_directory_path()
+    / std::format("pdf-navigation-cache-benchmark-{}", name);
+}
+
+FileIdentity MakeIdentity(uint64_t seed) {
+  return {
+    .mSize = 100'000 + seed,
+    .mLastWriteTime = std::filesystem::file_time_type::clock::now(),
+    .mContentHash = 0x9e3779b97f4a7c15 * (seed + 1),
+  };
+}
+
+/// Roughly like a checklist or chart book: a table of contents linking to
+/// every section, and cross-references
+Navigation MakeNavigation(PageIndex pageCount, uint32_t seed) {
+  std::minstd_rand random {seed};
+  Navigation ret;
+  for (PageIndex i = 0; i < pageCount; i += 4) {
+    ret.mBookmarks.push_back({
+      std::format("Section {} — été {}", i / 4, random() % 100),
+      i,
+    });
+  }
+  ret.mLinks.resize(pageCount);
+  for (PageIndex page = 0; page < pageCount; ++page) {
+    const auto linkCount = (page == 0) ? ret.mBookmarks.size() : random() % 6;
+    for (size_t i = 0; i < linkCount; ++i) {
+      const auto top = static_cast<float>(random() % 1000) / 1000.0f;
+      Link link {
+        .mRect = {0.1f, top, 0.9f, top + 0.02f},
+        .mDestination = {.mType = DestinationType::Page},
+      };
+      if (random() % 4 == 0) {
+        link.mDestination.mType = DestinationType::URI;
+        link.mDestination.mURI
+          = std::format("https://example.com/charts/{}", random());
+      } else {
+        link.mDestination.mPageIndex
+          = static_cast<PageIndex>(random() % pageCount);
+      }
+      ret.mLinks.at(page).push_back(std::move(link));
+    }
+  }
+  return ret;
+}
+
+/// A header that passes every check, in front of an arbitrary payload
+std::vector<std::byte> MakeEntry(
+  const FileIdentity& identity,
+  std::span<const std::byte> payload) {
+  std::vector<std::byte> ret;
+  const auto append = [&ret](uint64_t value, size_t byteCount) {
+    for (size_t i = 0; i < byteCount; ++i) {
+      ret.push_back(static_cast<std::byte>(value >> (i * 8)));
+    }
+  };
+  for (const auto c: NavigationCache::Magic) {
+    append(static_cast<uint8_t>(c), 1);
+  }
+  append(NavigationCache::Version, 4);
+  append(identity.mSize, 8);
+  append(identity.mContentHash, 8);
+  append(payload.size(), 8);
+  append(HashFileContent(payload), 8);
+  ret.insert(ret.end(), payload.begin(), payload.end());
+  return ret;
+}
+
+void WriteFile(
+  const std::filesystem::path& path,
+  std::span<const std::byte> bytes) {
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  f.write(
+    reinterpret_cast<const char*>(bytes.data()),
+    static_cast<std::streamsize>(bytes.size()));
+}
+
+size_t CountFiles(
+  const std::filesystem::path& directory,
+  std::string_view extension) {
+  size_t count = 0;
+  for (const auto& it: std::filesystem::directory_iterator(directory)) {
+    if (it.path().extension() == extension) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+void VerifySerialization(Checks& check) {
+  const auto identity = MakeIdentity(1);
+  const auto navigation = MakeNavigation(40, 1);
+  const auto bytes = NavigationCache::Serialize(identity, navigation);
+
+  check(
+    NavigationCache::Deserialize(bytes, identity) == navigation,
+    "serialize round trip");
+  check(
+    NavigationCache::Deserialize(
+      NavigationCache::Serialize(identity, {}), identity)
+      == Navigation {},
+    "empty navigation round trip");
+  {
+    // Links are compared bitwise, so this also checks that odd floats - and
+    // pages without links - survive
+    Navigation odd {
+      .mBookmarks = {{"", 0}, {std::string(1000, 'x'), 3}},
+      .mLinks = {
+        {},
+        {{
+          .mRect = {
+            -0.0f,
+            std::numeric_limits<float>::denorm_min(),
+            std::numeric_limits<float>::infinity(),
+            std::numeric_limits<float>::quiet_NaN(),
+          },
+          .mDestination = {.mType = DestinationType::URI, .mURI = ""},
+        }},
+        {},
+      },
+    };
+    check(
+      NavigationCache::Deserialize(
+        NavigationCache::Serialize(identity, odd), identity)
+        == odd,
+      "unusual values round trip");
+  }
+
+  {
+    auto other = identity;
+    other.mSize += 1;
+    check(
+      !NavigationCache::Deserialize(bytes, other), "different size misses");
+    other = identity;
+    other.mContentHash += 1;
+    check(
+      !NavigationCache::Deserialize(bytes, other),
+      "different content hash misses");
+    other = identity;
+    other.mLastWriteTime += std::chrono::hours(1);
+    check(
+      NavigationCache::Deserialize(bytes, other) == navigation,
+      "modification time doesn't matter");
+  }
+
+  {
+    size_t accepted = 0;
+    for (size_t size = 0; size < bytes.size(); ++size) {
+      if (NavigationCache::Deserialize(
+            std::span {bytes}.subspan(0, size), identity)) {
+        ++accepted;
+      }
+    }
+    check(
+      accepted == 0,
+      std::format("all {} truncations are rejected", bytes.size()));
+
+    auto extended = bytes;
+    extended.push_back(std::byte {0});
+    check(
+      !NavigationCache::Deserialize(extended, identity),
+      "trailing bytes are rejected");
+  }
+
+  {
+    // Every single-byte change is in a checked header field, or is caught by
+    // the payload hash
+    size_t accepted = 0;
+    auto flipped = bytes;
+    for (size_t i = 0; i < flipped.size(); ++i) {
+      for (const auto mask: {0x01, 0x80, 0xff}) {
+        flipped[i] ^= static_cast<std::byte>(mask);
+        if (NavigationCache::Deserialize(flipped, identity)) {
+          ++accepted;
+        }
+        flipped[i] ^= static_cast<std::byte>(mask);
+      }
+    }
+    check(
+      accepted == 0,
+      std::format("all {} byte flips are rejected", bytes.size() * 3));
+  }
+
+  {
+    // Valid header and payload hash, but a payload we didn't write; e.g. a
+    // future version that forgot to bump `Version`
+    const auto hostile = [&identity](std::vector<uint32_t> words) {
+      std::vector<std::byte> payload;
+      for (const auto word: words) {
+        for (int i = 0; i < 4; ++i) {
+          payload.push_back(static_cast<std::byte>(word >> (i * 8)));
+        }
+      }
+      return !NavigationCache::Deserialize(
+        MakeEntry(identity, payload), identity);
+    };
+    check(hostile({0xffffffff}), "huge bookmark count is rejected");
+    check(hostile({0, 0xffffffff}), "huge page count is rejected");
+    check(hostile({0, 1, 0xffffffff}), "huge link count is rejected");
+    check(hostile({1, 0xffffffff, 0, 0}), "huge name length is rejected");
+    check(!hostile({0, 0}), "hand-written minimal entry is accepted");
+
+    // No bookmarks, one page with one link; the type follows the counts and
+    // the rectangle
+    constexpr size_t TypeOffset = (3 * 4) + (4 * 4);
+    const Navigation oneLink {.mLinks = {{Link {}}}};
+    const auto valid = NavigationCache::Serialize(identity, oneLink);
+    std::vector<std::byte> payload(
+      valid.begin() + NavigationCache::HeaderSize, valid.end());
+    payload.at(TypeOffset) = std::byte {0x7f};
+    check(
+      !NavigationCache::Deserialize(MakeEntry(identity, payload), identity),
+      "unknown destination type is rejected");
+  }
+}
+
+void VerifyStorage(Checks& check) {
+  const auto directory = GetScratchPath("verify");
+  std::filesystem::remove_all(directory);
+
+  const auto identity = MakeIdentity(1);
+  const auto navigation = MakeNavigation(40, 1);
+  NavigationCache cache(directory);
+
+  check(!cache.Load(identity), "empty cache misses");
+  check(cache.Store(identity, navigation), "store");
+  check(cache.Load(identity) == navigation, "load");
+  check(
+    NavigationCache(directory).Load(identity) == navigation,
+    "load from another instance");
+  check(CountFiles(directory, ".tmp") == 0, "no temporary files left");
+  check(
+    cache.GetEntryPath(identity) != cache.GetEntryPath(MakeIdentity(2)),
+    "different content has a different entry");
+  check(!cache.Load(MakeIdentity(2)), "different content misses");
+
+  {
+    const auto path = cache.GetEntryPath(identity);
+    auto bytes = NavigationCache::Serialize(identity, navigation);
+    bytes.at(bytes.size() / 2) ^= std::byte {0x10};
+    WriteFile(path, bytes);
+    check(!cache.Load(identity), "corrupt entry on disk misses");
+    bytes.resize(bytes.size() / 2);
+    WriteFile(path, bytes);
+    check(!cache.Load(identity), "truncated entry on disk misses");
+    check(cache.Store(identity, navigation), "store over corrupt entry");
+    check(cache.Load(identity) == navigation, "load after re-storing");
+  }
+
+  {
+    std::filesystem::remove_all(directory);
+    const auto start = std::filesystem::file_time_type::clock::now();
+    constexpr auto Count = NavigationCache::MaxEntries;
+    for (uint64_t i = 0; i < Count; ++i) {
+      const auto it = MakeIdentity(100 + i);
+      cache.Store(it, navigation);
+      // Filesystem timestamps can be coarse; make the order unambiguous
+      std::filesystem::last_write_time(
+        cache.GetEntryPath(it), start - std::chrono::seconds(Count - i));
+    }
+    check(
+      CountFiles(directory, ".okpn") == Count, "nothing pruned until full");
+
+    // Makes the oldest entry the most recently used
+    const auto oldest = MakeIdentity(100);
+    check(
+      cache.Load(oldest).has_value()
+        && std::filesystem::last_write_time(cache.GetEntryPath(oldest))
+          >= start,
+      "load marks the entry as used");
+    for (uint64_t i = 0; i < 8; ++i) {
+      cache.Store(MakeIdentity(200 + i), navigation);
+    }
+    check(CountFiles(directory, ".okpn") == Count, "pruned to MaxEntries");
+    check(cache.Load(oldest).has_value(), "prune keeps recently used");
+    bool removed = true;
+    for (uint64_t i = 1; i <= 8; ++i) {
+      removed = removed
+        && !std::filesystem::exists(cache.GetEntryPath(MakeIdentity(100 + i)));
+    }
+    check(removed, "prune removes least recently used");
+    check(
+      cache.Load(MakeIdentity(200 + 7)).has_value(), "prune keeps new entries");
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+/// Several tabs or processes opening the same PDFs at once
+void VerifyConcurrency(Checks& check) {
+  const auto directory = GetScratchPath("concurrency");
+  std::filesystem::remove_all(directory);
+
+  constexpr uint64_t DocumentCount = 8;
+  std::vector<FileIdentity> identities;
+  std::vector<Navigation> navigations;
+  for (uint64_t i = 0; i < DocumentCount; ++i) {
+    identities.push_back(MakeIdentity(i));
+    navigations.push_back(MakeNavigation(50 + (i * 10), i));
+  }
+
+  std::atomic<size_t> stores {0}, failedStores {0};
+  std::atomic<size_t> hits {0}, misses {0}, wrong {0};
+  std::atomic<bool> writing {true};
+  {
+    std::vector<std::jthread> writers;
+    std::vector<std::jthread> readers;
+    for (int reader = 0; reader < 4; ++reader) {
+      readers.emplace_back([&, reader] {
+        NavigationCache cache(directory);
+        uint64_t i = reader;
+        while (writing) {
+          const auto index = i++ % DocumentCount;
+          const auto loaded = cache.Load(identities.at(index));
+          if (!loaded) {
+            ++misses;
+          } else if (*loaded == navigations.at(index)) {
+            ++hits;
+          } else {
+            ++wrong;
+          }
+        }
+      });
+    }
+    for (int writer = 0; writer < 4; ++writer) {
+      writers.emplace_back([&, writer] {
+        NavigationCache cache(directory);
+        for (int round = 0; round < 25; ++round) {
+          for (uint64_t i = 0; i < DocumentCount; ++i) {
+            const auto index = (i + writer) % DocumentCount;
+            if (cache.Store(identities.at(index), navigations.at(index))) {
+              ++stores;
+            } else {
+              ++failedStores;
+            }
+          }
+        }
+      });
+    }
+    writers.clear();
+    writing = false;
+  }
+
+  check(
+    wrong == 0,
+    std::format(
+      "concurrent readers never see another entry or a partial one ({} hits, "
+      "{} misses)",
+      hits.load(),
+      misses.load()));
+  check(
+    failedStores == 0,
+    std::format("concurrent stores succeed ({} stores)", stores.load()));
+  check(hits > 0, "concurrent readers get hits");
+  check(CountFiles(directory, ".tmp") == 0, "no temporary files left");
+
+  NavigationCache cache(directory);
+  bool allPresent = true;
+  for (uint64_t i = 0; i < DocumentCount; ++i) {
+    allPresent
+      = allPresent && cache.Load(identities.at(i)) == navigations.at(i);
+  }
+  check(allPresent, "every entry is intact afterwards");
+
+  std::filesystem::remove_all(directory);
+}
+
+int Verify() {
+  Checks check;
+  VerifySerialization(check);
+  VerifyStorage(check);
+  VerifyConcurrency(check);
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t iterations) {
+  const auto directory = GetScratchPath("bench");
+  std::filesystem::remove_all(directory);
+
+  std::cout << std::format(
+    "{:>8} {:>8} {:>10} {:>12} {:>12} {:>12}\n",
+    "pages",
+    "links",
+    "entry KiB",
+    "serialize",
+    "store",
+    "warm load");
+  uint64_t seed = 0;
+  for (const PageIndex pageCount: {10, 100, 1000, 10000}) {
+    const auto identity = MakeIdentity(seed);
+    const auto navigation
+      = MakeNavigation(pageCount, static_cast<uint32_t>(seed++));
+    size_t linkCount = 0;
+    for (const auto& page: navigation.mLinks) {
+      linkCount += page.size();
+    }
+
+    auto start = Clock::now();
+    size_t entrySize = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+      entrySize = NavigationCache::Serialize(identity, navigation).size();
+    }
+    const auto serializeMS = MillisecondsSince(start) / iterations;
+
+    NavigationCache cache(directory);
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      if (!cache.Store(identity, navigation)) {
+        std::cout << "Store failed\n";
+        return 1;
+      }
+    }
+    const auto storeMS = MillisecondsSince(start) / iterations;
+
+    // A new instance, like the next launch
+    NavigationCache warm(directory);
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      if (warm.Load(identity) != navigation) {
+        std::cout << "Load failed\n";
+        return 1;
+      }
+    }
+    const auto loadMS = MillisecondsSince(start) / iterations;
+
+    std::cout << std::format(
+      "{:>8} {:>8} {:>10.1f} {:>10.3f}ms {:>10.3f}ms {:>10.3f}ms\n",
+      pageCount,
+      linkCount,
+      entrySize / 1024.0,
+      serializeMS,
+      storeMS,
+      loadMS);
+  }
+
+  std::filesystem::remove_all(directory);
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[ITERATIONS]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 20 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
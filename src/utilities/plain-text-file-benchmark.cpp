@@ -0,0 +1,430 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks that `PlainTextFileReader` and `PlainTextLayout::AppendStream()`
+// produce the same pages as loading the whole file at once, including
+// while a file is being appended to, and measures loading and tailing
+// files from 1KB to 500MB. Only depends on the standard library, so it can
+// also be built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/PlainTextFileReader.h>
+#include <OpenKneeboard/PlainTextLayout.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+using Pages = std::vector<std::vector<std::string>>;
+
+std::filesystem::path GetScratchPath(std::string_view name) {
+  return std::filesystem::temp_directory_path()
+    / std::format("plain-text-file-benchmark-{}.txt", name);
+}
+
+// The previous `PlainTextFilePageSource::GetFileContent()` normalization;
+// quadratic, as every replacement moves the rest of the buffer
+std::string ReferenceNormalize(std::string buffer) {
+  size_t pos = 0;
+  while ((pos = buffer.find("\r\n", pos)) != std::string::npos) {
+    buffer.replace(pos, 2, "\n");
+    pos++;
+  }
+  return buffer;
+}
+
+Pages GetPages(const PlainTextLayout& layout) {
+  Pages pages;
+  for (size_t i = 0; i <= layout.GetCompletePageCount(); ++i) {
+    auto& page = pages.emplace_back();
+    for (const auto& line: layout.GetPageLines(i)) {
+      page.push_back(std::string {layout.GetText(line)});
+    }
+  }
+  return pages;
+}
+
+Pages LayoutAtOnce(std::string_view text) {
+  PlainTextLayout layout {40, 20};
+  layout.Append(text);
+  return GetPages(layout);
+}
+
+std::string RandomText(std::mt19937_64& rng, size_t size) {
+  static constexpr std::string_view Pieces[] {
+    "a", "b", "word", " ", " ", "  ", "\t", "\n", "\r\n", "\r", "\r\r\n",
+    "averyveryverylongwordthatdoesnotfitononeline", "\xc3\xa9",
+    // U+4E2D U+0301 U+1F600 U+2764 U+FE0F
+    "\xe4\xb8\xad", "\xcc\x81", "\xf0\x9f\x98\x80",
+    "\xe2\x9d\xa4\xef\xb8\x8f"};
+  std::uniform_int_distribution<size_t> piece(0, std::size(Pieces) - 1);
+  std::string text;
+  while (text.size() < size) {
+    text += Pieces[piece(rng)];
+  }
+  return text;
+}
+
+void WriteFile(
+  const std::filesystem::path& path,
+  std::string_view bytes,
+  bool append = false) {
+  std::ofstream f(
+    path,
+    std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+  f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+std::string EncodeUTF16(std::u32string_view text, bool bigEndian) {
+  std::string out {bigEndian ? "\xfe\xff" : "\xff\xfe"};
+  const auto unit = [&](char16_t u) {
+    const auto hi = static_cast<char>(u >> 8);
+    const auto lo = static_cast<char>(u & 0xff);
+    out += bigEndian ? hi : lo;
+    out += bigEndian ? lo : hi;
+  };
+  for (const auto cp: text) {
+    if (cp >= 0x10000) {
+      unit(static_cast<char16_t>(0xd800 + ((cp - 0x10000) >> 10)));
+      unit(static_cast<char16_t>(0xdc00 + ((cp - 0x10000) & 0x3ff)));
+    } else {
+      unit(static_cast<char16_t>(cp));
+    }
+  }
+  return out;
+}
+
+std::string MakeLogFile(size_t size) {
+  std::mt19937_64 rng {size};
+  std::string text;
+  text.reserve(size + 128);
+  size_t line = 0;
+  while (text.size() < size) {
+    text += std::format(
+      "{:08} INFO   subsystem{}: message with some detail, value={}\r\n",
+      line++,
+      rng() % 16,
+      rng() % 100000);
+  }
+  text.resize(size);
+  return text;
+}
+
+int Verify() {
+  Checks check;
+  std::mt19937_64 rng {1};
+
+  {
+    bool ok = true;
+    for (size_t i = 0; ok && i < 2000; ++i) {
+      auto text = RandomText(rng, rng() % 300);
+      // A leading BOM is intentionally handled differently
+      if (text.starts_with("\xef\xbb\xbf")) {
+        continue;
+      }
+      ok = (PlainTextFileReader::Decode(text) == ReferenceNormalize(text));
+    }
+    check(ok, "line endings match previous normalization");
+  }
+
+  check(
+    PlainTextFileReader::Decode("\xef\xbb\xbf" "a\r\nb") == "a\nb",
+    "UTF-8 BOM");
+  {
+    const std::u32string text {U"a\r\né中\U0001f600\r"};
+    const std::string expected {"a\n\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80\r"};
+    check(
+      PlainTextFileReader::Decode(EncodeUTF16(text, false)) == expected
+        && PlainTextFileReader::Decode(EncodeUTF16(text, true)) == expected,
+      "UTF-16");
+    constexpr std::string_view unpaired {"\xff\xfe\x00\xd8" "a\x00", 6};
+    check(
+      PlainTextFileReader::Decode(unpaired) == "\xef\xbf\xbd" "a",
+      "unpaired surrogate");
+  }
+
+  {
+    bool ok = true;
+    for (size_t i = 0; ok && i < 500; ++i) {
+      const auto text = ReferenceNormalize(RandomText(rng, rng() % 3000));
+      PlainTextLayout streamed {40, 20};
+      for (size_t offset = 0; offset < text.size();) {
+        const auto size = 1 + (rng() % 50);
+        streamed.AppendStream(std::string_view {text}.substr(offset, size));
+        offset += size;
+      }
+      ok = (GetPages(streamed) == LayoutAtOnce(text));
+    }
+    check(ok, "streamed layout matches layout at once");
+  }
+
+  const auto path = GetScratchPath("verify");
+  for (const std::string_view bom: {"", "\xef\xbb\xbf"}) {
+    WriteFile(path, bom);
+    PlainTextFileReader reader {path};
+    PlainTextLayout layout {40, 20};
+    std::string written {bom};
+    bool ok = true;
+    for (size_t i = 0; ok && i < 300; ++i) {
+      const auto chunk = RandomText(rng, rng() % 200);
+      WriteFile(path, chunk, /* append = */ true);
+      written += chunk;
+      const auto change = reader.Poll();
+      if (change != PlainTextFileReader::Change::Appended) {
+        ok = chunk.empty() && change == PlainTextFileReader::Change::None;
+        continue;
+      }
+      reader.Read(
+        [&layout](std::string_view text) { layout.AppendStream(text); });
+      // A trailing CR might be the start of CRLF, so it's held back
+      auto expected = PlainTextFileReader::Decode(written);
+      if (expected.ends_with('\r')) {
+        expected.pop_back();
+      }
+      ok = (GetPages(layout) == LayoutAtOnce(expected));
+    }
+    check(
+      ok,
+      bom.empty() ? "tailing a growing file" : "tailing a growing file, BOM");
+  }
+
+  {
+    WriteFile(path, "hello\nworld\n");
+    PlainTextFileReader reader {path};
+    reader.Poll();
+    reader.Read([](auto) {});
+    WriteFile(path, "HELLO\nworld\n");
+    const auto rewritten = reader.Poll();
+    std::string text;
+    reader.Read([&text](auto chunk) { text += chunk; });
+    WriteFile(path, "hi\n");
+    const auto truncated = reader.Poll();
+    const auto unchanged = (reader.Read([](auto) {}), reader.Poll());
+    check(
+      rewritten == PlainTextFileReader::Change::Replaced
+        && text == "HELLO\nworld\n"
+        && truncated == PlainTextFileReader::Change::Replaced
+        && unchanged == PlainTextFileReader::Change::None,
+      "replaced file");
+  }
+
+  {
+    // Changes past the first few KiB, with or without the file growing
+    auto text = MakeLogFile(300 * 1024);
+    WriteFile(path, text);
+    PlainTextFileReader reader {path};
+    reader.Poll();
+    reader.Read([](auto) {});
+    WriteFile(path, text);
+    const auto rewrittenSame = reader.Poll();
+    text[200 * 1024] ^= 0x20;
+    WriteFile(path, text);
+    const auto modified = reader.Poll();
+    reader.Read([](auto) {});
+    text[text.size() - 1] ^= 0x20;
+    WriteFile(path, text + "more\n");
+    const auto modifiedAndGrown = reader.Poll();
+    check(
+      rewrittenSame == PlainTextFileReader::Change::None
+        && modified == PlainTextFileReader::Change::Replaced
+        && modifiedAndGrown == PlainTextFileReader::Change::Replaced,
+      "modified file");
+  }
+
+  {
+    // Growing files only have the first and last complete blocks and the
+    // tail re-read; same-size edits are compared in full, and replacing the
+    // file is detected however little changed
+    auto text = MakeLogFile(1024 * 1024);
+    WriteFile(path, text);
+    PlainTextFileReader reader {path};
+    reader.Poll();
+    reader.Read([](auto) {});
+    text[10] ^= 0x20;
+    WriteFile(path, text + "more\n");
+    const auto firstBlock = reader.Poll();
+    reader.Read([](auto) {});
+    text[512 * 1024] ^= 0x20;
+    WriteFile(path, text + "more\n");
+    const auto inPlace = reader.Poll();
+    reader.Read([](auto) {});
+    text[text.size() - 1] ^= 0x20;
+    const auto temporary = GetScratchPath("verify-temporary");
+    WriteFile(temporary, text + "more\n");
+    std::filesystem::rename(temporary, path);
+    const auto renamed = reader.Poll();
+    check(
+      firstBlock == PlainTextFileReader::Change::Replaced
+        && inPlace == PlainTextFileReader::Change::Replaced
+        && renamed == PlainTextFileReader::Change::Replaced,
+      "sampled checks, full same-size checks, and replacement by rename");
+  }
+
+  {
+    // An in-place edit in the middle that keeps both the size and the last
+    // write time, e.g. a tool that restores timestamps; no sample covers
+    // the edit, and there's nothing appended
+    auto text = MakeLogFile(1024 * 1024);
+    WriteFile(path, text);
+    PlainTextFileReader reader {path};
+    reader.Poll();
+    reader.Read([](auto) {});
+    const auto repeated = reader.Poll();
+
+    const auto lastWriteTime = std::filesystem::last_write_time(path);
+    text[512 * 1024] ^= 0x20;
+    WriteFile(path, text);
+    std::filesystem::last_write_time(path, lastWriteTime);
+    const auto edited = reader.Poll();
+    std::string reread;
+    reader.Read([&reread](auto chunk) { reread += chunk; });
+    check(
+      repeated == PlainTextFileReader::Change::None
+        && edited == PlainTextFileReader::Change::Replaced
+        && reread == PlainTextFileReader::Decode(text),
+      "same-size, same-time edit in the middle is reloaded");
+  }
+  std::filesystem::remove(path);
+
+  {
+    // Extending the last line doesn't add a line, but must still change
+    // the identity, which is used to cache the current page's layout
+    PlainTextLayout layout {40, 20};
+    layout.AppendStream("hello");
+    const auto before = layout.GetIdentity();
+    const auto lineCount = layout.GetLineCount();
+    layout.AppendStream(" world");
+    check(
+      layout.GetLineCount() == lineCount
+        && layout.GetIdentity().mContentHash != before.mContentHash,
+      "extending a streamed line changes the identity");
+  }
+
+  {
+    PlainTextFileReader reader {GetScratchPath("missing")};
+    check(reader.Poll() == PlainTextFileReader::Change::Error, "missing file");
+  }
+
+  return check.GetExitCode();
+}
+
+int Benchmark(size_t maxMegabytes) {
+  constexpr size_t KiB = 1024;
+  constexpr size_t MiB = 1024 * KiB;
+  // Anything bigger takes minutes with the previous normalization
+  constexpr size_t MaxReferenceSize = 4 * MiB;
+  const auto path = GetScratchPath("bench");
+
+  for (const auto size:
+       {KiB, 64 * KiB, MiB, 4 * MiB, 16 * MiB, 128 * MiB, 500 * MiB}) {
+    if (size > maxMegabytes * MiB) {
+      break;
+    }
+    WriteFile(path, MakeLogFile(size));
+
+    auto start = Clock::now();
+    PlainTextFileReader reader {path};
+    PlainTextLayout layout {60, 38};
+    reader.Poll();
+    reader.Read(
+      [&layout](std::string_view text) { layout.AppendStream(text); });
+    const auto loadMS = MillisecondsSince(start);
+
+    // Tail a few lines at a time; averaged, as the layout's buffers
+    // occasionally grow
+    constexpr size_t TailCount = 64;
+    const auto tail = MakeLogFile(KiB);
+    double tailMS = 0;
+    for (size_t i = 0; i < TailCount; ++i) {
+      WriteFile(path, tail, /* append = */ true);
+      start = Clock::now();
+      if (reader.Poll() == PlainTextFileReader::Change::Appended) {
+        reader.Read(
+          [&layout](std::string_view text) { layout.AppendStream(text); });
+      }
+      tailMS += MillisecondsSince(start) / TailCount;
+    }
+
+    // A repeated change notification: same size, so everything already read
+    // is compared
+    start = Clock::now();
+    reader.Poll();
+    const auto unchangedMS = MillisecondsSince(start);
+
+    std::string reference;
+    if (size <= MaxReferenceSize) {
+      std::ifstream f(path, std::ios::binary);
+      reference = {std::istreambuf_iterator<char>(f), {}};
+      start = Clock::now();
+      reference = ReferenceNormalize(std::move(reference));
+    }
+    const auto referenceMS
+      = reference.empty() ? 0.0 : MillisecondsSince(start);
+
+    std::cout << std::format(
+      "{:>9} KiB: load {:9.2f}ms ({:6.1f} MiB/s), {} pages; 1KiB tail "
+      "{:.3f}ms; unchanged {:.3f}ms",
+      size / KiB,
+      loadMS,
+      (size / static_cast<double>(MiB)) / (loadMS / 1000),
+      layout.GetCompletePageCount() + 1,
+      tailMS,
+      unchangedMS);
+    if (!reference.empty()) {
+      std::cout << std::format("; previous CRLF pass {:.2f}ms", referenceMS);
+    }
+    std::cout << "\n";
+  }
+  std::filesystem::remove(path);
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[MAX_MEGABYTES]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 500 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
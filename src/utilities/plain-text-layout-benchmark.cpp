@@ -0,0 +1,383 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks that `PlainTextLayout` wraps and paginates exactly like the
+// original `PlainTextPageSource` implementation, and measures append
+// throughput for long radio-log style histories. Only depends on the
+// standard library, so it can also be built and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/PlainTextLayout.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+using Pages = std::vector<std::vector<std::string>>;
+
+// The layout algorithm from before `PlainTextLayout`, with `std::string`
+// instead of `winrt::hstring`; this is the golden reference.
+//
+// Wrapping has been updated to match `WrapLine()` for the generated messages,
+// which only contain lowercase letters and whitespace.
+class ReferenceLayout final {
+ public:
+  ReferenceLayout(int columns, int rows)
+    : mColumns(static_cast<size_t>(std::max(columns, 0))),
+      mRows(static_cast<size_t>(std::max(rows, 0))) {
+  }
+
+  void Append(std::string message) {
+    if (mRows <= 1 || mColumns <= 1) {
+      return;
+    }
+    while (true) {
+      auto pos = message.find_first_of("\t");
+      if (pos == message.npos) {
+        break;
+      }
+      message.replace(pos, 1, "    ");
+    }
+
+    std::vector<std::string_view> rawLines;
+    std::string_view remaining(message);
+    while (!remaining.empty()) {
+      auto newline = remaining.find_first_of("\n");
+      if (newline == remaining.npos) {
+        rawLines.push_back(remaining);
+        break;
+      }
+
+      rawLines.push_back(remaining.substr(0, newline));
+      if (remaining.size() <= newline) {
+        break;
+      }
+      remaining = remaining.substr(newline + 1);
+    }
+
+    std::vector<std::string_view> wrappedLines;
+    for (auto remaining: rawLines) {
+      while (true) {
+        if (remaining.size() <= mColumns) {
+          wrappedLines.push_back(remaining);
+          break;
+        }
+
+        // Spaces after a word hang past the margin, so the first character
+        // that doesn't fit is the first letter past it - unless there are
+        // only spaces before the margin
+        const auto firstLetter = remaining.find_first_not_of(' ');
+        if (firstLetter == remaining.npos || firstLetter >= mColumns) {
+          wrappedLines.push_back(remaining.substr(0, mColumns));
+          remaining = remaining.substr(mColumns);
+          continue;
+        }
+        const auto overflow = remaining.find_first_not_of(' ', mColumns);
+        if (overflow == remaining.npos) {
+          wrappedLines.push_back(
+            remaining.substr(0, remaining.find_last_not_of(' ') + 1));
+          break;
+        }
+
+        // Break after the last run of spaces that follows a word, and drop
+        // the spaces
+        const auto space = remaining.find_last_of(' ', overflow - 1);
+        if (space != remaining.npos && space > firstLetter) {
+          wrappedLines.push_back(
+            remaining.substr(0, remaining.find_last_not_of(' ', space) + 1));
+          remaining = remaining.substr(space + 1);
+          continue;
+        }
+
+        wrappedLines.push_back(remaining.substr(0, overflow));
+        remaining = remaining.substr(overflow);
+      }
+    }
+
+    if (wrappedLines.size() >= mRows) {
+      if (!mCurrentPageLines.empty()) {
+        mCurrentPageLines.push_back({});
+      }
+
+      for (const auto& line: wrappedLines) {
+        if (mCurrentPageLines.size() >= mRows) {
+          PushPage();
+        }
+        mCurrentPageLines.push_back(std::string {line});
+      }
+      return;
+    }
+
+    if (mCurrentPageLines.empty()) {
+      // do nothing
+    } else if (mRows - mCurrentPageLines.size() >= wrappedLines.size() + 1) {
+      mCurrentPageLines.push_back({});
+    } else {
+      PushPage();
+    }
+
+    for (auto line: wrappedLines) {
+      mCurrentPageLines.push_back(std::string {line});
+    }
+  }
+
+  void EnsureNewPage() {
+    if (!mCurrentPageLines.empty()) {
+      PushPage();
+    }
+  }
+
+  size_t GetPushedPageCount() const {
+    return mCompletePages.size();
+  }
+
+  Pages GetPages() const {
+    auto pages = mCompletePages;
+    pages.push_back(mCurrentPageLines);
+    return pages;
+  }
+
+ private:
+  size_t mColumns;
+  size_t mRows;
+  std::vector<std::vector<std::string>> mCompletePages;
+  std::vector<std::string> mCurrentPageLines;
+
+  void PushPage() {
+    mCompletePages.push_back(mCurrentPageLines);
+    mCurrentPageLines.clear();
+  }
+};
+
+Pages GetPages(const PlainTextLayout& layout) {
+  Pages pages;
+  for (size_t i = 0; i <= layout.GetCompletePageCount(); ++i) {
+    auto& page = pages.emplace_back();
+    for (const auto& line: layout.GetPageLines(i)) {
+      page.push_back(std::string {layout.GetText(line)});
+    }
+  }
+  return pages;
+}
+
+std::string RandomMessage(std::mt19937_64& rng, size_t maxWords) {
+  static constexpr std::string_view Separators[] {
+    " ", " ", " ", " ", " ", "  ", "\t", "\n", "\n\n", " \n", "\t\t"};
+  std::uniform_int_distribution<size_t> wordCount(0, maxWords);
+  // Mostly short words, but sometimes longer than a line
+  std::geometric_distribution<size_t> wordLength(0.15);
+  std::uniform_int_distribution<size_t> separator(
+    0, std::size(Separators) - 1);
+  std::uniform_int_distribution<int> letter('a', 'z');
+
+  std::string message;
+  const auto words = wordCount(rng);
+  for (size_t i = 0; i < words; ++i) {
+    if (i > 0 || (rng() % 8) == 0) {
+      message += Separators[separator(rng)];
+    }
+    const auto length = wordLength(rng) + 1;
+    for (size_t j = 0; j < length; ++j) {
+      message += static_cast<char>(letter(rng));
+    }
+  }
+  if ((rng() % 8) == 0) {
+    message += Separators[separator(rng)];
+  }
+  return message;
+}
+
+std::string RadioMessage(std::mt19937_64& rng, size_t index) {
+  static constexpr std::string_view Callsigns[] {
+    "Enfield 1-1", "Springfield 2-1", "Overlord", "Magic", "Batumi Tower"};
+  static constexpr std::string_view Phrases[] {
+    "request taxi to runway one three",
+    "cleared for takeoff, wind two six zero at eight",
+    "picture clean",
+    "fox three, bandit bullseye zero four five, twenty, angels two five",
+    "check in, two ship, flight level two four zero, with the picture",
+    "RTB, bingo fuel",
+  };
+  std::string message = std::format(
+    "[{:02}:{:02}:{:02}] {}: ",
+    (index / 3600) % 24,
+    (index / 60) % 60,
+    index % 60,
+    Callsigns[rng() % std::size(Callsigns)]);
+  const auto phrases = 1 + (rng() % 3);
+  for (size_t i = 0; i < phrases; ++i) {
+    if (i > 0) {
+      message += "; ";
+    }
+    message += Phrases[rng() % std::size(Phrases)];
+  }
+  return message;
+}
+
+int Verify() {
+  struct Config {
+    int mColumns;
+    int mRows;
+  };
+  // Roughly the default font's page size, then some degenerate sizes
+  constexpr Config configs[] {{60, 38}, {76, 45}, {10, 5}, {4, 3}, {2, 2}};
+
+  Checks check;
+  for (const auto& config: configs) {
+    std::mt19937_64 rng {config.mColumns * 1000ull + config.mRows};
+    ReferenceLayout reference {config.mColumns, config.mRows};
+    PlainTextLayout layout {config.mColumns, config.mRows};
+    size_t pushedPages = 0;
+
+    for (size_t i = 0; i < 20000; ++i) {
+      if ((rng() % 50) == 0) {
+        reference.EnsureNewPage();
+        pushedPages += layout.EnsureNewPage() ? 1 : 0;
+        continue;
+      }
+      const auto message = ((rng() % 4) == 0)
+        ? RandomMessage(rng, 4 * config.mColumns)
+        : RandomMessage(rng, 8);
+      reference.Append(message);
+      pushedPages += layout.Append(message);
+    }
+
+    const auto expected = reference.GetPages();
+    const auto actual = GetPages(layout);
+    const auto ok = (expected == actual)
+      && (pushedPages == reference.GetPushedPageCount());
+    check(
+      ok,
+      std::format(
+        "{}x{}: {} pages, {} lines",
+        config.mColumns,
+        config.mRows,
+        actual.size(),
+        layout.GetLineCount()));
+  }
+
+  // Identity must change for every append, and for page breaks
+  PlainTextLayout layout {60, 38};
+  const auto empty = layout.GetIdentity();
+  layout.Append("hello");
+  const auto hello = layout.GetIdentity();
+  layout.EnsureNewPage();
+  const auto withBreak = layout.GetIdentity();
+  check(
+    !(hello.HasSameContent(empty) || withBreak.HasSameContent(hello)),
+    "identity");
+
+  return check.GetExitCode();
+}
+
+template <class T>
+double TimeAppends(T& layout, const std::vector<std::string>& messages) {
+  const auto start = Clock::now();
+  for (const auto& message: messages) {
+    layout.Append(message);
+  }
+  return MillisecondsSince(start);
+}
+
+int Benchmark(size_t messageCount) {
+  constexpr size_t BatchSize = 1000;
+  std::mt19937_64 rng {42};
+  std::vector<std::string> messages;
+  messages.reserve(messageCount);
+  size_t bytes = 0;
+  for (size_t i = 0; i < messageCount; ++i) {
+    messages.push_back(RadioMessage(rng, i));
+    bytes += messages.back().size();
+  }
+
+  PlainTextLayout layout {60, 38};
+  std::vector<double> batchMilliseconds;
+  const auto start = Clock::now();
+  for (size_t i = 0; i < messageCount; i += BatchSize) {
+    const auto batchStart = Clock::now();
+    const auto end = std::min(i + BatchSize, messageCount);
+    for (size_t j = i; j < end; ++j) {
+      layout.Append(messages.at(j));
+    }
+    batchMilliseconds.push_back(MillisecondsSince(batchStart));
+  }
+  const auto layoutMS = MillisecondsSince(start);
+
+  ReferenceLayout reference {60, 38};
+  const auto referenceMS = TimeAppends(reference, messages);
+
+  const auto perMessageUS = [&](double ms, size_t count) {
+    return (ms * 1000) / static_cast<double>(count);
+  };
+  std::cout << std::format(
+    "{} messages, {:.1f} MiB, {} pages\n"
+    "  layout:    {:.1f}ms total, {:.2f}us/message, {:.1f} MiB/s\n"
+    "  reference: {:.1f}ms total, {:.2f}us/message\n",
+    messageCount,
+    bytes / (1024.0 * 1024),
+    layout.GetCompletePageCount() + 1,
+    layoutMS,
+    perMessageUS(layoutMS, messageCount),
+    (bytes / (1024.0 * 1024)) / (layoutMS / 1000),
+    referenceMS,
+    perMessageUS(referenceMS, messageCount));
+  if (batchMilliseconds.size() >= 2) {
+    // Should be roughly equal: appending shouldn't depend on history length
+    std::cout << std::format(
+      "  first {} messages: {:.2f}us/message; last {}: {:.2f}us/message\n",
+      BatchSize,
+      perMessageUS(batchMilliseconds.front(), BatchSize),
+      BatchSize,
+      perMessageUS(batchMilliseconds.back(), BatchSize));
+  }
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[MESSAGES]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 100000 : std::stoull(arguments[0]));
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
@@ -0,0 +1,493 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Measures `SearchIndex` indexing throughput and query latency on a
+// synthetic corpus, and checks that planted phrases are found where they
+// were put. Only depends on the standard library, so it can also be built
+// and profiled outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/SearchIndex.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+struct CorpusOptions {
+  size_t mDocuments {100};
+  size_t mPagesPerDocument {100};
+  size_t mLinesPerPage {45};
+  size_t mWordsPerLine {10};
+  size_t mVocabularySize {20000};
+  uint64_t mSeed {42};
+};
+
+/// A phrase that only appears once in the corpus
+struct Needle {
+  std::string mText;
+  uint64_t mDocumentKey;
+  uint64_t mPageKey;
+  SearchRect mRect;
+};
+
+struct Corpus {
+  std::vector<std::string> mVocabulary;
+  std::vector<SearchDocument> mDocuments;
+  std::vector<Needle> mNeedles;
+  size_t mTextBytes {};
+};
+
+/** Kneeboard-ish text: a skewed vocabulary, with frequencies and callsigns
+ * sprinkled in, and a unique needle on every tenth page. */
+Corpus GenerateCorpus(const CorpusOptions& options) {
+  Corpus corpus;
+  std::mt19937_64 rng {options.mSeed};
+
+  for (size_t i = 0; i < options.mVocabularySize; ++i) {
+    std::string word;
+    const auto length = 3 + (rng() % 8);
+    for (size_t j = 0; j < length; ++j) {
+      word.push_back(static_cast<char>('a' + (rng() % 26)));
+    }
+    corpus.mVocabulary.push_back(std::move(word));
+  }
+
+  std::uniform_real_distribution<double> uniform {0, 1};
+  const auto randomWord = [&]() -> const std::string& {
+    // Roughly Zipfian: a few words are very common
+    const auto u = uniform(rng);
+    return corpus.mVocabulary.at(
+      static_cast<size_t>(u * u * u * corpus.mVocabulary.size()));
+  };
+
+  for (size_t d = 0; d < options.mDocuments; ++d) {
+    SearchDocument doc {
+      .mDocumentKey = d + 1,
+      .mIdentity = {.mSize = d, .mContentHash = d},
+    };
+    for (size_t p = 0; p < options.mPagesPerDocument; ++p) {
+      SearchPage page {.mPageKey = ((d + 1) << 32) | p};
+      const auto needleLine = ((p % 10) == 0)
+        ? static_cast<size_t>(rng() % options.mLinesPerPage)
+        : options.mLinesPerPage;
+      for (size_t l = 0; l < options.mLinesPerPage; ++l) {
+        std::string line;
+        for (size_t w = 0; w < options.mWordsPerLine; ++w) {
+          line += randomWord();
+          line += ' ';
+        }
+        if ((rng() % 20) == 0) {
+          line += std::format("{}.{:03} ", 118 + (rng() % 18), rng() % 1000);
+        }
+        const auto height = 1.0f / options.mLinesPerPage;
+        const SearchRect rect {0.05f, l * height, 0.95f, (l + 1) * height};
+        if (l == needleLine) {
+          const auto needle = std::format("Needle{}x{} Tower", d, p);
+          line += needle;
+          corpus.mNeedles.push_back({
+            needle,
+            doc.mDocumentKey,
+            page.mPageKey,
+            rect,
+          });
+        }
+        corpus.mTextBytes += line.size();
+        page.mBlocks.push_back({std::move(line), rect});
+      }
+      doc.mPages.push_back(std::move(page));
+    }
+    corpus.mDocuments.push_back(std::move(doc));
+  }
+  return corpus;
+}
+
+/** A radio log that grows a message at a time; only the last page changes.
+ *
+ * Returns the pages after `messageCount` messages. */
+std::vector<SearchPage> MakeLog(
+  const std::vector<std::string>& vocabulary,
+  size_t messageCount,
+  size_t linesPerPage) {
+  std::vector<SearchPage> pages;
+  for (size_t i = 0; i < messageCount; ++i) {
+    if (i % linesPerPage == 0) {
+      pages.push_back({.mPageKey = 1000 + pages.size()});
+    }
+    pages.back().mBlocks.push_back({
+      std::format(
+        "Message{} {} {} {}.{:03}",
+        i,
+        vocabulary.at((i * 7) % vocabulary.size()),
+        vocabulary.at((i * 13) % vocabulary.size()),
+        118 + (i % 18),
+        (i * 25) % 1000),
+    });
+  }
+  return pages;
+}
+
+/** Re-index an append-only document the way `SearchIndexer` does: only the
+ * last indexed page and anything after it */
+bool AppendToLog(
+  SearchIndex& index,
+  uint64_t key,
+  std::vector<SearchPage> pages,
+  uint64_t messageCount) {
+  const auto indexed = index.GetPageKeys(key);
+  const FileIdentity identity {.mContentHash = messageCount};
+  if (!(indexed && !indexed->empty())) {
+    index.Upsert({key, identity, std::move(pages)});
+    return false;
+  }
+  const auto first = std::min(indexed->size() - 1, pages.size());
+  pages.erase(pages.begin(), pages.begin() + first);
+  return index.ReplacePages(key, identity, first, std::move(pages));
+}
+
+double Percentile(std::vector<double>& values, double percentile) {
+  std::ranges::sort(values);
+  const auto index = static_cast<size_t>(percentile * (values.size() - 1));
+  return values.at(index);
+}
+
+int Benchmark(const CorpusOptions& options) {
+  auto start = Clock::now();
+  auto corpus = GenerateCorpus(options);
+  std::cout << std::format(
+    "Generated {} documents, {:.1f}MiB of text in {:.0f}ms\n",
+    corpus.mDocuments.size(),
+    corpus.mTextBytes / (1024.0 * 1024.0),
+    MillisecondsSince(start));
+
+  SearchIndex index {{.mMemoryBudgetBytes = ~size_t {0}}};
+  const auto reindex = corpus.mDocuments.at(corpus.mDocuments.size() / 2);
+  start = Clock::now();
+  for (auto& doc: corpus.mDocuments) {
+    index.Upsert(std::move(doc));
+  }
+  const auto indexMS = MillisecondsSince(start);
+  const auto stats = index.GetStats();
+  std::cout << std::format(
+    "Indexed {} pages in {:.0f}ms: {:.1f}MiB/s, {:.0f} pages/s\n"
+    "  {} terms, {} postings, ~{:.1f}MiB estimated\n",
+    stats.mPageCount,
+    indexMS,
+    (corpus.mTextBytes / (1024.0 * 1024.0)) / (indexMS / 1000),
+    stats.mPageCount / (indexMS / 1000),
+    stats.mTermCount,
+    stats.mPostingCount,
+    stats.mEstimatedBytes / (1024.0 * 1024.0));
+
+  start = Clock::now();
+  index.Upsert(reindex);
+  std::cout << std::format(
+    "Re-indexed one document in {:.2f}ms\n", MillisecondsSince(start));
+
+  {
+    // A radio log that gets a new message every time, with the whole log
+    // re-indexed, or only the changed pages
+    constexpr size_t Messages = 1000;
+    constexpr size_t LinesPerPage = 40;
+    std::vector<std::vector<SearchPage>> logs;
+    for (size_t i = 1; i <= Messages; ++i) {
+      logs.push_back(MakeLog(corpus.mVocabulary, i, LinesPerPage));
+    }
+    const auto key = corpus.mDocuments.size() + 1;
+
+    start = Clock::now();
+    for (size_t i = 0; i < logs.size(); ++i) {
+      index.Upsert({key, {.mContentHash = i + 1}, logs.at(i)});
+    }
+    const auto fullMS = MillisecondsSince(start);
+
+    index.Remove(key);
+    start = Clock::now();
+    for (size_t i = 0; i < logs.size(); ++i) {
+      AppendToLog(index, key, logs.at(i), i + 1);
+    }
+    const auto incrementalMS = MillisecondsSince(start);
+    std::cout << std::format(
+      "Log of {} messages, re-indexed after each one: {:.0f}ms for the "
+      "whole log, {:.0f}ms incrementally\n",
+      Messages,
+      fullMS,
+      incrementalMS);
+    index.Remove(key);
+  }
+
+  std::mt19937_64 rng {options.mSeed + 1};
+  const auto& vocabulary = corpus.mVocabulary;
+  const auto anyWord = [&]() -> const std::string& {
+    return vocabulary.at(rng() % vocabulary.size());
+  };
+  struct QueryKind {
+    std::string_view mName;
+    std::function<std::string()> mGenerate;
+  };
+  const std::vector<QueryKind> kinds {
+    {"word", [&]() { return anyWord(); }},
+    {"two words", [&]() { return anyWord() + " " + anyWord(); }},
+    {"2-char prefix", [&]() { return anyWord().substr(0, 2); }},
+    {"frequency prefix",
+     [&]() { return std::format("{}.", 118 + (rng() % 18)); }},
+    {"needle",
+     [&]() {
+       return corpus.mNeedles.at(rng() % corpus.mNeedles.size()).mText;
+     }},
+  };
+  for (const auto& kind: kinds) {
+    std::vector<double> latencies;
+    size_t hitCount = 0;
+    for (size_t i = 0; i < 200; ++i) {
+      const auto query = kind.mGenerate();
+      const auto queryStart = Clock::now();
+      hitCount += index.Query(query).size();
+      latencies.push_back(MillisecondsSince(queryStart));
+    }
+    std::cout << std::format(
+      "Query ({}): p50 {:.3f}ms, p95 {:.3f}ms, max {:.3f}ms; {:.1f} "
+      "hits/query\n",
+      kind.mName,
+      Percentile(latencies, 0.5),
+      Percentile(latencies, 0.95),
+      Percentile(latencies, 1.0),
+      hitCount / 200.0);
+  }
+
+  std::cout << std::format(
+    "Peak memory: {:.1f}MiB\n", GetPeakMemoryBytes() / (1024.0 * 1024.0));
+  return 0;
+}
+
+int Verify(const CorpusOptions& options) {
+  auto corpus = GenerateCorpus(options);
+  Checks check;
+
+  SearchIndex index;
+  for (const auto& doc: corpus.mDocuments) {
+    index.Upsert(doc);
+  }
+
+  const auto failuresBeforeNeedles = check.GetFailureCount();
+  for (const auto& needle: corpus.mNeedles) {
+    const auto hits = index.Query(needle.mText);
+    if (hits.size() != 1) {
+      check.Fail(std::format("'{}' had {} hits", needle.mText, hits.size()));
+      continue;
+    }
+    const auto& hit = hits.front();
+    if (
+      hit.mDocumentKey != needle.mDocumentKey
+      || hit.mPageKey != needle.mPageKey || hit.mRects.size() != 1
+      || hit.mRects.front() != needle.mRect) {
+      check.Fail(std::format("'{}' found in the wrong place", needle.mText));
+    }
+    if (hit.mSnippet.find(needle.mText) == std::string::npos) {
+      check.Fail(std::format("'{}' not in snippet", needle.mText));
+    }
+  }
+  check(
+    check.GetFailureCount() == failuresBeforeNeedles,
+    std::format("{} needles found", corpus.mNeedles.size()));
+
+  // Case-insensitive, and the last term is a prefix
+  const auto& first = corpus.mNeedles.front();
+  std::string partial = first.mText;
+  std::ranges::transform(partial, partial.begin(), [](char c) {
+    return static_cast<char>(std::toupper(c));
+  });
+  partial.resize(partial.size() - 2);
+  check(!index.Query(partial).empty(), "case-insensitive prefix query");
+
+  // Replacing a document removes its old text
+  const auto key = first.mDocumentKey;
+  index.Upsert({
+    .mDocumentKey = key,
+    .mIdentity = {.mContentHash = 1234},
+    .mPages = {{.mPageKey = 1, .mBlocks = {{"replacement"}}}},
+  });
+  check(index.Query(first.mText).empty(), "replaced text removed");
+  check(index.Query("replacement").size() == 1, "replacement found");
+  check(index.IsCurrent(key, {.mContentHash = 1234}), "replacement identity");
+
+  {
+    // Incrementally indexing a growing log matches indexing it in one go
+    constexpr size_t Messages = 300;
+    constexpr size_t LinesPerPage = 40;
+    constexpr uint64_t LogKey = 999'999;
+    SearchIndex incremental;
+    size_t replaced = 0;
+    for (size_t i = 1; i <= Messages; ++i) {
+      if (AppendToLog(
+            incremental,
+            LogKey,
+            MakeLog(corpus.mVocabulary, i, LinesPerPage),
+            i)) {
+        ++replaced;
+      }
+    }
+    SearchIndex full;
+    full.Upsert({
+      LogKey,
+      {.mContentHash = Messages},
+      MakeLog(corpus.mVocabulary, Messages, LinesPerPage),
+    });
+    check(replaced == Messages - 1, "log: incremental updates");
+
+    const auto a = incremental.GetStats();
+    const auto b = full.GetStats();
+    check(
+      a.mPageCount == b.mPageCount && a.mTermCount == b.mTermCount
+        && a.mPostingCount == b.mPostingCount
+        && a.mEstimatedBytes == b.mEstimatedBytes,
+      "log: same stats as indexing in one go");
+
+    bool sameResults = true;
+    for (const auto& query: {"message1", "message299", "118.", "message"}) {
+      const auto x = incremental.Query(query, 1000);
+      const auto y = full.Query(query, 1000);
+      sameResults = sameResults && x.size() == y.size();
+      for (size_t i = 0; sameResults && i < x.size(); ++i) {
+        sameResults = x.at(i).mPageKey == y.at(i).mPageKey
+          && x.at(i).mRects == y.at(i).mRects
+          && x.at(i).mSnippet == y.at(i).mSnippet;
+      }
+    }
+    check(sameResults, "log: same results as indexing in one go");
+
+    // Replacing the tail removes terms that were only there
+    incremental.ReplacePages(
+      LogKey,
+      {.mContentHash = 1},
+      1,
+      {{.mPageKey = 5000, .mBlocks = {{"Truncated"}}}});
+    check(
+      incremental.Query("message299").empty()
+        && incremental.Query("message1").size() == 1
+        && incremental.Query("truncated").size() == 1
+        && incremental.GetPageKeys(LogKey)
+          == std::vector<uint64_t> {1000, 5000},
+      "log: replaced tail");
+    check(
+      incremental.GetStats().mTermCount < a.mTermCount,
+      "log: unused terms removed");
+
+    check(
+      !incremental.ReplacePages(LogKey + 1, {}, 0, {}),
+      "log: can't replace pages of unknown documents");
+    check(
+      !incremental.ReplacePages(LogKey, {}, 3, {}),
+      "log: can't replace pages past the end");
+    incremental.RetainOnly({});
+    check(
+      incremental.GetStats().mEstimatedBytes == 0,
+      "log: nothing left after removal");
+  }
+
+  // Removing everything leaves nothing behind
+  index.RetainOnly({});
+  const auto empty = index.GetStats();
+  check(
+    !(empty.mDocumentCount || empty.mTermCount || empty.mPostingCount
+      || empty.mEstimatedBytes),
+    "index empty after removing everything");
+
+  // The memory budget is respected, and the least-recently-used documents
+  // are evicted first
+  const auto budget = 4 * 1024 * 1024;
+  SearchIndex bounded {{.mMemoryBudgetBytes = budget}};
+  for (const auto& doc: corpus.mDocuments) {
+    bounded.Upsert(doc);
+    bounded.Query(first.mText);
+  }
+  const auto boundedStats = bounded.GetStats();
+  check(boundedStats.mEstimatedBytes <= budget, "within budget");
+  check(boundedStats.mEvictionCount > 0, "something evicted");
+  check(
+    bounded.Query(first.mText).size() == 1,
+    "recently-used document was kept");
+  const auto& evicted = corpus.mDocuments.at(1);
+  check(
+    !bounded.IsCurrent(evicted.mDocumentKey, evicted.mIdentity),
+    "evicted document isn't current, so it will be indexed again");
+  check(
+    !bounded.GetPageKeys(evicted.mDocumentKey)
+      && !bounded.ReplacePages(evicted.mDocumentKey, evicted.mIdentity, 0, {}),
+    "evicted documents can't be updated incrementally");
+  bounded.Upsert(evicted);
+  check(
+    bounded.IsCurrent(evicted.mDocumentKey, evicted.mIdentity)
+      && bounded.GetPageKeys(evicted.mDocumentKey)->size()
+        == evicted.mPages.size()
+      && bounded.GetStats().mEstimatedBytes <= budget,
+    "evicted document is searchable again after re-indexing");
+
+  std::cout << std::format(
+    "{} of {} documents kept within budget\n",
+    boundedStats.mDocumentCount,
+    corpus.mDocuments.size());
+  return check.GetExitCode();
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[DOCUMENTS [PAGES]]",
+        .mMaxArguments = 2,
+        .mRun =
+          [](auto arguments) {
+            CorpusOptions options;
+            if (arguments.size() >= 1) {
+              options.mDocuments = std::stoull(arguments[0]);
+            }
+            if (arguments.size() == 2) {
+              options.mPagesPerDocument = std::stoull(arguments[1]);
+            }
+            return Benchmark(options);
+          },
+      },
+      {
+        .mName = "verify",
+        .mRun =
+          [](auto) {
+            return Verify({.mDocuments = 20, .mPagesPerDocument = 50});
+          },
+      },
+    });
+}
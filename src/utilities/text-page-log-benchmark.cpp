@@ -0,0 +1,343 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks that `TextPageLog` round-trips pages and recovers from torn writes,
+// and that spilling a `PlainTextLayout`'s history doesn't change any page;
+// also soak-tests a long radio log with a bounded in-memory window. Only
+// depends on the standard library, so it can also be built and profiled
+// outside of Windows.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/PlainTextLayout.h>
+#include <OpenKneeboard/TextPageLog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+using Page = std::vector<std::string>;
+
+std::filesystem::path GetScratchPath(std::string_view name) {
+  return std::filesystem::temp_directory_path()
+    / std::format("text-page-log-benchmark-{}.oktpl", name);
+}
+
+std::string RadioMessage(std::mt19937_64& rng, size_t index) {
+  static constexpr std::string_view Callsigns[] {
+    "Enfield 1-1", "Springfield 2-1", "Overlord", "Magic", "Batumi Tower"};
+  static constexpr std::string_view Phrases[] {
+    "request taxi to runway one three",
+    "cleared for takeoff, wind two six zero at eight",
+    "picture clean",
+    "fox three, bandit bullseye zero four five, twenty, angels two five",
+    "check in, two ship, flight level two four zero, with the picture",
+    "RTB, bingo fuel",
+    "lines\n\tof\ttext",
+  };
+  std::string message = std::format(
+    "[{:02}:{:02}:{:02}] {}: ",
+    (index / 3600) % 24,
+    (index / 60) % 60,
+    index % 60,
+    Callsigns[rng() % std::size(Callsigns)]);
+  const auto phrases = 1 + (rng() % 3);
+  for (size_t i = 0; i < phrases; ++i) {
+    if (i > 0) {
+      message += "; ";
+    }
+    message += Phrases[rng() % std::size(Phrases)];
+  }
+  return message;
+}
+
+Page ReadPage(const PlainTextLayout& layout, size_t index) {
+  Page page;
+  for (const auto& line: layout.GetPageLines(index)) {
+    page.push_back(std::string {layout.GetText(line)});
+  }
+  return page;
+}
+
+// The same policy as `PlainTextPageSource`
+class SpilledHistory final {
+ public:
+  SpilledHistory(
+    const std::filesystem::path& path,
+    size_t maxResidentPages,
+    int columns,
+    int rows)
+    : mLog(path), mMaxResidentPages(maxResidentPages), mLayout(columns, rows) {
+    mLog.Clear();
+  }
+
+  void Append(std::string_view message) {
+    mLayout.Append(message);
+    this->Spill();
+  }
+
+  void EnsureNewPage() {
+    if (mLayout.EnsureNewPage()) {
+      this->Spill();
+    }
+  }
+
+  size_t GetPageCount() const {
+    return mLayout.GetCompletePageCount() + 1;
+  }
+
+  Page ReadPage(size_t index) {
+    if (index >= mLayout.GetFirstResidentPage()) {
+      return ::ReadPage(mLayout, index);
+    }
+    return mLog.Read(index);
+  }
+
+  const TextPageLog& GetLog() const {
+    return mLog;
+  }
+
+ private:
+  TextPageLog mLog;
+  size_t mMaxResidentPages;
+  PlainTextLayout mLayout;
+
+  void Spill() {
+    const auto first = mLayout.GetFirstResidentPage();
+    const auto resident = mLayout.GetCompletePageCount() - first;
+    const auto slack = std::max<size_t>(1, mMaxResidentPages / 2);
+    if (
+      resident <= mMaxResidentPages
+      || resident - mMaxResidentPages < slack) {
+      return;
+    }
+    const auto count = resident - mMaxResidentPages;
+    std::vector<std::string_view> lines;
+    for (size_t i = 0; i < count; ++i) {
+      lines.clear();
+      for (const auto& line: mLayout.GetPageLines(first + i)) {
+        lines.push_back(mLayout.GetText(line));
+      }
+      mLog.Append(lines);
+    }
+    mLayout.DiscardCompletePages(count);
+  }
+};
+
+std::vector<Page> MakePages(size_t count) {
+  std::mt19937_64 rng {123};
+  std::vector<Page> pages;
+  for (size_t i = 0; i < count; ++i) {
+    auto& page = pages.emplace_back();
+    const auto lines = rng() % 40;
+    for (size_t j = 0; j < lines; ++j) {
+      page.push_back(
+        ((rng() % 5) == 0) ? std::string {} : RadioMessage(rng, j));
+    }
+  }
+  return pages;
+}
+
+void AppendPages(TextPageLog& log, const std::vector<Page>& pages) {
+  for (const auto& page: pages) {
+    const std::vector<std::string_view> lines {page.begin(), page.end()};
+    log.Append(lines);
+  }
+}
+
+bool ReadsBack(TextPageLog& log, const std::vector<Page>& pages) {
+  if (log.GetPageCount() != pages.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < pages.size(); ++i) {
+    if (log.Read(i) != pages.at(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int Verify() {
+  const auto path = GetScratchPath("verify");
+  std::filesystem::remove(path);
+  const auto pages = MakePages(200);
+  Checks check;
+
+  {
+    TextPageLog log {path};
+    AppendPages(log, pages);
+    check(ReadsBack(log, pages), "round trip");
+  }
+  {
+    TextPageLog log {path};
+    check(
+      ReadsBack(log, pages) && log.GetDiscardedByteCount() == 0, "reopen");
+  }
+
+  // Simulate a crash part way through writing the last page
+  const auto fullSize = std::filesystem::file_size(path);
+  std::filesystem::resize_file(path, fullSize - 7);
+  {
+    TextPageLog log {path};
+    const std::vector<Page> expected {pages.begin(), pages.end() - 1};
+    check(
+      ReadsBack(log, expected) && log.GetDiscardedByteCount() > 0
+        && std::filesystem::file_size(path) == log.GetByteCount(),
+      "torn tail");
+    AppendPages(log, {pages.back()});
+    check(ReadsBack(log, pages), "append after torn tail");
+  }
+
+  // Corrupt a byte in the last page's payload
+  {
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(static_cast<std::streamoff>(std::filesystem::file_size(path) - 1));
+    f.put('\xff');
+  }
+  {
+    TextPageLog log {path};
+    const std::vector<Page> expected {pages.begin(), pages.end() - 1};
+    check(ReadsBack(log, expected), "corrupt tail");
+  }
+
+  {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f << "not a text page log";
+  }
+  {
+    TextPageLog log {path};
+    check(
+      log.GetPageCount() == 0 && log.GetDiscardedByteCount() > 0,
+      "invalid header");
+    AppendPages(log, pages);
+    check(ReadsBack(log, pages), "reuse after invalid header");
+    log.Clear();
+    check(log.GetPageCount() == 0, "clear");
+  }
+
+  // Spilling must not change the content of any page
+  for (const size_t window: {1, 2, 10}) {
+    std::mt19937_64 rng {window};
+    PlainTextLayout reference {40, 20};
+    SpilledHistory spilled {path, window, 40, 20};
+    for (size_t i = 0; i < 5000; ++i) {
+      if ((rng() % 40) == 0) {
+        reference.EnsureNewPage();
+        spilled.EnsureNewPage();
+        continue;
+      }
+      const auto message = RadioMessage(rng, i);
+      reference.Append(message);
+      spilled.Append(message);
+    }
+    bool ok = (spilled.GetPageCount() == reference.GetCompletePageCount() + 1)
+      && (spilled.GetLog().GetPageCount() > 0);
+    for (size_t i = 0; ok && i < spilled.GetPageCount(); ++i) {
+      ok = (spilled.ReadPage(i) == ReadPage(reference, i));
+    }
+    check(ok, std::format("spilled layout, {} resident pages", window));
+  }
+
+  std::filesystem::remove(path);
+  return check.GetExitCode();
+}
+
+int Soak(size_t messageCount, size_t maxResidentPages) {
+  const auto path = GetScratchPath("soak");
+  std::mt19937_64 rng {42};
+
+  size_t bytes = 0;
+  double slowestAppendMS = 0;
+  const auto start = Clock::now();
+  SpilledHistory history {path, maxResidentPages, 60, 38};
+  for (size_t i = 0; i < messageCount; ++i) {
+    const auto message = RadioMessage(rng, i);
+    bytes += message.size();
+    const auto appendStart = Clock::now();
+    history.Append(message);
+    slowestAppendMS = std::max(slowestAppendMS, MillisecondsSince(appendStart));
+  }
+  const auto appendMS = MillisecondsSince(start);
+
+  // Paging back through history
+  constexpr size_t ReadCount = 2000;
+  std::vector<double> readMS;
+  std::uniform_int_distribution<size_t> pageDist(
+    0, history.GetPageCount() - 1);
+  for (size_t i = 0; i < ReadCount; ++i) {
+    const auto readStart = Clock::now();
+    const auto page = history.ReadPage(pageDist(rng));
+    readMS.push_back(MillisecondsSince(readStart));
+  }
+  std::ranges::sort(readMS);
+
+  std::cout << std::format(
+    "{} messages, {:.1f} MiB, {} pages ({} on disk, {:.1f} MiB)\n"
+    "  append: {:.1f}ms total, {:.2f}us/message, slowest {:.2f}ms\n"
+    "  random page read: p50 {:.3f}ms, p99 {:.3f}ms\n"
+    "  peak memory: {:.1f} MiB\n",
+    messageCount,
+    bytes / (1024.0 * 1024),
+    history.GetPageCount(),
+    history.GetLog().GetPageCount(),
+    history.GetLog().GetByteCount() / (1024.0 * 1024),
+    appendMS,
+    (appendMS * 1000) / messageCount,
+    slowestAppendMS,
+    readMS.at(readMS.size() / 2),
+    readMS.at((readMS.size() * 99) / 100),
+    GetPeakMemoryBytes() / (1024.0 * 1024));
+
+  std::filesystem::remove(path);
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "soak",
+        .mUsage = "[MESSAGES [RESIDENT_PAGES]]",
+        .mMaxArguments = 2,
+        .mRun =
+          [](auto arguments) {
+            return Soak(
+              (arguments.size() >= 1) ? std::stoull(arguments[0]) : 1000000,
+              (arguments.size() == 2) ? std::stoull(arguments[1]) : 100);
+          },
+      },
+      {.mName = "verify", .mRun = [](auto) { return Verify(); }},
+    });
+}
@@ -0,0 +1,459 @@
+/*
+ * OpenKneeboard
+ *
+ * Copyright (C) 2022 Fred Emmott <fred@fredemmott.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+// Checks grapheme cluster and line break segmentation against the Unicode
+// test data, and that `WrapLine()` never splits a cluster or overflows a
+// line, then measures wrapping throughput. Only depends on the standard
+// library, so it can also be built and profiled outside of Windows.
+//
+// By default, the break cases are icu72-grapheme-break-cases.txt and
+// icu72-line-break-cases.txt from src/lib/unicode-data. They're generated
+// with ICU 72.1 from the same Unicode version as the tables, in the format
+// of the Unicode test files, but they are not the Unicode conformance tests;
+// passing checks doesn't mean this is conformant. The official
+// GraphemeBreakTest.txt and LineBreakTest.txt can be passed on the command
+// line instead.
+
+#include <OpenKneeboard/BenchmarkHarness.h>
+#include <OpenKneeboard/UnicodeText.h>
+
+#include <shims/filesystem>
+
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace OpenKneeboard;
+using namespace OpenKneeboard::BenchmarkHarness;
+
+namespace {
+
+std::string EncodeUTF8(char32_t c) {
+  std::string out;
+  if (c < 0x80) {
+    out += static_cast<char>(c);
+  } else if (c < 0x800) {
+    out += static_cast<char>(0xc0 | (c >> 6));
+    out += static_cast<char>(0x80 | (c & 0x3f));
+  } else if (c < 0x10000) {
+    out += static_cast<char>(0xe0 | (c >> 12));
+    out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+    out += static_cast<char>(0x80 | (c & 0x3f));
+  } else {
+    out += static_cast<char>(0xf0 | (c >> 18));
+    out += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+    out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+    out += static_cast<char>(0x80 | (c & 0x3f));
+  }
+  return out;
+}
+
+struct TestCase {
+  std::vector<char32_t> mCodePoints;
+  // mBreaks[i]: break before mCodePoints[i]; mBreaks[0] is ignored
+  std::vector<bool> mBreaks;
+};
+
+// "÷ 0020 × 0308 ÷ # comment"
+std::vector<TestCase> ReadTestData(const std::filesystem::path& path) {
+  std::vector<TestCase> cases;
+  std::ifstream f(path);
+  std::string line;
+  while (std::getline(f, line)) {
+    line = line.substr(0, line.find('#'));
+    TestCase testCase;
+    bool nextBreak = false;
+    size_t pos = 0;
+    while (pos < line.size()) {
+      if (line.compare(pos, 2, "\xc3\xb7") == 0) {
+        nextBreak = true;
+        pos += 2;
+      } else if (line.compare(pos, 2, "\xc3\x97") == 0) {
+        nextBreak = false;
+        pos += 2;
+      } else if (std::isxdigit(static_cast<unsigned char>(line[pos]))) {
+        size_t length {};
+        testCase.mCodePoints.push_back(
+          static_cast<char32_t>(std::stoul(line.substr(pos), &length, 16)));
+        testCase.mBreaks.push_back(nextBreak);
+        pos += length;
+      } else {
+        ++pos;
+      }
+    }
+    if (!testCase.mCodePoints.empty()) {
+      cases.push_back(std::move(testCase));
+    }
+  }
+  return cases;
+}
+
+template <class T>
+bool CheckTestData(
+  std::string_view name,
+  const std::filesystem::path& path,
+  T&& isBreak) {
+  const auto cases = ReadTestData(path);
+  size_t failures = 0;
+  for (const auto& testCase: cases) {
+    const auto actual = isBreak(testCase.mCodePoints);
+    bool ok = true;
+    for (size_t i = 1; i < testCase.mCodePoints.size(); ++i) {
+      ok = ok && (actual.at(i) == testCase.mBreaks.at(i));
+    }
+    if (ok) {
+      continue;
+    }
+    if (++failures <= 10) {
+      std::string expected;
+      std::string got;
+      for (size_t i = 0; i < testCase.mCodePoints.size(); ++i) {
+        const auto c = std::format(
+          "{:04X} ", static_cast<uint32_t>(testCase.mCodePoints.at(i)));
+        expected += (i && testCase.mBreaks.at(i) ? "/ " : "x ") + c;
+        got += (i && actual.at(i) ? "/ " : "x ") + c;
+      }
+      std::cout << std::format(
+        "  expected: {}\n  actual:   {}\n", expected, got);
+    }
+  }
+  std::cout << std::format(
+    "{}: {} of {} cases passed\n", name, cases.size() - failures, cases.size());
+  return failures == 0 && !cases.empty();
+}
+
+std::vector<bool> GetGraphemeBreaks(const std::vector<char32_t>& text) {
+  GraphemeBreaker breaker;
+  std::vector<bool> breaks;
+  for (const auto c: text) {
+    breaks.push_back(breaker.Next(GetCodePointProperties(c)));
+  }
+  return breaks;
+}
+
+std::vector<bool> GetLineBreaks(const std::vector<char32_t>& text) {
+  LineBreaker breaker;
+  std::vector<bool> breaks;
+  for (const auto c: text) {
+    breaks.push_back(
+      breaker.Next(GetCodePointProperties(c)) != LineBreaker::Break::None);
+  }
+  return breaks;
+}
+
+std::vector<std::string> Wrap(std::string_view text, size_t columns) {
+  std::vector<std::string> lines;
+  while (!text.empty()) {
+    const auto wrap = WrapLine(text, columns);
+    lines.push_back(std::string {text.substr(0, wrap.mLength)});
+    text.remove_prefix(wrap.mNextLineOffset);
+  }
+  return lines;
+}
+
+// Characters that exercise the interesting paths
+std::string RandomText(std::mt19937_64& rng, size_t codePoints) {
+  static constexpr char32_t Pool[] {
+    U'a',     U'b',     U'z',     U' ',     U' ',     U' ',     U'-',
+    U'/',     U'.',     U',',     U'(',     U')',     U'1',     U'$',
+    U'é', U'́', U'̈', U'א', U' ', U'​',
+    U'—', U'。', U'、', U'「', U'」', U'中',
+    U'文', U'あ', U'ー', U'（', U'）', U'가',
+    U'ᄀ', U'ᅡ', U'ᆨ', U'क', U'्', U'ष',
+    U'‍', U'️', U'❤', U'\U0001f466', U'\U0001f3fb',
+    U'\U0001f1e6', U'\U0001f1e8', U'\U0001f600', U'ก', U'ั',
+  };
+  std::string text;
+  for (size_t i = 0; i < codePoints; ++i) {
+    text += EncodeUTF8(Pool[rng() % std::size(Pool)]);
+  }
+  return text;
+}
+
+bool CheckRandomWrapping() {
+  std::mt19937_64 rng {1};
+  for (size_t i = 0; i < 20000; ++i) {
+    const auto text = RandomText(rng, rng() % 200);
+    const auto columns = 2 + (rng() % 40);
+
+    // Cluster boundaries, and whether each cluster is a space
+    std::vector<bool> isBoundary(text.size() + 1, false);
+    {
+      GraphemeBreaker breaker;
+      size_t offset = 0;
+      while (offset < text.size()) {
+        const auto start = offset;
+        const auto c = DecodeUTF8(text, offset);
+        isBoundary.at(start) = breaker.Next(GetCodePointProperties(c));
+      }
+      isBoundary.at(text.size()) = true;
+    }
+
+    std::string_view remaining {text};
+    while (!remaining.empty()) {
+      const auto wrap = WrapLine(remaining, columns);
+      const auto line = remaining.substr(0, wrap.mLength);
+      const auto dropped = remaining.substr(
+        wrap.mLength, wrap.mNextLineOffset - wrap.mLength);
+      const auto start = static_cast<size_t>(remaining.data() - text.data());
+      const auto width = GetDisplayWidth(line);
+
+      const auto endsAtBoundary = isBoundary.at(start + wrap.mLength)
+        && isBoundary.at(start + wrap.mNextLineOffset);
+      const auto onlyDropsSpaces
+        = dropped.find_first_not_of(' ') == dropped.npos;
+      // A line can only be too wide if it's a single cluster
+      size_t firstCluster = 0;
+      DecodeUTF8(line, firstCluster);
+      while (firstCluster < line.size()
+             && !isBoundary.at(start + firstCluster)) {
+        DecodeUTF8(line, firstCluster);
+      }
+      const auto fits = width <= columns || firstCluster == line.size();
+      if (
+        wrap.mNextLineOffset == 0 || !endsAtBoundary || !onlyDropsSpaces
+        || !fits) {
+        std::cout << std::format(
+          "Bad wrap at {} columns: '{}' -> '{}'\n", columns, text, line);
+        return false;
+      }
+      remaining.remove_prefix(wrap.mNextLineOffset);
+    }
+  }
+  return true;
+}
+
+int Verify(
+  const std::filesystem::path& graphemeBreakTest,
+  const std::filesystem::path& lineBreakTest) {
+  Checks check;
+
+  {
+    const std::string_view invalid {"a\xc3(\xe0\x80\xaf\xed\xa0\x80\xf0\x9f"};
+    std::u32string decoded;
+    for (size_t offset = 0; offset < invalid.size();) {
+      decoded += DecodeUTF8(invalid, offset);
+    }
+    check(
+      decoded == U"a�(��������",
+      "invalid UTF-8");
+  }
+
+  check(
+    GetDisplayWidth("abc") == 3 && GetDisplayWidth("é") == 1
+      && GetDisplayWidth("中文") == 4
+      && GetDisplayWidth("Ａｱ") == 3
+      && GetDisplayWidth("각") == 2
+      && GetDisplayWidth("❤️") == 2
+      && GetDisplayWidth("\U0001f1e6\U0001f1e8") == 2
+      && GetDisplayWidth("\U0001f468‍\U0001f469‍\U0001f467") == 2,
+    "display widths");
+
+  using Lines = std::vector<std::string>;
+  check(
+    Wrap("hello world", 8) == Lines {"hello", "world"}
+      && Wrap("hello   world   ", 8) == Lines {"hello", "world   "}
+      && Wrap("abcdefghij", 4) == Lines {"abcd", "efgh", "ij"}
+      && Wrap("      ab", 4) == Lines {"    ", "  ab"}
+      && Wrap("state-of-the-art", 10) == Lines {"state-of-", "the-art"},
+    "ASCII wrapping");
+  check(
+    Wrap("中文中文中", 5)
+        == Lines {"中文", "中文", "中"}
+      // No break before the full stop
+      && Wrap("中文中。", 6)
+        == Lines {"中文", "中。"}
+      && Wrap("ééé", 2) == Lines {"éé", "é"}
+      && Wrap("\U0001f1e6\U0001f1e8\U0001f1e6\U0001f1e8", 3)
+        == Lines {"\U0001f1e6\U0001f1e8", "\U0001f1e6\U0001f1e8"},
+    "Unicode wrapping");
+  check(CheckRandomWrapping(), "random wrapping never splits clusters");
+
+  using Breaks = std::vector<bool>;
+  check(
+    // Wide opening punctuation is excluded from LB30
+    GetLineBreaks({U'a', U'('}) == Breaks {false, false}
+      && GetLineBreaks({U'a', U'\u3008'}) == Breaks {false, true}
+      && GetLineBreaks({U')', U'a'}) == Breaks {false, false}
+      && GetLineBreaks({U'\u3009', U'a'}) == Breaks {false, true}
+      // LB30b only applies to unassigned Extended_Pictographic code points
+      && GetLineBreaks({U'\U0001f466', U'\U0001f3fb'})
+        == Breaks {false, false}
+      && GetLineBreaks({U'\U0001fffd', U'\U0001f3fb'})
+        == Breaks {false, false}
+      && GetLineBreaks({U'\U0001f600', U'\U0001f3fb'})
+        == Breaks {false, true},
+    "LB30 and LB30b");
+
+  check(
+    CheckTestData("grapheme breaks", graphemeBreakTest, &GetGraphemeBreaks),
+    std::format(
+      "grapheme breaks match {}", graphemeBreakTest.filename().string()));
+  check(
+    CheckTestData("line breaks", lineBreakTest, &GetLineBreaks),
+    std::format("line breaks match {}", lineBreakTest.filename().string()));
+  return check.GetExitCode();
+}
+
+// The previous `PlainTextLayout` wrapping: bytes, breaking at spaces
+size_t ReferenceWrap(std::string_view text, size_t columns) {
+  size_t lines = 0;
+  while (true) {
+    ++lines;
+    if (text.size() <= columns) {
+      return lines;
+    }
+    const auto space = text.find_last_of(' ', columns);
+    if (space != text.npos) {
+      text.remove_prefix(space + 1);
+      continue;
+    }
+    text.remove_prefix(columns);
+  }
+}
+
+size_t CountLines(std::string_view text, size_t columns) {
+  size_t lines = 0;
+  while (!text.empty()) {
+    ++lines;
+    text.remove_prefix(WrapLine(text, columns).mNextLineOffset);
+  }
+  return lines;
+}
+
+int Benchmark(size_t megabytes) {
+  struct Corpus {
+    std::string_view mName;
+    std::string_view mSentence;
+  };
+  constexpr Corpus corpora[] {
+    {
+      "ASCII",
+      "[12:34:56] Enfield 1-1: fox three, bandit bullseye zero four five, "
+      "twenty, angels two five; RTB, bingo fuel. ",
+    },
+    {
+      "Latin",
+      "Müller fährt über die Brücke; les élèves à l'école. ",
+    },
+    {
+      "CJK",
+      "我方机组正在返航，"
+      "燃油不足。"
+      "タワー、着陸許可を"
+      "要求します。",
+    },
+    {
+      "Emoji",
+      "Good kill \U0001f44d\U0001f3fd \U0001f1fa\U0001f1f8 "
+      "\U0001f468‍✈️ ❤️ landing now ",
+    },
+  };
+  constexpr size_t Columns = 60;
+  // Similar to a logical line in a radio log
+  constexpr size_t LineBytes = 400;
+
+  for (const auto& corpus: corpora) {
+    std::vector<std::string> lines;
+    size_t bytes = 0;
+    while (bytes < megabytes * 1024 * 1024) {
+      std::string line;
+      while (line.size() < LineBytes) {
+        line += corpus.mSentence;
+      }
+      bytes += line.size();
+      lines.push_back(std::move(line));
+    }
+
+    auto start = Clock::now();
+    size_t wrapped = 0;
+    for (const auto& line: lines) {
+      wrapped += CountLines(line, Columns);
+    }
+    const auto wrapMS = MillisecondsSince(start);
+
+    std::string reference;
+    if (corpus.mName == "ASCII") {
+      start = Clock::now();
+      size_t referenceLines = 0;
+      for (const auto& line: lines) {
+        referenceLines += ReferenceWrap(line, Columns);
+      }
+      reference = std::format(
+        "; previous byte-based wrapping {:.1f} MiB/s ({} lines)",
+        (bytes / (1024.0 * 1024)) / (MillisecondsSince(start) / 1000),
+        referenceLines);
+    }
+
+    std::cout << std::format(
+      "{:>6}: {:7.1f} MiB/s, {} lines{}\n",
+      corpus.mName,
+      (bytes / (1024.0 * 1024)) / (wrapMS / 1000),
+      wrapped,
+      reference);
+  }
+  return 0;
+}
+
+}// namespace
+
+int main(int argc, char** argv) {
+  return BenchmarkHarness::Run(
+    argc,
+    argv,
+    {
+      {
+        .mName = "bench",
+        .mUsage = "[MEGABYTES]",
+        .mMaxArguments = 1,
+        .mRun =
+          [](auto arguments) {
+            return Benchmark(
+              arguments.empty() ? 64 : std::stoull(arguments[0]));
+          },
+      },
+      {
+        .mName = "verify",
+        .mUsage = "[GRAPHEME_BREAK_TEST [LINE_BREAK_TEST]]",
+        .mMaxArguments = 2,
+        .mRun =
+          [](auto arguments) {
+            const std::filesystem::path dataDir {UNICODE_DATA_DIR};
+            auto graphemeBreakTest
+              = dataDir / "icu72-grapheme-break-cases.txt";
+            auto lineBreakTest = dataDir / "icu72-line-break-cases.txt";
+            if (arguments.size() >= 1) {
+              graphemeBreakTest = arguments[0];
+            }
+            if (arguments.size() == 2) {
+              lineBreakTest = arguments[1];
+            }
+            return Verify(graphemeBreakTest, lineBreakTest);
+          },
+      },
+    });
+}